@@ -0,0 +1,15 @@
+# Замеры QBENCHMARK на заглушках doas/bhyve/ifconfig (tests/support).
+# В make check не входят — запускаются вручную из каталога сборки:
+#   ./bench_lifecycle/bench_lifecycle -iterations 20
+# Модели и виды GUI — под QT_QPA_PLATFORM=offscreen; порог стопа цикла
+# событий — VMRUN_BENCH_MAX_STALL_MS
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    bench_control \
+    bench_lifecycle \
+    bench_log \
+    bench_logflood \
+    bench_rfb \
+    bench_scale \
+    bench_terminal
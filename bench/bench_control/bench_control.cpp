@@ -0,0 +1,157 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QScopedPointer>
+
+#include "controlclient.h"
+#include "controlload.h"
+#include "controlserver.h"
+#include "guestprocess.h"
+#include "hostmemory.h"
+#include "memoryadmission.h"
+#include "stallmonitor.h"
+#include "stubtools.h"
+#include "vmsupervisor.h"
+
+namespace {
+
+constexpr int Vms = 50;
+constexpr int LoadMs = 3000;
+constexpr int TimeoutMs = 60000;
+constexpr double MinRps = 2000;
+
+} // namespace
+
+// API управления под нагрузкой, ControlServer на временном сокете поверх
+// заглушек. Пачка start поднимает Vms ВМ, пока они работают, ControlLoad
+// читает в 16 соединений LoadMs, затем пачка stop гасит все. Сервер и
+// клиенты — в одном потоке, так что запросов в секунду — оценка снизу.
+// Печатаются время ответа пачек, до всех running/stopped по подписке,
+// задержки ControlLoad и стоп цикла событий
+class BenchControl : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void load();
+
+private:
+    StubTools m_stubs;
+};
+
+void BenchControl::initTestCase()
+{
+    StubTools::Options options;
+    options.taps = Vms;
+    QVERIFY2(m_stubs.prepare(options), qPrintable(m_stubs.errorString()));
+}
+
+void BenchControl::load()
+{
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(0));
+    // Память хоста поддельная (1 ТБ), иначе MemoryAdmission поставит гостей в очередь
+    HostMemory host;
+    host.totalBytes = 1ULL << 40;
+    host.availableBytes = host.totalBytes;
+    supervisor->memoryAdmission()->setBackend(std::unique_ptr<HostMemoryBackend>(new FakeHostMemoryBackend(host)));
+
+    QScopedPointer<ControlServer> server(new ControlServer(supervisor.data()));
+    server->setConfigProvider([this, &supervisor](const QString &name, VmConfig *config, QString *) {
+        *config = m_stubs.config(name, supervisor->allocateTap());
+        return true;
+    });
+    const QString path = m_stubs.filePath("control.sock");
+    QString error;
+    QVERIFY2(server->listen(path, &error), qPrintable(error));
+
+    QHash<QString, QString> states;
+    int statusEvents = 0;
+    int logLines = 0;
+    ControlClient watcher;
+    connect(&watcher, &ControlClient::event, this, [&](const QJsonObject &event) {
+        if (event.value("event").toString() == "log") {
+            logLines += event.value("lines").toArray().size();
+            return;
+        }
+        const QJsonObject vm = event.value("vm").toObject();
+        states.insert(vm.value("name").toString(), vm.value("state").toString());
+        ++statusEvents;
+    });
+    auto all = [&states](const QString &state) {
+        for (int i = 0; i < Vms; ++i) {
+            if (states.value(QString("api%1").arg(i)) != state)
+                return false;
+        }
+        return true;
+    };
+    auto batch = [](const QString &op) {
+        QJsonArray requests;
+        for (int i = 0; i < Vms; ++i)
+            requests.append(QJsonObject {{"op", op}, {"vm", QString("api%1").arg(i)}});
+        return QJsonObject {{"op", "batch"}, {"requests", requests}};
+    };
+
+    QSignalSpy watcherConnected(&watcher, &ControlClient::connected);
+    watcher.connectToServer(path);
+    QVERIFY(watcherConnected.count() > 0 || watcherConnected.wait(TimeoutMs));
+    QSignalSpy watcherReplied(&watcher, &ControlClient::replied);
+    watcher.send(QJsonObject {{"op", "subscribe"}, {"status", true}, {"log", true}});
+    QVERIFY(watcherReplied.wait(TimeoutMs));
+
+    ControlClient driver;
+    QSignalSpy driverConnected(&driver, &ControlClient::connected);
+    driver.connectToServer(path);
+    QVERIFY(driverConnected.count() > 0 || driverConnected.wait(TimeoutMs));
+    QSignalSpy replied(&driver, &ControlClient::replied);
+
+    StallMonitor monitor;
+    QElapsedTimer clock;
+    monitor.start();
+    clock.start();
+    driver.send(batch("start"));
+    QVERIFY(replied.wait(TimeoutMs));
+    const qint64 startReplyMs = clock.elapsed();
+    QTRY_VERIFY_WITH_TIMEOUT(all("running"), 4 * GuestProcess::StartDeadlineMs);
+    qInfo().noquote() << QString("пачка из %1 start: ответ за %2 мс, все running за %3 мс, событий status: %4")
+                             .arg(Vms).arg(startReplyMs).arg(clock.elapsed()).arg(statusEvents);
+
+    ControlLoad::Options options;
+    options.path = path;
+    options.durationMs = LoadMs;
+    ControlLoad load(options);
+    QSignalSpy loaded(&load, &ControlLoad::finished);
+    load.start();
+    QVERIFY(loaded.wait(LoadMs + TimeoutMs));
+    const ControlLoad::Result &result = load.result();
+    qInfo().noquote() << "ControlLoad: " + result.summary();
+
+    clock.start();
+    driver.send(batch("stop"));
+    QVERIFY(replied.wait(TimeoutMs));
+    const qint64 stopReplyMs = clock.elapsed();
+    QTRY_VERIFY_WITH_TIMEOUT(all("stopped"), TimeoutMs);
+    monitor.stop();
+    qInfo().noquote() << QString("пачка из %1 stop: ответ за %2 мс, все stopped за %3 мс; строк лога по подписке: %4")
+                             .arg(Vms).arg(stopReplyMs).arg(clock.elapsed()).arg(logLines);
+    reportLatency("стоп цикла событий", monitor.stalls());
+
+    QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+    QCOMPARE(result.errors, quint64(0));
+    QVERIFY2(result.perSecond() >= MinRps,
+             qPrintable(QString("%1 запросов в секунду при норме %2").arg(result.perSecond(), 0, 'f', 0).arg(MinRps)));
+    QVERIFY(logLines > 0);
+    for (const QVariantList &reply : qAsConst(replied))
+        QVERIFY(reply.at(1).toJsonObject().value("ok").toBool());
+    if (StallMonitor::limitMs() > 0) {
+        QVERIFY2(monitor.stalls().max() <= StallMonitor::limitMs(),
+                 qPrintable(QString("цикл событий стоял %1 мс").arg(monitor.stalls().max())));
+    }
+
+    server.reset();
+    QSignalSpy stopped(supervisor.data(), &VmSupervisor::allStopped);
+    if (supervisor->stopAll() > 0)
+        QVERIFY(stopped.wait(TimeoutMs));
+}
+
+QTEST_GUILESS_MAIN(BenchControl)
+#include "bench_control.moc"
@@ -0,0 +1,13 @@
+TARGET = bench_control
+
+include(../../tests/support/support.pri)
+
+# Нагрузочный клиент — из vmrun ctl load
+INCLUDEPATH += ../../cli
+
+SOURCES += \
+    ../../cli/controlload.cpp \
+    bench_control.cpp
+
+HEADERS += \
+    ../../cli/controlload.h
@@ -0,0 +1,152 @@
+#include <QtTest>
+#include <QListView>
+#include <QScopedPointer>
+#include <QTableView>
+
+#include "commandrunner.h"
+#include "eventjournal.h"
+#include "guestprocess.h"
+#include "logmodel.h"
+#include "offscreenmain.h"
+#include "stallmonitor.h"
+#include "stubtools.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+#include "vmtablemodel.h"
+
+// Проход QBENCHMARK — цикл start → сеть готова → stopAll на нескольких ВМ
+// поверх заглушек. Пока он идёт, открыты таблица ВМ (VmTableModel в
+// QTableView) и консоль первой ВМ (LogModel в QListView) — как в окне, —
+// а StallMonitor меряет, сколько цикл событий стоял. Кроме времени прохода
+// печатаются гистограммы: до Running, до готовой сети, остановки, фаз
+// EventJournal и команд CommandRunner
+class BenchLifecycle : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void startStop_data();
+    void startStop();
+
+private:
+    StubTools m_stubs;
+};
+
+void BenchLifecycle::initTestCase()
+{
+    QVERIFY2(m_stubs.prepare(), qPrintable(m_stubs.errorString()));
+}
+
+void BenchLifecycle::startStop_data()
+{
+    QTest::addColumn<int>("vms");
+    QTest::addColumn<int>("tapDelayMs");
+    QTest::addColumn<int>("ifconfigDelayMs");
+    QTest::addColumn<int>("ifconfigFailPercent");
+
+    QTest::newRow("4-vms") << 4 << 50 << 0 << 0;
+    QTest::newRow("16-vms") << 16 << 50 << 0 << 0;
+    QTest::newRow("slow-ifconfig") << 4 << 50 << 200 << 0;
+    QTest::newRow("flaky-ifconfig") << 4 << 50 << 0 << 20;
+}
+
+void BenchLifecycle::startStop()
+{
+    QFETCH(int, vms);
+    QFETCH(int, tapDelayMs);
+    QFETCH(int, ifconfigDelayMs);
+    QFETCH(int, ifconfigFailPercent);
+
+    StubTools::Options options;
+    options.tapDelayMs = tapDelayMs;
+    options.ifconfigDelayMs = ifconfigDelayMs;
+    options.ifconfigFailPercent = ifconfigFailPercent;
+    options.taps = vms;
+    m_stubs.apply(options);
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(vms));
+
+    VmTableModel table(supervisor.data());
+    QTableView tableView;
+    tableView.setModel(&table);
+    tableView.resize(1200, 600);
+    tableView.show();
+    LogModel log;
+    log.setBuffer(supervisor->at(0)->log());
+    QListView logView;
+    logView.setUniformItemSizes(true);
+    logView.setModel(&log);
+    connect(&log, &LogModel::appended, &logView, &QListView::scrollToBottom);
+    logView.resize(800, 600);
+    logView.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&tableView));
+    QVERIFY(QTest::qWaitForWindowExposed(&logView));
+
+    QElapsedTimer clock;
+    clock.start();
+    QHash<VmInstance *, qint64> startedAt;
+    LatencyHistogram toRunning;
+    LatencyHistogram toNetwork;
+    // Контекст соединений — монитор: уходит раньше переменных, которые они трогают
+    StallMonitor monitor;
+    for (VmInstance *vm : supervisor->instances()) {
+        connect(vm, &VmInstance::stateChanged, &monitor, [&startedAt, &toRunning, &clock, vm](VmInstance::State state) {
+            if (state == VmInstance::State::Running && startedAt.contains(vm))
+                toRunning.record(clock.elapsed() - startedAt.take(vm));
+        });
+    }
+    QSignalSpy stopped(supervisor.data(), &VmSupervisor::allStopped);
+    const int networkTimeoutMs = tapDelayMs + 4 * ifconfigDelayMs + 5000;
+    int withoutNetwork = 0;
+
+    monitor.start();
+    QBENCHMARK {
+        for (VmInstance *vm : supervisor->instances()) {
+            startedAt.insert(vm, clock.elapsed());
+            vm->start();
+        }
+        QTRY_VERIFY_WITH_TIMEOUT(StubTools::allIn(supervisor.data(), VmInstance::State::Running),
+                                 2 * GuestProcess::StartDeadlineMs);
+        QTRY_VERIFY_WITH_TIMEOUT(StubTools::networkSettled(supervisor.data()), networkTimeoutMs);
+        for (const VmInstance *vm : supervisor->instances()) {
+            if (vm->networkReadyMs() >= 0)
+                toNetwork.record(vm->networkReadyMs());
+            else
+                ++withoutNetwork;
+        }
+
+        const int expected = stopped.count() + 1;
+        QCOMPARE(supervisor->stopAll(), vms);
+        QTRY_COMPARE_WITH_TIMEOUT(stopped.count(), expected, 15000);
+    }
+    monitor.stop();
+
+    reportLatency("start() → Running", toRunning);
+    reportLatency("start() → сеть готова", toNetwork);
+    reportLatency("stop() → Stopped", supervisor->stopStats());
+    const EventJournal::PhaseStats phases = supervisor->journal()->stats();
+    for (int i = 0; i < EventJournal::PhaseCount; ++i) {
+        const VmPhase phase = VmPhase(i);
+        if (phases[i].count() > 0)
+            reportLatency(EventJournal::phaseKey(EventJournal::usualAnchor(phase)) + " → "
+                              + EventJournal::phaseKey(phase),
+                          phases[i]);
+    }
+    const QMap<QString, LatencyHistogram> commands = supervisor->commands()->latencyStats();
+    for (auto it = commands.cbegin(); it != commands.cend(); ++it)
+        reportLatency(it.key(), it.value());
+    reportLatency("стоп цикла событий", monitor.stalls());
+    if (withoutNetwork > 0)
+        qInfo().noquote() << QString("ifconfig заглушки отказал, ВМ без сети: %1").arg(withoutNetwork);
+
+    QCOMPARE(StubTools::countIn(supervisor.data(), VmInstance::State::Failed), 0);
+    if (ifconfigFailPercent == 0)
+        QCOMPARE(withoutNetwork, 0);
+    if (StallMonitor::limitMs() > 0) {
+        QVERIFY2(monitor.stalls().max() <= StallMonitor::limitMs(),
+                 qPrintable(QString("цикл событий стоял %1 мс").arg(monitor.stalls().max())));
+    }
+}
+
+VMRUN_OFFSCREEN_TEST_MAIN(BenchLifecycle)
+#include "bench_lifecycle.moc"
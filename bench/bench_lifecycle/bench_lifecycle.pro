@@ -0,0 +1,7 @@
+TARGET = bench_lifecycle
+
+include(../../tests/support/support.pri)
+include(../../tests/support/guimodels.pri)
+
+SOURCES += \
+    bench_lifecycle.cpp
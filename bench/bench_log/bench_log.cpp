@@ -0,0 +1,107 @@
+#include <QtTest>
+
+#include "arpscanparser.h"
+#include "logbuffer.h"
+
+// Разбор потока без процессов и цикла событий: LogBuffer::appendChunk
+// (вывод bhyve и com1) и ArpScanParser. Кроме времени QBENCHMARK на
+// проход — строк в секунду за все проходы
+class BenchLog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void appendChunk_data();
+    void appendChunk();
+    void arpScan_data();
+    void arpScan();
+};
+
+void BenchLog::appendChunk_data()
+{
+    QTest::addColumn<int>("severity");
+    QTest::addColumn<int>("chunkBytes");
+
+    QTest::newRow("stdout-4k") << int(LogSeverity::Stdout) << 4096;
+    QTest::newRow("stdout-64k") << int(LogSeverity::Stdout) << 65536;
+    // com1: из строк вырезаются ESC-последовательности
+    QTest::newRow("serial-64k") << int(LogSeverity::Serial) << 65536;
+}
+
+void BenchLog::appendChunk()
+{
+    QFETCH(int, severity);
+    QFETCH(int, chunkBytes);
+    constexpr int LinesPerPass = 1000000;
+
+    QByteArray chunk;
+    int chunkLines = 0;
+    while (chunk.size() < chunkBytes) {
+        chunk += "\x1b[32m[boot]\x1b[0m BHYVE stub console line " + QByteArray::number(chunkLines++)
+               + " virtio-net: link up, 10000 Mbps\r\n";
+    }
+
+    LogBuffer buffer;
+    qint64 lines = 0;
+    qint64 bytes = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        for (int pass = 0; pass < LinesPerPass; pass += chunkLines) {
+            buffer.appendChunk(LogSeverity(severity), chunk);
+            lines += chunkLines;
+            bytes += chunk.size();
+        }
+    }
+    const double seconds = qMax<qint64>(1, timer.nsecsElapsed()) / 1e9;
+    qInfo().noquote() << QString("%1 строк — %2 тыс. строк/с, %3 МБ/с")
+                             .arg(lines)
+                             .arg(lines / seconds / 1000, 0, 'f', 0)
+                             .arg(bytes / seconds / 1024 / 1024, 0, 'f', 1);
+    QCOMPARE(buffer.size(), buffer.capacity());
+    if (severity == int(LogSeverity::Serial))
+        QVERIFY(!buffer.lineAt(buffer.endSeq() - 1).text.contains(QChar(0x1b)));
+}
+
+void BenchLog::arpScan_data()
+{
+    QTest::addColumn<int>("chunkBytes");
+
+    QTest::newRow("4k") << 4096;
+    QTest::newRow("64k") << 65536;
+}
+
+void BenchLog::arpScan()
+{
+    QFETCH(int, chunkBytes);
+    constexpr int Hosts = 65536;
+
+    QByteArray output = "Interface: bridge0, type: EN10MB, MAC: 58:9c:fc:00:00:01, IPv4: 10.0.0.1\n";
+    for (int i = 0; i < Hosts; ++i) {
+        output += QString("10.%1.%2.%3\t58:9c:fc:%4:%5:%6\tPCS Systemtechnik GmbH\n")
+                      .arg((i >> 16) & 0xff).arg((i >> 8) & 0xff).arg(i & 0xff)
+                      .arg((i >> 16) & 0xff, 2, 16, QLatin1Char('0'))
+                      .arg((i >> 8) & 0xff, 2, 16, QLatin1Char('0'))
+                      .arg(i & 0xff, 2, 16, QLatin1Char('0'))
+                      .toLatin1();
+    }
+
+    quint64 lines = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        ArpScanParser parser;
+        QVector<ArpEntry> entries;
+        QStringList notes;
+        for (int pos = 0; pos < output.size(); pos += chunkBytes)
+            parser.feed(output.mid(pos, chunkBytes), &entries, &notes);
+        parser.finish(&entries, &notes);
+        lines += parser.linesParsed();
+        QCOMPARE(entries.size(), Hosts);
+    }
+    const double seconds = qMax<qint64>(1, timer.nsecsElapsed()) / 1e9;
+    qInfo().noquote() << QString("%1 строк — %2 тыс. строк/с").arg(lines).arg(lines / seconds / 1000, 0, 'f', 0);
+}
+
+QTEST_GUILESS_MAIN(BenchLog)
+#include "bench_log.moc"
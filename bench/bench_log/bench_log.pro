@@ -0,0 +1,6 @@
+TARGET = bench_log
+
+include(../../tests/support/support.pri)
+
+SOURCES += \
+    bench_log.cpp
@@ -0,0 +1,130 @@
+#include <QtTest>
+#include <QListView>
+#include <QScopedPointer>
+
+#include "guestprocess.h"
+#include "logmodel.h"
+#include "offscreenmain.h"
+#include "processmemory.h"
+#include "stallmonitor.h"
+#include "stubtools.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+
+// Миллион строк от заглушки bhyve тем же путём, что консоль гостя в окне:
+// файл вывода GuestProcess → LogBuffer ВМ → LogModel → QListView,
+// прокрученный вниз (QT_QPA_PLATFORM=offscreen). Проход QBENCHMARK — от
+// start() до последней строки загрузки в логе. Печатаются строк в секунду,
+// пик RSS процесса (getrusage) и самый долгий стоп цикла событий; строка
+// без вида показывает, сколько из этого — модель и отрисовка
+class BenchLogFlood : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void flood_data();
+    void flood();
+
+private:
+    StubTools m_stubs;
+};
+
+void BenchLogFlood::initTestCase()
+{
+    QVERIFY2(m_stubs.prepare(), qPrintable(m_stubs.errorString()));
+}
+
+void BenchLogFlood::flood_data()
+{
+    QTest::addColumn<int>("lines");
+    QTest::addColumn<bool>("withView");
+
+    QTest::newRow("1M-lines-view") << 1000000 << true;
+    QTest::newRow("1M-lines-no-view") << 1000000 << false;
+}
+
+void BenchLogFlood::flood()
+{
+    QFETCH(int, lines);
+    QFETCH(bool, withView);
+
+    m_stubs.setBootLines(lines);
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(1));
+    VmInstance *vm = supervisor->at(0);
+    LogBuffer *buffer = vm->log();
+
+    LogModel model;
+    QListView view;
+    if (withView) {
+        model.setBuffer(buffer);
+        view.setUniformItemSizes(true);
+        view.setModel(&model);
+        connect(&model, &LogModel::appended, &view, &QListView::scrollToBottom);
+        view.resize(1000, 700);
+        view.show();
+        QVERIFY(QTest::qWaitForWindowExposed(&view));
+    }
+
+    // Последняя строка загрузки заглушки — "[boot] login:"; смотрим только
+    // новые строки каждого кадра, как модель
+    QElapsedTimer clock;
+    qint64 deliveredMs = -1;
+    quint64 checked = 0;
+    quint64 startSeq = 0;
+    StallMonitor monitor;
+    connect(buffer, &LogBuffer::linesFlushed, &monitor, [&]() {
+        for (quint64 seq = qMax(checked, buffer->firstSeq()); seq < buffer->endSeq() && deliveredMs < 0; ++seq) {
+            if (buffer->lineAt(seq).text == QLatin1String("[boot] login:"))
+                deliveredMs = clock.elapsed();
+        }
+        checked = buffer->endSeq();
+    });
+
+    const quint64 rssBefore = currentRssBytes();
+    const quint64 peakBefore = peakRssBytes();
+    quint64 delivered = 0;
+    quint64 dropped = 0;
+    monitor.start();
+    QBENCHMARK {
+        deliveredMs = -1;
+        startSeq = buffer->endSeq();
+        checked = startSeq;
+        const quint64 droppedBefore = buffer->droppedCount();
+        clock.start();
+        vm->start();
+        QTRY_VERIFY_WITH_TIMEOUT(deliveredMs >= 0, 300000);
+        delivered += buffer->endSeq() - startSeq;
+        dropped += buffer->droppedCount() - droppedBefore;
+
+        vm->stop();
+        QTRY_COMPARE_WITH_TIMEOUT(vm->state(), VmInstance::State::Stopped, 15000);
+    }
+    monitor.stop();
+    const quint64 peakAfter = peakRssBytes();
+
+    const double seconds = qMax<qint64>(1, deliveredMs) / 1000.0;
+    qInfo().noquote() << QString("bhyve → LogBuffer%1: %2 строк за %3 мс — %4 тыс. строк/с, вытеснено из кольца %5")
+                             .arg(withView ? " → LogModel → QListView" : "")
+                             .arg(lines).arg(deliveredMs)
+                             .arg(lines / seconds / 1000, 0, 'f', 0)
+                             .arg(dropped);
+    qInfo().noquote() << QString("RSS: до запуска %1 МиБ, пик до %2 МиБ, пик после %3 МиБ; строк в модели %4")
+                             .arg(rssBefore >> 20).arg(peakBefore >> 20).arg(peakAfter >> 20)
+                             .arg(model.rowCount());
+    reportLatency("стоп цикла событий", monitor.stalls());
+
+    // Все строки прошли через буфер, а он не вырос больше своей ёмкости
+    QVERIFY(delivered >= quint64(lines));
+    QCOMPARE(buffer->size(), buffer->capacity());
+    if (withView)
+        QTRY_COMPARE(model.rowCount(), buffer->size());
+    if (StallMonitor::limitMs() > 0) {
+        QVERIFY2(monitor.stalls().max() <= StallMonitor::limitMs(),
+                 qPrintable(QString("цикл событий стоял %1 мс").arg(monitor.stalls().max())));
+    }
+    m_stubs.setBootLines(StubTools::Options().bootLines);
+}
+
+VMRUN_OFFSCREEN_TEST_MAIN(BenchLogFlood)
+#include "bench_logflood.moc"
@@ -0,0 +1,127 @@
+#include <QtTest>
+
+#include <ctime>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "rfbdecoder.h"
+#include "rfbtestserver.h"
+
+namespace {
+
+constexpr int RawFrames = 90;
+constexpr int ZrleFrames = 60;
+constexpr int SmallUpdates = 300;
+constexpr double MinFps = 30;
+
+qint64 threadCpuNs()
+{
+    timespec ts;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // namespace
+
+// RfbDecoder против RfbTestServer на loopback, экран 1920x1080: полные
+// кадры Raw и ZRLE (все виды плиток) и поток мелких обновлений с CopyRect.
+// Сервер кодирует кадры заранее и работает в своём потоке, так что CPU и
+// время декодера — только клиентские. На проход печатаются кадры в
+// секунду, CPU клиента и декодера на кадр и КБ на кадр; полные кадры —
+// не медленнее MinFps
+class BenchRfb : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void desktop();
+};
+
+void BenchRfb::desktop()
+{
+    std::vector<QByteArray> updates;
+    ZrleEncoder zrle;
+    QElapsedTimer encodeTimer;
+    encodeTimer.start();
+    const QVector<RfbPass> passes = buildDesktopPasses(RawFrames, ZrleFrames, SmallUpdates, &zrle, &updates);
+    qInfo().noquote() << QString("кадры собраны за %1 мс; плитки ZRLE: без сжатия %2, сплошных %3, палитра %4, "
+                                 "RLE %5, RLE с палитрой %6")
+                             .arg(encodeTimer.elapsed())
+                             .arg(zrle.uses[ZrleEncoder::RawTile])
+                             .arg(zrle.uses[ZrleEncoder::SolidTile])
+                             .arg(zrle.uses[ZrleEncoder::PackedTile])
+                             .arg(zrle.uses[ZrleEncoder::PlainRleTile])
+                             .arg(zrle.uses[ZrleEncoder::PaletteRleTile]);
+
+    RfbTestServer server;
+    QVERIFY2(server.listen(DesktopWidth, DesktopHeight, &updates), qPrintable(server.errorString()));
+    const int fd = server.connectClient();
+    QVERIFY2(fd >= 0, qPrintable(server.errorString()));
+
+    ScreenSurface surface;
+    RfbDecoder decoder(&surface);
+    QByteArray buffer(1 << 20, Qt::Uninitialized);
+    int pass = 0;
+    int done = 0;  // кадров прохода
+    QElapsedTimer passTimer;
+    qint64 passCpu = 0;
+    qint64 passDecodeNs = 0;
+    qint64 passBytes = 0;
+    auto startPass = [&]() {
+        done = 0;
+        passTimer.start();
+        passCpu = threadCpuNs();
+        passDecodeNs = decoder.stats().decodeNs;
+        passBytes = decoder.stats().bytesIn;
+    };
+    QStringList failures;
+    startPass();
+    while (pass < passes.size() && failures.isEmpty()) {
+        const QByteArray out = decoder.takeOutput();
+        if (!out.isEmpty() && ::send(fd, out.constData(), size_t(out.size()), MSG_NOSIGNAL) != out.size()) {
+            failures << "запрос серверу не ушёл";
+            break;
+        }
+        pollfd reading {fd, POLLIN, 0};
+        const ssize_t n = ::poll(&reading, 1, 5000) > 0 ? ::recv(fd, buffer.data(), size_t(buffer.size()), 0) : -1;
+        if (n <= 0) {
+            failures << QString("%1: сервер замолчал после %2 кадров").arg(passes[pass].name).arg(done);
+            break;
+        }
+        if (!decoder.feed(buffer.constData(), n)) {
+            failures << "декодер: " + decoder.error();
+            break;
+        }
+        for (int completed = decoder.takeCompletedUpdates(); completed > 0 && pass < passes.size(); --completed) {
+            decoder.takeDirtyRects();
+            decoder.requestUpdate(true);
+            if (++done < passes[pass].updates)
+                continue;
+
+            const RfbPass &finished = passes[pass];
+            const double fps = done / (passTimer.nsecsElapsed() / 1e9);
+            qInfo().noquote() << QString("%1: %2 кадров, %3 кадр/с, CPU клиента %4 мс/кадр, декодер %5 мс/кадр, %6 КБ/кадр")
+                                     .arg(finished.name, -6)
+                                     .arg(done)
+                                     .arg(fps, 0, 'f', 1)
+                                     .arg((threadCpuNs() - passCpu) / 1e6 / done, 0, 'f', 2)
+                                     .arg((decoder.stats().decodeNs - passDecodeNs) / 1e6 / done, 0, 'f', 2)
+                                     .arg((decoder.stats().bytesIn - passBytes) / 1024 / done);
+            if (!surface.sameAs(finished.expected))
+                failures << finished.name + ": экран клиента не совпал с сервером";
+            if (finished.fullFrames && fps < MinFps)
+                failures << QString("%1: %2 кадр/с при норме %3").arg(finished.name).arg(fps, 0, 'f', 1).arg(MinFps);
+            ++pass;
+            startPass();
+        }
+    }
+    ::close(fd);
+    const QString serverError = server.finish();
+
+    QVERIFY2(failures.isEmpty(), qPrintable(failures.join("; ")));
+    QVERIFY2(serverError.isEmpty(), qPrintable("тестовый сервер: " + serverError));
+}
+
+QTEST_GUILESS_MAIN(BenchRfb)
+#include "bench_rfb.moc"
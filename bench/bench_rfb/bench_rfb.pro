@@ -0,0 +1,6 @@
+TARGET = bench_rfb
+
+include(../../tests/support/support.pri)
+
+SOURCES += \
+    bench_rfb.cpp
@@ -0,0 +1,7 @@
+TARGET = bench_scale
+
+include(../../tests/support/support.pri)
+include(../../tests/support/guimodels.pri)
+
+SOURCES += \
+    bench_scale.cpp
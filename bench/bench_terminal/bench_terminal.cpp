@@ -0,0 +1,129 @@
+#include <QtTest>
+#include <QScopedPointer>
+
+#include "consolesample.h"
+#include "guestprocess.h"
+#include "serialconsole.h"
+#include "stallmonitor.h"
+#include "stubtools.h"
+#include "terminalscreen.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+
+namespace {
+
+constexpr int ChunkBytes = 4096;
+constexpr double MinMBps = 20;
+constexpr int Keys = 500;
+constexpr qint64 MaxEchoP99Us = 20000;
+constexpr int TimeoutMs = 30000;
+
+} // namespace
+
+// Консоль гостя:
+//   parse — разбор TerminalScreen кусками по 4 КиБ, повреждения забираются
+//           после каждого, как у TerminalView; МиБ/с за все проходы —
+//           не меньше MinMBps;
+//   echo  — com1 заглушки bhyve через pty: нажатие → эхо, следующее — когда
+//           вернулось эхо предыдущего; p99 — не больше MaxEchoP99Us
+class BenchTerminal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parse();
+    void echo();
+
+private:
+    StubTools m_stubs;
+};
+
+void BenchTerminal::initTestCase()
+{
+    QVERIFY2(m_stubs.prepare(), qPrintable(m_stubs.errorString()));
+}
+
+void BenchTerminal::parse()
+{
+    const QByteArray sample = consoleSample(256 * 1024);
+    TerminalScreen screen;
+    qint64 fed = 0;
+    int damagedRows = 0;
+    QElapsedTimer clock;
+    clock.start();
+    QBENCHMARK {
+        for (int offset = 0; offset < sample.size(); offset += ChunkBytes) {
+            screen.feed(sample.constData() + offset, qMin(ChunkBytes, sample.size() - offset));
+            const TerminalScreen::Damage damage = screen.takeDamage();
+            for (const TerminalScreen::Span &span : damage.rows)
+                damagedRows += span.isEmpty() ? 0 : 1;
+        }
+        fed += sample.size();
+        screen.takeReplies();
+    }
+    const double seconds = qMax<qint64>(1, clock.nsecsElapsed()) / 1e9;
+    const double mbps = fed / seconds / (1 << 20);
+    const TerminalScreen::Stats &stats = screen.stats();
+    qInfo().noquote() << QString("TerminalScreen: %1 КиБ — %2 МиБ/с; символов %3, последовательностей %4, "
+                                 "прокручено строк %5, перерисовано строк %6")
+                             .arg(fed >> 10).arg(mbps, 0, 'f', 0)
+                             .arg(stats.printed).arg(stats.sequences).arg(stats.scrolled).arg(damagedRows);
+    QVERIFY2(mbps >= MinMBps, qPrintable(QString("разбор медленнее %1 МиБ/с").arg(MinMBps)));
+}
+
+void BenchTerminal::echo()
+{
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(1));
+    VmInstance *vm = supervisor->at(0);
+    SerialConsole *serial = vm->serial();
+
+    QByteArray received;
+    int keys = 0;
+    char expected = 0;
+    bool typing = false;
+    QElapsedTimer keyClock;
+    LatencyHistogram echoUs;
+    // Контекст соединения — монитор: уходит раньше переменных, которые оно трогает
+    StallMonitor monitor;
+    auto sendKey = [&]() {
+        expected = char('a' + keys % 26);
+        keyClock.start();
+        serial->write(QByteArray(1, expected));
+    };
+    connect(serial, &SerialConsole::received, &monitor, [&](const QByteArray &data) {
+        received += data;
+        if (!typing || !data.contains(expected))
+            return;
+        echoUs.record(keyClock.nsecsElapsed() / 1000);
+        if (++keys < Keys)
+            sendKey();
+        else
+            typing = false;
+    });
+
+    QElapsedTimer clock;
+    clock.start();
+    vm->start();
+    QTRY_VERIFY_WITH_TIMEOUT(received.contains("login: "), 2 * GuestProcess::StartDeadlineMs);
+    qInfo().noquote() << QString("приглашение login на com1 через %1 мс после start").arg(clock.elapsed());
+
+    monitor.start();
+    typing = true;
+    sendKey();
+    QTRY_VERIFY_WITH_TIMEOUT(!typing, TimeoutMs);
+    monitor.stop();
+
+    reportLatency("нажатие → эхо через pty", echoUs, "мкс");
+    reportLatency("стоп цикла событий", monitor.stalls());
+    qInfo().noquote() << QString("com1: получено %1 Б, отправлено %2 Б").arg(serial->bytesReceived()).arg(serial->bytesSent());
+
+    vm->stop();
+    QTRY_COMPARE_WITH_TIMEOUT(vm->state(), VmInstance::State::Stopped, 15000);
+    QCOMPARE(keys, Keys);
+    QVERIFY2(echoUs.percentile(99) <= MaxEchoP99Us,
+             qPrintable(QString("p99 эха %1 мкс при норме %2").arg(echoUs.percentile(99)).arg(MaxEchoP99Us)));
+}
+
+QTEST_GUILESS_MAIN(BenchTerminal)
+#include "bench_terminal.moc"
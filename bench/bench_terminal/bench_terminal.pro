@@ -0,0 +1,6 @@
+TARGET = bench_terminal
+
+include(../../tests/support/support.pri)
+
+SOURCES += \
+    bench_terminal.cpp
@@ -0,0 +1,25 @@
+QT = core
+
+TARGET = vmrun
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+include(../core/core.pri)
+
+SOURCES += \
+    consolelog.cpp \
+    controlload.cpp \
+    main.cpp \
+    rawterminal.cpp \
+    unixsignals.cpp \
+    vmruncli.cpp
+
+HEADERS += \
+    consolelog.h \
+    controlload.h \
+    rawterminal.h \
+    unixsignals.h \
+    vmruncli.h
+
+unix:!android: target.path = /opt/vmrun/bin
+!isEmpty(target.path): INSTALLS += target
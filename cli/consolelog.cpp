@@ -0,0 +1,57 @@
+#include "consolelog.h"
+
+#include <QDateTime>
+#include <cstdio>
+
+ConsoleLog::ConsoleLog(QObject *parent)
+    : QObject(parent)
+    , m_out(stdout)
+{
+}
+
+void ConsoleLog::follow(LogBuffer *buffer, const QString &prefix)
+{
+    if (m_followers.contains(buffer))
+        return;
+    m_followers.insert(buffer, Follower{prefix, buffer->firstSeq()});
+
+    connect(buffer, &LogBuffer::linesFlushed, this, [this, buffer]() { drain(buffer); });
+    connect(buffer, &LogBuffer::cleared, this, [this, buffer]() {
+        m_followers[buffer].nextSeq = buffer->endSeq();
+    });
+    connect(buffer, &QObject::destroyed, this, [this, buffer]() { m_followers.remove(buffer); });
+    drain(buffer);
+}
+
+void ConsoleLog::message(LogSeverity severity, const QString &text)
+{
+    print(QString(), LogLine{QDateTime::currentMSecsSinceEpoch(), severity, text});
+}
+
+void ConsoleLog::drain(LogBuffer *buffer)
+{
+    auto it = m_followers.find(buffer);
+    if (it == m_followers.end())
+        return;
+
+    // Отставшие строки буфер мог уже вытеснить — начинаем с первой живой
+    quint64 seq = qMax(it->nextSeq, buffer->firstSeq());
+    for (; seq < buffer->endSeq(); ++seq)
+        print(it->prefix, buffer->lineAt(seq));
+    it->nextSeq = seq;
+    m_out.flush();
+}
+
+void ConsoleLog::print(const QString &prefix, const LogLine &line)
+{
+    m_out << QDateTime::fromMSecsSinceEpoch(line.timestampMs).toString("hh:mm:ss.zzz") << ' ';
+    if (!prefix.isEmpty())
+        m_out << '[' << prefix << "] ";
+    if (line.severity == LogSeverity::Stderr)
+        m_out << "[ERR] ";
+    else if (line.severity == LogSeverity::Serial)
+        m_out << "[COM1] ";
+    m_out << line.text << '\n';
+    if (prefix.isEmpty())
+        m_out.flush();
+}
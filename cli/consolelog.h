@@ -0,0 +1,35 @@
+#ifndef CONSOLELOG_H
+#define CONSOLELOG_H
+
+#include <QObject>
+#include <QHash>
+#include <QTextStream>
+
+#include "logbuffer.h"
+
+// Выводит строки LogBuffer'ов в stdout по мере их сброса буфером:
+// "12:00:01.250 [имя] текст". Каждый буфер читается со своего номера строки.
+class ConsoleLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConsoleLog(QObject *parent = nullptr);
+
+    void follow(LogBuffer *buffer, const QString &prefix);
+    void message(LogSeverity severity, const QString &text);
+
+private:
+    void drain(LogBuffer *buffer);
+    void print(const QString &prefix, const LogLine &line);
+
+    struct Follower {
+        QString prefix;
+        quint64 nextSeq = 0;
+    };
+
+    QHash<LogBuffer *, Follower> m_followers;
+    QTextStream m_out;
+};
+
+#endif // CONSOLELOG_H
@@ -0,0 +1,150 @@
+#include "controlload.h"
+#include "controlclient.h"
+
+#include <QJsonArray>
+
+#include <algorithm>
+
+namespace {
+constexpr int DrainTimeoutMs = 5000;  // после срока ждём ответы на отправленное
+constexpr int BatchSize = 10;
+constexpr int LogLines = 20;
+}
+
+qint32 ControlLoad::Result::percentileUs(double p) const
+{
+    if (latenciesUs.empty())
+        return 0;
+    const size_t index = std::min(latenciesUs.size() - 1, size_t(p / 100.0 * latenciesUs.size()));
+    return latenciesUs[index];
+}
+
+QString ControlLoad::Result::summary() const
+{
+    return QString("%1 ответов за %2 мс — %3 в секунду; задержка p50 %4 мкс, p99 %5 мкс, max %6 мкс; "
+                   "ошибок %7, соединений %8")
+        .arg(requests)
+        .arg(elapsedMs)
+        .arg(perSecond(), 0, 'f', 0)
+        .arg(percentileUs(50))
+        .arg(percentileUs(99))
+        .arg(latenciesUs.empty() ? 0 : latenciesUs.back())
+        .arg(errors)
+        .arg(connected);
+}
+
+ControlLoad::ControlLoad(const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+{
+    m_deadline.setSingleShot(true);
+}
+
+ControlLoad::~ControlLoad()
+{
+    qDeleteAll(m_connections);
+}
+
+void ControlLoad::start()
+{
+    m_clock.start();
+    m_sending = true;
+    m_result.latenciesUs.reserve(size_t(qMax(1, m_options.durationMs)) * 20);
+    for (int i = 0; i < m_options.clients; ++i) {
+        auto *connection = new Connection;
+        connection->client = new ControlClient(this);
+        m_connections.append(connection);
+
+        connect(connection->client, &ControlClient::connected, this, [this, connection]() {
+            ++m_result.connected;
+            fill(connection);
+        });
+        connect(connection->client, &ControlClient::replied, this, [this, connection](qint64, const QJsonObject &reply) {
+            if (connection->sentNs.empty())
+                return;  // ошибка кадра без id — следом сервер закроет соединение
+            const qint64 sent = connection->sentNs.front();
+            connection->sentNs.pop_front();
+            m_result.latenciesUs.push_back(qint32((m_clock.nsecsElapsed() - sent) / 1000));
+            ++m_result.requests;
+            if (!reply.value("ok").toBool())
+                ++m_result.errors;
+            if (m_vms.isEmpty() && reply.contains("vms")) {
+                for (const QJsonValue &vm : reply.value("vms").toArray())
+                    m_vms.append(vm.toObject().value("name").toString());
+            }
+            if (m_sending) {
+                fill(connection);
+                return;
+            }
+            for (const Connection *other : qAsConst(m_connections)) {
+                if (!other->sentNs.empty())
+                    return;
+            }
+            finish();
+        });
+        connect(connection->client, &ControlClient::disconnected, this, [this](const QString &error) {
+            if (m_result.error.isEmpty())
+                m_result.error = error.isEmpty() ? "сервер закрыл соединение" : error;
+            finish();
+        });
+        connection->client->connectToServer(m_options.path);
+    }
+
+    connect(&m_deadline, &QTimer::timeout, this, &ControlLoad::stopSending);
+    m_deadline.start(m_options.durationMs);
+}
+
+// Чтение всего подряд: каждый восьмой — list, дальше status, log, batch и ping
+void ControlLoad::fill(Connection *connection)
+{
+    while (int(connection->sentNs.size()) < m_options.pipeline) {
+        const quint64 n = connection->counter++;
+        const int kind = int(n % 8);
+        QJsonObject request;
+        if (m_vms.isEmpty() || kind == 0) {
+            request.insert("op", "list");
+        } else {
+            const QString vm = m_vms.at(int((n / 8) % quint64(m_vms.size())));
+            if (kind == 4) {
+                request = QJsonObject {{"op", "log"}, {"vm", vm}, {"lines", LogLines}};
+            } else if (kind == 5) {
+                QJsonArray requests;
+                for (int i = 0; i < BatchSize; ++i)
+                    requests.append(QJsonObject {{"op", "status"}, {"vm", m_vms.at((int(n) + i) % m_vms.size())}});
+                request = QJsonObject {{"op", "batch"}, {"requests", requests}};
+            } else if (kind == 6) {
+                request.insert("op", "ping");
+            } else {
+                request = QJsonObject {{"op", "status"}, {"vm", vm}};
+            }
+        }
+        connection->sentNs.push_back(m_clock.nsecsElapsed());
+        connection->client->send(request);
+    }
+}
+
+void ControlLoad::stopSending()
+{
+    m_sending = false;
+    QTimer::singleShot(DrainTimeoutMs, this, [this]() {
+        if (!m_finished && m_result.error.isEmpty())
+            m_result.error = "не дождались ответов на отправленные запросы";
+        finish();
+    });
+}
+
+void ControlLoad::finish()
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+    m_sending = false;
+    m_deadline.stop();
+    m_result.elapsedMs = m_clock.elapsed();
+    std::sort(m_result.latenciesUs.begin(), m_result.latenciesUs.end());
+    for (Connection *connection : qAsConst(m_connections)) {
+        connection->client->disconnect(this);
+        connection->client->disconnectFromServer();
+    }
+    emit finished();
+}
@@ -0,0 +1,73 @@
+#ifndef CONTROLLOAD_H
+#define CONTROLLOAD_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include <deque>
+#include <vector>
+
+class ControlClient;
+
+// Нагрузочный клиент API управления (vmrun ctl load, bench control):
+// clients соединений, в каждом до pipeline запросов в полёте. Смесь —
+// только чтение, ВМ не трогаются: list, status, log, batch из status и
+// ping. Задержка — от записи запроса до его ответа.
+class ControlLoad : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString path;
+        int clients = 16;
+        int pipeline = 8;
+        int durationMs = 5000;
+    };
+
+    struct Result {
+        quint64 requests = 0;   // получено ответов
+        quint64 errors = 0;     // ответов с ok: false
+        int connected = 0;
+        qint64 elapsedMs = 0;
+        QString error;          // соединение не удалось или оборвалось
+        std::vector<qint32> latenciesUs;  // по возрастанию после finished()
+
+        double perSecond() const { return elapsedMs > 0 ? requests * 1000.0 / elapsedMs : 0; }
+        qint32 percentileUs(double p) const;
+        QString summary() const;
+    };
+
+    explicit ControlLoad(const Options &options, QObject *parent = nullptr);
+    ~ControlLoad() override;
+
+    void start();
+    const Result &result() const { return m_result; }
+
+signals:
+    void finished();
+
+private:
+    struct Connection {
+        ControlClient *client = nullptr;
+        std::deque<qint64> sentNs;  // сервер отвечает по порядку
+        quint64 counter = 0;
+    };
+
+    void fill(Connection *connection);
+    void stopSending();
+    void finish();
+
+    Options m_options;
+    QVector<Connection *> m_connections;
+    QStringList m_vms;  // из первого ответа list
+    QElapsedTimer m_clock;
+    QTimer m_deadline;
+    bool m_sending = false;
+    bool m_finished = false;
+    Result m_result;
+};
+
+#endif // CONTROLLOAD_H
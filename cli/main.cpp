@@ -0,0 +1,74 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "vmruncli.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setOrganizationName("vmrun");
+    QCoreApplication::setApplicationName("vmrun");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Запуск и надзор за ВМ bhyve без GUI");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "list | run <имя> | daemon [имя...] | clone <шаблон> <имя...> | diskbench <имя|путь> | ctl <операция>");
+    const QCommandLineOption rootOption("root", "Каталог с образами ВМ.", "каталог");
+    const QCommandLineOption memoryOption({"m", "memory"}, "Память ВМ (4G, 8192M).", "объём");
+    const QCommandLineOption diskOption("disk", "Образ диска, если ВМ нет в каталоге.", "путь");
+    const QCommandLineOption isoOption("iso", "ISO для загрузки.", "путь");
+    const QCommandLineOption tapOption("tap", "tap-интерфейс (по умолчанию — первый свободный).", "tapN");
+    const QCommandLineOption cpusOption("cpus", "vCPU: 4, 4,pin или cpus=4,sockets=1,cores=2,threads=2[,pin].", "спец");
+    const QCommandLineOption diskProfileOption("disk-profile", "Профиль загрузочного диска: nvme,nocache или virtio-blk,ro,sectorsize=512/4096.", "профиль");
+    const QCommandLineOption vncPortOption("vnc-port", "VNC-порт экрана ВМ; 0 — первый свободный с 5900.", "порт");
+    const QCommandLineOption metricsOption("metrics", "Файл метрик для Prometheus (textfile collector).", "путь");
+    const QCommandLineOption consoleOption("console", "com1 гостя: nmdm (FreeBSD) или pty.", "nmdm|pty");
+    const QCommandLineOption socketOption("socket", "Сокет API управления (daemon, ctl); по умолчанию — в каталоге состояния гостей.", "путь");
+    parser.addOptions({rootOption, memoryOption, diskOption, isoOption, tapOption, cpusOption, diskProfileOption,
+                       vncPortOption, consoleOption, metricsOption, socketOption});
+
+    const QCommandLineOption testSizeOption("test-size", "diskbench: объём на тест.", "МБ", "256");
+    const QCommandLineOption testTimeOption("test-time", "diskbench: предел времени на тест.", "с", "5");
+    const QCommandLineOption parallelOption("parallel", "clone: копий одновременно на одном диске.", "n");
+    parser.addOptions({testSizeOption, testTimeOption, parallelOption});
+
+    const QCommandLineOption linesOption("lines", "ctl log: последних строк.", "n", "100");
+    const QCommandLineOption clientsOption("clients", "ctl load: соединений.", "n", "16");
+    const QCommandLineOption pipelineOption("pipeline", "ctl load: запросов в полёте на соединение.", "n", "8");
+    const QCommandLineOption durationOption("duration", "ctl load: длительность.", "с", "5");
+    parser.addOptions({linesOption, clientsOption, pipelineOption, durationOption});
+
+    parser.process(a);
+
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty())
+        parser.showHelp(2);
+    const QString command = args.takeFirst();
+
+    VmrunCli::Overrides overrides;
+    overrides.root = parser.value(rootOption);
+    overrides.memory = parser.value(memoryOption);
+    overrides.diskPath = parser.value(diskOption);
+    overrides.isoPath = parser.value(isoOption);
+    overrides.tap = parser.value(tapOption);
+    overrides.cpus = parser.value(cpusOption);
+    overrides.diskProfile = parser.value(diskProfileOption);
+    if (parser.isSet(vncPortOption))
+        overrides.vncPort = qBound(0, parser.value(vncPortOption).toInt(), 65535);
+    overrides.testSizeMb = qMax(1, parser.value(testSizeOption).toInt());
+    overrides.testTimeS = qMax(1, parser.value(testTimeOption).toInt());
+    overrides.cloneParallel = parser.value(parallelOption).toInt();
+    overrides.consoleBackend = parser.value(consoleOption);
+    overrides.metricsFile = parser.value(metricsOption);
+    overrides.controlSocket = parser.value(socketOption);
+    overrides.logLines = qMax(0, parser.value(linesOption).toInt());
+    overrides.loadClients = qMax(1, parser.value(clientsOption).toInt());
+    overrides.loadPipeline = qMax(1, parser.value(pipelineOption).toInt());
+    overrides.loadSeconds = qMax(1, parser.value(durationOption).toInt());
+
+    VmrunCli cli(overrides);
+    const int code = cli.start(command, args);
+    if (code >= 0)
+        return code;
+    return a.exec();
+}
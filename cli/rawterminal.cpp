@@ -0,0 +1,64 @@
+#include "rawterminal.h"
+
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <unistd.h>
+
+RawTerminal::RawTerminal(QObject *parent)
+    : QObject(parent)
+{
+    if (::isatty(STDIN_FILENO) && ::tcgetattr(STDIN_FILENO, &m_saved) == 0) {
+        termios raw = m_saved;
+        ::cfmakeraw(&raw);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        m_raw = ::tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+    m_notifier = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &RawTerminal::onReadable);
+}
+
+RawTerminal::~RawTerminal()
+{
+    delete m_notifier;
+    if (m_raw)
+        ::tcsetattr(STDIN_FILENO, TCSANOW, &m_saved);
+}
+
+void RawTerminal::write(const QByteArray &data)
+{
+    qint64 written = 0;
+    while (written < data.size()) {
+        const ssize_t n = ::write(STDOUT_FILENO, data.constData() + written, size_t(data.size() - written));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        written += n;
+    }
+}
+
+void RawTerminal::onReadable()
+{
+    char buf[4096];
+    const ssize_t n = ::read(STDIN_FILENO, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR)
+        return;
+    if (n <= 0) {
+        // Конец перенаправленного файла: ввод кончился, а вывод гостя ещё
+        // нужен — сеанс идёт до SIGINT
+        m_notifier->setEnabled(false);
+        return;
+    }
+    const QByteArray data(buf, int(n));
+    const int detach = data.indexOf(DetachKey);
+    if (detach < 0) {
+        emit input(data);
+        return;
+    }
+    // Всё, что набрано до Ctrl+], — ещё гостю
+    if (detach > 0)
+        emit input(data.left(detach));
+    emit detachRequested();
+}
@@ -0,0 +1,42 @@
+#ifndef RAWTERMINAL_H
+#define RAWTERMINAL_H
+
+#include <QObject>
+#include <QByteArray>
+
+#include <termios.h>
+
+class QSocketNotifier;
+
+// stdin в сыром режиме для vmrun ctl console: каждое нажатие сразу уходит
+// в input(), Ctrl+C и стрелки — гостю, а не нам. Выход — Ctrl+]
+// (detachRequested), как у cu и telnet. Режим терминала восстанавливается
+// в деструкторе; stdout — без буферизации, байты гостя пишутся как есть.
+class RawTerminal : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr char DetachKey = 0x1d;  // Ctrl+]
+
+    explicit RawTerminal(QObject *parent = nullptr);
+    ~RawTerminal() override;
+
+    // false — stdin не терминал (перенаправлен): ввод читается как есть
+    bool isRaw() const { return m_raw; }
+
+    static void write(const QByteArray &data);
+
+signals:
+    void input(const QByteArray &data);
+    void detachRequested();
+
+private:
+    void onReadable();
+
+    termios m_saved {};
+    bool m_raw = false;
+    QSocketNotifier *m_notifier = nullptr;
+};
+
+#endif // RAWTERMINAL_H
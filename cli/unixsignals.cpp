@@ -0,0 +1,62 @@
+#include "unixsignals.h"
+
+#include <QSocketNotifier>
+
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+namespace {
+int s_pipe[2] = {-1, -1};
+}
+
+UnixSignals::UnixSignals(const QList<int> &signums, QObject *parent)
+    : QObject(parent)
+    , m_signums(signums)
+{
+    if (::pipe2(s_pipe, O_CLOEXEC | O_NONBLOCK) != 0)
+        return;
+
+    m_notifier = new QSocketNotifier(s_pipe[0], QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &UnixSignals::onReadable);
+
+    struct sigaction action {};
+    action.sa_handler = &UnixSignals::handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    for (int signum : m_signums)
+        ::sigaction(signum, &action, nullptr);
+}
+
+UnixSignals::~UnixSignals()
+{
+    for (int signum : m_signums)
+        ::signal(signum, SIG_DFL);
+    delete m_notifier;
+    for (int &fd : s_pipe) {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+}
+
+void UnixSignals::handler(int signum)
+{
+    // Только async-signal-safe: write() и errno
+    const int savedErrno = errno;
+    const unsigned char byte = static_cast<unsigned char>(signum);
+    if (s_pipe[1] >= 0)
+        (void)::write(s_pipe[1], &byte, 1);
+    errno = savedErrno;
+}
+
+void UnixSignals::onReadable()
+{
+    unsigned char buf[16];
+    ssize_t n;
+    while ((n = ::read(s_pipe[0], buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; ++i)
+            emit received(buf[i]);
+    }
+}
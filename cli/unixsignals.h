@@ -0,0 +1,31 @@
+#ifndef UNIXSIGNALS_H
+#define UNIXSIGNALS_H
+
+#include <QObject>
+#include <QList>
+
+class QSocketNotifier;
+
+// SIGINT/SIGTERM/SIGHUP в цикл событий Qt через self-pipe: обработчик
+// сигнала только пишет номер в pipe, остальное делается в слоте.
+// Экземпляр должен быть один на процесс.
+class UnixSignals : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UnixSignals(const QList<int> &signums, QObject *parent = nullptr);
+    ~UnixSignals() override;
+
+signals:
+    void received(int signum);
+
+private:
+    static void handler(int signum);
+    void onReadable();
+
+    QList<int> m_signums;
+    QSocketNotifier *m_notifier = nullptr;
+};
+
+#endif // UNIXSIGNALS_H
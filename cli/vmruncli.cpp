@@ -0,0 +1,483 @@
+#include "vmruncli.h"
+#include "consolelog.h"
+#include "controlclient.h"
+#include "controlload.h"
+#include "controlserver.h"
+#include "rawterminal.h"
+#include "unixsignals.h"
+#include "vminstance.h"
+#include "vminventory.h"
+#include "vmsettings.h"
+#include "vmsupervisor.h"
+#include "resourcesampler.h"
+#include "diskbench.h"
+#include "imageclone.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QTextStream>
+
+#include <memory>
+
+#include <signal.h>
+
+VmrunCli::VmrunCli(const Overrides &overrides, QObject *parent)
+    : QObject(parent)
+    , m_overrides(overrides)
+    , m_root(overrides.root.isEmpty() ? VmSettings::inventoryRoot() : overrides.root)
+{
+}
+
+VmrunCli::~VmrunCli()
+{
+    // ВМ гасим раньше консоли: их последние строки ещё пишутся в лог.
+    // API — ещё раньше: клиенты не увидят наполовину удалённый supervisor
+    delete m_control;
+    delete m_supervisor;
+    // Терминал пользователя — обратно в обычный режим, что бы ни случилось
+    delete m_terminal;
+}
+
+int VmrunCli::start(const QString &command, const QStringList &args)
+{
+    if (command == "list")
+        return listImages();
+    if (command == "run") {
+        if (args.size() != 1) {
+            QTextStream(stderr) << "Использование: vmrun run <имя> [--memory 4G] [--disk путь] [--iso путь] [--tap tapN] [--cpus 4,pin]"
+                                   " [--disk-profile nvme,nocache] [--vnc-port 5901]\n";
+            return 2;
+        }
+        return runVms(args, true);
+    }
+    if (command == "daemon")
+        return runVms(args.isEmpty() ? VmSettings::daemonVms() : args, false);
+    if (command == "clone") {
+        if (args.size() < 2) {
+            QTextStream(stderr) << "Использование: vmrun clone <шаблон> <имя...> [--parallel 2]\n";
+            return 2;
+        }
+        return cloneImages(args.first(), args.mid(1));
+    }
+    if (command == "diskbench") {
+        if (args.size() != 1) {
+            QTextStream(stderr) << "Использование: vmrun diskbench <имя ВМ | образ | каталог> [--test-size 256] [--test-time 5]\n";
+            return 2;
+        }
+        return benchDisk(args.first());
+    }
+    if (command == "ctl")
+        return control(args);
+
+    QTextStream(stderr) << "Неизвестная команда: " << command << "\n";
+    return 2;
+}
+
+// ======================== list ========================
+int VmrunCli::listImages()
+{
+    m_inventory = new VmInventory(this);
+    m_inventory->setRoot(m_root);
+
+    // Кэш отдаётся сразу, но печатаем после перепроверки — скриптам нужен
+    // актуальный список, а не вчерашний
+    auto print = [this]() {
+        QTextStream out(stdout);
+        if (!m_inventory->isRootAvailable()) {
+            QTextStream(stderr) << "Каталог ВМ не найден: " << m_root << "\n";
+            QCoreApplication::exit(1);
+            return;
+        }
+        for (const VmImageInfo &vm : m_inventory->images()) {
+            out << vm.name << '\t'
+                << QString::number(vm.size / 1024.0 / 1024 / 1024, 'f', 2) << "G\t"
+                << QDateTime::fromMSecsSinceEpoch(vm.mtimeMs).toString(Qt::ISODate) << '\t'
+                << vm.imagePath << '\n';
+        }
+        out.flush();
+        QCoreApplication::exit(0);
+    };
+    connect(m_inventory, &VmInventory::scanFinished, this, print);
+    if (!m_inventory->loadCache())
+        m_inventory->refresh();
+    return -1;
+}
+
+// ======================== clone ========================
+// Шаблон — ВМ из каталога или путь к образу. SIGINT отменяет копии:
+// недописанные образы удаляются
+int VmrunCli::cloneImages(const QString &templateVm, const QStringList &names)
+{
+    VmInventory inventory;
+    inventory.setRoot(m_root);
+    const QString source = QFileInfo(templateVm).isFile() ? templateVm : inventory.imagePathFor(templateVm);
+
+    m_cloner = new ImageCloner(this);
+    m_cloner->setMaxParallel(m_overrides.cloneParallel > 0 ? m_overrides.cloneParallel : VmSettings::cloneParallel());
+    int queued = 0;
+    for (const QString &name : names) {
+        QString error;
+        if (!VmInventory::isValidName(name))
+            error = "недопустимое имя";
+        else if (m_cloner->clone(source, inventory.imagePathFor(name), &error))
+            ++queued;
+        if (!error.isEmpty())
+            QTextStream(stderr) << name << ": " << error << '\n';
+    }
+    if (queued == 0)
+        return 1;
+
+    auto nameOf = [](const ImageCloner::Job &job) { return QFileInfo(job.target).dir().dirName(); };
+    auto *ticker = new QTimer(this);
+    connect(ticker, &QTimer::timeout, this, [this, nameOf]() {
+        for (const ImageCloner::Job &job : m_cloner->jobs()) {
+            if (job.state == ImageCloner::State::Running)
+                QTextStream(stderr) << nameOf(job) << ": " << job.percent() << "% " << job.summary() << '\n';
+        }
+    });
+    ticker->start(1000);
+    connect(m_cloner, &ImageCloner::jobFinished, this, [this, nameOf](int id) {
+        const ImageCloner::Job job = m_cloner->job(id);
+        QTextStream(stdout) << nameOf(job) << '\t' << ImageCloner::stateName(job.state) << '\t' << job.summary() << '\n';
+    });
+    connect(m_cloner, &ImageCloner::allFinished, this, [this]() {
+        bool failed = false;
+        for (const ImageCloner::Job &job : m_cloner->jobs())
+            failed = failed || job.state != ImageCloner::State::Done;
+        QCoreApplication::exit(failed ? 1 : 0);
+    });
+
+    m_signals = new UnixSignals({SIGINT, SIGTERM}, this);
+    connect(m_signals, &UnixSignals::received, m_cloner, &ImageCloner::cancelAll);
+    return -1;
+}
+
+// ======================== diskbench ========================
+// Блокирует поток — циклу событий здесь обслуживать нечего
+int VmrunCli::benchDisk(const QString &target)
+{
+    VmInventory inventory;
+    inventory.setRoot(m_root);
+    const QString path = QFileInfo::exists(target) ? target : inventory.imagePathFor(target);
+
+    DiskBench::Options options;
+    options.path = path;
+    options.bytesPerTest = qint64(m_overrides.testSizeMb) << 20;
+    options.maxMsPerTest = m_overrides.testTimeS * 1000;
+    const DiskBench::Report report = DiskBench::run(options, nullptr, [](int done, int total, const QString &step) {
+        if (!step.isEmpty())
+            QTextStream(stderr) << QString("[%1/%2] %3\n").arg(done + 1).arg(total).arg(step);
+    });
+
+    QTextStream out(stdout);
+    out << report.summary() << '\n';
+    if (report.hasRecommendation) {
+        // Готовая строка для --disk-profile: модель — как выбрал бы запуск
+        VmConfig config;
+        config.name = target;
+        config.diskPath = path;
+        inventory.resolveDisk(config);
+        out << "Профиль: " << report.apply(config.diskProfile).toString() << '\n';
+    }
+    return report.error.isEmpty() && report.hasRecommendation ? 0 : 1;
+}
+
+// ======================== run / daemon ========================
+int VmrunCli::runVms(const QStringList &names, bool foreground)
+{
+    m_foreground = foreground;
+    m_console = new ConsoleLog(this);
+    m_supervisor = new VmSupervisor;
+    if (!m_overrides.metricsFile.isEmpty())
+        m_supervisor->sampler()->setPrometheusFile(m_overrides.metricsFile);
+    if (!m_overrides.consoleBackend.isEmpty()) {
+        SerialConsole::Backend backend;
+        if (!SerialConsole::parseBackend(m_overrides.consoleBackend, &backend)) {
+            QTextStream(stderr) << "--console: ожидается nmdm или pty, а не " << m_overrides.consoleBackend << '\n';
+            return 2;
+        }
+        m_supervisor->setConsoleBackend(backend);
+    }
+    m_inventory = new VmInventory(this);
+    m_inventory->setRoot(m_root);
+
+    // Демон без ВМ в списке ждёт команд по сокету
+    if (!foreground)
+        listenControl();
+
+    int started = 0;
+    for (const QString &name : names) {
+        VmConfig config;
+        QString error;
+        if (!prepareConfig(name, &config, &error)) {
+            m_console->message(LogSeverity::Error, name + ": " + error);
+            continue;
+        }
+        VmInstance *vm = m_supervisor->ensureInstance(config);
+        if (!vm)
+            continue;
+        // С API лог новых ВМ подхватывает listenControl()
+        if (!m_control)
+            m_console->follow(vm->log(), foreground ? QString() : name);
+        vm->start();
+        ++started;
+    }
+    if (started == 0 && !m_control) {
+        if (names.isEmpty())
+            QTextStream(stderr) << "Нечего запускать: укажите имена ВМ или daemon/vms в настройках\n";
+        return names.isEmpty() ? 2 : 1;
+    }
+
+    connect(m_supervisor, &VmSupervisor::instanceChanged, this, &VmrunCli::checkFinished);
+    connect(m_supervisor, &VmSupervisor::allStopped, this, [this](int count, qint64 elapsedMs) {
+        m_console->message(LogSeverity::Success, QString("Остановлено ВМ: %1 за %2 мс").arg(count).arg(elapsedMs));
+    });
+
+    m_signals = new UnixSignals({SIGINT, SIGTERM, SIGHUP}, this);
+    connect(m_signals, &UnixSignals::received, this, &VmrunCli::onSignal);
+    return -1;
+}
+
+// Запуски через API берут конфигурацию так же, как daemon по имени; их
+// лог идёт в консоль демона наравне с остальными
+void VmrunCli::listenControl()
+{
+    const QString path = m_overrides.controlSocket.isEmpty() ? VmSettings::controlSocket() : m_overrides.controlSocket;
+    if (path.isEmpty())
+        return;
+    auto *control = new ControlServer(m_supervisor, this);
+    control->setConfigProvider([this](const QString &name, VmConfig *config, QString *error) {
+        return prepareConfig(name, config, error);
+    });
+    QString error;
+    if (!control->listen(path, &error)) {
+        m_console->message(LogSeverity::Warning, "API управления не запущено: " + error);
+        delete control;
+        return;
+    }
+    m_control = control;
+    m_console->message(LogSeverity::Info, "API управления: " + path);
+    connect(m_supervisor, &VmSupervisor::instanceAdded, this, [this](int row) {
+        VmInstance *vm = m_supervisor->at(row);
+        m_console->follow(vm->log(), vm->name());
+    });
+}
+
+bool VmrunCli::prepareConfig(const QString &name, VmConfig *config, QString *error)
+{
+    config->name = name;
+    config->memory = m_overrides.memory;
+    config->diskPath = m_overrides.diskPath;
+    config->isoPath = m_overrides.isoPath;
+    config->tap = m_overrides.tap;
+    VmSettings::loadLaunch(*config);
+
+    if (config->memory.isEmpty()) {
+        *error = "объём памяти не задан: укажите --memory или запустите ВМ один раз из GUI";
+        return false;
+    }
+    if (!VmConfig::normalizeMemory(config->memory, &config->memory, error))
+        return false;
+
+    m_inventory->resolveDisk(*config);
+    VmSettings::apply(*config);
+    if (!m_overrides.cpus.isEmpty() && !CpuConfig::parse(m_overrides.cpus, &config->cpu, error))
+        return false;
+    if (!m_overrides.diskProfile.isEmpty() && !DiskProfile::parse(m_overrides.diskProfile, &config->diskProfile, error))
+        return false;
+    if (m_overrides.vncPort >= 0)
+        config->vncPort = m_overrides.vncPort;
+    if (config->tap.isEmpty())
+        config->tap = m_supervisor->allocateTap();
+    for (VmInstance *other : m_supervisor->instances()) {
+        if (other->isActive() && other->config().tap == config->tap) {
+            *error = config->tap + " уже занят ВМ " + other->name();
+            return false;
+        }
+    }
+    return true;
+}
+
+void VmrunCli::onSignal(int signum)
+{
+    if (signum == SIGHUP && !m_foreground) {
+        // Демон на SIGHUP только отмечается в логе — перечитывать пока нечего
+        m_console->message(LogSeverity::Notice, "SIGHUP получен");
+        return;
+    }
+    if (m_supervisor->activeCount() == 0) {
+        m_stopping = true;
+        checkFinished();
+        return;
+    }
+    if (!m_stopping) {
+        m_console->message(LogSeverity::Warning, "Сигнал получен — останавливаем ВМ");
+        m_stopping = true;
+        m_supervisor->stopAll();
+        return;
+    }
+
+    // stop() на уже останавливаемой ВМ переводит её на следующую ступень
+    m_console->message(LogSeverity::Warning, "Повторный сигнал — ускоряем остановку");
+    for (VmInstance *vm : m_supervisor->instances()) {
+        if (vm->isActive())
+            vm->stop();
+    }
+}
+
+// run завершается вместе со своей ВМ; daemon — только по сигналу
+void VmrunCli::checkFinished()
+{
+    if (m_supervisor->activeCount() > 0)
+        return;
+    if (!m_foreground && !m_stopping)
+        return;
+
+    bool failed = false;
+    for (VmInstance *vm : m_supervisor->instances())
+        failed = failed || vm->state() == VmInstance::State::Failed;
+    QCoreApplication::exit(failed ? 1 : 0);
+}
+
+// ======================== ctl ========================
+// Ответ сервера — одной строкой JSON в stdout (для jq и скриптов); watch
+// печатает так же каждое событие до SIGINT
+int VmrunCli::control(const QStringList &args)
+{
+    const QString usage = "Использование: vmrun ctl list | status <имя> | start|stop|restart <имя...> | log <имя> [--lines 100]"
+                          " | watch [имя...] | console <имя> | load [--clients 16] [--pipeline 8] [--duration 5] [--socket путь]\n";
+    const QString op = args.value(0);
+    const QStringList names = args.mid(1);
+    const QString path = m_overrides.controlSocket.isEmpty() ? VmSettings::controlSocket() : m_overrides.controlSocket;
+    if (path.isEmpty()) {
+        QTextStream(stderr) << "Сокет API управления не задан: укажите --socket\n";
+        return 2;
+    }
+
+    if (op == "load") {
+        ControlLoad::Options options;
+        options.path = path;
+        options.clients = m_overrides.loadClients;
+        options.pipeline = m_overrides.loadPipeline;
+        options.durationMs = m_overrides.loadSeconds * 1000;
+        m_load = new ControlLoad(options, this);
+        connect(m_load, &ControlLoad::finished, this, [this]() {
+            const ControlLoad::Result &result = m_load->result();
+            QTextStream(stdout) << result.summary() << '\n';
+            if (!result.error.isEmpty())
+                QTextStream(stderr) << "Ошибка: " << result.error << '\n';
+            QCoreApplication::exit(result.error.isEmpty() && result.errors == 0 ? 0 : 1);
+        });
+        QTextStream(stderr) << QString("Нагрузка на %1: %2 соединений по %3 запросов в полёте, %4 с\n")
+                                   .arg(path).arg(options.clients).arg(options.pipeline).arg(m_overrides.loadSeconds);
+        m_load->start();
+        return -1;
+    }
+    if (op == "console" && names.size() == 1)
+        return attachConsole(path, names.first());
+
+    QJsonObject request;
+    const bool watching = op == "watch";
+    if (op == "list" && names.isEmpty()) {
+        request.insert("op", op);
+    } else if ((op == "status" || op == "log") && names.size() == 1) {
+        request = QJsonObject {{"op", op}, {"vm", names.first()}};
+        if (op == "log")
+            request.insert("lines", m_overrides.logLines);
+    } else if ((op == "start" || op == "stop" || op == "restart") && !names.isEmpty()) {
+        // Несколько ВМ — одной пачкой
+        QJsonArray requests;
+        for (const QString &name : names)
+            requests.append(QJsonObject {{"op", op}, {"vm", name}});
+        request = names.size() == 1 ? requests.first().toObject() : QJsonObject {{"op", "batch"}, {"requests", requests}};
+    } else if (watching) {
+        request = QJsonObject {{"op", "subscribe"}, {"status", true}, {"log", true}, {"vms", QJsonArray::fromStringList(names)}};
+    } else {
+        QTextStream(stderr) << usage;
+        return 2;
+    }
+
+    auto print = [](const QJsonObject &message) {
+        QTextStream(stdout) << QJsonDocument(message).toJson(QJsonDocument::Compact) << '\n';
+    };
+    m_client = new ControlClient(this);
+    connect(m_client, &ControlClient::connected, this, [this, request]() { m_client->send(request); });
+    connect(m_client, &ControlClient::replied, this, [print, watching](qint64, const QJsonObject &reply) {
+        print(reply);
+        bool ok = reply.value("ok").toBool();
+        for (const QJsonValue &result : reply.value("results").toArray())
+            ok = ok && result.toObject().value("ok").toBool();
+        if (!watching || !ok)
+            QCoreApplication::exit(ok ? 0 : 1);
+    });
+    connect(m_client, &ControlClient::event, this, print);
+    connect(m_client, &ControlClient::disconnected, this, [path](const QString &error) {
+        QTextStream(stderr) << path << ": " << (error.isEmpty() ? QString("сервер закрыл соединение") : error) << '\n';
+        QCoreApplication::exit(1);
+    });
+    if (watching) {
+        m_signals = new UnixSignals({SIGINT, SIGTERM}, this);
+        connect(m_signals, &UnixSignals::received, this, []() { QCoreApplication::exit(0); });
+    }
+    m_client->connectToServer(path);
+    return -1;
+}
+
+// Сеанс на com1: история — сразу, чтобы было видно, что на экране; дальше
+// события console в stdout как есть, нажатия — op input. Управляющие
+// последовательности гостя не разбираются: их рисует терминал пользователя
+int VmrunCli::attachConsole(const QString &path, const QString &name)
+{
+    auto openRequest = std::make_shared<qint64>(0);
+    m_client = new ControlClient(this);
+    connect(m_client, &ControlClient::connected, this, [this, name, openRequest]() {
+        *openRequest = m_client->send(QJsonObject {{"op", "console"}, {"vm", name}});
+    });
+    connect(m_client, &ControlClient::replied, this, [this, name, openRequest](qint64 id, const QJsonObject &reply) {
+        // Отказ в одном вводе (гость не читает) сеанс не прерывает
+        if (id != *openRequest) {
+            if (!reply.value("ok").toBool())
+                QTextStream(stderr) << "\r\n[vmrun] " << reply.value("error").toString() << "\r\n";
+            return;
+        }
+        if (!reply.value("ok").toBool()) {
+            delete m_terminal;
+            m_terminal = nullptr;
+            QTextStream(stderr) << name << ": " << reply.value("error").toString() << "\r\n";
+            QCoreApplication::exit(1);
+            return;
+        }
+        if (reply.contains("data"))
+            RawTerminal::write(QByteArray::fromBase64(reply.value("data").toString().toLatin1()));
+    });
+    connect(m_client, &ControlClient::event, this, [name](const QJsonObject &event) {
+        if (event.value("event").toString() == "console" && event.value("vm").toString() == name)
+            RawTerminal::write(QByteArray::fromBase64(event.value("data").toString().toLatin1()));
+    });
+    connect(m_client, &ControlClient::disconnected, this, [this, path](const QString &error) {
+        delete m_terminal;
+        m_terminal = nullptr;
+        QTextStream(stderr) << "\n" << path << ": " << (error.isEmpty() ? QString("сервер закрыл соединение") : error) << '\n';
+        QCoreApplication::exit(1);
+    });
+
+    m_terminal = new RawTerminal(this);
+    connect(m_terminal, &RawTerminal::input, this, [this, name](const QByteArray &data) {
+        if (m_client->isConnected())
+            m_client->send(QJsonObject {{"op", "input"}, {"vm", name}, {"data", QString::fromLatin1(data.toBase64())}});
+    });
+    connect(m_terminal, &RawTerminal::detachRequested, this, []() {
+        QCoreApplication::exit(0);
+    });
+    m_signals = new UnixSignals({SIGINT, SIGTERM}, this);
+    connect(m_signals, &UnixSignals::received, this, []() { QCoreApplication::exit(0); });
+
+    QTextStream(stderr) << "Консоль " << name << " (com1); выход — Ctrl+]\r\n";
+    m_client->connectToServer(path);
+    return -1;
+}
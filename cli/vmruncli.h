@@ -0,0 +1,92 @@
+#ifndef VMRUNCLI_H
+#define VMRUNCLI_H
+
+#include <QObject>
+#include <QStringList>
+
+#include "vmconfig.h"
+
+class VmSupervisor;
+class VmInventory;
+class ConsoleLog;
+class UnixSignals;
+class ImageCloner;
+class ControlServer;
+class ControlClient;
+class ControlLoad;
+class RawTerminal;
+
+// Команды vmrun без GUI:
+//   list                 — образы ВМ в каталоге
+//   run <имя>            — одна ВМ на переднем плане, лог в stdout
+//   daemon [имя...]      — несколько ВМ под надзором до SIGTERM; слушает
+//                          сокет API управления (ControlServer)
+//   clone <шаблон> <имя...> — новые ВМ из образа-шаблона (см. ImageCloner)
+//   diskbench <имя|путь> — замер пула хранения образа (см. DiskBench)
+//   ctl <операция> ...   — запрос к API управления демона или окна;
+//                          ctl load — нагрузочный тест API (см. ControlLoad),
+//                          ctl console — com1 гостя в этом терминале (RawTerminal)
+// run и daemon останавливают ВМ по SIGINT/SIGTERM штатной цепочкой
+// остановки; повторный сигнал — следующая ступень.
+class VmrunCli : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Параметры из командной строки; пустые берутся из сохранённых настроек
+    struct Overrides {
+        QString root;
+        QString memory;
+        QString diskPath;
+        QString isoPath;
+        QString tap;
+        QString cpus;         // формат CpuConfig::parse; пусто — из настроек
+        QString diskProfile;  // формат DiskProfile::parse; пусто — из настроек
+        int vncPort = -1;     // -1 — из настроек, 0 — первый свободный
+        QString consoleBackend;  // nmdm | pty; пусто — из настроек
+        int testSizeMb = 256; // diskbench
+        int testTimeS = 5;
+        int cloneParallel = 0;  // 0 — из настроек
+        QString metricsFile;  // Prometheus textfile; пусто — из настроек
+        QString controlSocket;  // пусто — VmSettings::controlSocket()
+        int logLines = 100;     // ctl log
+        int loadClients = 16;   // ctl load
+        int loadPipeline = 8;
+        int loadSeconds = 5;
+    };
+
+    explicit VmrunCli(const Overrides &overrides, QObject *parent = nullptr);
+    ~VmrunCli() override;
+
+    // Код выхода, если команда уже завершилась; -1 — нужен цикл событий,
+    // выход через QCoreApplication::exit()
+    int start(const QString &command, const QStringList &args);
+
+private:
+    int listImages();
+    int benchDisk(const QString &target);
+    int cloneImages(const QString &templateVm, const QStringList &names);
+    int runVms(const QStringList &names, bool foreground);
+    int control(const QStringList &args);
+    int attachConsole(const QString &path, const QString &name);
+    void listenControl();
+    bool prepareConfig(const QString &name, VmConfig *config, QString *error);
+    void onSignal(int signum);
+    void checkFinished();
+
+    Overrides m_overrides;
+    QString m_root;
+    VmSupervisor *m_supervisor = nullptr;
+    VmInventory *m_inventory = nullptr;
+    ConsoleLog *m_console = nullptr;
+    UnixSignals *m_signals = nullptr;
+    ImageCloner *m_cloner = nullptr;
+    ControlServer *m_control = nullptr;
+    ControlClient *m_client = nullptr;
+    ControlLoad *m_load = nullptr;
+    RawTerminal *m_terminal = nullptr;
+    bool m_foreground = false;
+    bool m_stopping = false;
+};
+
+#endif // VMRUNCLI_H
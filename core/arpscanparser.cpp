@@ -0,0 +1,106 @@
+#include "arpscanparser.h"
+
+#include <QRegularExpression>
+
+namespace {
+
+// IP, MAC и остаток строки (производитель, возможно с "(DUP: n)")
+const QRegularExpression &entryPattern()
+{
+    static const QRegularExpression re = []() {
+        QRegularExpression pattern(R"(^(\d{1,3})\.(\d{1,3})\.(\d{1,3})\.(\d{1,3})\s+)"
+                                   R"(([0-9A-Fa-f]{2}(?::[0-9A-Fa-f]{2}){5})\s*(.*)$)");
+        pattern.optimize();
+        return pattern;
+    }();
+    return re;
+}
+
+const QRegularExpression &duplicatePattern()
+{
+    static const QRegularExpression re = []() {
+        QRegularExpression pattern(R"(\s*\(DUP: \d+\)\s*$)");
+        pattern.optimize();
+        return pattern;
+    }();
+    return re;
+}
+
+} // namespace
+
+void ArpScanParser::feed(const QByteArray &chunk, QVector<ArpEntry> *entries, QStringList *notes)
+{
+    int start = 0;
+    int nl;
+    while ((nl = chunk.indexOf('\n', start)) >= 0) {
+        if (m_partial.isEmpty()) {
+            parseBytes(chunk.mid(start, nl - start), entries, notes);
+        } else {
+            m_partial += chunk.mid(start, nl - start);
+            parseBytes(m_partial, entries, notes);
+            m_partial.clear();
+        }
+        start = nl + 1;
+    }
+    m_partial += chunk.mid(start);
+
+    // Строк такой длины arp-scan не пишет — не копим мусор бесконечно
+    if (m_partial.size() >= MaxLineLength) {
+        parseBytes(m_partial, entries, notes);
+        m_partial.clear();
+    }
+}
+
+void ArpScanParser::finish(QVector<ArpEntry> *entries, QStringList *notes)
+{
+    if (!m_partial.isEmpty())
+        parseBytes(m_partial, entries, notes);
+    m_partial.clear();
+}
+
+void ArpScanParser::parseBytes(const QByteArray &bytes, QVector<ArpEntry> *entries, QStringList *notes)
+{
+    QByteArray line = bytes;
+    if (line.endsWith('\r'))
+        line.chop(1);
+    if (line.trimmed().isEmpty())
+        return;
+    ++m_lines;
+
+    const QString text = QString::fromUtf8(line);
+    // Записи начинаются с цифры — служебные строки в регулярку не гоняем
+    ArpEntry entry;
+    if (line.at(0) >= '0' && line.at(0) <= '9' && parseLine(text, &entry)) {
+        entries->append(entry);
+        return;
+    }
+    if (notes)
+        notes->append(text);
+}
+
+bool ArpScanParser::parseLine(const QString &line, ArpEntry *entry)
+{
+    const QRegularExpressionMatch match = entryPattern().match(line);
+    if (!match.hasMatch())
+        return false;
+
+    quint32 ipValue = 0;
+    for (int i = 1; i <= 4; ++i) {
+        const uint octet = match.capturedRef(i).toUInt();
+        if (octet > 255)
+            return false;
+        ipValue = (ipValue << 8) | octet;
+    }
+
+    QString vendor = match.captured(6);
+    const int dup = vendor.indexOf(duplicatePattern());
+    entry->duplicate = dup >= 0;
+    if (entry->duplicate)
+        vendor.truncate(dup);
+
+    entry->ip = line.left(match.capturedEnd(4));
+    entry->mac = match.captured(5).toLower();
+    entry->vendor = vendor.trimmed();
+    entry->ipValue = ipValue;
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef ARPSCANPARSER_H
+#define ARPSCANPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Одна строка ответа arp-scan: "192.168.1.10\t58:9c:fc:12:34:56\tVendor"
+struct ArpEntry {
+    QString ip;
+    QString mac;        // в нижнем регистре, через ':'
+    QString vendor;
+    quint32 ipValue = 0;  // для сортировки по адресу, а не по строке
+    bool duplicate = false;  // arp-scan пометил "(DUP: n)"
+};
+
+// Потоковый разбор вывода arp-scan: кормится кусками из readyRead, хвост
+// без перевода строки ждёт следующего куска. Шаблоны компилируются один раз.
+class ArpScanParser
+{
+public:
+    static constexpr int MaxLineLength = 4096;
+
+    // Разобранные записи дописываются в entries, служебные строки
+    // ("Interface: ...", "Starting arp-scan", итоги) — в notes
+    void feed(const QByteArray &chunk, QVector<ArpEntry> *entries, QStringList *notes = nullptr);
+    // Конец вывода: разобрать строку без '\n', если она осталась
+    void finish(QVector<ArpEntry> *entries, QStringList *notes = nullptr);
+    void reset() { m_partial.clear(); m_lines = 0; }
+
+    quint64 linesParsed() const { return m_lines; }
+
+    // Разбор одной строки; false — это не запись об узле
+    static bool parseLine(const QString &line, ArpEntry *entry);
+
+private:
+    void parseBytes(const QByteArray &line, QVector<ArpEntry> *entries, QStringList *notes);
+
+    QByteArray m_partial;
+    quint64 m_lines = 0;
+};
+
+#endif // ARPSCANPARSER_H
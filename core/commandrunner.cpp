@@ -0,0 +1,239 @@
+#include "commandrunner.h"
+
+#include <QTimer>
+#include <QDir>
+#include <QFileInfo>
+
+// ======================== CommandSpec / CommandResult ========================
+CommandSpec CommandSpec::make(const QString &program, const QStringList &arguments, int timeoutMs)
+{
+    CommandSpec spec;
+    spec.program = program;
+    spec.arguments = arguments;
+    spec.timeoutMs = timeoutMs;
+    return spec;
+}
+
+CommandSpec CommandSpec::doas(const QStringList &arguments, int timeoutMs)
+{
+    return make("doas", arguments, timeoutMs);
+}
+
+QString CommandSpec::statsKey() const
+{
+    if (program == "doas" && !arguments.isEmpty())
+        return program + " " + arguments.first();
+    return program;
+}
+
+QString CommandSpec::toString() const
+{
+    return arguments.isEmpty() ? program : program + " " + arguments.join(" ");
+}
+
+bool CommandResult::ok() const
+{
+    return !failedToStart && !timedOut && !canceled
+        && exitStatus == QProcess::NormalExit && exitCode == 0;
+}
+
+QString CommandResult::errorString() const
+{
+    if (failedToStart) return QString("не удалось запустить %1").arg(spec.program);
+    if (timedOut)      return QString("таймаут %1 мс").arg(spec.timeoutMs);
+    if (canceled)      return "отменено";
+    if (exitStatus != QProcess::NormalExit) return "аварийное завершение";
+    if (exitCode != 0) {
+        const QString err = QString::fromLocal8Bit(standardError).trimmed();
+        return err.isEmpty() ? QString("код %1").arg(exitCode)
+                             : QString("код %1: %2").arg(exitCode).arg(err);
+    }
+    return QString();
+}
+
+// ======================== CommandRunner ========================
+CommandRunner::CommandRunner(QObject *parent)
+    : QObject(parent)
+    , m_toolDirectory(qEnvironmentVariable("VMRUN_TOOL_DIR"))
+{
+}
+
+CommandRunner::~CommandRunner()
+{
+    m_chains.clear();
+    for (Job &job : m_jobs) {
+        job.process->disconnect(this);
+        job.process->kill();
+    }
+    m_jobs.clear();
+}
+
+quint64 CommandRunner::run(const CommandSpec &spec, QObject *context, CommandCallback callback)
+{
+    return startJob(spec, context, std::move(callback), 0);
+}
+
+quint64 CommandRunner::runChain(const QList<CommandSpec> &steps, QObject *context,
+                                CommandCallback onStep, ChainCallback done)
+{
+    const quint64 id = m_nextId++;
+    Chain chain;
+    chain.steps = steps;
+    chain.context = context;
+    chain.hasContext = context != nullptr;
+    chain.onStep = std::move(onStep);
+    chain.done = std::move(done);
+    m_chains.insert(id, chain);
+
+    advanceChain(id, nullptr);
+    return id;
+}
+
+void CommandRunner::cancel(quint64 id)
+{
+    auto chainIt = m_chains.find(id);
+    if (chainIt != m_chains.end())
+        id = chainIt->currentJob;
+
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end())
+        return;
+    it->canceled = true;
+    it->process->kill();  // дальше — обычный путь через finished()
+}
+
+void CommandRunner::cancelAll()
+{
+    const QList<quint64> ids = m_jobs.keys();
+    for (quint64 id : ids)
+        cancel(id);
+}
+
+bool CommandRunner::startDetached(const CommandSpec &spec)
+{
+    return QProcess::startDetached(resolveProgram(spec.program), spec.arguments);
+}
+
+QString CommandRunner::resolveProgram(const QString &program) const
+{
+    if (m_toolDirectory.isEmpty() || program.contains('/'))
+        return program;
+    const QFileInfo stub(QDir(m_toolDirectory).filePath(program));
+    return (stub.isFile() && stub.isExecutable()) ? stub.absoluteFilePath() : program;
+}
+
+quint64 CommandRunner::startJob(const CommandSpec &spec, QObject *context,
+                                CommandCallback callback, quint64 chainId)
+{
+    const quint64 id = m_nextId++;
+
+    auto *process = new QProcess(this);
+    process->setProgram(resolveProgram(spec.program));
+    process->setArguments(spec.arguments);
+
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, id]() { finishJob(id, false); });
+    connect(process, &QProcess::errorOccurred, this, [this, id](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            finishJob(id, true);
+    });
+
+    Job job;
+    job.spec = spec;
+    job.process = process;
+    job.context = context;
+    job.hasContext = context != nullptr;
+    job.callback = std::move(callback);
+    job.chainId = chainId;
+    if (spec.timeoutMs > 0) {
+        job.timeout = new QTimer(process);
+        job.timeout->setSingleShot(true);
+        job.timeout->setInterval(spec.timeoutMs);
+        connect(job.timeout, &QTimer::timeout, this, [this, id]() {
+            auto it = m_jobs.find(id);
+            if (it == m_jobs.end())
+                return;
+            it->timedOut = true;
+            it->process->kill();
+        });
+    }
+    m_jobs.insert(id, job);
+    if (chainId)
+        m_chains[chainId].currentJob = id;
+
+    m_jobs[id].clock.start();
+    process->start();
+
+    // start() мог синхронно завершиться ошибкой — тогда задания уже нет
+    auto it = m_jobs.find(id);
+    if (it != m_jobs.end() && it->timeout)
+        it->timeout->start();
+    return id;
+}
+
+void CommandRunner::finishJob(quint64 id, bool failedToStart)
+{
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end())
+        return;
+    const Job job = it.value();
+    m_jobs.erase(it);
+
+    CommandResult result;
+    result.spec = job.spec;
+    result.elapsedMs = job.clock.elapsed();
+    result.failedToStart = failedToStart;
+    result.timedOut = job.timedOut;
+    result.canceled = job.canceled;
+    if (!failedToStart) {
+        result.exitCode = job.process->exitCode();
+        result.exitStatus = job.process->exitStatus();
+        result.standardOutput = job.process->readAllStandardOutput();
+        result.standardError = job.process->readAllStandardError();
+    }
+    job.process->disconnect(this);
+    job.process->deleteLater();
+
+    if (!failedToStart && !job.canceled)
+        m_stats[job.spec.statsKey()].record(result.elapsedMs);
+
+    emit commandFinished(result);
+
+    if (job.callback && (!job.hasContext || job.context))
+        job.callback(result);
+    if (job.chainId)
+        advanceChain(job.chainId, &result);
+}
+
+void CommandRunner::advanceChain(quint64 chainId, const CommandResult *previous)
+{
+    auto it = m_chains.find(chainId);
+    if (it == m_chains.end())
+        return;
+
+    bool alive = !it->hasContext || it->context;
+    bool stop = !alive;
+    if (previous) {
+        if (alive && it->onStep) {
+            const CommandCallback onStep = it->onStep;
+            onStep(*previous);
+            // onStep мог отменить цепочку или удалить context
+            it = m_chains.find(chainId);
+            if (it == m_chains.end())
+                return;
+            alive = !it->hasContext || it->context;
+        }
+        stop = !alive || previous->canceled || (!previous->ok() && !previous->spec.allowFailure);
+    }
+
+    if (stop || it->next >= it->steps.size()) {
+        const Chain chain = it.value();
+        m_chains.erase(it);
+        if (alive && chain.done)
+            chain.done(!stop, previous ? *previous : CommandResult());
+        return;
+    }
+
+    const CommandSpec next = it->steps.at(it->next++);
+    startJob(next, nullptr, CommandCallback(), chainId);
+}
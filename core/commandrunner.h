@@ -0,0 +1,128 @@
+#ifndef COMMANDRUNNER_H
+#define COMMANDRUNNER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QPointer>
+#include <QHash>
+#include <QMap>
+#include <QElapsedTimer>
+#include <functional>
+
+#include "latencyhistogram.h"
+
+class QTimer;
+
+// Описание одной внешней команды (doas/ifconfig/bhyvectl ...)
+struct CommandSpec {
+    static constexpr int DefaultTimeoutMs = 10000;
+
+    QString program;
+    QStringList arguments;
+    int timeoutMs = DefaultTimeoutMs;
+    bool allowFailure = false;  // в цепочке: ненулевой код не прерывает следующие шаги
+
+    static CommandSpec make(const QString &program, const QStringList &arguments,
+                            int timeoutMs = DefaultTimeoutMs);
+    static CommandSpec doas(const QStringList &arguments, int timeoutMs = DefaultTimeoutMs);
+
+    // Ключ для статистики задержек: "doas ifconfig", "doas bhyvectl"
+    QString statsKey() const;
+    QString toString() const;
+};
+
+struct CommandResult {
+    CommandSpec spec;
+    int exitCode = -1;
+    QProcess::ExitStatus exitStatus = QProcess::NormalExit;
+    QByteArray standardOutput;
+    QByteArray standardError;
+    qint64 elapsedMs = 0;
+    bool failedToStart = false;
+    bool timedOut = false;
+    bool canceled = false;
+
+    bool ok() const;
+    QString errorString() const;
+};
+
+using CommandCallback = std::function<void(const CommandResult &)>;
+using ChainCallback = std::function<void(bool ok, const CommandResult &last)>;
+
+// Асинхронный запуск внешних команд без waitForFinished() в GUI-потоке.
+// Каждая команда — отдельный QProcess с таймаутом; результат приходит в callback
+// в потоке событий. Если context уничтожен раньше — callback не вызывается.
+//
+// Программа подменяется каталогом-заглушкой: при заданном toolDirectory
+// (или переменной окружения VMRUN_TOOL_DIR) "doas" запускается как
+// <toolDirectory>/doas, если такой исполняемый файл существует.
+class CommandRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CommandRunner(QObject *parent = nullptr);
+    ~CommandRunner() override;
+
+    quint64 run(const CommandSpec &spec, QObject *context, CommandCallback callback);
+
+    // Последовательная цепочка: шаг N+1 стартует из continuation шага N.
+    // onStep вызывается после каждого шага, done — один раз в конце
+    // (ok == false, если шаг без allowFailure упал или цепочку отменили).
+    quint64 runChain(const QList<CommandSpec> &steps, QObject *context,
+                     CommandCallback onStep, ChainCallback done);
+
+    // Отмена убивает процесс; callback получает canceled == true
+    void cancel(quint64 id);
+    void cancelAll();
+    int pendingCount() const { return m_jobs.size(); }
+
+    // Для завершения приложения: запустить и не ждать
+    bool startDetached(const CommandSpec &spec);
+
+    void setToolDirectory(const QString &dir) { m_toolDirectory = dir; }
+    QString toolDirectory() const { return m_toolDirectory; }
+    QString resolveProgram(const QString &program) const;
+
+    QMap<QString, LatencyHistogram> latencyStats() const { return m_stats; }
+    void resetLatencyStats() { m_stats.clear(); }
+
+signals:
+    void commandFinished(const CommandResult &result);
+
+private:
+    struct Job {
+        CommandSpec spec;
+        QProcess *process = nullptr;
+        QTimer *timeout = nullptr;
+        QPointer<QObject> context;
+        bool hasContext = false;
+        CommandCallback callback;
+        QElapsedTimer clock;
+        bool timedOut = false;
+        bool canceled = false;
+        quint64 chainId = 0;
+    };
+
+    struct Chain {
+        QList<CommandSpec> steps;
+        int next = 0;
+        QPointer<QObject> context;
+        bool hasContext = false;
+        CommandCallback onStep;
+        ChainCallback done;
+        quint64 currentJob = 0;
+    };
+
+    quint64 startJob(const CommandSpec &spec, QObject *context, CommandCallback callback, quint64 chainId);
+    void finishJob(quint64 id, bool failedToStart);
+    void advanceChain(quint64 chainId, const CommandResult *previous);
+
+    quint64 m_nextId = 1;
+    QHash<quint64, Job> m_jobs;
+    QHash<quint64, Chain> m_chains;
+    QMap<QString, LatencyHistogram> m_stats;
+    QString m_toolDirectory;
+};
+
+#endif // COMMANDRUNNER_H
@@ -0,0 +1,66 @@
+#include "controlclient.h"
+
+#include <QLocalSocket>
+
+ControlClient::ControlClient(QObject *parent)
+    : QObject(parent)
+    , m_socket(new QLocalSocket(this))
+{
+    connect(m_socket, &QLocalSocket::connected, this, &ControlClient::connected);
+    connect(m_socket, &QLocalSocket::readyRead, this, &ControlClient::onReadyRead);
+    connect(m_socket, &QLocalSocket::disconnected, this, [this]() { emit disconnected(m_error); });
+    connect(m_socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError error) {
+        // Ошибка соединения сообщается с disconnected(); не подключились — сразу
+        if (error != QLocalSocket::PeerClosedError)
+            m_error = m_socket->errorString();
+        if (m_socket->state() == QLocalSocket::UnconnectedState)
+            emit disconnected(m_error);
+    });
+}
+
+ControlClient::~ControlClient() = default;
+
+void ControlClient::connectToServer(const QString &path)
+{
+    m_frames = ControlFrames();
+    m_pending = 0;
+    m_error.clear();
+    m_socket->connectToServer(path);
+}
+
+void ControlClient::disconnectFromServer()
+{
+    m_socket->disconnectFromServer();
+}
+
+bool ControlClient::isConnected() const
+{
+    return m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+qint64 ControlClient::send(QJsonObject request)
+{
+    const qint64 id = m_nextId++;
+    request.insert("id", double(id));
+    m_socket->write(ControlFrames::encode(request));
+    ++m_pending;
+    return id;
+}
+
+void ControlClient::onReadyRead()
+{
+    m_frames.feed(m_socket->readAll());
+    QJsonObject message;
+    while (m_frames.next(&message)) {
+        if (message.contains("event")) {
+            emit event(message);
+        } else {
+            --m_pending;
+            emit replied(qint64(message.value("id").toDouble()), message);
+        }
+    }
+    if (!m_frames.error().isEmpty()) {
+        m_error = "поток от сервера испорчен: " + m_frames.error();
+        m_socket->abort();
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef CONTROLCLIENT_H
+#define CONTROLCLIENT_H
+
+#include <QObject>
+#include <QJsonObject>
+
+#include "controlprotocol.h"
+
+class QLocalSocket;
+
+// Клиент API управления (ControlServer): vmrun ctl, нагрузочный тест и
+// bench. Запросы можно слать, не дожидаясь ответов, — сервер отвечает по
+// порядку, ответ находится по id.
+class ControlClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ControlClient(QObject *parent = nullptr);
+    ~ControlClient() override;
+
+    void connectToServer(const QString &path);
+    void disconnectFromServer();
+    bool isConnected() const;
+
+    // id запроса (ставится сам); ответ — replied()
+    qint64 send(QJsonObject request);
+    int pendingCount() const { return m_pending; }
+
+signals:
+    void connected();
+    void replied(qint64 id, const QJsonObject &reply);
+    void event(const QJsonObject &event);
+    // Пустая строка — сервер закрыл соединение штатно
+    void disconnected(const QString &error);
+
+private:
+    void onReadyRead();
+
+    QLocalSocket *m_socket;
+    ControlFrames m_frames;
+    QString m_error;
+    qint64 m_nextId = 1;
+    int m_pending = 0;
+};
+
+#endif // CONTROLCLIENT_H
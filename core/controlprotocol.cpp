@@ -0,0 +1,56 @@
+#include "controlprotocol.h"
+
+#include <QJsonDocument>
+#include <QtEndian>
+
+QByteArray ControlFrames::encode(const QJsonObject &message)
+{
+    return frame(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+QByteArray ControlFrames::frame(const QByteArray &json)
+{
+    QByteArray out(HeaderBytes, Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(json.size()), out.data());
+    out += json;
+    return out;
+}
+
+void ControlFrames::feed(const QByteArray &data)
+{
+    // Разобранное начало выбрасываем, когда его больше половины буфера —
+    // а не после каждого кадра: пачка мелких запросов не двигает память
+    if (m_offset > 0 && m_offset * 2 >= m_buffer.size()) {
+        m_buffer.remove(0, m_offset);
+        m_offset = 0;
+    }
+    m_buffer += data;
+}
+
+bool ControlFrames::next(QJsonObject *message)
+{
+    if (!m_error.isEmpty() || buffered() < HeaderBytes)
+        return false;
+    const quint32 length = qFromBigEndian<quint32>(m_buffer.constData() + m_offset);
+    if (length == 0 || length > quint32(MaxFrameBytes)) {
+        m_error = QString("недопустимая длина кадра: %1").arg(length);
+        return false;
+    }
+    if (buffered() < HeaderBytes + int(length))
+        return false;
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(
+        QByteArray::fromRawData(m_buffer.constData() + m_offset + HeaderBytes, int(length)), &parseError);
+    m_offset += HeaderBytes + int(length);
+    if (m_offset == m_buffer.size()) {
+        m_buffer.clear();
+        m_offset = 0;
+    }
+    if (!document.isObject()) {
+        m_error = document.isNull() ? "JSON: " + parseError.errorString() : "кадр — не JSON-объект";
+        return false;
+    }
+    *message = document.object();
+    return true;
+}
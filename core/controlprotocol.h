@@ -0,0 +1,39 @@
+#ifndef CONTROLPROTOCOL_H
+#define CONTROLPROTOCOL_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+// Кадры API управления (ControlServer, ControlClient): 4 байта длины
+// (big-endian) и JSON-объект в UTF-8 без перевода строки. Запрос —
+// {"id": 7, "op": "start", "vm": "web1"}, ответ — {"id": 7, "ok": true, ...}
+// или {"id": 7, "ok": false, "error": "..."}; события подписки приходят
+// без id: {"event": "status", ...}. Операции — см. ControlServer.
+//
+// Разбор без ввода-вывода: байты из сокета — в feed(), готовые кадры —
+// из next(). Длина проверяется до чтения тела, так что чужой или
+// испорченный поток не раздувает буфер.
+class ControlFrames
+{
+public:
+    static constexpr int HeaderBytes = 4;
+    static constexpr int MaxFrameBytes = 16 << 20;
+
+    static QByteArray encode(const QJsonObject &message);
+    // json — уже сериализованный объект (события рассылаются одной копией)
+    static QByteArray frame(const QByteArray &json);
+
+    void feed(const QByteArray &data);
+    // false — полного кадра пока нет или поток испорчен (тогда error() не пуст)
+    bool next(QJsonObject *message);
+    QString error() const { return m_error; }
+    int buffered() const { return m_buffer.size() - m_offset; }
+
+private:
+    QByteArray m_buffer;
+    int m_offset = 0;  // начало необработанного; буфер сдвигается только целиком
+    QString m_error;
+};
+
+#endif // CONTROLPROTOCOL_H
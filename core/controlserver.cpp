@@ -0,0 +1,541 @@
+#include "controlserver.h"
+#include "vmsupervisor.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <utility>
+
+namespace {
+
+constexpr int ProbeTimeoutMs = 200;
+constexpr int MaxPendingConnections = 1024;
+
+QString severityKey(LogSeverity severity)
+{
+    switch (severity) {
+    case LogSeverity::Info:    return "info";
+    case LogSeverity::Notice:  return "notice";
+    case LogSeverity::Command: return "command";
+    case LogSeverity::Success: return "success";
+    case LogSeverity::Warning: return "warning";
+    case LogSeverity::Error:   return "error";
+    case LogSeverity::Stdout:  return "stdout";
+    case LogSeverity::Stderr:  return "stderr";
+    case LogSeverity::Serial:  return "serial";
+    }
+    return QString();
+}
+
+// Строки [from, to) лога; seq в JSON — double, до 2^53 хватит
+QJsonArray logArray(const LogBuffer *log, quint64 from, quint64 to)
+{
+    QJsonArray lines;
+    for (quint64 seq = from; seq < to; ++seq) {
+        const LogLine &line = log->lineAt(seq);
+        lines.append(QJsonObject {
+            {"seq", double(seq)},
+            {"time", double(line.timestampMs)},
+            {"severity", severityKey(line.severity)},
+            {"text", line.text},
+        });
+    }
+    return lines;
+}
+
+QJsonObject failure(const QString &error)
+{
+    return QJsonObject {{"ok", false}, {"error", error}};
+}
+
+} // namespace
+
+ControlServer::ControlServer(VmSupervisor *supervisor, QObject *parent)
+    : QObject(parent)
+    , m_supervisor(supervisor)
+{
+    m_pushTimer.setSingleShot(true);
+    m_pushTimer.setInterval(PushIntervalMs);
+    connect(&m_pushTimer, &QTimer::timeout, this, &ControlServer::pushStatus);
+
+    for (VmInstance *vm : m_supervisor->instances())
+        watch(vm);
+    connect(m_supervisor, &VmSupervisor::instanceAdded, this, [this](int row) { watch(m_supervisor->at(row)); });
+    connect(m_supervisor, &VmSupervisor::instanceChanged, this, &ControlServer::onInstanceChanged);
+    connect(m_supervisor, &VmSupervisor::instanceAboutToBeRemoved, this, &ControlServer::onInstanceRemoved);
+}
+
+ControlServer::~ControlServer()
+{
+    close();
+}
+
+// ======================== Сокет ========================
+bool ControlServer::listen(const QString &path, QString *error)
+{
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    m_server->setMaxPendingConnections(MaxPendingConnections);
+    if (!m_server->listen(path) && m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        // Отвечает — это другой vmrun; молчит — сокет остался от упавшего
+        QLocalSocket probe;
+        probe.connectToServer(path);
+        if (probe.waitForConnected(ProbeTimeoutMs)) {
+            *error = path + ": сокет занят другим процессом vmrun";
+            delete m_server;
+            m_server = nullptr;
+            return false;
+        }
+        QLocalServer::removeServer(path);
+        m_server->listen(path);
+    }
+    if (!m_server->isListening()) {
+        *error = path + ": " + m_server->errorString();
+        delete m_server;
+        m_server = nullptr;
+        return false;
+    }
+    m_path = path;
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+    return true;
+}
+
+void ControlServer::close()
+{
+    for (Client *client : m_clients.values())
+        removeClient(client);
+    if (m_server) {
+        m_server->close();  // файл сокета удаляет сам QLocalServer
+        delete m_server;
+        m_server = nullptr;
+    }
+    m_path.clear();
+}
+
+bool ControlServer::isListening() const
+{
+    return m_server && m_server->isListening();
+}
+
+void ControlServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        auto *client = new Client;
+        client->socket = socket;
+        m_clients.insert(socket, client);
+        connect(socket, &QLocalSocket::readyRead, this, [this, client]() { onReadyRead(client); });
+        // Ответы копятся, пока клиент их не читает, — дальше его запросы ждут
+        connect(socket, &QLocalSocket::bytesWritten, this, [this, client]() {
+            if (client->socket->bytesToWrite() < MaxBacklogBytes / 2 && client->socket->bytesAvailable() > 0)
+                onReadyRead(client);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, client]() { removeClient(client); });
+    }
+    emit clientCountChanged(m_clients.size());
+}
+
+void ControlServer::onReadyRead(Client *client)
+{
+    QLocalSocket *socket = client->socket;
+    if (socket->bytesToWrite() >= MaxBacklogBytes)
+        return;
+    client->frames.feed(socket->readAll());
+
+    // Все ответы пачки — одной записью
+    QByteArray replies;
+    QJsonObject request;
+    while (client->frames.next(&request)) {
+        ++m_requests;
+        QJsonObject reply = handle(client, request, false);
+        if (request.contains("id"))
+            reply.insert("id", request.value("id"));
+        replies += ControlFrames::encode(reply);
+    }
+    if (!client->frames.error().isEmpty()) {
+        replies += ControlFrames::encode(failure(client->frames.error()));
+        socket->write(replies);
+        socket->disconnectFromServer();
+        return;
+    }
+    if (!replies.isEmpty())
+        socket->write(replies);
+}
+
+void ControlServer::removeClient(Client *client)
+{
+    if (!m_clients.remove(client->socket))
+        return;
+    client->socket->disconnect(this);
+    client->socket->abort();
+    client->socket->deleteLater();
+    delete client;
+    recountSubscribers();
+    emit clientCountChanged(m_clients.size());
+}
+
+// ======================== Запросы ========================
+QJsonObject ControlServer::handle(Client *client, const QJsonObject &request, bool nested)
+{
+    const QString op = request.value("op").toString();
+    const QString name = request.value("vm").toString();
+    QJsonObject reply;
+
+    if (op == "ping") {
+        // пустой ответ
+    } else if (op == "list") {
+        QJsonArray vms;
+        for (const VmInstance *vm : m_supervisor->instances())
+            vms.append(vmStatus(vm));
+        reply.insert("vms", vms);
+    } else if (op == "batch") {
+        const QJsonArray requests = request.value("requests").toArray();
+        if (nested)
+            return failure("batch внутри batch");
+        if (requests.size() > MaxBatch)
+            return failure(QString("в пачке больше %1 запросов").arg(MaxBatch));
+        QJsonArray results;
+        for (const QJsonValue &item : requests)
+            results.append(handle(client, item.toObject(), true));
+        reply.insert("results", results);
+    } else if (op == "subscribe") {
+        reply = subscribe(client, request);
+    } else if (op == "unsubscribe") {
+        client->status = false;
+        client->log = false;
+        client->vms.clear();
+        client->consoles.clear();
+        recountSubscribers();
+    } else if (name.isEmpty()) {
+        return failure(op.isEmpty() ? "не указана операция (\"op\")" : "не указана ВМ (\"vm\")");
+    } else if (op == "start") {
+        reply = startVm(name);
+    } else if (op == "stop") {
+        reply = stopVm(name);
+    } else if (op == "restart") {
+        reply = restartVm(name);
+    } else if (op == "status" || op == "log") {
+        VmInstance *vm = m_supervisor->instance(name);
+        if (!vm)
+            return failure("нет такой ВМ: " + name);
+        reply = op == "status" ? QJsonObject {{"vm", vmStatus(vm)}} : logLines(vm, request);
+    } else if (op == "console" || op == "input") {
+        VmInstance *vm = m_supervisor->instance(name);
+        if (!vm)
+            return failure("нет такой ВМ: " + name);
+        reply = op == "console" ? openConsole(client, vm, request) : writeConsole(vm, request);
+    } else {
+        return failure("неизвестная операция: " + op);
+    }
+
+    if (!reply.contains("ok"))
+        reply.insert("ok", true);
+    return reply;
+}
+
+QJsonObject ControlServer::startVm(const QString &name)
+{
+    m_restartPending.remove(name);
+    VmInstance *vm = m_supervisor->instance(name);
+    if (vm && vm->isActive())
+        return QJsonObject {{"state", stateKey(vm->state())}, {"already", true}};
+
+    // Настройки перечитываются при каждом запуске — как из окна
+    if (m_provider) {
+        VmConfig config;
+        QString error;
+        if (!m_provider(name, &config, &error))
+            return failure(error);
+        vm = m_supervisor->ensureInstance(config);
+        if (!vm)
+            return failure("ВМ уже запущена");
+    } else if (!vm) {
+        return failure("нет такой ВМ: " + name);
+    }
+    vm->start();
+    return QJsonObject {{"state", stateKey(vm->state())}};
+}
+
+QJsonObject ControlServer::stopVm(const QString &name)
+{
+    m_restartPending.remove(name);
+    VmInstance *vm = m_supervisor->instance(name);
+    if (!vm)
+        return failure("нет такой ВМ: " + name);
+    // Повторный stop() ускорил бы остановку — API так не делает
+    if (vm->isActive() && vm->state() != VmInstance::State::Stopping)
+        vm->stop();
+    return QJsonObject {{"state", stateKey(vm->state())}};
+}
+
+// Работающая ВМ останавливается штатной цепочкой, запуск — когда она дойдёт
+// до Stopped/Failed (onInstanceChanged)
+QJsonObject ControlServer::restartVm(const QString &name)
+{
+    VmInstance *vm = m_supervisor->instance(name);
+    if (!vm || !vm->isActive())
+        return startVm(name);
+    m_restartPending.insert(name);
+    if (vm->state() != VmInstance::State::Stopping)
+        vm->stop();
+    return QJsonObject {{"state", stateKey(vm->state())}};
+}
+
+QJsonObject ControlServer::logLines(VmInstance *vm, const QJsonObject &request) const
+{
+    const LogBuffer *log = vm->log();
+    const quint64 count = quint64(qBound(0, request.value("lines").toInt(DefaultLogLines), log->capacity()));
+    quint64 from = log->endSeq() - qMin<quint64>(count, quint64(log->size()));
+    if (request.contains("after"))
+        from = qMax(log->firstSeq(), quint64(qMax(0.0, request.value("after").toDouble())));
+    const quint64 to = qMin(log->endSeq(), from + count);
+    return QJsonObject {
+        {"lines", logArray(log, qMin(from, to), to)},
+        {"next", double(to)},
+        {"first", double(log->firstSeq())},
+    };
+}
+
+QJsonObject ControlServer::subscribe(Client *client, const QJsonObject &request)
+{
+    // Накопленные изменения уходят прежним подписчикам до снимка — иначе
+    // снимок затёр бы их в m_sent
+    pushStatus();
+
+    client->status = request.value("status").toBool(true);
+    client->log = request.value("log").toBool(false);
+    client->vms.clear();
+    for (const QJsonValue &vm : request.value("vms").toArray())
+        client->vms.insert(vm.toString());
+    recountSubscribers();
+
+    QJsonArray vms;
+    for (const VmInstance *vm : m_supervisor->instances()) {
+        if (!client->wants(vm->name()))
+            continue;
+        const QJsonObject status = vmStatus(vm);
+        m_sent.insert(vm->name(), QJsonDocument(status).toJson(QJsonDocument::Compact));
+        vms.append(status);
+    }
+    return QJsonObject {{"vms", vms}};
+}
+
+QJsonObject ControlServer::openConsole(Client *client, VmInstance *vm, const QJsonObject &request)
+{
+    const SerialConsole *serial = vm->serial();
+    if (request.value("follow").toBool(true)) {
+        client->consoles.insert(vm->name());
+        recountSubscribers();
+    }
+    return QJsonObject {
+        {"data", QString::fromLatin1(serial->history().toBase64())},
+        {"device", serial->guestDevice()},
+        {"open", serial->isOpen()},
+    };
+}
+
+QJsonObject ControlServer::writeConsole(VmInstance *vm, const QJsonObject &request)
+{
+    const QByteArray data = QByteArray::fromBase64(request.value("data").toString().toLatin1());
+    if (!vm->serial()->isOpen())
+        return failure("консоль " + vm->name() + " не подключена");
+    if (!vm->serial()->write(data))
+        return failure("гость не принимает ввод");
+    return QJsonObject {{"written", data.size()}};
+}
+
+void ControlServer::recountSubscribers()
+{
+    m_statusSubscribers = 0;
+    m_logSubscribers = 0;
+    m_consoleSubscribers = 0;
+    for (const Client *client : qAsConst(m_clients)) {
+        m_statusSubscribers += client->status ? 1 : 0;
+        m_logSubscribers += client->log ? 1 : 0;
+        m_consoleSubscribers += client->consoles.isEmpty() ? 0 : 1;
+    }
+    // Без подписчиков состояния не рассылаются — и помнить разосланное незачем
+    if (m_statusSubscribers == 0) {
+        m_sent.clear();
+        m_dirty.clear();
+    }
+}
+
+// ======================== События ========================
+void ControlServer::watch(VmInstance *vm)
+{
+    LogBuffer *log = vm->log();
+    m_logSeq.insert(vm->name(), log->endSeq());
+    connect(log, &LogBuffer::linesFlushed, this, [this, vm]() { pushLog(vm); });
+    connect(log, &LogBuffer::cleared, this, [this, vm]() { m_logSeq.insert(vm->name(), vm->log()->endSeq()); });
+    connect(vm->serial(), &SerialConsole::received, this, [this, vm](const QByteArray &data) {
+        if (m_consoleSubscribers > 0)
+            pushConsole(vm->name(), data);
+    });
+}
+
+void ControlServer::onInstanceChanged(int row)
+{
+    VmInstance *vm = m_supervisor->at(row);
+    if (!vm)
+        return;
+    if (!vm->isActive() && m_restartPending.contains(vm->name())) {
+        const QJsonObject started = startVm(vm->name());
+        if (!started.value("ok").toBool(true))
+            vm->log()->append(LogSeverity::Error, "[API] Перезапуск не удался: " + started.value("error").toString());
+    }
+    if (m_statusSubscribers == 0)
+        return;
+    m_dirty.insert(vm->name());
+    if (!m_pushTimer.isActive())
+        m_pushTimer.start();
+}
+
+void ControlServer::onInstanceRemoved(int row)
+{
+    VmInstance *vm = m_supervisor->at(row);
+    if (!vm)
+        return;
+    const QString name = vm->name();
+    m_restartPending.remove(name);
+    m_dirty.remove(name);
+    m_sent.remove(name);
+    m_logSeq.remove(name);
+    if (m_statusSubscribers == 0)
+        return;
+    const QByteArray frame = ControlFrames::encode(QJsonObject {{"event", "removed"}, {"vm", name}});
+    for (Client *client : qAsConst(m_clients)) {
+        if (client->status && client->wants(name))
+            client->socket->write(frame);
+    }
+}
+
+void ControlServer::pushStatus()
+{
+    m_pushTimer.stop();
+    const QSet<QString> dirty = std::exchange(m_dirty, QSet<QString>());
+    for (const QString &name : dirty) {
+        const VmInstance *vm = m_supervisor->instance(name);
+        if (!vm)
+            continue;
+        const QByteArray json = QJsonDocument(vmStatus(vm)).toJson(QJsonDocument::Compact);
+        QByteArray &sent = m_sent[name];
+        if (json == sent)
+            continue;
+        sent = json;
+        // Событие собирается из готового JSON — без второго обхода объекта
+        const QByteArray frame = ControlFrames::frame("{\"event\":\"status\",\"vm\":" + json + '}');
+        for (Client *client : qAsConst(m_clients)) {
+            if (client->status && client->wants(name))
+                client->socket->write(frame);
+        }
+    }
+}
+
+void ControlServer::pushLog(VmInstance *vm)
+{
+    const LogBuffer *log = vm->log();
+    const QString name = vm->name();
+    quint64 &seq = m_logSeq[name];
+    const quint64 from = qMax(seq, log->firstSeq());
+    const quint64 overwritten = from - seq;  // вытеснены из кольца раньше, чем ушли
+    seq = log->endSeq();
+    if (m_logSubscribers == 0 || from >= seq)
+        return;
+
+    QJsonObject event {{"event", "log"}, {"vm", name}, {"lines", logArray(log, from, seq)}};
+    const int lines = int(seq - from);
+    QByteArray frame;
+    for (Client *client : qAsConst(m_clients)) {
+        if (!client->log || !client->wants(name))
+            continue;
+        if (client->socket->bytesToWrite() >= MaxBacklogBytes) {
+            client->droppedLines += quint64(lines);
+            continue;
+        }
+        const quint64 dropped = client->droppedLines + overwritten;
+        if (dropped > 0) {
+            QJsonObject own = event;
+            own.insert("dropped", double(dropped));
+            client->socket->write(ControlFrames::encode(own));
+            client->droppedLines = 0;
+            continue;
+        }
+        if (frame.isEmpty())
+            frame = ControlFrames::encode(event);
+        client->socket->write(frame);
+    }
+}
+
+// Байты консоли нельзя проредить, как строки лога: кто не успевает,
+// теряет кусок целиком и узнаёт об этом по "dropped"
+void ControlServer::pushConsole(const QString &name, const QByteArray &data)
+{
+    QJsonObject event {{"event", "console"}, {"vm", name}, {"data", QString::fromLatin1(data.toBase64())}};
+    QByteArray frame;
+    for (Client *client : qAsConst(m_clients)) {
+        if (!client->consoles.contains(name))
+            continue;
+        if (client->socket->bytesToWrite() >= MaxBacklogBytes) {
+            client->droppedConsoleBytes += quint64(data.size());
+            continue;
+        }
+        if (client->droppedConsoleBytes > 0) {
+            QJsonObject own = event;
+            own.insert("dropped", double(client->droppedConsoleBytes));
+            client->socket->write(ControlFrames::encode(own));
+            client->droppedConsoleBytes = 0;
+            continue;
+        }
+        if (frame.isEmpty())
+            frame = ControlFrames::encode(event);
+        client->socket->write(frame);
+    }
+}
+
+// ======================== Состояние ВМ ========================
+QString ControlServer::stateKey(VmInstance::State state)
+{
+    switch (state) {
+    case VmInstance::State::Stopped:    return "stopped";
+    case VmInstance::State::Starting:   return "starting";
+    case VmInstance::State::Running:    return "running";
+    case VmInstance::State::Stopping:   return "stopping";
+    case VmInstance::State::Restarting: return "restarting";
+    case VmInstance::State::Failed:     return "failed";
+    }
+    return QString();
+}
+
+// Только то, что меняется при смене фазы: счётчики ресурсов сюда не идут,
+// иначе каждое событие status было бы новым
+QJsonObject ControlServer::vmStatus(const VmInstance *vm)
+{
+    const VmConfig &config = vm->config();
+    QJsonObject status {
+        {"name", vm->name()},
+        {"state", stateKey(vm->state())},
+        {"memory", config.memory},
+        {"vcpus", config.cpu.vcpus},
+        {"tap", config.tap},
+        {"restarts", vm->restartCount()},
+        {"exit_code", vm->lastExitCode()},
+    };
+    if (vm->isActive()) {
+        status.insert("pid", double(vm->processId()));
+        status.insert("started_at", double(vm->startedAtMs()));
+        status.insert("vnc_port", vm->vncPort());
+        status.insert("network_ready_ms", double(vm->networkReadyMs()));
+        if (vm->serial()->isOpen())
+            status.insert("console", vm->serial()->guestDevice());
+        if (vm->isWaitingForMemory())
+            status.insert("waiting_for_memory", true);
+        if (vm->stopStage() != VmInstance::StopStage::None)
+            status.insert("stop_stage", VmInstance::stopStageName(vm->stopStage()));
+    }
+    return status;
+}
@@ -0,0 +1,138 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSet>
+#include <QTimer>
+#include <functional>
+
+#include "controlprotocol.h"
+#include "vmconfig.h"
+#include "vminstance.h"
+
+class QLocalServer;
+class QLocalSocket;
+class VmSupervisor;
+
+// API управления на Unix-сокете: скрипты и автоматика делают то же, что
+// кнопки окна, без doas bhyve в обход vmrun. Кадры — ControlFrames.
+//
+// Операции ("op"), у всех, кроме list/ping/batch, — "vm": имя:
+//   ping                   — {}
+//   list                   — {"vms": [состояние, ...]}
+//   status                 — {"vm": состояние}
+//   start / stop / restart — {"state": ...}; сам переход — событиями status
+//   log                    — {"lines": [...], "next": seq}; "lines": сколько
+//                            последних (по умолчанию 100), "after": с какого seq
+//   subscribe              — "status": bool, "log": bool, "vms": [имена] (пусто —
+//                            все); ответ — текущие состояния, дальше события
+//   unsubscribe            — подписка снимается (и на консоли тоже)
+//   console                — {"data": base64, "device": ..., "open": bool}: история
+//                            com1 (SerialConsole::history); дальше — события console,
+//                            "follow": false — только история
+//   input                  — "data": base64 → гостю в com1; {"written": байт}
+//   batch                  — "requests": [запросы без id] → {"results": [ответы]};
+//                            одна пачка поднимает хоть 50 ВМ за один запрос
+//
+// События: {"event": "status", "vm": состояние} — только когда состояние
+// действительно изменилось, не чаще раза в PushIntervalMs на ВМ;
+// {"event": "log", "vm": имя, "lines": [...]} — по сигналу LogBuffer;
+// {"event": "console", "vm": имя, "data": base64} — байты com1 как есть,
+// тем же куском, что прочитан из устройства;
+// {"event": "removed", "vm": имя}. Каждое событие сериализуется один раз
+// и рассылается всем подписчикам одной копией. Клиенту, который не
+// успевает читать (в сокете больше MaxBacklogBytes), строки лога не
+// шлются, а в следующем событии log приходит "dropped": сколько пропущено;
+// так же теряются байты консоли — "dropped" в событии console.
+//
+// Всё — в потоке supervisor'а: запросы короткие, ВМ трогаются так же,
+// как из окна.
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int PushIntervalMs = 20;
+    static constexpr int MaxBacklogBytes = 8 << 20;
+    static constexpr int MaxBatch = 10000;
+    static constexpr int DefaultLogLines = 100;
+
+    // Конфигурация ВМ, которой ещё нет в supervisor'е (start по имени)
+    using ConfigProvider = std::function<bool(const QString &name, VmConfig *config, QString *error)>;
+
+    explicit ControlServer(VmSupervisor *supervisor, QObject *parent = nullptr);
+    ~ControlServer() override;
+
+    void setConfigProvider(const ConfigProvider &provider) { m_provider = provider; }
+
+    // Сокет, оставшийся от упавшего процесса, заменяется; живой — нет
+    bool listen(const QString &path, QString *error);
+    void close();
+    bool isListening() const;
+    QString path() const { return m_path; }
+
+    int clientCount() const { return m_clients.size(); }
+    quint64 requestCount() const { return m_requests; }
+
+    // "running" и т.п. — в API, в отличие от VmInstance::stateName()
+    static QString stateKey(VmInstance::State state);
+    static QJsonObject vmStatus(const VmInstance *vm);
+
+signals:
+    void clientCountChanged(int count);
+
+private:
+    struct Client {
+        QLocalSocket *socket = nullptr;
+        ControlFrames frames;
+        bool status = false;
+        bool log = false;
+        QSet<QString> vms;  // пусто — все
+        QSet<QString> consoles;
+        quint64 droppedLines = 0;
+        quint64 droppedConsoleBytes = 0;
+        bool wants(const QString &vm) const { return vms.isEmpty() || vms.contains(vm); }
+    };
+
+    void onNewConnection();
+    void onReadyRead(Client *client);
+    void removeClient(Client *client);
+
+    QJsonObject handle(Client *client, const QJsonObject &request, bool nested);
+    QJsonObject startVm(const QString &name);
+    QJsonObject stopVm(const QString &name);
+    QJsonObject restartVm(const QString &name);
+    QJsonObject logLines(VmInstance *vm, const QJsonObject &request) const;
+    QJsonObject subscribe(Client *client, const QJsonObject &request);
+    QJsonObject openConsole(Client *client, VmInstance *vm, const QJsonObject &request);
+    QJsonObject writeConsole(VmInstance *vm, const QJsonObject &request);
+
+    void watch(VmInstance *vm);
+    void onInstanceChanged(int row);
+    void onInstanceRemoved(int row);
+    void pushStatus();
+    void pushLog(VmInstance *vm);
+    void pushConsole(const QString &name, const QByteArray &data);
+    void recountSubscribers();
+
+    VmSupervisor *m_supervisor;
+    QLocalServer *m_server = nullptr;
+    QString m_path;
+    ConfigProvider m_provider;
+    QHash<QLocalSocket *, Client *> m_clients;
+    int m_statusSubscribers = 0;
+    int m_logSubscribers = 0;
+    int m_consoleSubscribers = 0;
+    quint64 m_requests = 0;
+
+    QSet<QString> m_restartPending;      // stop уже послан, start — как остановится
+    QSet<QString> m_dirty;               // состояние могло измениться
+    QHash<QString, QByteArray> m_sent;   // последнее разосланное состояние
+    QHash<QString, quint64> m_logSeq;    // с какой строки слать следующее событие log
+    QTimer m_pushTimer;
+};
+
+#endif // CONTROLSERVER_H
@@ -0,0 +1,9 @@
+# Подключение core к приложению: include(../core/core.pri). Путь к
+# библиотеке — от каталога сборки core, с любой глубины (tests/, bench/)
+QT += concurrent network
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+LIBS += -L$$shadowed($$PWD) -lvmrun-core -lz
+PRE_TARGETDEPS += $$shadowed($$PWD)/libvmrun-core.a
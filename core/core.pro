@@ -0,0 +1,68 @@
+TEMPLATE = lib
+TARGET = vmrun-core
+CONFIG += staticlib c++17
+
+# Без QtGui/QtWidgets: демон и CLI их не тянут; network — сокет API управления
+QT = core concurrent network
+
+SOURCES += \
+    arpscanparser.cpp \
+    commandrunner.cpp \
+    controlclient.cpp \
+    controlprotocol.cpp \
+    controlserver.cpp \
+    cputopology.cpp \
+    diskbench.cpp \
+    displayports.cpp \
+    eventjournal.cpp \
+    guestprocess.cpp \
+    hostmemory.cpp \
+    imageclone.cpp \
+    interfacewatcher.cpp \
+    latencyhistogram.cpp \
+    logarchive.cpp \
+    logbuffer.cpp \
+    memoryadmission.cpp \
+    networkreconciler.cpp \
+    processstats.cpp \
+    resourcesampler.cpp \
+    restarttracker.cpp \
+    rfbdecoder.cpp \
+    serialconsole.cpp \
+    terminalscreen.cpp \
+    vmconfig.cpp \
+    vminstance.cpp \
+    vminventory.cpp \
+    vmsettings.cpp \
+    vmsupervisor.cpp
+
+HEADERS += \
+    arpscanparser.h \
+    commandrunner.h \
+    controlclient.h \
+    controlprotocol.h \
+    controlserver.h \
+    cputopology.h \
+    diskbench.h \
+    displayports.h \
+    eventjournal.h \
+    guestprocess.h \
+    hostmemory.h \
+    imageclone.h \
+    interfacewatcher.h \
+    latencyhistogram.h \
+    logarchive.h \
+    logbuffer.h \
+    memoryadmission.h \
+    networkreconciler.h \
+    processstats.h \
+    resourcesampler.h \
+    restarttracker.h \
+    rfbdecoder.h \
+    serialconsole.h \
+    terminalscreen.h \
+    vmconfig.h \
+    vminstance.h \
+    vminventory.h \
+    vmsettings.h \
+    vmsupervisor.h
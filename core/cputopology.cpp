@@ -0,0 +1,407 @@
+#include "cputopology.h"
+
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QSet>
+#include <QThread>
+#include <QXmlStreamReader>
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+#if defined(Q_OS_FREEBSD)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#endif
+
+namespace {
+
+QString readTrimmed(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    return QString::fromLatin1(file.readAll()).trimmed();
+}
+
+// Процессоры по возрастанию id, ядра и узлы — плотно с нуля в порядке
+// появления: CpuPlacer индексирует по ним векторы
+void renumber(HostTopology &topology)
+{
+    std::sort(topology.cpus.begin(), topology.cpus.end(),
+              [](const HostCpu &a, const HostCpu &b) { return a.id < b.id; });
+    QHash<int, int> cores;
+    QHash<int, int> nodes;
+    for (HostCpu &cpu : topology.cpus) {
+        cpu.core = cores.insert(cpu.core, cores.value(cpu.core, cores.size())).value();
+        cpu.node = nodes.insert(cpu.node, nodes.value(cpu.node, nodes.size())).value();
+    }
+}
+
+HostTopology fallbackTopology()
+{
+    HostTopology topology = HostTopology::synthetic(1, qMax(1, QThread::idealThreadCount()), 1);
+    topology.source = "fallback";
+    return topology;
+}
+
+} // namespace
+
+// ======================== HostTopology ========================
+int HostTopology::coreCount() const
+{
+    int count = 0;
+    for (const HostCpu &cpu : cpus)
+        count = qMax(count, cpu.core + 1);
+    return count;
+}
+
+int HostTopology::nodeCount() const
+{
+    int count = 0;
+    for (const HostCpu &cpu : cpus)
+        count = qMax(count, cpu.node + 1);
+    return count;
+}
+
+QVector<int> HostTopology::siblings(int cpuId) const
+{
+    int core = -1;
+    for (const HostCpu &cpu : cpus) {
+        if (cpu.id == cpuId)
+            core = cpu.core;
+    }
+    QVector<int> result;
+    for (const HostCpu &cpu : cpus) {
+        if (cpu.core == core && cpu.id != cpuId)
+            result.append(cpu.id);
+    }
+    return result;
+}
+
+QString HostTopology::summary() const
+{
+    return QString("узлов NUMA: %1, ядер: %2, потоков: %3 (%4)")
+        .arg(nodeCount()).arg(coreCount()).arg(cpus.size()).arg(source);
+}
+
+QVector<int> HostTopology::parseCpuList(const QString &list)
+{
+    QVector<int> result;
+    for (const QString &part : list.split(',', Qt::SkipEmptyParts)) {
+        const QStringList range = part.trimmed().split('-');
+        bool okFirst = false, okLast = true;
+        const int first = range.value(0).toInt(&okFirst);
+        const int last = range.size() > 1 ? range.value(1).toInt(&okLast) : first;
+        if (!okFirst || !okLast || last < first)
+            continue;
+        for (int id = first; id <= last; ++id)
+            result.append(id);
+    }
+    return result;
+}
+
+HostTopology HostTopology::synthetic(int nodes, int coresPerNode, int threadsPerCore)
+{
+    HostTopology topology;
+    topology.source = "synthetic";
+    const int cores = nodes * coresPerNode;
+    for (int thread = 0; thread < threadsPerCore; ++thread) {
+        for (int core = 0; core < cores; ++core) {
+            HostCpu cpu;
+            cpu.id = thread * cores + core;
+            cpu.core = core;
+            cpu.node = core / coresPerNode;
+            topology.cpus.append(cpu);
+        }
+    }
+    renumber(topology);
+    return topology;
+}
+
+// cpu/online, cpu/cpuN/topology/{core_id,physical_package_id}, node/nodeN/cpulist.
+// core_id уникален только внутри пакета — ядро определяет пара
+HostTopology HostTopology::fromSysfs(const QString &root)
+{
+    HostTopology topology;
+    topology.source = "sysfs";
+    const QDir dir(root);
+
+    QVector<int> online = parseCpuList(readTrimmed(dir.filePath("cpu/online")));
+    if (online.isEmpty()) {
+        for (const QString &name : QDir(dir.filePath("cpu")).entryList({"cpu[0-9]*"}, QDir::Dirs)) {
+            bool ok = false;
+            const int id = name.mid(3).toInt(&ok);
+            if (ok)
+                online.append(id);
+        }
+    }
+
+    QHash<int, int> nodeOf;
+    for (const QString &name : QDir(dir.filePath("node")).entryList({"node[0-9]*"}, QDir::Dirs)) {
+        const int node = name.mid(4).toInt();
+        for (int id : parseCpuList(readTrimmed(dir.filePath("node/" + name + "/cpulist"))))
+            nodeOf.insert(id, node);
+    }
+
+    QMap<QPair<int, int>, int> coreOf;
+    for (int id : online) {
+        const QString topo = dir.filePath(QString("cpu/cpu%1/topology/").arg(id));
+        bool okCore = false, okPackage = false;
+        const int coreId = readTrimmed(topo + "core_id").toInt(&okCore);
+        const int package = readTrimmed(topo + "physical_package_id").toInt(&okPackage);
+        // Нет топологии — считаем процессор отдельным ядром
+        const QPair<int, int> key = okCore ? qMakePair(okPackage ? package : 0, coreId) : qMakePair(-1, id);
+        if (!coreOf.contains(key))
+            coreOf.insert(key, coreOf.size());
+
+        HostCpu cpu;
+        cpu.id = id;
+        cpu.core = coreOf.value(key);
+        cpu.node = nodeOf.value(id, 0);
+        topology.cpus.append(cpu);
+    }
+    renumber(topology);
+    return topology;
+}
+
+// <groups><group level="1"><cpu count="8" mask="ff">0, 1, ...</cpu><children>
+//   <group level="2"><cpu ...>0, 1</cpu><flags><flag name="THREAD">...
+// Группа с флагом THREAD или SMT — потоки одного ядра, NODE — NUMA-узел
+HostTopology HostTopology::fromTopologySpec(const QByteArray &xml)
+{
+    struct Group {
+        QVector<int> cpus;
+        bool smt = false;
+        bool node = false;
+    };
+
+    HostTopology topology;
+    topology.source = "sysctl";
+    QVector<Group> stack;
+    QMap<int, int> coreOf;  // id → номер первого процессора его ядра
+    QMap<int, int> nodeOf;
+    int nodes = 0;
+
+    QXmlStreamReader reader(xml);
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            if (reader.name() == QLatin1String("group")) {
+                stack.append(Group());
+            } else if (reader.name() == QLatin1String("cpu") && !stack.isEmpty()) {
+                stack.last().cpus = parseCpuList(reader.readElementText());
+            } else if (reader.name() == QLatin1String("flag") && !stack.isEmpty()) {
+                const QStringRef flag = reader.attributes().value("name");
+                if (flag == QLatin1String("THREAD") || flag == QLatin1String("SMT"))
+                    stack.last().smt = true;
+                else if (flag == QLatin1String("NODE"))
+                    stack.last().node = true;
+            }
+        } else if (reader.isEndElement() && reader.name() == QLatin1String("group") && !stack.isEmpty()) {
+            const Group group = stack.takeLast();
+            for (int id : group.cpus) {
+                if (!coreOf.contains(id))
+                    coreOf.insert(id, id);
+            }
+            if (group.smt && !group.cpus.isEmpty()) {
+                for (int id : group.cpus)
+                    coreOf.insert(id, group.cpus.first());
+            }
+            if (group.node) {
+                for (int id : group.cpus)
+                    nodeOf.insert(id, nodes);
+                ++nodes;
+            }
+        }
+    }
+    if (reader.hasError())
+        return HostTopology();
+
+    for (auto it = coreOf.cbegin(); it != coreOf.cend(); ++it) {
+        HostCpu cpu;
+        cpu.id = it.key();
+        cpu.core = it.value();
+        cpu.node = nodeOf.value(it.key(), 0);
+        topology.cpus.append(cpu);
+    }
+    renumber(topology);
+    return topology;
+}
+
+HostTopology HostTopology::detect()
+{
+    const QStringList fake = qEnvironmentVariable("VMRUN_FAKE_CPU_TOPOLOGY").split(':');
+    if (fake.size() == 3) {
+        const int nodes = fake[0].toInt(), cores = fake[1].toInt(), threads = fake[2].toInt();
+        if (nodes > 0 && cores > 0 && threads > 0)
+            return synthetic(nodes, cores, threads);
+    }
+
+    HostTopology topology;
+#if defined(Q_OS_LINUX)
+    topology = fromSysfs();
+#elif defined(Q_OS_FREEBSD)
+    size_t len = 0;
+    if (::sysctlbyname("kern.sched.topology_spec", nullptr, &len, nullptr, 0) == 0 && len > 0) {
+        QByteArray xml(int(len), '\0');
+        if (::sysctlbyname("kern.sched.topology_spec", xml.data(), &len, nullptr, 0) == 0) {
+            xml.truncate(int(qstrnlen(xml.constData(), uint(len))));
+            topology = fromTopologySpec(xml);
+        }
+    }
+#endif
+    return topology.cpus.isEmpty() ? fallbackTopology() : topology;
+}
+
+// ======================== CpuPlacer ========================
+void CpuPlacer::setHost(const HostTopology &host)
+{
+    m_host = host;
+    m_indexOf.clear();
+    m_coreCpus = QVector<QVector<int>>(host.coreCount());
+    m_load = QVector<int>(host.cpus.size(), 0);
+    for (int i = 0; i < host.cpus.size(); ++i) {
+        m_indexOf.insert(host.cpus[i].id, i);
+        m_coreCpus[host.cpus[i].core].append(i);
+    }
+    // Назначения переносим: процессоры, которых больше нет, просто не считаются
+    for (const QVector<int> &cpuIds : qAsConst(m_assignments))
+        apply(cpuIds, +1);
+}
+
+int CpuPlacer::load(int cpuId) const
+{
+    const int index = m_indexOf.value(cpuId, -1);
+    return index >= 0 ? m_load[index] : 0;
+}
+
+QStringList CpuPlacer::guestsOn(int cpuId) const
+{
+    QStringList guests;
+    for (auto it = m_assignments.cbegin(); it != m_assignments.cend(); ++it) {
+        for (int vcpu = 0; vcpu < it.value().size(); ++vcpu) {
+            if (it.value()[vcpu] == cpuId)
+                guests << QString("%1:%2").arg(it.key()).arg(vcpu);
+        }
+    }
+    guests.sort();
+    return guests;
+}
+
+void CpuPlacer::apply(const QVector<int> &cpuIds, int delta)
+{
+    for (int id : cpuIds) {
+        const int index = m_indexOf.value(id, -1);
+        if (index >= 0)
+            m_load[index] = qMax(0, m_load[index] + delta);
+    }
+}
+
+void CpuPlacer::reserve(const QString &vm, const QVector<int> &cpuIds)
+{
+    release(vm);
+    if (cpuIds.isEmpty())
+        return;
+    m_assignments.insert(vm, cpuIds);
+    apply(cpuIds, +1);
+}
+
+void CpuPlacer::release(const QString &vm)
+{
+    apply(m_assignments.take(vm), -1);
+}
+
+QVector<int> CpuPlacer::place(const QString &vm, int n)
+{
+    release(vm);
+    const int total = m_host.cpus.size();
+    if (n <= 0 || total == 0)
+        return QVector<int>();
+
+    auto coreLoad = [this](int core) {
+        int sum = 0;
+        for (int index : m_coreCpus[core])
+            sum += m_load[index];
+        return sum;
+    };
+
+    QVector<QVector<int>> nodePools(m_host.nodeCount());
+    QVector<int> hostPool;
+    for (int i = 0; i < total; ++i) {
+        nodePools[m_host.cpus[i].node].append(i);
+        hostPool.append(i);
+    }
+
+    using Capacity = std::function<int(const QVector<int> &)>;
+    const Capacity idleCores = [this, &coreLoad](const QVector<int> &pool) {
+        QSet<int> seen;
+        int count = 0;
+        for (int index : pool) {
+            const int core = m_host.cpus[index].core;
+            if (!seen.contains(core)) {
+                seen.insert(core);
+                count += coreLoad(core) == 0 ? 1 : 0;
+            }
+        }
+        return count;
+    };
+    const Capacity idleCpus = [this](const QVector<int> &pool) {
+        int count = 0;
+        for (int index : pool)
+            count += m_load[index] == 0 ? 1 : 0;
+        return count;
+    };
+    const Capacity size = [](const QVector<int> &pool) { return pool.size(); };
+    auto averageLoad = [this](const QVector<int> &pool) {
+        double sum = 0;
+        for (int index : pool)
+            sum += m_load[index];
+        return sum / pool.size();
+    };
+
+    // Узел лучше всего хоста (память гостя рядом с его vCPU), весь хост
+    // лучше SMT-соседства и двух vCPU на одном потоке
+    const QVector<int> *pool = nullptr;
+    for (const Capacity &capacity : {idleCores, idleCpus, size}) {
+        for (const QVector<int> &node : qAsConst(nodePools)) {
+            if (capacity(node) >= n && (!pool || averageLoad(node) < averageLoad(*pool)))
+                pool = &node;
+        }
+        if (!pool && capacity(hostPool) >= n)
+            pool = &hostPool;
+        if (pool)
+            break;
+    }
+    if (!pool)
+        pool = &hostPool;
+
+    // Ключ процессора: загрузка ядра, самого потока, затем — чужие vCPU на
+    // соседях (свои соседи лучше чужих), затем номер для стабильности
+    QVector<int> own(total, 0);
+    QVector<int> chosen;
+    for (int vcpu = 0; vcpu < n; ++vcpu) {
+        int best = -1;
+        std::tuple<int, int, int, int> bestKey;
+        for (int index : *pool) {
+            const int core = m_host.cpus[index].core;
+            int foreign = 0;
+            for (int sibling : m_coreCpus[core]) {
+                if (sibling != index)
+                    foreign += m_load[sibling] - own[sibling];
+            }
+            const auto key = std::make_tuple(coreLoad(core), m_load[index], foreign, m_host.cpus[index].id);
+            if (best < 0 || key < bestKey) {
+                best = index;
+                bestKey = key;
+            }
+        }
+        ++m_load[best];
+        ++own[best];
+        chosen.append(m_host.cpus[best].id);
+    }
+    m_assignments.insert(vm, chosen);
+    return chosen;
+}
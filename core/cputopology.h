@@ -0,0 +1,82 @@
+#ifndef CPUTOPOLOGY_H
+#define CPUTOPOLOGY_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// Один логический процессор хоста
+struct HostCpu {
+    int id = 0;    // номер для bhyve -p и cpuset
+    int core = 0;  // сквозной номер физического ядра: SMT-соседи делят его
+    int node = 0;  // NUMA-узел
+};
+
+// Топология процессоров хоста
+struct HostTopology {
+    QVector<HostCpu> cpus;
+    QString source;  // "sysfs", "sysctl", "synthetic", "fallback"
+
+    int coreCount() const;
+    int nodeCount() const;
+    // Номера (id) процессоров того же ядра, кроме cpu
+    QVector<int> siblings(int cpuId) const;
+    // "узлов NUMA: 2, ядер: 8, потоков: 16 (sysfs)"
+    QString summary() const;
+
+    // sysfs на Linux, kern.sched.topology_spec на FreeBSD, иначе — по
+    // процессору на ядро в одном узле. VMRUN_FAKE_CPU_TOPOLOGY=узлы:ядра:потоки
+    // (ядер на узел, потоков на ядро) — синтетика для прогонов без железа
+    static HostTopology detect();
+    // root — каталог с cpu/ и node/ (обычно /sys/devices/system)
+    static HostTopology fromSysfs(const QString &root = "/sys/devices/system");
+    // XML из sysctl kern.sched.topology_spec
+    static HostTopology fromTopologySpec(const QByteArray &xml);
+    // Процессоры нумеруются как у Linux на x86: сначала первые потоки всех
+    // ядер, потом вторые
+    static HostTopology synthetic(int nodes, int coresPerNode, int threadsPerCore);
+    // "0-3,8,10-11" → {0,1,2,3,8,10,11}
+    static QVector<int> parseCpuList(const QString &list);
+};
+
+// Раскладка vCPU закреплённых ВМ по процессорам хоста. Нагрузка процессора —
+// сколько vCPU на нём закреплено. Для новой ВМ:
+//   - ищем место, где её vCPU получат по целому свободному ядру (без
+//     SMT-соседства с чужими vCPU), сначала в одном NUMA-узле, потом на
+//     всём хосте; затем — просто свободные процессоры; иначе — наименее
+//     загруженный узел, которому хватает процессоров;
+//   - внутри выбранного набора каждый vCPU идёт на процессор наименее
+//     загруженного ядра, при равенстве — на наименее загруженный поток.
+// Не потокобезопасен: живёт в VmSupervisor, трогается из GUI-потока.
+class CpuPlacer
+{
+public:
+    void setHost(const HostTopology &host);
+    const HostTopology &host() const { return m_host; }
+
+    // Подбирает n процессоров для vm и резервирует их (прежнее назначение
+    // vm снимается). Возвращает id процессоров хоста по порядку vCPU
+    QVector<int> place(const QString &vm, int n);
+    // Резервирует готовое назначение — гость подхвачен после перезапуска
+    void reserve(const QString &vm, const QVector<int> &cpuIds);
+    void release(const QString &vm);
+
+    QVector<int> assignment(const QString &vm) const { return m_assignments.value(vm); }
+    const QHash<QString, QVector<int>> &assignments() const { return m_assignments; }
+    // Сколько vCPU закреплено за процессором с этим id
+    int load(int cpuId) const;
+    // "vm:vcpu" всех vCPU на процессоре с этим id
+    QStringList guestsOn(int cpuId) const;
+
+private:
+    void apply(const QVector<int> &cpuIds, int delta);
+
+    HostTopology m_host;
+    QHash<int, int> m_indexOf;           // id процессора → индекс в m_host.cpus
+    QVector<QVector<int>> m_coreCpus;    // ядро → индексы его процессоров
+    QVector<int> m_load;                 // по индексу процессора
+    QHash<QString, QVector<int>> m_assignments;
+};
+
+#endif // CPUTOPOLOGY_H
@@ -0,0 +1,319 @@
+#include "diskbench.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QStringList>
+
+#include <cmath>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const QVector<DiskBench::Pattern> AllPatterns = {DiskBench::Pattern::SeqWrite, DiskBench::Pattern::RandWrite,
+                                                 DiskBench::Pattern::SeqRead, DiskBench::Pattern::RandRead};
+
+bool isWrite(DiskBench::Pattern pattern)
+{
+    return pattern == DiskBench::Pattern::SeqWrite || pattern == DiskBench::Pattern::RandWrite;
+}
+
+bool isSequential(DiskBench::Pattern pattern)
+{
+    return pattern == DiskBench::Pattern::SeqWrite || pattern == DiskBench::Pattern::SeqRead;
+}
+
+// O_SYNC на чтение не влияет — такие тесты повторяли бы Buffered
+bool isSkipped(DiskBench::Mode mode, DiskBench::Pattern pattern)
+{
+    return mode == DiskBench::Mode::Sync && !isWrite(pattern);
+}
+
+QString errnoMessage(int error, DiskBench::Mode mode)
+{
+    // Linux отвечает EINVAL на O_DIRECT там, где ФС его не умеет (FUSE, tmpfs)
+    if (error == EINVAL && mode == DiskBench::Mode::NoCache)
+        return "ФС не поддерживает O_DIRECT (nocache)";
+    return qt_error_string(error);
+}
+
+class AlignedBuffer
+{
+public:
+    explicit AlignedBuffer(size_t size)
+    {
+        if (::posix_memalign(&m_data, DiskBench::Alignment, size) != 0)
+            m_data = nullptr;
+    }
+    ~AlignedBuffer() { ::free(m_data); }
+    AlignedBuffer(const AlignedBuffer &) = delete;
+    AlignedBuffer &operator=(const AlignedBuffer &) = delete;
+
+    void *data() const { return m_data; }
+
+private:
+    void *m_data = nullptr;
+};
+
+DiskBench::Result measure(DiskBench::Mode mode, DiskBench::Pattern pattern, const QString &path, void *buffer,
+                          const DiskBench::Options &options, const std::atomic_bool *cancel)
+{
+    DiskBench::Result result;
+    result.mode = mode;
+    result.pattern = pattern;
+    const bool write = isWrite(pattern);
+    const bool sequential = isSequential(pattern);
+    const qint64 block = sequential ? DiskBench::SeqBlockBytes : DiskBench::RandBlockBytes;
+
+    int flags = (write ? O_WRONLY | O_CREAT : O_RDONLY) | O_CLOEXEC;
+    if (mode == DiskBench::Mode::NoCache) {
+#ifdef O_DIRECT
+        flags |= O_DIRECT;
+#else
+        result.error = "O_DIRECT недоступен в этой системе";
+        return result;
+#endif
+    }
+    if (mode == DiskBench::Mode::Sync && write)
+        flags |= O_SYNC;
+
+    const int fd = ::open(QFile::encodeName(path).constData(), flags, 0600);
+    if (fd < 0) {
+        result.error = errnoMessage(errno, mode);
+        return result;
+    }
+
+    struct stat st;
+    const qint64 fileSize = ::fstat(fd, &st) == 0 ? qint64(st.st_size) : 0;
+    // Последовательно — один проход с начала; случайно — по всему файлу,
+    // чтобы большой образ не уместился в кэше устройства
+    qint64 span = 0;
+    switch (pattern) {
+    case DiskBench::Pattern::SeqWrite:  span = options.bytesPerTest; break;
+    case DiskBench::Pattern::SeqRead:   span = qMin(fileSize, options.bytesPerTest); break;
+    case DiskBench::Pattern::RandWrite:
+    case DiskBench::Pattern::RandRead:  span = fileSize; break;
+    }
+    const qint64 blocks = span / block;
+    if (blocks == 0) {
+        ::close(fd);
+        result.error = QString("файл меньше блока %1 КБ").arg(block / 1024);
+        return result;
+    }
+
+#ifdef POSIX_FADV_DONTNEED
+    // Холодное чтение: выкидываем образ из кэша хоста (ARC на ZFS это не трогает)
+    if (!write && mode == DiskBench::Mode::Buffered)
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+
+    const qint64 limit = sequential ? blocks * block : options.bytesPerTest;
+    QRandomGenerator *random = QRandomGenerator::global();
+    QElapsedTimer clock;
+    QElapsedTimer op;
+    clock.start();
+    qint64 offset = 0;
+    while (result.bytes < limit && clock.elapsed() < options.maxMsPerTest) {
+        if (cancel && cancel->load())
+            break;
+        const qint64 position = sequential ? offset : qint64(random->generate64() % quint64(blocks)) * block;
+        op.start();
+        const ssize_t done = write ? ::pwrite(fd, buffer, size_t(block), off_t(position))
+                                   : ::pread(fd, buffer, size_t(block), off_t(position));
+        const qint64 us = op.nsecsElapsed() / 1000;
+        if (done < 0) {
+            result.error = errnoMessage(errno, mode);
+            break;
+        }
+        if (done == 0)
+            break;
+        result.latencyUs.record(us);
+        result.bytes += done;
+        offset += block;
+    }
+    // Буферизованная запись без fsync мерила бы только память
+    if (write && result.error.isEmpty() && ::fsync(fd) != 0)
+        result.error = errnoMessage(errno, mode);
+    result.elapsedUs = clock.nsecsElapsed() / 1000;
+    ::close(fd);
+    return result;
+}
+
+} // namespace
+
+// ======================== Result ========================
+double DiskBench::Result::mbPerSec() const
+{
+    return elapsedUs > 0 ? double(bytes) / (1024.0 * 1024.0) / (double(elapsedUs) / 1e6) : 0.0;
+}
+
+double DiskBench::Result::iops() const
+{
+    return elapsedUs > 0 ? double(latencyUs.count()) / (double(elapsedUs) / 1e6) : 0.0;
+}
+
+QString DiskBench::Result::summary() const
+{
+    const QString name = modeName(mode) + " " + patternName(pattern);
+    if (!error.isEmpty())
+        return QString("%1: ошибка — %2").arg(name, error);
+    return QString("%1: %2 МБ/с, %3 IOPS, p50 %4, p99 %5")
+        .arg(name)
+        .arg(mbPerSec(), 0, 'f', 1)
+        .arg(qRound64(iops()))
+        .arg(formatLatency(latencyUs.percentile(50)), formatLatency(latencyUs.percentile(99)));
+}
+
+// ======================== Report ========================
+void DiskBench::Report::recommend()
+{
+    auto find = [this](Mode mode, Pattern pattern) -> const Result * {
+        for (const Result &result : results) {
+            if (result.mode == mode && result.pattern == pattern)
+                return &result;
+        }
+        return nullptr;
+    };
+
+    hasRecommendation = false;
+    double best = 0;
+    for (Mode mode : {Mode::Buffered, Mode::NoCache, Mode::Sync}) {
+        double logSum = 0;
+        bool complete = true;
+        for (Pattern pattern : AllPatterns) {
+            const Result *result = find(isSkipped(mode, pattern) ? Mode::Buffered : mode, pattern);
+            if (!result || !result->ok() || result->mbPerSec() <= 0) {
+                complete = false;
+                break;
+            }
+            logSum += std::log(result->mbPerSec());
+        }
+        if (!complete)
+            continue;
+        const double score = std::exp(logSum / AllPatterns.size());
+        if (!hasRecommendation || score > best) {
+            hasRecommendation = true;
+            recommended = mode;
+            best = score;
+        }
+    }
+}
+
+DiskProfile DiskBench::Report::apply(DiskProfile base) const
+{
+    base.nocache = recommended == Mode::NoCache;
+    base.direct = recommended == Mode::Sync;
+    return base;
+}
+
+QString DiskBench::Report::summary() const
+{
+    if (!error.isEmpty())
+        return "Замер не выполнен: " + error;
+    QStringList lines;
+    lines << "Чтение: " + target;
+    for (const Result &result : results)
+        lines << result.summary();
+    if (cancelled)
+        lines << "Замер прерван";
+    else if (hasRecommendation)
+        lines << "Быстрее всего: " + modeName(recommended);
+    else
+        lines << "Ни один режим не прошёл все тесты";
+    return lines.join('\n');
+}
+
+// ======================== DiskBench ========================
+QString DiskBench::modeName(Mode mode)
+{
+    // Имена опций bhyve, как в профиле диска
+    switch (mode) {
+    case Mode::Buffered: return "buffered";
+    case Mode::NoCache:  return "nocache";
+    case Mode::Sync:     return "direct";
+    }
+    return QString();
+}
+
+QString DiskBench::patternName(Pattern pattern)
+{
+    switch (pattern) {
+    case Pattern::SeqWrite:  return "seq-write";
+    case Pattern::RandWrite: return "rand-write";
+    case Pattern::SeqRead:   return "seq-read";
+    case Pattern::RandRead:  return "rand-read";
+    }
+    return QString();
+}
+
+QString DiskBench::formatLatency(qint64 us)
+{
+    if (us < 1000)
+        return QString("%1 мкс").arg(us);
+    return QString("%1 мс").arg(double(us) / 1000.0, 0, 'f', 1);
+}
+
+DiskBench::Report DiskBench::run(const Options &options, const std::atomic_bool *cancel, const Progress &progress)
+{
+    Report report;
+    report.path = options.path;
+    const QFileInfo info(options.path);
+    if (!info.exists()) {
+        report.error = "путь не найден: " + options.path;
+        return report;
+    }
+    const QString pool = info.isDir() ? info.absoluteFilePath() : info.absolutePath();
+    const QString scratch = QDir(pool).filePath(
+        QString(".vmrun-diskbench-%1.tmp").arg(QCoreApplication::applicationPid()));
+    report.target = info.isDir() ? scratch : info.absoluteFilePath();
+
+    AlignedBuffer buffer(size_t(SeqBlockBytes));
+    if (!buffer.data()) {
+        report.error = "не удалось выделить буфер";
+        return report;
+    }
+    // Случайные данные: нулевые блоки ZFS сжимает и на диск не пишет
+    QRandomGenerator::global()->fillRange(static_cast<quint32 *>(buffer.data()), SeqBlockBytes / sizeof(quint32));
+
+    int total = 0;
+    for (Mode mode : options.modes) {
+        for (Pattern pattern : AllPatterns)
+            total += isSkipped(mode, pattern) ? 0 : 1;
+    }
+
+    // Внутри режима запись идёт первой: случайная запись и чтение каталога
+    // работают по файлу, который заполнила последовательная запись
+    int done = 0;
+    for (Mode mode : options.modes) {
+        for (Pattern pattern : AllPatterns) {
+            if (isSkipped(mode, pattern))
+                continue;
+            if (cancel && cancel->load()) {
+                report.cancelled = true;
+                break;
+            }
+            if (progress)
+                progress(done, total, modeName(mode) + " " + patternName(pattern));
+            report.results.append(measure(mode, pattern, isWrite(pattern) ? scratch : report.target,
+                                          buffer.data(), options, cancel));
+            ++done;
+        }
+        if (report.cancelled)
+            break;
+    }
+    QFile::remove(scratch);
+    if (cancel && cancel->load())
+        report.cancelled = true;
+    if (progress)
+        progress(done, total, QString());
+    if (!report.cancelled)
+        report.recommend();
+    return report;
+}
@@ -0,0 +1,93 @@
+#ifndef DISKBENCH_H
+#define DISKBENCH_H
+
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+#include "latencyhistogram.h"
+#include "vmconfig.h"
+
+// Замер ввода-вывода на пуле хранения образов, чтобы выбрать профиль диска
+// (DiskProfile) под конкретную ФС. Режимы соответствуют опциям bhyve:
+//   Buffered — без опций, через кэш хоста;
+//   NoCache  — nocache, O_DIRECT: мимо кэша, нужны выровненные буферы;
+//   Sync     — direct, O_SYNC: каждая запись до диска (чтение как Buffered).
+// Чтение идёт по самому образу (только чтение, кэш хоста перед тестом
+// сбрасывается), запись — во временный файл рядом с ним: образ не
+// меняется, а файл лежит на той же ФС. Если задан каталог, всё идёт по
+// временному файлу. Запуск блокирующий — вызывать из рабочего потока.
+class DiskBench
+{
+public:
+    enum class Mode {
+        Buffered,
+        NoCache,
+        Sync
+    };
+
+    enum class Pattern {
+        SeqWrite,
+        RandWrite,
+        SeqRead,
+        RandRead
+    };
+
+    static constexpr int SeqBlockBytes = 1 << 20;
+    static constexpr int RandBlockBytes = 4096;
+    static constexpr int Alignment = 4096;  // O_DIRECT: адрес, смещение и длина кратны сектору
+    static constexpr qint64 DefaultBytesPerTest = 256LL << 20;
+    static constexpr int DefaultMaxMsPerTest = 5000;
+
+    struct Options {
+        QString path;  // образ или каталог пула
+        QVector<Mode> modes = {Mode::Buffered, Mode::NoCache, Mode::Sync};
+        qint64 bytesPerTest = DefaultBytesPerTest;  // объём временного файла и предел на тест
+        int maxMsPerTest = DefaultMaxMsPerTest;     // тест обрывается по времени, результат остаётся
+    };
+
+    struct Result {
+        Mode mode = Mode::Buffered;
+        Pattern pattern = Pattern::SeqRead;
+        QString error;  // непусто — тест не прошёл (например, O_DIRECT не поддерживается ФС)
+        qint64 bytes = 0;
+        qint64 elapsedUs = 0;
+        LatencyHistogram latencyUs;  // задержка одной операции, мкс
+
+        bool ok() const { return error.isEmpty() && latencyUs.count() > 0; }
+        double mbPerSec() const;
+        double iops() const;
+        // "nocache seq-read: 812.4 МБ/с, 812 IOPS, p50 1.2 мс, p99 3.4 мс"
+        QString summary() const;
+    };
+
+    struct Report {
+        QString path;
+        QString target;  // файл, по которому шло чтение
+        QVector<Result> results;
+        QString error;   // непусто — замер не состоялся вовсе
+        bool cancelled = false;
+        bool hasRecommendation = false;
+        Mode recommended = Mode::Buffered;
+
+        // Лучший режим — по среднему геометрическому МБ/с всех четырёх
+        // тестов; режим, у которого хоть один тест не прошёл, не участвует
+        void recommend();
+        // Опции рекомендованного режима поверх base (модель и ro не меняются)
+        DiskProfile apply(DiskProfile base) const;
+        QString summary() const;
+    };
+
+    // done из total тестов, step — что сейчас идёт
+    using Progress = std::function<void(int done, int total, const QString &step)>;
+
+    static QString modeName(Mode mode);
+    static QString patternName(Pattern pattern);
+    static QString formatLatency(qint64 us);  // "850 мкс", "12.4 мс"
+
+    static Report run(const Options &options, const std::atomic_bool *cancel = nullptr,
+                      const Progress &progress = Progress());
+};
+
+#endif // DISKBENCH_H
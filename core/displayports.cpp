@@ -0,0 +1,79 @@
+#include "displayports.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+void DisplayPorts::setRange(int first, int last)
+{
+    m_firstPort = qBound(1, first, 65535);
+    m_lastPort = qBound(m_firstPort, last, 65535);
+}
+
+int DisplayPorts::acquire(const QString &vm, int preferred)
+{
+    release(vm);
+    // Порт из настроек ВМ — только он: клиенты ждут её именно там
+    if (preferred > 0) {
+        if (!isFree(preferred))
+            return 0;
+        reserve(vm, preferred);
+        return preferred;
+    }
+
+    // Прошлый порт ВМ; чужие прошлые порты обходим, пока есть другие
+    const int last = m_last.value(vm);
+    if (last > 0 && isFree(last)) {
+        reserve(vm, last);
+        return last;
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int port = m_firstPort; port <= m_lastPort; ++port) {
+            bool remembered = false;
+            for (auto it = m_last.cbegin(); it != m_last.cend() && pass == 0; ++it)
+                remembered = remembered || (it.value() == port && it.key() != vm);
+            if (!remembered && isFree(port)) {
+                reserve(vm, port);
+                return port;
+            }
+        }
+    }
+    return 0;
+}
+
+void DisplayPorts::reserve(const QString &vm, int port)
+{
+    m_ports.insert(vm, port);
+    m_last.insert(vm, port);
+}
+
+void DisplayPorts::release(const QString &vm)
+{
+    m_ports.remove(vm);
+}
+
+bool DisplayPorts::isFree(int port) const
+{
+    for (auto it = m_ports.cbegin(); it != m_ports.cend(); ++it) {
+        if (it.value() == port)
+            return false;
+    }
+    return m_probe ? m_probe(port) : canBind(port);
+}
+
+bool DisplayPorts::canBind(int port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return true;  // проверить нечем — решит bhyve
+    // Как у bhyve: TIME_WAIT от прошлого гостя не мешает
+    const int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(quint16(port));
+    const bool free = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+    ::close(fd);
+    return free;
+}
@@ -0,0 +1,51 @@
+#ifndef DISPLAYPORTS_H
+#define DISPLAYPORTS_H
+
+#include <QHash>
+#include <QString>
+#include <functional>
+
+// VNC-порты гостей. bhyve fbuf слушает tcp=<адрес>:<порт>, и с одним
+// портом на всех вторая ВМ не стартует. Порт выдаётся при каждом запуске
+// из диапазона (по умолчанию FirstPort..LastPort — сотня гостей): сначала
+// заданный в настройках ВМ, затем тот, что был у неё в прошлый раз (клиенты
+// переподключаются туда же), затем первый свободный. Свободный — не занят
+// нашими ВМ и bind() на нём проходит: порт мог занять чужой процесс.
+class DisplayPorts
+{
+public:
+    static constexpr int FirstPort = 5900;
+    static constexpr int LastPort = 5999;
+
+    // true — порт можно отдать; по умолчанию пробный bind() на INADDR_ANY
+    using Probe = std::function<bool(int port)>;
+    void setProbe(const Probe &probe) { m_probe = probe; }
+
+    // Диапазон для выдачи без заданного порта; больше сотни гостей на узле —
+    // шире (заданные в настройках ВМ порты проверяются и вне его)
+    void setRange(int first, int last);
+    int firstPort() const { return m_firstPort; }
+    int lastPort() const { return m_lastPort; }
+
+    // 0 — свободных портов нет (или занят заданный preferred)
+    int acquire(const QString &vm, int preferred = 0);
+    // Порт гостя, который уже работает (подхват)
+    void reserve(const QString &vm, int port);
+    void release(const QString &vm);
+
+    int port(const QString &vm) const { return m_ports.value(vm); }
+    const QHash<QString, int> &assignments() const { return m_ports; }
+
+    static bool canBind(int port);
+
+private:
+    bool isFree(int port) const;
+
+    QHash<QString, int> m_ports;  // выданные сейчас
+    QHash<QString, int> m_last;   // последний порт каждой ВМ
+    Probe m_probe;
+    int m_firstPort = FirstPort;
+    int m_lastPort = LastPort;
+};
+
+#endif // DISPLAYPORTS_H
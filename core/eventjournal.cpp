@@ -0,0 +1,341 @@
+#include "eventjournal.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QRandomGenerator>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtConcurrent>
+#include <chrono>
+
+namespace {
+
+qint64 monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// ======================== JournalWriter ========================
+// Поток, который дописывает готовые строки в файл пачками. Очередь
+// ограничена: если диск не успевает, строки теряются, а не копятся в памяти
+// и не тормозят поток GUI.
+class JournalWriter : public QThread
+{
+public:
+    static constexpr int MaxQueued = 65536;
+    static constexpr qint64 MaxFileBytes = 64LL * 1024 * 1024;  // дальше — в <файл>.1
+
+    void setPath(const QString &path)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_path = path;
+        m_reopen = true;
+        m_cond.wakeOne();
+    }
+
+    void enqueue(const QByteArray &line)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_queue.size() >= MaxQueued) {
+            ++m_dropped;
+            return;
+        }
+        m_queue.append(line);
+        m_cond.wakeOne();
+    }
+
+    // Дописывает всё, что уже в очереди, и завершает поток
+    void shutdown()
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_cond.wakeOne();
+        }
+        wait();
+    }
+
+    quint64 dropped() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_dropped;
+    }
+
+    QString error() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_error;
+    }
+
+protected:
+    void run() override
+    {
+        QFile file;
+        QString path;
+        for (;;) {
+            QByteArrayList batch;
+            bool reopen = false;
+            {
+                QMutexLocker locker(&m_mutex);
+                while (m_queue.isEmpty() && !m_reopen && !m_stopping)
+                    m_cond.wait(&m_mutex);
+                if (m_queue.isEmpty() && !m_reopen && m_stopping)
+                    break;
+                batch.swap(m_queue);
+                reopen = m_reopen;
+                m_reopen = false;
+                path = m_path;
+            }
+
+            if (reopen || (file.isOpen() && file.size() >= MaxFileBytes)) {
+                const bool rotate = !reopen;
+                file.close();
+                if (rotate) {
+                    QFile::remove(path + ".1");
+                    QFile::rename(path, path + ".1");
+                }
+                if (!path.isEmpty())
+                    open(file, path);
+            }
+
+            if (!file.isOpen()) {
+                QMutexLocker locker(&m_mutex);
+                m_dropped += quint64(batch.size());
+                continue;
+            }
+            for (const QByteArray &line : qAsConst(batch))
+                file.write(line);
+            file.flush();
+        }
+    }
+
+private:
+    void open(QFile &file, const QString &path)
+    {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        file.setFileName(path);
+        const bool ok = file.open(QIODevice::WriteOnly | QIODevice::Append);
+        QMutexLocker locker(&m_mutex);
+        m_error = ok ? QString() : path + ": " + file.errorString();
+    }
+
+    mutable QMutex m_mutex;  // всё ниже
+    QWaitCondition m_cond;
+    QByteArrayList m_queue;
+    QString m_path;
+    QString m_error;
+    quint64 m_dropped = 0;
+    bool m_reopen = false;
+    bool m_stopping = false;
+};
+
+// ======================== EventJournal ========================
+namespace {
+
+// Метка процесса в каждой строке: loadHistory() не считает дважды
+// события, которые уже попали в статистику в этом же запуске программы
+const QString &sessionId()
+{
+    static const QString id = QString::number(QRandomGenerator::global()->generate64(), 16);
+    return id;
+}
+
+} // namespace
+
+EventJournal::EventJournal(QObject *parent)
+    : QObject(parent)
+    , m_writer(new JournalWriter)
+{
+    m_writer->setObjectName("vmrun-journal");
+    m_writer->start(QThread::LowPriority);
+
+    connect(&m_history, &QFutureWatcher<History>::finished, this, [this]() {
+        const History history = m_history.result();
+        for (auto it = history.stats.cbegin(); it != history.stats.cend(); ++it) {
+            PhaseStats &stats = m_stats[it.key()];
+            for (int i = 0; i < PhaseCount; ++i)
+                stats[i].merge(it.value()[i]);
+        }
+        emit historyLoaded(history.events);
+    });
+}
+
+EventJournal::~EventJournal()
+{
+    m_history.waitForFinished();
+    m_writer->shutdown();
+    delete m_writer;
+}
+
+QString EventJournal::phaseKey(VmPhase phase)
+{
+    switch (phase) {
+    case VmPhase::Validate:      return "validate";
+    case VmPhase::Spawn:         return "spawn";
+    case VmPhase::Started:       return "started";
+    case VmPhase::TapAttached:   return "tap_attached";
+    case VmPhase::BridgeJoined:  return "bridge_joined";
+    case VmPhase::StopRequested: return "stop_requested";
+    case VmPhase::Finished:      return "finished";
+    case VmPhase::Destroyed:     return "destroyed";
+    }
+    return QString();
+}
+
+QString EventJournal::phaseTitle(VmPhase phase)
+{
+    switch (phase) {
+    case VmPhase::Validate:      return "Проверка конфигурации";
+    case VmPhase::Spawn:         return "Запуск процесса";
+    case VmPhase::Started:       return "bhyve стартовал";
+    case VmPhase::TapAttached:   return "tap появился";
+    case VmPhase::BridgeJoined:  return "tap в bridge0";
+    case VmPhase::StopRequested: return "Запрошена остановка";
+    case VmPhase::Finished:      return "bhyve завершился";
+    case VmPhase::Destroyed:     return "Очистка завершена";
+    }
+    return QString();
+}
+
+bool EventJournal::phaseFromKey(const QString &key, VmPhase *phase)
+{
+    for (int i = 0; i < PhaseCount; ++i) {
+        if (phaseKey(VmPhase(i)) == key) {
+            *phase = VmPhase(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+VmPhase EventJournal::usualAnchor(VmPhase phase)
+{
+    if (phase == VmPhase::Validate || phase == VmPhase::StopRequested)
+        return phase;
+    return VmPhase(int(phase) - 1);
+}
+
+void EventJournal::setFile(const QString &path)
+{
+    if (path == m_path)
+        return;
+    m_path = path;
+    m_writer->setPath(path);
+}
+
+void EventJournal::loadHistory()
+{
+    if (m_path.isEmpty() || m_history.isRunning())
+        return;
+    m_history.setFuture(QtConcurrent::run(&EventJournal::readHistory, m_path));
+}
+
+// Поток пула: ротированный файл, затем текущий. Нужны только vm/phase/ms.
+EventJournal::History EventJournal::readHistory(const QString &path)
+{
+    History history;
+    for (const QString &name : {path + ".1", path}) {
+        QFile file(name);
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        while (!file.atEnd()) {
+            const QJsonObject event = QJsonDocument::fromJson(file.readLine()).object();
+            const double ms = event.value("ms").toDouble(-1);
+            VmPhase phase;
+            if (ms < 0 || event.value("session").toString() == sessionId()
+                || !phaseFromKey(event.value("phase").toString(), &phase))
+                continue;
+            history.stats[event.value("vm").toString()][int(phase)].record(qRound64(ms));
+            ++history.events;
+        }
+    }
+    return history;
+}
+
+void EventJournal::record(const QString &vm, quint64 run, VmPhase phase, const QString &detail)
+{
+    const qint64 nowNs = monotonicNs();
+
+    // Новый запуск — старые отметки больше не отсчёт
+    RunMarks &marks = m_runs[vm];
+    if (marks.run != run || phase == VmPhase::Validate) {
+        marks.run = run;
+        marks.atNs.fill(-1);
+    }
+    marks.atNs[int(phase)] = nowNs;
+
+    // Отрезок — от ближайшей отмеченной фазы той же половины цикла:
+    // запуск (Validate..BridgeJoined) или остановка (StopRequested..Destroyed).
+    // У Finished без stop() (ВМ вышла сама) отсчёта нет.
+    const int first = int(phase) <= int(VmPhase::BridgeJoined) ? int(VmPhase::Validate)
+                                                              : int(VmPhase::StopRequested);
+    int from = -1;
+    for (int p = int(phase) - 1; p >= first; --p) {
+        if (marks.atNs[p] >= 0) {
+            from = p;
+            break;
+        }
+    }
+    const double ms = from >= 0 ? double(nowNs - marks.atNs[from]) / 1e6 : -1;
+    if (from >= 0) {
+        m_stats[vm][int(phase)].record(qRound64(ms));
+        ++m_recorded;
+    }
+
+    if (m_path.isEmpty())
+        return;
+
+    QJsonObject event {
+        {"ts", QDateTime::currentMSecsSinceEpoch()},
+        {"mono_ns", nowNs},
+        {"session", sessionId()},
+        {"vm", vm},
+        {"run", double(run)},
+        {"phase", phaseKey(phase)},
+    };
+    if (from >= 0) {
+        event.insert("from", phaseKey(VmPhase(from)));
+        event.insert("ms", qRound64(ms * 1000) / 1000.0);
+    }
+    if (!detail.isEmpty())
+        event.insert("detail", detail);
+    m_writer->enqueue(QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n');
+}
+
+EventJournal::PhaseStats EventJournal::stats(const QString &vm) const
+{
+    if (!vm.isEmpty())
+        return m_stats.value(vm);
+
+    PhaseStats total;
+    for (const PhaseStats &stats : m_stats) {
+        for (int i = 0; i < PhaseCount; ++i)
+            total[i].merge(stats[i]);
+    }
+    return total;
+}
+
+QStringList EventJournal::vms() const
+{
+    QStringList names = m_stats.keys();
+    names.sort();
+    return names;
+}
+
+quint64 EventJournal::droppedCount() const
+{
+    return m_writer->dropped();
+}
+
+QString EventJournal::writeError() const
+{
+    return m_writer->error();
+}
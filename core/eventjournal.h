@@ -0,0 +1,92 @@
+#ifndef EVENTJOURNAL_H
+#define EVENTJOURNAL_H
+
+#include <QObject>
+#include <QHash>
+#include <QFutureWatcher>
+#include <array>
+#include <atomic>
+
+#include "latencyhistogram.h"
+
+// Фазы жизненного цикла одного запуска ВМ в порядке, в котором они идут
+enum class VmPhase {
+    Validate,       // launch(): проверка конфигурации
+    Spawn,          // GuestProcess::start()
+    Started,        // GuestProcess::started (или подхват работающего гостя)
+    TapAttached,    // tap появился в системе
+    BridgeJoined,   // tap в bridge0, сеть готова
+    StopRequested,  // stop()
+    Finished,       // GuestProcess::finished
+    Destroyed       // bhyvectl --destroy и deletem отработали
+};
+
+class JournalWriter;
+
+// Журнал событий ВМ: каждая фаза каждого запуска одной строкой JSON
+// (append-only, JSON lines) с монотонным временем. Запись в файл —
+// в отдельном потоке, record() только кладёт готовую строку в очередь.
+//
+// Для каждой фазы считается длительность отрезка от предыдущей фазы того же
+// запуска (Started — от Spawn, Destroyed — от Finished и т.д.); отрезки
+// копятся в гистограммах по ВМ. loadHistory() подтягивает их из файла,
+// чтобы статистика переживала перезапуск программы.
+class EventJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int PhaseCount = int(VmPhase::Destroyed) + 1;
+    using PhaseStats = std::array<LatencyHistogram, PhaseCount>;
+
+    explicit EventJournal(QObject *parent = nullptr);
+    ~EventJournal() override;
+
+    static QString phaseKey(VmPhase phase);    // "bridge_joined" — в файле
+    static QString phaseTitle(VmPhase phase);  // для людей
+    static bool phaseFromKey(const QString &key, VmPhase *phase);
+    // Фаза, от которой обычно отсчитывается отрезок; phase — если отсчёта нет
+    static VmPhase usualAnchor(VmPhase phase);
+
+    // Пустой путь — только статистика в памяти, без файла
+    void setFile(const QString &path);
+    QString file() const { return m_path; }
+
+    // Фоновое чтение файла; по окончании — historyLoaded()
+    void loadHistory();
+    bool isLoadingHistory() const { return m_history.isRunning(); }
+
+    // run — номер запуска ВМ (VmInstance меняет его в каждом launch())
+    void record(const QString &vm, quint64 run, VmPhase phase, const QString &detail = QString());
+
+    // Пустое имя — сумма по всем ВМ
+    PhaseStats stats(const QString &vm = QString()) const;
+    QStringList vms() const;
+    quint64 recordedCount() const { return m_recorded; }
+    quint64 droppedCount() const;  // не влезли в очередь писателя
+    QString writeError() const;
+
+signals:
+    void historyLoaded(int events);
+
+private:
+    struct History {
+        QHash<QString, PhaseStats> stats;
+        int events = 0;
+    };
+    static History readHistory(const QString &path);
+
+    struct RunMarks {
+        quint64 run = 0;
+        std::array<qint64, PhaseCount> atNs;
+    };
+
+    QString m_path;
+    JournalWriter *m_writer;
+    QHash<QString, RunMarks> m_runs;
+    QHash<QString, PhaseStats> m_stats;
+    quint64 m_recorded = 0;
+    QFutureWatcher<History> m_history;
+};
+
+#endif // EVENTJOURNAL_H
@@ -0,0 +1,476 @@
+#include "guestprocess.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QSaveFile>
+#include <QSysInfo>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <signal.h>
+
+namespace {
+
+// $1 — каталог, $2 — имя ВМ, дальше — команда гостя. HUP/INT игнорируем:
+// закрытый терминал или Ctrl+C в vmrun не должны гасить гостя; в терминал
+// vmrun прослойка ничего не пишет.
+//
+// stdout/stderr гостя идут через FIFO в rotate: куски <имя>.out.N по 4 МиБ
+// (dd — 1024 чтения по 4 КиБ), пока пишется N-й, (N-4)-й удаляется — на
+// поток не больше 16 МиБ, и никто не обрезает файл, в который пишут.
+// Кусок N+1 создаётся, только когда N дописан. Сломался dd (диск полон) —
+// поток дочитывается в /dev/null: гость не должен встать на записи в полный
+// канал. Код выхода кладём после того, как rotate дописал последний кусок;
+// если FIFO держит открытым потомок гостя, rotate ждём не дольше секунды.
+const char *const ShimScript = R"(trap '' HUP INT
+exec 2> /dev/null
+dir=$1
+name=$2
+shift 2
+rotate() {
+    n=0
+    while dd bs=4096 count=1024 of="$1.$n" 2> /dev/null && [ -s "$1.$n" ]; do
+        n=$((n + 1))
+        rm -f "$1.$((n - 4))"
+    done
+    cat > /dev/null
+}
+rm -f "$dir/$name.pid" "$dir/$name.exit" "$dir/$name.out" "$dir/$name.err" "$dir/$name".out.* "$dir/$name".err.*
+mkfifo "$dir/$name.out.fifo" "$dir/$name.err.fifo" || exit 1
+rotate "$dir/$name.out" < "$dir/$name.out.fifo" &
+out=$!
+rotate "$dir/$name.err" < "$dir/$name.err.fifo" &
+err=$!
+"$@" > "$dir/$name.out.fifo" 2> "$dir/$name.err.fifo" < /dev/null &
+child=$!
+echo "$child $$" > "$dir/$name.pid.tmp" && mv "$dir/$name.pid.tmp" "$dir/$name.pid"
+wait "$child"
+code=$?
+( sleep 1; kill $out $err 2> /dev/null ) &
+timer=$!
+wait $out $err
+kill $timer 2> /dev/null
+rm -f "$dir/$name.out.fifo" "$dir/$name.err.fifo"
+echo "$code" > "$dir/$name.exit.tmp" && mv "$dir/$name.exit.tmp" "$dir/$name.exit"
+)";
+
+constexpr int StartPollMs = 10;
+
+// Куски вывода <base>.N, которые прослойка ещё не удалила, по возрастанию
+QVector<int> outputSegments(const QString &base)
+{
+    const QFileInfo info(base);
+    const QString prefix = info.fileName() + '.';
+    QVector<int> segments;
+    for (const QString &name : info.dir().entryList({prefix + '*'}, QDir::Files)) {
+        bool ok = false;
+        const int number = name.mid(prefix.size()).toInt(&ok);
+        if (ok && number >= 0)
+            segments.append(number);
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+QString segmentPath(const QString &base, int segment)
+{
+    return base + '.' + QString::number(segment);
+}
+
+// Кусок после segment; -1 — прослойка его ещё не начала
+int nextSegment(const QString &base, int segment, const QFile *current)
+{
+    if (QFile::exists(segmentPath(base, segment + 1)))
+        return segment + 1;
+    if (current && current->exists())
+        return -1;
+    // Текущего куска уже нет: vmrun отстал больше чем на три куска, и
+    // прослойка удалила следующие за ним — берём ближайший оставшийся
+    const QVector<int> segments = outputSegments(base);
+    const auto next = std::upper_bound(segments.cbegin(), segments.cend(), segment);
+    return next == segments.cend() ? -1 : *next;
+}
+
+} // namespace
+
+// ======================== GuestState ========================
+QJsonObject GuestState::toJson() const
+{
+    QJsonObject json;
+    json["name"] = name;
+    json["pid"] = pid;
+    json["shim_pid"] = shimPid;
+    json["tap"] = tap;
+    json["vnc_port"] = vncPort;
+    json["console"] = console;
+    json["started_at"] = startedAtMs;
+    json["boot_id"] = QString::fromLatin1(QSysInfo::bootUniqueId());
+    json["memory"] = config.memory;
+    json["disk"] = config.diskPath;
+    json["disk_profile"] = config.diskProfile.toString();
+    QJsonArray extraDisks;
+    for (const DiskConfig &disk : config.extraDisks)
+        extraDisks.append(QJsonObject {{"path", disk.path}, {"profile", disk.profile.toString()}});
+    json["extra_disks"] = extraDisks;
+    json["iso"] = config.isoPath;
+    json["cpu"] = config.cpu.bhyveArgument();
+    QJsonArray pins;
+    for (int cpu : pinning)
+        pins.append(cpu);
+    json["pinning"] = pins;
+    return json;
+}
+
+bool GuestState::fromJson(const QJsonObject &json, GuestState *state)
+{
+    state->name = json["name"].toString();
+    state->pid = qint64(json["pid"].toDouble());
+    state->shimPid = qint64(json["shim_pid"].toDouble());
+    state->tap = json["tap"].toString();
+    state->vncPort = json["vnc_port"].toInt();
+    state->console = json["console"].toString();
+    state->startedAtMs = qint64(json["started_at"].toDouble());
+    state->config.name = state->name;
+    state->config.tap = state->tap;
+    state->config.memory = json["memory"].toString();
+    state->config.diskPath = json["disk"].toString();
+    // Файлы старых версий хранили только модель устройства
+    DiskProfile::parse(json["disk_profile"].toString(json["disk_device"].toString("ahci-hd")),
+                       &state->config.diskProfile);
+    state->config.extraDisks.clear();
+    for (const QJsonValue &value : json["extra_disks"].toArray()) {
+        DiskConfig disk;
+        disk.path = value["path"].toString();
+        DiskProfile::parse(value["profile"].toString(), &disk.profile);
+        state->config.extraDisks.append(disk);
+    }
+    state->config.isoPath = json["iso"].toString();
+    CpuConfig::parse(json["cpu"].toString("1"), &state->config.cpu);
+    state->pinning.clear();
+    for (const QJsonValue &cpu : json["pinning"].toArray())
+        state->pinning.append(cpu.toInt());
+    state->config.cpu.pin = !state->pinning.isEmpty();
+
+    // Файл пережил перезагрузку хоста — pid уже принадлежат другим процессам
+    const QString bootId = json["boot_id"].toString();
+    if (!bootId.isEmpty() && bootId != QString::fromLatin1(QSysInfo::bootUniqueId()))
+        state->pid = state->shimPid = 0;
+    return !state->name.isEmpty();
+}
+
+// ======================== GuestProcess ========================
+GuestProcess::GuestProcess(const QString &name, QObject *parent)
+    : QObject(parent)
+    , m_name(name)
+{
+    connect(&m_poll, &QTimer::timeout, this, &GuestProcess::poll);
+}
+
+GuestProcess::~GuestProcess() = default;
+
+QStringList GuestProcess::stateFiles(const QString &dir)
+{
+    QStringList files;
+    for (const QString &name : QDir(dir).entryList({"*.json"}, QDir::Files, QDir::Name))
+        files << QDir(dir).filePath(name);
+    return files;
+}
+
+bool GuestProcess::readState(const QString &path, GuestState *state, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!doc.isObject() || !GuestState::fromJson(doc.object(), state)) {
+        if (error)
+            *error = doc.isObject() ? QString("нет имени ВМ") : parseError.errorString();
+        return false;
+    }
+    return true;
+}
+
+void GuestProcess::discardState(const QString &dir, const QString &name)
+{
+    const QDir runtime(dir);
+    for (const char *suffix : {".json", ".pid", ".pid.tmp", ".exit", ".exit.tmp", ".out", ".err",
+                               ".out.fifo", ".err.fifo"})
+        QFile::remove(runtime.filePath(name + QLatin1String(suffix)));
+    for (const char *suffix : {".out", ".err"}) {
+        const QString base = runtime.filePath(name + QLatin1String(suffix));
+        for (int segment : outputSegments(base))
+            QFile::remove(segmentPath(base, segment));
+    }
+}
+
+bool GuestProcess::isAlive(qint64 pid)
+{
+    return pid > 0 && (::kill(pid_t(pid), 0) == 0 || errno == EPERM);
+}
+
+QString GuestProcess::path(const char *suffix) const
+{
+    return QDir(m_dir).filePath(m_name + QLatin1String(suffix));
+}
+
+bool GuestProcess::start(const QString &program, const QStringList &arguments, const GuestState &state)
+{
+    if (m_running)
+        return false;
+    m_state = state;
+    m_state.name = m_name;
+    m_state.pid = 0;
+    m_state.shimPid = 0;
+    m_error.clear();
+
+    if (m_dir.isEmpty() || !QDir().mkpath(m_dir)) {
+        m_error = "не создать каталог состояния гостей: " + m_dir;
+        return false;
+    }
+    QFile::remove(path(".json"));
+
+    qint64 shimPid = 0;
+    const QStringList shimArgs = QStringList {"-c", ShimScript, "vmrun-shim", m_dir, m_name, program} + arguments;
+    if (!QProcess::startDetached("/bin/sh", shimArgs, m_dir, &shimPid)) {
+        m_error = "не удалось запустить /bin/sh";
+        return false;
+    }
+
+    m_state.shimPid = shimPid;
+    m_running = true;
+    m_pidKnown = false;
+    m_startClock.start();
+    m_poll.start(StartPollMs);
+    return true;
+}
+
+bool GuestProcess::attach()
+{
+    if (m_running)
+        return true;
+    GuestState state;
+    if (!readState(path(".json"), &state, &m_error))
+        return false;
+    if (state.isStale()) {
+        discardState(m_dir, m_name);
+        m_error = "гость остался от прошлой загрузки хоста";
+        return false;
+    }
+
+    m_state = state;
+    m_running = true;
+    m_pidKnown = true;
+    openOutput(AttachTailBytes);
+    // Первый опрос — сразу: гость мог умереть, пока нас не было
+    m_poll.start(0);
+    return true;
+}
+
+void GuestProcess::detach()
+{
+    m_poll.stop();
+    drainOutput();
+    m_out.file.reset();
+    m_err.file.reset();
+    m_running = false;
+}
+
+void GuestProcess::kill()
+{
+    if (!m_running)
+        return;
+    if (m_state.pid > 0)
+        ::kill(pid_t(m_state.pid), SIGKILL);
+    else if (m_state.shimPid > 0)
+        ::kill(pid_t(m_state.shimPid), SIGKILL);
+}
+
+// ======================== Опрос файлов прослойки ========================
+void GuestProcess::poll()
+{
+    if (!m_pidKnown) {
+        if (!readPidFile()) {
+            const bool shimAlive = isAlive(m_state.shimPid);
+            if (shimAlive && m_startClock.elapsed() < StartDeadlineMs)
+                return;
+            if (shimAlive)
+                ::kill(pid_t(m_state.shimPid), SIGKILL);
+            m_poll.stop();
+            m_running = false;
+            m_error = shimAlive ? QString("прослойка не запустила гостя за %1 с").arg(StartDeadlineMs / 1000)
+                                : QString("прослойка завершилась, не запустив гостя");
+            emit failedToStart(m_error);
+            return;
+        }
+        m_pidKnown = true;
+        m_state.startedAtMs = QDateTime::currentMSecsSinceEpoch();
+        openOutput(0);
+        if (!writeState())
+            emit output(LogSeverity::Warning, ("[vmrun] состояние гостя не сохранено: " + m_error + "\n").toUtf8());
+        m_poll.setInterval(PollMs);
+        emit started();
+    }
+
+    const bool more = drainOutput();
+
+    // Код пишется до выхода прослойки — проверяем его раньше, чем pid
+    QFile exitFile(path(".exit"));
+    if (!exitFile.exists() && (isAlive(m_state.shimPid) || isAlive(m_state.pid))) {
+        m_poll.setInterval(more ? 0 : PollMs);
+        return;
+    }
+    if (exitFile.open(QIODevice::ReadOnly)) {
+        bool ok = false;
+        const int code = exitFile.readAll().trimmed().toInt(&ok);
+        // 128 + N — гость убит сигналом N
+        finish(ok ? code : -1, !ok || code > 128);
+        return;
+    }
+    finish(-1, true);
+}
+
+bool GuestProcess::readPidFile()
+{
+    QFile file(path(".pid"));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QList<QByteArray> fields = file.readAll().simplified().split(' ');
+    const qint64 pid = fields.value(0).toLongLong();
+    if (pid <= 0)
+        return false;
+    m_state.pid = pid;
+    m_state.shimPid = fields.value(1).toLongLong();
+    return true;
+}
+
+bool GuestProcess::openOutput(qint64 tailBytes)
+{
+    m_out.base = path(".out");
+    m_out.severity = LogSeverity::Stdout;
+    m_err.base = path(".err");
+    m_err.severity = LogSeverity::Stderr;
+    const bool out = openStream(m_out, tailBytes);
+    return openStream(m_err, tailBytes) && out;
+}
+
+bool GuestProcess::openStream(OutputStream &stream, qint64 tailBytes)
+{
+    stream.file.reset();
+    stream.segment = -1;
+
+    const QVector<int> segments = outputSegments(stream.base);
+    QString fileName;
+    qint64 keep = tailBytes;  // столько байт с конца выбранного файла
+    if (!segments.isEmpty()) {
+        int i = tailBytes > 0 ? segments.size() - 1 : 0;
+        // Свежий кусок короче хвоста — хвост начинается в предыдущем
+        for (; i > 0; --i) {
+            const qint64 size = QFileInfo(segmentPath(stream.base, segments[i])).size();
+            if (size >= keep)
+                break;
+            keep -= size;
+        }
+        stream.segment = segments[i];
+        fileName = segmentPath(stream.base, stream.segment);
+    } else if (tailBytes > 0 && QFile::exists(stream.base)) {
+        // Гость запущен прежней версией vmrun: весь вывод в одном файле
+        fileName = stream.base;
+    } else {
+        // Первый кусок прослойка ещё не создала — его найдёт drainOutput
+        return false;
+    }
+
+    stream.file.reset(new QFile(fileName));
+    if (!stream.file->open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        stream.file.reset();
+        return false;
+    }
+    const qint64 size = stream.file->size();
+    if (tailBytes <= 0 || size <= keep)
+        return true;
+    // Начинаем с целой строки
+    stream.file->seek(size - keep);
+    const QByteArray head = stream.file->read(keep);
+    const int newline = head.indexOf('\n');
+    stream.file->seek(size - keep + (newline >= 0 ? newline + 1 : head.size()));
+    return true;
+}
+
+bool GuestProcess::drainOutput()
+{
+    qint64 budget = ReadChunkBytes;
+    for (OutputStream *stream : {&m_out, &m_err}) {
+        while (budget > 0) {
+            if (stream->file) {
+                const QByteArray data = stream->file->read(budget);
+                if (!data.isEmpty()) {
+                    budget -= data.size();
+                    emit output(stream->severity, data);
+                    continue;
+                }
+            }
+
+            // Конец куска. Следующего нет — гость просто молчит
+            const int next = stream->base.isEmpty() ? -1
+                                                    : nextSegment(stream->base, stream->segment, stream->file.get());
+            if (next < 0)
+                break;
+            // Следующий начат — значит, этот дописан: забираем остаток целиком
+            if (stream->file) {
+                const QByteArray rest = stream->file->readAll();
+                if (!rest.isEmpty()) {
+                    budget -= rest.size();
+                    emit output(stream->severity, rest);
+                }
+            }
+            stream->segment = next;
+            stream->file.reset(new QFile(segmentPath(stream->base, stream->segment)));
+            if (!stream->file->open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+                stream->file.reset();
+        }
+    }
+    return budget <= 0;
+}
+
+void GuestProcess::finish(int exitCode, bool crashed)
+{
+    m_poll.stop();
+    while (drainOutput()) {
+    }
+    m_out.file.reset();
+    m_err.file.reset();
+    m_running = false;
+    removeStateFiles();
+    emit finished(exitCode, crashed);
+}
+
+void GuestProcess::removeStateFiles()
+{
+    for (const char *suffix : {".json", ".pid", ".exit"})
+        QFile::remove(path(suffix));
+}
+
+bool GuestProcess::writeState()
+{
+    QSaveFile file(path(".json"));
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(m_state.toJson()).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        m_error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef GUESTPROCESS_H
+#define GUESTPROCESS_H
+
+#include <QObject>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+#include "vmconfig.h"
+#include "logbuffer.h"
+
+class QJsonObject;
+
+// Что нужно, чтобы подхватить работающего гостя после перезапуска vmrun:
+// файл <каталог>/<имя>.json рядом с выводом гостя
+struct GuestState {
+    QString name;
+    qint64 pid = 0;        // doas → bhyve (doas делает exec, pid тот же)
+    qint64 shimPid = 0;    // shell-прослойка, ждущая выхода гостя
+    QString tap;
+    int vncPort = 0;
+    QString console;       // устройство com1 гостя (SerialConsole::guestDevice)
+    qint64 startedAtMs = 0;
+    QVector<int> pinning;  // vCPU → процессор хоста (bhyve -p); пусто — без закрепления
+    VmConfig config;       // имя, память, процессоры, диск, ISO — для VmConfig при подхвате
+
+    // Файл пережил перезагрузку хоста (fromJson обнулил pid): гостя нет,
+    // подхватывать и считать сбоем нечего
+    bool isStale() const { return pid <= 0 && shimPid <= 0; }
+
+    QJsonObject toJson() const;
+    static bool fromJson(const QJsonObject &json, GuestState *state);
+};
+
+// Процесс bhyve, не привязанный к жизни vmrun. Запускается через
+// QProcess::startDetached под маленькой shell-прослойкой, которая:
+//   - пишет stdout/stderr гостя кусками <имя>.out.N / <имя>.err.N
+//     (по 4 МиБ, хранит четыре последних),
+//   - кладёт "pid shimPid" в <имя>.pid сразу после запуска,
+//   - ждёт выхода и кладёт код в <имя>.exit.
+// Окно (или CLI) читает эти файлы по таймеру; закрылось — гость работает
+// дальше, следующий запуск находит <имя>.json и подхватывает его через
+// attach() без перезагрузки гостя.
+//
+// Сигналы повторяют нужное VmInstance подмножество QProcess.
+class GuestProcess : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int PollMs = 100;
+    static constexpr int StartDeadlineMs = 5000;   // прослойка не отчиталась — сбой запуска
+    static constexpr qint64 ReadChunkBytes = 4 * 1024 * 1024;
+    static constexpr qint64 AttachTailBytes = 64 * 1024;  // столько вывода показываем при подхвате
+
+    GuestProcess(const QString &name, QObject *parent = nullptr);
+    ~GuestProcess() override;
+
+    void setDirectory(const QString &dir) { m_dir = dir; }
+    QString directory() const { return m_dir; }
+
+    // Файлы состояния всех гостей каталога
+    static QStringList stateFiles(const QString &dir);
+    static bool readState(const QString &path, GuestState *state, QString *error = nullptr);
+    // Удалить все файлы гостя name: состояние, pid, код выхода, куски вывода
+    static void discardState(const QString &dir, const QString &name);
+    // Жив ли процесс (в том числе чужой, root: EPERM — тоже "жив")
+    static bool isAlive(qint64 pid);
+
+    bool start(const QString &program, const QStringList &arguments, const GuestState &state);
+    // Подхватить гостя по <имя>.json; false — файла нет, он битый или
+    // остался от прошлой загрузки хоста (тогда файлы гостя удаляются).
+    // Умерший без нас гость сообщит о себе finished() из цикла событий
+    bool attach();
+    // Перестать следить, гостя не трогать: файлы состояния остаются
+    void detach();
+    // SIGKILL гостю напрямую (если он запущен без doas) и прослойке, пока
+    // гость ещё не запущен
+    void kill();
+
+    bool isRunning() const { return m_running; }
+    qint64 processId() const { return m_state.pid; }
+    const GuestState &state() const { return m_state; }
+    QString errorString() const { return m_error; }
+
+signals:
+    void started();
+    void output(LogSeverity severity, const QByteArray &data);
+    void finished(int exitCode, bool crashed);
+    void failedToStart(const QString &error);
+
+private:
+    QString path(const char *suffix) const;
+    void poll();
+    bool readPidFile();
+    // Поток вывода гостя: читаем его куски по порядку номеров
+    struct OutputStream {
+        QString base;        // <каталог>/<имя>.out, куски — base.N
+        LogSeverity severity = LogSeverity::Stdout;
+        int segment = -1;
+        std::unique_ptr<QFile> file;
+    };
+
+    bool openOutput(qint64 tailBytes);
+    bool openStream(OutputStream &stream, qint64 tailBytes);
+    bool drainOutput();  // true — прочитали ReadChunkBytes, есть ещё
+    void finish(int exitCode, bool crashed);
+    void removeStateFiles();
+    bool writeState();
+
+    QString m_name;
+    QString m_dir;
+    GuestState m_state;
+    bool m_running = false;
+    bool m_pidKnown = false;
+    QString m_error;
+    QTimer m_poll;
+    QElapsedTimer m_startClock;
+    OutputStream m_out;
+    OutputStream m_err;
+};
+
+#endif // GUESTPROCESS_H
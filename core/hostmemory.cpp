@@ -0,0 +1,127 @@
+#include "hostmemory.h"
+
+#include <QFile>
+#include <QStringList>
+
+#if defined(Q_OS_FREEBSD)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#endif
+
+namespace {
+
+#if defined(Q_OS_FREEBSD)
+template <typename T>
+bool sysctlValue(const char *name, T *value)
+{
+    size_t len = sizeof(*value);
+    return ::sysctlbyname(name, value, &len, nullptr, 0) == 0 && len == sizeof(*value);
+}
+
+// Счётчики страниц vm.stats.vm.* — u_int, физическая память и предел wired — u_long
+class SysctlMemoryBackend : public HostMemoryBackend
+{
+public:
+    QString name() const override { return "sysctl"; }
+
+    bool read(HostMemory *memory) override
+    {
+        u_int pageSize = 0, freeCount = 0, inactiveCount = 0, wireCount = 0;
+        u_long physmem = 0, maxUserWired = 0;
+        if (!sysctlValue("vm.stats.vm.v_page_size", &pageSize) || !sysctlValue("hw.physmem", &physmem)
+            || !sysctlValue("vm.stats.vm.v_free_count", &freeCount)
+            || !sysctlValue("vm.stats.vm.v_inactive_count", &inactiveCount)
+            || !sysctlValue("vm.stats.vm.v_wire_count", &wireCount))
+            return false;
+        memory->totalBytes = physmem;
+        memory->availableBytes = (quint64(freeCount) + inactiveCount) * pageSize;
+        memory->wiredBytes = quint64(wireCount) * pageSize;
+        memory->wireLimitBytes = sysctlValue("vm.max_user_wired", &maxUserWired) ? quint64(maxUserWired) * pageSize : 0;
+        return true;
+    }
+};
+#endif
+
+class NullMemoryBackend : public HostMemoryBackend
+{
+public:
+    QString name() const override { return "none"; }
+    bool read(HostMemory *) override { return false; }
+};
+
+} // namespace
+
+std::unique_ptr<HostMemoryBackend> HostMemoryBackend::create()
+{
+    const QStringList fake = qEnvironmentVariable("VMRUN_FAKE_HOST_MEMORY").split(':');
+    if (fake.size() == 2) {
+        HostMemory memory;
+        memory.totalBytes = fake[0].toULongLong() << 20;
+        memory.availableBytes = fake[1].toULongLong() << 20;
+        return std::make_unique<FakeHostMemoryBackend>(memory);
+    }
+#if defined(Q_OS_LINUX)
+    return std::make_unique<MeminfoBackend>();
+#elif defined(Q_OS_FREEBSD)
+    return std::make_unique<SysctlMemoryBackend>();
+#else
+    return std::make_unique<NullMemoryBackend>();
+#endif
+}
+
+// ======================== /proc/meminfo ========================
+MeminfoBackend::MeminfoBackend(const QString &path)
+    : m_path(path)
+{
+}
+
+bool MeminfoBackend::read(HostMemory *memory)
+{
+    // procfs отдаёт размер 0 — читаем до конца, а не size()
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    return parse(file.readAll(), memory);
+}
+
+// Mlocked — ближайший аналог wired: bhyve -S на Linux не бывает, но
+// закреплённая память гостей (QEMU -mem-lock и т.п.) видна там
+bool MeminfoBackend::parse(const QByteArray &text, HostMemory *memory)
+{
+    bool haveTotal = false, haveAvailable = false;
+    quint64 free = 0, cached = 0, buffers = 0;
+    for (const QByteArray &line : text.split('\n')) {
+        const int colon = line.indexOf(':');
+        if (colon <= 0)
+            continue;
+        const QByteArray key = line.left(colon);
+        const QList<QByteArray> fields = line.mid(colon + 1).simplified().split(' ');
+        const quint64 value = fields.value(0).toULongLong() * (fields.value(1) == "kB" ? 1024 : 1);
+        if (key == "MemTotal") {
+            memory->totalBytes = value;
+            haveTotal = true;
+        } else if (key == "MemAvailable") {
+            memory->availableBytes = value;
+            haveAvailable = true;
+        } else if (key == "MemFree") {
+            free = value;
+        } else if (key == "Cached") {
+            cached = value;
+        } else if (key == "Buffers") {
+            buffers = value;
+        } else if (key == "Mlocked") {
+            memory->wiredBytes = value;
+        }
+    }
+    // Ядра старше 3.14 MemAvailable не знают
+    if (!haveAvailable)
+        memory->availableBytes = free + cached + buffers;
+    memory->wireLimitBytes = 0;
+    return haveTotal;
+}
+
+bool FakeHostMemoryBackend::read(HostMemory *memory)
+{
+    *memory = m_memory;
+    return m_memory.totalBytes > 0;
+}
@@ -0,0 +1,65 @@
+#ifndef HOSTMEMORY_H
+#define HOSTMEMORY_H
+
+#include <QtGlobal>
+#include <QString>
+#include <memory>
+
+// Память хоста на момент чтения
+struct HostMemory {
+    quint64 totalBytes = 0;
+    quint64 availableBytes = 0;  // можно занять без вытеснения: MemAvailable / free + inactive
+    quint64 wiredBytes = 0;      // не вытесняемая: Mlocked / v_wire_count
+    quint64 wireLimitBytes = 0;  // предел wired для процессов (vm.max_user_wired); 0 — нет
+};
+
+// Чтение HostMemory из ОС. Вызывается из GUI-потока при каждом решении о
+// запуске и по таймеру очереди — реализации должны быть дешёвыми.
+class HostMemoryBackend
+{
+public:
+    virtual ~HostMemoryBackend() = default;
+
+    virtual QString name() const = 0;
+    // false — прочитать не удалось
+    virtual bool read(HostMemory *memory) = 0;
+
+    // /proc/meminfo на Linux, sysctl vm.stats на FreeBSD, иначе заглушка;
+    // VMRUN_FAKE_HOST_MEMORY=всего:доступно (МБ) — постоянные числа для
+    // прогонов без гипервизора
+    static std::unique_ptr<HostMemoryBackend> create();
+};
+
+// Файл в формате /proc/meminfo ("MemTotal:  16318480 kB")
+class MeminfoBackend : public HostMemoryBackend
+{
+public:
+    explicit MeminfoBackend(const QString &path = "/proc/meminfo");
+
+    QString name() const override { return "meminfo"; }
+    bool read(HostMemory *memory) override;
+
+    static bool parse(const QByteArray &text, HostMemory *memory);
+
+private:
+    QString m_path;
+};
+
+// Числа задаются снаружи — для bench и VMRUN_FAKE_HOST_MEMORY
+class FakeHostMemoryBackend : public HostMemoryBackend
+{
+public:
+    explicit FakeHostMemoryBackend(const HostMemory &memory = HostMemory())
+        : m_memory(memory)
+    {
+    }
+
+    QString name() const override { return "fake"; }
+    bool read(HostMemory *memory) override;
+    void set(const HostMemory &memory) { m_memory = memory; }
+
+private:
+    HostMemory m_memory;
+};
+
+#endif // HOSTMEMORY_H
@@ -0,0 +1,410 @@
+#include "imageclone.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QStorageInfo>
+#include <QtConcurrent>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(Q_OS_LINUX)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+namespace {
+
+// ======================== Участки с данными ========================
+// Следующий участок с данными начиная с pos: [*begin, *end). false — до
+// конца файла одни дыры
+bool nextExtent(int fd, qint64 pos, qint64 size, bool *seekable, qint64 *begin, qint64 *end)
+{
+#ifdef SEEK_DATA
+    if (*seekable) {
+        const off_t data = ::lseek(fd, off_t(pos), SEEK_DATA);
+        if (data >= 0) {
+            const off_t hole = ::lseek(fd, data, SEEK_HOLE);
+            *begin = qint64(data);
+            *end = hole >= 0 ? qMin(qint64(hole), size) : size;
+            return *begin < size;
+        }
+        if (errno == ENXIO)
+            return false;
+        // ФС не умеет искать дыры — дальше файл целиком
+        *seekable = false;
+    }
+#endif
+    *seekable = false;
+    *begin = pos;
+    *end = size;
+    return pos < size;
+}
+
+bool isZero(const char *data, qint64 size)
+{
+    // Первый байт отсекает почти все блоки с данными сразу
+    return size == 0 || (data[0] == 0 && ::memcmp(data, data + 1, size_t(size - 1)) == 0);
+}
+
+// Ошибки, после которых copy_file_range бесполезен для этой пары файлов
+bool copyRangeUnsupported(int error)
+{
+    return error == EXDEV || error == ENOSYS || error == EOPNOTSUPP || error == EINVAL || error == EBADF;
+}
+
+} // namespace
+
+// ======================== ImageCopy ========================
+namespace ImageCopy {
+
+QString methodName(Method method)
+{
+    switch (method) {
+    case Method::Reflink:   return "reflink";
+    case Method::CopyRange: return "copy_file_range";
+    case Method::Sparse:    return "sparse";
+    }
+    return QString();
+}
+
+Result copy(const QString &source, const QString &target, const Options &options,
+            const std::atomic_bool *cancel, Progress *progress)
+{
+    Result result;
+    QElapsedTimer clock;
+    clock.start();
+    Progress local;
+    if (!progress)
+        progress = &local;
+    auto cancelled = [cancel]() { return cancel && cancel->load(); };
+
+    const int in = ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (in < 0 || ::fstat(in, &st) != 0) {
+        result.error = source + ": " + qt_error_string(errno);
+        if (in >= 0)
+            ::close(in);
+        return result;
+    }
+    const qint64 size = qint64(st.st_size);
+    result.totalBytes = size;
+    progress->totalBytes = size;
+
+    const QString part = target + ".part";
+    QDir().mkpath(QFileInfo(target).absolutePath());
+    const int out = ::open(QFile::encodeName(part).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (out < 0) {
+        result.error = part + ": " + qt_error_string(errno);
+        ::close(in);
+        return result;
+    }
+
+    bool done = false;
+#if defined(FICLONE)
+    if (options.reflink && ::ioctl(out, FICLONE, in) == 0) {
+        result.method = Method::Reflink;
+        progress->method = int(result.method);
+        progress->doneBytes = size;
+        done = true;
+    }
+#endif
+
+    if (!done) {
+        // Дыры получаются сами: файл сразу нужной длины, пишутся только данные
+        if (::ftruncate(out, off_t(size)) != 0)
+            result.error = part + ": " + qt_error_string(errno);
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
+        bool useCopyRange = options.copyRange;
+#else
+        bool useCopyRange = false;
+#endif
+        result.method = useCopyRange ? Method::CopyRange : Method::Sparse;
+        progress->method = int(result.method);
+        QByteArray buffer;
+        bool seekable = true;
+        qint64 pos = 0;
+        qint64 begin = 0, end = 0;
+        while (result.error.isEmpty() && !cancelled() && nextExtent(in, pos, size, &seekable, &begin, &end)) {
+            progress->doneBytes = begin;
+            qint64 offset = begin;
+            while (offset < end && result.error.isEmpty() && !cancelled()) {
+                const qint64 chunk = qMin<qint64>(options.chunkBytes, end - offset);
+                qint64 n = 0;
+                bool written = true;
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
+                if (useCopyRange) {
+                    off_t inOffset = off_t(offset), outOffset = off_t(offset);
+                    n = qint64(::copy_file_range(in, &inOffset, out, &outOffset, size_t(chunk), 0));
+                    if (n < 0 && copyRangeUnsupported(errno) && result.copiedBytes == 0) {
+                        // Ядро или ФС не умеют — этот и все следующие участки через буфер
+                        useCopyRange = false;
+                        result.method = Method::Sparse;
+                        progress->method = int(result.method);
+                        continue;
+                    }
+                }
+#endif
+                if (!useCopyRange) {
+                    if (buffer.size() < chunk)
+                        buffer.resize(int(chunk));
+                    n = qint64(::pread(in, buffer.data(), size_t(chunk), off_t(offset)));
+                    written = n > 0 && !isZero(buffer.constData(), n);
+                    if (written && ::pwrite(out, buffer.constData(), size_t(n), off_t(offset)) != n)
+                        n = -1;
+                }
+                if (n < 0) {
+                    result.error = qt_error_string(errno);
+                    break;
+                }
+                if (n == 0)  // файл укоротили на ходу
+                    break;
+                offset += n;
+                if (written)
+                    result.copiedBytes += n;
+                progress->copiedBytes = result.copiedBytes;
+                progress->doneBytes = offset;
+            }
+            pos = end;
+        }
+    }
+
+    result.cancelled = cancelled();
+    if (result.ok() && ::fsync(out) != 0)
+        result.error = part + ": " + qt_error_string(errno);
+    ::close(out);
+    ::close(in);
+
+    if (result.ok() && QFileInfo::exists(target))
+        result.error = target + ": уже существует";
+    if (result.ok() && ::rename(QFile::encodeName(part).constData(), QFile::encodeName(target).constData()) != 0)
+        result.error = target + ": " + qt_error_string(errno);
+    if (!result.ok()) {
+        ::unlink(QFile::encodeName(part).constData());
+        // Каталог ВМ, созданный под копию, пустым не оставляем
+        QDir().rmdir(QFileInfo(target).absolutePath());
+    } else {
+        progress->doneBytes = size;
+    }
+    result.elapsedMs = clock.elapsed();
+    return result;
+}
+
+} // namespace ImageCopy
+
+// ======================== ImageCloner ========================
+double ImageCloner::Job::mbPerSec() const
+{
+    return elapsedMs > 0 ? double(copiedBytes) / (1024.0 * 1024.0) / (double(elapsedMs) / 1000.0) : 0.0;
+}
+
+QString ImageCloner::Job::summary() const
+{
+    const double gib = 1024.0 * 1024.0 * 1024.0;
+    QString text = QString("%1 из %2 ГБ за %3 с, данных %4 ГБ, %5 МБ/с")
+                       .arg(double(doneBytes) / gib, 0, 'f', 1)
+                       .arg(double(totalBytes) / gib, 0, 'f', 1)
+                       .arg(elapsedMs / 1000)
+                       .arg(double(copiedBytes) / gib, 0, 'f', 1)
+                       .arg(mbPerSec(), 0, 'f', 0);
+    if (!method.isEmpty())
+        text += " (" + method + ")";
+    if (!error.isEmpty())
+        text += ": " + error;
+    return text;
+}
+
+ImageCloner::ImageCloner(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(16);
+    m_poll.setInterval(ProgressIntervalMs);
+    connect(&m_poll, &QTimer::timeout, this, &ImageCloner::pollProgress);
+}
+
+ImageCloner::~ImageCloner()
+{
+    // Недописанные копии отменяем — .part удалит сам поток
+    cancelAll();
+    waitForAll();
+}
+
+void ImageCloner::setMaxParallel(int jobs)
+{
+    m_maxParallel = qMax(1, jobs);
+    startQueued();
+}
+
+QString ImageCloner::stateName(State state)
+{
+    switch (state) {
+    case State::Queued:    return "в очереди";
+    case State::Running:   return "копируется";
+    case State::Done:      return "готово";
+    case State::Failed:    return "ошибка";
+    case State::Cancelled: return "отменено";
+    }
+    return QString();
+}
+
+int ImageCloner::clone(const QString &source, const QString &target, QString *error)
+{
+    QString why;
+    if (!QFileInfo(source).isFile())
+        why = "шаблон не найден: " + source;
+    else if (QFileInfo::exists(target))
+        why = "образ уже существует: " + target;
+    for (const Task &task : m_tasks) {
+        if (why.isEmpty() && !task.job.isFinished() && task.job.target == target)
+            why = "в этот образ уже идёт копия: " + target;
+    }
+    if (!why.isEmpty()) {
+        if (error)
+            *error = why;
+        return 0;
+    }
+
+    // Каталога ВМ ещё нет — устройство определяем по ближайшему существующему
+    QDir dir = QFileInfo(target).absoluteDir();
+    while (!dir.exists() && dir.cdUp()) {
+    }
+
+    Task task;
+    task.job.id = m_nextId++;
+    task.job.source = source;
+    task.job.target = target;
+    task.job.totalBytes = QFileInfo(source).size();
+    task.device = QString::fromLocal8Bit(QStorageInfo(dir.absolutePath()).device());
+    task.progress = std::make_shared<ImageCopy::Progress>();
+    task.cancel = std::make_shared<std::atomic_bool>(false);
+    m_tasks.insert(task.job.id, task);
+    emit jobChanged(task.job.id);
+    startQueued();
+    return task.job.id;
+}
+
+void ImageCloner::cancel(int id)
+{
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end() || it->job.isFinished())
+        return;
+    if (it->job.state == State::Queued) {
+        it->job.state = State::Cancelled;
+        emit jobChanged(id);
+        emit jobFinished(id);
+        if (activeCount() == 0)
+            emit allFinished();
+        return;
+    }
+    // Поток заметит флаг на границе куска и удалит .part
+    it->cancel->store(true);
+}
+
+void ImageCloner::cancelAll()
+{
+    for (int id : m_tasks.keys())
+        cancel(id);
+}
+
+void ImageCloner::waitForAll()
+{
+    for (const Task &task : m_tasks) {
+        if (task.watcher)
+            task.watcher->waitForFinished();
+    }
+}
+
+QVector<ImageCloner::Job> ImageCloner::jobs() const
+{
+    QVector<Job> list;
+    for (const Task &task : m_tasks)
+        list.append(task.job);
+    return list;
+}
+
+int ImageCloner::activeCount() const
+{
+    int active = 0;
+    for (const Task &task : m_tasks)
+        active += task.job.isFinished() ? 0 : 1;
+    return active;
+}
+
+// Очередь по порядку постановки; копия ждёт, только если её устройство
+// уже занято maxParallel копиями
+void ImageCloner::startQueued()
+{
+    QHash<QString, int> running;
+    for (const Task &task : m_tasks) {
+        if (task.job.state == State::Running)
+            ++running[task.device];
+    }
+    for (Task &task : m_tasks) {
+        if (task.job.state != State::Queued || running.value(task.device) >= m_maxParallel)
+            continue;
+        ++running[task.device];
+        task.job.state = State::Running;
+        task.clock.start();
+        task.watcher = new QFutureWatcher<ImageCopy::Result>(this);
+        const int id = task.job.id;
+        connect(task.watcher, &QFutureWatcher<ImageCopy::Result>::finished, this, [this, id]() { onFinished(id); });
+        task.watcher->setFuture(QtConcurrent::run(&m_pool, [source = task.job.source, target = task.job.target,
+                                                             options = m_options, cancel = task.cancel,
+                                                             progress = task.progress]() {
+            return ImageCopy::copy(source, target, options, cancel.get(), progress.get());
+        }));
+        emit jobChanged(id);
+    }
+    if (!m_poll.isActive() && activeCount() > 0)
+        m_poll.start();
+}
+
+void ImageCloner::pollProgress()
+{
+    bool running = false;
+    for (Task &task : m_tasks) {
+        if (task.job.state != State::Running)
+            continue;
+        running = true;
+        task.job.totalBytes = task.progress->totalBytes;
+        task.job.doneBytes = task.progress->doneBytes;
+        task.job.copiedBytes = task.progress->copiedBytes;
+        task.job.method = ImageCopy::methodName(ImageCopy::Method(task.progress->method.load()));
+        task.job.elapsedMs = task.clock.elapsed();
+        emit jobChanged(task.job.id);
+    }
+    if (!running)
+        m_poll.stop();
+}
+
+void ImageCloner::onFinished(int id)
+{
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end())
+        return;
+    const ImageCopy::Result result = it->watcher->result();
+    it->watcher->deleteLater();
+    it->watcher = nullptr;
+
+    Job &job = it->job;
+    job.totalBytes = result.totalBytes;
+    job.doneBytes = result.ok() ? result.totalBytes : it->progress->doneBytes.load();
+    job.copiedBytes = result.copiedBytes;
+    job.elapsedMs = result.elapsedMs;
+    job.method = ImageCopy::methodName(result.method);
+    job.error = result.error;
+    job.state = result.cancelled ? State::Cancelled : result.ok() ? State::Done : State::Failed;
+    emit jobChanged(id);
+    emit jobFinished(id);
+
+    startQueued();
+    if (activeCount() == 0)
+        emit allFinished();
+}
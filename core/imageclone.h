@@ -0,0 +1,152 @@
+#ifndef IMAGECLONE_H
+#define IMAGECLONE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QMap>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+
+// Копия образа диска, которая не раздувает разреженный файл. Способы по
+// убыванию скорости:
+//   Reflink   — FICLONE (Btrfs, XFS): общие блоки, копия мгновенная;
+//   CopyRange — copy_file_range() по участкам с данными: копирует ядро
+//               (на ZFS FreeBSD 14 — клонирование блоков), дыры остаются;
+//   Sparse    — pread/pwrite по участкам с данными, нулевые блоки не
+//               пишутся — копия разреженная, даже если исходник нет.
+// Участки ищутся SEEK_DATA/SEEK_HOLE; где ФС их не умеет (ntfs-3g),
+// весь файл считается одним участком. Копия пишется в "<цель>.part" и
+// переименовывается только целиком — прерванная не оставляет образа.
+namespace ImageCopy {
+
+enum class Method {
+    Reflink,
+    CopyRange,
+    Sparse
+};
+
+QString methodName(Method method);
+
+struct Options {
+    bool reflink = true;    // false — не пробовать FICLONE
+    bool copyRange = true;  // false — сразу pread/pwrite
+    int chunkBytes = 8 << 20;  // шаг прогресса и проверки отмены
+};
+
+// Пишет рабочий поток, читает кто угодно
+struct Progress {
+    std::atomic<qint64> totalBytes {0};
+    std::atomic<qint64> doneBytes {0};    // пройдено по файлу, вместе с дырами
+    std::atomic<qint64> copiedBytes {0};  // реально скопировано данных
+    std::atomic<int> method {int(Method::Sparse)};
+};
+
+struct Result {
+    Method method = Method::Sparse;
+    qint64 totalBytes = 0;
+    qint64 copiedBytes = 0;
+    qint64 elapsedMs = 0;
+    bool cancelled = false;
+    QString error;
+
+    bool ok() const { return error.isEmpty() && !cancelled; }
+};
+
+// Блокирующая копия — вызывать из рабочего потока. target не должен существовать
+Result copy(const QString &source, const QString &target, const Options &options = Options(),
+            const std::atomic_bool *cancel = nullptr, Progress *progress = nullptr);
+
+} // namespace ImageCopy
+
+// Очередь клонирования образов. Копии идут в собственном пуле потоков
+// (сканирование каталога и поиск по архиву их не ждут), но на одно
+// устройство хранения одновременно — не больше maxParallel: несколько
+// параллельных потоков на одном диске медленнее, чем по очереди, и
+// забирают всю его полосу у работающих ВМ.
+class ImageCloner : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultParallel = 2;
+    static constexpr int ProgressIntervalMs = 250;
+
+    enum class State {
+        Queued,
+        Running,
+        Done,
+        Failed,
+        Cancelled
+    };
+
+    struct Job {
+        int id = 0;
+        QString source;
+        QString target;
+        State state = State::Queued;
+        QString method;  // имя ImageCopy::Method, пока идёт — текущий
+        qint64 totalBytes = 0;
+        qint64 doneBytes = 0;
+        qint64 copiedBytes = 0;
+        qint64 elapsedMs = 0;
+        QString error;
+
+        bool isFinished() const { return state != State::Queued && state != State::Running; }
+        int percent() const { return totalBytes > 0 ? int(doneBytes * 100 / totalBytes) : 0; }
+        double mbPerSec() const;
+        // "12.3 из 100.0 ГБ за 45 с, данных 8.1 ГБ, 280 МБ/с (copy_file_range)";
+        // МБ/с — по реально скопированным данным, то есть нагрузка на диск
+        QString summary() const;
+    };
+
+    explicit ImageCloner(QObject *parent = nullptr);
+    ~ImageCloner() override;
+
+    void setMaxParallel(int jobs);  // на одно устройство
+    int maxParallel() const { return m_maxParallel; }
+    void setCopyOptions(const ImageCopy::Options &options) { m_options = options; }
+
+    static QString stateName(State state);
+
+    // Ставит копию в очередь; 0 — не поставлена, причина в error
+    int clone(const QString &source, const QString &target, QString *error = nullptr);
+    void cancel(int id);
+    void cancelAll();
+    // Блокирует до окончания всех копий — для деструктора и bench
+    void waitForAll();
+
+    Job job(int id) const { return m_tasks.value(id).job; }
+    QVector<Job> jobs() const;
+    int activeCount() const;
+
+signals:
+    void jobChanged(int id);
+    void jobFinished(int id);
+    void allFinished();
+
+private:
+    struct Task {
+        Job job;
+        QString device;  // QStorageInfo::device() каталога цели
+        std::shared_ptr<ImageCopy::Progress> progress;
+        std::shared_ptr<std::atomic_bool> cancel;
+        QFutureWatcher<ImageCopy::Result> *watcher = nullptr;
+        QElapsedTimer clock;
+    };
+
+    void startQueued();
+    void pollProgress();
+    void onFinished(int id);
+
+    QThreadPool m_pool;
+    QMap<int, Task> m_tasks;
+    QTimer m_poll;
+    ImageCopy::Options m_options;
+    int m_maxParallel = DefaultParallel;
+    int m_nextId = 1;
+};
+
+#endif // IMAGECLONE_H
@@ -0,0 +1,251 @@
+#include "interfacewatcher.h"
+
+#include <QTimer>
+#include <QSocketNotifier>
+#include <QDebug>
+
+#include <net/if.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#if defined(Q_OS_LINUX)
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#elif defined(Q_OS_FREEBSD)
+#include <net/route.h>
+#endif
+
+// ======================== InterfaceWatcher ========================
+InterfaceWatcher *InterfaceWatcher::create(QObject *parent)
+{
+    const QString backend = qEnvironmentVariable("VMRUN_NET_BACKEND", "auto");
+    if (backend == "fake") {
+        bool ok = false;
+        const int delay = qEnvironmentVariableIntValue("VMRUN_FAKE_TAP_DELAY_MS", &ok);
+        return new FakeInterfaceWatcher(ok ? delay : 0, parent);
+    }
+    if (backend == "poll")
+        return new PollingInterfaceWatcher(parent);
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
+    auto *kernel = new KernelInterfaceWatcher(parent);
+    if (kernel->isValid())
+        return kernel;
+    qWarning() << "InterfaceWatcher: событийный сокет недоступен, переходим на опрос";
+    delete kernel;
+#endif
+    return new PollingInterfaceWatcher(parent);
+}
+
+InterfaceWatcher::InterfaceWatcher(QObject *parent)
+    : QObject(parent)
+{
+}
+
+InterfaceWatcher::~InterfaceWatcher() = default;
+
+bool InterfaceWatcher::interfaceExists(const QString &ifname) const
+{
+    return !ifname.isEmpty() && if_nametoindex(ifname.toLocal8Bit().constData()) != 0;
+}
+
+quint64 InterfaceWatcher::waitFor(const QString &ifname, int deadlineMs, QObject *context, ReadyCallback callback)
+{
+    const quint64 id = m_nextId++;
+
+    Waiter waiter;
+    waiter.ifname = ifname;
+    waiter.context = context;
+    waiter.hasContext = context != nullptr;
+    waiter.callback = std::move(callback);
+    waiter.deadlineMs = deadlineMs;
+    waiter.pollMs = initialPollMs();
+    waiter.timer = new QTimer(this);
+    waiter.timer->setSingleShot(true);
+    connect(waiter.timer, &QTimer::timeout, this, [this, id]() { poll(id); });
+    waiter.clock.start();
+    m_waiters.insert(id, waiter);
+
+    waitStarted(ifname);
+    // Первая проверка — сразу, но уже из цикла событий: callback никогда не
+    // вызывается внутри waitFor()
+    m_waiters[id].timer->start(0);
+    return id;
+}
+
+void InterfaceWatcher::cancel(quint64 id)
+{
+    auto it = m_waiters.find(id);
+    if (it == m_waiters.end())
+        return;
+    it->timer->deleteLater();
+    m_waiters.erase(it);
+}
+
+void InterfaceWatcher::notifyInterface(const QString &ifname)
+{
+    const QList<quint64> ids = m_waiters.keys();
+    for (quint64 id : ids) {
+        auto it = m_waiters.constFind(id);
+        if (it != m_waiters.constEnd() && it->ifname == ifname)
+            finish(id, true);
+    }
+}
+
+void InterfaceWatcher::recheckAll()
+{
+    const QList<quint64> ids = m_waiters.keys();
+    for (quint64 id : ids) {
+        auto it = m_waiters.constFind(id);
+        if (it != m_waiters.constEnd() && interfaceExists(it->ifname))
+            finish(id, true);
+    }
+}
+
+void InterfaceWatcher::poll(quint64 id)
+{
+    auto it = m_waiters.find(id);
+    if (it == m_waiters.end())
+        return;
+
+    if (interfaceExists(it->ifname)) {
+        finish(id, true);
+        return;
+    }
+
+    const qint64 remaining = it->deadlineMs - it->clock.elapsed();
+    if (remaining <= 0) {
+        finish(id, false);
+        return;
+    }
+
+    const int delay = int(qMin<qint64>(it->pollMs, remaining));
+    it->pollMs = qMin(it->pollMs * 2, maxPollMs());
+    it->timer->start(delay);
+}
+
+void InterfaceWatcher::finish(quint64 id, bool ready)
+{
+    auto it = m_waiters.find(id);
+    if (it == m_waiters.end())
+        return;
+    const Waiter waiter = it.value();
+    m_waiters.erase(it);
+    waiter.timer->deleteLater();
+
+    if (waiter.callback && (!waiter.hasContext || waiter.context))
+        waiter.callback(ready, waiter.clock.elapsed());
+}
+
+// ======================== FakeInterfaceWatcher ========================
+FakeInterfaceWatcher::FakeInterfaceWatcher(int appearDelayMs, QObject *parent)
+    : InterfaceWatcher(parent)
+    , m_appearDelayMs(appearDelayMs)
+{
+}
+
+void FakeInterfaceWatcher::announce(const QString &ifname)
+{
+    m_present.insert(ifname);
+    notifyInterface(ifname);
+}
+
+void FakeInterfaceWatcher::waitStarted(const QString &ifname)
+{
+    if (m_appearDelayMs >= 0 && !m_present.contains(ifname))
+        QTimer::singleShot(m_appearDelayMs, this, [this, ifname]() { announce(ifname); });
+}
+
+// ======================== KernelInterfaceWatcher ========================
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
+KernelInterfaceWatcher::KernelInterfaceWatcher(QObject *parent)
+    : InterfaceWatcher(parent)
+{
+#if defined(Q_OS_LINUX)
+    m_fd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if (m_fd >= 0) {
+        sockaddr_nl addr {};
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = RTMGRP_LINK;
+        if (::bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+#elif defined(Q_OS_FREEBSD)
+    m_fd = ::socket(PF_ROUTE, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, AF_UNSPEC);
+#ifdef ROUTE_MSGFILTER
+    if (m_fd >= 0) {
+        // Маршруты и адреса нам не нужны — только появление/изменение интерфейсов
+        unsigned int filter = ROUTE_FILTER(RTM_IFANNOUNCE) | ROUTE_FILTER(RTM_IFINFO);
+        ::setsockopt(m_fd, PF_ROUTE, ROUTE_MSGFILTER, &filter, sizeof(filter));
+    }
+#endif
+#endif
+    if (m_fd < 0)
+        return;
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &KernelInterfaceWatcher::onReadable);
+}
+
+KernelInterfaceWatcher::~KernelInterfaceWatcher()
+{
+    delete m_notifier;
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+QString KernelInterfaceWatcher::backendName() const
+{
+#if defined(Q_OS_LINUX)
+    return "netlink";
+#else
+    return "route";
+#endif
+}
+
+void KernelInterfaceWatcher::onReadable()
+{
+    alignas(8) char buf[8192];
+    for (;;) {
+        const ssize_t n = ::recv(m_fd, buf, sizeof(buf), 0);
+        if (n < 0) {
+            // Очередь сокета переполнилась — события потеряны, проверяем всех вручную
+            if (errno == ENOBUFS)
+                recheckAll();
+            break;
+        }
+        if (n == 0)
+            break;
+
+#if defined(Q_OS_LINUX)
+        int len = int(n);
+        for (auto *nh = reinterpret_cast<nlmsghdr *>(buf); NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_type != RTM_NEWLINK)
+                continue;
+            auto *ifi = static_cast<ifinfomsg *>(NLMSG_DATA(nh));
+            int attrLen = IFLA_PAYLOAD(nh);
+            for (auto *rta = IFLA_RTA(ifi); RTA_OK(rta, attrLen); rta = RTA_NEXT(rta, attrLen)) {
+                if (rta->rta_type == IFLA_IFNAME)
+                    notifyInterface(QString::fromLocal8Bit(static_cast<const char *>(RTA_DATA(rta))));
+            }
+        }
+#else
+        // routing socket отдаёт по одному сообщению на recv()
+        const auto *rtm = reinterpret_cast<const rt_msghdr *>(buf);
+        if (rtm->rtm_version != RTM_VERSION)
+            continue;
+        if (rtm->rtm_type == RTM_IFANNOUNCE) {
+            const auto *ifan = reinterpret_cast<const if_announcemsghdr *>(buf);
+            if (ifan->ifan_what == IFAN_ARRIVAL)
+                notifyInterface(QString::fromLocal8Bit(ifan->ifan_name));
+        } else if (rtm->rtm_type == RTM_IFINFO) {
+            recheckAll();
+        }
+#endif
+    }
+}
+#endif
@@ -0,0 +1,128 @@
+#ifndef INTERFACEWATCHER_H
+#define INTERFACEWATCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <functional>
+
+class QTimer;
+class QSocketNotifier;
+
+// Ожидание появления сетевого интерфейса (tapN, который создаёт bhyve).
+// Базовый класс держит ожидающих с дедлайнами и страховочной перепроверкой
+// через if_nametoindex() — без fork'а ifconfig. Наследники подают события
+// ядра (routing socket на FreeBSD, netlink на Linux) или просто опрашивают.
+class InterfaceWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    using ReadyCallback = std::function<void(bool ready, qint64 elapsedMs)>;
+
+    static constexpr int DefaultDeadlineMs = 30000;
+
+    // Бэкенд выбирается переменной VMRUN_NET_BACKEND: "fake", "poll" или
+    // "auto" (по умолчанию) — событийный, если сокет открылся, иначе опрос
+    static InterfaceWatcher *create(QObject *parent = nullptr);
+
+    explicit InterfaceWatcher(QObject *parent = nullptr);
+    ~InterfaceWatcher() override;
+
+    virtual QString backendName() const = 0;
+    virtual bool interfaceExists(const QString &ifname) const;
+
+    // callback вызывается ровно один раз: ready == true, как только интерфейс
+    // появился, или false по дедлайну. Если context удалён — не вызывается.
+    quint64 waitFor(const QString &ifname, int deadlineMs, QObject *context, ReadyCallback callback);
+    void cancel(quint64 id);
+
+protected:
+    // Интервал страховочной перепроверки: растёт от initialPollMs() до maxPollMs()
+    virtual int initialPollMs() const { return 1000; }
+    virtual int maxPollMs() const { return 1000; }
+    virtual void waitStarted(const QString &ifname) { Q_UNUSED(ifname) }
+
+    void notifyInterface(const QString &ifname);
+    void recheckAll();
+
+private:
+    struct Waiter {
+        QString ifname;
+        QPointer<QObject> context;
+        bool hasContext = false;
+        ReadyCallback callback;
+        QElapsedTimer clock;
+        int deadlineMs = DefaultDeadlineMs;
+        int pollMs = 0;
+        QTimer *timer = nullptr;
+    };
+
+    void poll(quint64 id);
+    void finish(quint64 id, bool ready);
+
+    quint64 m_nextId = 1;
+    QHash<quint64, Waiter> m_waiters;
+};
+
+// Опрос с адаптивной задержкой: 10, 20, 40 ... 500 мс до дедлайна
+class PollingInterfaceWatcher : public InterfaceWatcher
+{
+    Q_OBJECT
+
+public:
+    using InterfaceWatcher::InterfaceWatcher;
+    QString backendName() const override { return "poll"; }
+
+protected:
+    int initialPollMs() const override { return 10; }
+    int maxPollMs() const override { return 500; }
+};
+
+// Для прогонов без настоящих tap: интерфейс "появляется" через appearDelayMs
+// после начала ожидания (отрицательное значение — никогда, только announce())
+class FakeInterfaceWatcher : public InterfaceWatcher
+{
+    Q_OBJECT
+
+public:
+    explicit FakeInterfaceWatcher(int appearDelayMs = 0, QObject *parent = nullptr);
+    QString backendName() const override { return "fake"; }
+    bool interfaceExists(const QString &ifname) const override { return m_present.contains(ifname); }
+
+    void announce(const QString &ifname);
+    void remove(const QString &ifname) { m_present.remove(ifname); }
+
+protected:
+    void waitStarted(const QString &ifname) override;
+
+private:
+    int m_appearDelayMs;
+    QSet<QString> m_present;
+};
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
+// Событийный бэкенд: RTM_NEWLINK из netlink (Linux) или RTM_IFANNOUNCE из
+// routing socket (FreeBSD). Интерфейс обнаруживается в момент создания.
+class KernelInterfaceWatcher : public InterfaceWatcher
+{
+    Q_OBJECT
+
+public:
+    explicit KernelInterfaceWatcher(QObject *parent = nullptr);
+    ~KernelInterfaceWatcher() override;
+
+    bool isValid() const { return m_fd >= 0; }
+    QString backendName() const override;
+
+private:
+    void onReadable();
+
+    int m_fd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+};
+#endif
+
+#endif // INTERFACEWATCHER_H
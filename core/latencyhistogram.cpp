@@ -0,0 +1,65 @@
+#include "latencyhistogram.h"
+
+#include <cmath>
+
+void LatencyHistogram::record(qint64 ms)
+{
+    if (ms < 0)
+        ms = 0;
+    ++m_buckets[size_t(bucketFor(ms))];
+    m_min = m_count ? qMin(m_min, ms) : ms;
+    m_max = qMax(m_max, ms);
+    m_sum += ms;
+    ++m_count;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    if (!other.m_count)
+        return;
+    for (int i = 0; i < BucketCount; ++i)
+        m_buckets[size_t(i)] += other.m_buckets[size_t(i)];
+    m_min = m_count ? qMin(m_min, other.m_min) : other.m_min;
+    m_max = qMax(m_max, other.m_max);
+    m_sum += other.m_sum;
+    m_count += other.m_count;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (!m_count)
+        return 0;
+    const quint64 rank = quint64(std::ceil(qBound(0.0, p, 100.0) / 100.0 * double(m_count)));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_buckets[size_t(i)];
+        if (seen >= qMax<quint64>(rank, 1))
+            return qBound(m_min, bucketUpperBound(i), m_max);
+    }
+    return m_max;
+}
+
+QString LatencyHistogram::summary() const
+{
+    return QString("n=%1 p50=%2 p95=%3 p99=%4 max=%5 мс")
+        .arg(m_count)
+        .arg(percentile(50))
+        .arg(percentile(95))
+        .arg(percentile(99))
+        .arg(m_max);
+}
+
+int LatencyHistogram::bucketFor(qint64 ms)
+{
+    if (ms < 1)
+        return 0;
+    const int bucket = int(std::floor(std::log2(double(ms)) * BucketsPerOctave)) + 1;
+    return qMin(bucket, BucketCount - 1);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket == 0)
+        return 0;
+    return qint64(std::ceil(std::exp2(double(bucket) / BucketsPerOctave)));
+}
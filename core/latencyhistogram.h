@@ -0,0 +1,43 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QString>
+#include <array>
+
+// Гистограмма задержек с логарифмическими корзинами (4 корзины на октаву,
+// ~19% точности) — от 1 мс до ~18 минут. Размер фиксированный, копируется дёшево,
+// перцентили считаются без хранения отдельных замеров.
+class LatencyHistogram
+{
+public:
+    static constexpr int BucketsPerOctave = 4;
+    static constexpr int BucketCount = 20 * BucketsPerOctave + 1;
+
+    void record(qint64 ms);
+    void merge(const LatencyHistogram &other);
+    void reset() { *this = LatencyHistogram(); }
+
+    quint64 count() const { return m_count; }
+    qint64 min() const { return m_count ? m_min : 0; }
+    qint64 max() const { return m_max; }
+    double mean() const { return m_count ? double(m_sum) / double(m_count) : 0.0; }
+
+    // p в диапазоне 0..100; возвращает верхнюю границу корзины (не больше max)
+    qint64 percentile(double p) const;
+
+    // "n=12 p50=40 p95=180 p99=310 max=320 мс"
+    QString summary() const;
+
+private:
+    static int bucketFor(qint64 ms);
+    static qint64 bucketUpperBound(int bucket);
+
+    std::array<quint32, BucketCount> m_buckets {};
+    quint64 m_count = 0;
+    qint64 m_sum = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
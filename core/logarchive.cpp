@@ -0,0 +1,702 @@
+#include "logarchive.h"
+
+#include <QByteArrayMatcher>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtEndian>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr int IndexEntryBytes = 16;
+constexpr qint64 MaxSegmentBytes = 1024LL * 1024 * 1024;
+
+QByteArray encodeIndexEntry(quint64 offset, qint64 timestampMs)
+{
+    char raw[IndexEntryBytes];
+    qToLittleEndian<quint64>(offset, raw);
+    qToLittleEndian<qint64>(timestampMs, raw + 8);
+    return QByteArray(raw, IndexEntryBytes);
+}
+
+QString segmentPath(const QString &vmDir, int number)
+{
+    return QDir(vmDir).filePath(QString("console-%1.log").arg(number, 6, 10, QLatin1Char('0')));
+}
+
+int segmentNumber(const QString &path)
+{
+    return QFileInfo(path).completeBaseName().mid(int(strlen("console-"))).toInt();
+}
+
+// Начало строки после p (или nullptr, если p — последняя)
+const char *nextLine(const char *p, const char *end)
+{
+    const void *nl = memchr(p, '\n', size_t(end - p));
+    return nl ? static_cast<const char *>(nl) + 1 : nullptr;
+}
+
+qint64 countLines(const char *p, const char *end)
+{
+    qint64 n = 0;
+    while (p && p < end && (p = nextLine(p, end)))
+        ++n;
+    return n;
+}
+
+} // namespace
+
+// ======================== LogArchiveWriter ========================
+// Один поток на все ВМ: пачки строк копятся в очереди и уходят на диск
+// одним write() на ВМ за проход. Очередь ограничена — при отставании диска
+// строки теряются (droppedCount), а не копятся в памяти.
+class LogArchiveWriter : public QThread
+{
+public:
+    static constexpr int MaxQueuedLines = 200000;
+
+    struct Batch {
+        QString vm;
+        QVector<LogLine> lines;
+    };
+
+    void configure(const QString &dir, qint64 maxFileBytes, int maxFiles)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_dir = dir;
+        m_maxFileBytes = maxFileBytes;
+        m_maxFiles = maxFiles;
+        m_reopen = true;
+        m_cond.wakeOne();
+    }
+
+    void enqueue(Batch batch)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_queuedLines + batch.lines.size() > MaxQueuedLines) {
+            m_dropped += quint64(batch.lines.size());
+            return;
+        }
+        m_queuedLines += batch.lines.size();
+        m_queue.append(std::move(batch));
+        m_cond.wakeOne();
+    }
+
+    void shutdown()
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_cond.wakeOne();
+        }
+        wait();
+    }
+
+    quint64 dropped() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_dropped;
+    }
+
+    QString error() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_error;
+    }
+
+protected:
+    void run() override
+    {
+        QHash<QString, std::shared_ptr<Stream>> streams;
+        QString dir;
+        for (;;) {
+            QVector<Batch> batches;
+            bool reopen = false;
+            {
+                QMutexLocker locker(&m_mutex);
+                while (m_queue.isEmpty() && !m_reopen && !m_stopping)
+                    m_cond.wait(&m_mutex);
+                if (m_queue.isEmpty() && !m_reopen && m_stopping)
+                    break;
+                batches.swap(m_queue);
+                m_queuedLines = 0;
+                reopen = m_reopen;
+                m_reopen = false;
+                if (reopen) {
+                    dir = m_dir;
+                    m_fileLimit = m_maxFileBytes;
+                    m_fileCount = m_maxFiles;
+                }
+            }
+
+            if (reopen)
+                streams.clear();
+            if (dir.isEmpty())
+                continue;
+
+            for (const Batch &batch : qAsConst(batches)) {
+                std::shared_ptr<Stream> &stream = streams[batch.vm];
+                if (!stream) {
+                    stream = std::make_shared<Stream>();
+                    stream->dir = QDir(dir).filePath(batch.vm);
+                }
+                // Не открылся в прошлый раз — пробуем снова, каталог могли починить
+                if (!stream->log.isOpen() && !openStream(*stream)) {
+                    addDropped(batch.lines.size());
+                    continue;
+                }
+                write(*stream, batch.lines);
+            }
+        }
+    }
+
+private:
+    struct Stream {
+        QString dir;
+        QFile log;
+        QFile index;
+        int number = 0;
+        qint64 size = 0;
+        qint64 lines = 0;
+        qint64 entries = 0;
+    };
+
+    // Дописываем последний файл, если он не полон и индекс с ним сходится
+    bool openStream(Stream &stream)
+    {
+        if (!QDir().mkpath(stream.dir)) {
+            setError(stream.dir + ": не удалось создать каталог");
+            return false;
+        }
+        const QStringList files = LogArchive::segmentFiles(stream.dir);
+        if (files.isEmpty())
+            return startSegment(stream, 1);
+        const QString last = files.last();
+        if (QFileInfo(last).size() < m_fileLimit && resume(stream, last))
+            return true;
+        return startSegment(stream, segmentNumber(last) + 1);
+    }
+
+    bool resume(Stream &stream, const QString &path)
+    {
+        stream.index.setFileName(LogArchive::indexPathFor(path));
+        QVector<LogIndexEntry> entries;
+        if (!stream.index.open(QIODevice::ReadWrite) || !LogArchive::readIndex(stream.index, &entries)
+            || entries.isEmpty()) {
+            stream.index.close();
+            return false;
+        }
+
+        // После последней записи индекса — не больше IndexStride целых строк
+        QFile tail(path);
+        if (!tail.open(QIODevice::ReadOnly) || !tail.seek(qint64(entries.last().offset))) {
+            stream.index.close();
+            return false;
+        }
+        const QByteArray rest = tail.readAll();
+        const qint64 tailLines = rest.count('\n');
+        if (tailLines > LogArchive::IndexStride || (!rest.isEmpty() && !rest.endsWith('\n'))) {
+            stream.index.close();
+            return false;
+        }
+
+        stream.log.setFileName(path);
+        if (!stream.log.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            stream.index.close();
+            return false;
+        }
+        stream.index.resize(qint64(entries.size()) * IndexEntryBytes);
+        stream.index.seek(stream.index.size());
+        stream.number = segmentNumber(path);
+        stream.size = stream.log.size();
+        stream.entries = entries.size();
+        stream.lines = (stream.entries - 1) * LogArchive::IndexStride + tailLines;
+        return true;
+    }
+
+    bool startSegment(Stream &stream, int number)
+    {
+        stream.log.close();
+        stream.index.close();
+        const QString path = segmentPath(stream.dir, number);
+        stream.log.setFileName(path);
+        stream.index.setFileName(LogArchive::indexPathFor(path));
+        if (!stream.log.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            || !stream.index.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            setError(path + ": " + (stream.log.isOpen() ? stream.index : stream.log).errorString());
+            stream.log.close();
+            stream.index.close();
+            return false;
+        }
+        stream.number = number;
+        stream.size = 0;
+        stream.lines = 0;
+        stream.entries = 0;
+        trim(stream.dir);
+        return true;
+    }
+
+    void trim(const QString &vmDir)
+    {
+        const QStringList files = LogArchive::segmentFiles(vmDir);
+        for (int i = 0; i < files.size() - m_fileCount; ++i) {
+            QFile::remove(files[i]);
+            QFile::remove(LogArchive::indexPathFor(files[i]));
+        }
+    }
+
+    void write(Stream &stream, const QVector<LogLine> &lines)
+    {
+        QByteArray out;
+        QByteArray index;
+        // Лог — раньше индекса: читатель не должен увидеть смещение за концом файла
+        auto flushPending = [this, &stream, &out, &index]() {
+            if (!out.isEmpty()) {
+                if (stream.log.write(out) < 0)
+                    setError(stream.log.fileName() + ": " + stream.log.errorString());
+                stream.log.flush();
+                stream.size += out.size();
+                out.clear();
+            }
+            if (!index.isEmpty()) {
+                stream.index.write(index);
+                stream.index.flush();
+                index.clear();
+            }
+        };
+
+        for (int i = 0; i < lines.size(); ++i) {
+            const LogLine &line = lines[i];
+            const QByteArray text = LogArchive::formatLine(line);
+            if (stream.lines > 0 && stream.size + out.size() + text.size() > m_fileLimit) {
+                flushPending();
+                if (!startSegment(stream, stream.number + 1)) {
+                    addDropped(lines.size() - i);
+                    return;
+                }
+            }
+            if (stream.lines % LogArchive::IndexStride == 0
+                && stream.lines / LogArchive::IndexStride == stream.entries) {
+                index += encodeIndexEntry(quint64(stream.size + out.size()), line.timestampMs);
+                ++stream.entries;
+            }
+            out += text;
+            ++stream.lines;
+        }
+        flushPending();
+    }
+
+    void setError(const QString &error)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_error = error;
+    }
+
+    void addDropped(int lines)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_dropped += quint64(lines);
+    }
+
+    mutable QMutex m_mutex;  // всё до m_fileLimit
+    QWaitCondition m_cond;
+    QVector<Batch> m_queue;
+    int m_queuedLines = 0;
+    QString m_dir;
+    qint64 m_maxFileBytes = LogArchive::DefaultMaxFileBytes;
+    int m_maxFiles = LogArchive::DefaultMaxFiles;
+    bool m_reopen = false;
+    bool m_stopping = false;
+    quint64 m_dropped = 0;
+    QString m_error;
+
+    // Только поток записи
+    qint64 m_fileLimit = LogArchive::DefaultMaxFileBytes;
+    int m_fileCount = LogArchive::DefaultMaxFiles;
+};
+
+// ======================== LogArchive ========================
+LogArchive::LogArchive(QObject *parent)
+    : QObject(parent)
+    , m_writer(new LogArchiveWriter)
+{
+    m_writer->setObjectName("vmrun-logarchive");
+    m_writer->start(QThread::LowPriority);
+}
+
+LogArchive::~LogArchive()
+{
+    // Хвосты, которые ещё не дождались linesFlushed
+    for (const QString &vm : m_followers.keys()) {
+        drain(vm);
+        if (LogBuffer *buffer = m_followers.value(vm).buffer)
+            buffer->setReadMark(LogBuffer::NoReadMark);
+    }
+    m_writer->shutdown();
+    delete m_writer;
+}
+
+void LogArchive::setDirectory(const QString &dir)
+{
+    if (dir == m_dir)
+        return;
+    m_dir = dir;
+    m_writer->configure(m_dir, m_maxFileBytes, m_maxFiles);
+}
+
+void LogArchive::setLimits(qint64 maxFileBytes, int maxFiles)
+{
+    m_maxFileBytes = qBound<qint64>(64 * 1024, maxFileBytes, MaxSegmentBytes);
+    m_maxFiles = qMax(1, maxFiles);
+    m_writer->configure(m_dir, m_maxFileBytes, m_maxFiles);
+}
+
+void LogArchive::follow(const QString &vm, LogBuffer *buffer)
+{
+    auto it = m_followers.find(vm);
+    if (it != m_followers.end()) {
+        if (it->buffer == buffer)
+            return;
+        if (it->buffer) {
+            disconnect(it->buffer, nullptr, this, nullptr);
+            it->buffer->setReadMark(LogBuffer::NoReadMark);
+        }
+    }
+    m_followers.insert(vm, Follower{buffer, buffer->firstSeq()});
+
+    connect(buffer, &LogBuffer::linesFlushed, this, [this, vm]() { drain(vm); });
+    // Clear в окне лога стирает строки, поток быстрее кадра вытесняет — забираем до этого
+    connect(buffer, &LogBuffer::aboutToClear, this, [this, vm]() { drain(vm); });
+    connect(buffer, &LogBuffer::aboutToEvict, this, [this, vm]() { drain(vm); });
+    drain(vm);
+}
+
+QString LogArchive::vmDirectory(const QString &vm) const
+{
+    return m_dir.isEmpty() ? QString() : QDir(m_dir).filePath(vm);
+}
+
+void LogArchive::drain(const QString &vm)
+{
+    auto it = m_followers.find(vm);
+    if (it == m_followers.end() || !it->buffer)
+        return;
+    LogBuffer *buffer = it->buffer;
+
+    quint64 seq = it->nextSeq;
+    if (seq < buffer->firstSeq()) {
+        m_missed += buffer->firstSeq() - seq;
+        seq = buffer->firstSeq();
+    }
+    // Дальше буфер не вытеснит строку, не спросив нас (aboutToEvict)
+    buffer->setReadMark(buffer->endSeq());
+    if (m_dir.isEmpty() || seq >= buffer->endSeq()) {
+        it->nextSeq = buffer->endSeq();
+        return;
+    }
+
+    LogArchiveWriter::Batch batch;
+    batch.vm = vm;
+    batch.lines.reserve(int(buffer->endSeq() - seq));
+    for (; seq < buffer->endSeq(); ++seq)
+        batch.lines.append(buffer->lineAt(seq));
+    it->nextSeq = seq;
+    m_writer->enqueue(std::move(batch));
+}
+
+quint64 LogArchive::droppedCount() const
+{
+    return m_missed + m_writer->dropped();
+}
+
+QString LogArchive::writeError() const
+{
+    return m_writer->error();
+}
+
+char LogArchive::severityTag(LogSeverity severity)
+{
+    switch (severity) {
+    case LogSeverity::Info:    return 'I';
+    case LogSeverity::Notice:  return 'N';
+    case LogSeverity::Command: return 'C';
+    case LogSeverity::Success: return 'S';
+    case LogSeverity::Warning: return 'W';
+    case LogSeverity::Error:   return 'E';
+    case LogSeverity::Stdout:  return 'O';
+    case LogSeverity::Stderr:  return 'R';
+    case LogSeverity::Serial:  return 'T';
+    }
+    return 'I';
+}
+
+QByteArray LogArchive::formatLine(const LogLine &line)
+{
+    // Дата до секунд одна на тысячи строк подряд — форматируем её раз в секунду
+    thread_local qint64 cachedSecond = -1;
+    thread_local QByteArray cachedPrefix;
+    const qint64 second = line.timestampMs / 1000;
+    if (second != cachedSecond) {
+        cachedSecond = second;
+        cachedPrefix = QDateTime::fromMSecsSinceEpoch(second * 1000).toString("yyyy-MM-dd HH:mm:ss").toLatin1();
+    }
+
+    QByteArray text = line.text.toUtf8();
+    text.replace('\n', ' ');
+    char millis[8];
+    std::snprintf(millis, sizeof millis, ".%03d ", int(line.timestampMs % 1000));
+
+    QByteArray out;
+    out.reserve(TextOffset + text.size() + 1);
+    out += cachedPrefix;
+    out += millis;
+    out += severityTag(line.severity);
+    out += ' ';
+    out += text;
+    out += '\n';
+    return out;
+}
+
+bool LogArchive::parseTimestamp(const char *data, qint64 size, qint64 *timestampMs)
+{
+    if (size < TimestampLength)
+        return false;
+    const QDateTime time = QDateTime::fromString(QString::fromLatin1(data, TimestampLength),
+                                                 "yyyy-MM-dd HH:mm:ss.zzz");
+    if (!time.isValid())
+        return false;
+    *timestampMs = time.toMSecsSinceEpoch();
+    return true;
+}
+
+QStringList LogArchive::segmentFiles(const QString &vmDir)
+{
+    // Номера с ведущими нулями — сортировка по имени совпадает с порядком записи
+    const QDir dir(vmDir);
+    QStringList files;
+    for (const QString &name : dir.entryList({"console-*.log"}, QDir::Files, QDir::Name))
+        files << dir.filePath(name);
+    return files;
+}
+
+QString LogArchive::indexPathFor(const QString &logPath)
+{
+    return (logPath.endsWith(".log") ? logPath.chopped(4) : logPath) + ".idx";
+}
+
+bool LogArchive::readIndex(QFile &file, QVector<LogIndexEntry> *entries)
+{
+    if (!file.seek(0))
+        return false;
+    const QByteArray raw = file.readAll();
+    const int count = raw.size() / IndexEntryBytes;
+    entries->resize(count);
+    for (int i = 0; i < count; ++i) {
+        const char *p = raw.constData() + i * IndexEntryBytes;
+        (*entries)[i].offset = qFromLittleEndian<quint64>(p);
+        (*entries)[i].timestampMs = qFromLittleEndian<qint64>(p + 8);
+    }
+    return true;
+}
+
+// ======================== LogArchiveReader ========================
+bool LogArchiveReader::open(const QString &vmDir, QString *error)
+{
+    m_segments.clear();
+    const QStringList files = LogArchive::segmentFiles(vmDir);
+    if (files.isEmpty()) {
+        if (error)
+            *error = "В архиве нет файлов: " + vmDir;
+        return false;
+    }
+
+    qint64 firstRow = 0;
+    for (const QString &path : files) {
+        auto segment = std::make_shared<Segment>();
+        segment->file.reset(new QFile(path));
+        if (!segment->file->open(QIODevice::ReadOnly)) {
+            if (error)
+                *error = path + ": " + segment->file->errorString();
+            continue;
+        }
+        // Снимок размера: то, что поток записи допишет позже, увидим после open()
+        segment->size = qMin(segment->file->size(), MaxSegmentBytes);
+        if (segment->size == 0)
+            continue;
+        segment->data = reinterpret_cast<const char *>(segment->file->map(0, segment->size));
+        if (!segment->data) {
+            if (error)
+                *error = path + ": " + segment->file->errorString();
+            continue;
+        }
+        const char *end = segment->data + segment->size;
+
+        QFile indexFile(LogArchive::indexPathFor(path));
+        if (indexFile.open(QIODevice::ReadOnly))
+            LogArchive::readIndex(indexFile, &segment->index);
+        // Записи за концом снимка (индекс дописан позже) отбрасываем
+        while (!segment->index.isEmpty() && qint64(segment->index.last().offset) >= segment->size)
+            segment->index.removeLast();
+
+        if (segment->index.isEmpty() || segment->index.first().offset != 0) {
+            // Индекса нет или он битый — строим в памяти одним проходом
+            segment->index.clear();
+            qint64 row = 0;
+            for (const char *p = segment->data; p && p < end; p = nextLine(p, end), ++row) {
+                if (row % LogArchive::IndexStride == 0) {
+                    LogIndexEntry entry;
+                    entry.offset = quint64(p - segment->data);
+                    LogArchive::parseTimestamp(p, end - p, &entry.timestampMs);
+                    segment->index.append(entry);
+                }
+            }
+        }
+
+        // Неполная последняя строка (её сейчас пишут) в счёт не идёт
+        const LogIndexEntry &last = segment->index.last();
+        segment->lines = qint64(segment->index.size() - 1) * LogArchive::IndexStride
+                       + countLines(segment->data + last.offset, end);
+        segment->firstRow = firstRow;
+        firstRow += segment->lines;
+        m_segments.append(segment);
+    }
+    return !m_segments.isEmpty();
+}
+
+qint64 LogArchiveReader::lineCount() const
+{
+    if (m_segments.isEmpty())
+        return 0;
+    const Segment &last = *m_segments.last();
+    return last.firstRow + last.lines;
+}
+
+qint64 LogArchiveReader::totalBytes() const
+{
+    qint64 total = 0;
+    for (const auto &segment : m_segments)
+        total += segment->size;
+    return total;
+}
+
+int LogArchiveReader::segmentFor(qint64 row) const
+{
+    if (row < 0)
+        return -1;
+    auto it = std::upper_bound(m_segments.cbegin(), m_segments.cend(), row,
+                               [](qint64 r, const std::shared_ptr<const Segment> &s) { return r < s->firstRow; });
+    if (it == m_segments.cbegin())
+        return -1;
+    const int i = int(it - m_segments.cbegin()) - 1;
+    return row < m_segments[i]->firstRow + m_segments[i]->lines ? i : -1;
+}
+
+const char *LogArchiveReader::Segment::lineStart(qint64 localRow) const
+{
+    if (localRow < 0 || localRow >= lines)
+        return nullptr;
+    // Индекс мог отстать от файла — тогда идём от последней записи
+    const qint64 entry = qMin<qint64>(localRow / LogArchive::IndexStride, index.size() - 1);
+    const char *end = data + size;
+    const char *p = data + index[int(entry)].offset;
+    for (qint64 row = entry * LogArchive::IndexStride; p && row < localRow; ++row)
+        p = nextLine(p, end);
+    return p;
+}
+
+qint64 LogArchiveReader::Segment::rowForOffset(qint64 offset) const
+{
+    auto it = std::upper_bound(index.cbegin(), index.cend(), quint64(offset),
+                               [](quint64 o, const LogIndexEntry &e) { return o < e.offset; });
+    const int entry = qMax(0, int(it - index.cbegin()) - 1);
+    const char *start = data + index[entry].offset;
+    const qint64 row = qint64(entry) * LogArchive::IndexStride
+                     + qint64(std::count(start, data + offset, '\n'));
+    return qMin(row, lines - 1);
+}
+
+QByteArray LogArchiveReader::line(qint64 row) const
+{
+    const int i = segmentFor(row);
+    if (i < 0)
+        return QByteArray();
+    const Segment &segment = *m_segments[i];
+    const char *p = segment.lineStart(row - segment.firstRow);
+    if (!p)
+        return QByteArray();
+    const char *end = segment.data + segment.size;
+    const char *nl = static_cast<const char *>(memchr(p, '\n', size_t(end - p)));
+    return QByteArray(p, int((nl ? nl : end) - p));
+}
+
+qint64 LogArchiveReader::lineTimestamp(qint64 row) const
+{
+    const QByteArray text = line(row);
+    qint64 timestampMs = -1;
+    return LogArchive::parseTimestamp(text.constData(), text.size(), &timestampMs) ? timestampMs : -1;
+}
+
+qint64 LogArchiveReader::rowAtTime(qint64 timestampMs) const
+{
+    if (m_segments.isEmpty())
+        return 0;
+
+    // Файл, начатый последним раньше искомого времени: строки с тем же
+    // временем могут начинаться в предыдущем
+    int i = 0;
+    for (int s = 0; s < m_segments.size(); ++s) {
+        if (m_segments[s]->index.first().timestampMs < timestampMs)
+            i = s;
+    }
+
+    // В нём — последняя запись индекса раньше искомого, дальше построчно
+    const Segment &segment = *m_segments[i];
+    auto it = std::lower_bound(segment.index.cbegin(), segment.index.cend(), timestampMs,
+                               [](const LogIndexEntry &e, qint64 t) { return e.timestampMs < t; });
+    const int entry = qMax(0, int(it - segment.index.cbegin()) - 1);
+    qint64 row = segment.firstRow + qint64(entry) * LogArchive::IndexStride;
+    const qint64 count = lineCount();
+    for (; row < count; ++row) {
+        const qint64 t = lineTimestamp(row);
+        if (t >= timestampMs)
+            break;
+    }
+    return row;
+}
+
+qint64 LogArchiveReader::find(const QByteArray &needle, qint64 fromRow, const std::atomic<bool> *cancel) const
+{
+    // Окна по 8 МБ с перекрытием на длину образца: отмена проверяется между ними
+    constexpr qint64 Window = 8 * 1024 * 1024;
+
+    int i = segmentFor(qMax<qint64>(0, fromRow));
+    if (needle.isEmpty() || i < 0)
+        return -1;
+    const QByteArrayMatcher matcher(needle);
+
+    for (; i < m_segments.size(); ++i) {
+        const Segment &segment = *m_segments[i];
+        qint64 start = 0;
+        if (fromRow > segment.firstRow) {
+            const char *p = segment.lineStart(fromRow - segment.firstRow);
+            if (!p)
+                continue;
+            start = p - segment.data;
+        }
+        for (qint64 pos = start; pos < segment.size; pos += Window) {
+            if (cancel && cancel->load(std::memory_order_relaxed))
+                return -1;
+            const qint64 length = qMin(segment.size - pos, Window + needle.size() - 1);
+            const int hit = matcher.indexIn(segment.data + pos, int(length), 0);
+            if (hit >= 0)
+                return segment.firstRow + segment.rowForOffset(pos + hit);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,135 @@
+#ifndef LOGARCHIVE_H
+#define LOGARCHIVE_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QPointer>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+#include "logbuffer.h"
+
+class LogArchiveWriter;
+
+// Запись индекса: смещение строки в файле и её время
+struct LogIndexEntry {
+    quint64 offset = 0;
+    qint64 timestampMs = 0;
+};
+
+// Архив консоли ВМ на диске. Для каждой ВМ — каталог <dir>/<имя>/ с файлами
+// console-000001.log, console-000002.log ... (новый при достижении
+// maxFileBytes, старше maxFiles — удаляются) и разреженным индексом рядом:
+// console-NNNNNN.idx — по записи LogIndexEntry (16 байт, little-endian)
+// на каждую IndexStride-ю строку файла.
+//
+// Строка файла: "2026-10-17 12:00:00.123 O текст\n", буква — LogSeverity.
+//
+// LogArchive забирает новые строки из LogBuffer по linesFlushed (как
+// ConsoleLog в CLI) и отдаёт их пачками потоку записи; поток GUI на диск
+// не ходит. Если гость за один кадр выдал больше ёмкости буфера, архив
+// забирает строки по aboutToEvict — до вытеснения, а не после. Clear в окне
+// лога архив не трогает.
+class LogArchive : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int IndexStride = 256;
+    static constexpr qint64 DefaultMaxFileBytes = 64LL * 1024 * 1024;
+    static constexpr int DefaultMaxFiles = 32;
+    static constexpr int TimestampLength = 23;  // "yyyy-MM-dd HH:mm:ss.zzz"
+    static constexpr int TextOffset = TimestampLength + 3;
+
+    explicit LogArchive(QObject *parent = nullptr);
+    ~LogArchive() override;
+
+    // Пустой каталог — архив выключен
+    void setDirectory(const QString &dir);
+    QString directory() const { return m_dir; }
+    // Файл — не больше 1 ГБ: читатель ищет в нём через int-смещения
+    void setLimits(qint64 maxFileBytes, int maxFiles);
+
+    void follow(const QString &vm, LogBuffer *buffer);
+    QString vmDirectory(const QString &vm) const;
+
+    // Строки, не попавшие на диск: очередь записи переполнилась — диск отстал
+    quint64 droppedCount() const;
+    QString writeError() const;
+
+    static char severityTag(LogSeverity severity);
+    static QByteArray formatLine(const LogLine &line);
+    // Время из начала строки файла; false — строка не в формате архива
+    static bool parseTimestamp(const char *data, qint64 size, qint64 *timestampMs);
+
+    // Файлы архива каталога ВМ от старых к новым
+    static QStringList segmentFiles(const QString &vmDir);
+    static QString indexPathFor(const QString &logPath);
+    static bool readIndex(QFile &file, QVector<LogIndexEntry> *entries);
+
+private:
+    struct Follower {
+        QPointer<LogBuffer> buffer;
+        quint64 nextSeq = 0;
+    };
+
+    void drain(const QString &vm);
+
+    QString m_dir;
+    qint64 m_maxFileBytes = DefaultMaxFileBytes;
+    int m_maxFiles = DefaultMaxFiles;
+    LogArchiveWriter *m_writer;
+    QHash<QString, Follower> m_followers;
+    quint64 m_missed = 0;
+};
+
+// Чтение архива одной ВМ через mmap: в память попадают только страницы,
+// которые реально читают. Строки адресуются сквозным номером по всем
+// файлам; индекс даёт начало каждой IndexStride-й строки, остальное —
+// проход memchr не длиннее IndexStride строк.
+//
+// Копия читателя разделяет отображения с оригиналом — её можно отдать
+// в фоновый поток для поиска, пока модель продолжает читать свою.
+class LogArchiveReader
+{
+public:
+    bool open(const QString &vmDir, QString *error = nullptr);
+    void close() { m_segments.clear(); }
+
+    qint64 lineCount() const;
+    qint64 totalBytes() const;
+    int fileCount() const { return m_segments.size(); }
+
+    // Строка без '\n'; пустая, если номера нет
+    QByteArray line(qint64 row) const;
+    qint64 lineTimestamp(qint64 row) const;  // -1 — не разобрать
+
+    // Первая строка со временем >= timestampMs (lineCount(), если таких нет)
+    qint64 rowAtTime(qint64 timestampMs) const;
+
+    // Первая строка с подстрокой needle, начиная с fromRow; -1 — не найдено
+    // или cancel выставлен
+    qint64 find(const QByteArray &needle, qint64 fromRow,
+                const std::atomic<bool> *cancel = nullptr) const;
+
+private:
+    struct Segment {
+        std::unique_ptr<QFile> file;
+        const char *data = nullptr;
+        qint64 size = 0;
+        QVector<LogIndexEntry> index;
+        qint64 firstRow = 0;
+        qint64 lines = 0;
+
+        const char *lineStart(qint64 localRow) const;
+        qint64 rowForOffset(qint64 offset) const;
+    };
+
+    int segmentFor(qint64 row) const;
+
+    QVector<std::shared_ptr<const Segment>> m_segments;
+};
+
+#endif // LOGARCHIVE_H
@@ -0,0 +1,168 @@
+#include "logbuffer.h"
+
+#include <QDateTime>
+
+namespace {
+
+// Строка терминала без разметки: CSI (ESC [ ... буква), OSC (ESC ] ... BEL
+// или ESC \\), прочие ESC X и управляющие байты, кроме табуляции. Байты
+// UTF-8 не трогаем
+QByteArray plainText(const QByteArray &line)
+{
+    QByteArray out;
+    out.reserve(line.size());
+    const int size = line.size();
+    for (int i = 0; i < size; ++i) {
+        const uchar c = uchar(line.at(i));
+        if (c == 0x1b && i + 1 < size) {
+            const char kind = line.at(++i);
+            if (kind == '[') {
+                while (i + 1 < size && (uchar(line.at(i + 1)) < 0x40 || uchar(line.at(i + 1)) > 0x7e))
+                    ++i;
+                ++i;
+            } else if (kind == ']') {
+                while (i + 1 < size && line.at(i + 1) != '\a' && line.at(i + 1) != 0x1b)
+                    ++i;
+                ++i;
+                if (i < size && line.at(i) == 0x1b)
+                    ++i;  // ST — ESC \\
+            } else if (kind == '(' || kind == ')') {
+                ++i;  // выбор набора символов
+            }
+            continue;
+        }
+        if (c == '\b') {
+            if (!out.isEmpty())
+                out.chop(1);
+            continue;
+        }
+        if (c < 0x20 && c != '\t')
+            continue;
+        if (c == 0x7f)
+            continue;
+        out.append(char(c));
+    }
+    return out;
+}
+
+} // namespace
+
+LogBuffer::LogBuffer(int capacity, QObject *parent)
+    : QObject(parent)
+    , m_capacity(qMax(1, capacity))
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(DefaultFlushIntervalMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &LogBuffer::linesFlushed);
+}
+
+void LogBuffer::append(LogSeverity severity, const QString &text)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    // Многострочные сообщения (вывод ifconfig и т.п.) раскладываем по строкам
+    if (text.contains('\n')) {
+        for (const QString &line : text.split('\n', Qt::SkipEmptyParts))
+            pushLine(severity, line, now);
+    } else {
+        pushLine(severity, text, now);
+    }
+    scheduleFlush();
+}
+
+void LogBuffer::appendChunk(LogSeverity severity, const QByteArray &chunk)
+{
+    QByteArray &partial = partialFor(severity);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    int start = 0;
+    int nl;
+    while ((nl = chunk.indexOf('\n', start)) >= 0) {
+        QByteArray line = partial.isEmpty() ? chunk.mid(start, nl - start)
+                                            : partial + chunk.mid(start, nl - start);
+        partial.clear();
+        if (line.endsWith('\r'))
+            line.chop(1);
+        if (severity == LogSeverity::Serial)
+            line = plainText(line);
+        if (!line.isEmpty())
+            pushLine(severity, QString::fromLocal8Bit(line), now);
+        start = nl + 1;
+    }
+    partial += chunk.mid(start);
+
+    // Гость может писать без перевода строки (прогресс-бары) — не копим бесконечно
+    if (partial.size() >= MaxLineLength) {
+        pushLine(severity, QString::fromLocal8Bit(severity == LogSeverity::Serial ? plainText(partial) : partial), now);
+        partial.clear();
+    }
+    scheduleFlush();
+}
+
+void LogBuffer::flushPartial()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (!m_partialOut.isEmpty())
+        pushLine(LogSeverity::Stdout, QString::fromLocal8Bit(m_partialOut), now);
+    if (!m_partialErr.isEmpty())
+        pushLine(LogSeverity::Stderr, QString::fromLocal8Bit(m_partialErr), now);
+    // Приглашение "login: " без перевода строки — тоже строка
+    const QByteArray serial = plainText(m_partialSerial);
+    if (!serial.trimmed().isEmpty())
+        pushLine(LogSeverity::Serial, QString::fromLocal8Bit(serial), now);
+    m_partialOut.clear();
+    m_partialErr.clear();
+    m_partialSerial.clear();
+    scheduleFlush();
+}
+
+void LogBuffer::clear()
+{
+    emit aboutToClear();
+    // Номера строк не сбрасываем: модель опирается на их монотонность
+    for (quint64 seq = m_firstSeq; seq < m_endSeq; ++seq)
+        m_ring[slotFor(seq)].text.clear();
+    m_firstSeq = m_endSeq;
+    m_partialOut.clear();
+    m_partialErr.clear();
+    m_partialSerial.clear();
+    m_flushTimer.stop();
+    emit cleared();
+}
+
+void LogBuffer::pushLine(LogSeverity severity, QString text, qint64 timestampMs)
+{
+    if (text.size() > MaxLineLength)
+        text.truncate(MaxLineLength);
+
+    // Новая строка займёт слот самой старой — читатель забирает её до этого
+    if (size() == m_capacity && m_firstSeq >= m_readMark)
+        emit aboutToEvict();
+
+    const int index = slotFor(m_endSeq);
+    if (index >= m_ring.size())
+        m_ring.resize(index + 1);
+
+    LogLine &slot = m_ring[index];
+    slot.timestampMs = timestampMs;
+    slot.severity = severity;
+    slot.text = std::move(text);
+    ++m_endSeq;
+
+    if (m_endSeq - m_firstSeq > quint64(m_capacity)) {
+        ++m_firstSeq;
+        ++m_dropped;
+    }
+}
+
+void LogBuffer::scheduleFlush()
+{
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+QByteArray &LogBuffer::partialFor(LogSeverity severity)
+{
+    if (severity == LogSeverity::Stdout)
+        return m_partialOut;
+    return severity == LogSeverity::Serial ? m_partialSerial : m_partialErr;
+}
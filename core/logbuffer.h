@@ -0,0 +1,99 @@
+#ifndef LOGBUFFER_H
+#define LOGBUFFER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QTimer>
+#include <limits>
+
+// Уровень строки лога — вместо HTML-разметки <font color=...>
+enum class LogSeverity : quint8 {
+    Info,
+    Notice,
+    Command,
+    Success,
+    Warning,
+    Error,
+    Stdout,
+    Stderr,
+    Serial   // com1 гостя (SerialConsole), без управляющих последовательностей
+};
+
+struct LogLine {
+    qint64 timestampMs = 0;
+    LogSeverity severity = LogSeverity::Info;
+    QString text;
+};
+
+// Кольцевой буфер строк лога фиксированной ёмкости.
+// Каждая строка получает сквозной номер (seq): строки со старыми номерами
+// вытесняются, память ограничена capacity * MaxLineLength.
+// Уведомления копятся и отдаются одним сигналом linesFlushed() по таймеру кадра,
+// так что поток из миллиона строк не превращается в миллион перерисовок.
+class LogBuffer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultCapacity = 50000;
+    static constexpr int MaxLineLength = 4096;
+    static constexpr int DefaultFlushIntervalMs = 33;
+
+    explicit LogBuffer(int capacity = DefaultCapacity, QObject *parent = nullptr);
+
+    void append(LogSeverity severity, const QString &text);
+
+    // Сырые данные процесса: режутся по '\n', неполный хвост ждёт следующего куска.
+    // У Serial из строк выбрасываются ESC-последовательности и управляющие байты
+    void appendChunk(LogSeverity severity, const QByteArray &chunk);
+    void flushPartial();
+
+    void clear();
+
+    int capacity() const { return m_capacity; }
+    int size() const { return int(m_endSeq - m_firstSeq); }
+    quint64 firstSeq() const { return m_firstSeq; }
+    quint64 endSeq() const { return m_endSeq; }
+    quint64 droppedCount() const { return m_dropped; }
+
+    bool contains(quint64 seq) const { return seq >= m_firstSeq && seq < m_endSeq; }
+    const LogLine &lineAt(quint64 seq) const { return m_ring.at(slotFor(seq)); }
+
+    void setFlushInterval(int ms) { m_flushTimer.setInterval(ms); }
+
+    // Читатель, которому нужна каждая строка (LogArchive), отмечает, с какого
+    // номера он ещё не забрал. Вытесняя такую строку, буфер сначала шлёт
+    // aboutToEvict — читатель забирает всё сразу, и сигнал повторится не
+    // раньше, чем через capacity строк. NoReadMark — читателя нет
+    static constexpr quint64 NoReadMark = std::numeric_limits<quint64>::max();
+    void setReadMark(quint64 seq) { m_readMark = seq; }
+
+signals:
+    void linesFlushed();
+    void aboutToClear();  // строки ещё на месте — последний шанс их забрать
+    void aboutToEvict();  // то же для строки с номером >= readMark
+    void cleared();
+
+private:
+    void pushLine(LogSeverity severity, QString text, qint64 timestampMs);
+    void scheduleFlush();
+    QByteArray &partialFor(LogSeverity severity);
+    int slotFor(quint64 seq) const { return int(seq % quint64(m_capacity)); }
+
+    // Кольцо растёт до m_capacity по мере заполнения: сотня молчащих ВМ
+    // не держит по мегабайту пустых слотов
+    int m_capacity;
+    QVector<LogLine> m_ring;
+    quint64 m_firstSeq = 0;
+    quint64 m_endSeq = 0;
+    quint64 m_dropped = 0;
+    quint64 m_readMark = NoReadMark;
+    QByteArray m_partialOut;
+    QByteArray m_partialErr;
+    QByteArray m_partialSerial;
+    QTimer m_flushTimer;
+};
+
+#endif // LOGBUFFER_H
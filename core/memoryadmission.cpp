@@ -0,0 +1,218 @@
+#include "memoryadmission.h"
+
+#include <QRegularExpression>
+
+QString MemoryAdmission::Snapshot::summary() const
+{
+    QString text = QString("запас %1: ВМ %2, резерв %3")
+                       .arg(formatBytes(headroomBytes), formatBytes(qint64(committedBytes)), formatBytes(qint64(reserveBytes)));
+    if (hostKnown)
+        text += QString(", доступно %1 из %2 (%3)")
+                    .arg(formatBytes(qint64(host.availableBytes)), formatBytes(qint64(host.totalBytes)), backend);
+    else
+        text += QString(" (память хоста неизвестна: %1)").arg(backend);
+    if (queued > 0)
+        text += QString(", в очереди: %1").arg(queued);
+    return text;
+}
+
+MemoryAdmission::MemoryAdmission(QObject *parent)
+    : QObject(parent)
+    , m_backend(HostMemoryBackend::create())
+{
+    m_poll.setInterval(PollMs);
+    connect(&m_poll, &QTimer::timeout, this, &MemoryAdmission::processQueue);
+}
+
+MemoryAdmission::~MemoryAdmission() = default;
+
+void MemoryAdmission::setBackend(std::unique_ptr<HostMemoryBackend> backend)
+{
+    m_backend = std::move(backend);
+}
+
+QString MemoryAdmission::backendName() const
+{
+    return m_backend ? m_backend->name() : QString("none");
+}
+
+quint64 MemoryAdmission::parseMemory(const QString &memory)
+{
+    static const QRegularExpression re("^(\\d+)([GMgm]?)$");
+    const QRegularExpressionMatch match = re.match(memory.trimmed());
+    if (!match.hasMatch())
+        return 0;
+    const quint64 value = match.captured(1).toULongLong();
+    return match.captured(2).toUpper() == "G" ? value << 30 : value << 20;
+}
+
+QString MemoryAdmission::formatBytes(qint64 bytes)
+{
+    return QString::number(bytes / 1024.0 / 1024 / 1024, 'f', 1) + " ГБ";
+}
+
+quint64 MemoryAdmission::committed(const QString &vm) const
+{
+    return m_committed.value(vm);
+}
+
+bool MemoryAdmission::isQueued(const QString &vm) const
+{
+    for (const Pending &pending : m_queue) {
+        if (pending.vm == vm)
+            return true;
+    }
+    return false;
+}
+
+// ======================== Решение ========================
+MemoryAdmission::Snapshot MemoryAdmission::snapshot() const
+{
+    Snapshot state;
+    state.backend = backendName();
+    state.hostKnown = m_backend && m_backend->read(&state.host);
+    state.reserveBytes = m_reserveBytes;
+    state.queued = m_queue.size();
+    for (auto it = m_committed.cbegin(); it != m_committed.cend(); ++it) {
+        state.committedBytes += it.value();
+        const QElapsedTimer admittedAt = m_admittedAt.value(it.key());
+        if (admittedAt.isValid() && admittedAt.elapsed() < m_settleMs)
+            state.settlingBytes += it.value();
+    }
+    if (state.hostKnown) {
+        const qint64 byTotal = qint64(state.host.totalBytes) - qint64(m_reserveBytes) - qint64(state.committedBytes);
+        const qint64 byAvailable = qint64(state.host.availableBytes) - qint64(m_reserveBytes) - qint64(state.settlingBytes);
+        state.headroomBytes = qMin(byTotal, byAvailable);
+        if (state.host.wireLimitBytes > 0)
+            state.headroomBytes = qMin(state.headroomBytes, qint64(state.host.wireLimitBytes)
+                                                                - qint64(state.host.wiredBytes) - qint64(state.settlingBytes));
+    }
+    return state;
+}
+
+MemoryAdmission::Verdict MemoryAdmission::evaluate(quint64 bytes, const Snapshot &state, QString *reason) const
+{
+    // Без данных о хосте не мешаем запуску — как было до контроля
+    if (!state.hostKnown)
+        return Verdict::Admit;
+
+    const qint64 need = qint64(bytes);
+    const qint64 capacity = qint64(state.host.totalBytes) - qint64(m_reserveBytes);
+    if (need > capacity) {
+        *reason = QString("ВМ нужно %1, а хосту за вычетом резерва %2 — всего %3")
+                      .arg(formatBytes(need), formatBytes(qint64(m_reserveBytes)), formatBytes(capacity));
+        return Verdict::Reject;
+    }
+    if (need > state.headroomBytes) {
+        *reason = QString("ВМ нужно %1, свободно с учётом резерва %2 (занято ВМ %3, доступно %4)")
+                      .arg(formatBytes(need), formatBytes(qMax<qint64>(0, state.headroomBytes)),
+                           formatBytes(qint64(state.committedBytes)), formatBytes(qint64(state.host.availableBytes)));
+        return m_queueing ? Verdict::Queue : Verdict::Reject;
+    }
+    return Verdict::Admit;
+}
+
+MemoryAdmission::Verdict MemoryAdmission::acquire(const QString &vm, quint64 bytes, QString *reason,
+                                                  QObject *context, const Callback &done)
+{
+    release(vm);
+    QString why;
+    // Очередь FIFO: пока в ней кто-то есть, новые встают за ним
+    Verdict verdict = evaluate(bytes, snapshot(), &why);
+    if (verdict == Verdict::Admit && !m_queue.isEmpty()) {
+        verdict = m_queueing ? Verdict::Queue : Verdict::Reject;
+        why = QString("перед ней в очереди ждут память: %1").arg(m_queue.size());
+    }
+    if (reason)
+        *reason = why;
+
+    switch (verdict) {
+    case Verdict::Admit:
+        commit(vm, bytes);
+        break;
+    case Verdict::Queue: {
+        Pending pending;
+        pending.vm = vm;
+        pending.bytes = bytes;
+        pending.context = context;
+        pending.done = done;
+        pending.waiting.start();
+        m_queue.append(pending);
+        m_poll.start();
+        emit changed();
+        break;
+    }
+    case Verdict::Reject:
+        break;
+    }
+    return verdict;
+}
+
+void MemoryAdmission::reserve(const QString &vm, quint64 bytes)
+{
+    release(vm);
+    m_committed.insert(vm, bytes);
+    // Гость работает давно — его память уже видна в available
+    m_admittedAt.remove(vm);
+    emit changed();
+}
+
+void MemoryAdmission::commit(const QString &vm, quint64 bytes)
+{
+    m_committed.insert(vm, bytes);
+    QElapsedTimer admittedAt;
+    admittedAt.start();
+    m_admittedAt.insert(vm, admittedAt);
+    emit changed();
+}
+
+void MemoryAdmission::release(const QString &vm)
+{
+    bool changedAny = m_committed.remove(vm) > 0;
+    m_admittedAt.remove(vm);
+    for (int i = m_queue.size() - 1; i >= 0; --i) {
+        if (m_queue[i].vm == vm) {
+            m_queue.remove(i);
+            changedAny = true;
+        }
+    }
+    if (!changedAny)
+        return;
+    emit changed();
+    // Освободилось место — очередь проверяем сразу, но не из стека вызывающего
+    if (!m_queue.isEmpty())
+        QTimer::singleShot(0, this, &MemoryAdmission::processQueue);
+}
+
+// Голова очереди допускается, пока помещается; первая непоместившаяся
+// держит остальных. Устаревшие ожидания снимаются с отказом
+void MemoryAdmission::processQueue()
+{
+    while (!m_queue.isEmpty()) {
+        Pending &head = m_queue.first();
+        if (!head.context) {
+            m_queue.removeFirst();
+            continue;
+        }
+        if (m_queueTimeoutMs > 0 && head.waiting.elapsed() > m_queueTimeoutMs) {
+            const Pending expired = m_queue.takeFirst();
+            emit changed();
+            if (expired.done)
+                expired.done(false, QString("память не освободилась за %1 с").arg(m_queueTimeoutMs / 1000));
+            continue;
+        }
+        QString reason;
+        const Verdict verdict = evaluate(head.bytes, snapshot(), &reason);
+        if (verdict == Verdict::Queue)
+            break;
+        const Pending ready = m_queue.takeFirst();
+        if (verdict == Verdict::Admit)
+            commit(ready.vm, ready.bytes);
+        else
+            emit changed();
+        if (ready.context && ready.done)
+            ready.done(verdict == Verdict::Admit, reason);
+    }
+    if (m_queue.isEmpty())
+        m_poll.stop();
+}
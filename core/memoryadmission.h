@@ -0,0 +1,115 @@
+#ifndef MEMORYADMISSION_H
+#define MEMORYADMISSION_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <functional>
+#include <memory>
+
+#include "hostmemory.h"
+
+// Допуск запусков по памяти. Гости стартуют с bhyve -S: вся их память
+// сразу становится wired, и запуск сверх свободной памяти хоста уводит
+// его в своп или под OOM. Запуск допускается, только если:
+//   - память всех допущенных ВМ плюс новая не больше total − резерв;
+//   - новая помещается в available − резерв, за вычетом ВМ, допущенных
+//     недавно (SettleMs): их память ещё может не успеть стать wired;
+//   - wired + новая не больше vm.max_user_wired, если предел известен.
+// Не поместилась сейчас, но поместится, когда остановятся другие, —
+// в очередь (если включена), иначе отказ. Очередь — FIFO: первая
+// ожидающая ВМ не пропускает вперёд тех, что поменьше.
+class MemoryAdmission : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Verdict {
+        Admit,
+        Queue,
+        Reject
+    };
+
+    static constexpr int PollMs = 1000;            // очередь перепроверяется по таймеру и на release()
+    static constexpr int DefaultSettleMs = 15000;
+    static constexpr int DefaultQueueTimeoutMs = 300000;
+    static constexpr quint64 DefaultReserveBytes = 2ULL << 30;
+
+    struct Snapshot {
+        HostMemory host;
+        bool hostKnown = false;
+        QString backend;
+        quint64 committedBytes = 0;  // все допущенные ВМ
+        quint64 settlingBytes = 0;   // допущенные за последние SettleMs
+        quint64 reserveBytes = 0;
+        qint64 headroomBytes = 0;    // сколько ещё можно допустить прямо сейчас
+        int queued = 0;
+
+        // "запас 5.2 ГБ: ВМ 8.0 ГБ, резерв 2.0 ГБ, доступно 9.1 из 31.3 ГБ (meminfo)"
+        QString summary() const;
+    };
+
+    // admitted == false — ожидание отменено по таймауту; reason — для лога
+    using Callback = std::function<void(bool admitted, const QString &reason)>;
+
+    explicit MemoryAdmission(QObject *parent = nullptr);
+    ~MemoryAdmission() override;
+
+    void setBackend(std::unique_ptr<HostMemoryBackend> backend);
+    QString backendName() const;
+
+    void setReserveBytes(quint64 bytes) { m_reserveBytes = bytes; }
+    quint64 reserveBytes() const { return m_reserveBytes; }
+    void setQueueing(bool enabled) { m_queueing = enabled; }
+    bool queueing() const { return m_queueing; }
+    void setQueueTimeoutMs(int ms) { m_queueTimeoutMs = ms; }
+    void setSettleMs(int ms) { m_settleMs = ms; }
+
+    // "8G" → 8 ГиБ, "4096M" → 4 ГиБ (после VmConfig::normalizeMemory); 0 — не разобрать
+    static quint64 parseMemory(const QString &memory);
+    static QString formatBytes(qint64 bytes);
+
+    // Решение для ВМ vm размером bytes. Admit — память уже закреплена за
+    // vm; Reject — причина в reason; Queue — ответ придёт в done, если
+    // context ещё жив, reason — почему ждём
+    Verdict acquire(const QString &vm, quint64 bytes, QString *reason, QObject *context, const Callback &done);
+    // Закрепить без проверки — гость уже работает (подхват)
+    void reserve(const QString &vm, quint64 bytes);
+    // Снять закрепление или ожидание в очереди
+    void release(const QString &vm);
+
+    quint64 committed(const QString &vm) const;
+    bool isQueued(const QString &vm) const;
+    Snapshot snapshot() const;
+
+signals:
+    void changed();
+
+private:
+    struct Pending {
+        QString vm;
+        quint64 bytes = 0;
+        QPointer<QObject> context;
+        Callback done;
+        QElapsedTimer waiting;
+    };
+
+    Verdict evaluate(quint64 bytes, const Snapshot &state, QString *reason) const;
+    void commit(const QString &vm, quint64 bytes);
+    void processQueue();
+
+    std::unique_ptr<HostMemoryBackend> m_backend;
+    quint64 m_reserveBytes = DefaultReserveBytes;
+    bool m_queueing = true;
+    int m_queueTimeoutMs = DefaultQueueTimeoutMs;
+    int m_settleMs = DefaultSettleMs;
+    QHash<QString, quint64> m_committed;
+    QHash<QString, QElapsedTimer> m_admittedAt;
+    QVector<Pending> m_queue;
+    QTimer m_poll;
+};
+
+#endif // MEMORYADMISSION_H
@@ -0,0 +1,325 @@
+#include "networkreconciler.h"
+#include "commandrunner.h"
+
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <memory>
+
+// ======================== NetworkSnapshot ========================
+// Заголовок интерфейса — с начала строки ("tap0: flags=..."), его свойства —
+// с отступом; нас интересуют "member: tapN flags=..." у мостов и
+// "Opened by PID N" у tap'ов, с которыми работает bhyve
+NetworkSnapshot NetworkSnapshot::parse(const QByteArray &ifconfigOutput)
+{
+    NetworkSnapshot snapshot;
+    QString current;
+    for (const QByteArray &raw : ifconfigOutput.split('\n')) {
+        if (raw.isEmpty())
+            continue;
+        if (raw.at(0) != ' ' && raw.at(0) != '\t') {
+            const int colon = raw.indexOf(':');
+            current = colon > 0 ? QString::fromLatin1(raw.left(colon)) : QString();
+            if (!current.isEmpty())
+                snapshot.interfaces.insert(current);
+            continue;
+        }
+        if (current.isEmpty())
+            continue;
+
+        const QByteArray line = raw.trimmed();
+        if (line.startsWith("member: ")) {
+            const QList<QByteArray> fields = line.split(' ');
+            if (fields.size() >= 2)
+                snapshot.members[current].insert(QString::fromLatin1(fields.at(1)));
+        } else if (line.startsWith("Opened by PID")) {
+            snapshot.opened.insert(current);
+        }
+    }
+    return snapshot;
+}
+
+bool NetworkSnapshot::isTap(const QString &name)
+{
+    static const QRegularExpression re("^tap\\d+$");
+    return re.match(name).hasMatch();
+}
+
+// ======================== NetworkReconciler ========================
+QString NetworkReconciler::Report::summary() const
+{
+    QString text = QString("в мост добавлено: %1, уничтожено tap: %2").arg(attached).arg(destroyed);
+    if (created > 0)
+        text += QString(", создано заново: %1").arg(created);
+    if (kept > 0)
+        text += QString(", занятых процессами оставлено: %1").arg(kept);
+    if (failed > 0)
+        text += QString(", ошибок: %1").arg(failed);
+    return text + QString("; вызовов ifconfig: %1 за %2 мс").arg(commands).arg(elapsedMs);
+}
+
+NetworkReconciler::NetworkReconciler(CommandRunner *commands, QObject *parent)
+    : QObject(parent)
+    , m_commands(commands)
+{
+    m_batchTimer.setSingleShot(true);
+    m_batchTimer.setInterval(CoalesceMs);
+    connect(&m_batchTimer, &QTimer::timeout, this, &NetworkReconciler::runBatch);
+}
+
+void NetworkReconciler::attach(const QString &tap, QObject *context, MemberCallback done)
+{
+    enqueue(tap, true, context, std::move(done));
+}
+
+void NetworkReconciler::detach(const QString &tap, QObject *context, MemberCallback done)
+{
+    enqueue(tap, false, context, std::move(done));
+}
+
+void NetworkReconciler::enqueue(const QString &tap, bool attach, QObject *context, MemberCallback done)
+{
+    Request request;
+    request.tap = tap;
+    request.attach = attach;
+    request.context = context;
+    request.hasContext = context != nullptr;
+    request.done = std::move(done);
+    m_pending.append(request);
+    // Пока идёт прошлая пачка, новые ждут её конца — finishBatch() их подхватит
+    if (!m_busy && !m_batchTimer.isActive())
+        m_batchTimer.start();
+}
+
+void NetworkReconciler::finishRequest(const Request &request, bool ok, bool changed, const QString &error)
+{
+    if (request.hasContext && !request.context)
+        return;
+    if (request.done)
+        request.done(ok, changed, error);
+}
+
+void NetworkReconciler::runBatch()
+{
+    if (m_busy || m_pending.isEmpty())
+        return;
+    m_busy = true;
+    QList<Request> requests;
+    requests.swap(m_pending);
+
+    takeSnapshot([this, requests](bool ok, const NetworkSnapshot &snapshot, const QString &error) {
+        if (!ok) {
+            for (const Request &request : requests)
+                finishRequest(request, false, false, error);
+            finishBatch();
+            return;
+        }
+
+        // На один tap побеждает последний запрос (ВМ успели остановить и запустить)
+        QHash<QString, int> last;
+        for (int i = 0; i < requests.size(); ++i)
+            last.insert(requests[i].tap, i);
+
+        const QSet<QString> members = snapshot.members.value(m_bridge);
+        QStringList arguments;
+        QList<Request> changing;
+        bool adding = false;
+        for (int i = 0; i < requests.size(); ++i) {
+            const Request &request = requests[i];
+            if (last.value(request.tap) != i) {
+                finishRequest(request, true, false, QString());
+                continue;
+            }
+            if (request.attach && !snapshot.interfaces.contains(request.tap)) {
+                finishRequest(request, false, false, request.tap + " не найден в системе");
+            } else if (request.attach == members.contains(request.tap)) {
+                finishRequest(request, true, false, QString());
+            } else {
+                arguments << (request.attach ? "addm" : "deletem") << request.tap;
+                adding = adding || request.attach;
+                changing << request;
+            }
+        }
+
+        if (changing.isEmpty()) {
+            finishBatch();
+            return;
+        }
+        if (adding)
+            arguments << "up";
+        applyBatch(changing, arguments);
+    });
+}
+
+void NetworkReconciler::applyBatch(const QList<Request> &requests, const QStringList &arguments)
+{
+    m_commands->run(CommandSpec::doas(QStringList {"ifconfig", m_bridge} + arguments), this,
+                    [this, requests](const CommandResult &result) {
+        if (result.ok()) {
+            for (const Request &request : requests)
+                finishRequest(request, true, true, QString());
+            finishBatch();
+            return;
+        }
+
+        // ifconfig останавливается на первой ошибке — дальше по одному
+        QList<CommandSpec> specs;
+        for (const Request &request : requests) {
+            QStringList args = {"ifconfig", m_bridge, request.attach ? "addm" : "deletem", request.tap};
+            if (request.attach)
+                args << "up";
+            specs << CommandSpec::doas(args);
+        }
+        runLimited(specs, [requests](const CommandResult &single) {
+            const QString tap = single.spec.arguments.value(3);
+            for (const Request &request : requests) {
+                if (request.tap == tap)
+                    finishRequest(request, single.ok(), single.ok(), single.ok() ? QString() : single.errorString());
+            }
+        }, [this]() { finishBatch(); });
+    });
+}
+
+void NetworkReconciler::finishBatch()
+{
+    m_busy = false;
+    if (!m_pending.isEmpty() && !m_batchTimer.isActive())
+        m_batchTimer.start();
+}
+
+void NetworkReconciler::cleanup(const QSet<QString> &expected, QObject *context, ReportCallback done)
+{
+    auto report = std::make_shared<Report>();
+    auto clock = std::make_shared<QElapsedTimer>();
+    clock->start();
+    QPointer<QObject> guard(context);
+    const bool hasContext = context != nullptr;
+    auto finish = [report, clock, guard, hasContext, done]() {
+        report->elapsedMs = clock->elapsed();
+        if ((!hasContext || guard) && done)
+            done(*report);
+    };
+
+    report->commands = 1;
+    takeSnapshot([this, expected, report, finish](bool ok, const NetworkSnapshot &snapshot, const QString &error) {
+        if (!ok) {
+            report->failed = 1;
+            report->errors << "ifconfig -a: " + error;
+            finish();
+            return;
+        }
+
+        // Ожидаемые: пропавший tap создаём заново, выпавший из моста — добавляем
+        const QSet<QString> members = snapshot.members.value(m_bridge);
+        auto missing = std::make_shared<QStringList>();
+        QList<CommandSpec> specs;
+        for (const QString &tap : expected) {
+            if (!snapshot.interfaces.contains(tap))
+                specs << CommandSpec::doas({"ifconfig", tap, "create"});
+            if (!members.contains(tap))
+                *missing << tap;
+        }
+        missing->sort();
+        // Лишние: ни одна наша ВМ их не ждёт и ни один процесс не держит открытыми
+        QStringList stale;
+        for (const QString &name : snapshot.interfaces) {
+            if (!NetworkSnapshot::isTap(name) || expected.contains(name))
+                continue;
+            if (snapshot.opened.contains(name))
+                ++report->kept;
+            else
+                stale << name;
+        }
+        stale.sort();
+        for (const QString &tap : qAsConst(stale))
+            specs << CommandSpec::doas({"ifconfig", tap, "destroy"});
+
+        // create и destroy — параллельно, затем один addm на всех недостающих
+        report->commands += specs.size();
+        runLimited(specs, [report, missing](const CommandResult &result) {
+            const QString tap = result.spec.arguments.value(1);
+            if (!result.ok()) {
+                ++report->failed;
+                report->errors << result.spec.toString() + ": " + result.errorString();
+                missing->removeAll(tap);
+            } else if (result.spec.arguments.value(2) == "create") {
+                ++report->created;
+            } else {
+                ++report->destroyed;
+            }
+        }, [this, report, missing, finish]() {
+            if (missing->isEmpty()) {
+                finish();
+                return;
+            }
+            QStringList args = {"ifconfig", m_bridge};
+            for (const QString &tap : qAsConst(*missing))
+                args << "addm" << tap;
+            ++report->commands;
+            m_commands->run(CommandSpec::doas(args << "up"), this, [report, missing, finish](const CommandResult &result) {
+                if (result.ok()) {
+                    report->attached += missing->size();
+                } else {
+                    ++report->failed;
+                    report->errors << result.spec.toString() + ": " + result.errorString();
+                }
+                finish();
+            });
+        });
+    });
+}
+
+void NetworkReconciler::takeSnapshot(SnapshotCallback done)
+{
+    m_commands->run(CommandSpec::make("ifconfig", {"-a"}, 5000), this, [done](const CommandResult &result) {
+        if (!result.ok()) {
+            done(false, NetworkSnapshot(), result.errorString());
+            return;
+        }
+        done(true, NetworkSnapshot::parse(result.standardOutput), QString());
+    });
+}
+
+void NetworkReconciler::runLimited(const QList<CommandSpec> &specs, std::function<void(const CommandResult &)> onEach,
+                                   std::function<void()> done)
+{
+    struct State {
+        QList<CommandSpec> queue;
+        int running = 0;
+        std::function<void(const CommandResult &)> onEach;
+        std::function<void()> done;
+        std::function<void()> pump;
+    };
+    auto state = std::make_shared<State>();
+    state->queue = specs;
+    state->onEach = std::move(onEach);
+    state->done = std::move(done);
+
+    // pump держит state через weak_ptr — иначе цикл ссылок
+    std::weak_ptr<State> weak = state;
+    state->pump = [this, weak]() {
+        auto state = weak.lock();
+        if (!state)
+            return;
+        while (state->running < MaxParallel && !state->queue.isEmpty()) {
+            ++state->running;
+            m_commands->run(state->queue.takeFirst(), this, [state](const CommandResult &result) {
+                --state->running;
+                if (state->onEach)
+                    state->onEach(result);
+                if (state->queue.isEmpty() && state->running == 0) {
+                    if (state->done)
+                        state->done();
+                } else {
+                    state->pump();
+                }
+            });
+        }
+    };
+
+    if (specs.isEmpty()) {
+        if (state->done)
+            state->done();
+        return;
+    }
+    state->pump();
+}
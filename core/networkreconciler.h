@@ -0,0 +1,99 @@
+#ifndef NETWORKRECONCILER_H
+#define NETWORKRECONCILER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <functional>
+
+#include "commandrunner.h"
+
+// Состояние сети хоста по одному выводу "ifconfig -a"
+struct NetworkSnapshot {
+    QSet<QString> interfaces;
+    QSet<QString> opened;                   // tap открыт процессом ("Opened by PID")
+    QHash<QString, QSet<QString>> members;  // мост -> участники (строки "member:")
+
+    static NetworkSnapshot parse(const QByteArray &ifconfigOutput);
+    static bool isTap(const QString &name);  // tap0, tap17 — не tapfoo
+};
+
+// Приводит tap'ы и участников моста к тому, что ожидают ВМ, минимальным
+// числом вызовов ifconfig:
+//  - attach()/detach() от разных ВМ копятся CoalesceMs и применяются пачкой:
+//    один снимок "ifconfig -a", затем одна команда
+//    "ifconfig bridge0 deletem tapA addm tapB ... up" только для тех, кого
+//    это действительно касается (участие сверяется точно, а не подстрокой);
+//    если пачка упала — повтор по одному, чтобы понять, чей tap виноват;
+//  - cleanup() — полная сверка: пропавшие tap'ы работающих ВМ создаются,
+//    tap'ы без ВМ и без открывшего их процесса уничтожаются — параллельно,
+//    не больше MaxParallel ifconfig одновременно; недостающие участники
+//    моста затем добавляются одной командой.
+class NetworkReconciler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int CoalesceMs = 20;
+    static constexpr int MaxParallel = 8;
+
+    // ok — tap в нужном состоянии; changed — пришлось вызвать ifconfig
+    using MemberCallback = std::function<void(bool ok, bool changed, const QString &error)>;
+
+    struct Report {
+        int created = 0;
+        int attached = 0;
+        int destroyed = 0;
+        int kept = 0;       // чужой tap, но открыт процессом — не трогаем
+        int failed = 0;
+        int commands = 0;   // сколько раз запускали ifconfig
+        qint64 elapsedMs = 0;
+        QStringList errors;
+
+        QString summary() const;
+    };
+    using ReportCallback = std::function<void(const Report &report)>;
+
+    explicit NetworkReconciler(CommandRunner *commands, QObject *parent = nullptr);
+
+    void setBridge(const QString &bridge) { m_bridge = bridge; }
+    QString bridge() const { return m_bridge; }
+
+    void attach(const QString &tap, QObject *context, MemberCallback done);
+    void detach(const QString &tap, QObject *context, MemberCallback done);
+
+    // expected — tap'ы активных ВМ: они должны быть в мосту, остальные лишние
+    void cleanup(const QSet<QString> &expected, QObject *context, ReportCallback done);
+
+private:
+    struct Request {
+        QString tap;
+        bool attach = true;
+        QPointer<QObject> context;
+        bool hasContext = false;
+        MemberCallback done;
+    };
+
+    void enqueue(const QString &tap, bool attach, QObject *context, MemberCallback done);
+    void runBatch();
+    void finishBatch();
+    void applyBatch(const QList<Request> &requests, const QStringList &arguments);
+    static void finishRequest(const Request &request, bool ok, bool changed, const QString &error);
+
+    using SnapshotCallback = std::function<void(bool ok, const NetworkSnapshot &snapshot, const QString &error)>;
+    void takeSnapshot(SnapshotCallback done);
+    // Команды параллельно, не больше MaxParallel; onEach — по каждой, done — в конце
+    void runLimited(const QList<CommandSpec> &specs, std::function<void(const CommandResult &)> onEach,
+                    std::function<void()> done);
+
+    CommandRunner *m_commands;
+    QString m_bridge = "bridge0";
+    QList<Request> m_pending;
+    QTimer m_batchTimer;
+    bool m_busy = false;
+};
+
+#endif // NETWORKRECONCILER_H
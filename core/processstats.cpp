@@ -0,0 +1,169 @@
+#include "processstats.h"
+
+#include <QElapsedTimer>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(Q_OS_FREEBSD)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#include <sys/user.h>
+#endif
+
+namespace {
+
+#if defined(Q_OS_LINUX)
+// Файл из /proc целиком в буфер на стеке — без QFile и без аллокаций
+int readSmallFile(const char *path, char *buf, int size)
+{
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    const ssize_t n = ::read(fd, buf, size_t(size - 1));
+    ::close(fd);
+    if (n < 0)
+        return -1;
+    buf[n] = '\0';
+    return int(n);
+}
+
+quint64 fieldAfter(const char *text, const char *key)
+{
+    const char *p = std::strstr(text, key);
+    return p ? std::strtoull(p + std::strlen(key), nullptr, 10) : 0;
+}
+
+class ProcfsStatsBackend : public ProcessStatsBackend
+{
+public:
+    ProcfsStatsBackend()
+        : m_ticksPerSecond(quint64(qMax(1L, ::sysconf(_SC_CLK_TCK))))
+        , m_pageSize(quint64(qMax(1L, ::sysconf(_SC_PAGESIZE))))
+    {
+    }
+
+    QString name() const override { return "procfs"; }
+
+    bool read(qint64 pid, ProcessStats *stats) override
+    {
+        char path[64];
+        char buf[1024];
+
+        std::snprintf(path, sizeof(path), "/proc/%lld/stat", static_cast<long long>(pid));
+        if (readSmallFile(path, buf, sizeof(buf)) <= 0)
+            return false;
+
+        // Имя процесса в скобках может содержать пробелы — считаем поля после ')'
+        const char *p = std::strrchr(buf, ')');
+        if (!p)
+            return false;
+        quint64 utime = 0, stime = 0, rssPages = 0;
+        int field = 2;
+        for (++p; *p; ) {
+            while (*p == ' ')
+                ++p;
+            ++field;
+            if (field == 14) utime = std::strtoull(p, nullptr, 10);
+            else if (field == 15) stime = std::strtoull(p, nullptr, 10);
+            else if (field == 24) { rssPages = std::strtoull(p, nullptr, 10); break; }
+            while (*p && *p != ' ')
+                ++p;
+        }
+        stats->cpuTimeUs = (utime + stime) * 1000000ULL / m_ticksPerSecond;
+        stats->rssBytes = rssPages * m_pageSize;
+
+        // /proc/<pid>/io читается только владельцем или root
+        std::snprintf(path, sizeof(path), "/proc/%lld/io", static_cast<long long>(pid));
+        stats->hasIoBytes = readSmallFile(path, buf, sizeof(buf)) > 0;
+        if (stats->hasIoBytes) {
+            stats->readOps = fieldAfter(buf, "syscr: ");
+            stats->writeOps = fieldAfter(buf, "syscw: ");
+            stats->readBytes = fieldAfter(buf, "read_bytes: ");
+            stats->writeBytes = fieldAfter(buf, "write_bytes: ");
+        }
+        return true;
+    }
+
+private:
+    quint64 m_ticksPerSecond;
+    quint64 m_pageSize;
+};
+#endif
+
+#if defined(Q_OS_FREEBSD)
+class SysctlStatsBackend : public ProcessStatsBackend
+{
+public:
+    SysctlStatsBackend()
+        : m_pageSize(quint64(::getpagesize()))
+    {
+    }
+
+    QString name() const override { return "sysctl"; }
+
+    bool read(qint64 pid, ProcessStats *stats) override
+    {
+        int mib[4] = {CTL_KERN, KERN_PROC, KERN_PROC_PID, int(pid)};
+        struct kinfo_proc kp;
+        size_t len = sizeof(kp);
+        if (::sysctl(mib, 4, &kp, &len, nullptr, 0) != 0 || len == 0)
+            return false;
+
+        stats->cpuTimeUs = quint64(kp.ki_runtime);
+        stats->rssBytes = quint64(kp.ki_rssize) * m_pageSize;
+        stats->readOps = quint64(kp.ki_rusage.ru_inblock);
+        stats->writeOps = quint64(kp.ki_rusage.ru_oublock);
+        stats->hasIoBytes = false;
+        return true;
+    }
+
+private:
+    quint64 m_pageSize;
+};
+#endif
+
+class NullStatsBackend : public ProcessStatsBackend
+{
+public:
+    QString name() const override { return "none"; }
+    bool read(qint64, ProcessStats *) override { return false; }
+};
+
+} // namespace
+
+std::unique_ptr<ProcessStatsBackend> ProcessStatsBackend::create()
+{
+    if (qEnvironmentVariable("VMRUN_STATS_BACKEND") == "fake")
+        return std::make_unique<FakeProcessStatsBackend>();
+#if defined(Q_OS_LINUX)
+    return std::make_unique<ProcfsStatsBackend>();
+#elif defined(Q_OS_FREEBSD)
+    return std::make_unique<SysctlStatsBackend>();
+#else
+    return std::make_unique<NullStatsBackend>();
+#endif
+}
+
+bool FakeProcessStatsBackend::read(qint64 pid, ProcessStats *stats)
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    const quint64 ms = quint64(clock.elapsed());
+    // 5..45% CPU в зависимости от pid, память — от 256 МБ
+    const quint64 load = 5 + quint64(pid % 41);
+    stats->cpuTimeUs = ms * 10 * load;
+    stats->rssBytes = (256ULL + quint64(pid % 768)) << 20;
+    stats->readOps = ms / 10;
+    stats->writeOps = ms / 20;
+    stats->readBytes = stats->readOps * 4096;
+    stats->writeBytes = stats->writeOps * 4096;
+    stats->hasIoBytes = true;
+    return true;
+}
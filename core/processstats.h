@@ -0,0 +1,44 @@
+#ifndef PROCESSSTATS_H
+#define PROCESSSTATS_H
+
+#include <QtGlobal>
+#include <QString>
+#include <memory>
+
+// Счётчики одного процесса на момент чтения
+struct ProcessStats {
+    quint64 cpuTimeUs = 0;    // user + system
+    quint64 rssBytes = 0;
+    quint64 readOps = 0;      // read-системные вызовы (Linux) или блоки ввода (FreeBSD)
+    quint64 writeOps = 0;
+    quint64 readBytes = 0;    // только если hasIoBytes
+    quint64 writeBytes = 0;
+    bool hasIoBytes = false;
+};
+
+// Чтение ProcessStats из ОС. Вызывается из потока сэмплера, поэтому
+// реализации не должны трогать Qt-объекты и не должны аллоцировать
+// на каждом вызове больше необходимого.
+class ProcessStatsBackend
+{
+public:
+    virtual ~ProcessStatsBackend() = default;
+
+    virtual QString name() const = 0;
+    // false — процесса нет или читать нечего
+    virtual bool read(qint64 pid, ProcessStats *stats) = 0;
+
+    // procfs на Linux, sysctl(KERN_PROC_PID) на FreeBSD, иначе заглушка;
+    // VMRUN_STATS_BACKEND=fake — синтетические числа для прогонов без bhyve
+    static std::unique_ptr<ProcessStatsBackend> create();
+};
+
+// Синтетическая нагрузка: монотонные счётчики, зависящие от pid
+class FakeProcessStatsBackend : public ProcessStatsBackend
+{
+public:
+    QString name() const override { return "fake"; }
+    bool read(qint64 pid, ProcessStats *stats) override;
+};
+
+#endif // PROCESSSTATS_H
@@ -0,0 +1,303 @@
+#include "resourcesampler.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimer>
+
+#include <time.h>
+
+// ======================== SampleRing ========================
+void SampleRing::push(const ResourceSample &sample)
+{
+    const quint64 index = m_head.load(std::memory_order_relaxed);
+    Slot &slot = m_slots[index % Capacity];
+
+    // Версия ячейки — номер замера: 2·index+1 — пишется, 2·index+2 — готова
+    slot.version.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sample = sample;
+    slot.version.store(2 * index + 2, std::memory_order_release);
+
+    m_head.store(index + 1, std::memory_order_release);
+}
+
+bool SampleRing::readSlot(quint64 index, ResourceSample *sample) const
+{
+    // Ждём ровно версию замера index: недописанная ячейка и ячейка, которую
+    // писатель обогнал на круг, пока читали снимок, одинаково пропускаются
+    const Slot &slot = m_slots[index % Capacity];
+    const quint64 expected = 2 * index + 2;
+    if (slot.version.load(std::memory_order_acquire) != expected)
+        return false;
+    *sample = slot.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.version.load(std::memory_order_relaxed) == expected;
+}
+
+QVector<ResourceSample> SampleRing::snapshot(int maxCount) const
+{
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    const quint64 count = qMin<quint64>(head, quint64(qBound(0, maxCount, Capacity - 1)));
+
+    QVector<ResourceSample> samples;
+    samples.reserve(int(count));
+    ResourceSample sample;
+    for (quint64 i = head - count; i < head; ++i) {
+        if (readSlot(i, &sample))
+            samples.append(sample);
+    }
+    return samples;
+}
+
+bool SampleRing::latest(ResourceSample *sample) const
+{
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    return head > 0 && readSlot(head - 1, sample);
+}
+
+// ======================== SamplerWorker ========================
+// Живёт в потоке сэмплера; без собственных сигналов, поэтому без Q_OBJECT
+class SamplerWorker : public QObject
+{
+public:
+    static constexpr int ExportIntervalMs = 5000;
+
+    explicit SamplerWorker(ResourceSampler *owner)
+        : m_owner(owner)
+    {
+    }
+
+    void start()
+    {
+        m_timer = new QTimer(this);
+        m_timer->setTimerType(Qt::CoarseTimer);
+        connect(m_timer, &QTimer::timeout, this, [this]() { tick(); });
+        m_timer->start(m_owner->interval());
+        m_window.start();
+        m_windowCpuNs = threadCpuNs();
+    }
+
+    void setInterval(int ms)
+    {
+        if (m_timer)
+            m_timer->setInterval(ms);
+    }
+
+private:
+    struct Previous {
+        ProcessStats stats;
+        qint64 atMs = 0;
+    };
+
+    static quint64 threadCpuNs()
+    {
+        timespec ts {};
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return quint64(ts.tv_sec) * 1000000000ULL + quint64(ts.tv_nsec);
+    }
+
+    void tick()
+    {
+        QHash<QString, ResourceSampler::Target> targets;
+        {
+            QMutexLocker lock(&m_owner->m_mutex);
+            targets = m_owner->m_targets;
+        }
+
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        ProcessStats stats;
+        for (auto it = targets.cbegin(); it != targets.cend(); ++it) {
+            stats = ProcessStats();
+            if (!m_owner->m_backend->read(it->pid, &stats))
+                continue;
+
+            ResourceSample sample;
+            sample.timestampMs = now;
+            sample.cpuTimeUs = stats.cpuTimeUs;
+            sample.rssBytes = stats.rssBytes;
+            sample.readBytes = stats.readBytes;
+            sample.writeBytes = stats.writeBytes;
+            sample.hasIoBytes = stats.hasIoBytes;
+
+            auto prev = m_previous.find(it.key());
+            if (prev != m_previous.end() && now > prev->atMs) {
+                const double seconds = double(now - prev->atMs) / 1000.0;
+                auto rate = [seconds](quint64 cur, quint64 old) {
+                    return cur >= old ? float(double(cur - old) / seconds) : 0.0f;
+                };
+                sample.cpuPercent = rate(stats.cpuTimeUs, prev->stats.cpuTimeUs) / 10000.0f;
+                sample.readOpsPerSec = rate(stats.readOps, prev->stats.readOps);
+                sample.writeOpsPerSec = rate(stats.writeOps, prev->stats.writeOps);
+                sample.readBytesPerSec = rate(stats.readBytes, prev->stats.readBytes);
+                sample.writeBytesPerSec = rate(stats.writeBytes, prev->stats.writeBytes);
+            }
+            m_previous[it.key()] = Previous{stats, now};
+            it->ring->push(sample);
+        }
+
+        // ВМ, которые перестали отслеживать
+        for (auto it = m_previous.begin(); it != m_previous.end(); ) {
+            if (targets.contains(it.key()))
+                ++it;
+            else
+                it = m_previous.erase(it);
+        }
+
+        if (!m_lastExport.isValid() || m_lastExport.elapsed() >= ExportIntervalMs) {
+            m_lastExport.start();
+            exportPrometheus(targets);
+        }
+
+        // Собственная стоимость: CPU потока за окно ~10 с к длине окна
+        if (m_window.elapsed() >= 10000) {
+            const quint64 cpuNs = threadCpuNs();
+            const double ratio = double(cpuNs - m_windowCpuNs) / (double(m_window.nsecsElapsed()));
+            m_owner->m_overheadPpm.store(quint64(ratio * 1e6), std::memory_order_relaxed);
+            m_window.restart();
+            m_windowCpuNs = cpuNs;
+        }
+
+        emit m_owner->sampled();
+    }
+
+    void exportPrometheus(const QHash<QString, ResourceSampler::Target> &targets)
+    {
+        const QString path = m_owner->prometheusFile();
+        if (path.isEmpty())
+            return;
+
+        auto label = [](QString name) {
+            name.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+            return "{vm=\"" + name + "\"}";
+        };
+
+        QString cpu, ratio, rss, readOps, writeOps, readBytes, writeBytes;
+        ResourceSample s;
+        for (auto it = targets.cbegin(); it != targets.cend(); ++it) {
+            if (!it->ring->latest(&s))
+                continue;
+            const QString l = label(it.key());
+            cpu += "vmrun_vm_cpu_seconds_total" + l + ' ' + QString::number(double(s.cpuTimeUs) / 1e6, 'f', 3) + '\n';
+            ratio += "vmrun_vm_cpu_ratio" + l + ' ' + QString::number(s.cpuPercent / 100.0, 'f', 4) + '\n';
+            rss += "vmrun_vm_resident_memory_bytes" + l + ' ' + QString::number(s.rssBytes) + '\n';
+            if (s.hasIoBytes) {
+                readBytes += "vmrun_vm_io_read_bytes_total" + l + ' ' + QString::number(s.readBytes) + '\n';
+                writeBytes += "vmrun_vm_io_write_bytes_total" + l + ' ' + QString::number(s.writeBytes) + '\n';
+            }
+            readOps += "vmrun_vm_io_read_ops_per_second" + l + ' ' + QString::number(s.readOpsPerSec, 'f', 1) + '\n';
+            writeOps += "vmrun_vm_io_write_ops_per_second" + l + ' ' + QString::number(s.writeOpsPerSec, 'f', 1) + '\n';
+        }
+
+        QString text;
+        auto family = [&text](const char *name, const char *type, const char *help, const QString &samples) {
+            if (samples.isEmpty())
+                return;
+            text += QString("# HELP %1 %2\n# TYPE %1 %3\n").arg(name, help, type) + samples;
+        };
+        family("vmrun_vm_cpu_seconds_total", "counter", "CPU time of the bhyve process.", cpu);
+        family("vmrun_vm_cpu_ratio", "gauge", "CPU usage over the last interval, 1 = one core.", ratio);
+        family("vmrun_vm_resident_memory_bytes", "gauge", "Resident set size of the bhyve process.", rss);
+        family("vmrun_vm_io_read_bytes_total", "counter", "Bytes read by the bhyve process.", readBytes);
+        family("vmrun_vm_io_write_bytes_total", "counter", "Bytes written by the bhyve process.", writeBytes);
+        family("vmrun_vm_io_read_ops_per_second", "gauge", "Read operations per second.", readOps);
+        family("vmrun_vm_io_write_ops_per_second", "gauge", "Write operations per second.", writeOps);
+        family("vmrun_sampler_overhead_ratio", "gauge", "CPU used by the sampler thread, 1 = one core.",
+               QString("vmrun_sampler_overhead_ratio %1\n").arg(m_owner->overheadRatio(), 0, 'f', 6));
+        family("vmrun_sampler_tracked_vms", "gauge", "Number of VMs being sampled.",
+               QString("vmrun_sampler_tracked_vms %1\n").arg(targets.size()));
+
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+        file.write(text.toUtf8());
+        file.commit();
+    }
+
+    ResourceSampler *m_owner;
+    QTimer *m_timer = nullptr;
+    QHash<QString, Previous> m_previous;
+    QElapsedTimer m_lastExport;
+    QElapsedTimer m_window;
+    quint64 m_windowCpuNs = 0;
+};
+
+// ======================== ResourceSampler ========================
+ResourceSampler::ResourceSampler(QObject *parent)
+    : QObject(parent)
+    , m_backend(ProcessStatsBackend::create())
+{
+    m_worker = new SamplerWorker(this);
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::started, m_worker, [worker = m_worker]() { worker->start(); });
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread.setObjectName("vmrun-sampler");
+    m_thread.start(QThread::LowPriority);
+}
+
+ResourceSampler::~ResourceSampler()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QString ResourceSampler::backendName() const
+{
+    return m_backend->name();
+}
+
+void ResourceSampler::setInterval(int ms)
+{
+    const int interval = qMax(50, ms);
+    m_intervalMs.store(interval, std::memory_order_relaxed);
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, interval]() { worker->setInterval(interval); });
+}
+
+void ResourceSampler::setPrometheusFile(const QString &path)
+{
+    QMutexLocker lock(&m_mutex);
+    m_prometheusFile = path;
+}
+
+QString ResourceSampler::prometheusFile() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_prometheusFile;
+}
+
+std::shared_ptr<SampleRing> ResourceSampler::track(const QString &vm, qint64 pid)
+{
+    QMutexLocker lock(&m_mutex);
+    std::shared_ptr<SampleRing> &ring = m_rings[vm];
+    if (!ring)
+        ring = std::make_shared<SampleRing>();
+    m_targets.insert(vm, Target{pid, ring});
+    return ring;
+}
+
+void ResourceSampler::untrack(const QString &vm)
+{
+    QMutexLocker lock(&m_mutex);
+    m_targets.remove(vm);
+}
+
+void ResourceSampler::forget(const QString &vm)
+{
+    QMutexLocker lock(&m_mutex);
+    m_targets.remove(vm);
+    m_rings.remove(vm);
+}
+
+std::shared_ptr<SampleRing> ResourceSampler::ring(const QString &vm) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_rings.value(vm);
+}
+
+double ResourceSampler::overheadRatio() const
+{
+    return double(m_overheadPpm.load(std::memory_order_relaxed)) / 1e6;
+}
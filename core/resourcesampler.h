@@ -0,0 +1,114 @@
+#ifndef RESOURCESAMPLER_H
+#define RESOURCESAMPLER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+#include "processstats.h"
+
+// Один замер ВМ; скорости посчитаны потоком сэмплера по соседним замерам
+struct ResourceSample {
+    qint64 timestampMs = 0;   // QDateTime::currentMSecsSinceEpoch()
+    float cpuPercent = 0;     // 100 = одно ядро
+    quint64 cpuTimeUs = 0;
+    quint64 rssBytes = 0;
+    float readOpsPerSec = 0;
+    float writeOpsPerSec = 0;
+    float readBytesPerSec = 0;
+    float writeBytesPerSec = 0;
+    quint64 readBytes = 0;
+    quint64 writeBytes = 0;
+    bool hasIoBytes = false;
+};
+
+// Кольцо замеров фиксированной ёмкости: один писатель (поток сэмплера),
+// сколько угодно читателей без блокировок. Каждая ячейка защищена своим
+// счётчиком версий (seqlock) с номером замера: читатель, попавший на запись
+// или на ячейку, уже занятую следующим кругом, просто пропускает её.
+class SampleRing
+{
+public:
+    static constexpr int Capacity = 512;  // ~8.5 мин при 1 Гц
+
+    void push(const ResourceSample &sample);
+    // До maxCount последних замеров, от старых к новым
+    QVector<ResourceSample> snapshot(int maxCount = Capacity) const;
+    bool latest(ResourceSample *sample) const;
+    quint64 written() const { return m_head.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        std::atomic<quint64> version {0};
+        ResourceSample sample;
+    };
+
+    bool readSlot(quint64 index, ResourceSample *sample) const;
+
+    Slot m_slots[Capacity];
+    std::atomic<quint64> m_head {0};  // сколько замеров записано всего
+};
+
+class SamplerWorker;
+
+// Периодически снимает ProcessStats со всех отслеживаемых процессов ВМ
+// в отдельном потоке и кладёт их в SampleRing каждой ВМ. GUI и экспорт
+// читают кольца без блокировок; sampled() приходит в поток владельца
+// раз за проход. Опционально пишет файл для Prometheus (textfile collector).
+class ResourceSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultIntervalMs = 1000;
+
+    explicit ResourceSampler(QObject *parent = nullptr);
+    ~ResourceSampler() override;
+
+    QString backendName() const;
+
+    void setInterval(int ms);
+    int interval() const { return m_intervalMs.load(std::memory_order_relaxed); }
+
+    // Пустой путь — экспорт выключен; файл обновляется атомарно (QSaveFile)
+    void setPrometheusFile(const QString &path);
+    QString prometheusFile() const;
+
+    // История ВМ переживает перезапуски: track() после untrack() пишет
+    // в то же кольцо. forget() — когда ВМ убрали совсем.
+    std::shared_ptr<SampleRing> track(const QString &vm, qint64 pid);
+    void untrack(const QString &vm);
+    void forget(const QString &vm);
+    std::shared_ptr<SampleRing> ring(const QString &vm) const;
+
+    // Доля одного ядра, которую тратит сам сэмплер (CPU потока / время)
+    double overheadRatio() const;
+
+signals:
+    void sampled();
+
+private:
+    friend class SamplerWorker;
+
+    struct Target {
+        qint64 pid = 0;
+        std::shared_ptr<SampleRing> ring;
+    };
+
+    mutable QMutex m_mutex;  // m_targets, m_rings и m_prometheusFile
+    QHash<QString, Target> m_targets;
+    QHash<QString, std::shared_ptr<SampleRing>> m_rings;
+    QString m_prometheusFile;
+    std::atomic<int> m_intervalMs {DefaultIntervalMs};
+
+    std::unique_ptr<ProcessStatsBackend> m_backend;
+    std::atomic<quint64> m_overheadPpm {0};
+    QThread m_thread;
+    SamplerWorker *m_worker = nullptr;
+};
+
+#endif // RESOURCESAMPLER_H
@@ -0,0 +1,148 @@
+#include "restarttracker.h"
+
+#include <QRandomGenerator>
+
+RestartTracker::ExitKind RestartTracker::classify(int exitCode, bool crashed)
+{
+    if (crashed)
+        return ExitKind::Failure;
+    switch (exitCode) {
+    case 0:  return ExitKind::Reboot;
+    case 1:  return ExitKind::PowerOff;
+    case 2:  return ExitKind::Halt;
+    default: return ExitKind::Failure;
+    }
+}
+
+QString RestartTracker::exitKindName(ExitKind kind)
+{
+    switch (kind) {
+    case ExitKind::Reboot:   return "перезагрузка гостя";
+    case ExitKind::PowerOff: return "гость выключился";
+    case ExitKind::Halt:     return "гость остановлен (halt)";
+    case ExitKind::Failure:  return "сбой";
+    }
+    return QString();
+}
+
+RestartTracker::RestartTracker(const RestartPolicy &policy)
+    : m_policy(policy)
+{
+}
+
+void RestartTracker::arm()
+{
+    m_recentFailures.clear();
+    m_consecutiveFailures = 0;
+    m_crashLoop = false;
+    m_failedAtMs = -1;
+}
+
+void RestartTracker::onStarted(qint64 nowMs)
+{
+    m_startedAtMs = nowMs;
+    if (m_failedAtMs >= 0) {
+        m_recovery.record(nowMs - m_failedAtMs);
+        m_failedAtMs = -1;
+    }
+}
+
+RestartTracker::Decision RestartTracker::onExit(ExitKind kind, qint64 nowMs)
+{
+    Decision decision;
+    decision.reason = exitKindName(kind);
+
+    const qint64 uptime = finishRun(nowMs);
+
+    // Долго проработала — прошлые сбои к этой серии не относятся
+    if (uptime >= m_policy.minUptimeMs)
+        m_consecutiveFailures = 0;
+
+    if (kind == ExitKind::Failure) {
+        ++m_failures;
+        ++m_consecutiveFailures;
+        m_failedAtMs = nowMs;
+        m_recentFailures.append(nowMs);
+        while (!m_recentFailures.isEmpty() && nowMs - m_recentFailures.first() > m_policy.crashLoopWindowMs)
+            m_recentFailures.removeFirst();
+    }
+
+    switch (m_policy.mode) {
+    case RestartPolicy::Never:
+        decision.restart = false;
+        break;
+    case RestartPolicy::OnFailure:
+        decision.restart = kind == ExitKind::Reboot || kind == ExitKind::Failure;
+        break;
+    case RestartPolicy::Always:
+        decision.restart = true;
+        break;
+    }
+    if (!decision.restart)
+        return decision;
+
+    if (kind == ExitKind::Failure
+        && m_policy.crashLoopFailures > 0
+        && m_recentFailures.size() >= m_policy.crashLoopFailures) {
+        m_crashLoop = true;
+        decision.restart = false;
+        decision.crashLoop = true;
+        decision.reason = QString("%1 сбоев за %2 с — перезапуски прекращены")
+                              .arg(m_recentFailures.size())
+                              .arg(m_policy.crashLoopWindowMs / 1000);
+        return decision;
+    }
+
+    decision.delayMs = (kind == ExitKind::Failure)
+        ? withJitter(backoffMs(m_consecutiveFailures))
+        : m_policy.rebootDelayMs;
+    ++m_restarts;
+    return decision;
+}
+
+void RestartTracker::onStopped(qint64 nowMs)
+{
+    finishRun(nowMs);
+}
+
+// Процесс так и не стартовал — аптайм не считаем
+qint64 RestartTracker::finishRun(qint64 nowMs)
+{
+    if (m_startedAtMs < 0)
+        return 0;
+    const qint64 uptime = nowMs - m_startedAtMs;
+    ++m_runs;
+    m_uptimeSumMs += uptime;
+    m_startedAtMs = -1;
+    return uptime;
+}
+
+// initial * 2^(n-1), не больше maxBackoffMs
+int RestartTracker::backoffMs(int failureNumber) const
+{
+    qint64 delay = qMax(m_policy.initialBackoffMs, 0);
+    for (int i = 1; i < failureNumber && delay < m_policy.maxBackoffMs; ++i)
+        delay *= 2;
+    return int(qMin<qint64>(delay, m_policy.maxBackoffMs));
+}
+
+int RestartTracker::withJitter(int delayMs) const
+{
+    const int spread = delayMs * qBound(0, m_policy.jitterPercent, 100) / 100;
+    if (spread <= 0)
+        return delayMs;
+    return qMax(0, delayMs + QRandomGenerator::global()->bounded(-spread, spread + 1));
+}
+
+QString RestartTracker::summary() const
+{
+    const qint64 uptimeMin = meanUptimeMs() / 60000;
+    QString text = QString("рестартов %1, сбоев %2, средний аптайм %3 ч %4 мин")
+                       .arg(m_restarts).arg(m_failures)
+                       .arg(uptimeMin / 60).arg(uptimeMin % 60);
+    if (m_recovery.count())
+        text += "\nвосстановление после сбоя: " + m_recovery.summary();
+    if (m_crashLoop)
+        text += "\nпредохранитель сработал — нужен ручной запуск";
+    return text;
+}
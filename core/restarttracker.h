@@ -0,0 +1,81 @@
+#ifndef RESTARTTRACKER_H
+#define RESTARTTRACKER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+
+#include "vmconfig.h"
+#include "latencyhistogram.h"
+
+// Решает по RestartPolicy, перезапускать ли bhyve после выхода и через
+// сколько, и ведёт счётчики для таблицы ВМ. Время передаётся снаружи
+// (монотонные миллисекунды), поэтому класс без таймеров и QObject.
+class RestartTracker
+{
+public:
+    // Коды выхода bhyve(8): 0 — перезагрузка, 1 — выключение, 2 — halt,
+    // 3 — triple fault, 4 — ошибка; убийство сигналом — тоже сбой
+    enum class ExitKind {
+        Reboot,
+        PowerOff,
+        Halt,
+        Failure
+    };
+
+    struct Decision {
+        bool restart = false;
+        int delayMs = 0;
+        bool crashLoop = false;   // сработал предохранитель
+        QString reason;
+    };
+
+    static ExitKind classify(int exitCode, bool crashed);
+    static QString exitKindName(ExitKind kind);
+
+    explicit RestartTracker(const RestartPolicy &policy = RestartPolicy());
+
+    void setPolicy(const RestartPolicy &policy) { m_policy = policy; }
+    const RestartPolicy &policy() const { return m_policy; }
+
+    // start() пользователя: сбрасывает серию сбоев и предохранитель,
+    // накопленные счётчики остаются
+    void arm();
+
+    void onStarted(qint64 nowMs);
+    Decision onExit(ExitKind kind, qint64 nowMs);
+    // Выход после stop(): только учитываем аптайм
+    void onStopped(qint64 nowMs);
+
+    int restarts() const { return m_restarts; }
+    int failures() const { return m_failures; }
+    int consecutiveFailures() const { return m_consecutiveFailures; }
+    bool isCrashLoop() const { return m_crashLoop; }
+    qint64 meanUptimeMs() const { return m_runs ? m_uptimeSumMs / m_runs : 0; }
+    // От выхода со сбоем до следующего запуска bhyve
+    const LatencyHistogram &recoveryStats() const { return m_recovery; }
+
+    // "рестартов 3, сбоев 2, средний аптайм 4 ч 12 мин, восстановление n=2 ..."
+    QString summary() const;
+
+private:
+    qint64 finishRun(qint64 nowMs);
+    int backoffMs(int failureNumber) const;
+    int withJitter(int delayMs) const;
+
+    RestartPolicy m_policy;
+    QVector<qint64> m_recentFailures;  // моменты сбоев внутри окна
+    int m_consecutiveFailures = 0;
+    bool m_crashLoop = false;
+
+    qint64 m_startedAtMs = -1;
+    qint64 m_failedAtMs = -1;
+
+    int m_restarts = 0;
+    int m_failures = 0;
+    qint64 m_runs = 0;
+    qint64 m_uptimeSumMs = 0;
+    LatencyHistogram m_recovery;
+};
+
+#endif // RESTARTTRACKER_H
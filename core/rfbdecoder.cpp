@@ -0,0 +1,832 @@
+#include "rfbdecoder.h"
+
+#include <QElapsedTimer>
+#include <QSysInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr int ZrleTileSize = 64;
+constexpr quint32 MaxCompressedBytes = 64u << 20;
+constexpr int MaxDirtyRects = 256;  // больше — отдаём одним охватывающим
+constexpr quint32 Opaque = 0xff000000u;
+
+quint16 be16(const uchar *p) { return qFromBigEndian<quint16>(p); }
+quint32 be32(const uchar *p) { return qFromBigEndian<quint32>(p); }
+
+// 0xRRGGBB → 0xffRRGGBB
+void convertNative(const uchar *src, quint32 *dst, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i alpha = _mm_set1_epi32(int(Opaque));
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4 + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(a, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4), _mm_or_si128(b, alpha));
+    }
+#endif
+    for (; i < count; ++i) {
+        quint32 value;
+        std::memcpy(&value, src + i * 4, 4);
+        dst[i] = value | Opaque;
+    }
+}
+
+// 0xBBGGRR → 0xffRRGGBB
+void convertSwapped(const uchar *src, quint32 *dst, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i alpha = _mm_set1_epi32(int(Opaque));
+    const __m128i green = _mm_set1_epi32(0x0000ff00);
+    const __m128i low = _mm_set1_epi32(0x000000ff);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        const __m128i red = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+        const __m128i blue = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+        const __m128i out = _mm_or_si128(_mm_or_si128(red, blue), _mm_or_si128(_mm_and_si128(p, green), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), out);
+    }
+#endif
+    for (; i < count; ++i) {
+        quint32 value;
+        std::memcpy(&value, src + i * 4, 4);
+        dst[i] = Opaque | (value & 0x0000ff00u) | ((value & 0xffu) << 16) | ((value >> 16) & 0xffu);
+    }
+}
+
+quint32 scaleChannel(quint32 value, int shift, int max)
+{
+    const quint32 c = (value >> shift) & quint32(max);
+    if (max == 255)
+        return c;
+    return max > 0 ? (c * 255 + quint32(max) / 2) / quint32(max) : 0;
+}
+
+} // namespace
+
+// ======================== PixelFormat ========================
+
+QByteArray RfbDecoder::PixelFormat::encode() const
+{
+    QByteArray data(16, '\0');
+    uchar *p = reinterpret_cast<uchar *>(data.data());
+    p[0] = uchar(bitsPerPixel);
+    p[1] = uchar(depth);
+    p[2] = bigEndian ? 1 : 0;
+    p[3] = trueColour ? 1 : 0;
+    qToBigEndian<quint16>(quint16(redMax), p + 4);
+    qToBigEndian<quint16>(quint16(greenMax), p + 6);
+    qToBigEndian<quint16>(quint16(blueMax), p + 8);
+    p[10] = uchar(redShift);
+    p[11] = uchar(greenShift);
+    p[12] = uchar(blueShift);
+    return data;
+}
+
+RfbDecoder::PixelFormat RfbDecoder::PixelFormat::decode(const char *data)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    PixelFormat format;
+    format.bitsPerPixel = p[0];
+    format.depth = p[1];
+    format.bigEndian = p[2] != 0;
+    format.trueColour = p[3] != 0;
+    format.redMax = be16(p + 4);
+    format.greenMax = be16(p + 6);
+    format.blueMax = be16(p + 8);
+    format.redShift = p[10];
+    format.greenShift = p[11];
+    format.blueShift = p[12];
+    return format;
+}
+
+// ======================== RfbDecoder ========================
+
+RfbDecoder::RfbDecoder(RfbSurface *surface)
+    : m_surface(surface)
+    , m_encodings(defaultEncodings())
+{
+    std::memset(&m_zlibStream, 0, sizeof(m_zlibStream));
+    std::memset(&m_zrleStream, 0, sizeof(m_zrleStream));
+    // Разобранные байты выбрасываются из начала буфера, память остаётся
+    m_in.reserve(1 << 20);
+}
+
+RfbDecoder::~RfbDecoder()
+{
+    if (m_zlibReady)
+        inflateEnd(&m_zlibStream);
+    if (m_zrleReady)
+        inflateEnd(&m_zrleStream);
+}
+
+QVector<qint32> RfbDecoder::defaultEncodings()
+{
+    return {Zrle, Zlib, CopyRect, Raw, DesktopSize};
+}
+
+bool RfbDecoder::feed(const char *data, qint64 size)
+{
+    if (m_phase == Phase::Failed)
+        return false;
+    QElapsedTimer clock;
+    clock.start();
+    m_stats.bytesIn += size;
+    if (m_pos > 0) {
+        m_in.remove(0, int(m_pos));
+        m_pos = 0;
+    }
+    m_in.append(data, int(size));
+    const bool ok = parse();
+    m_stats.decodeNs += clock.nsecsElapsed();
+    return ok;
+}
+
+QByteArray RfbDecoder::takeOutput()
+{
+    QByteArray out;
+    out.swap(m_out);
+    return out;
+}
+
+int RfbDecoder::takeCompletedUpdates()
+{
+    const int n = m_completedUpdates;
+    m_completedUpdates = 0;
+    return n;
+}
+
+QVector<QRect> RfbDecoder::takeDirtyRects()
+{
+    QVector<QRect> rects;
+    rects.swap(m_dirty);
+    return rects;
+}
+
+bool RfbDecoder::fail(const QString &error)
+{
+    m_phase = Phase::Failed;
+    m_error = error;
+    return false;
+}
+
+// Каждый шаг либо что-то разбирает, либо ждёт данных (false)
+bool RfbDecoder::parse()
+{
+    while (m_phase != Phase::Failed) {
+        const bool progress = m_phase == Phase::Normal ? parseMessage() : parseHandshake();
+        if (!progress)
+            break;
+    }
+    return m_phase != Phase::Failed;
+}
+
+// ======================== Рукопожатие ========================
+
+bool RfbDecoder::parseHandshake()
+{
+    // Причина отказа: u32 длина + текст; false — ещё не пришла целиком
+    auto reason = [this](qint64 offset, QString *text) {
+        if (available() < offset + 4)
+            return false;
+        const quint32 length = be32(peek() + offset);
+        if (available() < offset + 4 + length)
+            return false;
+        *text = QString::fromUtf8(reinterpret_cast<const char *>(peek() + offset + 4), int(length));
+        return true;
+    };
+
+    switch (m_phase) {
+    case Phase::Version: {
+        if (available() < 12)
+            return false;
+        const QByteArray version(reinterpret_cast<const char *>(peek()), 12);
+        consume(12);
+        int major = 0;
+        int minor = 0;
+        if (std::sscanf(version.constData(), "RFB %3d.%3d", &major, &minor) != 2 || major != 3)
+            return fail("не сервер RFB: " + QString::fromLatin1(version.trimmed()));
+        m_minorVersion = minor >= 8 ? 8 : (minor == 7 ? 7 : 3);
+        m_out += QByteArray("RFB 003.00") + char('0' + m_minorVersion) + '\n';
+        m_phase = Phase::Security;
+        return true;
+    }
+
+    case Phase::Security: {
+        QString text;
+        if (m_minorVersion == 3) {
+            // 3.3: тип выбирает сервер
+            if (available() < 4)
+                return false;
+            const quint32 type = be32(peek());
+            if (type == 0) {
+                if (!reason(4, &text))
+                    return false;
+                return fail("сервер отказал: " + text);
+            }
+            consume(4);
+            if (type != 1)
+                return fail(QString("сервер требует аутентификацию (тип %1)").arg(type));
+        } else {
+            if (available() < 1)
+                return false;
+            const int count = peek()[0];
+            if (count == 0) {
+                if (!reason(1, &text))
+                    return false;
+                return fail("сервер отказал: " + text);
+            }
+            if (available() < 1 + count)
+                return false;
+            bool none = false;
+            for (int i = 0; i < count; ++i)
+                none = none || peek()[1 + i] == 1;
+            consume(1 + count);
+            if (!none)
+                return fail("сервер требует пароль, поддерживается только вход без аутентификации");
+            write8(1);
+            // В 3.8 сервер ещё подтверждает выбор
+            if (m_minorVersion == 8) {
+                m_phase = Phase::SecurityResult;
+                return true;
+            }
+        }
+        write8(1);  // ClientInit: экран общий с другими клиентами
+        m_phase = Phase::ServerInit;
+        return true;
+    }
+
+    case Phase::SecurityResult: {
+        if (available() < 4)
+            return false;
+        if (be32(peek()) != 0) {
+            QString text;
+            if (!reason(4, &text))
+                return false;
+            return fail("сервер отказал: " + text);
+        }
+        consume(4);
+        write8(1);
+        m_phase = Phase::ServerInit;
+        return true;
+    }
+
+    case Phase::ServerInit: {
+        if (available() < 24)
+            return false;
+        const quint32 nameLength = be32(peek() + 20);
+        if (nameLength > (1u << 16))
+            return fail("ServerInit: слишком длинное имя экрана");
+        if (available() < 24 + qint64(nameLength))
+            return false;
+        m_width = be16(peek());
+        m_height = be16(peek() + 2);
+        m_name = QString::fromUtf8(reinterpret_cast<const char *>(peek() + 24), int(nameLength));
+        consume(24 + nameLength);
+
+        // Формат сервера не важен: просим свой, сервер обязан его соблюдать
+        m_format = m_requestedFormat;
+        m_format.trueColour = true;
+        if (m_format.bitsPerPixel != 8 && m_format.bitsPerPixel != 16 && m_format.bitsPerPixel != 32)
+            return fail(QString("неподдерживаемый формат точек: %1 бит").arg(m_format.bitsPerPixel));
+        write8(0);  // SetPixelFormat
+        write8(0);
+        write16(0);
+        m_out += m_format.encode();
+        write8(2);  // SetEncodings
+        write8(0);
+        write16(quint16(m_encodings.size()));
+        for (qint32 encoding : qAsConst(m_encodings))
+            write32(quint32(encoding));
+
+        setupPixelPath();
+        m_surface->resize(m_width, m_height);
+        m_phase = Phase::Normal;
+        m_step = Step::MessageType;
+        requestUpdate(false);
+        return true;
+    }
+
+    case Phase::Normal:
+    case Phase::Failed:
+        break;
+    }
+    return false;
+}
+
+void RfbDecoder::setupPixelPath()
+{
+    const PixelFormat &f = m_format;
+    m_bytesPerPixel = f.bytesPerPixel();
+    const bool hostOrder = f.bigEndian == (QSysInfo::ByteOrder == QSysInfo::BigEndian);
+    const bool full = f.redMax == 255 && f.greenMax == 255 && f.blueMax == 255;
+    m_path = PixelPath::Generic;
+    if (f.bitsPerPixel == 32 && hostOrder && full && f.greenShift == 8) {
+        if (f.redShift == 16 && f.blueShift == 0)
+            m_path = PixelPath::Native;
+        else if (f.redShift == 0 && f.blueShift == 16)
+            m_path = PixelPath::Swapped;
+    }
+
+    // ZRLE шлёт 3 байта на точку, если цвет целиком в младших или старших трёх
+    m_cpixelBytes = m_bytesPerPixel;
+    m_cpixelShift = 0;
+    if (f.bitsPerPixel == 32 && f.depth <= 24) {
+        const quint32 mask = (quint32(f.redMax) << f.redShift) | (quint32(f.greenMax) << f.greenShift)
+                             | (quint32(f.blueMax) << f.blueShift);
+        if ((mask & 0xff000000u) == 0) {
+            m_cpixelBytes = 3;
+        } else if ((mask & 0xffu) == 0) {
+            m_cpixelBytes = 3;
+            m_cpixelShift = 8;
+        }
+    }
+}
+
+// ======================== Сообщения сервера ========================
+
+bool RfbDecoder::parseMessage()
+{
+    switch (m_step) {
+    case Step::MessageType: {
+        if (available() < 1)
+            return false;
+        const int type = peek()[0];
+        switch (type) {
+        case 0:  // FramebufferUpdate
+            if (available() < 4)
+                return false;
+            m_rectsLeft = be16(peek() + 2);
+            consume(4);
+            if (m_rectsLeft == 0)
+                finishUpdate();
+            else
+                m_step = Step::RectHeader;
+            return true;
+        case 1:  // SetColourMapEntries — при true colour не нужна
+            if (available() < 6)
+                return false;
+            m_skipLeft = quint32(be16(peek() + 4)) * 6;
+            consume(6);
+            m_step = Step::Skip;
+            return true;
+        case 2:  // Bell
+            consume(1);
+            return true;
+        case 3:  // ServerCutText
+            if (available() < 8)
+                return false;
+            m_skipLeft = be32(peek() + 4);
+            consume(8);
+            m_step = Step::Skip;
+            return true;
+        default:
+            return fail(QString("неизвестное сообщение сервера: %1").arg(type));
+        }
+    }
+
+    case Step::RectHeader: {
+        if (available() < 12)
+            return false;
+        const uchar *p = peek();
+        m_rect = QRect(be16(p), be16(p + 2), be16(p + 4), be16(p + 6));
+        m_encoding = qint32(be32(p + 8));
+        consume(12);
+        if (m_encoding == DesktopSize) {
+            m_width = m_rect.width();
+            m_height = m_rect.height();
+            m_surface->resize(m_width, m_height);
+            m_dirty.clear();
+            m_rect = QRect(0, 0, m_width, m_height);
+            finishRect();
+            return true;
+        }
+        if (!m_rect.isEmpty() && !QRect(0, 0, m_width, m_height).contains(m_rect)) {
+            return fail(QString("прямоугольник %1,%2 %3×%4 за пределами экрана %5×%6")
+                            .arg(m_rect.x()).arg(m_rect.y()).arg(m_rect.width()).arg(m_rect.height())
+                            .arg(m_width).arg(m_height));
+        }
+        switch (m_encoding) {
+        case Raw:
+            m_row = 0;
+            if (m_rect.isEmpty())
+                finishRect();  // данных нет
+            else
+                m_step = Step::RawRows;
+            return true;
+        case CopyRect:
+            m_step = Step::CopyRectBody;
+            return true;
+        case Zlib:
+        case Zrle:
+            m_step = Step::CompressedLength;
+            return true;
+        default:
+            return fail(QString("сервер прислал кодировку %1, которую не просили").arg(m_encoding));
+        }
+    }
+
+    case Step::RawRows:
+        return decodeRawRows();
+
+    case Step::CopyRectBody:
+        return decodeCopyRect();
+
+    case Step::CompressedLength:
+        if (available() < 4)
+            return false;
+        m_compressedLength = be32(peek());
+        consume(4);
+        if (m_compressedLength > MaxCompressedBytes)
+            return fail(QString("сжатый прямоугольник %1 байт — слишком большой").arg(m_compressedLength));
+        m_step = Step::CompressedBody;
+        return true;
+
+    case Step::CompressedBody: {
+        if (available() < qint64(m_compressedLength))
+            return false;
+        const bool ok = m_encoding == Zlib ? decodeZlib(peek(), int(m_compressedLength))
+                                           : decodeZrle(peek(), int(m_compressedLength));
+        consume(m_compressedLength);
+        if (!ok)
+            return false;
+        finishRect();
+        return true;
+    }
+
+    case Step::Skip: {
+        const qint64 n = qMin<qint64>(available(), m_skipLeft);
+        consume(n);
+        m_skipLeft -= quint32(n);
+        if (m_skipLeft == 0) {
+            m_step = Step::MessageType;
+            return true;
+        }
+        return n > 0;
+    }
+    }
+    return false;
+}
+
+void RfbDecoder::finishRect()
+{
+    ++m_stats.rects;
+    m_stats.pixels += qint64(m_rect.width()) * m_rect.height();
+    if (!m_rect.isEmpty()) {
+        if (m_dirty.size() >= MaxDirtyRects) {
+            QRect bounds = m_rect;
+            for (const QRect &rect : qAsConst(m_dirty))
+                bounds |= rect;
+            m_dirty = {bounds};
+        } else {
+            m_dirty << m_rect;
+        }
+    }
+    if (--m_rectsLeft > 0)
+        m_step = Step::RectHeader;
+    else
+        finishUpdate();
+}
+
+void RfbDecoder::finishUpdate()
+{
+    ++m_completedUpdates;
+    ++m_stats.updates;
+    m_step = Step::MessageType;
+}
+
+// ======================== Кодировки ========================
+
+// Строки Raw переводятся прямо из входного буфера, как только пришли целиком
+bool RfbDecoder::decodeRawRows()
+{
+    const int rowBytes = m_rect.width() * m_bytesPerPixel;
+    const int left = m_rect.height() - m_row;
+    const int rows = rowBytes > 0 ? int(qMin<qint64>(available() / rowBytes, left)) : left;
+    for (int i = 0; i < rows; ++i, ++m_row) {
+        convertRow(peek(), m_surface->scanLine(m_rect.y() + m_row) + m_rect.x(), m_rect.width());
+        consume(rowBytes);
+    }
+    if (m_row < m_rect.height())
+        return rows > 0;
+    finishRect();
+    return true;
+}
+
+bool RfbDecoder::decodeCopyRect()
+{
+    if (available() < 4)
+        return false;
+    const int sx = be16(peek());
+    const int sy = be16(peek() + 2);
+    consume(4);
+    const QRect source(sx, sy, m_rect.width(), m_rect.height());
+    if (m_rect.isEmpty()) {
+        finishRect();
+        return true;
+    }
+    if (!QRect(0, 0, m_width, m_height).contains(source))
+        return fail("CopyRect: источник за пределами экрана");
+    // Области могут перекрываться: идём от дальнего края
+    const size_t bytes = size_t(m_rect.width()) * 4;
+    if (sy < m_rect.y()) {
+        for (int row = m_rect.height() - 1; row >= 0; --row)
+            std::memmove(m_surface->scanLine(m_rect.y() + row) + m_rect.x(),
+                         m_surface->scanLine(sy + row) + sx, bytes);
+    } else {
+        for (int row = 0; row < m_rect.height(); ++row)
+            std::memmove(m_surface->scanLine(m_rect.y() + row) + m_rect.x(),
+                         m_surface->scanLine(sy + row) + sx, bytes);
+    }
+    finishRect();
+    return true;
+}
+
+int RfbDecoder::inflateAll(z_stream *stream, bool *ready, const uchar *data, int size)
+{
+    if (!*ready) {
+        if (inflateInit(stream) != Z_OK) {
+            fail("zlib: не удалось начать распаковку");
+            return -1;
+        }
+        *ready = true;
+    }
+    if (m_scratch.size() < (1 << 16))
+        m_scratch.resize(1 << 16);
+    stream->next_in = const_cast<Bytef *>(data);
+    stream->avail_in = uInt(size);
+    int produced = 0;
+    for (;;) {
+        if (produced == m_scratch.size())
+            m_scratch.resize(m_scratch.size() * 2);
+        stream->next_out = reinterpret_cast<Bytef *>(m_scratch.data()) + produced;
+        stream->avail_out = uInt(m_scratch.size() - produced);
+        const int rc = inflate(stream, Z_SYNC_FLUSH);
+        produced = m_scratch.size() - int(stream->avail_out);
+        if (rc == Z_BUF_ERROR && stream->avail_in == 0)
+            break;  // всё отдали, zlib просто нечего делать
+        if (rc != Z_OK && rc != Z_STREAM_END) {
+            fail("zlib: " + (stream->msg ? QString::fromLatin1(stream->msg) : QString("данные повреждены")));
+            return -1;
+        }
+        if (stream->avail_in == 0 && stream->avail_out > 0)
+            break;
+    }
+    return produced;
+}
+
+bool RfbDecoder::decodeZlib(const uchar *data, int size)
+{
+    const int rowBytes = m_rect.width() * m_bytesPerPixel;
+    const int produced = inflateAll(&m_zlibStream, &m_zlibReady, data, size);
+    if (produced < 0)
+        return false;
+    if (m_rect.isEmpty())
+        return true;
+    if (produced < rowBytes * m_rect.height())
+        return fail("Zlib: данные прямоугольника оборваны");
+    const uchar *in = reinterpret_cast<const uchar *>(m_scratch.constData());
+    for (int row = 0; row < m_rect.height(); ++row, in += rowBytes)
+        convertRow(in, m_surface->scanLine(m_rect.y() + row) + m_rect.x(), m_rect.width());
+    return true;
+}
+
+bool RfbDecoder::decodeZrle(const uchar *data, int size)
+{
+    const int produced = inflateAll(&m_zrleStream, &m_zrleReady, data, size);
+    if (produced < 0)
+        return false;
+    const uchar *in = reinterpret_cast<const uchar *>(m_scratch.constData());
+    const uchar *end = in + produced;
+    for (int ty = 0; ty < m_rect.height(); ty += ZrleTileSize) {
+        const int th = qMin(ZrleTileSize, m_rect.height() - ty);
+        for (int tx = 0; tx < m_rect.width(); tx += ZrleTileSize) {
+            const int tw = qMin(ZrleTileSize, m_rect.width() - tx);
+            if (!zrleTile(in, end, m_rect.x() + tx, m_rect.y() + ty, tw, th))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Плитка ZRLE: 0 — точки подряд, 1 — один цвет, 2–16 — палитра с упакованными
+// индексами, 128 — серии цветов, 130–255 — серии по палитре
+bool RfbDecoder::zrleTile(const uchar *&in, const uchar *end, int x, int y, int w, int h)
+{
+    auto truncated = [this]() { return fail("ZRLE: данные плитки оборваны"); };
+    auto row = [this, x, y](int r) { return m_surface->scanLine(y + r) + x; };
+    const int cp = m_cpixelBytes;
+
+    if (in >= end)
+        return truncated();
+    const int sub = *in++;
+
+    if (sub == 0) {
+        if (end - in < qint64(w) * h * cp)
+            return truncated();
+        for (int r = 0; r < h; ++r) {
+            quint32 *dst = row(r);
+            if (cp == m_bytesPerPixel) {
+                convertRow(in, dst, w);
+                in += w * cp;
+            } else {
+                for (int c = 0; c < w; ++c, in += cp)
+                    dst[c] = convertPixel(readCPixel(in));
+            }
+        }
+        return true;
+    }
+
+    if (sub == 1) {
+        if (end - in < cp)
+            return truncated();
+        const quint32 colour = convertPixel(readCPixel(in));
+        in += cp;
+        for (int r = 0; r < h; ++r)
+            std::fill_n(row(r), w, colour);
+        return true;
+    }
+
+    if ((sub > 16 && sub < 128) || sub == 129)
+        return fail(QString("ZRLE: неизвестный вид плитки %1").arg(sub));
+
+    quint32 palette[128];
+    const int paletteSize = sub <= 16 ? sub : (sub >= 130 ? sub - 128 : 0);
+    if (end - in < qint64(paletteSize) * cp)
+        return truncated();
+    for (int i = 0; i < paletteSize; ++i, in += cp)
+        palette[i] = convertPixel(readCPixel(in));
+    std::fill(palette + paletteSize, palette + 128, Opaque);
+
+    if (sub <= 16) {
+        const int bits = sub == 2 ? 1 : (sub <= 4 ? 2 : 4);
+        const int rowBytes = (w * bits + 7) / 8;
+        if (end - in < qint64(rowBytes) * h)
+            return truncated();
+        const int mask = (1 << bits) - 1;
+        for (int r = 0; r < h; ++r, in += rowBytes) {
+            quint32 *dst = row(r);
+            for (int c = 0; c < w; ++c) {
+                const int bit = c * bits;
+                dst[c] = palette[(in[bit >> 3] >> (8 - bits - (bit & 7))) & mask];
+            }
+        }
+        return true;
+    }
+
+    // Серии: длина — сумма байтов до первого не-255, плюс один
+    const int total = w * h;
+    int pos = 0;
+    while (pos < total) {
+        quint32 colour;
+        bool hasRun = true;
+        if (sub == 128) {
+            if (end - in < cp)
+                return truncated();
+            colour = convertPixel(readCPixel(in));
+            in += cp;
+        } else {
+            if (in >= end)
+                return truncated();
+            const int index = *in++;
+            colour = palette[index & 127];
+            hasRun = index & 128;
+        }
+        int run = 1;
+        if (hasRun) {
+            int byte;
+            do {
+                if (in >= end)
+                    return truncated();
+                byte = *in++;
+                run += byte;
+            } while (byte == 255);
+        }
+        if (run > total - pos)
+            return fail("ZRLE: серия за пределами плитки");
+        while (run > 0) {
+            const int c = pos % w;
+            const int n = qMin(run, w - c);
+            std::fill_n(row(pos / w) + c, n, colour);
+            pos += n;
+            run -= n;
+        }
+    }
+    return true;
+}
+
+// ======================== Точки ========================
+
+void RfbDecoder::convertRow(const uchar *src, quint32 *dst, int count) const
+{
+    switch (m_path) {
+    case PixelPath::Native:
+        convertNative(src, dst, count);
+        return;
+    case PixelPath::Swapped:
+        convertSwapped(src, dst, count);
+        return;
+    case PixelPath::Generic:
+        for (int i = 0; i < count; ++i, src += m_bytesPerPixel)
+            dst[i] = convertPixel(readPixel(src));
+        return;
+    }
+}
+
+quint32 RfbDecoder::convertPixel(quint32 value) const
+{
+    if (m_path == PixelPath::Native)
+        return value | Opaque;
+    const PixelFormat &f = m_format;
+    return Opaque | (scaleChannel(value, f.redShift, f.redMax) << 16)
+           | (scaleChannel(value, f.greenShift, f.greenMax) << 8) | scaleChannel(value, f.blueShift, f.blueMax);
+}
+
+quint32 RfbDecoder::readPixel(const uchar *src) const
+{
+    switch (m_bytesPerPixel) {
+    case 1:
+        return src[0];
+    case 2:
+        return m_format.bigEndian ? qFromBigEndian<quint16>(src) : qFromLittleEndian<quint16>(src);
+    default:
+        return m_format.bigEndian ? qFromBigEndian<quint32>(src) : qFromLittleEndian<quint32>(src);
+    }
+}
+
+quint32 RfbDecoder::readCPixel(const uchar *src) const
+{
+    if (m_cpixelBytes != 3)
+        return readPixel(src);
+    const quint32 value = m_format.bigEndian ? (quint32(src[0]) << 16 | quint32(src[1]) << 8 | src[2])
+                                             : (quint32(src[0]) | quint32(src[1]) << 8 | quint32(src[2]) << 16);
+    return value << m_cpixelShift;
+}
+
+// ======================== Сообщения клиента ========================
+
+void RfbDecoder::requestUpdate(bool incremental)
+{
+    requestUpdate(QRect(0, 0, m_width, m_height), incremental);
+}
+
+void RfbDecoder::requestUpdate(const QRect &rect, bool incremental)
+{
+    if (!isReady())
+        return;
+    write8(3);
+    write8(incremental ? 1 : 0);
+    write16(quint16(rect.x()));
+    write16(quint16(rect.y()));
+    write16(quint16(rect.width()));
+    write16(quint16(rect.height()));
+}
+
+void RfbDecoder::pointerEvent(int x, int y, int buttons)
+{
+    if (!isReady())
+        return;
+    write8(5);
+    write8(quint8(buttons));
+    write16(quint16(qBound(0, x, qMax(0, m_width - 1))));
+    write16(quint16(qBound(0, y, qMax(0, m_height - 1))));
+}
+
+void RfbDecoder::keyEvent(quint32 keysym, bool down)
+{
+    if (!isReady())
+        return;
+    write8(4);
+    write8(down ? 1 : 0);
+    write16(0);
+    write32(keysym);
+}
+
+void RfbDecoder::write8(quint8 value)
+{
+    m_out.append(char(value));
+}
+
+void RfbDecoder::write16(quint16 value)
+{
+    uchar bytes[2];
+    qToBigEndian(value, bytes);
+    m_out.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+void RfbDecoder::write32(quint32 value)
+{
+    uchar bytes[4];
+    qToBigEndian(value, bytes);
+    m_out.append(reinterpret_cast<const char *>(bytes), 4);
+}
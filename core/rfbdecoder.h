@@ -0,0 +1,202 @@
+#ifndef RFBDECODER_H
+#define RFBDECODER_H
+
+#include <QByteArray>
+#include <QRect>
+#include <QString>
+#include <QVector>
+#include <zlib.h>
+
+// Куда RfbDecoder рисует экран гостя: 32 бита на точку, 0xffRRGGBB —
+// раскладка QImage::Format_RGB32, строки можно отдавать прямо из QImage
+class RfbSurface
+{
+public:
+    virtual ~RfbSurface() = default;
+    // Новый размер экрана; содержимое можно не сохранять
+    virtual void resize(int width, int height) = 0;
+    virtual quint32 *scanLine(int y) = 0;
+};
+
+// Клиентская сторона RFB 3.3/3.7/3.8 (RFC 6143) без ввода-вывода: байты
+// от сервера — в feed(), ответы серверу — из takeOutput(). Сокет, поток
+// и блокировку экрана выбирает вызывающий (RfbClient в GUI, bench).
+//
+// Безопасность — только None: bhyve fbuf без password= другой не знает.
+// Сразу после ServerInit уходит SetPixelFormat с раскладкой 0xRRGGBB в
+// 32 битах little-endian — она же родная для bhyve и QImage::Format_RGB32,
+// так что строка Raw превращается в строку QImage одним OR альфа-байта
+// (SSE2 по 4 точки). Другие форматы (setPixelFormat()) переводятся
+// через сдвиги и маски: 0xBBGGRR — тоже SSE2, остальное — по точке.
+//
+// Кодировки: Raw (строки разбираются по мере прихода, весь прямоугольник
+// не буферизуется), CopyRect, Zlib (ею отвечает bhyve), ZRLE и
+// псевдокодировка DesktopSize. Потоки zlib живут всё соединение, как
+// того требует протокол.
+class RfbDecoder
+{
+public:
+    enum class Phase {
+        Version,
+        Security,
+        SecurityResult,
+        ServerInit,
+        Normal,
+        Failed
+    };
+
+    enum Encoding : qint32 {
+        Raw = 0,
+        CopyRect = 1,
+        Zlib = 6,
+        Zrle = 16,
+        DesktopSize = -223
+    };
+
+    struct PixelFormat {
+        int bitsPerPixel = 32;
+        int depth = 24;
+        bool bigEndian = false;
+        bool trueColour = true;
+        int redMax = 255;
+        int greenMax = 255;
+        int blueMax = 255;
+        int redShift = 16;
+        int greenShift = 8;
+        int blueShift = 0;
+
+        // 0xRRGGBB в 32 битах little-endian
+        static PixelFormat native() { return PixelFormat(); }
+        QByteArray encode() const;  // 16 байт PIXEL_FORMAT
+        static PixelFormat decode(const char *data);
+        int bytesPerPixel() const { return bitsPerPixel / 8; }
+    };
+
+    struct Stats {
+        qint64 bytesIn = 0;
+        qint64 updates = 0;   // законченных FramebufferUpdate
+        qint64 rects = 0;
+        qint64 pixels = 0;
+        qint64 decodeNs = 0;  // время внутри feed()
+    };
+
+    explicit RfbDecoder(RfbSurface *surface);
+    ~RfbDecoder();
+
+    RfbDecoder(const RfbDecoder &) = delete;
+    RfbDecoder &operator=(const RfbDecoder &) = delete;
+
+    // До рукопожатия: какой формат точек и кодировки просить у сервера
+    void setPixelFormat(const PixelFormat &format) { m_requestedFormat = format; }
+    void setEncodings(const QVector<qint32> &encodings) { m_encodings = encodings; }
+    static QVector<qint32> defaultEncodings();
+
+    // false — сервер отказал или нарушил протокол, причина в error()
+    bool feed(const char *data, qint64 size);
+    QByteArray takeOutput();
+
+    // Запросы серверу; до фазы Normal игнорируются
+    void requestUpdate(bool incremental);
+    void requestUpdate(const QRect &rect, bool incremental);
+    void pointerEvent(int x, int y, int buttons);
+    void keyEvent(quint32 keysym, bool down);
+
+    // Законченные с прошлого вызова FramebufferUpdate и где менялся экран
+    int takeCompletedUpdates();
+    QVector<QRect> takeDirtyRects();
+
+    Phase phase() const { return m_phase; }
+    bool isReady() const { return m_phase == Phase::Normal; }
+    QString error() const { return m_error; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    QString desktopName() const { return m_name; }
+    const PixelFormat &pixelFormat() const { return m_format; }
+    const Stats &stats() const { return m_stats; }
+
+private:
+    enum class Step {
+        MessageType,
+        RectHeader,
+        RawRows,
+        CopyRectBody,
+        CompressedLength,
+        CompressedBody,
+        Skip  // SetColourMapEntries, ServerCutText — не нужны
+    };
+
+    bool parse();
+    bool parseHandshake();
+    bool parseMessage();
+    bool fail(const QString &error);
+    void setupPixelPath();
+    void finishRect();
+    void finishUpdate();
+    bool decodeRawRows();
+    bool decodeCopyRect();
+    bool decodeZlib(const uchar *data, int size);
+    bool decodeZrle(const uchar *data, int size);
+    // Распаковывает в m_scratch; -1 — ошибка zlib
+    int inflateAll(z_stream *stream, bool *ready, const uchar *data, int size);
+    bool zrleTile(const uchar *&in, const uchar *end, int x, int y, int w, int h);
+
+    // Перевод точек сервера в 0xffRRGGBB
+    void convertRow(const uchar *src, quint32 *dst, int count) const;
+    quint32 convertPixel(quint32 value) const;
+    quint32 readPixel(const uchar *src) const;
+    quint32 readCPixel(const uchar *src) const;
+
+    qint64 available() const { return m_in.size() - m_pos; }
+    const uchar *peek() const { return reinterpret_cast<const uchar *>(m_in.constData()) + m_pos; }
+    void consume(qint64 n) { m_pos += n; }
+    void write8(quint8 value);
+    void write16(quint16 value);
+    void write32(quint32 value);
+
+    RfbSurface *m_surface;
+    PixelFormat m_requestedFormat;
+    QVector<qint32> m_encodings;
+
+    QByteArray m_in;
+    qint64 m_pos = 0;
+    QByteArray m_out;
+
+    Phase m_phase = Phase::Version;
+    Step m_step = Step::MessageType;
+    int m_minorVersion = 8;
+    QString m_error;
+    QString m_name;
+    int m_width = 0;
+    int m_height = 0;
+    PixelFormat m_format;
+
+    enum class PixelPath {
+        Native,   // 0xRRGGBB как у хоста — OR альфы
+        Swapped,  // 0xBBGGRR — перестановка байтов
+        Generic
+    };
+    PixelPath m_path = PixelPath::Native;
+    int m_bytesPerPixel = 4;
+    int m_cpixelBytes = 4;
+    int m_cpixelShift = 0;  // 3-байтный CPIXEL — старшие байты значения
+
+    // Текущий FramebufferUpdate и прямоугольник
+    int m_rectsLeft = 0;
+    QRect m_rect;
+    qint32 m_encoding = Raw;
+    int m_row = 0;
+    quint32 m_compressedLength = 0;
+    quint32 m_skipLeft = 0;
+
+    z_stream m_zlibStream;
+    z_stream m_zrleStream;
+    bool m_zlibReady = false;
+    bool m_zrleReady = false;
+    QByteArray m_scratch;  // распакованные данные Zlib/ZRLE, память переиспользуется
+
+    int m_completedUpdates = 0;
+    QVector<QRect> m_dirty;
+    Stats m_stats;
+};
+
+#endif // RFBDECODER_H
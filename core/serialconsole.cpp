@@ -0,0 +1,288 @@
+#include "serialconsole.h"
+
+#include <QFile>
+#include <QSocketNotifier>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+// Сырой режим: ни эха, ни перевода строк, ни сигналов — всё решает гость.
+// CLOCAL — nmdm без второй стороны не должен «вешать трубку»
+bool makeRaw(int fd)
+{
+    termios tio;
+    if (::tcgetattr(fd, &tio) != 0)
+        return false;
+    ::cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    return ::tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+void setNonBlocking(int fd)
+{
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+QString errnoString()
+{
+    return QString::fromLocal8Bit(std::strerror(errno));
+}
+
+} // namespace
+
+SerialConsole::Backend SerialConsole::defaultBackend()
+{
+#if defined(Q_OS_FREEBSD)
+    return Backend::Nmdm;
+#else
+    return Backend::Pty;
+#endif
+}
+
+QString SerialConsole::backendName(Backend backend)
+{
+    return backend == Backend::Nmdm ? "nmdm" : "pty";
+}
+
+bool SerialConsole::parseBackend(const QString &name, Backend *backend)
+{
+    const QString key = name.trimmed().toLower();
+    if (key == "nmdm")
+        *backend = Backend::Nmdm;
+    else if (key == "pty")
+        *backend = Backend::Pty;
+    else
+        return false;
+    return true;
+}
+
+QString SerialConsole::nmdmDevice(const QString &vmName, char side)
+{
+    return QString("/dev/nmdm-%1-com1%2").arg(vmName).arg(QLatin1Char(side));
+}
+
+SerialConsole::SerialConsole(QObject *parent)
+    : QObject(parent)
+{
+}
+
+SerialConsole::~SerialConsole()
+{
+    // Без дочитывания и сигналов: объект уходит вместе с ВМ
+    delete m_readNotifier;
+    delete m_writeNotifier;
+    if (m_fd >= 0)
+        ::close(m_fd);
+    if (m_slaveFd >= 0)
+        ::close(m_slaveFd);
+}
+
+// ======================== Открытие ========================
+bool SerialConsole::open(Backend backend, const QString &vmName, QString *error)
+{
+    close();
+    m_history.clear();
+    m_historyBytes = 0;
+    m_backend = backend;
+
+    if (backend == Backend::Nmdm) {
+        // Пара создаётся при первом открытии любой из сторон
+        if (!openHostSide(nmdmDevice(vmName, 'B'), error))
+            return false;
+        m_guestDevice = nmdmDevice(vmName, 'A');
+        watch();
+        return true;
+    }
+
+    const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0) {
+        *error = "posix_openpt: " + errnoString();
+        return false;
+    }
+    const char *slaveName = (::grantpt(master) == 0 && ::unlockpt(master) == 0) ? ::ptsname(master) : nullptr;
+    const int slave = slaveName ? ::open(slaveName, O_RDWR | O_NOCTTY) : -1;
+    if (slave < 0) {
+        *error = "псевдотерминал: " + errnoString();
+        ::close(master);
+        return false;
+    }
+    // До того как гость откроет slave, эхо драйвера терминала вернуло бы нам наш же ввод
+    makeRaw(slave);
+    setNonBlocking(master);
+    ::fcntl(slave, F_SETFD, FD_CLOEXEC);
+    m_fd = master;
+    m_slaveFd = slave;
+    m_guestDevice = QString::fromLocal8Bit(slaveName);
+    watch();
+    return true;
+}
+
+bool SerialConsole::attach(const QString &guestDevice, QString *error)
+{
+    close();
+    if (!guestDevice.startsWith("/dev/nmdm") || !guestDevice.endsWith('A')) {
+        *error = guestDevice + ": подхватить можно только nmdm — псевдотерминал ушёл вместе с прошлым vmrun";
+        return false;
+    }
+    m_backend = Backend::Nmdm;
+    if (!openHostSide(guestDevice.left(guestDevice.size() - 1) + 'B', error))
+        return false;
+    m_guestDevice = guestDevice;
+    watch();
+    return true;
+}
+
+bool SerialConsole::openHostSide(const QString &path, QString *error)
+{
+    const int fd = ::open(QFile::encodeName(path).constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        const int code = errno;
+        *error = path + ": " + errnoString();
+        if (code == ENOENT)
+            *error += " (kldload nmdm)";
+        else if (code == EACCES)
+            *error += " (нужно правило devfs для nmdm*)";
+        return false;
+    }
+    makeRaw(fd);
+    m_fd = fd;
+    return true;
+}
+
+void SerialConsole::watch()
+{
+    m_readNotifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_readNotifier, &QSocketNotifier::activated, this, [this]() { drain(MaxReadsPerWakeup); });
+    m_writeNotifier = new QSocketNotifier(m_fd, QSocketNotifier::Write, this);
+    m_writeNotifier->setEnabled(false);
+    connect(m_writeNotifier, &QSocketNotifier::activated, this, &SerialConsole::flushPending);
+    emit opened();
+}
+
+void SerialConsole::close()
+{
+    if (m_fd < 0)
+        return;
+    // То, что гость успел написать перед выходом, — ещё зрителям и в лог
+    drain(MaxReadsPerWakeup);
+    if (m_fd < 0)
+        return;  // закрыли из обработчика received()
+    delete m_readNotifier;
+    m_readNotifier = nullptr;
+    delete m_writeNotifier;
+    m_writeNotifier = nullptr;
+    ::close(m_fd);
+    m_fd = -1;
+    if (m_slaveFd >= 0)
+        ::close(m_slaveFd);
+    m_slaveFd = -1;
+    m_pending.clear();
+    emit closed();
+}
+
+// ======================== Чтение и запись ========================
+void SerialConsole::drain(int maxReads)
+{
+    for (int i = 0; i < maxReads && m_fd >= 0; ++i) {
+        const ssize_t n = ::read(m_fd, m_readBuffer, sizeof(m_readBuffer));
+        if (n > 0) {
+            const QByteArray chunk(m_readBuffer, int(n));
+            m_received += quint64(n);
+            appendHistory(chunk);
+            emit received(chunk);
+            if (n < ssize_t(sizeof(m_readBuffer)))
+                return;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        // 0 или EIO — второй стороны больше нет; уведомитель иначе будет срабатывать вечно
+        if (m_readNotifier)
+            m_readNotifier->setEnabled(false);
+        return;
+    }
+}
+
+bool SerialConsole::write(const QByteArray &data)
+{
+    if (m_fd < 0)
+        return false;
+    if (!m_pending.isEmpty()) {
+        if (m_pending.size() + data.size() > MaxPendingBytes)
+            return false;
+        m_pending += data;
+        return true;
+    }
+    qint64 written = 0;
+    while (written < data.size()) {
+        const ssize_t n = ::write(m_fd, data.constData() + written, size_t(data.size() - written));
+        if (n > 0) {
+            written += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            return false;
+        break;
+    }
+    m_sent += quint64(written);
+    if (written < data.size()) {
+        // Гость не читает — остаток уйдёт, когда в устройстве освободится место
+        m_pending = data.mid(int(written));
+        m_writeNotifier->setEnabled(true);
+    }
+    return true;
+}
+
+void SerialConsole::flushPending()
+{
+    while (!m_pending.isEmpty()) {
+        const ssize_t n = ::write(m_fd, m_pending.constData(), size_t(m_pending.size()));
+        if (n > 0) {
+            m_sent += quint64(n);
+            m_pending.remove(0, int(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;  // ждём следующей готовности
+        m_pending.clear();  // устройство сломалось — гостю это уже не доставить
+    }
+    m_writeNotifier->setEnabled(false);
+}
+
+// ======================== История ========================
+void SerialConsole::appendHistory(const QByteArray &chunk)
+{
+    if (!m_history.empty() && m_history.back().size() + chunk.size() <= HistoryChunkBytes)
+        m_history.back() += chunk;
+    else
+        m_history.push_back(chunk);
+    m_historyBytes += chunk.size();
+    while (m_history.size() > 1 && m_historyBytes - m_history.front().size() >= HistoryBytes) {
+        m_historyBytes -= m_history.front().size();
+        m_history.pop_front();
+    }
+}
+
+QByteArray SerialConsole::history() const
+{
+    QByteArray out;
+    out.reserve(int(m_historyBytes));
+    for (const QByteArray &chunk : m_history)
+        out += chunk;
+    return out;
+}
@@ -0,0 +1,95 @@
+#ifndef SERIALCONSOLE_H
+#define SERIALCONSOLE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <deque>
+
+class QSocketNotifier;
+
+// Наша сторона com1 гостя. bhyve получает "-l com1,<guestDevice()>", vmrun
+// читает и пишет другой конец пары:
+//   Nmdm — /dev/nmdm-<имя>-com1A гостю, ...B нам (FreeBSD). Пара живёт в
+//          ядре отдельно от vmrun: после перезапуска окна attach() снова
+//          открывает B. Без root нужно правило devfs для nmdm*.
+//   Pty  — псевдотерминал: slave гостю, master нам. Подхватить нельзя —
+//          master умирает вместе с vmrun; годится для Linux и заглушек.
+//
+// Чтение — по QSocketNotifier прямо из цикла событий, без таймеров: байт
+// гостя уходит зрителям в тот же проход. Каждый прочитанный кусок — один
+// QByteArray: received() отдаёт его всем подписчикам (терминалы, лог ВМ,
+// API) без копий, он же ложится в историю. Запись — сразу в устройство;
+// не влезло — хвост ждёт готовности на запись.
+class SerialConsole : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Backend {
+        Nmdm,
+        Pty
+    };
+
+    static constexpr int ReadChunkBytes = 16 * 1024;
+    static constexpr int MaxReadsPerWakeup = 16;  // дальше — следующий проход цикла событий
+    static constexpr qint64 HistoryBytes = 256 * 1024;
+    static constexpr int HistoryChunkBytes = 4096;  // мелкие куски (эхо по байту) склеиваются
+    static constexpr int MaxPendingBytes = 1024 * 1024;
+
+    // FreeBSD — nmdm, остальное — pty
+    static Backend defaultBackend();
+    static QString backendName(Backend backend);
+    static bool parseBackend(const QString &name, Backend *backend);
+    // side — 'A' (гостю) или 'B' (нам)
+    static QString nmdmDevice(const QString &vmName, char side);
+
+    explicit SerialConsole(QObject *parent = nullptr);
+    ~SerialConsole() override;
+
+    // Открыть нашу сторону перед запуском bhyve; история очищается
+    bool open(Backend backend, const QString &vmName, QString *error);
+    // Подхват гостя: открыть нашу сторону по его устройству (только nmdm)
+    bool attach(const QString &guestDevice, QString *error);
+    // Дочитывает то, что уже пришло, и закрывает; история остаётся
+    void close();
+
+    bool isOpen() const { return m_fd >= 0; }
+    Backend backend() const { return m_backend; }
+    QString guestDevice() const { return m_guestDevice; }
+
+    // Байты гостю; false — консоль закрыта или очередь переполнена
+    bool write(const QByteArray &data);
+
+    // Последние HistoryBytes вывода — новому зрителю, чтобы восстановить экран
+    QByteArray history() const;
+    quint64 bytesReceived() const { return m_received; }
+    quint64 bytesSent() const { return m_sent; }
+
+signals:
+    void received(const QByteArray &data);
+    void opened();
+    void closed();
+
+private:
+    bool openHostSide(const QString &path, QString *error);
+    void watch();
+    void drain(int maxReads);
+    void flushPending();
+    void appendHistory(const QByteArray &chunk);
+
+    Backend m_backend = Backend::Pty;
+    int m_fd = -1;
+    int m_slaveFd = -1;  // pty: свой slave, иначе master без гостя сыплет EIO
+    QString m_guestDevice;
+    QSocketNotifier *m_readNotifier = nullptr;
+    QSocketNotifier *m_writeNotifier = nullptr;
+    QByteArray m_pending;
+    char m_readBuffer[ReadChunkBytes];
+    std::deque<QByteArray> m_history;
+    qint64 m_historyBytes = 0;
+    quint64 m_received = 0;
+    quint64 m_sent = 0;
+};
+
+#endif // SERIALCONSOLE_H
@@ -0,0 +1,757 @@
+#include "terminalscreen.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr int TabWidth = 8;
+constexpr int MaxParams = 32;
+constexpr int MaxParamValue = 9999;
+
+// DEC Special Graphics: '`'..'~' → рамки и символы (ESC ( 0)
+const quint32 DecGraphics[] = {
+    0x25c6, 0x2592, 0x2409, 0x240c, 0x240d, 0x240a, 0x00b0, 0x00b1,  // ` a b c d e f g
+    0x2424, 0x240b, 0x2518, 0x2510, 0x250c, 0x2514, 0x253c, 0x23ba,  // h i j k l m n o
+    0x23bb, 0x2500, 0x23bc, 0x23bd, 0x251c, 0x2524, 0x2534, 0x252c,  // p q r s t u v w
+    0x2502, 0x2264, 0x2265, 0x03c0, 0x2260, 0x00a3, 0x00b7,          // x y z { | } ~
+};
+
+const quint32 AnsiPalette[16] = {
+    0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+    0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff,
+};
+
+// Уровень компоненты куба 6×6×6, ближайший к value
+int cubeLevel(int value)
+{
+    if (value < 48)
+        return 0;
+    if (value < 115)
+        return 1;
+    return qMin(5, (value - 35) / 40);
+}
+
+} // namespace
+
+bool TerminalScreen::Damage::isEmpty() const
+{
+    if (scrolledLines > 0)
+        return false;
+    for (const Span &span : rows) {
+        if (!span.isEmpty())
+            return false;
+    }
+    return true;
+}
+
+TerminalScreen::TerminalScreen(int columns, int rows)
+    : m_columns(qMax(1, columns))
+    , m_rows(qMax(1, rows))
+{
+    m_lines = QVector<QVector<TerminalCell>>(m_rows, QVector<TerminalCell>(m_columns));
+    m_scrollBottom = m_rows - 1;
+    m_dirty.resize(m_rows);
+    markAllDirty();
+}
+
+quint32 TerminalScreen::paletteColor(int index)
+{
+    index = qBound(0, index, 255);
+    if (index < 16)
+        return AnsiPalette[index];
+    if (index < 232) {
+        static const int levels[] = {0, 95, 135, 175, 215, 255};
+        const int cube = index - 16;
+        return quint32(levels[cube / 36] << 16 | levels[cube / 6 % 6] << 8 | levels[cube % 6]);
+    }
+    const int gray = 8 + (index - 232) * 10;
+    return quint32(gray << 16 | gray << 8 | gray);
+}
+
+// ======================== Размер и сброс ========================
+void TerminalScreen::resize(int columns, int rows)
+{
+    columns = qMax(1, columns);
+    rows = qMax(1, rows);
+    if (columns == m_columns && rows == m_rows)
+        return;
+
+    // Курсор не должен уйти за нижний край — лишнее уезжает в историю
+    if (m_cursorRow >= rows) {
+        const int excess = m_cursorRow - rows + 1;
+        scrollUp(0, m_rows - 1, excess);
+        m_cursorRow -= excess;
+    }
+    for (QVector<QVector<TerminalCell>> *lines : {&m_lines, &m_savedLines}) {
+        if (lines->isEmpty())
+            continue;
+        lines->resize(rows);
+        for (QVector<TerminalCell> &line : *lines)
+            line.resize(columns);
+    }
+    m_columns = columns;
+    m_rows = rows;
+    m_scrollTop = 0;
+    m_scrollBottom = rows - 1;
+    m_cursorRow = qMin(m_cursorRow, rows - 1);
+    m_cursorColumn = qMin(m_cursorColumn, columns - 1);
+    m_wrapPending = false;
+    m_dirty.resize(rows);
+    m_scrolled = 0;
+    markAllDirty();
+}
+
+void TerminalScreen::reset()
+{
+    m_lines = QVector<QVector<TerminalCell>>(m_rows, QVector<TerminalCell>(m_columns));
+    m_savedLines.clear();
+    m_cursorRow = m_cursorColumn = 0;
+    m_wrapPending = false;
+    m_cursorVisible = true;
+    m_autoWrap = true;
+    m_insertMode = false;
+    m_appCursorKeys = false;
+    m_altScreen = false;
+    m_graphics = false;
+    m_scrollTop = 0;
+    m_scrollBottom = m_rows - 1;
+    m_pen = TerminalCell();
+    m_saved = SavedCursor();
+    m_state = State::Ground;
+    m_utf8Pending = 0;
+    m_scrolled = 0;
+    markAllDirty();
+}
+
+// ======================== Разбор ========================
+void TerminalScreen::feed(const char *data, int size)
+{
+    m_stats.bytes += size;
+    for (int i = 0; i < size; ++i) {
+        const uchar c = uchar(data[i]);
+        switch (m_state) {
+        case State::Ground:
+            if (m_utf8Pending > 0) {
+                if ((c & 0xc0) == 0x80) {
+                    m_utf8 = (m_utf8 << 6) | (c & 0x3f);
+                    if (--m_utf8Pending == 0)
+                        print(m_utf8);
+                    continue;
+                }
+                m_utf8Pending = 0;
+                print(0xfffd);  // оборванная последовательность; байт разбираем заново
+            }
+            if (c >= 0x20 && c < 0x7f) {
+                print(c);
+            } else if (c < 0x20) {
+                execute(c);
+            } else if (c >= 0xc2 && c <= 0xf4) {
+                m_utf8Pending = c >= 0xf0 ? 3 : (c >= 0xe0 ? 2 : 1);
+                m_utf8 = c & (0x3f >> m_utf8Pending);
+            } else if (c != 0x7f) {
+                print(0xfffd);
+            }
+            break;
+        case State::Escape:
+            escape(c);
+            break;
+        case State::Charset:
+            // Нас интересует только G0: "0" — графика, остальное — ASCII
+            if (m_intermediate == '(')
+                m_graphics = c == '0';
+            m_state = State::Ground;
+            break;
+        case State::Csi:
+            if (c >= '0' && c <= '9') {
+                if (m_params.isEmpty())
+                    m_params.append(0);
+                int &value = m_params.last();
+                value = qMin(MaxParamValue, value * 10 + (c - '0'));
+            } else if (c == ';' || c == ':') {
+                if (m_params.isEmpty())
+                    m_params.append(0);
+                if (m_params.size() < MaxParams)
+                    m_params.append(0);
+            } else if (c >= '<' && c <= '?' && m_params.isEmpty()) {
+                m_private = char(c);
+            } else if (c >= 0x20 && c <= 0x2f) {
+                m_intermediate = char(c);
+            } else if (c >= 0x40 && c <= 0x7e) {
+                ++m_stats.sequences;
+                dispatchCsi(c);
+                m_state = State::Ground;
+            } else if (c == 0x1b) {
+                m_state = State::Escape;
+            } else if (c < 0x20) {
+                execute(c);  // управляющие символы внутри CSI выполняются сразу
+            }
+            break;
+        case State::String:
+            if (c == 0x07) {
+                finishString();
+            } else if (c == 0x1b) {
+                m_state = State::StringEscape;
+            } else if (m_string.size() < MaxTitleLength) {
+                m_string.append(char(c));
+            }
+            break;
+        case State::StringEscape:
+            finishString();
+            if (c != '\\')
+                escape(c);
+            break;
+        }
+    }
+}
+
+void TerminalScreen::execute(uchar c)
+{
+    switch (c) {
+    case '\b':
+        if (m_cursorColumn > 0)
+            moveCursor(m_cursorRow, m_cursorColumn - 1);
+        break;
+    case '\t':
+        moveCursor(m_cursorRow, qMin(m_columns - 1, (m_cursorColumn / TabWidth + 1) * TabWidth));
+        break;
+    case '\n':
+    case '\v':
+    case '\f':
+        lineFeed();
+        break;
+    case '\r':
+        moveCursor(m_cursorRow, 0);
+        break;
+    case 0x0e:  // SO/SI: G1/G0 — графику выбирают через ESC ( 0
+    case 0x0f:
+        break;
+    case 0x1b:
+        m_state = State::Escape;
+        break;
+    default:
+        break;  // BEL и прочее — без последствий для экрана
+    }
+}
+
+void TerminalScreen::escape(uchar c)
+{
+    m_state = State::Ground;
+    ++m_stats.sequences;
+    switch (c) {
+    case '[':
+        m_state = State::Csi;
+        m_params.clear();
+        m_private = 0;
+        m_intermediate = 0;
+        break;
+    case ']':
+    case 'P':
+    case '_':
+    case '^':
+        m_state = State::String;
+        m_string.clear();
+        m_intermediate = char(c);
+        break;
+    case '(':
+    case ')':
+    case '*':
+    case '+':
+        m_state = State::Charset;
+        m_intermediate = char(c);
+        break;
+    case '7':
+        m_saved = {m_cursorRow, m_cursorColumn, m_pen, m_graphics};
+        break;
+    case '8':
+        moveCursor(m_saved.row, m_saved.column);
+        m_pen = m_saved.pen;
+        m_graphics = m_saved.graphics;
+        break;
+    case 'D':
+        lineFeed();
+        break;
+    case 'E':
+        lineFeed();
+        moveCursor(m_cursorRow, 0);
+        break;
+    case 'M':
+        reverseIndex();
+        break;
+    case 'c':
+        reset();
+        break;
+    case 0x1b:
+        m_state = State::Escape;
+        break;
+    default:
+        break;  // ESC = / ESC > (режим цифровой клавиатуры), ESC # ... — не нужны
+    }
+}
+
+void TerminalScreen::finishString()
+{
+    m_state = State::Ground;
+    ++m_stats.sequences;
+    // OSC 0/2 — заголовок окна
+    if (m_intermediate == ']' && (m_string.startsWith("0;") || m_string.startsWith("2;")))
+        m_title = QString::fromUtf8(m_string.mid(2));
+    m_string.clear();
+}
+
+int TerminalScreen::param(int index, int defaultValue) const
+{
+    const int value = index < m_params.size() ? m_params[index] : 0;
+    return value > 0 ? value : defaultValue;
+}
+
+void TerminalScreen::dispatchCsi(uchar final)
+{
+    const int n = param(0, 1);
+    if (m_private == '?' && final != 'h' && final != 'l')
+        return;  // DECSED, DECSEL и прочие частные — как обычные не толкуем
+
+    switch (final) {
+    case '@':
+        insertCells(n);
+        break;
+    case 'A':
+        moveCursor(qMax(m_cursorRow >= m_scrollTop ? m_scrollTop : 0, m_cursorRow - n), m_cursorColumn);
+        break;
+    case 'B':
+    case 'e':
+        moveCursor(qMin(m_cursorRow <= m_scrollBottom ? m_scrollBottom : m_rows - 1, m_cursorRow + n), m_cursorColumn);
+        break;
+    case 'C':
+    case 'a':
+        moveCursor(m_cursorRow, m_cursorColumn + n);
+        break;
+    case 'D':
+        moveCursor(m_cursorRow, m_cursorColumn - n);
+        break;
+    case 'E':
+        moveCursor(m_cursorRow + n, 0);
+        break;
+    case 'F':
+        moveCursor(m_cursorRow - n, 0);
+        break;
+    case 'G':
+    case '`':
+        moveCursor(m_cursorRow, n - 1);
+        break;
+    case 'H':
+    case 'f':
+        moveCursor(param(0, 1) - 1, param(1, 1) - 1);
+        break;
+    case 'I':
+        for (int i = 0; i < n; ++i)
+            execute('\t');
+        break;
+    case 'Z':
+        moveCursor(m_cursorRow, qMax(0, ((m_cursorColumn - 1) / TabWidth - (n - 1)) * TabWidth));
+        break;
+    case 'J': {
+        const int mode = param(0, 0);
+        if (mode == 0) {
+            eraseCells(m_cursorRow, m_cursorColumn, m_columns);
+            eraseLines(m_cursorRow + 1, m_rows);
+        } else if (mode == 1) {
+            eraseLines(0, m_cursorRow);
+            eraseCells(m_cursorRow, 0, m_cursorColumn + 1);
+        } else if (mode == 2) {
+            eraseLines(0, m_rows);
+        } else if (mode == 3) {
+            m_scrollback.clear();
+        }
+        break;
+    }
+    case 'K': {
+        const int mode = param(0, 0);
+        if (mode == 0)
+            eraseCells(m_cursorRow, m_cursorColumn, m_columns);
+        else if (mode == 1)
+            eraseCells(m_cursorRow, 0, m_cursorColumn + 1);
+        else if (mode == 2)
+            eraseCells(m_cursorRow, 0, m_columns);
+        break;
+    }
+    case 'L':
+        if (m_cursorRow >= m_scrollTop && m_cursorRow <= m_scrollBottom)
+            scrollDown(m_cursorRow, m_scrollBottom, n);
+        break;
+    case 'M':
+        if (m_cursorRow >= m_scrollTop && m_cursorRow <= m_scrollBottom)
+            scrollUp(m_cursorRow, m_scrollBottom, n);
+        break;
+    case 'P':
+        deleteCells(n);
+        break;
+    case 'S':
+        scrollUp(m_scrollTop, m_scrollBottom, n);
+        break;
+    case 'T':
+        scrollDown(m_scrollTop, m_scrollBottom, n);
+        break;
+    case 'X':
+        eraseCells(m_cursorRow, m_cursorColumn, qMin(m_columns, m_cursorColumn + n));
+        break;
+    case 'b':
+        for (int i = 0; i < qMin(n, m_columns * m_rows); ++i)
+            print(m_lastPrinted);
+        break;
+    case 'c':
+        // Device Attributes: VT102 или «ничего особенного» для вторичного запроса
+        if (param(0, 0) == 0)
+            m_replies += m_private == '>' ? QByteArray("\x1b[>0;0;0c") : QByteArray("\x1b[?6c");
+        break;
+    case 'd':
+        moveCursor(n - 1, m_cursorColumn);
+        break;
+    case 'h':
+    case 'l':
+        for (int i = 0; i < qMax(1, m_params.size()); ++i)
+            setMode(param(i, 0), m_private == '?', final == 'h');
+        break;
+    case 'm':
+        selectGraphicRendition();
+        break;
+    case 'n':
+        if (param(0, 0) == 5)
+            m_replies += "\x1b[0n";
+        else if (param(0, 0) == 6)
+            m_replies += QString("\x1b[%1;%2R").arg(m_cursorRow + 1).arg(m_cursorColumn + 1).toLatin1();
+        break;
+    case 'r': {
+        const int top = param(0, 1) - 1;
+        const int bottom = qMin(m_rows, param(1, m_rows)) - 1;
+        if (top < bottom) {
+            m_scrollTop = top;
+            m_scrollBottom = bottom;
+            moveCursor(0, 0);
+        }
+        break;
+    }
+    case 's':
+        m_saved = {m_cursorRow, m_cursorColumn, m_pen, m_graphics};
+        break;
+    case 'u':
+        moveCursor(m_saved.row, m_saved.column);
+        m_pen = m_saved.pen;
+        m_graphics = m_saved.graphics;
+        break;
+    default:
+        break;
+    }
+}
+
+void TerminalScreen::setMode(int mode, bool privateMode, bool on)
+{
+    if (!privateMode) {
+        if (mode == 4)
+            m_insertMode = on;
+        return;
+    }
+    switch (mode) {
+    case 1:
+        m_appCursorKeys = on;
+        break;
+    case 7:
+        m_autoWrap = on;
+        break;
+    case 25:
+        m_cursorVisible = on;
+        markDirty(m_cursorRow, m_cursorColumn, m_cursorColumn + 1);
+        break;
+    case 47:
+    case 1047:
+    case 1049:
+        if (mode == 1049 && on)
+            m_savedMain = {m_cursorRow, m_cursorColumn, m_pen, m_graphics};
+        switchScreen(on);
+        if (mode == 1049 && !on) {
+            moveCursor(m_savedMain.row, m_savedMain.column);
+            m_pen = m_savedMain.pen;
+            m_graphics = m_savedMain.graphics;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void TerminalScreen::selectGraphicRendition()
+{
+    if (m_params.isEmpty())
+        m_params.append(0);
+    for (int i = 0; i < m_params.size(); ++i) {
+        const int p = m_params[i];
+        if (p == 0) {
+            m_pen = TerminalCell();
+        } else if (p == 1) {
+            m_pen.attrs |= TerminalCell::Bold;
+        } else if (p == 4) {
+            m_pen.attrs |= TerminalCell::Underline;
+        } else if (p == 7) {
+            m_pen.attrs |= TerminalCell::Inverse;
+        } else if (p == 22) {
+            m_pen.attrs &= ~TerminalCell::Bold;
+        } else if (p == 24) {
+            m_pen.attrs &= ~TerminalCell::Underline;
+        } else if (p == 27) {
+            m_pen.attrs &= ~TerminalCell::Inverse;
+        } else if (p >= 30 && p <= 37) {
+            m_pen.fg = quint8(p - 30);
+            m_pen.attrs &= ~TerminalCell::DefaultFg;
+        } else if (p == 39) {
+            m_pen.attrs |= TerminalCell::DefaultFg;
+        } else if (p >= 40 && p <= 47) {
+            m_pen.bg = quint8(p - 40);
+            m_pen.attrs &= ~TerminalCell::DefaultBg;
+        } else if (p == 49) {
+            m_pen.attrs |= TerminalCell::DefaultBg;
+        } else if (p >= 90 && p <= 97) {
+            m_pen.fg = quint8(p - 90 + 8);
+            m_pen.attrs &= ~TerminalCell::DefaultFg;
+        } else if (p >= 100 && p <= 107) {
+            m_pen.bg = quint8(p - 100 + 8);
+            m_pen.attrs &= ~TerminalCell::DefaultBg;
+        } else if ((p == 38 || p == 48) && i + 1 < m_params.size()) {
+            // 38;5;N — палитра, 38;2;R;G;B — ближайший цвет куба
+            int color = -1;
+            if (m_params[i + 1] == 5 && i + 2 < m_params.size()) {
+                color = qBound(0, m_params[i + 2], 255);
+                i += 2;
+            } else if (m_params[i + 1] == 2 && i + 4 < m_params.size()) {
+                color = 16 + 36 * cubeLevel(m_params[i + 2]) + 6 * cubeLevel(m_params[i + 3]) + cubeLevel(m_params[i + 4]);
+                i += 4;
+            } else {
+                break;
+            }
+            if (p == 38) {
+                m_pen.fg = quint8(color);
+                m_pen.attrs &= ~TerminalCell::DefaultFg;
+            } else {
+                m_pen.bg = quint8(color);
+                m_pen.attrs &= ~TerminalCell::DefaultBg;
+            }
+        }
+    }
+}
+
+// ======================== Запись на экран ========================
+void TerminalScreen::print(quint32 ch)
+{
+    if (m_graphics && ch >= 0x60 && ch <= 0x7e)
+        ch = DecGraphics[ch - 0x60];
+    m_lastPrinted = ch;
+    ++m_stats.printed;
+
+    if (m_wrapPending) {
+        m_wrapPending = false;
+        if (m_autoWrap) {
+            m_cursorColumn = 0;
+            lineFeed();
+        }
+    }
+    if (m_insertMode)
+        insertCells(1);
+
+    TerminalCell &cell = m_lines[m_cursorRow][m_cursorColumn];
+    if (cell.ch != ch || !cell.sameStyle(m_pen)) {
+        cell = m_pen;
+        cell.ch = ch;
+        markDirty(m_cursorRow, m_cursorColumn, m_cursorColumn + 1);
+    }
+    if (m_cursorColumn + 1 < m_columns)
+        ++m_cursorColumn;
+    else
+        m_wrapPending = true;
+}
+
+void TerminalScreen::lineFeed()
+{
+    m_wrapPending = false;
+    if (m_cursorRow == m_scrollBottom)
+        scrollUp(m_scrollTop, m_scrollBottom, 1);
+    else if (m_cursorRow + 1 < m_rows)
+        ++m_cursorRow;
+}
+
+void TerminalScreen::reverseIndex()
+{
+    m_wrapPending = false;
+    if (m_cursorRow == m_scrollTop)
+        scrollDown(m_scrollTop, m_scrollBottom, 1);
+    else if (m_cursorRow > 0)
+        --m_cursorRow;
+}
+
+void TerminalScreen::scrollUp(int top, int bottom, int count)
+{
+    count = qMin(count, bottom - top + 1);
+    if (count <= 0)
+        return;
+    m_stats.scrolled += count;
+    const bool wholeScreen = top == 0 && bottom == m_rows - 1;
+    if (wholeScreen && !m_altScreen) {
+        for (int i = 0; i < count; ++i)
+            m_scrollback.push_back(m_lines[i]);
+        while (int(m_scrollback.size()) > MaxScrollback)
+            m_scrollback.pop_front();
+    }
+    std::rotate(m_lines.begin() + top, m_lines.begin() + top + count, m_lines.begin() + bottom + 1);
+    const TerminalCell empty = blank();
+    for (int row = bottom - count + 1; row <= bottom; ++row)
+        std::fill(m_lines[row].begin(), m_lines[row].end(), empty);
+
+    if (!wholeScreen) {
+        markRowsDirty(top, bottom + 1);
+        return;
+    }
+    // Картинку сдвинет рисующий: отрезки едут вместе со строками, новые — целиком
+    m_scrolled += count;
+    std::rotate(m_dirty.begin(), m_dirty.begin() + count, m_dirty.end());
+    markRowsDirty(m_rows - count, m_rows);
+}
+
+void TerminalScreen::scrollDown(int top, int bottom, int count)
+{
+    count = qMin(count, bottom - top + 1);
+    if (count <= 0)
+        return;
+    m_stats.scrolled += count;
+    std::rotate(m_lines.begin() + top, m_lines.begin() + bottom + 1 - count, m_lines.begin() + bottom + 1);
+    const TerminalCell empty = blank();
+    for (int row = top; row < top + count; ++row)
+        std::fill(m_lines[row].begin(), m_lines[row].end(), empty);
+    markRowsDirty(top, bottom + 1);
+}
+
+void TerminalScreen::eraseCells(int row, int from, int to)
+{
+    from = qBound(0, from, m_columns);
+    to = qBound(from, to, m_columns);
+    m_wrapPending = false;
+    const TerminalCell empty = blank();
+    QVector<TerminalCell> &line = m_lines[row];
+    for (int column = from; column < to; ++column) {
+        if (line[column] != empty) {
+            line[column] = empty;
+            markDirty(row, column, column + 1);
+        }
+    }
+}
+
+void TerminalScreen::eraseLines(int from, int to)
+{
+    for (int row = qMax(0, from); row < qMin(to, m_rows); ++row)
+        eraseCells(row, 0, m_columns);
+}
+
+void TerminalScreen::insertCells(int count)
+{
+    QVector<TerminalCell> &line = m_lines[m_cursorRow];
+    count = qMin(count, m_columns - m_cursorColumn);
+    std::rotate(line.begin() + m_cursorColumn, line.end() - count, line.end());
+    std::fill(line.begin() + m_cursorColumn, line.begin() + m_cursorColumn + count, blank());
+    markDirty(m_cursorRow, m_cursorColumn, m_columns);
+}
+
+void TerminalScreen::deleteCells(int count)
+{
+    QVector<TerminalCell> &line = m_lines[m_cursorRow];
+    count = qMin(count, m_columns - m_cursorColumn);
+    std::rotate(line.begin() + m_cursorColumn, line.begin() + m_cursorColumn + count, line.end());
+    std::fill(line.end() - count, line.end(), blank());
+    markDirty(m_cursorRow, m_cursorColumn, m_columns);
+    m_wrapPending = false;
+}
+
+void TerminalScreen::moveCursor(int row, int column)
+{
+    m_cursorRow = qBound(0, row, m_rows - 1);
+    m_cursorColumn = qBound(0, column, m_columns - 1);
+    m_wrapPending = false;
+}
+
+void TerminalScreen::switchScreen(bool alternate)
+{
+    if (alternate == m_altScreen)
+        return;
+    m_altScreen = alternate;
+    if (alternate) {
+        m_savedLines = m_lines;
+        m_lines = QVector<QVector<TerminalCell>>(m_rows, QVector<TerminalCell>(m_columns));
+    } else {
+        m_lines = m_savedLines;
+        m_savedLines.clear();
+    }
+    m_scrollTop = 0;
+    m_scrollBottom = m_rows - 1;
+    markAllDirty();
+}
+
+// Стирание красит фоном текущего пера, как xterm (BCE)
+TerminalCell TerminalScreen::blank() const
+{
+    TerminalCell cell;
+    cell.bg = m_pen.bg;
+    cell.attrs = TerminalCell::DefaultFg | (m_pen.attrs & TerminalCell::DefaultBg);
+    return cell;
+}
+
+QString TerminalScreen::text(int row) const
+{
+    const QVector<TerminalCell> &line = m_lines[row];
+    int end = line.size();
+    while (end > 0 && line[end - 1].ch == ' ')
+        --end;
+    QVector<uint> ucs4(end);
+    for (int column = 0; column < end; ++column)
+        ucs4[column] = line[column].ch;
+    return QString::fromUcs4(ucs4.constData(), end);
+}
+
+QByteArray TerminalScreen::takeReplies()
+{
+    QByteArray replies;
+    replies.swap(m_replies);
+    return replies;
+}
+
+// ======================== Повреждения ========================
+void TerminalScreen::markDirty(int row, int left, int right)
+{
+    Span &span = m_dirty[row];
+    if (span.isEmpty()) {
+        span = {left, right};
+        return;
+    }
+    span.left = qMin(span.left, left);
+    span.right = qMax(span.right, right);
+}
+
+void TerminalScreen::markRowsDirty(int from, int to)
+{
+    for (int row = from; row < to; ++row)
+        m_dirty[row] = {0, m_columns};
+}
+
+void TerminalScreen::markAllDirty()
+{
+    markRowsDirty(0, m_rows);
+}
+
+TerminalScreen::Damage TerminalScreen::takeDamage()
+{
+    Damage damage;
+    // Экран уехал целиком — сдвигать нечего, проще нарисовать всё
+    if (m_scrolled >= m_rows) {
+        markAllDirty();
+        m_scrolled = 0;
+    }
+    damage.scrolledLines = m_scrolled;
+    damage.rows = m_dirty;
+    m_scrolled = 0;
+    std::fill(m_dirty.begin(), m_dirty.end(), Span());
+    return damage;
+}
@@ -0,0 +1,189 @@
+#ifndef TERMINALSCREEN_H
+#define TERMINALSCREEN_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <deque>
+
+// Клетка экрана терминала: символ (UCS-4) и его оформление. Цвета — номера
+// палитры xterm: 0–15 ANSI, 16–255 — куб 6×6×6 и серые; DefaultFg/DefaultBg —
+// цвет по умолчанию, его выбирает тот, кто рисует
+struct TerminalCell {
+    enum Attr : quint8 {
+        Bold = 0x01,
+        Underline = 0x02,
+        Inverse = 0x04,
+        DefaultFg = 0x08,
+        DefaultBg = 0x10
+    };
+
+    quint32 ch = ' ';
+    quint8 fg = 7;
+    quint8 bg = 0;
+    quint8 attrs = DefaultFg | DefaultBg;
+
+    bool sameStyle(const TerminalCell &other) const
+    {
+        return fg == other.fg && bg == other.bg && attrs == other.attrs;
+    }
+    bool operator==(const TerminalCell &other) const { return ch == other.ch && sameStyle(other); }
+    bool operator!=(const TerminalCell &other) const { return !(*this == other); }
+};
+
+// Эмулятор терминала без ввода-вывода и без рисования: байты гостя — в
+// feed(), ответы гостю (DSR, DA) — из takeReplies(). Подмножество xterm,
+// которого хватает загрузчику FreeBSD, консоли Linux, vi и dialog:
+// UTF-8, C0, CSI (курсор, стирание, вставка/удаление строк и символов,
+// область прокрутки, SGR с 256 цветами и truecolor, приближённым к
+// палитре), DEC-графика для рамок, альтернативный экран, OSC-заголовок.
+// Широкие символы занимают одну клетку.
+//
+// Перерисовка — по повреждениям: на каждой строке копится отрезок
+// изменённых клеток, а прокрутка всего экрана не портит строки, а
+// копится в scrolledLines — рисующий сдвигает готовую картинку и
+// дорисовывает только новые строки. Строки, ушедшие вверх с основного
+// экрана, попадают в историю (до MaxScrollback).
+class TerminalScreen
+{
+public:
+    static constexpr int DefaultColumns = 80;
+    static constexpr int DefaultRows = 25;
+    static constexpr int MaxScrollback = 5000;
+    static constexpr int MaxTitleLength = 256;
+
+    // Отрезок [left, right) изменённых клеток строки; left >= right — строка цела
+    struct Span {
+        int left = 0;
+        int right = 0;
+        bool isEmpty() const { return left >= right; }
+    };
+
+    struct Damage {
+        int scrolledLines = 0;  // весь экран уехал вверх на столько строк
+        QVector<Span> rows;     // в координатах после прокрутки
+        bool isEmpty() const;
+    };
+
+    struct Stats {
+        qint64 bytes = 0;
+        qint64 printed = 0;    // символов на экран
+        qint64 sequences = 0;  // разобранных ESC/CSI/OSC
+        qint64 scrolled = 0;   // строк прокрутки
+    };
+
+    explicit TerminalScreen(int columns = DefaultColumns, int rows = DefaultRows);
+
+    // Содержимое сохраняется сверху слева; курсор остаётся на экране
+    void resize(int columns, int rows);
+    void reset();
+
+    void feed(const char *data, int size);
+    void feed(const QByteArray &data) { feed(data.constData(), data.size()); }
+    QByteArray takeReplies();
+
+    Damage takeDamage();
+    void markAllDirty();
+
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+    const TerminalCell &cell(int row, int column) const { return m_lines[row][column]; }
+    const QVector<TerminalCell> &line(int row) const { return m_lines[row]; }
+    // Строка без оформления и без пробелов в конце — для проверок и поиска
+    QString text(int row) const;
+
+    int scrollbackSize() const { return int(m_scrollback.size()); }
+    // 0 — самая старая строка истории
+    const QVector<TerminalCell> &scrollbackLine(int index) const { return m_scrollback[size_t(index)]; }
+
+    int cursorRow() const { return m_cursorRow; }
+    int cursorColumn() const { return m_cursorColumn; }
+    bool cursorVisible() const { return m_cursorVisible; }
+    // DECCKM: стрелки — ESC O A вместо ESC [ A
+    bool applicationCursorKeys() const { return m_appCursorKeys; }
+    bool isAlternateScreen() const { return m_altScreen; }
+    QString title() const { return m_title; }
+    const Stats &stats() const { return m_stats; }
+
+    // Цвет палитры xterm в 0xRRGGBB
+    static quint32 paletteColor(int index);
+
+private:
+    enum class State {
+        Ground,
+        Escape,
+        Charset,
+        Csi,
+        String,      // OSC/DCS — до BEL или ST
+        StringEscape
+    };
+
+    struct SavedCursor {
+        int row = 0;
+        int column = 0;
+        TerminalCell pen;
+        bool graphics = false;
+    };
+
+    void execute(uchar c);
+    void escape(uchar c);
+    void dispatchCsi(uchar final);
+    void setMode(int mode, bool privateMode, bool on);
+    void selectGraphicRendition();
+    void finishString();
+    void print(quint32 ch);
+
+    void lineFeed();
+    void reverseIndex();
+    void scrollUp(int top, int bottom, int count);
+    void scrollDown(int top, int bottom, int count);
+    void eraseCells(int row, int from, int to);
+    void eraseLines(int from, int to);
+    void insertCells(int count);
+    void deleteCells(int count);
+    void moveCursor(int row, int column);
+    void switchScreen(bool alternate);
+
+    void markDirty(int row, int left, int right);
+    void markRowsDirty(int from, int to);
+    TerminalCell blank() const;
+    int param(int index, int defaultValue) const;
+
+    int m_columns;
+    int m_rows;
+    QVector<QVector<TerminalCell>> m_lines;
+    QVector<QVector<TerminalCell>> m_savedLines;  // основной экран, пока открыт альтернативный
+    std::deque<QVector<TerminalCell>> m_scrollback;
+
+    int m_cursorRow = 0;
+    int m_cursorColumn = 0;
+    bool m_wrapPending = false;  // символ в последней колонке: перенос — со следующим
+    bool m_cursorVisible = true;
+    bool m_autoWrap = true;
+    bool m_insertMode = false;
+    bool m_appCursorKeys = false;
+    bool m_altScreen = false;
+    bool m_graphics = false;  // G0 — DEC Special Graphics
+    int m_scrollTop = 0;
+    int m_scrollBottom = 0;
+    TerminalCell m_pen;
+    SavedCursor m_saved;
+    SavedCursor m_savedMain;   // курсор основного экрана на время альтернативного
+    quint32 m_lastPrinted = ' ';
+
+    State m_state = State::Ground;
+    QVector<int> m_params;
+    char m_private = 0;      // '?', '>' ... перед параметрами CSI
+    char m_intermediate = 0;
+    QByteArray m_string;
+    quint32 m_utf8 = 0;
+    int m_utf8Pending = 0;
+
+    QVector<Span> m_dirty;
+    int m_scrolled = 0;
+    QByteArray m_replies;
+    QString m_title;
+    Stats m_stats;
+};
+
+#endif // TERMINALSCREEN_H
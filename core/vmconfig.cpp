@@ -0,0 +1,184 @@
+#include "vmconfig.h"
+
+#include <QRegularExpression>
+#include <QStringList>
+
+bool VmConfig::normalizeMemory(const QString &input, QString *normalized, QString *errorMessage)
+{
+    const QString mem = input.trimmed();
+    if (mem.isEmpty()) {
+        if (errorMessage) *errorMessage = "Укажите объём памяти!";
+        return false;
+    }
+
+    static const QRegularExpression re("^(\\d+)([GMgm])$");
+    const QRegularExpressionMatch match = re.match(mem);
+    quint64 value = 0;
+    QString unit;
+
+    if (match.hasMatch()) {
+        value = match.captured(1).toULongLong();
+        unit = match.captured(2).toUpper();
+    } else {
+        bool ok;
+        value = mem.toULongLong(&ok);
+        if (!ok || value == 0) {
+            if (errorMessage) *errorMessage = "Неверный формат памяти!\n\nКорректные примеры:\n• 4G\n• 8G\n• 8192M\n• 4096 (МБ)";
+            return false;
+        }
+        unit = "M";
+    }
+
+    quint64 valueInMB = (unit == "G") ? value * 1024ULL : value;
+    if (valueInMB < 256) {
+        if (errorMessage) *errorMessage = "Слишком мало памяти! Минимум 256 МБ.";
+        return false;
+    }
+    if (valueInMB > 512 * 1024) {
+        if (errorMessage) *errorMessage = QString("Слишком много памяти (%1 ГБ)! Максимум 512 ГБ.").arg(valueInMB / 1024);
+        return false;
+    }
+
+    if (normalized)
+        *normalized = QString::number(value) + unit;
+    return true;
+}
+
+bool CpuConfig::normalize(QString *errorMessage)
+{
+    if (vcpus < 1 || vcpus > MaxVcpus) {
+        if (errorMessage) *errorMessage = QString("Число vCPU — от 1 до %1.").arg(MaxVcpus);
+        return false;
+    }
+    if (sockets == 1 && cores == 1 && threads == 1)
+        sockets = vcpus;
+    if (sockets < 1 || cores < 1 || threads < 1 || sockets * cores * threads != vcpus) {
+        if (errorMessage)
+            *errorMessage = QString("Топология %1×%2×%3 (сокеты × ядра × потоки) не даёт %4 vCPU.")
+                                .arg(sockets).arg(cores).arg(threads).arg(vcpus);
+        return false;
+    }
+    return true;
+}
+
+QString CpuConfig::bhyveArgument() const
+{
+    if (sockets == vcpus)
+        return QString::number(vcpus);
+    return QString("cpus=%1,sockets=%2,cores=%3,threads=%4").arg(vcpus).arg(sockets).arg(cores).arg(threads);
+}
+
+bool CpuConfig::parse(const QString &input, CpuConfig *cpu, QString *errorMessage)
+{
+    CpuConfig parsed;
+    bool ok = true;
+    const QStringList parts = input.trimmed().split(',', Qt::SkipEmptyParts);
+    for (int i = 0; i < parts.size() && ok; ++i) {
+        const QString part = parts[i].trimmed();
+        if (part == "pin") {
+            parsed.pin = true;
+            continue;
+        }
+        const int eq = part.indexOf('=');
+        // Голое число первым — как в bhyve -c 4
+        const QString key = eq < 0 && i == 0 ? QString("cpus") : part.left(eq);
+        const int value = part.mid(eq + 1).toInt(&ok);
+        if (key == "cpus") parsed.vcpus = value;
+        else if (key == "sockets") parsed.sockets = value;
+        else if (key == "cores") parsed.cores = value;
+        else if (key == "threads") parsed.threads = value;
+        else ok = false;
+    }
+    if (!ok || parts.isEmpty()) {
+        if (errorMessage) *errorMessage = "Неверный формат процессоров: " + input
+                                          + "\n\nКорректные примеры:\n• 4\n• 4,pin\n• cpus=4,sockets=1,cores=2,threads=2";
+        return false;
+    }
+    if (!parsed.normalize(errorMessage))
+        return false;
+    *cpu = parsed;
+    return true;
+}
+
+QString DiskProfile::deviceName(Device device)
+{
+    switch (device) {
+    case Device::AhciHd:    return "ahci-hd";
+    case Device::VirtioBlk: return "virtio-blk";
+    case Device::Nvme:      return "nvme";
+    }
+    return QString();
+}
+
+QString DiskProfile::bhyveOptions() const
+{
+    QString options;
+    if (nocache)
+        options += ",nocache";
+    if (direct)
+        options += ",direct";
+    if (readOnly)
+        options += ",ro";
+    if (sectorSize > 0) {
+        options += ",sectorsize=" + QString::number(sectorSize);
+        if (physicalSectorSize > 0 && physicalSectorSize != sectorSize)
+            options += "/" + QString::number(physicalSectorSize);
+    }
+    return options;
+}
+
+QString DiskProfile::toString() const
+{
+    return deviceName(device) + bhyveOptions();
+}
+
+bool DiskProfile::parse(const QString &input, DiskProfile *profile, QString *errorMessage)
+{
+    DiskProfile parsed;
+    const QStringList parts = input.trimmed().split(',', Qt::SkipEmptyParts);
+    QString bad;
+    for (int i = 0; i < parts.size() && bad.isEmpty(); ++i) {
+        const QString part = parts[i].trimmed();
+        if (i == 0) {
+            if (part == "ahci-hd") parsed.device = Device::AhciHd;
+            else if (part == "virtio-blk") parsed.device = Device::VirtioBlk;
+            else if (part == "nvme") parsed.device = Device::Nvme;
+            else bad = part;
+        } else if (part == "nocache") {
+            parsed.nocache = true;
+        } else if (part == "direct") {
+            parsed.direct = true;
+        } else if (part == "ro") {
+            parsed.readOnly = true;
+        } else if (part.startsWith("sectorsize=")) {
+            const QStringList sizes = part.mid(11).split('/');
+            bool okLogical = false, okPhysical = true;
+            parsed.sectorSize = sizes.value(0).toInt(&okLogical);
+            parsed.physicalSectorSize = sizes.size() > 1 ? sizes.value(1).toInt(&okPhysical) : 0;
+            // bhyve принимает степени двойки от 512 байт
+            auto valid = [](int size) { return size >= 512 && size <= 65536 && (size & (size - 1)) == 0; };
+            if (!okLogical || !okPhysical || !valid(parsed.sectorSize)
+                || (parsed.physicalSectorSize && (!valid(parsed.physicalSectorSize) || parsed.physicalSectorSize < parsed.sectorSize)))
+                bad = part;
+        } else {
+            bad = part;
+        }
+    }
+    if (parts.isEmpty() || !bad.isEmpty()) {
+        if (errorMessage)
+            *errorMessage = QString("Неверный профиль диска: %1%2\n\nКорректные примеры:\n• virtio-blk\n• nvme,nocache\n"
+                                    "• ahci-hd,ro\n• virtio-blk,direct,sectorsize=512/4096")
+                                .arg(input, bad.isEmpty() ? QString() : " (" + bad + ")");
+        return false;
+    }
+    *profile = parsed;
+    return true;
+}
+
+QVector<DiskConfig> VmConfig::disks() const
+{
+    QVector<DiskConfig> list;
+    list.append(DiskConfig {diskPath, diskProfile});
+    list += extraDisks;
+    return list;
+}
@@ -0,0 +1,110 @@
+#ifndef VMCONFIG_H
+#define VMCONFIG_H
+
+#include <QString>
+#include <QVector>
+
+// Ступени остановки и сколько ждать выхода bhyve на каждой. 0 — ступень
+// пропускается (кроме Destroy: bhyvectl --destroy выполняется всегда).
+struct ShutdownPolicy {
+    int powerOffMs = 30000;       // doas kill -TERM: bhyve жмёт ACPI-кнопку питания
+    int forcePowerOffMs = 5000;   // bhyvectl --force-poweroff: выключение "из розетки"
+    int killMs = 3000;            // doas kill -KILL
+    int destroyMs = 8000;         // bhyvectl --destroy — последнее средство
+};
+
+// Когда перезапускать bhyve после выхода, и как быстро. Перезагрузка
+// гостя (код 0) для bhyve — тоже выход процесса.
+struct RestartPolicy {
+    enum Mode {
+        Never,      // ни при каком выходе
+        OnFailure,  // перезагрузка гостя и сбои; выключение/halt — нет
+        Always      // любой выход, кроме stop()
+    };
+
+    Mode mode = OnFailure;
+    int rebootDelayMs = 1000;       // перезагрузка гостя — не сбой, без backoff
+    int initialBackoffMs = 2000;    // первый повтор после сбоя
+    int maxBackoffMs = 120000;
+    int jitterPercent = 20;         // ± к каждой задержке
+    int crashLoopFailures = 5;      // столько сбоев за crashLoopWindowMs —
+    int crashLoopWindowMs = 300000; //   и перезапуски прекращаются
+    int minUptimeMs = 60000;        // проработала дольше — счётчик сбоев с нуля
+};
+
+// Процессоры гостя: сколько vCPU и какой их видит гость (sockets × cores ×
+// threads = vcpus). pin — закрепить vCPU за процессорами хоста (bhyve -p),
+// их подбирает CpuPlacer
+struct CpuConfig {
+    static constexpr int MaxVcpus = 64;
+
+    int vcpus = 1;
+    int sockets = 1;
+    int cores = 1;
+    int threads = 1;
+    bool pin = false;
+
+    // Топология не задана (1×1×1) — как у bhyve: по сокету на vCPU.
+    // Не сходится с vcpus — false и текст для пользователя
+    bool normalize(QString *errorMessage = nullptr);
+    // Аргумент bhyve -c: "4" или "cpus=4,sockets=1,cores=2,threads=2"
+    QString bhyveArgument() const;
+    // "4", "4,pin", "cpus=4,sockets=1,cores=4,threads=1[,pin]" — формат
+    // bhyve -c плюс pin; результат уже нормализован
+    static bool parse(const QString &input, CpuConfig *cpu, QString *errorMessage = nullptr);
+};
+
+// Как bhyve подключает образ: модель устройства и опции блочного
+// backend'а. nocache — O_DIRECT (мимо кэша хоста), direct — O_SYNC
+// (каждая запись до диска), ro — только чтение (золотые образы)
+struct DiskProfile {
+    enum class Device {
+        AhciHd,
+        VirtioBlk,
+        Nvme
+    };
+
+    Device device = Device::AhciHd;
+    bool nocache = false;
+    bool direct = false;
+    bool readOnly = false;
+    int sectorSize = 0;          // логический сектор, байт; 0 — как решит bhyve
+    int physicalSectorSize = 0;  // 0 — равен логическому
+
+    static QString deviceName(Device device);
+    // Опции после пути: ",nocache,ro,sectorsize=512/4096"
+    QString bhyveOptions() const;
+    // "virtio-blk,nocache,ro,sectorsize=512/4096" — модель первой, опции в
+    // синтаксисе bhyve; то же самое возвращает toString()
+    QString toString() const;
+    static bool parse(const QString &input, DiskProfile *profile, QString *errorMessage = nullptr);
+};
+
+struct DiskConfig {
+    QString path;
+    DiskProfile profile;
+};
+
+// Параметры запуска одной ВМ (то, что раньше читалось прямо из lineEdit_*)
+struct VmConfig {
+    QString name;
+    QString memory;     // уже нормализовано: "8G", "4096M"
+    QString diskPath;
+    DiskProfile diskProfile;         // virtio-blk для образов из каталога ВМ, если не задан
+    QVector<DiskConfig> extraDisks;  // дополнительные диски, слоты PCI — автоматически
+    QString isoPath;
+    QString tap;
+    CpuConfig cpu;
+    int vncPort = 0;    // порт экрана (fbuf); 0 — выдаёт DisplayPorts
+    ShutdownPolicy shutdown;
+    RestartPolicy restart;
+
+    // "4g" → "4G", "4096" → "4096M"; от 256 МБ до 512 ГБ. При ошибке —
+    // false и текст для пользователя в errorMessage
+    static bool normalizeMemory(const QString &input, QString *normalized, QString *errorMessage = nullptr);
+
+    // Загрузочный диск первым, за ним дополнительные
+    QVector<DiskConfig> disks() const;
+};
+
+#endif // VMCONFIG_H
@@ -0,0 +1,645 @@
+#include "vminstance.h"
+#include "commandrunner.h"
+#include "interfacewatcher.h"
+#include "networkreconciler.h"
+#include "guestprocess.h"
+#include "cputopology.h"
+#include "memoryadmission.h"
+#include "displayports.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QCryptographicHash>
+
+VmInstance::VmInstance(const VmConfig &config, CommandRunner *commands, InterfaceWatcher *network,
+                       NetworkReconciler *reconciler, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_commands(commands)
+    , m_network(network)
+    , m_reconciler(reconciler)
+    , m_serial(new SerialConsole(this))
+    , m_guest(new GuestProcess(config.name, this))
+    , m_log(new LogBuffer(LogCapacity, this))
+{
+    m_restartTimer.setSingleShot(true);
+    m_restarts.setPolicy(m_config.restart);
+    connect(&m_restartTimer, &QTimer::timeout, this, &VmInstance::launch);
+
+    m_stopTimer.setSingleShot(true);
+    connect(&m_stopTimer, &QTimer::timeout, this, &VmInstance::advanceStop);
+
+    connect(m_guest, &GuestProcess::started, this, [this]() {
+        m_startedAtMs = m_guest->state().startedAtMs;
+        m_restarts.onStarted(m_uptimeClock.elapsed());
+        markPhase(VmPhase::Started, "pid " + QString::number(m_guest->processId()));
+        // stop() пришёл, пока прослойка запускала bhyve: pid известен только
+        // сейчас — начинаем ступени остановки, а не объявляем ВМ работающей
+        if (m_state == State::Stopping) {
+            if (m_stopStage == StopStage::None)
+                advanceStop();
+            return;
+        }
+        setState(State::Running);
+        appendLog(LogSeverity::Success, "[ЗАПУЩЕНО] Виртуальная машина успешно стартовала");
+    });
+    connect(m_guest, &GuestProcess::output, this, [this](LogSeverity severity, const QByteArray &data) {
+        m_log->appendChunk(severity, data);
+    });
+    connect(m_guest, &GuestProcess::finished, this, &VmInstance::onFinished);
+    connect(m_guest, &GuestProcess::failedToStart, this, &VmInstance::onFailedToStart);
+    // Консоль гостя — в тот же лог, а с ним и в архив на диске
+    connect(m_serial, &SerialConsole::received, this, [this](const QByteArray &data) {
+        m_log->appendChunk(LogSeverity::Serial, data);
+    });
+}
+
+VmInstance::~VmInstance()
+{
+    if (!m_guest->isRunning())
+        return;
+    m_guest->disconnect(this);
+    // Гость переживает окно: следующий запуск подхватит его через reattach()
+    if (m_detachOnDestroy) {
+        m_guest->detach();
+        return;  // nmdm остаётся за гостем; наша сторона закроется вместе с объектом
+    }
+    m_guest->kill();
+    // Ждать ответа некому — bhyvectl запускаем отвязанным
+    m_commands->startDetached(CommandSpec::doas({"bhyvectl", "--destroy", "--vm=" + m_config.name}));
+}
+
+qint64 VmInstance::processId() const
+{
+    return m_guest->isRunning() ? m_guest->processId() : 0;
+}
+
+bool VmInstance::setConfig(const VmConfig &config)
+{
+    if (isActive() || config.name != m_config.name)
+        return false;
+    m_config = config;
+    m_restarts.setPolicy(config.restart);
+    emit changed();
+    return true;
+}
+
+QString VmInstance::stateName(State state)
+{
+    switch (state) {
+    case State::Stopped:    return "Остановлена";
+    case State::Starting:   return "Запускается";
+    case State::Running:    return "Работает";
+    case State::Stopping:   return "Останавливается";
+    case State::Restarting: return "Перезапуск";
+    case State::Failed:     return "Ошибка";
+    }
+    return QString();
+}
+
+QString VmInstance::guestMacAddress(const QString &vmName)
+{
+    const QByteArray seed = QString("%1-%2-%3").arg(NetSlot).arg(0).arg(vmName).toUtf8();
+    const QByteArray digest = QCryptographicHash::hash(seed, QCryptographicHash::Md5);
+    return QString("58:9c:fc:%1:%2:%3")
+        .arg(quint8(digest[0]), 2, 16, QLatin1Char('0'))
+        .arg(quint8(digest[1]), 2, 16, QLatin1Char('0'))
+        .arg(quint8(digest[2]), 2, 16, QLatin1Char('0'));
+}
+
+QString VmInstance::stopStageName(StopStage stage)
+{
+    switch (stage) {
+    case StopStage::None:          return QString();
+    case StopStage::PowerOff:      return "ACPI poweroff";
+    case StopStage::ForcePowerOff: return "force-poweroff";
+    case StopStage::Kill:          return "SIGKILL";
+    case StopStage::Destroy:       return "bhyvectl --destroy";
+    }
+    return QString();
+}
+
+// ======================== Старт / стоп ========================
+void VmInstance::start()
+{
+    if (isActive())
+        return;
+    m_shouldRestart = true;
+    m_restarts.arm();
+    if (!m_uptimeClock.isValid())
+        m_uptimeClock.start();
+    appendLog(LogSeverity::Command, "[Старт] Подготовка к запуску VM: " + m_config.name);
+    launch();
+}
+
+// Гость, запущенный прошлым экземпляром vmrun: ничего не запускаем, только
+// читаем его файлы дальше. Сеть сверяется через NetworkReconciler — если
+// tap уже в мосту, это не стоит ни одной команды
+bool VmInstance::reattach()
+{
+    if (isActive())
+        return false;
+    m_guest->setDirectory(m_runtimeDir);
+    if (!m_guest->attach())
+        return false;
+
+    ++m_generation;
+    m_launchClock.start();
+    m_networkReadyMs = -1;
+    m_shouldRestart = true;
+    m_restarts.arm();
+    if (!m_uptimeClock.isValid())
+        m_uptimeClock.start();
+    m_restarts.onStarted(m_uptimeClock.elapsed());
+    m_startedAtMs = m_guest->state().startedAtMs;
+    // Закреплённые vCPU гостя занимают процессоры и после перезапуска окна
+    if (m_placer && !m_guest->state().pinning.isEmpty())
+        m_placer->reserve(m_config.name, m_guest->state().pinning);
+    // Его память уже wired — учитываем без проверки
+    if (m_admission)
+        m_admission->reserve(m_config.name, MemoryAdmission::parseMemory(m_config.memory));
+    // Экран гостя остаётся на прежнем порту
+    m_vncPort = m_guest->state().vncPort;
+    if (m_displayPorts && m_vncPort > 0)
+        m_displayPorts->reserve(m_config.name, m_vncPort);
+    // nmdm пережил прошлый vmrun — открываем нашу сторону заново
+    if (!m_guest->state().console.isEmpty()) {
+        QString consoleError;
+        if (!m_serial->attach(m_guest->state().console, &consoleError))
+            appendLog(LogSeverity::Warning, "[Консоль] com1 недоступен: " + consoleError);
+    }
+
+    appendLog(LogSeverity::Notice, QString("[Подхват] bhyve уже работает (pid %1, запущен %2)")
+                                       .arg(m_guest->processId())
+                                       .arg(QDateTime::fromMSecsSinceEpoch(m_startedAtMs).toString("dd.MM HH:mm:ss")));
+    markPhase(VmPhase::Started, "подхват, pid " + QString::number(m_guest->processId()));
+    setState(State::Running);
+    if (!m_config.tap.isEmpty()) {
+        markPhase(VmPhase::TapAttached, m_config.tap);
+        attachTapToBridge();
+    }
+    return true;
+}
+
+void VmInstance::stop()
+{
+    m_shouldRestart = false;
+
+    if (m_state == State::Restarting && m_restartTimer.isActive()) {
+        m_restartTimer.stop();
+        appendLog(LogSeverity::Info, "Авторестарт отменён.");
+        setState(State::Stopped);
+        return;
+    }
+    // bhyve ещё не запускали — достаточно выйти из очереди за памятью
+    if (m_waitingForMemory) {
+        m_waitingForMemory = false;
+        appendLog(LogSeverity::Info, "[Память] Ожидание памяти отменено.");
+        markPhase(VmPhase::Finished, "отменено в очереди за памятью");
+        setState(State::Stopped);
+        return;
+    }
+    if (!m_guest->isRunning())
+        return;
+
+    // Уже останавливаемся — не ждём дедлайна текущей ступени
+    if (m_state == State::Stopping) {
+        if (m_stopStage != StopStage::None && m_stopStage != StopStage::Destroy) {
+            appendLog(LogSeverity::Warning, "[Остановка] Повторный запрос — переходим к следующей ступени");
+            advanceStop();
+        }
+        return;
+    }
+
+    m_network->cancel(m_tapWaitId);
+    markPhase(VmPhase::StopRequested);
+    m_stopClock.start();
+    m_stopStage = StopStage::None;
+    setState(State::Stopping);
+    appendLog(LogSeverity::Warning, "[Остановка] Остановка виртуальной машины...");
+    // Очистка (bhyvectl --destroy, deletem) — в onFinished, как и при штатном выходе
+    advanceStop();
+}
+
+// Следующая ступень остановки. bhyve работает от root через doas, поэтому
+// сигналы шлём тоже через doas — напрямую до него не достать.
+void VmInstance::advanceStop()
+{
+    if (m_state != State::Stopping || !m_guest->isRunning())
+        return;
+
+    // Дальше эскалировать некуда — только сообщаем, что процесс завис
+    if (m_stopStage == StopStage::Destroy) {
+        appendLog(LogSeverity::Error, "[Остановка] bhyve не завершился даже после bhyvectl --destroy");
+        return;
+    }
+    // Прослойка ещё не отчиталась pid'ом bhyve. Снимать её нельзя — doas мог
+    // уже стартовать и остался бы сиротой; ступени начнёт обработчик started(),
+    // а не дождётся его — GuestProcess сам снимет прослойку по StartDeadlineMs
+    if (m_guest->processId() <= 0)
+        return;
+
+    const ShutdownPolicy &policy = m_config.shutdown;
+    const QString pid = QString::number(m_guest->processId());
+    int deadlineMs = 0;
+    CommandSpec spec;
+
+    // Ступени с нулевым дедлайном пропускаем
+    do {
+        m_stopStage = StopStage(int(m_stopStage) + 1);
+        switch (m_stopStage) {
+        case StopStage::PowerOff:
+            deadlineMs = policy.powerOffMs;
+            spec = CommandSpec::doas({"kill", "-TERM", pid});
+            break;
+        case StopStage::ForcePowerOff:
+            deadlineMs = policy.forcePowerOffMs;
+            spec = CommandSpec::doas({"bhyvectl", "--force-poweroff", "--vm=" + m_config.name});
+            break;
+        case StopStage::Kill:
+            deadlineMs = policy.killMs;
+            spec = CommandSpec::doas({"kill", "-KILL", pid});
+            break;
+        case StopStage::Destroy:
+        case StopStage::None:
+            m_stopStage = StopStage::Destroy;
+            deadlineMs = qMax(policy.destroyMs, 1000);
+            spec = CommandSpec::doas({"bhyvectl", "--destroy", "--vm=" + m_config.name}, 8000);
+            break;
+        }
+    } while (deadlineMs <= 0);
+
+    spec.allowFailure = true;  // процесс мог выйти между ступенями
+    appendLog(LogSeverity::Warning, QString("[Остановка] %1, ждём выхода до %2 с")
+                                        .arg(stopStageName(m_stopStage))
+                                        .arg(deadlineMs / 1000.0, 0, 'f', 1));
+    emit changed();
+
+    if (m_stopStage == StopStage::Kill)
+        m_guest->kill();  // на случай, если bhyve запущен без doas
+    const StopStage stage = m_stopStage;
+    m_commands->run(spec, this, [this, stage](const CommandResult &result) {
+        if (!result.ok() && m_state == State::Stopping && m_guest->isRunning())
+            appendLog(LogSeverity::Error, "[Остановка] " + stopStageName(stage) + ": " + result.errorString());
+    });
+
+    m_stopTimer.start(deadlineMs);
+}
+
+// Вызывается, когда ВМ после stop() дошла до Stopped: считаем полную задержку
+void VmInstance::finishStop()
+{
+    if (m_stopStage == StopStage::None)
+        return;
+    m_lastStopMs = m_stopClock.elapsed();
+    m_stopStats.record(m_lastStopMs);
+    appendLog(LogSeverity::Success, QString("[Остановка] Завершено за %1 мс (ступень: %2)")
+                                        .arg(m_lastStopMs).arg(stopStageName(m_stopStage)));
+    m_stopStage = StopStage::None;
+}
+
+// ======================== Запуск bhyve ========================
+QVector<int> VmInstance::diskSlots(int count)
+{
+    // Слоты 1–2 не трогаем: на них исторически ничего не висит, и гости
+    // со старой раскладкой видят загрузочный диск там же, где раньше — в 3
+    static const QVector<int> reserved = {0, 4, NetSlot, 15, 30, 31};
+    QVector<int> available;
+    for (int slot = 3; slot < 30; ++slot) {
+        if (!reserved.contains(slot))
+            available.append(slot);
+    }
+    if (count > available.size())
+        return {};
+    return count > 0 ? available.mid(0, count) : available;
+}
+
+void VmInstance::launch()
+{
+    ++m_generation;
+    m_launchClock.start();
+    m_networkReadyMs = -1;
+    markPhase(VmPhase::Validate);
+    setState(State::Starting);
+
+    const QVector<DiskConfig> disks = m_config.disks();
+    for (const DiskConfig &disk : disks) {
+        if (!QFileInfo::exists(disk.path)) {
+            appendLog(LogSeverity::Error, "[Ошибка] Диск не найден: " + disk.path);
+            markPhase(VmPhase::Finished, "диск не найден");
+            m_shouldRestart = false;
+            setState(State::Failed);
+            return;
+        }
+    }
+    if (diskSlots(disks.size()).isEmpty()) {
+        appendLog(LogSeverity::Error, QString("[Ошибка] Слишком много дисков: %1, свободных PCI-слотов %2")
+                                          .arg(disks.size()).arg(diskSlots(0).size()));
+        markPhase(VmPhase::Finished, "нет PCI-слотов для дисков");
+        m_shouldRestart = false;
+        setState(State::Failed);
+        return;
+    }
+
+    if (!m_admission) {
+        spawn();
+        return;
+    }
+
+    // -S закрепляет всю память гостя сразу — сначала убеждаемся, что она есть
+    const quint64 bytes = MemoryAdmission::parseMemory(m_config.memory);
+    const quint64 generation = m_generation;
+    QString reason;
+    const MemoryAdmission::Verdict verdict = m_admission->acquire(
+        m_config.name, bytes, &reason, this, [this, generation](bool admitted, const QString &why) {
+            if (generation != m_generation || !m_waitingForMemory)
+                return;
+            m_waitingForMemory = false;
+            emit changed();
+            if (!admitted) {
+                appendLog(LogSeverity::Error, "[Память] Запуск отменён: " + why);
+                markPhase(VmPhase::Finished, why);
+                m_shouldRestart = false;
+                setState(State::Failed);
+                return;
+            }
+            appendLog(LogSeverity::Notice, "[Память] Память освободилась, запускаем");
+            spawn();
+        });
+
+    switch (verdict) {
+    case MemoryAdmission::Verdict::Admit:
+        spawn();
+        break;
+    case MemoryAdmission::Verdict::Queue:
+        m_waitingForMemory = true;
+        appendLog(LogSeverity::Warning, "[Память] Запуск ждёт памяти: " + reason);
+        emit changed();
+        break;
+    case MemoryAdmission::Verdict::Reject:
+        appendLog(LogSeverity::Error, "[Память] Запуск отклонён: " + reason);
+        markPhase(VmPhase::Finished, reason);
+        m_shouldRestart = false;
+        setState(State::Failed);
+        break;
+    }
+}
+
+void VmInstance::spawn()
+{
+    // Порт экрана — до команды: без него bhyve не запустится на занятом
+    m_vncPort = m_displayPorts ? m_displayPorts->acquire(m_config.name, m_config.vncPort)
+                               : (m_config.vncPort > 0 ? m_config.vncPort : DisplayPorts::FirstPort);
+    if (m_vncPort == 0) {
+        onFailedToStart(m_config.vncPort > 0
+                            ? QString("VNC-порт %1 занят").arg(m_config.vncPort)
+                            : QString("нет свободного VNC-порта (%1–%2)")
+                                  .arg(m_displayPorts->firstPort()).arg(m_displayPorts->lastPort()));
+        return;
+    }
+    appendLog(LogSeverity::Notice, QString("[Экран] VNC на порту %1").arg(m_vncPort));
+
+    // Нашу сторону com1 — до bhyve: имя slave у pty известно только после открытия
+    QString consoleError;
+    const bool console = m_serial->open(m_consoleBackend, m_config.name, &consoleError);
+    if (console)
+        appendLog(LogSeverity::Notice, QString("[Консоль] com1 → %1 (%2)")
+                                           .arg(m_serial->guestDevice(), SerialConsole::backendName(m_consoleBackend)));
+    else
+        appendLog(LogSeverity::Warning, "[Консоль] com1 не подключён: " + consoleError);
+
+    QStringList args = {
+        "-c", m_config.cpu.bhyveArgument(),
+        "-s", "0,hostbridge",
+    };
+
+    const QVector<DiskConfig> disks = m_config.disks();
+    const QVector<int> pciSlots = diskSlots(disks.size());
+    for (int i = 0; i < disks.size(); ++i) {
+        const DiskProfile &profile = disks[i].profile;
+        args << "-s" << QString("%1,%2,%3%4").arg(pciSlots[i])
+                            .arg(DiskProfile::deviceName(profile.device), disks[i].path, profile.bhyveOptions());
+    }
+
+    if (!m_config.isoPath.isEmpty() && QFileInfo::exists(m_config.isoPath)) {
+        args << "-s" << QString("4,ahci-cd,%1").arg(m_config.isoPath);
+    }
+
+    args << "-s" << QString("%1,virtio-net,%2").arg(NetSlot).arg(m_config.tap);
+    args << "-s" << "15,virtio-9p,sharename=/home/";
+    args << "-s" << QString("30,fbuf,tcp=0.0.0.0:%1,w=1920,h=1080").arg(m_vncPort);
+    args << "-s" << "31,lpc";
+
+    // Процессоры хоста подбираются заново при каждом запуске: за время
+    // простоя раскладка остальных ВМ могла измениться
+    QVector<int> pinning;
+    if (m_config.cpu.pin && m_placer) {
+        pinning = m_placer->place(m_config.name, m_config.cpu.vcpus);
+        QStringList map;
+        for (int vcpu = 0; vcpu < pinning.size(); ++vcpu) {
+            args << "-p" << QString("%1:%2").arg(vcpu).arg(pinning[vcpu]);
+            map << QString("%1→%2").arg(vcpu).arg(pinning[vcpu]);
+        }
+        appendLog(LogSeverity::Notice, "[CPU] vCPU → процессор хоста: " + map.join(", "));
+    }
+
+    if (console)
+        args << "-l" << "com1," + m_serial->guestDevice();
+    args << "-l" << "bootrom,/usr/local/share/uefi-firmware/BHYVE_UEFI.fd";
+    args << "-m" << m_config.memory;
+    args << "-H" << "-w" << "-P" << "-S";
+    args << m_config.name;
+
+    appendLog(LogSeverity::Command, "[Команда] doas bhyve " + args.join(" "));
+
+    GuestState guest;
+    guest.tap = m_config.tap;
+    guest.vncPort = m_vncPort;
+    guest.console = console ? m_serial->guestDevice() : QString();
+    guest.pinning = pinning;
+    guest.config = m_config;
+
+    // Состояние Running ставим ТОЛЬКО в сигнале started(): прослойка
+    // отчиталась pid'ом гостя
+    markPhase(VmPhase::Spawn);
+    m_guest->setDirectory(m_runtimeDir);
+    if (!m_guest->start(m_commands->resolveProgram("doas"), QStringList() << "bhyve" << args, guest)) {
+        onFailedToStart(m_guest->errorString());
+        return;
+    }
+
+    // tap создаёт сам bhyve при открытии /dev/tapN — ждём события, а не таймера
+    waitForTap();
+}
+
+void VmInstance::waitForTap()
+{
+    const QString tap = m_config.tap;
+    if (tap.isEmpty()) {
+        appendLog(LogSeverity::Warning, "[Bridge] tap-интерфейс не указан — добавление в bridge0 пропущено");
+        return;
+    }
+
+    m_network->cancel(m_tapWaitId);
+    const quint64 generation = m_generation;
+    m_tapWaitId = m_network->waitFor(tap, TapDeadlineMs, this, [this, generation, tap](bool ready, qint64 waitedMs) {
+        m_tapWaitId = 0;
+        // ВМ уже остановили или перезапустили, пока ждали tap
+        if (generation != m_generation || (m_state != State::Starting && m_state != State::Running))
+            return;
+        if (!ready) {
+            appendLog(LogSeverity::Error, QString("[Bridge] %1 не появился за %2 с — ВМ осталась без сети")
+                                              .arg(tap).arg(TapDeadlineMs / 1000));
+            return;
+        }
+        appendLog(LogSeverity::Notice, QString("[Bridge] %1 появился через %2 мс (%3)")
+                                           .arg(tap).arg(waitedMs).arg(m_network->backendName()));
+        markPhase(VmPhase::TapAttached, tap);
+        attachTapToBridge();
+    });
+}
+
+// Проверка участия и addm — через общий NetworkReconciler: запуски
+// нескольких ВМ подряд сливаются в один снимок и одну команду ifconfig
+void VmInstance::attachTapToBridge()
+{
+    const QString tap = m_config.tap;
+    const QString bridge = m_reconciler->bridge();
+    const quint64 generation = m_generation;
+
+    m_reconciler->attach(tap, this, [this, tap, bridge, generation](bool ok, bool changed, const QString &error) {
+        if (generation != m_generation)
+            return;
+        if (!ok) {
+            appendLog(LogSeverity::Error, "[Bridge] Ошибка добавления " + tap + " в " + bridge + ": " + error);
+            return;
+        }
+        if (changed)
+            appendLog(LogSeverity::Success, "[Bridge] " + tap + " успешно добавлен в " + bridge + " и поднят");
+        else
+            appendLog(LogSeverity::Success, "[Bridge] " + tap + " уже в " + bridge);
+        markNetworkReady();
+    });
+}
+
+void VmInstance::markNetworkReady()
+{
+    m_networkReadyMs = m_launchClock.elapsed();
+    m_networkReadyStats.record(m_networkReadyMs);
+    markPhase(VmPhase::BridgeJoined, m_config.tap);
+    appendLog(LogSeverity::Success, QString("[Сеть] Готова через %1 мс после запуска").arg(m_networkReadyMs));
+    emit changed();
+}
+
+// bhyvectl --destroy, затем удаление tap из моста через NetworkReconciler
+// (остановка нескольких ВМ даёт один deletem на всех), без блокировки GUI
+void VmInstance::teardown(const std::function<void()> &done)
+{
+    CommandSpec destroy = CommandSpec::doas({"bhyvectl", "--destroy", "--vm=" + m_config.name}, 8000);
+    const QString tap = m_config.tap;
+    const QString bridge = m_reconciler->bridge();
+
+    // После штатного выхода bhyve ВМ уже уничтожена — код bhyvectl не важен
+    m_commands->run(destroy, this, [this, tap, bridge, done](const CommandResult &) {
+        if (tap.isEmpty()) {
+            if (done)
+                done();
+            return;
+        }
+        m_reconciler->detach(tap, this, [this, tap, bridge, done](bool ok, bool changed, const QString &error) {
+            if (!ok)
+                appendLog(LogSeverity::Warning, "[Bridge] " + tap + " не удалён из " + bridge + ": " + error);
+            else if (changed)
+                appendLog(LogSeverity::Notice, "[Bridge] " + tap + " удалён из " + bridge);
+            if (done)
+                done();
+        });
+    });
+}
+
+// ======================== Обработчики завершения ========================
+void VmInstance::onFinished(int exitCode, bool crashed)
+{
+    m_network->cancel(m_tapWaitId);
+    m_stopTimer.stop();
+    m_log->flushPartial();
+    m_lastExitCode = exitCode;
+    if (crashed)
+        appendLog(LogSeverity::Error, "[ОШИБКА] bhyve аварийно завершился");
+    appendLog(LogSeverity::Error, "[Завершён] bhyve завершился (код: " + QString::number(exitCode) + ")");
+    markPhase(VmPhase::Finished, crashed ? QString("crash") : "код " + QString::number(exitCode));
+
+    // stop() сбрасывает m_shouldRestart — тогда код выхода уже не важен
+    const bool userStop = !m_shouldRestart;
+    const RestartTracker::ExitKind kind = RestartTracker::classify(exitCode, crashed);
+    RestartTracker::Decision decision;
+    if (userStop)
+        m_restarts.onStopped(m_uptimeClock.elapsed());
+    else
+        decision = m_restarts.onExit(kind, m_uptimeClock.elapsed());
+    m_shouldRestart = false;
+    setState(State::Stopping);
+
+    teardown([this, userStop, kind, decision]() {
+        markPhase(VmPhase::Destroyed);
+        finishStop();
+        if (userStop) {
+            setState(State::Stopped);
+            return;
+        }
+        if (!decision.restart) {
+            if (decision.crashLoop)
+                appendLog(LogSeverity::Error, "[Авторестарт] " + decision.reason);
+            else
+                appendLog(LogSeverity::Info, "Авторестарт не нужен: " + decision.reason + ".");
+            setState(kind == RestartTracker::ExitKind::Failure ? State::Failed : State::Stopped);
+            return;
+        }
+
+        appendLog(LogSeverity::Warning, QString("[Авторестарт] %1 — перезапуск через %2 с")
+                                            .arg(decision.reason)
+                                            .arg(decision.delayMs / 1000.0, 0, 'f', 1));
+        m_shouldRestart = true;
+        setState(State::Restarting);
+        m_restartTimer.start(decision.delayMs);
+    });
+}
+
+void VmInstance::onFailedToStart(const QString &error)
+{
+    appendLog(LogSeverity::Error, "[ОШИБКА] Не удалось запустить bhyve: " + error);
+    m_network->cancel(m_tapWaitId);
+    markPhase(VmPhase::Finished, error);
+    m_shouldRestart = false;
+    setState(State::Failed);
+}
+
+void VmInstance::setState(State state)
+{
+    if (m_state == state)
+        return;
+    m_state = state;
+    // bhyve не работает — его процессоры, память и порт экрана свободны для других ВМ
+    if (state == State::Stopped || state == State::Failed || state == State::Restarting) {
+        if (m_placer)
+            m_placer->release(m_config.name);
+        if (m_admission)
+            m_admission->release(m_config.name);
+        if (m_displayPorts)
+            m_displayPorts->release(m_config.name);
+        m_vncPort = 0;
+        m_serial->close();
+    }
+    emit stateChanged(state);
+    emit changed();
+}
+
+void VmInstance::appendLog(LogSeverity severity, const QString &text)
+{
+    m_log->append(severity, text);
+}
+
+void VmInstance::markPhase(VmPhase phase, const QString &detail)
+{
+    emit phaseReached(m_generation, phase, detail);
+}
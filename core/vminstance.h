@@ -0,0 +1,184 @@
+#ifndef VMINSTANCE_H
+#define VMINSTANCE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
+
+#include "vmconfig.h"
+#include "logbuffer.h"
+#include "latencyhistogram.h"
+#include "restarttracker.h"
+#include "eventjournal.h"
+#include "serialconsole.h"
+
+class CommandRunner;
+class InterfaceWatcher;
+class NetworkReconciler;
+class GuestProcess;
+class CpuPlacer;
+class MemoryAdmission;
+class DisplayPorts;
+
+// Одна ВМ под управлением VmSupervisor: свой процесс bhyve, свой лог,
+// явная машина состояний вместо пары флагов в MainWindow. bhyve живёт
+// отдельно от vmrun (GuestProcess) — reattach() подхватывает его после
+// перезапуска окна.
+//
+//   Stopped/Failed --start()--> Starting --started--> Running
+//   Running --finished, RestartPolicy велит--> Restarting --задержка--> Starting
+//   Running --stop()--> Stopping --finished--> Stopped
+//     (в Stopping ступени ShutdownPolicy сменяют друг друга по дедлайнам,
+//      очистка начинается сразу по finished)
+//   Starting/Running --ошибка запуска, сбой без перезапуска--> Failed
+//     (в Starting ВМ может ждать памяти в очереди MemoryAdmission — тогда
+//      stop() просто снимает её с очереди)
+class VmInstance : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class State {
+        Stopped,
+        Starting,
+        Running,
+        Stopping,
+        Restarting,
+        Failed
+    };
+    Q_ENUM(State)
+
+    enum class StopStage {
+        None,
+        PowerOff,
+        ForcePowerOff,
+        Kill,
+        Destroy
+    };
+    Q_ENUM(StopStage)
+
+    static constexpr int LogCapacity = 20000;
+    static constexpr int TapDeadlineMs = 30000;
+    static constexpr int NetSlot = 10;  // PCI-слот virtio-net
+
+    // PCI-слоты для count дисков по порядку: 3, 5–9, 11–14, 16–29 — мимо
+    // занятых hostbridge, ahci-cd, virtio-net, virtio-9p, fbuf и lpc.
+    // count == 0 — все доступные; дисков больше, чем слотов, — пустой список
+    static QVector<int> diskSlots(int count);
+
+    // MAC, который bhyve сам выдаёт virtio-net без mac=: net_genmac() —
+    // 58:9c:fc + первые три байта MD5("<слот>-<функция>-<имя ВМ>")
+    static QString guestMacAddress(const QString &vmName);
+
+    VmInstance(const VmConfig &config, CommandRunner *commands, InterfaceWatcher *network,
+               NetworkReconciler *reconciler, QObject *parent = nullptr);
+    ~VmInstance() override;
+
+    const VmConfig &config() const { return m_config; }
+    bool setConfig(const VmConfig &config);  // только для неактивной ВМ
+    QString name() const { return m_config.name; }
+
+    State state() const { return m_state; }
+    bool isActive() const { return m_state != State::Stopped && m_state != State::Failed; }
+    static QString stateName(State state);
+    static QString stopStageName(StopStage stage);
+
+    LogBuffer *log() const { return m_log; }
+    qint64 processId() const;
+    qint64 startedAtMs() const { return m_startedAtMs; }
+    int lastExitCode() const { return m_lastExitCode; }
+    int restartCount() const { return m_restarts.restarts(); }
+    const RestartTracker &restarts() const { return m_restarts; }
+
+    // От запуска bhyve до tap в bridge0; -1 — сеть ещё не готова
+    qint64 networkReadyMs() const { return m_networkReadyMs; }
+    const LatencyHistogram &networkReadyStats() const { return m_networkReadyStats; }
+
+    // От stop() до Stopped, включая очистку; -1 — ещё не останавливали
+    StopStage stopStage() const { return m_stopStage; }
+    qint64 lastStopMs() const { return m_lastStopMs; }
+    const LatencyHistogram &stopStats() const { return m_stopStats; }
+
+    // Каталог состояния гостей (GuestProcess); задаёт VmSupervisor
+    void setRuntimeDirectory(const QString &dir) { m_runtimeDir = dir; }
+    // true — при удалении объекта работающий гость остаётся жить
+    void setDetachOnDestroy(bool detach) { m_detachOnDestroy = detach; }
+    // Общая раскладка vCPU по хосту (VmSupervisor); без неё cpu.pin игнорируется
+    void setCpuPlacer(CpuPlacer *placer) { m_placer = placer; }
+    // Допуск по памяти хоста (VmSupervisor); без него запуск не проверяется
+    void setMemoryAdmission(MemoryAdmission *admission) { m_admission = admission; }
+    // VNC-порты гостей (VmSupervisor); без них — DisplayPorts::FirstPort
+    void setDisplayPorts(DisplayPorts *ports) { m_displayPorts = ports; }
+    // Порт экрана работающего гостя; 0 — ВМ не запущена
+    int vncPort() const { return m_vncPort; }
+    // com1 гостя: открыт, пока bhyve работает; история вывода остаётся и после
+    SerialConsole *serial() const { return m_serial; }
+    void setConsoleBackend(SerialConsole::Backend backend) { m_consoleBackend = backend; }
+    // Ждёт в очереди MemoryAdmission (состояние — Starting)
+    bool isWaitingForMemory() const { return m_waitingForMemory; }
+
+    void start();
+    // Подхватить гостя, оставленного прошлым запуском; false — его нет
+    bool reattach();
+    // Повторный вызов во время остановки сразу переходит к следующей ступени
+    void stop();
+
+signals:
+    void stateChanged(VmInstance::State state);
+    void changed();
+    // Отметка фазы для EventJournal; run — номер запуска
+    void phaseReached(quint64 run, VmPhase phase, const QString &detail);
+
+private:
+    void setState(State state);
+    void appendLog(LogSeverity severity, const QString &text);
+    void markPhase(VmPhase phase, const QString &detail = QString());
+    void launch();
+    void spawn();
+    void waitForTap();
+    void attachTapToBridge();
+    void markNetworkReady();
+    void advanceStop();
+    void finishStop();
+    void teardown(const std::function<void()> &done);
+    void onFinished(int exitCode, bool crashed);
+    void onFailedToStart(const QString &error);
+
+    VmConfig m_config;
+    CommandRunner *m_commands;
+    InterfaceWatcher *m_network;
+    NetworkReconciler *m_reconciler;
+    CpuPlacer *m_placer = nullptr;
+    MemoryAdmission *m_admission = nullptr;
+    DisplayPorts *m_displayPorts = nullptr;
+    int m_vncPort = 0;
+    SerialConsole *m_serial;
+    SerialConsole::Backend m_consoleBackend = SerialConsole::defaultBackend();
+    bool m_waitingForMemory = false;
+    GuestProcess *m_guest;
+    QString m_runtimeDir;
+    bool m_detachOnDestroy = false;
+    LogBuffer *m_log;
+    QTimer m_restartTimer;
+    QTimer m_stopTimer;
+    State m_state = State::Stopped;
+    bool m_shouldRestart = false;  // пользователь хочет, чтобы ВМ работала
+    qint64 m_startedAtMs = 0;
+    int m_lastExitCode = 0;
+    RestartTracker m_restarts;
+    quint64 m_generation = 0;  // номер запуска — отложенные действия не трогают следующий
+
+    QElapsedTimer m_launchClock;
+    QElapsedTimer m_uptimeClock;  // монотонное время для RestartTracker
+    quint64 m_tapWaitId = 0;
+    qint64 m_networkReadyMs = -1;
+    LatencyHistogram m_networkReadyStats;
+
+    StopStage m_stopStage = StopStage::None;
+    QElapsedTimer m_stopClock;
+    qint64 m_lastStopMs = -1;
+    LatencyHistogram m_stopStats;
+};
+
+#endif // VMINSTANCE_H
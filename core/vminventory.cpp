@@ -0,0 +1,301 @@
+#include "vminventory.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+const quint32 CacheMagic = 0x564d4958;  // "VMIX"
+const quint16 CacheVersion = 1;
+
+bool sameImage(const VmImageInfo &a, const VmImageInfo &b)
+{
+    return a.imagePath == b.imagePath && a.size == b.size && a.mtimeMs == b.mtimeMs;
+}
+}
+
+VmInventory::VmInventory(QObject *parent)
+    : QObject(parent)
+    , m_root(defaultRoot())
+    , m_cachePath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/vm-inventory.cache")
+{
+    // Серия событий (копирование образа, распаковка) — один проход сканера
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(300);
+    connect(&m_debounce, &QTimer::timeout, this, &VmInventory::startPendingScan);
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(2000);
+    connect(&m_saveTimer, &QTimer::timeout, this, &VmInventory::saveCache);
+
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &VmInventory::onDirectoryChanged);
+    connect(&m_scan, &QFutureWatcher<ScanResult>::finished, this, [this]() {
+        applyScan(m_scan.result());
+        emit scanFinished();
+        startPendingScan();
+    });
+}
+
+VmInventory::~VmInventory()
+{
+    if (m_saveTimer.isActive())
+        saveCache();
+}
+
+void VmInventory::setRoot(const QString &root)
+{
+    const QString cleaned = QDir::cleanPath(root);
+    if (cleaned == m_root)
+        return;
+
+    m_root = cleaned;
+    m_index.clear();
+    m_dirs.clear();
+    m_rootExists = true;
+    m_pendingDirs.clear();
+    updateWatchedDirs();
+    emit changed();
+}
+
+QVector<VmImageInfo> VmInventory::images() const
+{
+    QVector<VmImageInfo> list;
+    list.reserve(m_index.size());
+    for (const VmImageInfo &info : m_index)
+        list.append(info);
+    std::sort(list.begin(), list.end(), [](const VmImageInfo &a, const VmImageInfo &b) {
+        return QString::compare(a.name, b.name, Qt::CaseInsensitive) < 0;
+    });
+    return list;
+}
+
+QString VmInventory::imagePathFor(const QString &name) const
+{
+    return QDir(m_root).filePath(name + "/" + name + ".img");
+}
+
+bool VmInventory::isValidName(const QString &name)
+{
+    static const QRegularExpression re("^[A-Za-z0-9_][A-Za-z0-9._-]*$");
+    return re.match(name).hasMatch();
+}
+
+void VmInventory::resolveDisk(VmConfig &config) const
+{
+    if (contains(config.name) || config.diskPath.isEmpty())
+        config.diskPath = imagePathFor(config.name);
+    config.diskProfile = DiskProfile();
+    if (config.diskPath.startsWith(m_root + "/"))
+        config.diskProfile.device = DiskProfile::Device::VirtioBlk;
+}
+
+// ======================== Сканирование ========================
+void VmInventory::refresh()
+{
+    m_pendingList = true;
+    m_pendingStatAll = true;
+    startPendingScan();
+}
+
+void VmInventory::refreshVm(const QString &name)
+{
+    m_pendingDirs.insert(name);
+    m_debounce.start();
+}
+
+void VmInventory::onDirectoryChanged(const QString &path)
+{
+    // Изменился сам root — появились/исчезли каталоги ВМ; иначе — содержимое одной ВМ
+    if (QDir::cleanPath(path) == m_root)
+        m_pendingList = true;
+    else
+        m_pendingDirs.insert(QFileInfo(path).fileName());
+    m_debounce.start();
+}
+
+void VmInventory::startPendingScan()
+{
+    // Один проход за раз; всё, что накопилось, уйдёт следующим
+    if (m_scan.isRunning())
+        return;
+    if (!m_pendingList && m_pendingDirs.isEmpty())
+        return;
+
+    ScanRequest request;
+    request.root = m_root;
+    request.listRoot = m_pendingList;
+    request.statAll = m_pendingStatAll;
+    request.knownDirs = m_dirs;
+    request.statDirs = m_pendingDirs;
+
+    m_pendingList = false;
+    m_pendingStatAll = false;
+    m_pendingDirs.clear();
+
+    m_scan.setFuture(QtConcurrent::run(&VmInventory::scan, request));
+}
+
+// Выполняется в пуле потоков — только локальные данные, никаких членов класса
+VmInventory::ScanResult VmInventory::scan(const ScanRequest &request)
+{
+    ScanResult result;
+    result.root = request.root;
+
+    const QDir dir(request.root);
+    QSet<QString> toStat = request.statDirs;
+
+    if (request.listRoot) {
+        result.listed = true;
+        result.rootExists = dir.exists();
+        if (result.rootExists)
+            result.dirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        // Известные каталоги без явной причины не трогаем — это и есть инкрементальность
+        for (const QString &name : qAsConst(result.dirs)) {
+            if (request.statAll || !request.knownDirs.contains(name))
+                toStat.insert(name);
+        }
+    }
+
+    for (const QString &name : qAsConst(toStat)) {
+        result.statted.insert(name);
+        // Один QFileInfo — один stat() на ВМ
+        const QFileInfo info(dir.absoluteFilePath(name + "/" + name + ".img"));
+        if (!info.isFile())
+            continue;
+        VmImageInfo vm;
+        vm.name = name;
+        vm.imagePath = info.absoluteFilePath();
+        vm.size = info.size();
+        vm.mtimeMs = info.lastModified().toMSecsSinceEpoch();
+        result.found.insert(name, vm);
+    }
+    return result;
+}
+
+void VmInventory::applyScan(const ScanResult &result)
+{
+    m_statCount += quint64(result.statted.size());
+    if (result.root != m_root)
+        return;  // root сменили, пока шёл проход
+
+    bool dirty = false;
+    if (result.listed) {
+        dirty = m_rootExists != result.rootExists;
+        m_rootExists = result.rootExists;
+        m_dirs = QSet<QString>(result.dirs.begin(), result.dirs.end());
+        for (auto it = m_index.begin(); it != m_index.end();) {
+            if (!m_dirs.contains(it.key())) {
+                it = m_index.erase(it);
+                dirty = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (const QString &name : result.statted) {
+        const auto found = result.found.constFind(name);
+        if (found != result.found.constEnd()) {
+            m_dirs.insert(name);
+            auto current = m_index.find(name);
+            if (current == m_index.end() || !sameImage(*current, *found)) {
+                m_index.insert(name, *found);
+                dirty = true;
+            }
+        } else if (m_index.remove(name)) {
+            dirty = true;
+        }
+    }
+
+    if (result.listed)
+        updateWatchedDirs();
+    if (dirty) {
+        m_saveTimer.start();
+        emit changed();
+    }
+}
+
+void VmInventory::updateWatchedDirs()
+{
+    QSet<QString> wanted;
+    if (!m_root.isEmpty() && m_rootExists) {
+        wanted.insert(m_root);
+        for (const QString &name : qAsConst(m_dirs))
+            wanted.insert(m_root + "/" + name);
+    }
+
+    const QStringList watched = m_watcher.directories();
+    QStringList stale;
+    for (const QString &path : watched) {
+        if (!wanted.remove(path))
+            stale << path;
+    }
+    if (!stale.isEmpty())
+        m_watcher.removePaths(stale);
+    if (!wanted.isEmpty())
+        m_watcher.addPaths(wanted.values());
+}
+
+// ======================== Кэш на диске ========================
+bool VmInventory::loadCache()
+{
+    QFile file(m_cachePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString root;
+    QStringList dirs;
+    quint32 count = 0;
+    in >> magic >> version >> root >> dirs >> count;
+    if (magic != CacheMagic || version != CacheVersion || root != m_root || in.status() != QDataStream::Ok)
+        return false;
+
+    QHash<QString, VmImageInfo> index;
+    index.reserve(int(count));
+    for (quint32 i = 0; i < count; ++i) {
+        VmImageInfo vm;
+        in >> vm.name >> vm.size >> vm.mtimeMs;
+        vm.imagePath = imagePathFor(vm.name);
+        index.insert(vm.name, vm);
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    m_index = index;
+    m_dirs = QSet<QString>(dirs.begin(), dirs.end());
+    updateWatchedDirs();
+    emit changed();
+
+    // Кэш мог устареть, пока приложение было закрыто
+    refresh();
+    return true;
+}
+
+void VmInventory::saveCache()
+{
+    m_saveTimer.stop();
+    QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+
+    QSaveFile file(m_cachePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << CacheMagic << CacheVersion << m_root << m_dirs.values() << quint32(m_index.size());
+    for (const VmImageInfo &vm : qAsConst(m_index))
+        out << vm.name << vm.size << vm.mtimeMs;
+    file.commit();
+}
@@ -0,0 +1,115 @@
+#ifndef VMINVENTORY_H
+#define VMINVENTORY_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+
+#include "vmconfig.h"
+
+// Одна готовая ВМ в каталоге: <root>/<name>/<name>.img
+struct VmImageInfo {
+    QString name;
+    QString imagePath;
+    qint64 size = 0;
+    qint64 mtimeMs = 0;
+};
+
+// Индекс образов ВМ в памяти. Диск (NTFS через FUSE) трогается только
+// в фоновом потоке: при старте индекс поднимается из компактного кэша,
+// затем перепроверяется; изменения каталогов ловит QFileSystemWatcher,
+// и пересканируются только затронутые подкаталоги.
+class VmInventory : public QObject
+{
+    Q_OBJECT
+
+public:
+    static QString defaultRoot() { return "/ntfs-2TB/vm"; }
+
+    explicit VmInventory(QObject *parent = nullptr);
+    ~VmInventory() override;
+
+    QString root() const { return m_root; }
+    // Только меняет каталог и сбрасывает индекс; загрузку (loadCache() или
+    // refresh()) запускает вызывающий — CLI индекс целиком не нужен
+    void setRoot(const QString &root);
+
+    QString cachePath() const { return m_cachePath; }
+    void setCachePath(const QString &path) { m_cachePath = path; }
+    bool loadCache();
+
+    // Полная перепроверка (список каталогов + stat каждого образа) в фоне
+    void refresh();
+    // Точечная перепроверка одной ВМ (например, после её остановки)
+    void refreshVm(const QString &name);
+
+    bool isRootAvailable() const { return m_rootExists; }
+    bool isScanning() const { return m_scan.isRunning(); }
+    // Сколько каталогов ВМ проверено stat() с момента создания: точечный
+    // проход не должен трогать каталоги, которые не менялись
+    quint64 statCount() const { return m_statCount; }
+
+    QVector<VmImageInfo> images() const;  // по имени
+    bool contains(const QString &name) const { return m_index.contains(name); }
+    VmImageInfo image(const QString &name) const { return m_index.value(name); }
+    QString imagePathFor(const QString &name) const;
+    // Имя ВМ — это и каталог, и имя образа: латиница, цифры, '.', '_', '-'
+    static bool isValidName(const QString &name);
+
+    // Образ из каталога ВМ важнее явно указанного диска и подключается как
+    // virtio-blk; пустой diskPath тоже берётся из каталога. Сохранённый
+    // профиль диска (VmSettings::apply) перекрывает эту модель
+    void resolveDisk(VmConfig &config) const;
+
+signals:
+    void changed();
+    void scanFinished();
+
+private:
+    struct ScanRequest {
+        QString root;
+        bool listRoot = false;
+        bool statAll = false;
+        QSet<QString> knownDirs;
+        QSet<QString> statDirs;
+    };
+    struct ScanResult {
+        QString root;
+        bool listed = false;
+        bool rootExists = true;
+        QStringList dirs;
+        QSet<QString> statted;
+        QHash<QString, VmImageInfo> found;
+    };
+
+    static ScanResult scan(const ScanRequest &request);
+
+    void onDirectoryChanged(const QString &path);
+    void startPendingScan();
+    void applyScan(const ScanResult &result);
+    void updateWatchedDirs();
+    void saveCache();
+
+    QString m_root;
+    QString m_cachePath;
+    bool m_rootExists = true;
+    QHash<QString, VmImageInfo> m_index;
+    QSet<QString> m_dirs;  // все подкаталоги root, в том числе без образа
+    quint64 m_statCount = 0;
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounce;
+    QTimer m_saveTimer;
+    QFutureWatcher<ScanResult> m_scan;
+
+    // Накопленная работа для следующего прохода
+    bool m_pendingList = false;
+    bool m_pendingStatAll = false;
+    QSet<QString> m_pendingDirs;
+};
+
+#endif // VMINVENTORY_H
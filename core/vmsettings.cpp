@@ -0,0 +1,307 @@
+#include "vmsettings.h"
+#include "vminventory.h"
+#include "resourcesampler.h"
+#include "logarchive.h"
+#include "memoryadmission.h"
+#include "imageclone.h"
+#include "serialconsole.h"
+
+#include <QSettings>
+#include <QStandardPaths>
+
+namespace {
+
+QString groupFor(const QString &vmName, const QString &section)
+{
+    return "vms/" + vmName + "/" + section;
+}
+
+} // namespace
+
+namespace VmSettings {
+
+QString inventoryRoot()
+{
+    return QSettings().value("vm/root", VmInventory::defaultRoot()).toString();
+}
+
+void setInventoryRoot(const QString &root)
+{
+    QSettings().setValue("vm/root", root);
+}
+
+QStringList daemonVms()
+{
+    return QSettings().value("daemon/vms").toStringList();
+}
+
+int telemetryIntervalMs()
+{
+    return QSettings().value("telemetry/intervalMs", ResourceSampler::DefaultIntervalMs).toInt();
+}
+
+QString prometheusFile()
+{
+    return QSettings().value("telemetry/prometheusFile").toString();
+}
+
+QString journalFile()
+{
+    const QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journal.jsonl";
+    return QSettings().value("journal/file", defaultPath).toString();
+}
+
+QString consoleLogDir()
+{
+    const QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/console";
+    return QSettings().value("console/dir", defaultPath).toString();
+}
+
+qint64 consoleLogMaxFileBytes()
+{
+    return QSettings().value("console/maxFileMb", LogArchive::DefaultMaxFileBytes / (1024 * 1024)).toLongLong()
+           * 1024 * 1024;
+}
+
+int consoleLogMaxFiles()
+{
+    return QSettings().value("console/maxFiles", LogArchive::DefaultMaxFiles).toInt();
+}
+
+QString consoleBackend()
+{
+    return QSettings().value("console/backend", SerialConsole::backendName(SerialConsole::defaultBackend())).toString();
+}
+
+QString runtimeDir()
+{
+    // RuntimeLocation чистится при перезагрузке — вместе с гостями
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (defaultPath.isEmpty())
+        defaultPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/run";
+    else
+        defaultPath += "/vmrun";
+    return QSettings().value("runtime/dir", defaultPath).toString();
+}
+
+bool keepGuestsRunning()
+{
+    return QSettings().value("runtime/keepGuests", true).toBool();
+}
+
+QString controlSocket()
+{
+    return QSettings().value("control/socket", runtimeDir() + "/control.sock").toString();
+}
+
+int memoryReserveMb()
+{
+    return QSettings().value("memory/reserveMb", int(MemoryAdmission::DefaultReserveBytes >> 20)).toInt();
+}
+
+bool queueLaunchesForMemory()
+{
+    return QSettings().value("memory/queue", true).toBool();
+}
+
+int cloneParallel()
+{
+    return qMax(1, QSettings().value("clone/parallel", ImageCloner::DefaultParallel).toInt());
+}
+
+ShutdownPolicy loadShutdownPolicy(const QString &vmName)
+{
+    const ShutdownPolicy defaults;
+    ShutdownPolicy policy;
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "shutdown"));
+    policy.powerOffMs      = settings.value("powerOffMs", defaults.powerOffMs).toInt();
+    policy.forcePowerOffMs = settings.value("forcePowerOffMs", defaults.forcePowerOffMs).toInt();
+    policy.killMs          = settings.value("killMs", defaults.killMs).toInt();
+    policy.destroyMs       = settings.value("destroyMs", defaults.destroyMs).toInt();
+    settings.endGroup();
+    return policy;
+}
+
+void saveShutdownPolicy(const QString &vmName, const ShutdownPolicy &policy)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "shutdown"));
+    settings.setValue("powerOffMs", policy.powerOffMs);
+    settings.setValue("forcePowerOffMs", policy.forcePowerOffMs);
+    settings.setValue("killMs", policy.killMs);
+    settings.setValue("destroyMs", policy.destroyMs);
+    settings.endGroup();
+}
+
+RestartPolicy loadRestartPolicy(const QString &vmName)
+{
+    const RestartPolicy defaults;
+    RestartPolicy policy;
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "restart"));
+    policy.mode              = RestartPolicy::Mode(qBound(int(RestartPolicy::Never),
+                                                          settings.value("mode", int(defaults.mode)).toInt(),
+                                                          int(RestartPolicy::Always)));
+    policy.rebootDelayMs     = settings.value("rebootDelayMs", defaults.rebootDelayMs).toInt();
+    policy.initialBackoffMs  = settings.value("initialBackoffMs", defaults.initialBackoffMs).toInt();
+    policy.maxBackoffMs      = settings.value("maxBackoffMs", defaults.maxBackoffMs).toInt();
+    policy.jitterPercent     = settings.value("jitterPercent", defaults.jitterPercent).toInt();
+    policy.crashLoopFailures = settings.value("crashLoopFailures", defaults.crashLoopFailures).toInt();
+    policy.crashLoopWindowMs = settings.value("crashLoopWindowMs", defaults.crashLoopWindowMs).toInt();
+    policy.minUptimeMs       = settings.value("minUptimeMs", defaults.minUptimeMs).toInt();
+    settings.endGroup();
+    return policy;
+}
+
+void saveRestartPolicy(const QString &vmName, const RestartPolicy &policy)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "restart"));
+    settings.setValue("mode", int(policy.mode));
+    settings.setValue("rebootDelayMs", policy.rebootDelayMs);
+    settings.setValue("initialBackoffMs", policy.initialBackoffMs);
+    settings.setValue("maxBackoffMs", policy.maxBackoffMs);
+    settings.setValue("jitterPercent", policy.jitterPercent);
+    settings.setValue("crashLoopFailures", policy.crashLoopFailures);
+    settings.setValue("crashLoopWindowMs", policy.crashLoopWindowMs);
+    settings.setValue("minUptimeMs", policy.minUptimeMs);
+    settings.endGroup();
+}
+
+CpuConfig loadCpuConfig(const QString &vmName)
+{
+    const CpuConfig defaults;
+    CpuConfig cpu;
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "cpu"));
+    cpu.vcpus   = settings.value("vcpus", defaults.vcpus).toInt();
+    cpu.sockets = settings.value("sockets", defaults.sockets).toInt();
+    cpu.cores   = settings.value("cores", defaults.cores).toInt();
+    cpu.threads = settings.value("threads", defaults.threads).toInt();
+    cpu.pin     = settings.value("pin", defaults.pin).toBool();
+    settings.endGroup();
+    // Испорченная запись — один vCPU, как было до настройки
+    return cpu.normalize() ? cpu : defaults;
+}
+
+void saveCpuConfig(const QString &vmName, const CpuConfig &cpu)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "cpu"));
+    settings.setValue("vcpus", cpu.vcpus);
+    settings.setValue("sockets", cpu.sockets);
+    settings.setValue("cores", cpu.cores);
+    settings.setValue("threads", cpu.threads);
+    settings.setValue("pin", cpu.pin);
+    settings.endGroup();
+}
+
+bool loadDiskProfile(const QString &vmName, DiskProfile *profile)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "disks"));
+    const QString text = settings.value("profile").toString();
+    settings.endGroup();
+    // Испорченная запись — как будто профиль не задан
+    return !text.isEmpty() && DiskProfile::parse(text, profile);
+}
+
+void saveDiskProfile(const QString &vmName, const DiskProfile *profile)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "disks"));
+    if (profile)
+        settings.setValue("profile", profile->toString());
+    else
+        settings.remove("profile");
+    settings.endGroup();
+}
+
+QVector<DiskConfig> loadExtraDisks(const QString &vmName)
+{
+    QVector<DiskConfig> disks;
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "disks"));
+    const int count = settings.beginReadArray("extra");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        DiskConfig disk;
+        disk.path = settings.value("path").toString();
+        if (disk.path.isEmpty() || !DiskProfile::parse(settings.value("profile").toString(), &disk.profile))
+            continue;
+        disks.append(disk);
+    }
+    settings.endArray();
+    settings.endGroup();
+    return disks;
+}
+
+void saveExtraDisks(const QString &vmName, const QVector<DiskConfig> &disks)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "disks"));
+    settings.remove("extra");
+    settings.beginWriteArray("extra", disks.size());
+    for (int i = 0; i < disks.size(); ++i) {
+        settings.setArrayIndex(i);
+        settings.setValue("path", disks[i].path);
+        settings.setValue("profile", disks[i].profile.toString());
+    }
+    settings.endArray();
+    settings.endGroup();
+}
+
+int loadVncPort(const QString &vmName)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "display"));
+    const int port = settings.value("vncPort", 0).toInt();
+    settings.endGroup();
+    return port > 0 && port < 65536 ? port : 0;
+}
+
+void saveVncPort(const QString &vmName, int port)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(vmName, "display"));
+    if (port > 0)
+        settings.setValue("vncPort", port);
+    else
+        settings.remove("vncPort");
+    settings.endGroup();
+}
+
+void saveLaunch(const VmConfig &config)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(config.name, "launch"));
+    settings.setValue("memory", config.memory);
+    settings.setValue("isoPath", config.isoPath);
+    settings.endGroup();
+}
+
+void loadLaunch(VmConfig &config)
+{
+    QSettings settings;
+    settings.beginGroup(groupFor(config.name, "launch"));
+    if (config.memory.isEmpty())
+        config.memory = settings.value("memory").toString();
+    if (config.isoPath.isEmpty())
+        config.isoPath = settings.value("isoPath").toString();
+    settings.endGroup();
+}
+
+void apply(VmConfig &config)
+{
+    if (config.name.isEmpty())
+        return;
+    config.shutdown = loadShutdownPolicy(config.name);
+    config.restart = loadRestartPolicy(config.name);
+    config.cpu = loadCpuConfig(config.name);
+    loadDiskProfile(config.name, &config.diskProfile);
+    config.extraDisks = loadExtraDisks(config.name);
+    config.vncPort = loadVncPort(config.name);
+}
+
+} // namespace VmSettings
@@ -0,0 +1,80 @@
+#ifndef VMSETTINGS_H
+#define VMSETTINGS_H
+
+#include <QString>
+#include <QStringList>
+
+#include "vmconfig.h"
+
+// Настройки отдельных ВМ, которых нет в форме запуска. Хранятся в QSettings
+// в группе "vms/<имя>/..." и подмешиваются в VmConfig перед стартом.
+namespace VmSettings {
+
+// Каталог с образами ВМ (общий для GUI и vmrun)
+QString inventoryRoot();
+void setInventoryRoot(const QString &root);
+
+// ВМ, которые "vmrun daemon" поднимает без аргументов
+QStringList daemonVms();
+
+// Телеметрия: период замеров и файл для Prometheus (пусто — не писать)
+int telemetryIntervalMs();
+QString prometheusFile();
+
+// Журнал событий ВМ (JSON lines); пустая строка — не писать
+QString journalFile();
+
+// Архив консоли ВМ: каталог (пусто — не писать), размер файла и число файлов на ВМ
+QString consoleLogDir();
+qint64 consoleLogMaxFileBytes();
+int consoleLogMaxFiles();
+// Чем подключать com1 гостя: "nmdm" или "pty" (SerialConsole)
+QString consoleBackend();
+
+// Каталог состояния гостей, переживших окно (pid, tap, вывод bhyve), и
+// оставлять ли их работать при закрытии GUI
+QString runtimeDir();
+bool keepGuestsRunning();
+
+// Сокет API управления (ControlServer) — в каталоге состояния гостей;
+// пустая строка — не слушать
+QString controlSocket();
+
+// Допуск запусков по памяти: сколько МБ оставить хосту и ждать ли памяти
+// (false — сразу отказ)
+int memoryReserveMb();
+bool queueLaunchesForMemory();
+
+// Клонирование образов: сколько копий одновременно на одном устройстве
+int cloneParallel();
+
+ShutdownPolicy loadShutdownPolicy(const QString &vmName);
+void saveShutdownPolicy(const QString &vmName, const ShutdownPolicy &policy);
+
+RestartPolicy loadRestartPolicy(const QString &vmName);
+void saveRestartPolicy(const QString &vmName, const RestartPolicy &policy);
+
+CpuConfig loadCpuConfig(const QString &vmName);
+void saveCpuConfig(const QString &vmName, const CpuConfig &cpu);
+
+// Диски ВМ: профиль загрузочного диска (false — не задан, модель
+// выбирает VmInventory::resolveDisk) и дополнительные диски
+bool loadDiskProfile(const QString &vmName, DiskProfile *profile);
+void saveDiskProfile(const QString &vmName, const DiskProfile *profile);  // nullptr — сбросить
+QVector<DiskConfig> loadExtraDisks(const QString &vmName);
+void saveExtraDisks(const QString &vmName, const QVector<DiskConfig> &disks);
+
+// Постоянный VNC-порт ВМ; 0 — выдаётся автоматически при запуске
+int loadVncPort(const QString &vmName);
+void saveVncPort(const QString &vmName, int port);
+
+// Память и ISO последнего запуска — чтобы CLI/демон поднимали ВМ по имени
+void saveLaunch(const VmConfig &config);
+void loadLaunch(VmConfig &config);
+
+// Дополняет config сохранёнными настройками ВМ config.name
+void apply(VmConfig &config);
+
+} // namespace VmSettings
+
+#endif // VMSETTINGS_H
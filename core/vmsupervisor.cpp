@@ -0,0 +1,230 @@
+#include "vmsupervisor.h"
+#include "vminstance.h"
+#include "commandrunner.h"
+#include "interfacewatcher.h"
+#include "networkreconciler.h"
+#include "resourcesampler.h"
+#include "eventjournal.h"
+#include "logarchive.h"
+#include "guestprocess.h"
+#include "memoryadmission.h"
+#include "vmsettings.h"
+
+#include <QFileInfo>
+#include <QSet>
+
+VmSupervisor::VmSupervisor(QObject *parent)
+    : QObject(parent)
+    , m_commands(new CommandRunner(this))
+    , m_network(InterfaceWatcher::create(this))
+    , m_reconciler(new NetworkReconciler(m_commands, this))
+    , m_sampler(new ResourceSampler(this))
+    , m_journal(new EventJournal(this))
+    , m_archive(new LogArchive(this))
+    , m_admission(new MemoryAdmission(this))
+{
+    m_sampler->setInterval(VmSettings::telemetryIntervalMs());
+    m_sampler->setPrometheusFile(VmSettings::prometheusFile());
+    m_journal->setFile(VmSettings::journalFile());
+    m_archive->setLimits(VmSettings::consoleLogMaxFileBytes(), VmSettings::consoleLogMaxFiles());
+    m_archive->setDirectory(VmSettings::consoleLogDir());
+    m_runtimeDir = VmSettings::runtimeDir();
+    m_placer.setHost(HostTopology::detect());
+    m_admission->setReserveBytes(quint64(VmSettings::memoryReserveMb()) << 20);
+    m_admission->setQueueing(VmSettings::queueLaunchesForMemory());
+    SerialConsole::parseBackend(VmSettings::consoleBackend(), &m_consoleBackend);
+}
+
+VmSupervisor::~VmSupervisor()
+{
+    // Архив забирает последние строки, пока буферы логов ещё живы
+    delete m_archive;
+    m_archive = nullptr;
+    // ВМ удаляем раньше CommandRunner: их деструкторы ещё запускают bhyvectl
+    // (или отпускают гостей, если m_keepGuests)
+    qDeleteAll(m_instances);
+    m_instances.clear();
+    m_byName.clear();
+}
+
+int VmSupervisor::indexOf(const QString &name) const
+{
+    VmInstance *vm = m_byName.value(name);
+    return vm ? m_instances.indexOf(vm) : -1;
+}
+
+VmInstance *VmSupervisor::instance(const QString &name) const
+{
+    return m_byName.value(name);
+}
+
+int VmSupervisor::activeCount() const
+{
+    int n = 0;
+    for (VmInstance *vm : m_instances)
+        n += vm->isActive() ? 1 : 0;
+    return n;
+}
+
+VmInstance *VmSupervisor::ensureInstance(const VmConfig &config)
+{
+    if (VmInstance *existing = m_byName.value(config.name)) {
+        if (existing->isActive())
+            return nullptr;
+        existing->setConfig(config);
+        return existing;
+    }
+
+    auto *vm = new VmInstance(config, m_commands, m_network, m_reconciler, this);
+    vm->setRuntimeDirectory(m_runtimeDir);
+    vm->setDetachOnDestroy(m_keepGuests);
+    vm->setCpuPlacer(&m_placer);
+    vm->setMemoryAdmission(m_admission);
+    vm->setDisplayPorts(&m_displayPorts);
+    vm->setConsoleBackend(m_consoleBackend);
+    m_archive->follow(config.name, vm->log());
+    // Замеры — только пока процесс bhyve жив
+    connect(vm, &VmInstance::stateChanged, this, [this, vm](VmInstance::State state) {
+        if (state == VmInstance::State::Running && vm->processId() > 0)
+            m_sampler->track(vm->name(), vm->processId());
+        else if (state != VmInstance::State::Stopping)
+            m_sampler->untrack(vm->name());
+    });
+    connect(vm, &VmInstance::phaseReached, this, [this, vm](quint64 run, VmPhase phase, const QString &detail) {
+        m_journal->record(vm->name(), run, phase, detail);
+    });
+    // Строку ищем по указателю в момент сигнала — индексы сдвигаются при remove()
+    connect(vm, &VmInstance::changed, this, [this, vm]() {
+        const int row = m_instances.indexOf(vm);
+        if (row >= 0)
+            emit instanceChanged(row);
+        if (m_stoppingAll > 0 && activeCount() == 0) {
+            const int stopped = m_stoppingAll;
+            m_stoppingAll = 0;
+            emit allStopped(stopped, m_stopAllClock.elapsed());
+        }
+    });
+
+    m_instances.append(vm);
+    m_byName.insert(config.name, vm);
+    emit instanceAdded(m_instances.size() - 1);
+    return vm;
+}
+
+bool VmSupervisor::remove(const QString &name)
+{
+    VmInstance *vm = m_byName.value(name);
+    if (!vm || vm->isActive())
+        return false;
+
+    const int row = m_instances.indexOf(vm);
+    emit instanceAboutToBeRemoved(row);
+    m_instances.remove(row);
+    m_byName.remove(name);
+    m_sampler->forget(name);
+    vm->deleteLater();
+    emit instanceRemoved(row);
+    return true;
+}
+
+void VmSupervisor::setRuntimeDirectory(const QString &dir)
+{
+    m_runtimeDir = dir;
+    for (VmInstance *vm : qAsConst(m_instances))
+        vm->setRuntimeDirectory(dir);
+}
+
+void VmSupervisor::setKeepGuestsRunning(bool keep)
+{
+    m_keepGuests = keep;
+    for (VmInstance *vm : qAsConst(m_instances))
+        vm->setDetachOnDestroy(keep);
+}
+
+void VmSupervisor::setConsoleBackend(SerialConsole::Backend backend)
+{
+    m_consoleBackend = backend;
+    for (VmInstance *vm : qAsConst(m_instances))
+        vm->setConsoleBackend(backend);
+}
+
+QStringList VmSupervisor::reattachGuests()
+{
+    QStringList names;
+    for (const QString &path : GuestProcess::stateFiles(m_runtimeDir)) {
+        GuestState state;
+        if (!GuestProcess::readState(path, &state))
+            continue;
+        // Гость прошлой загрузки хоста: ни ВМ, ни сбоя, ни авторестарта —
+        // только убрать его файлы
+        if (state.isStale()) {
+            GuestProcess::discardState(m_runtimeDir, QFileInfo(path).completeBaseName());
+            continue;
+        }
+        VmConfig config = state.config;
+        VmSettings::apply(config);
+        // Процессоры и диски — как у работающего гостя, настройки вступят
+        // со следующего запуска (порт экрана VmInstance::reattach() берёт сам)
+        config.cpu = state.config.cpu;
+        config.diskProfile = state.config.diskProfile;
+        config.extraDisks = state.config.extraDisks;
+        VmInstance *vm = ensureInstance(config);
+        if (vm && vm->reattach())
+            names << config.name;
+    }
+    return names;
+}
+
+QSet<QString> VmSupervisor::expectedTaps() const
+{
+    QSet<QString> taps;
+    for (VmInstance *vm : m_instances) {
+        if (vm->isActive() && !vm->config().tap.isEmpty())
+            taps.insert(vm->config().tap);
+    }
+    return taps;
+}
+
+QString VmSupervisor::allocateTap() const
+{
+    QSet<QString> used;
+    for (VmInstance *vm : m_instances) {
+        if (vm->isActive())
+            used.insert(vm->config().tap);
+    }
+    for (int i = 0;; ++i) {
+        const QString tap = QString("tap%1").arg(i);
+        if (!used.contains(tap))
+            return tap;
+    }
+}
+
+int VmSupervisor::stopAll()
+{
+    // Каждая ВМ эскалирует по своим дедлайнам, ждать друг друга им незачем
+    int stopping = 0;
+    for (VmInstance *vm : m_instances) {
+        if (vm->isActive()) {
+            ++stopping;
+            vm->stop();
+        }
+    }
+    if (stopping > 0 && m_stoppingAll == 0)
+        m_stopAllClock.start();
+    m_stoppingAll += stopping;
+    // Все были в ожидании авторестарта и остановились сразу
+    if (m_stoppingAll > 0 && activeCount() == 0) {
+        const int stopped = m_stoppingAll;
+        m_stoppingAll = 0;
+        emit allStopped(stopped, m_stopAllClock.elapsed());
+    }
+    return stopping;
+}
+
+LatencyHistogram VmSupervisor::stopStats() const
+{
+    LatencyHistogram total;
+    for (VmInstance *vm : m_instances)
+        total.merge(vm->stopStats());
+    return total;
+}
@@ -0,0 +1,118 @@
+#ifndef VMSUPERVISOR_H
+#define VMSUPERVISOR_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+
+#include "vmconfig.h"
+#include "latencyhistogram.h"
+#include "cputopology.h"
+#include "displayports.h"
+#include "serialconsole.h"
+
+class CommandRunner;
+class EventJournal;
+class LogArchive;
+class MemoryAdmission;
+class InterfaceWatcher;
+class NetworkReconciler;
+class ResourceSampler;
+class VmInstance;
+
+// Владелец всех ВМ: по одному VmInstance на имя, общие CommandRunner,
+// InterfaceWatcher, NetworkReconciler (tap'ы и участники bridge0 всех ВМ),
+// ResourceSampler (работающие ВМ отслеживаются сами), CpuPlacer (vCPU
+// закреплённых ВМ раскладываются по процессорам хоста с оглядкой на соседей),
+// MemoryAdmission (запуск, которому не хватит памяти хоста, ждёт или отклоняется),
+// DisplayPorts (у каждой работающей ВМ свой VNC-порт),
+// SerialConsole (com1 каждой ВМ — через nmdm или pty, см. setConsoleBackend),
+// EventJournal (фазы всех ВМ пишутся в него) и LogArchive (лог каждой ВМ —
+// ещё и на диск).
+// Порядок instances() стабилен — на нём строится табличная модель.
+class VmSupervisor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VmSupervisor(QObject *parent = nullptr);
+    ~VmSupervisor() override;
+
+    CommandRunner *commands() const { return m_commands; }
+    InterfaceWatcher *network() const { return m_network; }
+    NetworkReconciler *reconciler() const { return m_reconciler; }
+    ResourceSampler *sampler() const { return m_sampler; }
+    EventJournal *journal() const { return m_journal; }
+    LogArchive *archive() const { return m_archive; }
+    CpuPlacer *cpuPlacer() { return &m_placer; }
+    MemoryAdmission *memoryAdmission() const { return m_admission; }
+    DisplayPorts *displayPorts() { return &m_displayPorts; }
+
+    int count() const { return m_instances.size(); }
+    VmInstance *at(int row) const { return m_instances.value(row); }
+    int indexOf(const QString &name) const;
+    VmInstance *instance(const QString &name) const;
+    const QVector<VmInstance *> &instances() const { return m_instances; }
+    int activeCount() const;
+
+    // Создаёт ВМ или обновляет конфигурацию остановленной; nullptr — если ВМ
+    // с этим именем сейчас работает и конфигурацию менять нельзя
+    VmInstance *ensureInstance(const VmConfig &config);
+    bool remove(const QString &name);
+
+    // tap'ы активных ВМ — их NetworkReconciler::cleanup() не трогает
+    QSet<QString> expectedTaps() const;
+
+    // Каталог состояния гостей: bhyve живёт отдельно от vmrun, его pid,
+    // tap, порт VNC и вывод лежат там (GuestProcess)
+    void setRuntimeDirectory(const QString &dir);
+    QString runtimeDirectory() const { return m_runtimeDir; }
+    // true — при удалении supervisor'а гости работают дальше (окно GUI),
+    // false — гасятся, как раньше (CLI, bench)
+    void setKeepGuestsRunning(bool keep);
+    bool keepGuestsRunning() const { return m_keepGuests; }
+    // Чем подключать com1 гостей при следующих запусках (по умолчанию — из VmSettings)
+    void setConsoleBackend(SerialConsole::Backend backend);
+    SerialConsole::Backend consoleBackend() const { return m_consoleBackend; }
+    // Подхватывает гостей, оставленных прошлым запуском; имена подхваченных
+    QStringList reattachGuests();
+
+    // Свободный tapN, не занятый ни одной ВМ под наблюдением
+    QString allocateTap() const;
+
+    // Останавливает все активные ВМ параллельно; allStopped() — когда
+    // последняя дошла до Stopped/Failed. Возвращает число остановленных.
+    int stopAll();
+
+    // Задержки остановки всех ВМ под наблюдением, одной гистограммой
+    LatencyHistogram stopStats() const;
+
+signals:
+    void instanceAdded(int row);
+    void instanceAboutToBeRemoved(int row);
+    void instanceRemoved(int row);
+    void instanceChanged(int row);
+    void allStopped(int count, qint64 elapsedMs);
+
+private:
+    CommandRunner *m_commands;
+    InterfaceWatcher *m_network;
+    NetworkReconciler *m_reconciler;
+    ResourceSampler *m_sampler;
+    EventJournal *m_journal;
+    LogArchive *m_archive;
+    CpuPlacer m_placer;
+    MemoryAdmission *m_admission;
+    DisplayPorts m_displayPorts;
+    QVector<VmInstance *> m_instances;
+    QHash<QString, VmInstance *> m_byName;
+    QString m_runtimeDir;
+    bool m_keepGuests = false;
+    SerialConsole::Backend m_consoleBackend = SerialConsole::defaultBackend();
+    int m_stoppingAll = 0;  // сколько ВМ ушло в stopAll(); 0 — не ждём
+    QElapsedTimer m_stopAllClock;
+};
+
+#endif // VMSUPERVISOR_H
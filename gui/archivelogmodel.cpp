@@ -0,0 +1,80 @@
+#include "archivelogmodel.h"
+
+#include <QColor>
+#include <QFont>
+#include <limits>
+
+ArchiveLogModel::ArchiveLogModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+bool ArchiveLogModel::open(const QString &vmDir, QString *error)
+{
+    beginResetModel();
+    const bool ok = m_reader.open(vmDir, error);
+    // Больше INT_MAX строк QListView не покажет — это ~100 ГБ лога
+    m_rows = int(qMin<qint64>(m_reader.lineCount(), std::numeric_limits<int>::max()));
+    m_cachedRow = -1;
+    m_cachedLine.clear();
+    endResetModel();
+    return ok;
+}
+
+int ArchiveLogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+const QByteArray &ArchiveLogModel::lineAt(int row) const
+{
+    if (row != m_cachedRow) {
+        m_cachedRow = row;
+        m_cachedLine = m_reader.line(row);
+    }
+    return m_cachedLine;
+}
+
+QVariant ArchiveLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows)
+        return QVariant();
+
+    const QByteArray &line = lineAt(index.row());
+    // "дата время X текст": без буквы уровня, как в окне лога
+    const char tag = line.size() > LogArchive::TimestampLength + 1 ? line.at(LogArchive::TimestampLength + 1) : 'I';
+
+    switch (role) {
+    case Qt::DisplayRole: {
+        if (line.size() < LogArchive::TextOffset)
+            return QString::fromUtf8(line);
+        const QString time = QString::fromLatin1(line.constData(), LogArchive::TimestampLength);
+        const QString text = QString::fromUtf8(line.constData() + LogArchive::TextOffset,
+                                               line.size() - LogArchive::TextOffset);
+        if (tag == 'R')
+            return time + " [ERR] " + text;
+        return tag == 'T' ? time + " [COM1] " + text : time + ' ' + text;
+    }
+    case Qt::ForegroundRole:
+        switch (tag) {
+        case 'N': return QColor(Qt::blue);
+        case 'C': return QColor("#ff79c6");
+        case 'S': return QColor("#2e7d32");
+        case 'W': return QColor("orange");
+        case 'E':
+        case 'R': return QColor(Qt::red);
+        case 'O': return QColor(Qt::darkGreen);
+        case 'T': return QColor(Qt::darkCyan);
+        default:  return QVariant();
+        }
+    case Qt::FontRole:
+        if (tag == 'C' || tag == 'E') {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
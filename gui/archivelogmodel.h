@@ -0,0 +1,34 @@
+#ifndef ARCHIVELOGMODEL_H
+#define ARCHIVELOGMODEL_H
+
+#include <QAbstractListModel>
+
+#include "logarchive.h"
+
+// Архив консоли ВМ для QListView (uniformItemSizes): строки читаются из
+// отображённых в память файлов только тогда, когда вид их рисует.
+// Снимок берётся в open(); свежие строки — повторным open().
+class ArchiveLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit ArchiveLogModel(QObject *parent = nullptr);
+
+    bool open(const QString &vmDir, QString *error = nullptr);
+    const LogArchiveReader &reader() const { return m_reader; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    const QByteArray &lineAt(int row) const;
+
+    LogArchiveReader m_reader;
+    int m_rows = 0;
+    // Вид спрашивает одну строку несколькими ролями подряд
+    mutable int m_cachedRow = -1;
+    mutable QByteArray m_cachedLine;
+};
+
+#endif // ARCHIVELOGMODEL_H
@@ -0,0 +1,142 @@
+#include "arpresultsmodel.h"
+
+#include <QColor>
+#include <QFont>
+
+ArpResultsModel::ArpResultsModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int ArpResultsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_entries.size();
+}
+
+int ArpResultsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ArpResultsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_entries.size())
+        return QVariant();
+
+    const ArpEntry &entry = m_entries.at(index.row());
+    const QString vm = m_vmByMac.value(entry.mac);
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case IpColumn:     return entry.ip;
+        case MacColumn:    return entry.mac;
+        case VendorColumn: return entry.duplicate ? entry.vendor + " (DUP)" : entry.vendor;
+        case VmColumn:     return vm;
+        default:           return QVariant();
+        }
+    case SortRole:
+        // IP сортируем численно, иначе 10.0.0.10 окажется перед 10.0.0.9
+        if (index.column() == IpColumn)
+            return entry.ipValue;
+        return data(index, Qt::DisplayRole).toString().toLower();
+    case Qt::ForegroundRole:
+        if (index.column() == IpColumn)
+            return QColor("#2e7d32");
+        if (entry.duplicate)
+            return QColor(Qt::red);
+        break;
+    case Qt::FontRole:
+        if (!vm.isEmpty()) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        break;
+    case Qt::ToolTipRole:
+        if (!vm.isEmpty())
+            return "virtio-net ВМ " + vm;
+        break;
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+QVariant ArpResultsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (section) {
+    case IpColumn:     return "IP";
+    case MacColumn:    return "MAC";
+    case VendorColumn: return "Производитель";
+    case VmColumn:     return "ВМ";
+    default:           return QVariant();
+    }
+}
+
+void ArpResultsModel::clear()
+{
+    beginResetModel();
+    m_entries.clear();
+    m_rowByKey.clear();
+    endResetModel();
+}
+
+void ArpResultsModel::addEntries(const QVector<ArpEntry> &entries)
+{
+    QVector<ArpEntry> fresh;
+    fresh.reserve(entries.size());
+    for (const ArpEntry &entry : entries) {
+        const QString key = entry.ip + '/' + entry.mac;
+        const int existing = m_rowByKey.value(key, -1);
+        if (existing >= 0) {
+            // Повторный ответ того же узла: только отмечаем DUP
+            if (entry.duplicate && !m_entries[existing].duplicate) {
+                m_entries[existing].duplicate = true;
+                emit dataChanged(index(existing, 0), index(existing, ColumnCount - 1));
+            }
+            continue;
+        }
+        m_rowByKey.insert(key, m_entries.size() + fresh.size());
+        fresh.append(entry);
+    }
+    if (fresh.isEmpty())
+        return;
+
+    // Одна вставка на кусок вывода, а не на строку
+    const int first = m_entries.size();
+    beginInsertRows(QModelIndex(), first, first + fresh.size() - 1);
+    m_entries += fresh;
+    endInsertRows();
+}
+
+void ArpResultsModel::setVmMacs(const QHash<QString, QString> &vmByMac)
+{
+    m_vmByMac = vmByMac;
+    if (!m_entries.isEmpty())
+        emit dataChanged(index(0, 0), index(m_entries.size() - 1, ColumnCount - 1));
+}
+
+int ArpResultsModel::vmMatchCount() const
+{
+    int n = 0;
+    for (const ArpEntry &entry : m_entries)
+        n += m_vmByMac.contains(entry.mac) ? 1 : 0;
+    return n;
+}
+
+QString ArpResultsModel::toText() const
+{
+    QString text;
+    for (const ArpEntry &entry : m_entries) {
+        text += entry.ip + '\t' + entry.mac + '\t' + entry.vendor;
+        const QString vm = m_vmByMac.value(entry.mac);
+        if (!vm.isEmpty())
+            text += "\tВМ " + vm;
+        text += '\n';
+    }
+    return text;
+}
@@ -0,0 +1,52 @@
+#ifndef ARPRESULTSMODEL_H
+#define ARPRESULTSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QVector>
+
+#include "arpscanparser.h"
+
+// Результаты arp-scan для живой таблицы: записи добавляются пачками по мере
+// прихода вывода, повторы (IP+MAC) не плодят строк. MAC сверяется с
+// virtio-net наших ВМ — колонка "ВМ". Сортировка и фильтр — через
+// QSortFilterProxyModel с SortRole.
+class ArpResultsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        IpColumn,
+        MacColumn,
+        VendorColumn,
+        VmColumn,
+        ColumnCount
+    };
+
+    static constexpr int SortRole = Qt::UserRole;
+
+    explicit ArpResultsModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void clear();
+    void addEntries(const QVector<ArpEntry> &entries);
+
+    // MAC (нижний регистр) → имя ВМ
+    void setVmMacs(const QHash<QString, QString> &vmByMac);
+    int vmMatchCount() const;
+
+    // Все строки в порядке поступления, через табуляцию — для буфера обмена
+    QString toText() const;
+
+private:
+    QVector<ArpEntry> m_entries;
+    QHash<QString, int> m_rowByKey;  // ip + '/' + mac
+    QHash<QString, QString> m_vmByMac;
+};
+
+#endif // ARPRESULTSMODEL_H
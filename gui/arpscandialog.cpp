@@ -0,0 +1,133 @@
+#include "arpscandialog.h"
+#include "arpresultsmodel.h"
+#include "commandrunner.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QProcess>
+#include <QPushButton>
+#include <QSortFilterProxyModel>
+#include <QTableView>
+#include <QVBoxLayout>
+
+ArpScanDialog::ArpScanDialog(CommandRunner *commands, QWidget *parent)
+    : QDialog(parent)
+    , m_commands(commands)
+    , m_model(new ArpResultsModel(this))
+    , m_proxy(new QSortFilterProxyModel(this))
+    , m_status(new QLabel(this))
+{
+    setWindowTitle("Сканирование сети — arp-scan --localnet");
+    resize(800, 600);
+    setModal(false);
+
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setSortRole(ArpResultsModel::SortRole);
+    m_proxy->setFilterKeyColumn(-1);  // фильтр по всем колонкам
+    m_proxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    m_proxy->setDynamicSortFilter(true);
+
+    auto *layout = new QVBoxLayout(this);
+    auto *filterEdit = new QLineEdit(this);
+    filterEdit->setPlaceholderText("Фильтр: IP, MAC, производитель или имя ВМ");
+    filterEdit->setClearButtonEnabled(true);
+    layout->addWidget(filterEdit);
+
+    auto *table = new QTableView(this);
+    table->setModel(m_proxy);
+    table->setSortingEnabled(true);
+    table->sortByColumn(ArpResultsModel::IpColumn, Qt::AscendingOrder);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->verticalHeader()->setVisible(false);
+    table->verticalHeader()->setDefaultSectionSize(22);
+    table->setColumnWidth(ArpResultsModel::IpColumn, 130);
+    table->setColumnWidth(ArpResultsModel::MacColumn, 150);
+    table->setColumnWidth(ArpResultsModel::VendorColumn, 300);
+    layout->addWidget(table);
+
+    m_status->setWordWrap(true);
+    layout->addWidget(m_status);
+
+    auto *btnLayout = new QHBoxLayout();
+    auto *copyBtn = new QPushButton("Копировать всё", this);
+    auto *closeBtn = new QPushButton("Закрыть", this);
+    btnLayout->addWidget(copyBtn);
+    btnLayout->addStretch();
+    btnLayout->addWidget(closeBtn);
+    layout->addLayout(btnLayout);
+
+    connect(filterEdit, &QLineEdit::textChanged, m_proxy, &QSortFilterProxyModel::setFilterFixedString);
+    connect(copyBtn, &QPushButton::clicked, this, [this]() {
+        QApplication::clipboard()->setText(m_model->toText());
+        QMessageBox::information(this, "Готово", "Результат сканирования скопирован в буфер обмена");
+    });
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::close);
+}
+
+void ArpScanDialog::scan(const QHash<QString, QString> &vmMacs)
+{
+    m_model->clear();
+    m_model->setVmMacs(vmMacs);
+    m_parser.reset();
+    m_errors.clear();
+    m_status->setText("Сканирование локальной сети...");
+
+    // Записи идут в таблицу по мере вывода arp-scan, а не после его завершения
+    QProcess *arpProcess = new QProcess(this);
+    connect(arpProcess, &QProcess::readyReadStandardOutput, this, [this, arpProcess]() {
+        QVector<ArpEntry> entries;
+        m_parser.feed(arpProcess->readAllStandardOutput(), &entries);
+        m_model->addEntries(entries);
+        updateStatus(false);
+    });
+    connect(arpProcess, &QProcess::readyReadStandardError, this, [this, arpProcess]() {
+        m_errors += QString::fromLocal8Bit(arpProcess->readAllStandardError());
+    });
+    connect(arpProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, arpProcess]() {
+                QVector<ArpEntry> entries;
+                m_parser.feed(arpProcess->readAllStandardOutput(), &entries);
+                m_parser.finish(&entries);
+                m_model->addEntries(entries);
+                m_errors += QString::fromLocal8Bit(arpProcess->readAllStandardError());
+                updateStatus(true);
+                arpProcess->deleteLater();
+                emit scanFinished();
+            });
+    connect(arpProcess, &QProcess::errorOccurred, this, [this, arpProcess](QProcess::ProcessError error) {
+        // finished() после FailedToStart не приходит — о конце сообщаем здесь
+        if (error != QProcess::FailedToStart)
+            return;
+        m_errors += arpProcess->errorString();
+        updateStatus(true);
+        arpProcess->deleteLater();
+        emit scanFinished();
+    });
+
+    arpProcess->setProgram(m_commands->resolveProgram("doas"));
+    arpProcess->setArguments({"arp-scan", "--localnet"});
+    arpProcess->start();
+    show();
+    raise();
+    activateWindow();
+}
+
+void ArpScanDialog::updateStatus(bool finished)
+{
+    QString text = QString("%1 узлов, из них наших ВМ: %2")
+                       .arg(m_model->rowCount()).arg(m_model->vmMatchCount());
+    text = finished ? "Сканирование завершено: " + text : "Сканирование... " + text;
+    if (finished && m_model->rowCount() == 0 && m_errors.isEmpty())
+        text += " (arp-scan не установлен или нет прав)";
+    if (!m_errors.trimmed().isEmpty())
+        text += "\nОшибка: " + m_errors.trimmed();
+    m_status->setText(text);
+    m_status->setStyleSheet(m_errors.trimmed().isEmpty() ? QString() : "color: #c62828;");
+}
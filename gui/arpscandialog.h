@@ -0,0 +1,42 @@
+#ifndef ARPSCANDIALOG_H
+#define ARPSCANDIALOG_H
+
+#include <QDialog>
+#include <QHash>
+
+#include "arpscanparser.h"
+
+class ArpResultsModel;
+class CommandRunner;
+class QLabel;
+class QSortFilterProxyModel;
+
+// Немодальное окно arp-scan --localnet: записи идут в таблицу по мере
+// вывода, узлы с MAC наших ВМ подписываются именем ВМ. Окно живёт между
+// сканированиями, каждое scan() начинает таблицу заново
+class ArpScanDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ArpScanDialog(CommandRunner *commands, QWidget *parent = nullptr);
+
+    // vmMacs — MAC → имя ВМ для подписи строк
+    void scan(const QHash<QString, QString> &vmMacs);
+
+signals:
+    // arp-scan завершился или не запустился
+    void scanFinished();
+
+private:
+    void updateStatus(bool finished);
+
+    CommandRunner *m_commands;
+    ArpResultsModel *m_model;
+    QSortFilterProxyModel *m_proxy;
+    QLabel *m_status;
+    ArpScanParser m_parser;
+    QString m_errors;
+};
+
+#endif // ARPSCANDIALOG_H
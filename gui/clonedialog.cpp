@@ -0,0 +1,124 @@
+#include "clonedialog.h"
+#include "imageclone.h"
+#include "vminventory.h"
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+CloneDialog::CloneDialog(ImageCloner *cloner, VmInventory *inventory, const QString &templateName, QWidget *parent)
+    : QDialog(parent)
+    , m_cloner(cloner)
+    , m_inventory(inventory)
+    , m_template(new QComboBox(this))
+    , m_names(new QLineEdit(this))
+{
+    setWindowTitle("Клонирование ВМ");
+    resize(820, 420);
+    auto *layout = new QVBoxLayout(this);
+    auto *form = new QFormLayout;
+    layout->addLayout(form);
+
+    for (const VmImageInfo &vm : m_inventory->images())
+        m_template->addItem(QString("%1 (%2 ГБ)").arg(vm.name).arg(vm.size / 1024.0 / 1024 / 1024, 0, 'f', 1), vm.name);
+    m_template->setCurrentIndex(qMax(0, m_template->findData(templateName)));
+    m_names->setPlaceholderText("web1 web2 web3 — несколько имён клонируются параллельно");
+    auto *parallelBox = new QSpinBox(this);
+    parallelBox->setRange(1, 16);
+    parallelBox->setValue(m_cloner->maxParallel());
+    parallelBox->setToolTip("Сколько копий одновременно пишут на одно устройство; остальные ждут в очереди");
+    form->addRow("Шаблон:", m_template);
+    form->addRow("Новые ВМ:", m_names);
+    form->addRow("Копий на диск одновременно:", parallelBox);
+    connect(parallelBox, QOverload<int>::of(&QSpinBox::valueChanged), m_cloner, &ImageCloner::setMaxParallel);
+
+    const QStringList headers = {"ВМ", "Состояние", "%", "МБ/с", "Способ", "Подробности"};
+    m_table = new QTableWidget(0, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(m_table);
+
+    fill();
+    connect(m_cloner, &ImageCloner::jobChanged, this, &CloneDialog::fill);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto *cloneButton = buttonBox->addButton("Клонировать", QDialogButtonBox::ActionRole);
+    auto *cancelButton = buttonBox->addButton("Отменить копию", QDialogButtonBox::ActionRole);
+    layout->addWidget(buttonBox);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(cloneButton, &QPushButton::clicked, this, &CloneDialog::cloneSelected);
+    connect(cancelButton, &QPushButton::clicked, this, &CloneDialog::cancelSelected);
+    // Enter в поле имён — клонировать, а не закрыть окно
+    cloneButton->setDefault(true);
+}
+
+void CloneDialog::fill()
+{
+    const QVector<ImageCloner::Job> jobs = m_cloner->jobs();
+    m_table->setRowCount(jobs.size());
+    for (int row = 0; row < jobs.size(); ++row) {
+        const ImageCloner::Job &job = jobs[row];
+        const QStringList cells = {
+            QFileInfo(job.target).dir().dirName(),
+            ImageCloner::stateName(job.state),
+            QString::number(job.percent()),
+            job.state == ImageCloner::State::Queued ? QString() : QString::number(job.mbPerSec(), 'f', 0),
+            job.method,
+            job.summary(),
+        };
+        for (int col = 0; col < cells.size(); ++col) {
+            auto *item = new QTableWidgetItem(cells[col]);
+            item->setData(Qt::UserRole, job.id);
+            if (col == 2 || col == 3)
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            if (job.state == ImageCloner::State::Failed)
+                item->setForeground(Qt::red);
+            m_table->setItem(row, col, item);
+        }
+    }
+}
+
+void CloneDialog::cloneSelected()
+{
+    const QString templateVm = m_template->currentData().toString();
+    if (templateVm.isEmpty()) {
+        QMessageBox::warning(this, "Ошибка", "Нет образов-шаблонов в " + m_inventory->root());
+        return;
+    }
+    const QStringList names = m_names->text().split(QRegularExpression("[\\s,;]+"), Qt::SkipEmptyParts);
+    QStringList errors;
+    for (const QString &name : names) {
+        if (!VmInventory::isValidName(name)) {
+            errors << name + ": недопустимое имя";
+            continue;
+        }
+        QString error;
+        if (!m_cloner->clone(m_inventory->imagePathFor(templateVm), m_inventory->imagePathFor(name), &error))
+            errors << name + ": " + error;
+        else
+            emit cloneQueued(templateVm, name);
+    }
+    if (!errors.isEmpty())
+        QMessageBox::warning(this, "Клонирование", errors.join('\n'));
+    m_names->clear();
+}
+
+void CloneDialog::cancelSelected()
+{
+    if (QTableWidgetItem *item = m_table->item(m_table->currentRow(), 0))
+        m_cloner->cancel(item->data(Qt::UserRole).toInt());
+}
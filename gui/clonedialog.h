@@ -0,0 +1,37 @@
+#ifndef CLONEDIALOG_H
+#define CLONEDIALOG_H
+
+#include <QDialog>
+
+class ImageCloner;
+class QComboBox;
+class QLineEdit;
+class QTableWidget;
+class VmInventory;
+
+// Новые ВМ из золотого образа: <каталог>/<имя>/<имя>.img. Копии идут в
+// ImageCloner и переживают закрытие окна; таблица — все копии сеанса
+class CloneDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    CloneDialog(ImageCloner *cloner, VmInventory *inventory, const QString &templateName, QWidget *parent = nullptr);
+
+signals:
+    // Копия поставлена в очередь ImageCloner
+    void cloneQueued(const QString &templateVm, const QString &name);
+
+private:
+    void fill();
+    void cloneSelected();
+    void cancelSelected();
+
+    ImageCloner *m_cloner;
+    VmInventory *m_inventory;
+    QComboBox *m_template;
+    QLineEdit *m_names;
+    QTableWidget *m_table;
+};
+
+#endif // CLONEDIALOG_H
@@ -0,0 +1,138 @@
+#include "consolearchivedialog.h"
+#include "archivelogmodel.h"
+#include "logarchive.h"
+
+#include <QDateTimeEdit>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+ConsoleArchiveDialog::ConsoleArchiveDialog(LogArchive *archive, const QString &vmName, const QString &vmDir, QWidget *parent)
+    : QDialog(parent)
+    , m_archive(archive)
+    , m_vmDir(vmDir)
+    , m_time(new QDateTimeEdit(QDateTime::currentDateTime(), this))
+    , m_search(new QLineEdit(this))
+    , m_find(new QPushButton("Найти далее", this))
+    , m_model(new ArchiveLogModel(this))
+    , m_view(new QListView(this))
+    , m_status(new QLabel(this))
+    , m_cancel(std::make_shared<std::atomic<bool>>(false))
+{
+    setWindowTitle("Архив консоли — " + vmName);
+    resize(1000, 600);
+    auto *layout = new QVBoxLayout(this);
+
+    auto *toolbar = new QHBoxLayout;
+    m_time->setDisplayFormat("dd.MM.yyyy HH:mm:ss");
+    m_time->setCalendarPopup(true);
+    auto *jumpButton = new QPushButton("Перейти ко времени", this);
+    m_search->setPlaceholderText("Подстрока для поиска");
+    toolbar->addWidget(m_time);
+    toolbar->addWidget(jumpButton);
+    toolbar->addSpacing(16);
+    toolbar->addWidget(m_search, 1);
+    toolbar->addWidget(m_find);
+    layout->addLayout(toolbar);
+
+    m_view->setUniformItemSizes(true);
+    m_view->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_view->setModel(m_model);
+    layout->addWidget(m_view);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto *reloadButton = buttonBox->addButton("Обновить", QDialogButtonBox::ActionRole);
+    auto *bottom = new QHBoxLayout;
+    bottom->addWidget(m_status, 1);
+    bottom->addWidget(buttonBox);
+    layout->addLayout(bottom);
+
+    reload();
+    // Время по умолчанию — последней строки, чтобы шагать назад от неё
+    const qint64 lastTime = m_model->reader().lineTimestamp(m_model->reader().lineCount() - 1);
+    if (lastTime >= 0)
+        m_time->setDateTime(QDateTime::fromMSecsSinceEpoch(lastTime));
+
+    connect(reloadButton, &QPushButton::clicked, this, &ConsoleArchiveDialog::reload);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(jumpButton, &QPushButton::clicked, this, &ConsoleArchiveDialog::jumpToTime);
+    connect(&m_watcher, &QFutureWatcher<qint64>::finished, this, &ConsoleArchiveDialog::showFound);
+    connect(m_find, &QPushButton::clicked, this, &ConsoleArchiveDialog::find);
+    connect(m_search, &QLineEdit::returnPressed, this, &ConsoleArchiveDialog::find);
+}
+
+ConsoleArchiveDialog::~ConsoleArchiveDialog()
+{
+    m_cancel->store(true);
+}
+
+void ConsoleArchiveDialog::reload()
+{
+    QString error;
+    m_model->open(m_vmDir, &error);
+    m_view->scrollToBottom();
+    showStatus(error);
+}
+
+void ConsoleArchiveDialog::jumpToTime()
+{
+    selectRow(m_model->reader().rowAtTime(m_time->dateTime().toMSecsSinceEpoch()));
+}
+
+// Читатель копируется в задачу вместе с отображениями — закрытие окна
+// не выдёргивает память из-под поиска, а флаг отмены его прерывает
+void ConsoleArchiveDialog::find()
+{
+    const QByteArray needle = m_search->text().toUtf8();
+    if (needle.isEmpty() || m_watcher.isRunning())
+        return;
+    const QModelIndex current = m_view->currentIndex();
+    const qint64 from = current.isValid() ? current.row() + 1 : 0;
+    m_find->setEnabled(false);
+    showStatus("поиск...");
+    const LogArchiveReader reader = m_model->reader();
+    const std::shared_ptr<std::atomic<bool>> cancel = m_cancel;
+    m_watcher.setFuture(QtConcurrent::run([reader, needle, from, cancel]() {
+        return reader.find(needle, from, cancel.get());
+    }));
+}
+
+void ConsoleArchiveDialog::showFound()
+{
+    m_find->setEnabled(true);
+    const qint64 row = m_watcher.result();
+    if (row >= 0) {
+        selectRow(row);
+        showStatus(QString());
+    } else {
+        showStatus("не найдено");
+    }
+}
+
+void ConsoleArchiveDialog::selectRow(qint64 row)
+{
+    const QModelIndex index = m_model->index(int(qBound<qint64>(0, row, m_model->rowCount() - 1)));
+    m_view->setCurrentIndex(index);
+    m_view->scrollTo(index, QAbstractItemView::PositionAtTop);
+}
+
+void ConsoleArchiveDialog::showStatus(const QString &extra)
+{
+    const LogArchiveReader &reader = m_model->reader();
+    QString text = QString("Файлов: %1, %2 МБ, строк: %3")
+                       .arg(reader.fileCount())
+                       .arg(reader.totalBytes() / 1024.0 / 1024.0, 0, 'f', 1)
+                       .arg(reader.lineCount());
+    if (m_archive->droppedCount() > 0)
+        text += QString("; не записано строк: %1").arg(m_archive->droppedCount());
+    if (!m_archive->writeError().isEmpty())
+        text += "; ошибка записи: " + m_archive->writeError();
+    if (!extra.isEmpty())
+        text += " — " + extra;
+    m_status->setText(text);
+}
@@ -0,0 +1,50 @@
+#ifndef CONSOLEARCHIVEDIALOG_H
+#define CONSOLEARCHIVEDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+
+class ArchiveLogModel;
+class LogArchive;
+class QDateTimeEdit;
+class QLabel;
+class QLineEdit;
+class QListView;
+class QPushButton;
+
+// Лог ВМ с диска за всё время: файлы отображаются в память, вид читает
+// только видимые строки; поиск подстроки идёт в пуле потоков
+class ConsoleArchiveDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // vmDir — archive->vmDirectory(vmName), не пустой
+    ConsoleArchiveDialog(LogArchive *archive, const QString &vmName, const QString &vmDir, QWidget *parent = nullptr);
+    // Прерывает поиск, если он ещё идёт
+    ~ConsoleArchiveDialog() override;
+
+private:
+    void reload();
+    void jumpToTime();
+    void find();
+    void showFound();
+    void selectRow(qint64 row);
+    void showStatus(const QString &extra);
+
+    LogArchive *m_archive;
+    QString m_vmDir;
+    QDateTimeEdit *m_time;
+    QLineEdit *m_search;
+    QPushButton *m_find;
+    ArchiveLogModel *m_model;
+    QListView *m_view;
+    QLabel *m_status;
+
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+    QFutureWatcher<qint64> m_watcher;
+};
+
+#endif // CONSOLEARCHIVEDIALOG_H
@@ -0,0 +1,116 @@
+#include "consolewindow.h"
+#include "terminalview.h"
+#include "serialconsole.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+
+#include <QCloseEvent>
+#include <QLabel>
+#include <QTabWidget>
+#include <QVBoxLayout>
+
+ConsoleWindow::ConsoleWindow(VmSupervisor *supervisor, QWidget *parent)
+    : QWidget(parent, Qt::Window)
+    , m_supervisor(supervisor)
+    , m_tabs(new QTabWidget(this))
+    , m_status(new QLabel(this))
+{
+    setWindowTitle("Консоли ВМ");
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    m_tabs->setTabsClosable(true);
+    m_tabs->setDocumentMode(true);
+    layout->addWidget(m_tabs, 1);
+    layout->addWidget(m_status);
+
+    connect(m_tabs, &QTabWidget::tabCloseRequested, this, &ConsoleWindow::closeTab);
+    connect(m_tabs, &QTabWidget::currentChanged, this, [this](int index) {
+        updateStatus();
+        if (QWidget *view = m_tabs->widget(index))
+            view->setFocus();
+    });
+    connect(m_supervisor, &VmSupervisor::instanceAboutToBeRemoved, this, [this](int row) {
+        VmInstance *vm = m_supervisor->at(row);
+        if (TerminalView *view = vm ? m_views.value(vm->name()) : nullptr)
+            closeTab(m_tabs->indexOf(view));
+    });
+
+    m_statusTimer.setInterval(StatusIntervalMs);
+    connect(&m_statusTimer, &QTimer::timeout, this, &ConsoleWindow::updateStatus);
+}
+
+void ConsoleWindow::showVm(const QString &name)
+{
+    TerminalView *view = m_views.value(name);
+    if (!view) {
+        VmInstance *vm = m_supervisor->instance(name);
+        if (!vm)
+            return;
+        view = new TerminalView(m_tabs);
+        m_views.insert(name, view);
+        m_tabs->addTab(view, name);
+        attach(view, vm);
+        if (m_views.size() == 1)
+            resize(sizeHint());
+    }
+    m_tabs->setCurrentWidget(view);
+    m_statusTimer.start();
+    show();
+    raise();
+    activateWindow();
+    view->setFocus();
+}
+
+// Соединения принадлежат виджету: закрыли вкладку — отписались от консоли
+void ConsoleWindow::attach(TerminalView *view, VmInstance *vm)
+{
+    SerialConsole *serial = vm->serial();
+    view->feed(serial->history());
+    connect(serial, &SerialConsole::received, view, &TerminalView::feed);
+    connect(serial, &SerialConsole::opened, view, &TerminalView::reset);
+    connect(view, &TerminalView::input, serial, [serial](const QByteArray &data) { serial->write(data); });
+    connect(serial, &SerialConsole::opened, this, &ConsoleWindow::updateStatus);
+    connect(serial, &SerialConsole::closed, this, &ConsoleWindow::updateStatus);
+}
+
+void ConsoleWindow::updateStatus()
+{
+    auto *view = qobject_cast<TerminalView *>(m_tabs->currentWidget());
+    VmInstance *vm = view ? m_supervisor->instance(m_views.key(view)) : nullptr;
+    if (!vm) {
+        m_status->clear();
+        return;
+    }
+    const SerialConsole *serial = vm->serial();
+    if (!serial->isOpen()) {
+        m_status->setText("com1 не подключён — ВМ не запущена");
+        return;
+    }
+    const TerminalScreen &screen = view->screen();
+    QString status = QString("%1 (%2) — получено %3 КиБ, отправлено %4 Б")
+                         .arg(serial->guestDevice(), SerialConsole::backendName(serial->backend()))
+                         .arg(serial->bytesReceived() / 1024)
+                         .arg(serial->bytesSent());
+    if (!screen.title().isEmpty())
+        status += " — " + screen.title();
+    m_status->setText(status);
+}
+
+void ConsoleWindow::closeTab(int index)
+{
+    auto *view = qobject_cast<TerminalView *>(m_tabs->widget(index));
+    if (!view)
+        return;
+    m_views.remove(m_views.key(view));
+    m_tabs->removeTab(index);
+    view->deleteLater();
+    if (m_views.isEmpty())
+        m_statusTimer.stop();
+}
+
+void ConsoleWindow::closeEvent(QCloseEvent *event)
+{
+    while (m_tabs->count() > 0)
+        closeTab(0);
+    QWidget::closeEvent(event);
+}
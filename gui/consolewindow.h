@@ -0,0 +1,46 @@
+#ifndef CONSOLEWINDOW_H
+#define CONSOLEWINDOW_H
+
+#include <QWidget>
+#include <QHash>
+#include <QTimer>
+
+class QLabel;
+class QTabWidget;
+class TerminalView;
+class VmInstance;
+class VmSupervisor;
+
+// Консоли ВМ: окно с вкладкой TerminalView на каждую открытую ВМ, как
+// DisplayWindow для экранов. Вкладка сначала проигрывает историю com1
+// (SerialConsole::history), потом получает байты гостя по сигналу — тем
+// же куском, что ушёл в лог и в API. Новый запуск ВМ начинает экран с
+// нуля; закрытая вкладка отписывается от консоли.
+class ConsoleWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int StatusIntervalMs = 1000;
+
+    explicit ConsoleWindow(VmSupervisor *supervisor, QWidget *parent = nullptr);
+
+    // Открыть (или выбрать) вкладку ВМ и поднять окно
+    void showVm(const QString &name);
+
+protected:
+    void closeEvent(QCloseEvent *event) override;
+
+private:
+    void attach(TerminalView *view, VmInstance *vm);
+    void updateStatus();
+    void closeTab(int index);
+
+    VmSupervisor *m_supervisor;
+    QTabWidget *m_tabs;
+    QLabel *m_status;
+    QTimer m_statusTimer;
+    QHash<QString, TerminalView *> m_views;
+};
+
+#endif // CONSOLEWINDOW_H
@@ -0,0 +1,67 @@
+#include "cpuconfigdialog.h"
+
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QMessageBox>
+#include <QSpinBox>
+
+CpuConfigDialog::CpuConfigDialog(const QString &vmName, const CpuConfig &cpu, const QString &hostSummary,
+                                 QWidget *parent)
+    : QDialog(parent)
+    , m_pin(new QCheckBox("закрепить vCPU за процессорами хоста", this))
+    , m_cpu(cpu)
+{
+    setWindowTitle("Процессоры — " + vmName);
+    auto *form = new QFormLayout(this);
+
+    auto makeSpin = [this](int value) {
+        auto *spin = new QSpinBox(this);
+        spin->setRange(1, CpuConfig::MaxVcpus);
+        spin->setValue(value);
+        return spin;
+    };
+    m_vcpus = makeSpin(cpu.vcpus);
+    m_sockets = makeSpin(cpu.sockets);
+    m_cores = makeSpin(cpu.cores);
+    m_threads = makeSpin(cpu.threads);
+    m_pin->setChecked(cpu.pin);
+    form->addRow("vCPU:", m_vcpus);
+    form->addRow("Сокеты:", m_sockets);
+    form->addRow("Ядер на сокет:", m_cores);
+    form->addRow("Потоков на ядро:", m_threads);
+    form->addRow(m_pin);
+    form->addRow(new QLabel(hostSummary, this));
+
+    // Меняется только число vCPU — ведём его одним сокетом, как bhyve по умолчанию
+    connect(m_vcpus, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        if (m_cores->value() * m_threads->value() * m_sockets->value() != value) {
+            m_sockets->setValue(value);
+            m_cores->setValue(1);
+            m_threads->setValue(1);
+        }
+    });
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    form->addRow(buttonBox);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &CpuConfigDialog::tryAccept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+void CpuConfigDialog::tryAccept()
+{
+    CpuConfig updated;
+    updated.vcpus = m_vcpus->value();
+    updated.sockets = m_sockets->value();
+    updated.cores = m_cores->value();
+    updated.threads = m_threads->value();
+    updated.pin = m_pin->isChecked();
+    QString error;
+    if (!updated.normalize(&error)) {
+        QMessageBox::warning(this, "Ошибка", error);
+        return;
+    }
+    m_cpu = updated;
+    accept();
+}
@@ -0,0 +1,35 @@
+#ifndef CPUCONFIGDIALOG_H
+#define CPUCONFIGDIALOG_H
+
+#include <QDialog>
+
+#include "vmconfig.h"
+
+class QCheckBox;
+class QSpinBox;
+
+// vCPU и топология гостя. OK проходит только с конфигурацией, которую
+// принимает CpuConfig::normalize(); сохраняет её вызывающий
+class CpuConfigDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // hostSummary — строка HostTopology::summary() под формой
+    CpuConfigDialog(const QString &vmName, const CpuConfig &cpu, const QString &hostSummary,
+                    QWidget *parent = nullptr);
+
+    CpuConfig cpu() const { return m_cpu; }
+
+private:
+    void tryAccept();
+
+    QSpinBox *m_vcpus;
+    QSpinBox *m_sockets;
+    QSpinBox *m_cores;
+    QSpinBox *m_threads;
+    QCheckBox *m_pin;
+    CpuConfig m_cpu;
+};
+
+#endif // CPUCONFIGDIALOG_H
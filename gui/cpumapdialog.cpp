@@ -0,0 +1,71 @@
+#include "cpumapdialog.h"
+#include "cputopology.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+CpuMapDialog::CpuMapDialog(CpuPlacer *placer, QWidget *parent)
+    : QDialog(parent)
+    , m_placer(placer)
+    , m_status(new QLabel(this))
+{
+    setWindowTitle("Карта CPU хоста");
+    resize(640, 420);
+    auto *layout = new QVBoxLayout(this);
+    layout->addWidget(m_status);
+
+    const QStringList headers = {"CPU", "Узел", "Ядро", "SMT-соседи", "vCPU", "ВМ:vCPU"};
+    m_table = new QTableWidget(0, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(m_table);
+    fill();
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto *refresh = buttonBox->addButton("Обновить", QDialogButtonBox::ActionRole);
+    connect(refresh, &QPushButton::clicked, this, &CpuMapDialog::fill);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttonBox);
+}
+
+void CpuMapDialog::fill()
+{
+    const HostTopology &host = m_placer->host();
+    m_table->setRowCount(host.cpus.size());
+    int pinned = 0;
+    for (int row = 0; row < host.cpus.size(); ++row) {
+        const HostCpu &cpu = host.cpus[row];
+        QStringList siblings;
+        for (int id : host.siblings(cpu.id))
+            siblings << QString::number(id);
+        const int load = m_placer->load(cpu.id);
+        pinned += load;
+        const QStringList cells = {
+            QString::number(cpu.id),
+            QString::number(cpu.node),
+            QString::number(cpu.core),
+            siblings.join(", "),
+            load ? QString::number(load) : QString(),
+            m_placer->guestsOn(cpu.id).join(", "),
+        };
+        for (int col = 0; col < cells.size(); ++col) {
+            auto *item = new QTableWidgetItem(cells[col]);
+            if (col != 3 && col != 5)
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            // Перегруженный поток — больше одного vCPU
+            if (load > 1)
+                item->setForeground(Qt::red);
+            m_table->setItem(row, col, item);
+        }
+    }
+    m_status->setText(QString("%1; закреплено vCPU: %2 у %3 ВМ")
+                          .arg(host.summary()).arg(pinned).arg(m_placer->assignments().size()));
+}
@@ -0,0 +1,27 @@
+#ifndef CPUMAPDIALOG_H
+#define CPUMAPDIALOG_H
+
+#include <QDialog>
+
+class CpuPlacer;
+class QLabel;
+class QTableWidget;
+
+// Процессоры хоста и закреплённые на них vCPU работающих ВМ; перегруженные
+// потоки (больше одного vCPU) — красным
+class CpuMapDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CpuMapDialog(CpuPlacer *placer, QWidget *parent = nullptr);
+
+private:
+    void fill();
+
+    CpuPlacer *m_placer;
+    QLabel *m_status;
+    QTableWidget *m_table;
+};
+
+#endif // CPUMAPDIALOG_H
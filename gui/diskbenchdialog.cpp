@@ -0,0 +1,155 @@
+#include "diskbenchdialog.h"
+
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+DiskBenchDialog::DiskBenchDialog(const QString &vmName, const QString &path, QWidget *parent)
+    : QDialog(parent)
+    , m_vmName(vmName)
+    , m_path(path)
+    , m_size(new QSpinBox(this))
+    , m_time(new QSpinBox(this))
+    , m_start(new QPushButton("Запустить", this))
+    , m_status(new QLabel("Чтение — по образу, запись — во временный файл рядом с ним", this))
+    , m_progress(std::make_shared<Progress>())
+    , m_cancel(std::make_shared<std::atomic_bool>(false))
+{
+    setWindowTitle("Тест диска — " + (vmName.isEmpty() ? path : vmName));
+    resize(760, 420);
+    auto *layout = new QVBoxLayout(this);
+
+    auto *toolbar = new QHBoxLayout;
+    m_size->setRange(16, 8192);
+    m_size->setSuffix(" МБ");
+    m_size->setValue(int(DiskBench::DefaultBytesPerTest >> 20));
+    m_time->setRange(1, 120);
+    m_time->setSuffix(" с на тест");
+    m_time->setValue(DiskBench::DefaultMaxMsPerTest / 1000);
+    toolbar->addWidget(new QLabel(path, this), 1);
+    toolbar->addWidget(m_size);
+    toolbar->addWidget(m_time);
+    toolbar->addWidget(m_start);
+    layout->addLayout(toolbar);
+
+    const QStringList headers = {"Режим", "Тест", "МБ/с", "IOPS", "p50", "p99", "max", "Ошибка"};
+    m_table = new QTableWidget(0, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(m_table);
+
+    m_status->setWordWrap(true);
+    layout->addWidget(m_status);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_apply = buttonBox->addButton("Применить к ВМ", QDialogButtonBox::ActionRole);
+    m_apply->setEnabled(false);
+    m_apply->setVisible(!vmName.isEmpty());
+    layout->addWidget(buttonBox);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    m_poll.setInterval(ProgressIntervalMs);
+    connect(&m_poll, &QTimer::timeout, this, &DiskBenchDialog::showProgress);
+    connect(&m_watcher, &QFutureWatcher<DiskBench::Report>::finished, this, &DiskBenchDialog::showReport);
+    connect(m_start, &QPushButton::clicked, this, &DiskBenchDialog::start);
+    connect(m_apply, &QPushButton::clicked, this, [this]() { emit applyRequested(m_report); });
+}
+
+DiskBenchDialog::~DiskBenchDialog()
+{
+    m_cancel->store(true);
+}
+
+void DiskBenchDialog::showApplied(const DiskProfile &profile)
+{
+    m_status->setText("Профиль " + m_vmName + ": " + profile.toString());
+}
+
+void DiskBenchDialog::start()
+{
+    if (m_watcher.isRunning()) {
+        m_cancel->store(true);
+        m_start->setText("Останавливаем...");
+        return;
+    }
+    m_cancel->store(false);
+    m_apply->setEnabled(false);
+    m_table->setRowCount(0);
+    DiskBench::Options options;
+    options.path = m_path;
+    options.bytesPerTest = qint64(m_size->value()) << 20;
+    options.maxMsPerTest = m_time->value() * 1000;
+    m_start->setText("Прервать");
+    m_poll.start();
+
+    // Задача держит свои копии указателей — окно может закрыться раньше неё
+    const std::shared_ptr<std::atomic_bool> cancel = m_cancel;
+    const std::shared_ptr<Progress> progress = m_progress;
+    m_watcher.setFuture(QtConcurrent::run([options, cancel, progress]() {
+        return DiskBench::run(options, cancel.get(), [progress](int done, int total, const QString &step) {
+            QMutexLocker lock(&progress->mutex);
+            progress->done = done;
+            progress->total = total;
+            progress->step = step;
+        });
+    }));
+}
+
+void DiskBenchDialog::showProgress()
+{
+    QMutexLocker lock(&m_progress->mutex);
+    if (!m_progress->step.isEmpty())
+        m_status->setText(QString("Тест %1 из %2: %3").arg(m_progress->done + 1).arg(m_progress->total).arg(m_progress->step));
+}
+
+void DiskBenchDialog::showReport()
+{
+    m_poll.stop();
+    m_start->setText("Запустить");
+    m_report = m_watcher.result();
+    m_table->setRowCount(m_report.results.size());
+    for (int row = 0; row < m_report.results.size(); ++row) {
+        const DiskBench::Result &result = m_report.results[row];
+        const bool ok = result.ok();
+        const QStringList cells = {
+            DiskBench::modeName(result.mode),
+            DiskBench::patternName(result.pattern),
+            ok ? QString::number(result.mbPerSec(), 'f', 1) : QString(),
+            ok ? QString::number(qRound64(result.iops())) : QString(),
+            ok ? DiskBench::formatLatency(result.latencyUs.percentile(50)) : QString(),
+            ok ? DiskBench::formatLatency(result.latencyUs.percentile(99)) : QString(),
+            ok ? DiskBench::formatLatency(result.latencyUs.max()) : QString(),
+            result.error,
+        };
+        for (int col = 0; col < cells.size(); ++col) {
+            auto *item = new QTableWidgetItem(cells[col]);
+            if (col >= 2 && col <= 6)
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            if (!result.error.isEmpty())
+                item->setForeground(Qt::red);
+            else if (m_report.hasRecommendation && result.mode == m_report.recommended)
+                item->setForeground(Qt::darkGreen);
+            m_table->setItem(row, col, item);
+        }
+    }
+    if (!m_report.error.isEmpty())
+        m_status->setText("Замер не выполнен: " + m_report.error);
+    else if (m_report.cancelled)
+        m_status->setText("Замер прерван");
+    else if (m_report.hasRecommendation)
+        m_status->setText("Быстрее всего: " + DiskBench::modeName(m_report.recommended)
+                          + " (среднее геометрическое МБ/с по четырём тестам)");
+    else
+        m_status->setText("Ни один режим не прошёл все тесты");
+    m_apply->setEnabled(m_report.hasRecommendation);
+}
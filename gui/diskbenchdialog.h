@@ -0,0 +1,69 @@
+#ifndef DISKBENCHDIALOG_H
+#define DISKBENCHDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+
+#include "diskbench.h"
+
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
+
+// Замер пула хранения, где лежит образ ВМ (или выбранного каталога):
+// чтение по образу, запись во временный файл рядом. DiskBench идёт в пуле
+// потоков, окно опрашивает прогресс таймером. "Применить к ВМ" только
+// просит вызывающего сохранить профиль по отчёту (applyRequested)
+class DiskBenchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ProgressIntervalMs = 200;
+
+    // vmName пустое — замер каталога, без кнопки "Применить к ВМ"
+    DiskBenchDialog(const QString &vmName, const QString &path, QWidget *parent = nullptr);
+    // Окно закрыто посреди замера — поток доработает тест и уберёт временный файл
+    ~DiskBenchDialog() override;
+
+    // Профиль, который вызывающий сохранил по applyRequested()
+    void showApplied(const DiskProfile &profile);
+
+signals:
+    void applyRequested(const DiskBench::Report &report);
+
+private:
+    // Прогресс пишет рабочий поток, читает таймер окна
+    struct Progress {
+        QMutex mutex;
+        int done = 0;
+        int total = 0;
+        QString step;
+    };
+
+    void start();
+    void showProgress();
+    void showReport();
+
+    QString m_vmName;
+    QString m_path;
+    QSpinBox *m_size;
+    QSpinBox *m_time;
+    QPushButton *m_start;
+    QPushButton *m_apply;
+    QTableWidget *m_table;
+    QLabel *m_status;
+    QTimer m_poll;
+
+    std::shared_ptr<Progress> m_progress;
+    std::shared_ptr<std::atomic_bool> m_cancel;
+    DiskBench::Report m_report;
+    QFutureWatcher<DiskBench::Report> m_watcher;
+};
+
+#endif // DISKBENCHDIALOG_H
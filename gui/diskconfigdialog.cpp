@@ -0,0 +1,172 @@
+#include "diskconfigdialog.h"
+#include "vminstance.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+DiskConfigDialog::DiskConfigDialog(const VmConfig &current, const DiskProfile &defaultProfile, QWidget *parent)
+    : QDialog(parent)
+    , m_diskPath(current.diskPath)
+    , m_defaultProfile(defaultProfile)
+    , m_device(new QComboBox(this))
+    , m_nocache(new QCheckBox("nocache — мимо кэша хоста (O_DIRECT)", this))
+    , m_direct(new QCheckBox("direct — синхронная запись (O_SYNC)", this))
+    , m_readOnly(new QCheckBox("только чтение (золотой образ)", this))
+    , m_sectors(new QComboBox(this))
+    , m_slots(new QLabel(this))
+{
+    setWindowTitle("Диски — " + current.name);
+    resize(640, 420);
+    auto *layout = new QVBoxLayout(this);
+    auto *form = new QFormLayout;
+    layout->addLayout(form);
+
+    for (DiskProfile::Device model : {DiskProfile::Device::AhciHd, DiskProfile::Device::VirtioBlk, DiskProfile::Device::Nvme})
+        m_device->addItem(DiskProfile::deviceName(model), int(model));
+    m_sectors->addItem("по умолчанию");
+    m_sectors->addItems({"512", "4096", "512/4096"});
+    showProfile(current.diskProfile);
+    form->addRow("Загрузочный диск:", new QLabel(current.diskPath, this));
+    form->addRow("Модель:", m_device);
+    form->addRow(m_nocache);
+    form->addRow(m_direct);
+    form->addRow(m_readOnly);
+    form->addRow("Сектор, байт:", m_sectors);
+
+    layout->addWidget(new QLabel("Дополнительные диски (профиль — как в vmrun --disk-profile):", this));
+    const QStringList headers = {"Путь", "Профиль"};
+    m_table = new QTableWidget(0, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+    for (const DiskConfig &disk : current.extraDisks)
+        addDiskRow(disk);
+    layout->addWidget(m_table);
+    showSlots();
+    layout->addWidget(m_slots);
+
+    auto *tableButtons = new QHBoxLayout;
+    auto *addButton = new QPushButton("Добавить...", this);
+    auto *removeButton = new QPushButton("Удалить", this);
+    tableButtons->addWidget(addButton);
+    tableButtons->addWidget(removeButton);
+    tableButtons->addStretch();
+    layout->addLayout(tableButtons);
+    connect(addButton, &QPushButton::clicked, this, [this]() {
+        const QString path = QFileDialog::getOpenFileName(this, "Образ диска", QFileInfo(m_diskPath).absolutePath());
+        if (path.isEmpty())
+            return;
+        DiskConfig disk;
+        disk.path = path;
+        disk.profile.device = DiskProfile::Device::VirtioBlk;
+        addDiskRow(disk);
+        showSlots();
+    });
+    connect(removeButton, &QPushButton::clicked, this, [this]() {
+        if (m_table->currentRow() >= 0)
+            m_table->removeRow(m_table->currentRow());
+        showSlots();
+    });
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel
+                                               | QDialogButtonBox::RestoreDefaults, this);
+    layout->addWidget(buttonBox);
+    // Сброс — модель снова выбирает каталог ВМ (virtio-blk для своих образов)
+    connect(buttonBox->button(QDialogButtonBox::RestoreDefaults), &QPushButton::clicked, this, [this]() {
+        showProfile(m_defaultProfile);
+        m_resetProfile = true;
+    });
+    for (QCheckBox *box : {m_nocache, m_direct, m_readOnly})
+        connect(box, &QCheckBox::toggled, this, [this]() { m_resetProfile = false; });
+    connect(m_device, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() { m_resetProfile = false; });
+    connect(m_sectors, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() { m_resetProfile = false; });
+
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &DiskConfigDialog::tryAccept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+void DiskConfigDialog::showProfile(const DiskProfile &profile)
+{
+    m_device->setCurrentIndex(m_device->findData(int(profile.device)));
+    m_nocache->setChecked(profile.nocache);
+    m_direct->setChecked(profile.direct);
+    m_readOnly->setChecked(profile.readOnly);
+    QString sectorText;
+    if (profile.sectorSize > 0) {
+        sectorText = QString::number(profile.sectorSize);
+        if (profile.physicalSectorSize > 0 && profile.physicalSectorSize != profile.sectorSize)
+            sectorText += "/" + QString::number(profile.physicalSectorSize);
+        if (m_sectors->findText(sectorText) < 0)
+            m_sectors->addItem(sectorText);
+    }
+    m_sectors->setCurrentIndex(qMax(0, m_sectors->findText(sectorText)));
+}
+
+void DiskConfigDialog::addDiskRow(const DiskConfig &disk)
+{
+    const int row = m_table->rowCount();
+    m_table->insertRow(row);
+    m_table->setItem(row, 0, new QTableWidgetItem(disk.path));
+    m_table->setItem(row, 1, new QTableWidgetItem(disk.profile.toString()));
+}
+
+void DiskConfigDialog::showSlots()
+{
+    const QVector<int> assigned = VmInstance::diskSlots(m_table->rowCount() + 1);
+    QStringList list;
+    for (int slot : assigned)
+        list << QString::number(slot);
+    m_slots->setText(assigned.isEmpty()
+                     ? QString("Слишком много дисков: свободных PCI-слотов %1").arg(VmInstance::diskSlots(0).size())
+                     : "PCI-слоты по порядку: " + list.join(", "));
+}
+
+void DiskConfigDialog::tryAccept()
+{
+    QString text = m_device->currentText();
+    if (m_nocache->isChecked())
+        text += ",nocache";
+    if (m_direct->isChecked())
+        text += ",direct";
+    if (m_readOnly->isChecked())
+        text += ",ro";
+    if (m_sectors->currentIndex() > 0)
+        text += ",sectorsize=" + m_sectors->currentText();
+    QString error;
+    DiskProfile profile;
+    if (!DiskProfile::parse(text, &profile, &error)) {
+        QMessageBox::warning(this, "Ошибка", error);
+        return;
+    }
+    QVector<DiskConfig> extraDisks;
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        DiskConfig disk;
+        disk.path = m_table->item(row, 0) ? m_table->item(row, 0)->text().trimmed() : QString();
+        const QString profileText = m_table->item(row, 1) ? m_table->item(row, 1)->text() : QString();
+        if (disk.path.isEmpty() || !DiskProfile::parse(profileText, &disk.profile, &error)) {
+            QMessageBox::warning(this, "Ошибка", QString("Диск %1: %2").arg(row + 1).arg(error.isEmpty() ? "не указан путь" : error));
+            return;
+        }
+        extraDisks.append(disk);
+    }
+    if (VmInstance::diskSlots(extraDisks.size() + 1).isEmpty()) {
+        QMessageBox::warning(this, "Ошибка", "Дисков больше, чем свободных PCI-слотов");
+        return;
+    }
+    m_profile = profile;
+    m_extraDisks = extraDisks;
+    accept();
+}
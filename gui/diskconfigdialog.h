@@ -0,0 +1,52 @@
+#ifndef DISKCONFIGDIALOG_H
+#define DISKCONFIGDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+#include "vmconfig.h"
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QTableWidget;
+
+// Профиль загрузочного диска и дополнительные диски; слоты PCI раздаются
+// автоматически при запуске. "По умолчанию" возвращает профиль, который
+// выбирает VmInventory::resolveDisk(), — тогда сохранённый профиль
+// удаляется (resetProfile()). Сохраняет и применяет результат вызывающий
+class DiskConfigDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // current — конфигурация с уже применёнными настройками ВМ,
+    // defaultProfile — профиль её диска без сохранённых настроек
+    DiskConfigDialog(const VmConfig &current, const DiskProfile &defaultProfile, QWidget *parent = nullptr);
+
+    DiskProfile profile() const { return m_profile; }
+    bool resetProfile() const { return m_resetProfile; }
+    QVector<DiskConfig> extraDisks() const { return m_extraDisks; }
+
+private:
+    void showProfile(const DiskProfile &profile);
+    void addDiskRow(const DiskConfig &disk);
+    void showSlots();
+    void tryAccept();
+
+    QString m_diskPath;
+    DiskProfile m_defaultProfile;
+    QComboBox *m_device;
+    QCheckBox *m_nocache;
+    QCheckBox *m_direct;
+    QCheckBox *m_readOnly;
+    QComboBox *m_sectors;
+    QTableWidget *m_table;
+    QLabel *m_slots;
+
+    DiskProfile m_profile;
+    bool m_resetProfile = false;
+    QVector<DiskConfig> m_extraDisks;
+};
+
+#endif // DISKCONFIGDIALOG_H
@@ -0,0 +1,35 @@
+#include "displayportdialog.h"
+#include "displayports.h"
+
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QSpinBox>
+
+DisplayPortDialog::DisplayPortDialog(const QString &vmName, int port, int currentPort, QWidget *parent)
+    : QDialog(parent)
+    , m_port(new QSpinBox(this))
+{
+    setWindowTitle("VNC-порт — " + vmName);
+    auto *form = new QFormLayout(this);
+
+    m_port->setRange(0, 65535);
+    m_port->setSpecialValueText("авто");
+    m_port->setValue(port);
+    form->addRow("Порт:", m_port);
+    form->addRow(new QLabel(QString("«авто» — первый свободный из %1–%2, по возможности прежний.\n"
+                                    "Заданный порт занят — ВМ не запустится.")
+                                .arg(DisplayPorts::FirstPort).arg(DisplayPorts::LastPort), this));
+    if (currentPort > 0)
+        form->addRow(new QLabel(QString("Сейчас: %1").arg(currentPort), this));
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    form->addRow(buttonBox);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+int DisplayPortDialog::port() const
+{
+    return m_port->value();
+}
@@ -0,0 +1,23 @@
+#ifndef DISPLAYPORTDIALOG_H
+#define DISPLAYPORTDIALOG_H
+
+#include <QDialog>
+
+class QSpinBox;
+
+// VNC-порт ВМ: 0 — «авто» из диапазона DisplayPorts. Сохраняет вызывающий
+class DisplayPortDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // currentPort > 0 — порт, на котором экран ВМ сейчас
+    DisplayPortDialog(const QString &vmName, int port, int currentPort, QWidget *parent = nullptr);
+
+    int port() const;
+
+private:
+    QSpinBox *m_port;
+};
+
+#endif // DISPLAYPORTDIALOG_H
@@ -0,0 +1,98 @@
+#include "displaywindow.h"
+#include "rfbview.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+
+#include <QCloseEvent>
+#include <QLabel>
+#include <QTabWidget>
+#include <QVBoxLayout>
+
+namespace {
+// bhyve слушает fbuf на всех адресах — подключаемся локально
+const char *const DisplayHost = "127.0.0.1";
+}
+
+DisplayWindow::DisplayWindow(VmSupervisor *supervisor, QWidget *parent)
+    : QWidget(parent, Qt::Window)
+    , m_supervisor(supervisor)
+    , m_tabs(new QTabWidget(this))
+    , m_status(new QLabel(this))
+{
+    setWindowTitle("Экраны ВМ");
+    resize(1280, 800);
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    m_tabs->setTabsClosable(true);
+    m_tabs->setDocumentMode(true);
+    layout->addWidget(m_tabs, 1);
+    layout->addWidget(m_status);
+
+    connect(m_tabs, &QTabWidget::tabCloseRequested, this, &DisplayWindow::closeTab);
+    connect(m_tabs, &QTabWidget::currentChanged, this, [this](int index) {
+        m_status->setText(index >= 0 ? m_tabs->tabToolTip(index) : QString());
+        if (QWidget *view = m_tabs->widget(index))
+            view->setFocus();
+    });
+    connect(m_supervisor, &VmSupervisor::instanceChanged, this, [this](int row) {
+        if (VmInstance *vm = m_supervisor->at(row))
+            syncView(vm);
+    });
+    connect(m_supervisor, &VmSupervisor::instanceAboutToBeRemoved, this, [this](int row) {
+        VmInstance *vm = m_supervisor->at(row);
+        if (RfbView *view = vm ? m_views.value(vm->name()) : nullptr)
+            closeTab(m_tabs->indexOf(view));
+    });
+}
+
+void DisplayWindow::showVm(const QString &name)
+{
+    RfbView *view = m_views.value(name);
+    if (!view) {
+        view = new RfbView(m_tabs);
+        m_views.insert(name, view);
+        connect(view, &RfbView::statusChanged, this, [this, view](const QString &status) {
+            const int index = m_tabs->indexOf(view);
+            m_tabs->setTabToolTip(index, status);
+            if (index == m_tabs->currentIndex())
+                m_status->setText(status);
+        });
+        m_tabs->addTab(view, name);
+        if (VmInstance *vm = m_supervisor->instance(name))
+            syncView(vm);
+        else
+            view->setTarget(QString(), 0);
+    }
+    m_tabs->setCurrentWidget(view);
+    show();
+    raise();
+    activateWindow();
+    view->setFocus();
+}
+
+// Порт появляется при запуске bhyve; пока он не слушает, RfbView повторяет попытки
+void DisplayWindow::syncView(VmInstance *vm)
+{
+    RfbView *view = m_views.value(vm->name());
+    if (!view)
+        return;
+    const int port = vm->isActive() ? vm->vncPort() : 0;
+    view->setTarget(port > 0 ? QString(DisplayHost) : QString(), port);
+}
+
+void DisplayWindow::closeTab(int index)
+{
+    auto *view = qobject_cast<RfbView *>(m_tabs->widget(index));
+    if (!view)
+        return;
+    m_views.remove(m_views.key(view));
+    m_tabs->removeTab(index);
+    view->deleteLater();
+}
+
+void DisplayWindow::closeEvent(QCloseEvent *event)
+{
+    while (m_tabs->count() > 0)
+        closeTab(0);
+    QWidget::closeEvent(event);
+}
@@ -0,0 +1,40 @@
+#ifndef DISPLAYWINDOW_H
+#define DISPLAYWINDOW_H
+
+#include <QWidget>
+#include <QHash>
+
+class QLabel;
+class QTabWidget;
+class RfbView;
+class VmInstance;
+class VmSupervisor;
+
+// Экраны ВМ: окно с вкладкой RfbView на каждую открытую ВМ. Адрес экрана
+// следует за ВМ — запустилась, подключаемся к её VNC-порту (DisplayPorts),
+// остановилась — вкладка ждёт следующего запуска. Закрытие вкладки или
+// окна рвёт соединение, фоновые экраны не декодируются зря.
+class DisplayWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DisplayWindow(VmSupervisor *supervisor, QWidget *parent = nullptr);
+
+    // Открыть (или выбрать) вкладку ВМ и поднять окно
+    void showVm(const QString &name);
+
+protected:
+    void closeEvent(QCloseEvent *event) override;
+
+private:
+    void syncView(VmInstance *vm);
+    void closeTab(int index);
+
+    VmSupervisor *m_supervisor;
+    QTabWidget *m_tabs;
+    QLabel *m_status;
+    QHash<QString, RfbView *> m_views;
+};
+
+#endif // DISPLAYWINDOW_H
@@ -0,0 +1,74 @@
+QT       += core gui network
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = vmrun-gui
+CONFIG += c++17
+
+include(../core/core.pri)
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+    archivelogmodel.cpp \
+    arpresultsmodel.cpp \
+    arpscandialog.cpp \
+    clonedialog.cpp \
+    consolearchivedialog.cpp \
+    consolewindow.cpp \
+    cpuconfigdialog.cpp \
+    cpumapdialog.cpp \
+    diskbenchdialog.cpp \
+    diskconfigdialog.cpp \
+    displayportdialog.cpp \
+    displaywindow.cpp \
+    logmodel.cpp \
+    main.cpp \
+    mainwindow.cpp \
+    phasestatsdialog.cpp \
+    restartpolicydialog.cpp \
+    rfbclient.cpp \
+    rfbview.cpp \
+    shutdownpolicydialog.cpp \
+    sparklinedelegate.cpp \
+    terminalview.cpp \
+    vmpickerdialog.cpp \
+    vmtablemodel.cpp
+
+HEADERS += \
+    archivelogmodel.h \
+    arpresultsmodel.h \
+    arpscandialog.h \
+    clonedialog.h \
+    consolearchivedialog.h \
+    consolewindow.h \
+    cpuconfigdialog.h \
+    cpumapdialog.h \
+    diskbenchdialog.h \
+    diskconfigdialog.h \
+    displayportdialog.h \
+    displaywindow.h \
+    logmodel.h \
+    mainwindow.h \
+    phasestatsdialog.h \
+    restartpolicydialog.h \
+    rfbclient.h \
+    rfbview.h \
+    shutdownpolicydialog.h \
+    sparklinedelegate.h \
+    terminalview.h \
+    vmpickerdialog.h \
+    vmtablemodel.h
+
+FORMS += \
+    mainwindow.ui
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/vmrun/bin
+!isEmpty(target.path): INSTALLS += target
+
+RESOURCES += \
+    resources.qrc
@@ -0,0 +1,121 @@
+#include "logmodel.h"
+
+#include <QColor>
+#include <QFont>
+#include <QDateTime>
+
+LogModel::LogModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void LogModel::setBuffer(LogBuffer *buffer)
+{
+    if (m_buffer == buffer)
+        return;
+    if (m_buffer)
+        disconnect(m_buffer, nullptr, this, nullptr);
+
+    m_buffer = buffer;
+    if (m_buffer) {
+        connect(m_buffer, &LogBuffer::linesFlushed, this, &LogModel::syncWithBuffer);
+        connect(m_buffer, &LogBuffer::cleared, this, &LogModel::resetFromBuffer);
+        connect(m_buffer, &QObject::destroyed, this, [this]() {
+            m_buffer = nullptr;
+            resetFromBuffer();
+        });
+    }
+    resetFromBuffer();
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || !m_buffer)
+        return QVariant();
+
+    const quint64 seq = m_firstSeq + quint64(index.row());
+    if (!m_buffer->contains(seq))
+        return QVariant();  // строка уже вытеснена, модель догонит на следующем кадре
+
+    const LogLine &line = m_buffer->lineAt(seq);
+    switch (role) {
+    case Qt::DisplayRole:
+        if (line.severity == LogSeverity::Stderr)
+            return QStringLiteral("[ERR] ") + line.text;
+        if (line.severity == LogSeverity::Serial)
+            return QStringLiteral("[COM1] ") + line.text;
+        return line.text;
+    case Qt::ToolTipRole:
+        return QDateTime::fromMSecsSinceEpoch(line.timestampMs).toString("dd.MM.yyyy hh:mm:ss.zzz");
+    case Qt::ForegroundRole:
+        switch (line.severity) {
+        case LogSeverity::Notice:  return QColor(Qt::blue);
+        case LogSeverity::Command: return QColor("#ff79c6");
+        case LogSeverity::Success: return QColor("#2e7d32");
+        case LogSeverity::Warning: return QColor("orange");
+        case LogSeverity::Error:
+        case LogSeverity::Stderr:  return QColor(Qt::red);
+        case LogSeverity::Stdout:  return QColor(Qt::darkGreen);
+        case LogSeverity::Serial:  return QColor(Qt::darkCyan);
+        case LogSeverity::Info:    break;
+        }
+        return QVariant();
+    case Qt::FontRole:
+        if (line.severity == LogSeverity::Command || line.severity == LogSeverity::Error) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+QString LogModel::lineText(int row) const
+{
+    return data(index(row), Qt::DisplayRole).toString();
+}
+
+void LogModel::syncWithBuffer()
+{
+    if (!m_buffer)
+        return;
+
+    // 1. Вытесненные строки — одним removeRows с начала
+    const quint64 newFirst = m_buffer->firstSeq();
+    if (newFirst > m_firstSeq) {
+        const int evicted = int(qMin<quint64>(newFirst - m_firstSeq, quint64(m_rows)));
+        if (evicted > 0) {
+            beginRemoveRows(QModelIndex(), 0, evicted - 1);
+            m_rows -= evicted;
+            m_firstSeq = newFirst;
+            endRemoveRows();
+        } else {
+            m_firstSeq = newFirst;
+        }
+    }
+
+    // 2. Новые строки — одним insertRows в конец
+    const int newRows = int(m_buffer->endSeq() - m_firstSeq);
+    if (newRows > m_rows) {
+        emit aboutToAppend();
+        beginInsertRows(QModelIndex(), m_rows, newRows - 1);
+        m_rows = newRows;
+        endInsertRows();
+        emit appended();
+    }
+}
+
+void LogModel::resetFromBuffer()
+{
+    beginResetModel();
+    m_firstSeq = m_buffer ? m_buffer->firstSeq() : 0;
+    m_rows = m_buffer ? m_buffer->size() : 0;
+    endResetModel();
+}
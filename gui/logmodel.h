@@ -0,0 +1,41 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QPointer>
+
+#include "logbuffer.h"
+
+// Плоская модель поверх LogBuffer для QListView (uniformItemSizes — рисуются
+// только видимые строки). Строки адресуются сквозным номером из буфера, поэтому
+// вытеснение старых строк между кадрами не сдвигает индексы под видом.
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogModel(QObject *parent = nullptr);
+
+    void setBuffer(LogBuffer *buffer);
+    LogBuffer *buffer() const { return m_buffer; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    QString lineText(int row) const;
+
+signals:
+    // Вызывается перед вставкой новых строк — вид решает, прокручивать ли вниз
+    void aboutToAppend();
+    void appended();
+
+private:
+    void syncWithBuffer();
+    void resetFromBuffer();
+
+    QPointer<LogBuffer> m_buffer;
+    quint64 m_firstSeq = 0;
+    int m_rows = 0;
+};
+
+#endif // LOGMODEL_H
@@ -5,6 +5,8 @@
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    QApplication::setOrganizationName("vmrun");
+    QApplication::setApplicationName("vmrun");
     MainWindow w;
     w.show();
     return a.exec();
@@ -0,0 +1,765 @@
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+#include <QMessageBox>
+#include <QTimer>
+#include <QDebug>
+#include <QFileInfo>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QDialog>
+#include <QLabel>
+#include <QPushButton>
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+#include <QScrollBar>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QFileDialog>
+#include <QStatusBar>
+#include <QTableView>
+#include <QLineEdit>
+#include <algorithm>
+
+#include "logmodel.h"
+#include "commandrunner.h"
+#include "networkreconciler.h"
+#include "vmsupervisor.h"
+#include "vminstance.h"
+#include "vmtablemodel.h"
+#include "sparklinedelegate.h"
+#include "vminventory.h"
+#include "vmsettings.h"
+#include "eventjournal.h"
+#include "logarchive.h"
+#include "cputopology.h"
+#include "memoryadmission.h"
+#include "imageclone.h"
+#include "displaywindow.h"
+#include "consolewindow.h"
+#include "controlserver.h"
+#include "arpscandialog.h"
+#include "clonedialog.h"
+#include "consolearchivedialog.h"
+#include "cpuconfigdialog.h"
+#include "cpumapdialog.h"
+#include "diskbenchdialog.h"
+#include "diskconfigdialog.h"
+#include "displayportdialog.h"
+#include "phasestatsdialog.h"
+#include "restartpolicydialog.h"
+#include "shutdownpolicydialog.h"
+#include "vmpickerdialog.h"
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent)
+    , ui(new Ui::MainWindow)
+    , m_log(new LogBuffer(LogBuffer::DefaultCapacity, this))
+    , m_logModel(new LogModel(this))
+    , m_supervisor(new VmSupervisor(this))
+    , m_vmModel(new VmTableModel(m_supervisor, this))
+    , m_inventory(new VmInventory(this))
+    , m_cloner(new ImageCloner(this))
+{
+    ui->setupUi(this);
+    ui->lineEdit->setPlaceholderText("Например: 4G, 8G, 8192M");
+    setupLogView();
+    setupVmTable();
+
+    // Запас памяти хоста под запуски — в строке состояния. Таймер ловит
+    // изменения памяти, которые сделали не наши ВМ
+    m_memoryStatus = new QLabel(this);
+    statusBar()->addPermanentWidget(m_memoryStatus);
+    auto *memoryTimer = new QTimer(this);
+    connect(memoryTimer, &QTimer::timeout, this, &MainWindow::updateMemoryStatus);
+    connect(m_supervisor->memoryAdmission(), &MemoryAdmission::changed, this, &MainWindow::updateMemoryStatus);
+    memoryTimer->start(MemoryStatusIntervalMs);
+    updateMemoryStatus();
+
+    // Индекс ВМ: сначала кэш с диска, затем фоновая перепроверка
+    m_inventory->setRoot(VmSettings::inventoryRoot());
+    if (!m_inventory->loadCache())
+        m_inventory->refresh();
+
+    // Копии идут и после закрытия диалога — итог пишем в общий лог
+    m_cloner->setMaxParallel(VmSettings::cloneParallel());
+    connect(m_cloner, &ImageCloner::jobFinished, this, [this](int id) {
+        const ImageCloner::Job job = m_cloner->job(id);
+        const QString name = QFileInfo(job.target).dir().dirName();
+        if (job.state == ImageCloner::State::Done) {
+            appendLog(LogSeverity::Success, QString("[Клон] %1 готова: %2").arg(name, job.summary()));
+            m_inventory->refreshVm(name);
+        } else {
+            appendLog(LogSeverity::Warning, QString("[Клон] %1 — %2: %3")
+                                                .arg(name, ImageCloner::stateName(job.state), job.summary()));
+        }
+    });
+
+    // Статистика фаз прошлых сеансов — из журнала, в фоне
+    connect(m_supervisor->journal(), &EventJournal::historyLoaded, this, [this](int events) {
+        if (events > 0)
+            appendLog(LogSeverity::Info, QString("[Журнал] Загружено %1 замеров фаз из %2")
+                                             .arg(events).arg(m_supervisor->journal()->file()));
+    });
+    m_supervisor->journal()->loadHistory();
+
+    // Гости, пережившие прошлое окно, подхватываются без перезагрузки
+    m_supervisor->setKeepGuestsRunning(VmSettings::keepGuestsRunning());
+    QElapsedTimer reattachClock;
+    reattachClock.start();
+    const QStringList reattached = m_supervisor->reattachGuests();
+    if (!reattached.isEmpty())
+        appendLog(LogSeverity::Success, QString("[Подхват] Работающие ВМ: %1 (за %2 мс)")
+                                            .arg(reattached.join(", ")).arg(reattachClock.elapsed()));
+
+    // API управления: скрипты делают то же, что кнопки, по имени ВМ.
+    // Второй экземпляр (или демон) уже слушает — тогда без API
+    const QString controlPath = VmSettings::controlSocket();
+    if (!controlPath.isEmpty()) {
+        m_control = new ControlServer(m_supervisor, this);
+        m_control->setConfigProvider([this](const QString &name, VmConfig *config, QString *error) {
+            return configByName(name, config, error);
+        });
+        QString error;
+        if (m_control->listen(controlPath, &error))
+            appendLog(LogSeverity::Info, "[API] Управление через " + controlPath);
+        else
+            appendLog(LogSeverity::Warning, "[API] Не запущено: " + error);
+    }
+
+    connect(ui->pushButton_start, &QPushButton::clicked, this, &MainWindow::on_pushButton_start_clicked);
+    connect(ui->pushButton_stop, &QPushButton::clicked, this, &MainWindow::on_pushButton_stop_clicked);
+    connect(ui->pushButton_cleanupTap, &QPushButton::clicked, this, &MainWindow::cleanupAllTapDevices);
+    connect(ui->pushButton_clear, &QPushButton::clicked, this, [this]() {
+        if (m_logModel->buffer())
+            m_logModel->buffer()->clear();
+    });
+    connect(ui->pushButton_arpScan, &QPushButton::clicked, this, &MainWindow::on_pushButton_arpScan_clicked);
+
+    // === Самое важное: кнопки Start/Stop отражают состояние ВМ, имя которой в форме ===
+    connect(ui->lineEdit_2, &QLineEdit::textChanged, this, &MainWindow::updateVmButtons);
+    updateVmButtons();
+}
+
+MainWindow::~MainWindow()
+{
+    // Модели удаляются позже supervisor'а — отвязываем виды, пока всё живо.
+    // Работающие ВМ деструктор VmSupervisor отпускает (runtime/keepGuests)
+    // или гасит.
+    ui->tableView_vms->setModel(nullptr);
+    ui->listView_log->setModel(nullptr);
+    // Клиенты API отключаются, пока supervisor цел
+    delete m_control;
+    delete ui;
+}
+
+// ======================== Таблица ВМ ========================
+void MainWindow::setupVmTable()
+{
+    ui->tableView_vms->setModel(m_vmModel);
+    ui->tableView_vms->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableView_vms->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableView_vms->horizontalHeader()->setStretchLastSection(true);
+    ui->tableView_vms->verticalHeader()->setVisible(false);
+    ui->tableView_vms->verticalHeader()->setDefaultSectionSize(22);
+    ui->tableView_vms->setItemDelegateForColumn(VmTableModel::CpuColumn,
+        new SparklineDelegate(VmTableModel::SparklineRole, 100.0f, ui->tableView_vms));
+    ui->tableView_vms->setColumnWidth(VmTableModel::CpuColumn, 120);
+
+    connect(ui->tableView_vms->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &MainWindow::onVmSelectionChanged);
+
+    auto *removeAction = new QAction("Убрать из списка", ui->tableView_vms);
+    ui->tableView_vms->addAction(removeAction);
+    ui->tableView_vms->setContextMenuPolicy(Qt::ActionsContextMenu);
+    connect(removeAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr;
+        if (!vm)
+            return;
+        if (vm->isActive()) {
+            QMessageBox::information(this, "ВМ работает", "Сначала остановите ВМ " + vm->name());
+            return;
+        }
+        m_supervisor->remove(vm->name());
+    });
+
+    auto *shutdownAction = new QAction("Параметры остановки...", ui->tableView_vms);
+    ui->tableView_vms->addAction(shutdownAction);
+    connect(shutdownAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        if (VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr)
+            editShutdownPolicy(vm->name());
+    });
+
+    auto *restartAction = new QAction("Политика перезапуска...", ui->tableView_vms);
+    ui->tableView_vms->addAction(restartAction);
+    connect(restartAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        if (VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr)
+            editRestartPolicy(vm->name());
+    });
+
+    auto *cpuAction = new QAction("Процессоры...", ui->tableView_vms);
+    ui->tableView_vms->addAction(cpuAction);
+    connect(cpuAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        if (VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr)
+            editCpuConfig(vm->name());
+    });
+
+    auto *cpuMapAction = new QAction("Карта CPU хоста...", ui->tableView_vms);
+    ui->tableView_vms->addAction(cpuMapAction);
+    connect(cpuMapAction, &QAction::triggered, this, &MainWindow::showCpuMap);
+
+    auto *cloneAction = new QAction("Клонировать...", ui->tableView_vms);
+    ui->tableView_vms->addAction(cloneAction);
+    connect(cloneAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr;
+        showCloneDialog(vm ? vm->name() : QString());
+    });
+
+    auto *diskAction = new QAction("Диски...", ui->tableView_vms);
+    ui->tableView_vms->addAction(diskAction);
+    connect(diskAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        if (VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr)
+            editDiskConfig(vm->name());
+    });
+
+    auto *diskBenchAction = new QAction("Тест диска...", ui->tableView_vms);
+    ui->tableView_vms->addAction(diskBenchAction);
+    connect(diskBenchAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr;
+        showDiskBench(vm ? vm->name() : QString());
+    });
+
+    auto *phaseAction = new QAction("Задержки фаз...", ui->tableView_vms);
+    ui->tableView_vms->addAction(phaseAction);
+    connect(phaseAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr;
+        showPhaseStats(vm ? vm->name() : QString());
+    });
+
+    auto *archiveAction = new QAction("Архив консоли...", ui->tableView_vms);
+    ui->tableView_vms->addAction(archiveAction);
+    connect(archiveAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        if (VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr)
+            showConsoleArchive(vm->name());
+    });
+
+    auto *displayAction = new QAction("Экран", ui->tableView_vms);
+    ui->tableView_vms->addAction(displayAction);
+    connect(displayAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        if (VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr)
+            showDisplay(vm->name());
+    });
+    // Двойной щелчок по работающей ВМ — сразу её экран
+    connect(ui->tableView_vms, &QTableView::doubleClicked, this, [this](const QModelIndex &idx) {
+        VmInstance *vm = m_vmModel->instanceAt(idx.row());
+        if (vm && vm->isActive())
+            showDisplay(vm->name());
+    });
+
+    auto *consoleAction = new QAction("Консоль", ui->tableView_vms);
+    ui->tableView_vms->addAction(consoleAction);
+    connect(consoleAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        if (VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr)
+            showConsole(vm->name());
+    });
+
+    auto *displayPortAction = new QAction("VNC-порт...", ui->tableView_vms);
+    ui->tableView_vms->addAction(displayPortAction);
+    connect(displayPortAction, &QAction::triggered, this, [this]() {
+        const QModelIndex idx = ui->tableView_vms->currentIndex();
+        if (VmInstance *vm = idx.isValid() ? m_vmModel->instanceAt(idx.row()) : nullptr)
+            editDisplayPort(vm->name());
+    });
+
+    auto *stopAllAction = new QAction("Остановить все", ui->tableView_vms);
+    ui->tableView_vms->addAction(stopAllAction);
+    connect(stopAllAction, &QAction::triggered, this, &MainWindow::stopAllVms);
+    connect(m_supervisor, &VmSupervisor::allStopped, this, [this](int count, qint64 elapsedMs) {
+        appendLog(LogSeverity::Success, QString("[Остановка] Все ВМ (%1) остановлены за %2 мс; %3")
+                                            .arg(count).arg(elapsedMs).arg(m_supervisor->stopStats().summary()));
+    });
+
+    connect(m_supervisor, &VmSupervisor::instanceChanged, this, [this](int row) {
+        VmInstance *vm = m_supervisor->at(row);
+        if (vm && vm == currentVm())
+            updateVmButtons();
+        // Образ остановленной ВМ мог вырасти — обновляем размер/дату в индексе
+        if (vm && !vm->isActive())
+            m_inventory->refreshVm(vm->name());
+    });
+    connect(m_supervisor, &VmSupervisor::instanceRemoved, this, &MainWindow::updateVmButtons);
+}
+
+void MainWindow::onVmSelectionChanged()
+{
+    const QModelIndexList rows = ui->tableView_vms->selectionModel()->selectedRows();
+    VmInstance *vm = rows.isEmpty() ? nullptr : m_vmModel->instanceAt(rows.first().row());
+    showLogFor(vm);
+    if (!vm)
+        return;
+
+    // Выбор строки подставляет конфигурацию ВМ в форму
+    const VmConfig &config = vm->config();
+    ui->lineEdit_2->setText(config.name);
+    ui->lineEdit->setText(config.memory);
+    ui->lineEdit_3->setText(config.diskPath);
+    ui->lineEdit_4->setText(config.isoPath);
+    ui->lineEdit_5->setText(config.tap);
+}
+
+// Дедлайны ступеней остановки одной ВМ; применяются со следующего запуска
+void MainWindow::editShutdownPolicy(const QString &vmName)
+{
+    ShutdownPolicyDialog dialog(vmName, VmSettings::loadShutdownPolicy(vmName), this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    const ShutdownPolicy updated = dialog.policy();
+    VmSettings::saveShutdownPolicy(vmName, updated);
+
+    // Работающей ВМ конфигурацию не меняем — подхватится при следующем старте
+    if (VmInstance *vm = m_supervisor->instance(vmName)) {
+        VmConfig config = vm->config();
+        config.shutdown = updated;
+        vm->setConfig(config);
+    }
+}
+
+void MainWindow::editRestartPolicy(const QString &vmName)
+{
+    RestartPolicyDialog dialog(vmName, VmSettings::loadRestartPolicy(vmName), this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    const RestartPolicy updated = dialog.policy();
+    VmSettings::saveRestartPolicy(vmName, updated);
+
+    if (VmInstance *vm = m_supervisor->instance(vmName)) {
+        VmConfig config = vm->config();
+        config.restart = updated;
+        vm->setConfig(config);
+    }
+}
+
+// vCPU и топология гостя; применяются со следующего запуска
+void MainWindow::editCpuConfig(const QString &vmName)
+{
+    CpuConfigDialog dialog(vmName, VmSettings::loadCpuConfig(vmName),
+                           m_supervisor->cpuPlacer()->host().summary(), this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    const CpuConfig updated = dialog.cpu();
+    VmSettings::saveCpuConfig(vmName, updated);
+    if (VmInstance *vm = m_supervisor->instance(vmName)) {
+        VmConfig config = vm->config();
+        config.cpu = updated;
+        vm->setConfig(config);
+    }
+}
+
+void MainWindow::showCpuMap()
+{
+    CpuMapDialog dialog(m_supervisor->cpuPlacer(), this);
+    dialog.exec();
+}
+
+void MainWindow::editDiskConfig(const QString &vmName)
+{
+    VmInstance *vm = m_supervisor->instance(vmName);
+    VmConfig current = vm ? vm->config() : VmConfig();
+    current.name = vmName;
+    m_inventory->resolveDisk(current);
+    VmSettings::apply(current);
+
+    // Сброс — модель снова выбирает каталог ВМ (virtio-blk для своих образов)
+    VmConfig defaults;
+    defaults.name = vmName;
+    defaults.diskPath = current.diskPath;
+    m_inventory->resolveDisk(defaults);
+
+    DiskConfigDialog dialog(current, defaults.diskProfile, this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    const DiskProfile profile = dialog.profile();
+    VmSettings::saveDiskProfile(vmName, dialog.resetProfile() ? nullptr : &profile);
+    VmSettings::saveExtraDisks(vmName, dialog.extraDisks());
+    if (vm) {
+        VmConfig config = vm->config();
+        m_inventory->resolveDisk(config);
+        VmSettings::apply(config);
+        if (!vm->setConfig(config))
+            appendLog(LogSeverity::Notice, "[Диски] ВМ " + vmName + " работает — новые диски подключатся при следующем запуске");
+    }
+}
+
+void MainWindow::showDiskBench(const QString &vmName)
+{
+    QString path;
+    if (VmInstance *vm = vmName.isEmpty() ? nullptr : m_supervisor->instance(vmName))
+        path = vm->config().diskPath;
+    if (path.isEmpty() && !vmName.isEmpty())
+        path = m_inventory->imagePathFor(vmName);
+    if (path.isEmpty() || !QFileInfo::exists(path))
+        path = QFileDialog::getExistingDirectory(this, "Каталог пула хранения", m_inventory->root());
+    if (path.isEmpty())
+        return;
+
+    DiskBenchDialog dialog(vmName, path, this);
+    // Модель и ro остаются прежними — меняются только опции кэша
+    connect(&dialog, &DiskBenchDialog::applyRequested, this, [this, vmName, &dialog](const DiskBench::Report &report) {
+        VmConfig config;
+        config.name = vmName;
+        if (VmInstance *vm = m_supervisor->instance(vmName))
+            config = vm->config();
+        m_inventory->resolveDisk(config);
+        VmSettings::apply(config);
+        const DiskProfile profile = report.apply(config.diskProfile);
+        VmSettings::saveDiskProfile(vmName, &profile);
+        if (VmInstance *vm = m_supervisor->instance(vmName)) {
+            config.diskProfile = profile;
+            vm->setConfig(config);
+        }
+        dialog.showApplied(profile);
+        appendLog(LogSeverity::Notice, "[Диски] " + vmName + ": профиль по замеру — " + profile.toString());
+    });
+    dialog.exec();
+}
+
+void MainWindow::showCloneDialog(const QString &templateName)
+{
+    CloneDialog dialog(m_cloner, m_inventory, templateName, this);
+    connect(&dialog, &CloneDialog::cloneQueued, this, [this](const QString &templateVm, const QString &name) {
+        appendLog(LogSeverity::Notice, QString("[Клон] %1 → %2").arg(templateVm, name));
+    });
+    dialog.exec();
+}
+
+void MainWindow::updateMemoryStatus()
+{
+    const MemoryAdmission::Snapshot memory = m_supervisor->memoryAdmission()->snapshot();
+    m_memoryStatus->setText("Память: " + memory.summary());
+    m_memoryStatus->setStyleSheet(memory.hostKnown && memory.headroomBytes <= 0 ? "color: red;" : QString());
+}
+
+void MainWindow::stopAllVms()
+{
+    const int active = m_supervisor->activeCount();
+    if (active == 0)
+        return;
+    if (QMessageBox::question(this, "Остановить все",
+                              QString("Остановить все запущенные ВМ (%1)?").arg(active)) != QMessageBox::Yes)
+        return;
+    appendLog(LogSeverity::Warning, QString("[Остановка] Останавливаем %1 ВМ параллельно").arg(m_supervisor->stopAll()));
+}
+
+void MainWindow::showPhaseStats(const QString &vmName)
+{
+    PhaseStatsDialog dialog(m_supervisor->journal(), vmName, this);
+    dialog.exec();
+}
+
+void MainWindow::showConsoleArchive(const QString &vmName)
+{
+    LogArchive *archive = m_supervisor->archive();
+    const QString vmDir = archive->vmDirectory(vmName);
+    if (vmDir.isEmpty()) {
+        QMessageBox::information(this, "Архив консоли", "Архив консоли выключен (console/dir пуст).");
+        return;
+    }
+    ConsoleArchiveDialog dialog(archive, vmName, vmDir, this);
+    dialog.exec();
+}
+
+// Экран ВМ во вкладке общего окна; окно создаётся при первом открытии
+void MainWindow::showDisplay(const QString &vmName)
+{
+    if (!m_displays)
+        m_displays = new DisplayWindow(m_supervisor, this);
+    m_displays->showVm(vmName);
+}
+
+// com1 ВМ во вкладке общего окна консолей — так же, как экраны
+void MainWindow::showConsole(const QString &vmName)
+{
+    if (!m_consoles)
+        m_consoles = new ConsoleWindow(m_supervisor, this);
+    m_consoles->showVm(vmName);
+}
+
+void MainWindow::editDisplayPort(const QString &vmName)
+{
+    VmInstance *running = m_supervisor->instance(vmName);
+    DisplayPortDialog dialog(vmName, VmSettings::loadVncPort(vmName), running ? running->vncPort() : 0, this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    VmSettings::saveVncPort(vmName, dialog.port());
+    if (VmInstance *vm = m_supervisor->instance(vmName)) {
+        VmConfig config = vm->config();
+        config.vncPort = dialog.port();
+        vm->setConfig(config);
+    }
+}
+
+void MainWindow::showLogFor(VmInstance *vm)
+{
+    m_logModel->setBuffer(vm ? vm->log() : m_log);
+    ui->groupBox_2->setTitle(vm ? "Логи — " + vm->name() : "Логи");
+    ui->listView_log->scrollToBottom();
+    m_logFollowTail = true;
+}
+
+// ======================== Лог ========================
+void MainWindow::setupLogView()
+{
+    m_logModel->setBuffer(m_log);
+    ui->listView_log->setModel(m_logModel);
+
+    // Автопрокрутка только если пользователь и так смотрел в самый низ
+    connect(m_logModel, &LogModel::aboutToAppend, this, [this]() {
+        QScrollBar *bar = ui->listView_log->verticalScrollBar();
+        m_logFollowTail = bar->value() >= bar->maximum();
+    });
+    connect(m_logModel, &LogModel::appended, this, [this]() {
+        if (m_logFollowTail)
+            ui->listView_log->scrollToBottom();
+    });
+
+    auto *copyAction = new QAction("Копировать", ui->listView_log);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setShortcutContext(Qt::WidgetShortcut);
+    ui->listView_log->addAction(copyAction);
+    ui->listView_log->setContextMenuPolicy(Qt::ActionsContextMenu);
+    connect(copyAction, &QAction::triggered, this, [this]() {
+        QModelIndexList rows = ui->listView_log->selectionModel()->selectedRows();
+        std::sort(rows.begin(), rows.end());
+        QStringList lines;
+        for (const QModelIndex &idx : rows)
+            lines << m_logModel->lineText(idx.row());
+        QApplication::clipboard()->setText(lines.join('\n'));
+    });
+}
+
+// ======================== ARP-SCAN ========================
+void MainWindow::on_pushButton_arpScan_clicked()
+{
+    // Слот подключён и по имени, и явно — второй вызов застаёт кнопку выключенной
+    if (!ui->pushButton_arpScan->isEnabled())
+        return;
+    // Окно одно на всё время работы; повторное нажатие — новое сканирование в нём же
+    if (!m_arpScan) {
+        m_arpScan = new ArpScanDialog(m_supervisor->commands(), this);
+        connect(m_arpScan, &ArpScanDialog::scanFinished, this, [this]() {
+            ui->pushButton_arpScan->setEnabled(true);
+        });
+    }
+    ui->pushButton_arpScan->setEnabled(false);
+    m_arpScan->scan(vmMacs());
+}
+
+// MAC virtio-net всех известных ВМ: и запущенных, и просто лежащих в каталоге
+QHash<QString, QString> MainWindow::vmMacs() const
+{
+    QHash<QString, QString> macs;
+    for (const VmImageInfo &image : m_inventory->images())
+        macs.insert(VmInstance::guestMacAddress(image.name), image.name);
+    for (VmInstance *vm : m_supervisor->instances())
+        macs.insert(VmInstance::guestMacAddress(vm->name()), vm->name());
+    return macs;
+}
+
+// ======================== Выбор ВМ из индекса ========================
+void MainWindow::showVmPicker()
+{
+    // Индекс уже в памяти (из кэша или фонового скана) — диалог открывается сразу
+    if (m_inventory->images().isEmpty()) {
+        if (!m_inventory->isRootAvailable()) {
+            m_inventory->refresh();  // вдруг диск примонтировали после старта
+            QMessageBox::warning(this, "Ошибка", "Папка с виртуальными машинами не найдена:\n" + m_inventory->root() + "\nУбедитесь, что диск примонтирован.");
+            return;
+        }
+        if (!m_inventory->isScanning()) {
+            QMessageBox::information(this, "Нет виртуальных машин", "Не найдено готовых VM в " + m_inventory->root() + "/\n\nСоздайте структуру:\n" + m_inventory->root() + "/имя_машины/имя_машины.img");
+            return;
+        }
+    }
+
+    VmPickerDialog dialog(m_inventory, this);
+    connect(&dialog, &VmPickerDialog::cloneRequested, this, &MainWindow::showCloneDialog);
+    connect(&dialog, &VmPickerDialog::rootSelected, this, [this](const QString &root) {
+        VmSettings::setInventoryRoot(root);
+        m_inventory->setRoot(root);
+        if (!m_inventory->loadCache())
+            m_inventory->refresh();
+    });
+    if (dialog.exec() != QDialog::Accepted || dialog.selectedVm().isEmpty())
+        return;
+
+    // Выбор двойным щелчком — сразу и запуск, если память уже указана
+    ui->lineEdit_2->setText(dialog.selectedVm());
+    if (!getMemory().isEmpty())
+        QTimer::singleShot(100, this, &MainWindow::on_pushButton_start_clicked);
+}
+
+// ======================== Start VM ========================
+void MainWindow::on_pushButton_start_clicked()
+{
+    VmInstance *running = currentVm();
+    if (running && running->isActive()) {
+        QMessageBox::information(this, "Уже запущено", "ВМ уже запущена или в процессе запуска.");
+        return;
+    }
+
+    QString vmName = getVmName().trimmed();
+    if (vmName.isEmpty()) {
+        showVmPicker();
+        return;
+    }
+
+    QString normalized;
+    QString errMsg;
+    if (!VmConfig::normalizeMemory(getMemory(), &normalized, &errMsg)) {
+        QMessageBox::warning(this, "Неверный объём памяти", errMsg);
+        return;
+    }
+    ui->lineEdit->setText(normalized);
+
+    startVm();
+}
+
+// ======================== Запуск ВМ ========================
+void MainWindow::startVm()
+{
+    VmConfig config = configFromForm();
+    if (config.tap.isEmpty()) {
+        config.tap = m_supervisor->allocateTap();
+        ui->lineEdit_5->setText(config.tap);
+    }
+
+    for (VmInstance *other : m_supervisor->instances()) {
+        if (other->name() != config.name && other->isActive() && other->config().tap == config.tap) {
+            QMessageBox::warning(this, "tap занят",
+                                 QString("%1 уже используется ВМ %2.\nУкажите другой tap-интерфейс или оставьте поле пустым.")
+                                     .arg(config.tap, other->name()));
+            return;
+        }
+    }
+
+    VmInstance *vm = m_supervisor->ensureInstance(config);
+    if (!vm) {
+        QMessageBox::information(this, "Уже запущено", "ВМ уже запущена или в процессе запуска.");
+        return;
+    }
+
+    const int row = m_supervisor->indexOf(vm->name());
+    ui->tableView_vms->selectRow(row);
+    VmSettings::saveLaunch(config);  // vmrun run/daemon поднимут её по имени
+    vm->start();
+    updateVmButtons();
+}
+
+VmConfig MainWindow::configFromForm() const
+{
+    VmConfig config;
+    config.name = getVmName();
+    config.memory = getMemory();
+    config.diskPath = getDiskPath();
+    config.isoPath = getIsoPath();
+    config.tap = getTapInterface();
+    m_inventory->resolveDisk(config);
+    VmSettings::apply(config);
+    return config;
+}
+
+// Запуск через API: память и ISO прошлого запуска из окна, как у vmrun daemon
+bool MainWindow::configByName(const QString &name, VmConfig *config, QString *error) const
+{
+    config->name = name;
+    VmSettings::loadLaunch(*config);
+    if (config->memory.isEmpty()) {
+        *error = "объём памяти не задан: ВМ ещё не запускалась из окна";
+        return false;
+    }
+    if (!VmConfig::normalizeMemory(config->memory, &config->memory, error))
+        return false;
+    m_inventory->resolveDisk(*config);
+    VmSettings::apply(*config);
+    config->tap = m_supervisor->allocateTap();
+    return true;
+}
+
+VmInstance *MainWindow::currentVm() const
+{
+    return m_supervisor->instance(getVmName());
+}
+
+// ======================== Остановка и состояние кнопок ========================
+void MainWindow::on_pushButton_stop_clicked()
+{
+    VmInstance *vm = currentVm();
+    if (vm && vm->isActive())
+        vm->stop();
+}
+
+void MainWindow::updateVmButtons()
+{
+    VmInstance *vm = currentVm();
+    const VmInstance::State state = vm ? vm->state() : VmInstance::State::Stopped;
+
+    ui->pushButton_start->setEnabled(state == VmInstance::State::Stopped || state == VmInstance::State::Failed);
+    ui->pushButton_stop->setEnabled(state == VmInstance::State::Starting
+                                    || state == VmInstance::State::Running
+                                    || state == VmInstance::State::Restarting);
+    switch (state) {
+    case VmInstance::State::Starting:   ui->pushButton_start->setText("Запускается..."); break;
+    case VmInstance::State::Running:    ui->pushButton_start->setText("Запущено"); break;
+    case VmInstance::State::Stopping:   ui->pushButton_start->setText("Очистка..."); break;
+    case VmInstance::State::Restarting: ui->pushButton_start->setText("Перезапустится..."); break;
+    case VmInstance::State::Stopped:
+    case VmInstance::State::Failed:     ui->pushButton_start->setText("Start VM"); break;
+    }
+}
+
+void MainWindow::appendLog(LogSeverity severity, const QString &text)
+{
+    m_log->append(severity, text);
+}
+
+// Сверка вместо "уничтожить всё": tap'ы работающих ВМ остаются и
+// возвращаются в мост, если выпали; лишние уничтожаются параллельно
+void MainWindow::cleanupAllTapDevices()
+{
+    NetworkReconciler *reconciler = m_supervisor->reconciler();
+    appendLog(LogSeverity::Command, "[Очистка] Сверяем tap-интерфейсы и участников " + reconciler->bridge() + "...");
+    ui->pushButton_cleanupTap->setEnabled(false);
+
+    reconciler->cleanup(m_supervisor->expectedTaps(), this, [this](const NetworkReconciler::Report &report) {
+        for (const QString &error : report.errors)
+            appendLog(LogSeverity::Stderr, error);
+        if (report.created == 0 && report.attached == 0 && report.destroyed == 0 && report.failed == 0)
+            appendLog(LogSeverity::Info, "Нет лишних tap-устройств");
+        appendLog(report.failed > 0 ? LogSeverity::Warning : LogSeverity::Success,
+                  "[Готово] Очистка завершена: " + report.summary());
+        ui->pushButton_cleanupTap->setEnabled(true);
+    });
+}
+
+// ======================== Геттеры ========================
+QString MainWindow::getVmName() const       { return ui->lineEdit_2->text().trimmed(); }
+QString MainWindow::getMemory() const       { return ui->lineEdit->text().trimmed(); }
+QString MainWindow::getDiskPath() const     { return ui->lineEdit_3->text().trimmed(); }
+QString MainWindow::getIsoPath() const      { return ui->lineEdit_4->text().trimmed(); }
+QString MainWindow::getTapInterface() const { return ui->lineEdit_5->text().trimmed(); }
@@ -0,0 +1,97 @@
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+
+#include <QHash>
+
+#include "logbuffer.h"
+#include "vmconfig.h"
+
+class ArpScanDialog;
+class LogModel;
+class QLabel;
+class VmSupervisor;
+class VmInstance;
+class VmTableModel;
+class VmInventory;
+class ImageCloner;
+class DisplayWindow;
+class ConsoleWindow;
+class ControlServer;
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class MainWindow; }
+QT_END_NAMESPACE
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
+
+private slots:
+    void on_pushButton_start_clicked();
+    void on_pushButton_stop_clicked();
+    void cleanupAllTapDevices();
+    void on_pushButton_arpScan_clicked();
+
+private:
+    void showVmPicker();
+    void startVm();
+    VmConfig configFromForm() const;
+    bool configByName(const QString &name, VmConfig *config, QString *error) const;
+    VmInstance *currentVm() const;
+    void updateVmButtons();
+
+    void setupVmTable();
+    void onVmSelectionChanged();
+    void showLogFor(VmInstance *vm);
+    void editShutdownPolicy(const QString &vmName);
+    void editRestartPolicy(const QString &vmName);
+    void editCpuConfig(const QString &vmName);
+    void showCpuMap();
+    void editDiskConfig(const QString &vmName);
+    void showDiskBench(const QString &vmName);
+    void showCloneDialog(const QString &templateName);
+    void updateMemoryStatus();
+    void stopAllVms();
+    void showPhaseStats(const QString &vmName);
+    void showConsoleArchive(const QString &vmName);
+    void showDisplay(const QString &vmName);
+    void showConsole(const QString &vmName);
+    void editDisplayPort(const QString &vmName);
+
+    void setupLogView();
+    void appendLog(LogSeverity severity, const QString &text);
+
+    // Геттеры
+    QString getVmName() const;
+    QString getMemory() const;
+    QString getDiskPath() const;
+    QString getIsoPath() const;
+    QString getTapInterface() const;
+
+    QHash<QString, QString> vmMacs() const;
+
+    Ui::MainWindow *ui;
+
+    LogBuffer *m_log;
+    LogModel  *m_logModel;
+    bool m_logFollowTail = true;
+
+    VmSupervisor *m_supervisor;
+    VmTableModel *m_vmModel;
+    VmInventory  *m_inventory;
+    ImageCloner  *m_cloner;
+    DisplayWindow *m_displays = nullptr;
+    ConsoleWindow *m_consoles = nullptr;
+    ControlServer *m_control = nullptr;
+    ArpScanDialog *m_arpScan = nullptr;
+    QLabel *m_memoryStatus = nullptr;
+    static constexpr int MemoryStatusIntervalMs = 2000;
+};
+
+#endif // MAINWINDOW_H
@@ -0,0 +1,82 @@
+#include "phasestatsdialog.h"
+#include "eventjournal.h"
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+PhaseStatsDialog::PhaseStatsDialog(EventJournal *journal, const QString &vmName, QWidget *parent)
+    : QDialog(parent)
+    , m_journal(journal)
+    , m_vm(new QComboBox(this))
+    , m_status(new QLabel(this))
+{
+    setWindowTitle("Задержки фаз");
+    resize(760, 360);
+    auto *layout = new QVBoxLayout(this);
+
+    m_vm->addItem("Все ВМ", QString());
+    for (const QString &name : m_journal->vms())
+        m_vm->addItem(name, name);
+    m_vm->setCurrentIndex(qMax(0, m_vm->findData(vmName)));
+    layout->addWidget(m_vm);
+
+    const QStringList headers = {"Фаза", "Отсчёт от", "n", "p50, мс", "p95, мс", "p99, мс", "max, мс"};
+    m_table = new QTableWidget(EventJournal::PhaseCount, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    layout->addWidget(m_table);
+    layout->addWidget(m_status);
+
+    fill();
+    connect(m_vm, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PhaseStatsDialog::fill);
+    connect(m_journal, &EventJournal::historyLoaded, this, &PhaseStatsDialog::fill);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto *refresh = buttonBox->addButton("Обновить", QDialogButtonBox::ActionRole);
+    connect(refresh, &QPushButton::clicked, this, &PhaseStatsDialog::fill);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttonBox);
+}
+
+void PhaseStatsDialog::fill()
+{
+    const EventJournal::PhaseStats stats = m_journal->stats(m_vm->currentData().toString());
+    for (int row = 0; row < EventJournal::PhaseCount; ++row) {
+        const VmPhase phase = VmPhase(row);
+        const VmPhase anchor = EventJournal::usualAnchor(phase);
+        const LatencyHistogram &h = stats[row];
+        const QStringList cells = {
+            EventJournal::phaseTitle(phase),
+            anchor == phase ? QString("—") : EventJournal::phaseTitle(anchor),
+            QString::number(h.count()),
+            h.count() ? QString::number(h.percentile(50)) : QString(),
+            h.count() ? QString::number(h.percentile(95)) : QString(),
+            h.count() ? QString::number(h.percentile(99)) : QString(),
+            h.count() ? QString::number(h.max()) : QString(),
+        };
+        for (int col = 0; col < cells.size(); ++col) {
+            auto *item = new QTableWidgetItem(cells[col]);
+            if (col >= 2)
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_table->setItem(row, col, item);
+        }
+    }
+
+    QString text = m_journal->file().isEmpty() ? QString("Журнал: только в памяти")
+                                               : "Журнал: " + m_journal->file();
+    if (m_journal->isLoadingHistory())
+        text += " (история ещё загружается)";
+    if (m_journal->droppedCount() > 0)
+        text += QString("; потеряно строк: %1").arg(m_journal->droppedCount());
+    if (!m_journal->writeError().isEmpty())
+        text += "; ошибка записи: " + m_journal->writeError();
+    m_status->setText(text);
+}
@@ -0,0 +1,29 @@
+#ifndef PHASESTATSDIALOG_H
+#define PHASESTATSDIALOG_H
+
+#include <QDialog>
+
+class EventJournal;
+class QComboBox;
+class QLabel;
+class QTableWidget;
+
+// p50/p95/p99 отрезков между фазами запуска и остановки — по журналу событий
+class PhaseStatsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // vmName пустое — сводка по всем ВМ
+    PhaseStatsDialog(EventJournal *journal, const QString &vmName, QWidget *parent = nullptr);
+
+private:
+    void fill();
+
+    EventJournal *m_journal;
+    QComboBox *m_vm;
+    QTableWidget *m_table;
+    QLabel *m_status;
+};
+
+#endif // PHASESTATSDIALOG_H
@@ -0,0 +1,71 @@
+#include "restartpolicydialog.h"
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QSpinBox>
+
+RestartPolicyDialog::RestartPolicyDialog(const QString &vmName, const RestartPolicy &policy, QWidget *parent)
+    : QDialog(parent)
+    , m_mode(new QComboBox(this))
+    , m_jitter(new QSpinBox(this))
+    , m_failures(new QSpinBox(this))
+{
+    setWindowTitle("Перезапуск — " + vmName);
+    auto *form = new QFormLayout(this);
+
+    m_mode->addItem("Никогда", RestartPolicy::Never);
+    m_mode->addItem("При сбое и перезагрузке гостя", RestartPolicy::OnFailure);
+    m_mode->addItem("Всегда", RestartPolicy::Always);
+    m_mode->setCurrentIndex(m_mode->findData(policy.mode));
+
+    auto makeSeconds = [this](int ms, double max) {
+        auto *spin = new QDoubleSpinBox(this);
+        spin->setRange(0, max);
+        spin->setDecimals(1);
+        spin->setSuffix(" с");
+        spin->setValue(ms / 1000.0);
+        return spin;
+    };
+    m_rebootDelay = makeSeconds(policy.rebootDelayMs, 600);
+    m_initialBackoff = makeSeconds(policy.initialBackoffMs, 600);
+    m_maxBackoff = makeSeconds(policy.maxBackoffMs, 3600);
+    m_minUptime = makeSeconds(policy.minUptimeMs, 86400);
+    m_window = makeSeconds(policy.crashLoopWindowMs, 86400);
+
+    m_jitter->setRange(0, 100);
+    m_jitter->setSuffix(" %");
+    m_jitter->setValue(policy.jitterPercent);
+    m_failures->setRange(0, 1000);
+    m_failures->setSpecialValueText("выключен");
+    m_failures->setValue(policy.crashLoopFailures);
+
+    form->addRow("Перезапускать:", m_mode);
+    form->addRow("После перезагрузки гостя:", m_rebootDelay);
+    form->addRow("Первая задержка после сбоя:", m_initialBackoff);
+    form->addRow("Максимальная задержка:", m_maxBackoff);
+    form->addRow("Разброс задержки:", m_jitter);
+    form->addRow("Предохранитель: сбоев", m_failures);
+    form->addRow("…за окно:", m_window);
+    form->addRow("Аптайм, сбрасывающий серию:", m_minUptime);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    form->addRow(buttonBox);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+RestartPolicy RestartPolicyDialog::policy() const
+{
+    RestartPolicy policy;
+    policy.mode = RestartPolicy::Mode(m_mode->currentData().toInt());
+    policy.rebootDelayMs = int(m_rebootDelay->value() * 1000);
+    policy.initialBackoffMs = int(m_initialBackoff->value() * 1000);
+    policy.maxBackoffMs = int(m_maxBackoff->value() * 1000);
+    policy.jitterPercent = m_jitter->value();
+    policy.crashLoopFailures = m_failures->value();
+    policy.crashLoopWindowMs = int(m_window->value() * 1000);
+    policy.minUptimeMs = int(m_minUptime->value() * 1000);
+    return policy;
+}
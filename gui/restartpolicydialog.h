@@ -0,0 +1,34 @@
+#ifndef RESTARTPOLICYDIALOG_H
+#define RESTARTPOLICYDIALOG_H
+
+#include <QDialog>
+
+#include "vmconfig.h"
+
+class QComboBox;
+class QDoubleSpinBox;
+class QSpinBox;
+
+// RestartPolicy одной ВМ: когда перезапускать, backoff, jitter и
+// предохранитель. Только форма — сохраняет результат вызывающий
+class RestartPolicyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    RestartPolicyDialog(const QString &vmName, const RestartPolicy &policy, QWidget *parent = nullptr);
+
+    RestartPolicy policy() const;
+
+private:
+    QComboBox *m_mode;
+    QDoubleSpinBox *m_rebootDelay;
+    QDoubleSpinBox *m_initialBackoff;
+    QDoubleSpinBox *m_maxBackoff;
+    QDoubleSpinBox *m_minUptime;
+    QDoubleSpinBox *m_window;
+    QSpinBox *m_jitter;
+    QSpinBox *m_failures;
+};
+
+#endif // RESTARTPOLICYDIALOG_H
@@ -0,0 +1,141 @@
+#include "rfbclient.h"
+
+#include <QTcpSocket>
+
+// ======================== RfbFrame ========================
+
+void RfbFrame::resize(int width, int height)
+{
+    image = QImage(width, height, QImage::Format_RGB32);
+    image.fill(Qt::black);
+    m_bits = reinterpret_cast<quint32 *>(image.bits());
+    m_stride = image.bytesPerLine() / 4;
+    dirty = QRegion(0, 0, width, height);
+}
+
+// ======================== RfbClient ========================
+
+RfbClient::RfbClient(RfbFrame *frame, QObject *parent)
+    : QObject(parent)
+    , m_frame(frame)
+{
+}
+
+RfbClient::~RfbClient()
+{
+    if (m_socket)
+        m_socket->abort();
+}
+
+void RfbClient::connectToHost(const QString &host, int port)
+{
+    disconnectFromHost();
+    m_decoder.reset(new RfbDecoder(m_frame));
+    m_announced = false;
+    m_width = 0;
+    m_height = 0;
+
+    m_socket = new QTcpSocket(this);
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    // Кадр 1080p без сжатия — 8 МБ: пусть ядро держит побольше
+    m_socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 << 20);
+    connect(m_socket, &QTcpSocket::readyRead, this, &RfbClient::onReadyRead);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, [this]() {
+        drop(m_socket->errorString());
+    });
+    connect(m_socket, &QTcpSocket::disconnected, this, [this]() {
+        drop("сервер закрыл соединение");
+    });
+    m_socket->connectToHost(host, quint16(port));
+}
+
+void RfbClient::disconnectFromHost()
+{
+    if (!m_socket)
+        return;
+    m_socket->disconnect(this);
+    m_socket->abort();
+    m_socket->deleteLater();
+    m_socket = nullptr;
+    m_decoder.reset();
+}
+
+void RfbClient::drop(const QString &error)
+{
+    if (!m_socket)
+        return;
+    disconnectFromHost();
+    emit disconnected(error);
+}
+
+void RfbClient::onReadyRead()
+{
+    if (!m_socket || !m_decoder)
+        return;
+    const qint64 size = m_socket->bytesAvailable();
+    if (size <= 0)
+        return;
+    if (m_buffer.size() < size)
+        m_buffer.resize(int(size));
+    const qint64 got = m_socket->read(m_buffer.data(), size);
+    if (got <= 0)
+        return;
+
+    bool ok;
+    bool dirty;
+    {
+        QMutexLocker lock(&m_frame->mutex);
+        ok = m_decoder->feed(m_buffer.constData(), got);
+        for (const QRect &rect : m_decoder->takeDirtyRects())
+            m_frame->dirty += rect;
+        m_frame->stats = m_decoder->stats();
+        dirty = !m_frame->dirty.isEmpty();
+    }
+    if (!ok) {
+        drop(m_decoder->error());
+        return;
+    }
+
+    if (m_decoder->isReady()) {
+        if (!m_announced) {
+            m_announced = true;
+            m_width = m_decoder->width();
+            m_height = m_decoder->height();
+            emit connected(m_decoder->desktopName(), m_width, m_height);
+        } else if (m_decoder->width() != m_width || m_decoder->height() != m_height) {
+            m_width = m_decoder->width();
+            m_height = m_decoder->height();
+            emit resized(m_width, m_height);
+        }
+    }
+    // Следующий кадр просим сразу — сервер пришлёт, когда экран изменится
+    if (m_decoder->takeCompletedUpdates() > 0)
+        m_decoder->requestUpdate(true);
+    flush();
+
+    if (dirty && !m_frame->pending.exchange(true))
+        emit frameReady();
+}
+
+void RfbClient::sendPointer(int x, int y, int buttons)
+{
+    if (!m_decoder)
+        return;
+    m_decoder->pointerEvent(x, y, buttons);
+    flush();
+}
+
+void RfbClient::sendKey(quint32 keysym, bool down)
+{
+    if (!m_decoder)
+        return;
+    m_decoder->keyEvent(keysym, down);
+    flush();
+}
+
+void RfbClient::flush()
+{
+    const QByteArray out = m_decoder->takeOutput();
+    if (!out.isEmpty() && m_socket)
+        m_socket->write(out);
+}
@@ -0,0 +1,77 @@
+#ifndef RFBCLIENT_H
+#define RFBCLIENT_H
+
+#include <QObject>
+#include <QImage>
+#include <QMutex>
+#include <QRegion>
+#include <atomic>
+#include <memory>
+
+#include "rfbdecoder.h"
+
+class QTcpSocket;
+
+// Экран гостя, общий для потока RfbClient и RfbView. Декодер пишет прямо
+// в строки image (указатель на данные берётся один раз при resize —
+// QImage не отсоединяется и не копируется), окно рисует из него же.
+// Всё под mutex; dirty — где экран менялся с прошлой отрисовки.
+class RfbFrame : public RfbSurface
+{
+public:
+    void resize(int width, int height) override;
+    quint32 *scanLine(int y) override { return m_bits + qptrdiff(y) * m_stride; }
+
+    QMutex mutex;
+    QImage image;  // Format_RGB32
+    QRegion dirty;
+    RfbDecoder::Stats stats;
+    // Сигнал frameReady уже в очереди — следующий не нужен, пока окно не забрало dirty
+    std::atomic_bool pending {false};
+
+private:
+    quint32 *m_bits = nullptr;
+    int m_stride = 0;  // в точках
+};
+
+// RFB-клиент одного экрана. Живёт в отдельном потоке (RfbView): сокет,
+// разбор протокола и перевод точек не трогают поток GUI. Запрос
+// следующего кадра уходит сразу по окончании текущего — скорость
+// ограничивает сервер, а не таймер; сигнал frameReady не копится,
+// пока окно не отрисовало прошлый.
+class RfbClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RfbClient(RfbFrame *frame, QObject *parent = nullptr);
+    ~RfbClient() override;
+
+    // Вызывать в потоке клиента (QMetaObject::invokeMethod)
+    void connectToHost(const QString &host, int port);
+    void disconnectFromHost();
+    void sendPointer(int x, int y, int buttons);
+    void sendKey(quint32 keysym, bool down);
+
+signals:
+    void connected(const QString &desktopName, int width, int height);
+    void resized(int width, int height);
+    void frameReady();
+    // error пуст — отключились сами
+    void disconnected(const QString &error);
+
+private:
+    void onReadyRead();
+    void flush();
+    void drop(const QString &error);
+
+    RfbFrame *m_frame;
+    QTcpSocket *m_socket = nullptr;
+    std::unique_ptr<RfbDecoder> m_decoder;
+    QByteArray m_buffer;  // приёмный, память переиспользуется
+    bool m_announced = false;
+    int m_width = 0;
+    int m_height = 0;
+};
+
+#endif // RFBCLIENT_H
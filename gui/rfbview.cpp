@@ -0,0 +1,379 @@
+#include "rfbview.h"
+
+#include <QCursor>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+
+namespace {
+
+// Кнопки мыши в PointerEvent
+constexpr int LeftButton = 1;
+constexpr int MiddleButton = 2;
+constexpr int RightButton = 4;
+constexpr int WheelUp = 8;
+constexpr int WheelDown = 16;
+
+int buttonBit(Qt::MouseButton button)
+{
+    switch (button) {
+    case Qt::LeftButton:   return LeftButton;
+    case Qt::MiddleButton: return MiddleButton;
+    case Qt::RightButton:  return RightButton;
+    default:               return 0;
+    }
+}
+
+} // namespace
+
+RfbView::RfbView(QWidget *parent)
+    : QWidget(parent)
+    , m_client(new RfbClient(&m_frame))
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFocusPolicy(Qt::StrongFocus);
+    setMouseTracking(true);
+    setMinimumSize(320, 200);
+
+    m_client->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_client, &QObject::deleteLater);
+    connect(m_client, &RfbClient::frameReady, this, &RfbView::onFrameReady);
+    connect(m_client, &RfbClient::connected, this, [this](const QString &name, int width, int height) {
+        m_connected = true;
+        m_error.clear();
+        m_desktopName = name;
+        m_screen = QSize(width, height);
+        updateGeometryMapping();
+        update();
+        updateStatus();
+    });
+    connect(m_client, &RfbClient::resized, this, [this](int width, int height) {
+        m_screen = QSize(width, height);
+        updateGeometryMapping();
+        update();
+        updateStatus();
+    });
+    connect(m_client, &RfbClient::disconnected, this, [this](const QString &error) {
+        m_connected = false;
+        m_error = error;
+        update();
+        updateStatus();
+        if (m_port > 0)
+            m_retry.start();
+    });
+    m_thread.setObjectName("rfb");
+    m_thread.start();
+
+    m_retry.setSingleShot(true);
+    m_retry.setInterval(RetryIntervalMs);
+    connect(&m_retry, &QTimer::timeout, this, &RfbView::reconnect);
+
+    // Частота кадров — по законченным FramebufferUpdate за секунду
+    m_statusTimer.setInterval(1000);
+    connect(&m_statusTimer, &QTimer::timeout, this, [this]() {
+        RfbDecoder::Stats stats;
+        {
+            QMutexLocker lock(&m_frame.mutex);
+            stats = m_frame.stats;
+        }
+        if (stats.updates < m_lastUpdates) {  // новое соединение
+            m_lastUpdates = 0;
+            m_lastDecodeNs = 0;
+        }
+        const qint64 elapsed = m_fpsClock.restart();
+        const qint64 updates = stats.updates - m_lastUpdates;
+        m_fps = elapsed > 0 ? updates * 1000.0 / elapsed : 0;
+        m_decodeMs = updates > 0 ? (stats.decodeNs - m_lastDecodeNs) / 1e6 / updates : 0;
+        m_lastUpdates = stats.updates;
+        m_lastDecodeNs = stats.decodeNs;
+        updateStatus();
+    });
+    m_fpsClock.start();
+    m_statusTimer.start();
+}
+
+RfbView::~RfbView()
+{
+    m_retry.stop();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QSize RfbView::sizeHint() const
+{
+    return m_screen.isEmpty() ? QSize(1024, 640) : m_screen.boundedTo(QSize(1600, 900));
+}
+
+void RfbView::setTarget(const QString &host, int port)
+{
+    if (host == m_host && port == m_port && (m_connected || m_retry.isActive()))
+        return;
+    m_host = host;
+    m_port = port;
+    m_retry.stop();
+    if (port > 0) {
+        reconnect();
+        return;
+    }
+    QMetaObject::invokeMethod(m_client, [client = m_client]() { client->disconnectFromHost(); });
+    m_connected = false;
+    m_error.clear();
+    update();
+    updateStatus();
+}
+
+void RfbView::reconnect()
+{
+    if (m_port <= 0)
+        return;
+    m_connected = false;
+    m_error.clear();
+    updateStatus();
+    QMetaObject::invokeMethod(m_client, [client = m_client, host = m_host, port = m_port]() {
+        client->connectToHost(host, port);
+    });
+}
+
+void RfbView::updateStatus()
+{
+    const QString address = QString("%1:%2").arg(m_host).arg(m_port);
+    QString status;
+    if (m_port <= 0) {
+        status = "Экран недоступен — ВМ не запущена";
+    } else if (m_connected) {
+        status = QString("%1 — %2×%3, %4 к/с, декодер %5 мс/кадр")
+                     .arg(address).arg(m_screen.width()).arg(m_screen.height())
+                     .arg(m_fps, 0, 'f', 0).arg(m_decodeMs, 0, 'f', 1);
+        if (!m_desktopName.isEmpty())
+            status += " (" + m_desktopName + ")";
+    } else if (!m_error.isEmpty()) {
+        status = QString("%1: %2, повтор через %3 с").arg(address, m_error).arg(RetryIntervalMs / 1000);
+    } else {
+        status = "Подключение к " + address + "...";
+    }
+    emit statusChanged(status);
+}
+
+// ======================== Отрисовка ========================
+
+void RfbView::onFrameReady()
+{
+    QRegion dirty;
+    {
+        QMutexLocker lock(&m_frame.mutex);
+        dirty.swap(m_frame.dirty);
+        m_frame.pending = false;
+    }
+    if (m_scale == 1.0) {
+        update(dirty.translated(m_target.topLeft()));
+        return;
+    }
+    QRegion region;
+    for (const QRect &rect : dirty)
+        region += toWidget(rect);
+    update(region);
+}
+
+void RfbView::updateGeometryMapping()
+{
+    if (m_screen.isEmpty()) {
+        m_target = QRect();
+        m_scale = 1.0;
+        return;
+    }
+    if (m_screen.width() <= width() && m_screen.height() <= height()) {
+        m_scale = 1.0;
+        m_target = QRect(QPoint((width() - m_screen.width()) / 2, (height() - m_screen.height()) / 2), m_screen);
+        return;
+    }
+    m_scale = qMax(double(m_screen.width()) / width(), double(m_screen.height()) / height());
+    const QSize size(qRound(m_screen.width() / m_scale), qRound(m_screen.height() / m_scale));
+    m_target = QRect(QPoint((width() - size.width()) / 2, (height() - size.height()) / 2), size);
+}
+
+QRect RfbView::toWidget(const QRect &imageRect) const
+{
+    if (m_scale == 1.0)
+        return imageRect.translated(m_target.topLeft());
+    const QRectF rect(imageRect.x() / m_scale + m_target.x(), imageRect.y() / m_scale + m_target.y(),
+                      imageRect.width() / m_scale, imageRect.height() / m_scale);
+    return rect.toAlignedRect().adjusted(-1, -1, 1, 1);
+}
+
+void RfbView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateGeometryMapping();
+}
+
+void RfbView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    const QRegion region = event->region();
+    for (const QRect &rect : region.subtracted(m_target))
+        painter.fillRect(rect, Qt::black);
+
+    {
+        QMutexLocker lock(&m_frame.mutex);
+        if (!m_frame.image.isNull() && !m_target.isEmpty()) {
+            if (m_scale == 1.0) {
+                // Строки копируются как есть, без преобразования и масштаба
+                for (const QRect &rect : region.intersected(m_target))
+                    painter.drawImage(rect.topLeft(), m_frame.image, rect.translated(-m_target.topLeft()));
+            } else {
+                painter.setRenderHint(QPainter::SmoothPixmapTransform);
+                for (const QRect &rect : region.intersected(m_target)) {
+                    const QRectF source((rect.x() - m_target.x()) * m_scale, (rect.y() - m_target.y()) * m_scale,
+                                        rect.width() * m_scale, rect.height() * m_scale);
+                    painter.drawImage(QRectF(rect), m_frame.image, source);
+                }
+            }
+        }
+    }
+
+    if (!m_connected) {
+        const QString text = m_port <= 0 ? QString("ВМ не запущена")
+                             : m_error.isEmpty() ? QString("Подключение...")
+                                                 : m_error;
+        painter.setPen(Qt::white);
+        painter.fillRect(QRect(0, 0, width(), 28), QColor(0, 0, 0, 180));
+        painter.drawText(QRect(8, 0, width() - 16, 28), Qt::AlignVCenter | Qt::AlignLeft, text);
+    }
+}
+
+// ======================== Ввод ========================
+
+void RfbView::sendPointer(const QPoint &widgetPos, int buttons)
+{
+    if (!m_connected || m_target.isEmpty())
+        return;
+    const int x = qRound((widgetPos.x() - m_target.x()) * m_scale);
+    const int y = qRound((widgetPos.y() - m_target.y()) * m_scale);
+    QMetaObject::invokeMethod(m_client, [client = m_client, x, y, buttons]() {
+        client->sendPointer(x, y, buttons);
+    });
+}
+
+void RfbView::sendKey(quint32 keysym, bool down)
+{
+    if (!m_connected || keysym == 0)
+        return;
+    QMetaObject::invokeMethod(m_client, [client = m_client, keysym, down]() {
+        client->sendKey(keysym, down);
+    });
+}
+
+void RfbView::mousePressEvent(QMouseEvent *event)
+{
+    m_buttons |= buttonBit(event->button());
+    sendPointer(event->pos(), m_buttons);
+}
+
+void RfbView::mouseReleaseEvent(QMouseEvent *event)
+{
+    m_buttons &= ~buttonBit(event->button());
+    sendPointer(event->pos(), m_buttons);
+}
+
+void RfbView::mouseMoveEvent(QMouseEvent *event)
+{
+    sendPointer(event->pos(), m_buttons);
+}
+
+// Колесо в RFB — нажатие и отпускание кнопки 4/5
+void RfbView::wheelEvent(QWheelEvent *event)
+{
+    const int delta = event->angleDelta().y();
+    if (delta == 0)
+        return;
+    const int bit = delta > 0 ? WheelUp : WheelDown;
+    sendPointer(event->position().toPoint(), m_buttons | bit);
+    sendPointer(event->position().toPoint(), m_buttons);
+}
+
+// Tab и Backtab — гостю, а не смене фокуса
+bool RfbView::event(QEvent *event)
+{
+    if (event->type() == QEvent::KeyPress) {
+        auto *key = static_cast<QKeyEvent *>(event);
+        if (key->key() == Qt::Key_Tab || key->key() == Qt::Key_Backtab) {
+            keyPressEvent(key);
+            return true;
+        }
+    }
+    return QWidget::event(event);
+}
+
+void RfbView::keyPressEvent(QKeyEvent *event)
+{
+    const quint32 keysym = keysymFor(event);
+    if (keysym == 0)
+        return;
+    m_pressedKeys.insert(event->key(), keysym);
+    sendKey(keysym, true);
+}
+
+void RfbView::keyReleaseEvent(QKeyEvent *event)
+{
+    // Автоповтор — повторные нажатия без отпусканий, как у настоящей клавиатуры
+    if (event->isAutoRepeat())
+        return;
+    const quint32 keysym = m_pressedKeys.contains(event->key()) ? m_pressedKeys.take(event->key())
+                                                                : keysymFor(event);
+    sendKey(keysym, false);
+}
+
+// Ушёл фокус — гость не должен остаться с зажатым Ctrl
+void RfbView::focusOutEvent(QFocusEvent *event)
+{
+    for (quint32 keysym : qAsConst(m_pressedKeys))
+        sendKey(keysym, false);
+    m_pressedKeys.clear();
+    if (m_buttons) {
+        m_buttons = 0;
+        sendPointer(mapFromGlobal(QCursor::pos()), 0);
+    }
+    QWidget::focusOutEvent(event);
+}
+
+quint32 RfbView::keysymFor(const QKeyEvent *event)
+{
+    static const QHash<int, quint32> special = {
+        {Qt::Key_Backspace, 0xff08}, {Qt::Key_Tab, 0xff09},      {Qt::Key_Backtab, 0xff09},
+        {Qt::Key_Return, 0xff0d},    {Qt::Key_Enter, 0xff8d},    {Qt::Key_Escape, 0xff1b},
+        {Qt::Key_Insert, 0xff63},    {Qt::Key_Delete, 0xffff},   {Qt::Key_Home, 0xff50},
+        {Qt::Key_End, 0xff57},       {Qt::Key_PageUp, 0xff55},   {Qt::Key_PageDown, 0xff56},
+        {Qt::Key_Left, 0xff51},      {Qt::Key_Up, 0xff52},       {Qt::Key_Right, 0xff53},
+        {Qt::Key_Down, 0xff54},      {Qt::Key_Shift, 0xffe1},    {Qt::Key_Control, 0xffe3},
+        {Qt::Key_Meta, 0xffe7},      {Qt::Key_Alt, 0xffe9},      {Qt::Key_AltGr, 0xfe03},
+        {Qt::Key_Super_L, 0xffeb},   {Qt::Key_Super_R, 0xffec},  {Qt::Key_Menu, 0xff67},
+        {Qt::Key_CapsLock, 0xffe5},  {Qt::Key_NumLock, 0xff7f},  {Qt::Key_ScrollLock, 0xff14},
+        {Qt::Key_Print, 0xff61},     {Qt::Key_Pause, 0xff13},
+    };
+    const int key = event->key();
+    const auto it = special.constFind(key);
+    if (it != special.constEnd())
+        return it.value();
+    if (key >= Qt::Key_F1 && key <= Qt::Key_F35)
+        return 0xffbe + quint32(key - Qt::Key_F1);
+
+    // С Ctrl text() — управляющий символ, поэтому буквы берём по клавише;
+    // регистр гость получает от своего Shift
+    // Latin-1 совпадает с keysym, остальной Unicode — 0x01000000 + код
+    const QString text = event->text();
+    auto fromText = [&text]() {
+        const quint32 code = text.at(0).unicode();
+        return code < 0x100 ? code : 0x01000000u | code;
+    };
+    if (key >= Qt::Key_A && key <= Qt::Key_Z) {
+        if (text.size() == 1 && text.at(0).isLetter())
+            return fromText();
+        return 'a' + quint32(key - Qt::Key_A);
+    }
+    if (text.size() == 1 && text.at(0).isPrint())
+        return fromText();
+    if (key >= 0x20 && key < 0x100)
+        return quint32(key);
+    return 0;
+}
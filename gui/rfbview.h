@@ -0,0 +1,93 @@
+#ifndef RFBVIEW_H
+#define RFBVIEW_H
+
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <QTimer>
+
+#include "rfbclient.h"
+
+// Экран гостя в окне: RfbClient в своём потоке декодирует в общий
+// RfbFrame, виджет перерисовывает только изменившиеся прямоугольники.
+// Экран больше окна — уменьшается с сохранением пропорций, меньше —
+// рисуется 1:1 по центру (без масштабирования, строками из QImage).
+// Мышь и клавиатура уходят гостю; пропавшее соединение восстанавливается
+// само, пока задан адрес.
+class RfbView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int RetryIntervalMs = 2000;
+
+    explicit RfbView(QWidget *parent = nullptr);
+    ~RfbView() override;
+
+    // Порт 0 — отключиться и не переподключаться
+    void setTarget(const QString &host, int port);
+    QString host() const { return m_host; }
+    int port() const { return m_port; }
+    bool isConnected() const { return m_connected; }
+
+    // Кадров в секунду за последнюю секунду и время декодера на кадр
+    double framesPerSecond() const { return m_fps; }
+    double decodeMsPerFrame() const { return m_decodeMs; }
+
+    QSize sizeHint() const override;
+
+signals:
+    // Строка для пользователя: адрес, размер экрана, частота кадров или ошибка
+    void statusChanged(const QString &status);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    bool event(QEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void keyReleaseEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void focusOutEvent(QFocusEvent *event) override;
+
+private:
+    void reconnect();
+    void onFrameReady();
+    void updateGeometryMapping();
+    void updateStatus();
+    void sendPointer(const QPoint &widgetPos, int buttons);
+    void sendKey(quint32 keysym, bool down);
+    static quint32 keysymFor(const QKeyEvent *event);
+    QRect toWidget(const QRect &imageRect) const;
+
+    RfbFrame m_frame;
+    QThread m_thread;
+    RfbClient *m_client;
+    QTimer m_retry;
+    QTimer m_statusTimer;
+
+    QString m_host;
+    int m_port = 0;
+    bool m_connected = false;
+    QString m_error;
+    QString m_desktopName;
+    QSize m_screen;
+
+    // Экран → окно: target — куда ложится весь экран, scale — во сколько раз меньше
+    QRect m_target;
+    double m_scale = 1.0;
+
+    int m_buttons = 0;
+    QHash<int, quint32> m_pressedKeys;  // Qt::Key → keysym, чтобы отпустить тем же
+
+    qint64 m_lastDecodeNs = 0;
+    qint64 m_lastUpdates = 0;
+    QElapsedTimer m_fpsClock;
+    double m_fps = 0;
+    double m_decodeMs = 0;
+};
+
+#endif // RFBVIEW_H
@@ -0,0 +1,47 @@
+#include "shutdownpolicydialog.h"
+
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+
+ShutdownPolicyDialog::ShutdownPolicyDialog(const QString &vmName, const ShutdownPolicy &policy, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Остановка — " + vmName);
+    auto *form = new QFormLayout(this);
+
+    auto makeSpin = [this](int ms) {
+        auto *spin = new QDoubleSpinBox(this);
+        spin->setRange(0, 600);
+        spin->setDecimals(1);
+        spin->setSuffix(" с");
+        spin->setSpecialValueText("пропустить");
+        spin->setValue(ms / 1000.0);
+        return spin;
+    };
+    m_powerOff = makeSpin(policy.powerOffMs);
+    m_forcePowerOff = makeSpin(policy.forcePowerOffMs);
+    m_kill = makeSpin(policy.killMs);
+    m_destroy = makeSpin(policy.destroyMs);
+    m_destroy->setSpecialValueText(QString());
+    m_destroy->setMinimum(1);
+    form->addRow("ACPI poweroff (гостевая ОС):", m_powerOff);
+    form->addRow("bhyvectl --force-poweroff:", m_forcePowerOff);
+    form->addRow("SIGKILL:", m_kill);
+    form->addRow("bhyvectl --destroy:", m_destroy);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    form->addRow(buttonBox);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+ShutdownPolicy ShutdownPolicyDialog::policy() const
+{
+    ShutdownPolicy policy;
+    policy.powerOffMs = int(m_powerOff->value() * 1000);
+    policy.forcePowerOffMs = int(m_forcePowerOff->value() * 1000);
+    policy.killMs = int(m_kill->value() * 1000);
+    policy.destroyMs = int(m_destroy->value() * 1000);
+    return policy;
+}
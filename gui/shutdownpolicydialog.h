@@ -0,0 +1,28 @@
+#ifndef SHUTDOWNPOLICYDIALOG_H
+#define SHUTDOWNPOLICYDIALOG_H
+
+#include <QDialog>
+
+#include "vmconfig.h"
+
+class QDoubleSpinBox;
+
+// Дедлайны ступеней остановки одной ВМ. Только форма: сохраняет и
+// применяет результат вызывающий (со следующего запуска ВМ)
+class ShutdownPolicyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ShutdownPolicyDialog(const QString &vmName, const ShutdownPolicy &policy, QWidget *parent = nullptr);
+
+    ShutdownPolicy policy() const;
+
+private:
+    QDoubleSpinBox *m_powerOff;
+    QDoubleSpinBox *m_forcePowerOff;
+    QDoubleSpinBox *m_kill;
+    QDoubleSpinBox *m_destroy;
+};
+
+#endif // SHUTDOWNPOLICYDIALOG_H
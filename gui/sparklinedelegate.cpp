@@ -0,0 +1,63 @@
+#include "sparklinedelegate.h"
+
+#include <QApplication>
+#include <QPainter>
+#include <QPolygonF>
+
+SparklineDelegate::SparklineDelegate(int valueRole, float scaleMax, QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_valueRole(valueRole)
+    , m_scaleMax(scaleMax)
+{
+}
+
+void SparklineDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    const QString text = opt.text;
+    opt.text.clear();
+
+    // Фон и выделение — стилем, как у остальных ячеек
+    const QWidget *widget = opt.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    const QVector<float> values = index.data(m_valueRole).value<QVector<float>>();
+    const QRect area = opt.rect.adjusted(2, 3, -2, -3);
+    if (values.size() >= 2 && area.width() > 4 && area.height() > 2) {
+        float top = m_scaleMax;
+        for (float v : values)
+            top = qMax(top, v);
+
+        QPolygonF line;
+        line.reserve(values.size());
+        const qreal step = qreal(area.width()) / (values.size() - 1);
+        for (int i = 0; i < values.size(); ++i) {
+            const qreal y = area.bottom() - qreal(qBound(0.0f, values.at(i), top)) / top * area.height();
+            line << QPointF(area.left() + i * step, y);
+        }
+
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(QPen(opt.state & QStyle::State_Selected ? opt.palette.highlightedText().color()
+                                                                 : QColor("#1976d2"), 1.2));
+        painter->drawPolyline(line);
+        painter->restore();
+    }
+
+    if (!text.isEmpty()) {
+        painter->save();
+        painter->setPen(opt.state & QStyle::State_Selected ? opt.palette.highlightedText().color()
+                                                           : opt.palette.text().color());
+        painter->drawText(opt.rect.adjusted(2, 0, -4, 0), Qt::AlignRight | Qt::AlignVCenter, text);
+        painter->restore();
+    }
+}
+
+QSize SparklineDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    size.setWidth(qMax(size.width(), 120));
+    return size;
+}
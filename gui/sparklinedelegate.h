@@ -0,0 +1,23 @@
+#ifndef SPARKLINEDELEGATE_H
+#define SPARKLINEDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Мини-график в ячейке: значения из valueRole (QVector<float>), текст
+// ячейки поверх справа. Шкала — от 0 до max(scaleMax, максимум ряда).
+class SparklineDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    SparklineDelegate(int valueRole, float scaleMax, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    int m_valueRole;
+    float m_scaleMax;
+};
+
+#endif // SPARKLINEDELEGATE_H
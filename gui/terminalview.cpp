@@ -0,0 +1,359 @@
+#include "terminalview.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QWheelEvent>
+
+#include <cstring>
+
+namespace {
+
+constexpr QRgb DefaultForeground = 0xd0d0d0;
+constexpr QRgb DefaultBackground = 0x000000;
+constexpr int WheelLines = 3;
+
+// Цвета клетки с учётом Bold (яркие 8–15 вместо 0–7) и Inverse
+void cellColors(const TerminalCell &cell, QRgb *fg, QRgb *bg)
+{
+    int fgIndex = cell.fg;
+    if ((cell.attrs & TerminalCell::Bold) && fgIndex < 8)
+        fgIndex += 8;
+    *fg = (cell.attrs & TerminalCell::DefaultFg) ? DefaultForeground : TerminalScreen::paletteColor(fgIndex);
+    *bg = (cell.attrs & TerminalCell::DefaultBg) ? DefaultBackground : TerminalScreen::paletteColor(cell.bg);
+    if (cell.attrs & TerminalCell::Inverse)
+        std::swap(*fg, *bg);
+}
+
+} // namespace
+
+TerminalView::TerminalView(QWidget *parent)
+    : QWidget(parent)
+    , m_font(QFontDatabase::systemFont(QFontDatabase::FixedFont))
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFocusPolicy(Qt::StrongFocus);
+
+    m_font.setStyleHint(QFont::TypeWriter);
+    m_boldFont = m_font;
+    m_boldFont.setBold(true);
+    const QFontMetrics metrics(m_font);
+    m_cellWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char('M')));
+    m_cellHeight = qMax(1, metrics.height());
+    m_ascent = metrics.ascent();
+
+    m_image = QImage(m_screen.columns() * m_cellWidth, m_screen.rows() * m_cellHeight, QImage::Format_RGB32);
+    m_image.fill(DefaultBackground);
+    m_screen.markAllDirty();
+    scheduleRender();
+}
+
+QSize TerminalView::sizeHint() const
+{
+    return m_image.size() + QSize(8, 8);
+}
+
+void TerminalView::feed(const QByteArray &data)
+{
+    m_screen.feed(data);
+    const QByteArray replies = m_screen.takeReplies();
+    if (!replies.isEmpty())
+        emit input(replies);
+    scheduleRender();
+}
+
+void TerminalView::reset()
+{
+    m_screen.reset();
+    m_scrollOffset = 0;
+    scheduleRender();
+}
+
+// ======================== Отрисовка ========================
+
+void TerminalView::scheduleRender()
+{
+    if (m_renderQueued)
+        return;
+    m_renderQueued = true;
+    QMetaObject::invokeMethod(this, &TerminalView::render, Qt::QueuedConnection);
+}
+
+void TerminalView::render()
+{
+    m_renderQueued = false;
+    const TerminalScreen::Damage damage = m_screen.takeDamage();
+    const QRect grid = m_image.rect();
+    QRegion region;
+
+    if (m_scrollOffset > 0) {
+        // Листаем историю: строки под окном сдвигаются вместе с выводом — рисуем всё
+        if (!damage.isEmpty()) {
+            for (int row = 0; row < m_screen.rows(); ++row)
+                renderRow(row, 0, m_screen.columns());
+            region = grid;
+        }
+    } else {
+        if (damage.scrolledLines > 0) {
+            scrollImage(damage.scrolledLines);
+            region = grid;
+        }
+        for (int row = 0; row < damage.rows.size(); ++row) {
+            const TerminalScreen::Span &span = damage.rows.at(row);
+            if (span.isEmpty())
+                continue;
+            renderRow(row, span.left, span.right);
+            if (damage.scrolledLines == 0)
+                region += QRect(span.left * m_cellWidth, row * m_cellHeight,
+                                (span.right - span.left) * m_cellWidth, m_cellHeight);
+        }
+    }
+
+    const QRect cursor = m_scrollOffset == 0 && m_screen.cursorVisible()
+                             ? cellRect(m_screen.cursorRow(), m_screen.cursorColumn())
+                             : QRect();
+    if (cursor != m_cursorRect) {
+        region += m_cursorRect;
+        region += cursor;
+        m_cursorRect = cursor;
+    }
+    if (!region.isEmpty())
+        update(region.translated(m_origin));
+}
+
+// Строки картинки — подряд в памяти: сдвиг на N строк терминала — один memmove
+void TerminalView::scrollImage(int lines)
+{
+    const int shift = lines * m_cellHeight * m_image.bytesPerLine();
+    const int total = int(m_image.sizeInBytes());
+    if (shift >= total)
+        return;
+    uchar *bits = m_image.bits();
+    std::memmove(bits, bits + shift, size_t(total - shift));
+}
+
+// Клетки одного оформления — одним прямоугольником фона и одной строкой текста
+void TerminalView::renderRow(int row, int left, int right)
+{
+    const QVector<TerminalCell> &line = visibleLine(row);
+    QPainter painter(&m_image);
+    const int end = qMin(right, line.size());
+    if (end < right)
+        painter.fillRect(QRect(end * m_cellWidth, row * m_cellHeight, (right - end) * m_cellWidth, m_cellHeight),
+                         QColor(DefaultBackground));
+
+    const int top = row * m_cellHeight;
+    for (int column = left; column < end;) {
+        const TerminalCell &first = line.at(column);
+        int runEnd = column + 1;
+        while (runEnd < end && line.at(runEnd).sameStyle(first))
+            ++runEnd;
+
+        QRgb fg;
+        QRgb bg;
+        cellColors(first, &fg, &bg);
+        const QRect rect(column * m_cellWidth, top, (runEnd - column) * m_cellWidth, m_cellHeight);
+        painter.fillRect(rect, QColor(bg));
+        painter.setPen(QColor(fg));
+        painter.setFont((first.attrs & TerminalCell::Bold) ? m_boldFont : m_font);
+
+        // ASCII — одной строкой; остальное по клетке: у запасных шрифтов
+        // рамок и кириллицы ширина может отличаться от ширины клетки
+        QString ascii;
+        int asciiStart = column;
+        auto flushAscii = [&]() {
+            if (!ascii.trimmed().isEmpty())
+                painter.drawText(asciiStart * m_cellWidth, top + m_ascent, ascii);
+            ascii.clear();
+        };
+        for (int c = column; c < runEnd; ++c) {
+            const quint32 ch = line.at(c).ch;
+            if (ch >= 0x20 && ch < 0x7f) {
+                if (ascii.isEmpty())
+                    asciiStart = c;
+                ascii += QLatin1Char(char(ch));
+                continue;
+            }
+            flushAscii();
+            if (ch > 0x7f)
+                painter.drawText(c * m_cellWidth, top + m_ascent, QString::fromUcs4(&ch, 1));
+        }
+        flushAscii();
+        if (first.attrs & TerminalCell::Underline)
+            painter.drawLine(rect.left(), top + m_ascent + 1, rect.right(), top + m_ascent + 1);
+        column = runEnd;
+    }
+}
+
+const QVector<TerminalCell> &TerminalView::visibleLine(int row) const
+{
+    const int index = m_screen.scrollbackSize() - m_scrollOffset + row;
+    if (index < m_screen.scrollbackSize())
+        return m_screen.scrollbackLine(index);
+    return m_screen.line(index - m_screen.scrollbackSize());
+}
+
+QRect TerminalView::cellRect(int row, int column) const
+{
+    return QRect(column * m_cellWidth, row * m_cellHeight, m_cellWidth, m_cellHeight);
+}
+
+void TerminalView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_origin = QPoint(qMax(0, (width() - m_image.width()) / 2), qMax(0, (height() - m_image.height()) / 2));
+    update();
+}
+
+void TerminalView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    const QRect grid = m_image.rect().translated(m_origin);
+    const QRegion region = event->region();
+    for (const QRect &rect : region.subtracted(grid))
+        painter.fillRect(rect, QColor(DefaultBackground));
+    for (const QRect &rect : region.intersected(grid))
+        painter.drawImage(rect.topLeft(), m_image, rect.translated(-m_origin));
+
+    // Курсор — инверсией поверх картинки, чтобы не перерисовывать клетку под ним
+    if (!m_cursorRect.isEmpty()) {
+        const QRect cursor = m_cursorRect.translated(m_origin);
+        if (hasFocus()) {
+            painter.setCompositionMode(QPainter::RasterOp_SourceXorDestination);
+            painter.fillRect(cursor, Qt::white);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        } else {
+            painter.setPen(QColor(DefaultForeground));
+            painter.drawRect(cursor.adjusted(0, 0, -1, -1));
+        }
+    }
+
+    if (m_scrollOffset > 0) {
+        const QString text = QString("История: −%1 строк").arg(m_scrollOffset);
+        const QRect label(grid.right() - 200, grid.top(), 200, m_cellHeight + 4);
+        painter.fillRect(label, QColor(0, 0, 0, 180));
+        painter.setPen(Qt::yellow);
+        painter.drawText(label, Qt::AlignCenter, text);
+    }
+}
+
+// ======================== Ввод ========================
+
+void TerminalView::setScrollOffset(int offset)
+{
+    offset = qBound(0, offset, m_screen.scrollbackSize());
+    if (offset == m_scrollOffset)
+        return;
+    m_scrollOffset = offset;
+    m_screen.markAllDirty();
+    scheduleRender();
+    update();
+}
+
+void TerminalView::sendInput(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return;
+    setScrollOffset(0);
+    emit input(data);
+}
+
+void TerminalView::wheelEvent(QWheelEvent *event)
+{
+    const int steps = event->angleDelta().y() / 120;
+    if (steps != 0)
+        setScrollOffset(m_scrollOffset + steps * WheelLines);
+}
+
+// Tab и Backtab — гостю, а не смене фокуса
+bool TerminalView::event(QEvent *event)
+{
+    if (event->type() == QEvent::KeyPress) {
+        auto *key = static_cast<QKeyEvent *>(event);
+        if (key->key() == Qt::Key_Tab || key->key() == Qt::Key_Backtab) {
+            keyPressEvent(key);
+            return true;
+        }
+    }
+    if (event->type() == QEvent::FocusIn || event->type() == QEvent::FocusOut)
+        update(m_cursorRect.translated(m_origin));
+    return QWidget::event(event);
+}
+
+void TerminalView::keyPressEvent(QKeyEvent *event)
+{
+    // Ctrl+Shift+V — вставка из буфера обмена; перевод строки гостю — \r, как Enter
+    if (event->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier) && event->key() == Qt::Key_V) {
+        QString text = QApplication::clipboard()->text();
+        text.replace("\r\n", "\r").replace('\n', '\r');
+        sendInput(text.toUtf8());
+        return;
+    }
+    if (event->modifiers() == Qt::ShiftModifier
+        && (event->key() == Qt::Key_PageUp || event->key() == Qt::Key_PageDown)) {
+        const int page = m_screen.rows() - 1;
+        setScrollOffset(m_scrollOffset + (event->key() == Qt::Key_PageUp ? page : -page));
+        return;
+    }
+    sendInput(bytesFor(event));
+}
+
+QByteArray TerminalView::bytesFor(const QKeyEvent *event) const
+{
+    // DECCKM: в режиме приложения (vi, less) стрелки — ESC O, иначе ESC [
+    const QByteArray cursorPrefix = m_screen.applicationCursorKeys() ? "\x1bO" : "\x1b[";
+    switch (event->key()) {
+    case Qt::Key_Up:        return cursorPrefix + 'A';
+    case Qt::Key_Down:      return cursorPrefix + 'B';
+    case Qt::Key_Right:     return cursorPrefix + 'C';
+    case Qt::Key_Left:      return cursorPrefix + 'D';
+    case Qt::Key_Home:      return cursorPrefix + 'H';
+    case Qt::Key_End:       return cursorPrefix + 'F';
+    case Qt::Key_Insert:    return "\x1b[2~";
+    case Qt::Key_Delete:    return "\x1b[3~";
+    case Qt::Key_PageUp:    return "\x1b[5~";
+    case Qt::Key_PageDown:  return "\x1b[6~";
+    case Qt::Key_Return:
+    case Qt::Key_Enter:     return "\r";
+    case Qt::Key_Backspace: return "\x7f";
+    case Qt::Key_Tab:       return "\t";
+    case Qt::Key_Backtab:   return "\x1b[Z";
+    case Qt::Key_Escape:    return "\x1b";
+    case Qt::Key_F1:        return "\x1bOP";
+    case Qt::Key_F2:        return "\x1bOQ";
+    case Qt::Key_F3:        return "\x1bOR";
+    case Qt::Key_F4:        return "\x1bOS";
+    default:
+        break;
+    }
+    if (event->key() >= Qt::Key_F5 && event->key() <= Qt::Key_F12) {
+        static const int codes[] = {15, 17, 18, 19, 20, 21, 23, 24};
+        return QByteArray("\x1b[") + QByteArray::number(codes[event->key() - Qt::Key_F5]) + '~';
+    }
+
+    // Ctrl+буква — C0 по клавише: text() с Ctrl зависит от раскладки
+    if (event->modifiers() & Qt::ControlModifier) {
+        const int key = event->key();
+        if (key >= Qt::Key_A && key <= Qt::Key_Z)
+            return QByteArray(1, char(key - Qt::Key_A + 1));
+        switch (key) {
+        case Qt::Key_Space:
+        case Qt::Key_At:           return QByteArray(1, '\0');
+        case Qt::Key_BracketLeft:  return "\x1b";
+        case Qt::Key_Backslash:    return "\x1c";
+        case Qt::Key_BracketRight: return "\x1d";
+        case Qt::Key_AsciiCircum:  return "\x1e";
+        case Qt::Key_Underscore:   return "\x1f";
+        default:                   break;
+        }
+    }
+
+    const QByteArray text = event->text().toUtf8();
+    if (text.isEmpty())
+        return QByteArray();
+    // Alt — префикс ESC, как у xterm с metaSendsEscape
+    return (event->modifiers() & Qt::AltModifier) ? "\x1b" + text : text;
+}
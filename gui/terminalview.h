@@ -0,0 +1,69 @@
+#ifndef TERMINALVIEW_H
+#define TERMINALVIEW_H
+
+#include <QWidget>
+#include <QFont>
+#include <QImage>
+
+#include "terminalscreen.h"
+
+// Терминал com1 в окне: TerminalScreen разбирает байты гостя, виджет
+// рисует его в свою картинку только там, где экран повреждён. Прокрутка
+// всего экрана сдвигает готовую картинку строками (memmove) и дорисовывает
+// новые строки — поток загрузки ядра не перерисовывает 80×25 клеток на
+// каждую строку. Разбор — сразу в feed(), отрисовка — одна на проход
+// цикла событий, сколько бы кусков ни пришло.
+//
+// Размер сетки — фиксированный (по умолчанию 80×25): у com1 нет способа
+// сообщить гостю размер окна. Колесо листает историю, любая клавиша
+// возвращает вниз. Нажатия — байтами xterm в input(); туда же уходят
+// ответы экрана на запросы гостя (DSR, DA).
+class TerminalView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TerminalView(QWidget *parent = nullptr);
+
+    void feed(const QByteArray &data);
+    // Новый запуск гостя: экран с нуля, история прокрутки остаётся
+    void reset();
+
+    const TerminalScreen &screen() const { return m_screen; }
+    QSize sizeHint() const override;
+
+signals:
+    void input(const QByteArray &data);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    bool event(QEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void scheduleRender();
+    void render();
+    void renderRow(int row, int left, int right);
+    void scrollImage(int lines);
+    void setScrollOffset(int offset);
+    void sendInput(const QByteArray &data);
+    const QVector<TerminalCell> &visibleLine(int row) const;
+    QRect cellRect(int row, int column) const;
+    QByteArray bytesFor(const QKeyEvent *event) const;
+
+    TerminalScreen m_screen;
+    QFont m_font;
+    QFont m_boldFont;
+    int m_cellWidth = 8;
+    int m_cellHeight = 16;
+    int m_ascent = 12;
+    QImage m_image;
+    QPoint m_origin;            // где в виджете левый верхний угол сетки
+    bool m_renderQueued = false;
+    int m_scrollOffset = 0;     // строк истории над экраном; 0 — экран гостя
+    QRect m_cursorRect;         // где курсор нарисован сейчас
+};
+
+#endif // TERMINALVIEW_H
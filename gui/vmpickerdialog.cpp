@@ -0,0 +1,63 @@
+#include "vmpickerdialog.h"
+#include "vminventory.h"
+
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QListWidget>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+VmPickerDialog::VmPickerDialog(VmInventory *inventory, QWidget *parent)
+    : QDialog(parent)
+    , m_inventory(inventory)
+    , m_list(new QListWidget(this))
+{
+    setMinimumWidth(420);
+    setMinimumHeight(560);
+    auto *layout = new QVBoxLayout(this);
+    layout->addWidget(m_list);
+
+    populate();
+    connect(m_inventory, &VmInventory::changed, this, &VmPickerDialog::populate);
+    connect(m_inventory, &VmInventory::scanFinished, this, &VmPickerDialog::populate);
+
+    m_list->setStyleSheet("QListWidget { font-size: 14px; } QListWidget::item { padding: 12px; } QListWidget::item:selected { background: #0078d4; color: white; }");
+    connect(m_list, &QListWidget::itemDoubleClicked, this, [this](QListWidgetItem *item) {
+        m_list->setCurrentItem(item);
+        accept();
+    });
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Cancel, this);
+    auto *rootButton = buttonBox->addButton("Папка...", QDialogButtonBox::ResetRole);
+    auto *cloneButton = buttonBox->addButton("Клонировать...", QDialogButtonBox::ActionRole);
+    layout->addWidget(buttonBox);
+    connect(cloneButton, &QPushButton::clicked, this, [this]() { emit cloneRequested(selectedVm()); });
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(rootButton, &QPushButton::clicked, this, [this]() {
+        const QString root = QFileDialog::getExistingDirectory(this, "Папка с виртуальными машинами", m_inventory->root());
+        if (!root.isEmpty())
+            emit rootSelected(root);
+    });
+}
+
+QString VmPickerDialog::selectedVm() const
+{
+    return m_list->currentItem() ? m_list->currentItem()->data(Qt::UserRole).toString() : QString();
+}
+
+void VmPickerDialog::populate()
+{
+    const QString selected = selectedVm();
+    setWindowTitle(m_inventory->isScanning() ? "Выберите виртуальную машину (обновляется...)" : "Выберите виртуальную машину");
+    m_list->clear();
+    for (const VmImageInfo &vm : m_inventory->images()) {
+        const QString sizeStr = QString::number(vm.size / 1024.0 / 1024 / 1024, 'f', 2) + " ГБ";
+        const QString itemText = QString("%1 (%2, %3)").arg(vm.name).arg(sizeStr).arg(QDateTime::fromMSecsSinceEpoch(vm.mtimeMs).toString("dd.MM.yyyy hh:mm"));
+        auto *item = new QListWidgetItem(itemText);
+        item->setData(Qt::UserRole, vm.name);
+        m_list->addItem(item);
+        if (vm.name == selected)
+            m_list->setCurrentItem(item);
+    }
+}
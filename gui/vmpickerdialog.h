@@ -0,0 +1,34 @@
+#ifndef VMPICKERDIALOG_H
+#define VMPICKERDIALOG_H
+
+#include <QDialog>
+
+class QListWidget;
+class VmInventory;
+
+// Выбор ВМ из индекса VmInventory; список обновляется вместе с фоновым
+// сканом. Двойной щелчок — выбрать и закрыть окно
+class VmPickerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit VmPickerDialog(VmInventory *inventory, QWidget *parent = nullptr);
+
+    // Пусто, если ничего не выбрано
+    QString selectedVm() const;
+
+signals:
+    // "Клонировать..." — шаблоном служит выделенная ВМ (может быть пусто)
+    void cloneRequested(const QString &templateName);
+    // Пользователь выбрал другую папку с ВМ
+    void rootSelected(const QString &root);
+
+private:
+    void populate();
+
+    VmInventory *m_inventory;
+    QListWidget *m_list;
+};
+
+#endif // VMPICKERDIALOG_H
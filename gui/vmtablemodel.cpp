@@ -0,0 +1,220 @@
+#include "vmtablemodel.h"
+#include "vmsupervisor.h"
+#include "vminstance.h"
+#include "resourcesampler.h"
+
+#include <QColor>
+#include <QDateTime>
+
+VmTableModel::VmTableModel(VmSupervisor *supervisor, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_supervisor(supervisor)
+{
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(UpdateIntervalMs);
+    connect(&m_updateTimer, &QTimer::timeout, this, &VmTableModel::flushDirty);
+
+    connect(m_supervisor, &VmSupervisor::instanceAdded, this, [this](int row) {
+        beginInsertRows(QModelIndex(), row, row);
+        endInsertRows();
+    });
+    connect(m_supervisor, &VmSupervisor::instanceAboutToBeRemoved, this, [this](int row) {
+        beginRemoveRows(QModelIndex(), row, row);
+    });
+    connect(m_supervisor, &VmSupervisor::instanceRemoved, this, [this]() {
+        endRemoveRows();
+        // Накопленный диапазон мог съехать — проще обновить всё
+        if (m_dirtyFirst >= 0) {
+            markDirty(0);
+            markDirty(rowCount() - 1);
+        }
+    });
+    connect(m_supervisor, &VmSupervisor::instanceChanged, this, &VmTableModel::markDirty);
+    // Новый замер — перерисовать всё одним dataChanged в общем ритме таблицы.
+    // Память хоста читаем тут же, а не в data() на каждую ячейку
+    connect(m_supervisor->sampler(), &ResourceSampler::sampled, this, &VmTableModel::refreshMemory);
+    connect(m_supervisor->memoryAdmission(), &MemoryAdmission::changed, this, &VmTableModel::refreshMemory);
+    m_memory = m_supervisor->memoryAdmission()->snapshot();
+}
+
+void VmTableModel::refreshMemory()
+{
+    m_memory = m_supervisor->memoryAdmission()->snapshot();
+    if (rowCount() > 0) {
+        markDirty(0);
+        markDirty(rowCount() - 1);
+    }
+}
+
+int VmTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_supervisor->count();
+}
+
+int VmTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant VmTableModel::data(const QModelIndex &index, int role) const
+{
+    const VmInstance *vm = instanceAt(index.row());
+    if (!vm)
+        return QVariant();
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case NameColumn:     return vm->name();
+        case StateColumn:    return VmInstance::stateName(vm->state());
+        case MemoryColumn:   return vm->config().memory;
+        case HeadroomColumn: {
+            // Для остановленной — сколько останется после её запуска
+            if (vm->isWaitingForMemory())
+                return "ждёт памяти";
+            if (vm->isActive() || !m_memory.hostKnown)
+                return QVariant();
+            const qint64 need = qint64(MemoryAdmission::parseMemory(vm->config().memory));
+            return MemoryAdmission::formatBytes(m_memory.headroomBytes - need);
+        }
+        case TapColumn:      return vm->config().tap;
+        case VncColumn:      return vm->vncPort() > 0 ? QVariant(vm->vncPort()) : QVariant();
+        case PidColumn:      return vm->processId() > 0 ? QVariant(vm->processId()) : QVariant();
+        case StartedColumn:
+            return vm->startedAtMs() > 0
+                ? QDateTime::fromMSecsSinceEpoch(vm->startedAtMs()).toString("dd.MM hh:mm:ss")
+                : QString();
+        case NetworkColumn:  return vm->networkReadyMs() >= 0 ? QVariant(vm->networkReadyMs()) : QVariant();
+        case CpuColumn:
+        case RssColumn: {
+            if (!vm->isActive())
+                return QVariant();
+            const auto ring = m_supervisor->sampler()->ring(vm->name());
+            ResourceSample sample;
+            if (!ring || !ring->latest(&sample))
+                return QVariant();
+            if (index.column() == CpuColumn)
+                return QString::number(sample.cpuPercent, 'f', 0) + "%";
+            return QString::number(sample.rssBytes / 1024.0 / 1024 / 1024, 'f', 2) + " ГБ";
+        }
+        case RestartsColumn: return vm->restartCount();
+        default:             return QVariant();
+        }
+    }
+
+    if (role == Qt::ToolTipRole && index.column() == NetworkColumn && vm->networkReadyStats().count())
+        return "Старт → tap в bridge0: " + vm->networkReadyStats().summary();
+
+    if (role == SparklineRole && index.column() == CpuColumn) {
+        const auto ring = m_supervisor->sampler()->ring(vm->name());
+        QVector<float> values;
+        if (ring) {
+            const QVector<ResourceSample> samples = ring->snapshot(SparklineSamples);
+            values.reserve(samples.size());
+            for (const ResourceSample &sample : samples)
+                values.append(sample.cpuPercent);
+        }
+        return QVariant::fromValue(values);
+    }
+
+    if (role == Qt::ToolTipRole && (index.column() == CpuColumn || index.column() == RssColumn)) {
+        const auto ring = m_supervisor->sampler()->ring(vm->name());
+        ResourceSample sample;
+        if (!ring || !ring->latest(&sample))
+            return QVariant();
+        QString tip = QString("CPU %1%, RSS %2 МБ\nЧтение %3 оп/с, запись %4 оп/с")
+                          .arg(sample.cpuPercent, 0, 'f', 1)
+                          .arg(sample.rssBytes >> 20)
+                          .arg(sample.readOpsPerSec, 0, 'f', 0)
+                          .arg(sample.writeOpsPerSec, 0, 'f', 0);
+        if (sample.hasIoBytes)
+            tip += QString("\nДиск: %1 КБ/с чтение, %2 КБ/с запись")
+                       .arg(sample.readBytesPerSec / 1024, 0, 'f', 0)
+                       .arg(sample.writeBytesPerSec / 1024, 0, 'f', 0);
+        tip += QString("\nСэмплер (%1): %2% ядра")
+                   .arg(m_supervisor->sampler()->backendName())
+                   .arg(m_supervisor->sampler()->overheadRatio() * 100, 0, 'f', 3);
+        return tip;
+    }
+
+    if (role == Qt::ToolTipRole && index.column() == RestartsColumn)
+        return vm->restarts().summary();
+
+    if (role == Qt::ToolTipRole && index.column() == StateColumn) {
+        if (vm->state() == VmInstance::State::Stopping && vm->stopStage() != VmInstance::StopStage::None)
+            return "Ступень остановки: " + VmInstance::stopStageName(vm->stopStage());
+        if (vm->stopStats().count())
+            return "Остановка: " + vm->stopStats().summary();
+    }
+
+    if (role == Qt::ForegroundRole && index.column() == RestartsColumn && vm->restarts().isCrashLoop())
+        return QColor(Qt::red);
+
+    if (role == Qt::ForegroundRole && index.column() == HeadroomColumn) {
+        if (vm->isWaitingForMemory())
+            return QColor("orange");
+        if (!vm->isActive() && m_memory.hostKnown
+            && qint64(MemoryAdmission::parseMemory(vm->config().memory)) > m_memory.headroomBytes)
+            return QColor(Qt::red);
+    }
+
+    if (role == Qt::ToolTipRole && index.column() == HeadroomColumn)
+        return "Память хоста: " + m_memory.summary();
+
+    if (role == Qt::ForegroundRole && index.column() == StateColumn) {
+        switch (vm->state()) {
+        case VmInstance::State::Running:    return QColor("#2e7d32");
+        case VmInstance::State::Starting:
+        case VmInstance::State::Restarting: return QColor("orange");
+        case VmInstance::State::Stopping:   return QColor(Qt::blue);
+        case VmInstance::State::Failed:     return QColor(Qt::red);
+        case VmInstance::State::Stopped:    break;
+        }
+    }
+    return QVariant();
+}
+
+QVariant VmTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (section) {
+    case NameColumn:     return "Имя";
+    case StateColumn:    return "Состояние";
+    case MemoryColumn:   return "Память";
+    case HeadroomColumn: return "Запас";
+    case TapColumn:      return "tap";
+    case VncColumn:      return "VNC";
+    case PidColumn:      return "PID";
+    case StartedColumn:  return "Запущена";
+    case NetworkColumn:  return "Сеть, мс";
+    case CpuColumn:      return "CPU";
+    case RssColumn:      return "RSS";
+    case RestartsColumn: return "Рестарты";
+    default:             return QVariant();
+    }
+}
+
+VmInstance *VmTableModel::instanceAt(int row) const
+{
+    return m_supervisor->at(row);
+}
+
+void VmTableModel::markDirty(int row)
+{
+    if (row < 0)
+        return;
+    m_dirtyFirst = (m_dirtyFirst < 0) ? row : qMin(m_dirtyFirst, row);
+    m_dirtyLast = qMax(m_dirtyLast, row);
+    if (!m_updateTimer.isActive())
+        m_updateTimer.start();
+}
+
+void VmTableModel::flushDirty()
+{
+    const int last = qMin(m_dirtyLast, rowCount() - 1);
+    if (m_dirtyFirst >= 0 && m_dirtyFirst <= last)
+        emit dataChanged(index(m_dirtyFirst, 0), index(last, ColumnCount - 1));
+    m_dirtyFirst = -1;
+    m_dirtyLast = -1;
+}
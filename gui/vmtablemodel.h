@@ -0,0 +1,64 @@
+#ifndef VMTABLEMODEL_H
+#define VMTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QTimer>
+
+#include "memoryadmission.h"
+
+class VmSupervisor;
+class VmInstance;
+
+// Таблица ВМ поверх VmSupervisor. Изменения отдельных ВМ копятся и уходят
+// одним dataChanged() на диапазон строк раз в UpdateIntervalMs — при сотнях
+// ВМ, меняющих состояние одновременно, вид перерисовывается один раз.
+class VmTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        NameColumn,
+        StateColumn,
+        MemoryColumn,
+        HeadroomColumn,
+        TapColumn,
+        VncColumn,
+        PidColumn,
+        StartedColumn,
+        NetworkColumn,
+        CpuColumn,
+        RssColumn,
+        RestartsColumn,
+        ColumnCount
+    };
+
+    static constexpr int UpdateIntervalMs = 100;
+    static constexpr int SparklineSamples = 60;
+    // QVector<float> последних загрузок CPU (%) для SparklineDelegate
+    static constexpr int SparklineRole = Qt::UserRole + 1;
+
+    explicit VmTableModel(VmSupervisor *supervisor, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    VmInstance *instanceAt(int row) const;
+    // Последний снимок MemoryAdmission — общий для всех строк
+    const MemoryAdmission::Snapshot &memory() const { return m_memory; }
+
+private:
+    void refreshMemory();
+    void markDirty(int row);
+    void flushDirty();
+
+    VmSupervisor *m_supervisor;
+    QTimer m_updateTimer;
+    int m_dirtyFirst = -1;
+    int m_dirtyLast = -1;
+    MemoryAdmission::Snapshot m_memory;
+};
+
+#endif // VMTABLEMODEL_H
@@ -0,0 +1,18 @@
+#include "consolesample.h"
+
+#include <QString>
+
+QByteArray consoleSample(int bytes)
+{
+    QByteArray sample;
+    for (int i = 0; sample.size() < bytes; ++i) {
+        sample += QString("\x1b[1;32m[  OK  ]\x1b[0m Запущена служба %1 ─── \x1b[33m%2\x1b[0m\r\n")
+                      .arg(i).arg(QString(i % 40, QLatin1Char('#')))
+                      .toUtf8();
+        if (i % 50 == 0)
+            sample += "\x1b[5;10H\x1b[K\x1b[7m статус \x1b[27m\x1b[25;1H";
+        if (i % 500 == 0)
+            sample += "\x1b(0lqqqk\x1b(B\x1b[6n";
+    }
+    return sample;
+}
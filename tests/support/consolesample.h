@@ -0,0 +1,11 @@
+#ifndef CONSOLESAMPLE_H
+#define CONSOLESAMPLE_H
+
+#include <QByteArray>
+
+// Вывод загрузки на com1 не меньше bytes байт: цвет, рамки DEC Special
+// Graphics, кириллица, позиционирование курсора и запросы DSR — всё, что
+// TerminalScreen разбирает в окне консоли
+QByteArray consoleSample(int bytes);
+
+#endif // CONSOLESAMPLE_H
@@ -0,0 +1,16 @@
+# Модели GUI без главного окна — для проверок под QT_QPA_PLATFORM=offscreen
+# (main — VMRUN_OFFSCREEN_TEST_MAIN из offscreenmain.h)
+QT += gui widgets
+
+GUI_DIR = $$PWD/../../gui
+INCLUDEPATH += $$GUI_DIR
+DEPENDPATH += $$GUI_DIR
+
+SOURCES += \
+    $$GUI_DIR/logmodel.cpp \
+    $$GUI_DIR/vmtablemodel.cpp
+
+HEADERS += \
+    $$PWD/offscreenmain.h \
+    $$GUI_DIR/logmodel.h \
+    $$GUI_DIR/vmtablemodel.h
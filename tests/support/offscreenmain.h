@@ -0,0 +1,22 @@
+#ifndef OFFSCREENMAIN_H
+#define OFFSCREENMAIN_H
+
+#include <QApplication>
+#include <QtTest>
+
+// QTEST_MAIN для тестов и замеров с моделями и видами GUI: без дисплея
+// (CI, ssh на узел) — платформа offscreen, виды рисуются в память.
+// Заданная явно QT_QPA_PLATFORM остаётся — можно смотреть глазами
+#define VMRUN_OFFSCREEN_TEST_MAIN(TestObject) \
+    int main(int argc, char *argv[]) \
+    { \
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) \
+            qputenv("QT_QPA_PLATFORM", "offscreen"); \
+        QApplication app(argc, argv); \
+        app.setAttribute(Qt::AA_Use96Dpi, true); \
+        TestObject tc; \
+        QTEST_SET_MAIN_SOURCE_PATH \
+        return QTest::qExec(&tc, argc, argv); \
+    }
+
+#endif // OFFSCREENMAIN_H
@@ -0,0 +1,25 @@
+#include "processmemory.h"
+#include "processstats.h"
+
+#include <QCoreApplication>
+
+#include <sys/resource.h>
+
+quint64 peakRssBytes()
+{
+    rusage usage {};
+    if (::getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef Q_OS_MACOS
+    return quint64(usage.ru_maxrss);
+#else
+    return quint64(usage.ru_maxrss) * 1024;
+#endif
+}
+
+quint64 currentRssBytes()
+{
+    static const std::unique_ptr<ProcessStatsBackend> backend = ProcessStatsBackend::create();
+    ProcessStats stats;
+    return backend->read(QCoreApplication::applicationPid(), &stats) ? stats.rssBytes : 0;
+}
@@ -0,0 +1,12 @@
+#ifndef PROCESSMEMORY_H
+#define PROCESSMEMORY_H
+
+#include <QtGlobal>
+
+// Память своего процесса для замеров. Пик — getrusage(RUSAGE_SELF):
+// ru_maxrss в КиБ на Linux и FreeBSD, в байтах на macOS. Текущая — через
+// ProcessStatsBackend, как у ResourceSampler; 0 — прочитать нечем
+quint64 peakRssBytes();
+quint64 currentRssBytes();
+
+#endif // PROCESSMEMORY_H
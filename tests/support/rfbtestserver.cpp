@@ -0,0 +1,491 @@
+#include "rfbtestserver.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// Поток RfbTestServer; клиента ждёт 5 с, после последнего кадра закрывает соединение
+void serveRfb(int listenFd, int width, int height, const std::vector<QByteArray> *updates, QString *error)
+{
+    auto fail = [error](const QString &text) { *error = text; };
+    pollfd accepting {listenFd, POLLIN, 0};
+    if (::poll(&accepting, 1, 5000) <= 0) {
+        fail("клиент не подключился");
+        return;
+    }
+    const int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+        fail("accept: " + qt_error_string(errno));
+        return;
+    }
+    auto sendAll = [fd](const char *data, qint64 size) {
+        while (size > 0) {
+            const ssize_t n = ::send(fd, data, size_t(size), MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= n;
+        }
+        return true;
+    };
+    QByteArray in;
+    auto readAtLeast = [fd, &in](int bytes) {
+        char buffer[4096];
+        while (in.size() < bytes) {
+            pollfd reading {fd, POLLIN, 0};
+            if (::poll(&reading, 1, 5000) <= 0)
+                return false;
+            const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+                return false;
+            in.append(buffer, int(n));
+        }
+        return true;
+    };
+
+    QByteArray init("RFB 003.008\n");
+    init.append(char(1));  // один тип безопасности — None
+    init.append(char(1));
+    if (!sendAll(init.constData(), init.size()) || !readAtLeast(12 + 1)) {
+        fail("рукопожатие: клиент не ответил");
+        ::close(fd);
+        return;
+    }
+    in.remove(0, 13);
+    QByteArray serverInit;
+    appendBe32(serverInit, 0);  // SecurityResult: OK
+    if (!sendAll(serverInit.constData(), serverInit.size()) || !readAtLeast(1)) {
+        fail("ClientInit не пришёл");
+        ::close(fd);
+        return;
+    }
+    in.remove(0, 1);
+    serverInit.clear();
+    appendBe16(serverInit, quint16(width));
+    appendBe16(serverInit, quint16(height));
+    serverInit.append(RfbDecoder::PixelFormat::native().encode());
+    appendBe32(serverInit, 4);
+    serverInit.append("test");
+    sendAll(serverInit.constData(), serverInit.size());
+
+    // Сообщения клиента: SetPixelFormat, SetEncodings, запросы кадров
+    size_t next = 0;
+    while (next < updates->size()) {
+        if (!readAtLeast(1))
+            break;
+        const int type = uchar(in.at(0));
+        int length = 0;
+        switch (type) {
+        case 0: length = 20; break;
+        case 2:
+            if (!readAtLeast(4))
+                break;
+            length = 4 + 4 * qFromBigEndian<quint16>(in.constData() + 2);
+            break;
+        case 3: length = 10; break;
+        case 4: length = 8; break;
+        case 5: length = 6; break;
+        default:
+            fail(QString("неизвестное сообщение клиента: %1").arg(type));
+            next = updates->size();
+            continue;
+        }
+        if (length == 0 || !readAtLeast(length))
+            break;
+        if (type == 0 && !(RfbDecoder::PixelFormat::decode(in.constData() + 4).encode()
+                           == RfbDecoder::PixelFormat::native().encode())) {
+            fail("клиент попросил не родной формат точек");
+            break;
+        }
+        in.remove(0, length);
+        if (type == 3) {
+            const QByteArray &update = (*updates)[next++];
+            if (!sendAll(update.constData(), update.size()))
+                break;
+        }
+    }
+    if (next < updates->size() && error->isEmpty())
+        fail(QString("клиент ушёл после %1 кадров из %2").arg(next).arg(updates->size()));
+    ::close(fd);
+}
+
+} // namespace
+
+void appendBe16(QByteArray &out, quint16 value)
+{
+    const char bytes[2] = {char(value >> 8), char(value)};
+    out.append(bytes, 2);
+}
+
+void appendBe32(QByteArray &out, quint32 value)
+{
+    appendBe16(out, quint16(value >> 16));
+    appendBe16(out, quint16(value));
+}
+
+void appendRectHeader(QByteArray &out, const QRect &rect, qint32 encoding)
+{
+    appendBe16(out, quint16(rect.x()));
+    appendBe16(out, quint16(rect.y()));
+    appendBe16(out, quint16(rect.width()));
+    appendBe16(out, quint16(rect.height()));
+    appendBe32(out, quint32(encoding));
+}
+
+void appendRaw(QByteArray &out, const RfbScreen &screen, const QRect &rect)
+{
+    appendRectHeader(out, rect, RfbDecoder::Raw);
+    for (int y = rect.y(); y <= rect.y() + rect.height() - 1; ++y) {
+        const quint32 *src = screen.row(y) + rect.x();
+        for (int x = 0; x < rect.width(); ++x) {
+            const quint32 value = src[x] | 0x5a000000u;
+            const char bytes[4] = {char(value), char(value >> 8), char(value >> 16), char(value >> 24)};
+            out.append(bytes, 4);
+        }
+    }
+}
+
+void appendCopyRect(QByteArray &out, RfbScreen &screen, const QRect &rect, const QPoint &source)
+{
+    appendRectHeader(out, rect, RfbDecoder::CopyRect);
+    appendBe16(out, quint16(source.x()));
+    appendBe16(out, quint16(source.y()));
+    std::vector<quint32> copy(size_t(rect.width()) * rect.height());
+    for (int y = 0; y < rect.height(); ++y)
+        std::copy_n(screen.row(source.y() + y) + source.x(), rect.width(), copy.data() + size_t(y) * rect.width());
+    for (int y = 0; y < rect.height(); ++y)
+        std::copy_n(copy.data() + size_t(y) * rect.width(), rect.width(), screen.row(rect.y() + y) + rect.x());
+}
+
+QByteArray beginUpdate(int rects)
+{
+    QByteArray update;
+    update.append(char(0));  // FramebufferUpdate
+    update.append(char(0));
+    appendBe16(update, quint16(rects));
+    return update;
+}
+
+QByteArray serverHandshake(int width, int height, const QByteArray &name)
+{
+    QByteArray out("RFB 003.008\n");
+    out.append(char(1));  // один тип безопасности — None
+    out.append(char(1));
+    appendBe32(out, 0);  // SecurityResult: OK
+    appendBe16(out, quint16(width));
+    appendBe16(out, quint16(height));
+    out.append(RfbDecoder::PixelFormat::native().encode());
+    appendBe32(out, quint32(name.size()));
+    out.append(name);
+    return out;
+}
+
+// ======================== ZrleEncoder ========================
+
+ZrleEncoder::ZrleEncoder()
+{
+    std::memset(&m_stream, 0, sizeof(m_stream));
+    deflateInit(&m_stream, 1);
+}
+
+ZrleEncoder::~ZrleEncoder()
+{
+    deflateEnd(&m_stream);
+}
+
+bool ZrleEncoder::usedAllKinds() const
+{
+    return std::all_of(std::begin(uses), std::end(uses), [](int n) { return n > 0; });
+}
+
+void ZrleEncoder::append(QByteArray &out, const RfbScreen &screen, const QRect &rect)
+{
+    m_tiles.clear();
+    for (int ty = 0; ty < rect.height(); ty += 64) {
+        for (int tx = 0; tx < rect.width(); tx += 64) {
+            tile(screen, rect.x() + tx, rect.y() + ty, qMin(64, rect.width() - tx), qMin(64, rect.height() - ty));
+        }
+    }
+    appendRectHeader(out, rect, RfbDecoder::Zrle);
+    m_packed.resize(int(deflateBound(&m_stream, uLong(m_tiles.size())) + 64));
+    m_stream.next_in = reinterpret_cast<Bytef *>(m_tiles.data());
+    m_stream.avail_in = uInt(m_tiles.size());
+    m_stream.next_out = reinterpret_cast<Bytef *>(m_packed.data());
+    m_stream.avail_out = uInt(m_packed.size());
+    deflate(&m_stream, Z_SYNC_FLUSH);
+    const int length = m_packed.size() - int(m_stream.avail_out);
+    appendBe32(out, quint32(length));
+    out.append(m_packed.constData(), length);
+}
+
+void ZrleEncoder::cpixel(quint32 value)
+{
+    const char bytes[3] = {char(value), char(value >> 8), char(value >> 16)};
+    m_tiles.append(bytes, 3);
+}
+
+void ZrleEncoder::runLength(int run)
+{
+    for (run -= 1; run >= 255; run -= 255)
+        m_tiles.append(char(255));
+    m_tiles.append(char(run));
+}
+
+void ZrleEncoder::tile(const RfbScreen &screen, int x, int y, int w, int h)
+{
+    // Палитра до 127 цветов и число серий в порядке строк
+    quint32 palette[127];
+    int colours = 0;
+    int runs = 0;
+    quint32 previous = 0;
+    for (int r = 0; r < h; ++r) {
+        const quint32 *src = screen.row(y + r) + x;
+        for (int c = 0; c < w; ++c) {
+            const quint32 value = src[c];
+            if ((r == 0 && c == 0) || value != previous) {
+                ++runs;
+                previous = value;
+                if (colours <= 127) {
+                    int i = 0;
+                    while (i < colours && palette[i] != value)
+                        ++i;
+                    if (i == colours && colours < 127)
+                        palette[colours++] = value;
+                    else if (i == colours)
+                        colours = 128;  // палитра не подходит
+                }
+            }
+        }
+    }
+
+    auto indexOf = [&](quint32 value) {
+        int i = 0;
+        while (palette[i] != value)
+            ++i;
+        return i;
+    };
+    const int bits = colours == 2 ? 1 : (colours <= 4 ? 2 : 4);
+    const int rawSize = w * h * 3;
+    const int packedSize = colours <= 16 ? colours * 3 + h * ((w * bits + 7) / 8) : INT_MAX;
+    const int plainRleSize = runs * 4;
+    const int paletteRleSize = colours <= 127 ? colours * 3 + runs * 2 : INT_MAX;
+    const int best = std::min({rawSize, packedSize, plainRleSize, paletteRleSize});
+
+    if (colours == 1) {
+        ++uses[SolidTile];
+        m_tiles.append(char(1));
+        cpixel(palette[0]);
+    } else if (best == packedSize) {
+        ++uses[PackedTile];
+        m_tiles.append(char(colours));
+        for (int i = 0; i < colours; ++i)
+            cpixel(palette[i]);
+        for (int r = 0; r < h; ++r) {
+            const quint32 *src = screen.row(y + r) + x;
+            int acc = 0;
+            int filled = 0;
+            for (int c = 0; c < w; ++c) {
+                acc = (acc << bits) | indexOf(src[c]);
+                filled += bits;
+                if (filled == 8) {
+                    m_tiles.append(char(acc));
+                    acc = 0;
+                    filled = 0;
+                }
+            }
+            if (filled > 0)
+                m_tiles.append(char(acc << (8 - filled)));
+        }
+    } else if (best == rawSize) {
+        ++uses[RawTile];
+        m_tiles.append(char(0));
+        for (int r = 0; r < h; ++r) {
+            const quint32 *src = screen.row(y + r) + x;
+            for (int c = 0; c < w; ++c)
+                cpixel(src[c]);
+        }
+    } else {
+        const bool withPalette = best == paletteRleSize;
+        ++uses[withPalette ? PaletteRleTile : PlainRleTile];
+        m_tiles.append(char(withPalette ? 128 + colours : 128));
+        for (int i = 0; withPalette && i < colours; ++i)
+            cpixel(palette[i]);
+        int run = 0;
+        quint32 current = 0;
+        auto flush = [&]() {
+            if (withPalette) {
+                m_tiles.append(char(indexOf(current) | (run > 1 ? 128 : 0)));
+                if (run > 1)
+                    runLength(run);
+            } else {
+                cpixel(current);
+                runLength(run);
+            }
+        };
+        for (int r = 0; r < h; ++r) {
+            const quint32 *src = screen.row(y + r) + x;
+            for (int c = 0; c < w; ++c) {
+                if (run > 0 && src[c] == current) {
+                    ++run;
+                    continue;
+                }
+                if (run > 0)
+                    flush();
+                current = src[c];
+                run = 1;
+            }
+        }
+        flush();
+    }
+}
+
+// ======================== Рабочий стол ========================
+
+void paintDesktop(RfbScreen &screen, int frame)
+{
+    for (int y = 0; y < screen.height; ++y)
+        std::fill_n(screen.row(y), screen.width, 0x203050u + quint32(y * 96 / screen.height));
+    for (int y = screen.height - 56; y < screen.height; ++y)
+        std::fill_n(screen.row(y), screen.width, 0x2b2b2bu);  // панель задач
+    for (int i = 0; i < 3; ++i) {
+        const QRect window(80 + i * 520 + (frame * 6) % 160, 100 + i * 220 + (frame * 4) % 120, 600, 400);
+        for (int y = window.y(); y < window.y() + window.height() && y < screen.height; ++y) {
+            quint32 *row = screen.row(y);
+            for (int x = window.x(); x < window.x() + window.width() && x < screen.width; ++x) {
+                const int wy = y - window.y();
+                const bool title = wy < 28;
+                const bool text = !title && (wy % 18) < 11 && ((x / 3 + wy / 2 + i) % 5 == 0);
+                row[x] = title ? 0x3c6eb4u : (text ? 0x101010u : 0xf4f4f4u);
+            }
+        }
+    }
+    quint32 seed = 0x9e3779b9u * quint32(frame + 1);
+    for (int y = 640; y < 640 + 240; ++y) {
+        quint32 *row = screen.row(y);
+        for (int x = 1400; x < 1400 + 320; ++x) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            row[x] = seed & 0xffffffu;
+        }
+    }
+}
+
+QVector<RfbPass> buildDesktopPasses(int rawFrames, int zrleFrames, int smallUpdates, ZrleEncoder *zrle,
+                                    std::vector<QByteArray> *updates)
+{
+    QVector<RfbPass> passes;
+    RfbScreen screen(DesktopWidth, DesktopHeight);
+    {
+        // Raw — 33 МБ на четыре разных кадра, дальше они по кругу
+        std::vector<QByteArray> frames;
+        for (int i = 0; i < 4; ++i) {
+            paintDesktop(screen, i);
+            frames.push_back(beginUpdate(1));
+            appendRaw(frames.back(), screen, QRect(0, 0, DesktopWidth, DesktopHeight));
+        }
+        for (int i = 0; i < rawFrames; ++i)
+            updates->push_back(frames[size_t(i % 4)]);
+        paintDesktop(screen, (rawFrames - 1) % 4);
+        passes.append(RfbPass {"Raw", rawFrames, true, screen});
+    }
+    for (int i = 0; i < zrleFrames; ++i) {
+        paintDesktop(screen, i);
+        updates->push_back(beginUpdate(1));
+        zrle->append(updates->back(), screen, QRect(0, 0, DesktopWidth, DesktopHeight));
+    }
+    passes.append(RfbPass {"ZRLE", zrleFrames, true, screen});
+    for (int i = 0; i < smallUpdates; ++i) {
+        QByteArray update = beginUpdate(3);
+        const QPoint from(100 + (i * 2) % 1000, 80 + i % 500);
+        appendCopyRect(update, screen, QRect(from.x() + 2, from.y() + 1, 600, 400), from);
+        const QRect text(200 + (i * 37) % 1500, 100 + (i * 53) % 900, 64, 48);
+        for (int y = text.y(); y < text.y() + text.height(); ++y) {
+            for (int x = text.x(); x < text.x() + text.width(); ++x)
+                screen.row(y)[x] = ((x + y + i) % 7 == 0) ? 0x101010u : 0xf4f4f4u;
+        }
+        zrle->append(update, screen, text);
+        const QRect cursor(300 + (i * 11) % 1500, 200 + (i * 7) % 800, 16, 16);
+        for (int y = cursor.y(); y < cursor.y() + cursor.height(); ++y)
+            std::fill_n(screen.row(y) + cursor.x(), cursor.width(), 0xffffffu - quint32(y - cursor.y()));
+        appendRaw(update, screen, cursor);
+        updates->push_back(update);
+    }
+    passes.append(RfbPass {"мелкие", smallUpdates, false, screen});
+    return passes;
+}
+
+bool ScreenSurface::sameAs(const RfbScreen &expected) const
+{
+    if (screen.width != expected.width || screen.height != expected.height)
+        return false;
+    for (size_t i = 0; i < expected.pixels.size(); ++i) {
+        if ((screen.pixels[i] & 0xffffffu) != expected.pixels[i])
+            return false;
+    }
+    return true;
+}
+
+// ======================== RfbTestServer ========================
+
+RfbTestServer::~RfbTestServer()
+{
+    finish();
+}
+
+bool RfbTestServer::listen(int width, int height, const std::vector<QByteArray> *updates)
+{
+    m_listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLength = sizeof(addr);
+    if (m_listenFd < 0 || ::bind(m_listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0
+        || ::listen(m_listenFd, 1) != 0
+        || ::getsockname(m_listenFd, reinterpret_cast<sockaddr *>(&addr), &addrLength) != 0) {
+        m_error = "тестовый сервер не поднялся: " + qt_error_string(errno);
+        if (m_listenFd >= 0)
+            ::close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    m_port = ntohs(addr.sin_port);
+    m_serverError.clear();
+    m_thread = std::thread(serveRfb, m_listenFd, width, height, updates, &m_serverError);
+    return true;
+}
+
+int RfbTestServer::connectClient()
+{
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(m_port);
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        m_error = "нет соединения с тестовым сервером: " + qt_error_string(errno);
+        if (fd >= 0)
+            ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+QString RfbTestServer::finish()
+{
+    if (m_thread.joinable())
+        m_thread.join();
+    if (m_listenFd >= 0)
+        ::close(m_listenFd);
+    m_listenFd = -1;
+    return m_serverError;
+}
@@ -0,0 +1,135 @@
+#ifndef RFBTESTSERVER_H
+#define RFBTESTSERVER_H
+
+#include <QByteArray>
+#include <QPoint>
+#include <QRect>
+#include <QString>
+#include <QVector>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+#include "rfbdecoder.h"
+
+// Сторона сервера RFB для тестов и замеров RfbDecoder: кадры кодируются
+// заранее, «рабочий стол» 1920x1080 — как у гостя с графической сессией
+
+constexpr int DesktopWidth = 1920;
+constexpr int DesktopHeight = 1080;
+
+// Экран тестового сервера: то, что клиент должен увидеть после каждого кадра
+struct RfbScreen {
+    int width = 0;
+    int height = 0;
+    std::vector<quint32> pixels;  // 0x00RRGGBB
+
+    RfbScreen(int w, int h) : width(w), height(h), pixels(size_t(w) * h) {}
+    quint32 *row(int y) { return pixels.data() + size_t(y) * width; }
+    const quint32 *row(int y) const { return pixels.data() + size_t(y) * width; }
+};
+
+void appendBe16(QByteArray &out, quint16 value);
+void appendBe32(QByteArray &out, quint32 value);
+void appendRectHeader(QByteArray &out, const QRect &rect, qint32 encoding);
+// Точки в родном формате клиента (32 бита LE, 0xRRGGBB); старший байт —
+// мусор, как у настоящих серверов: клиент обязан его не замечать
+void appendRaw(QByteArray &out, const RfbScreen &screen, const QRect &rect);
+// CopyRect: на экране сервера и в сообщении; области могут перекрываться
+void appendCopyRect(QByteArray &out, RfbScreen &screen, const QRect &rect, const QPoint &source);
+// Заголовок FramebufferUpdate из rects прямоугольников
+QByteArray beginUpdate(int rects);
+// Всё, что сервер 3.8 без пароля шлёт до первого кадра, одним куском —
+// для RfbDecoder без сокета: его ответы серверу не нужны
+QByteArray serverHandshake(int width, int height, const QByteArray &name);
+
+// ZRLE с одним потоком zlib на соединение. Вид каждой плитки — самый
+// короткий из подходящих, так что на «рабочем столе» встречаются все
+// (uses[] считает, какие были)
+class ZrleEncoder
+{
+public:
+    ZrleEncoder();
+    ~ZrleEncoder();
+
+    ZrleEncoder(const ZrleEncoder &) = delete;
+    ZrleEncoder &operator=(const ZrleEncoder &) = delete;
+
+    enum Kind { RawTile, SolidTile, PackedTile, PlainRleTile, PaletteRleTile, KindCount };
+    int uses[KindCount] = {};
+
+    void append(QByteArray &out, const RfbScreen &screen, const QRect &rect);
+    bool usedAllKinds() const;
+
+private:
+    void cpixel(quint32 value);
+    void runLength(int run);
+    void tile(const RfbScreen &screen, int x, int y, int w, int h);
+
+    z_stream m_stream;
+    QByteArray m_tiles;
+    QByteArray m_packed;
+};
+
+// «Рабочий стол» кадра frame: градиентный фон (серии по палитре), окна с
+// двухцветным «текстом» (упакованная палитра), панель задач (одноцветные
+// плитки) и шумное «видео» (плитки без сжатия). Окна сдвигаются каждый кадр
+void paintDesktop(RfbScreen &screen, int frame);
+
+// Проход — подряд идущие кадры одного вида; expected — экран после последнего
+struct RfbPass {
+    QString name;
+    int updates = 0;
+    bool fullFrames = true;  // по прямоугольнику на кадр, иначе по три
+    RfbScreen expected {0, 0};
+};
+
+// Кадры рабочего стола по порядку: полные Raw (четыре разных по кругу),
+// полные ZRLE и мелкие обновления — окно тащат мышью (CopyRect со
+// сдвигом), под курсором меняется текст (ZRLE), сам курсор — Raw
+QVector<RfbPass> buildDesktopPasses(int rawFrames, int zrleFrames, int smallUpdates, ZrleEncoder *zrle,
+                                    std::vector<QByteArray> *updates);
+
+// Экран клиента в памяти вместо QImage
+class ScreenSurface : public RfbSurface
+{
+public:
+    void resize(int width, int height) override { screen = RfbScreen(width, height); }
+    quint32 *scanLine(int y) override { return screen.row(y); }
+
+    // Альфа-байт декодер выставляет сам, сравниваем только цвет
+    bool sameAs(const RfbScreen &expected) const;
+
+    RfbScreen screen {0, 0};
+};
+
+// Тестовый сервер на loopback: рукопожатие 3.8 без пароля, затем по одному
+// заранее собранному FramebufferUpdate на каждый запрос клиента. Работает в
+// std::thread — клиент в потоке теста меряет только себя
+class RfbTestServer
+{
+public:
+    RfbTestServer() = default;
+    ~RfbTestServer();
+
+    RfbTestServer(const RfbTestServer &) = delete;
+    RfbTestServer &operator=(const RfbTestServer &) = delete;
+
+    // updates должны жить до finish(); false — причина в errorString()
+    bool listen(int width, int height, const std::vector<QByteArray> *updates);
+    // Сокет клиента, закрывает вызывающий; -1 — причина в errorString()
+    int connectClient();
+    // Ждёт поток сервера; пусто — клиент получил все кадры
+    QString finish();
+
+    QString errorString() const { return m_error; }
+
+private:
+    int m_listenFd = -1;
+    quint16 m_port = 0;
+    std::thread m_thread;
+    QString m_error;
+    QString m_serverError;
+};
+
+#endif // RFBTESTSERVER_H
@@ -0,0 +1,43 @@
+#include "stallmonitor.h"
+
+#include <QDebug>
+
+StallMonitor::StallMonitor(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(TickMs);
+    connect(&m_timer, &QTimer::timeout, this, &StallMonitor::onTick);
+}
+
+void StallMonitor::start()
+{
+    m_stalls.reset();
+    m_clock.start();
+    m_timer.start();
+}
+
+void StallMonitor::stop()
+{
+    m_timer.stop();
+}
+
+int StallMonitor::limitMs()
+{
+    return qMax(0, qEnvironmentVariableIntValue("VMRUN_BENCH_MAX_STALL_MS"));
+}
+
+void StallMonitor::onTick()
+{
+    const qint64 gap = m_clock.restart();
+    m_stalls.record(qMax<qint64>(0, gap - TickMs));
+}
+
+void reportLatency(const QString &name, const LatencyHistogram &h, const char *unit)
+{
+    qInfo().noquote() << QString("%1 n=%2 p50=%3 p95=%4 p99=%5 max=%6 %7")
+                             .arg(name, -36).arg(h.count(), 5)
+                             .arg(h.percentile(50), 5).arg(h.percentile(95), 5)
+                             .arg(h.percentile(99), 5).arg(h.max(), 5)
+                             .arg(QString::fromUtf8(unit));
+}
@@ -0,0 +1,39 @@
+#ifndef STALLMONITOR_H
+#define STALLMONITOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "latencyhistogram.h"
+
+// Задержки цикла событий: точный таймер тикает раз в TickMs, всё сверх
+// этого — время, когда поток был занят и окно не перерисовывалось.
+// Порог для замеров — VMRUN_BENCH_MAX_STALL_MS (0 или не задан — без порога)
+class StallMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int TickMs = 5;
+
+    explicit StallMonitor(QObject *parent = nullptr);
+
+    void start();
+    void stop();
+    const LatencyHistogram &stalls() const { return m_stalls; }
+
+    static int limitMs();
+
+private:
+    void onTick();
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    LatencyHistogram m_stalls;
+};
+
+// Строка гистограммы в вывод теста: "name n=… p50=… p95=… p99=… max=… мс"
+void reportLatency(const QString &name, const LatencyHistogram &h, const char *unit = "мс");
+
+#endif // STALLMONITOR_H
@@ -0,0 +1,214 @@
+#include "stubtools.h"
+#include "commandrunner.h"
+#include "eventjournal.h"
+#include "logarchive.h"
+#include "vmsupervisor.h"
+
+#include <QFile>
+
+namespace {
+
+// Заглушки пишутся для /bin/sh: на FreeBSD и на голом Linux одинаково
+const char *const DoasStub = R"(#!/bin/sh
+# doas: программа из этого каталога, если есть, иначе системная (kill)
+dir=$(dirname "$0")
+prog=$1
+shift
+if [ -x "$dir/$prog" ]; then
+    exec "$dir/$prog" "$@"
+fi
+exec "$prog" "$@"
+)";
+
+const char *const BhyveStub = R"(#!/bin/sh
+# bhyve: вывод загрузки, затем ждёт SIGTERM, как гость с ACPI. С "-l com1,<tty>"
+# на com1 — приглашение login и эхо всего, что пришло
+sleeper=
+echoer=
+trap 'kill $sleeper $echoer 2>/dev/null; echo "bhyve: ACPI power button, guest powered off"; exit 1' TERM
+lines=${VMRUN_STUB_BOOT_LINES:-0}
+echo "bhyve stub: $*"
+com1=
+prev=
+for arg in "$@"; do
+    if [ "$prev" = "-l" ]; then
+        case "$arg" in com1,*) com1=${arg#com1,} ;; esac
+    fi
+    prev=$arg
+done
+if [ -n "$com1" ]; then
+    (
+        exec 3<>"$com1"
+        stty raw -echo <&3 2>/dev/null
+        printf '\r\nFreeBSD/amd64 (stub) (ttyu0)\r\n\r\nlogin: ' >&3
+        exec cat <&3 >&3
+    ) &
+    echoer=$!
+fi
+if [ "$lines" -gt 0 ]; then
+    seq 1 "$lines" | sed 's/^/[boot] BHYVE stub console line /'
+fi
+echo "[boot] login:"
+while :; do
+    sleep 1 >/dev/null 2>&1 &
+    sleeper=$!
+    wait $sleeper
+done
+)";
+
+const char *const BhyvectlStub = R"(#!/bin/sh
+exit 0
+)";
+
+const char *const IfconfigStub = R"(#!/bin/sh
+# ifconfig: задержка и доля отказов — из окружения; участники bridge0 —
+# в файле рядом, "-a" показывает мост и tap0..tap$VMRUN_STUB_TAPS-1
+if [ -n "$VMRUN_STUB_IFCONFIG_DELAY" ]; then
+    sleep "$VMRUN_STUB_IFCONFIG_DELAY"
+fi
+fail=${VMRUN_STUB_IFCONFIG_FAIL:-0}
+if [ "$fail" -gt 0 ] && [ $(( $(od -An -N1 -tu1 /dev/urandom) * 100 / 256 )) -lt "$fail" ]; then
+    echo "ifconfig: stub failure" >&2
+    exit 1
+fi
+state="$(dirname "$0")/bridge0.members"
+[ -e "$state" ] || : > "$state"
+if [ "$1" = "-a" ]; then
+    echo "bridge0: flags=8843<UP,BROADCAST,RUNNING,SIMPLEX,MULTICAST> metric 0 mtu 1500"
+    while read -r m; do
+        printf '\tmember: %s flags=143<LEARNING,DISCOVER,AUTOEDGE,AUTOPTP>\n' "$m"
+    done < "$state"
+    i=0
+    while [ "$i" -lt "${VMRUN_STUB_TAPS:-0}" ]; do
+        echo "tap$i: flags=8943<UP,BROADCAST,RUNNING,PROMISC,SIMPLEX,MULTICAST> metric 0 mtu 1500"
+        i=$((i + 1))
+    done
+    exit 0
+fi
+if [ "$1" = "bridge0" ] && [ "$#" -gt 1 ]; then
+    shift
+    while [ "$#" -gt 1 ]; do
+        case "$1" in
+        addm) grep -qx "$2" "$state" || echo "$2" >> "$state"; shift 2 ;;
+        deletem) grep -vx "$2" "$state" > "$state.$$"; mv "$state.$$" "$state"; shift 2 ;;
+        *) shift ;;
+        esac
+    done
+    exit 0
+fi
+if [ "$#" -eq 1 ]; then
+    echo "$1: flags=8843<UP,BROADCAST,RUNNING,SIMPLEX,MULTICAST> metric 0 mtu 1500"
+fi
+exit 0
+)";
+
+} // namespace
+
+bool StubTools::prepare(const Options &options)
+{
+    if (!m_dir.isValid()) {
+        m_error = m_dir.errorString();
+        return false;
+    }
+
+    const QList<QPair<QString, const char *>> stubs = {
+        {"doas", DoasStub},
+        {"bhyve", BhyveStub},
+        {"bhyvectl", BhyvectlStub},
+        {"ifconfig", IfconfigStub},
+    };
+    for (const auto &stub : stubs) {
+        QFile file(filePath(stub.first));
+        if (!file.open(QIODevice::WriteOnly) || file.write(stub.second) < 0) {
+            m_error = file.fileName() + ": " + file.errorString();
+            return false;
+        }
+        file.close();
+        file.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    }
+
+    // launch() проверяет только наличие образа
+    QFile disk(diskImage());
+    if (!disk.open(QIODevice::WriteOnly)) {
+        m_error = disk.fileName() + ": " + disk.errorString();
+        return false;
+    }
+
+    apply(options);
+    return true;
+}
+
+// Читаются при создании InterfaceWatcher и при каждом запуске заглушек
+void StubTools::apply(const Options &options)
+{
+    m_options = options;
+    qputenv("VMRUN_NET_BACKEND", "fake");
+    qputenv("VMRUN_FAKE_TAP_DELAY_MS", QByteArray::number(options.tapDelayMs));
+    qputenv("VMRUN_STUB_IFCONFIG_DELAY", QByteArray::number(options.ifconfigDelayMs / 1000.0, 'f', 3));
+    qputenv("VMRUN_STUB_IFCONFIG_FAIL", QByteArray::number(options.ifconfigFailPercent));
+    qputenv("VMRUN_STUB_BOOT_LINES", QByteArray::number(options.bootLines));
+    qputenv("VMRUN_STUB_TAPS", QByteArray::number(options.taps));
+}
+
+void StubTools::setBootLines(int lines)
+{
+    m_options.bootLines = lines;
+    qputenv("VMRUN_STUB_BOOT_LINES", QByteArray::number(lines));
+}
+
+VmConfig StubTools::config(const QString &name, const QString &tap) const
+{
+    VmConfig config;
+    config.name = name;
+    config.memory = "256M";
+    config.diskPath = diskImage();
+    config.tap = tap;
+    config.restart.mode = RestartPolicy::Never;
+    return config;
+}
+
+VmSupervisor *StubTools::createSupervisor(int count, QObject *parent) const
+{
+    auto *supervisor = new VmSupervisor(parent);
+    supervisor->commands()->setToolDirectory(path());
+    supervisor->journal()->setFile(QString());
+    supervisor->archive()->setDirectory(QString());
+    supervisor->setRuntimeDirectory(filePath("run"));
+    supervisor->setConsoleBackend(SerialConsole::Backend::Pty);
+    QFile::remove(filePath("bridge0.members"));
+
+    for (int i = 0; i < count; ++i)
+        supervisor->ensureInstance(config(QString("vm%1").arg(i), QString("tap%1").arg(i)));
+    return supervisor;
+}
+
+bool StubTools::allIn(const VmSupervisor *supervisor, VmInstance::State state)
+{
+    return countIn(supervisor, state) == supervisor->count();
+}
+
+int StubTools::countIn(const VmSupervisor *supervisor, VmInstance::State state)
+{
+    int count = 0;
+    for (const VmInstance *vm : supervisor->instances())
+        count += vm->state() == state ? 1 : 0;
+    return count;
+}
+
+bool StubTools::networkSettled(const VmSupervisor *supervisor)
+{
+    for (const VmInstance *vm : supervisor->instances()) {
+        if (vm->networkReadyMs() < 0 && !logContains(vm->log(), "[Bridge] Ошибка"))
+            return false;
+    }
+    return true;
+}
+
+bool StubTools::logContains(const LogBuffer *log, const QString &text)
+{
+    for (quint64 seq = log->firstSeq(); seq < log->endSeq(); ++seq) {
+        if (log->lineAt(seq).text.contains(text))
+            return true;
+    }
+    return false;
+}
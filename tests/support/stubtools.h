@@ -0,0 +1,68 @@
+#ifndef STUBTOOLS_H
+#define STUBTOOLS_H
+
+#include <QString>
+#include <QTemporaryDir>
+
+#include "vmconfig.h"
+#include "vminstance.h"
+
+class LogBuffer;
+class QObject;
+class VmSupervisor;
+
+// Заглушки doas, bhyve, bhyvectl и ifconfig для /bin/sh во временном
+// каталоге: движок запускает их вместо настоящих (CommandRunner::
+// setToolDirectory), tap "появляется" через фейковый InterfaceWatcher.
+// Всё остальное — настоящий VmSupervisor/VmInstance, поэтому тесты и
+// замеры идут без гипервизора и без root.
+//
+// Заглушка bhyve печатает bootLines строк загрузки, с "-l com1,<tty>"
+// отвечает на com1 приглашением login и эхом, гаснет по SIGTERM, как гость
+// с ACPI. Поведение заглушек задаёт окружение процесса — apply() меняет его
+// между прогонами (строка данных теста со своей задержкой tap и т. п.).
+class StubTools
+{
+public:
+    struct Options {
+        int tapDelayMs = 50;
+        int ifconfigDelayMs = 0;
+        int ifconfigFailPercent = 0;
+        int bootLines = 200;
+        int taps = 4;          // сколько tapN показывает "ifconfig -a"
+    };
+
+    // false — каталог или заглушки не созданы, причина в errorString()
+    bool prepare(const Options &options = Options());
+    QString errorString() const { return m_error; }
+
+    void apply(const Options &options);
+    void setBootLines(int lines);
+    const Options &options() const { return m_options; }
+
+    QString path() const { return m_dir.path(); }
+    QString filePath(const QString &name) const { return m_dir.filePath(name); }
+    QString diskImage() const { return filePath("disk.img"); }
+
+    // ВМ на образе-заглушке: 256M, без перезапусков
+    VmConfig config(const QString &name, const QString &tap) const;
+
+    // Supervisor поверх заглушек и count ВМ vm0..vmN на tap0..tapN. Журнал —
+    // только в памяти, архив консоли выключен, каталог состояния гостей —
+    // здесь же, com1 — через pty (nmdm требует модуля ядра)
+    VmSupervisor *createSupervisor(int count, QObject *parent = nullptr) const;
+
+    // Условия для QTRY_VERIFY: все ВМ в состоянии state; сеть каждой либо
+    // готова, либо ifconfig заглушки отказал (VMRUN_STUB_IFCONFIG_FAIL)
+    static bool allIn(const VmSupervisor *supervisor, VmInstance::State state);
+    static int countIn(const VmSupervisor *supervisor, VmInstance::State state);
+    static bool networkSettled(const VmSupervisor *supervisor);
+    static bool logContains(const LogBuffer *log, const QString &text);
+
+private:
+    QTemporaryDir m_dir;
+    Options m_options;
+    QString m_error;
+};
+
+#endif // STUBTOOLS_H
@@ -0,0 +1,26 @@
+# Общее для tests/ и bench/ — include(../../tests/support/support.pri) из
+# каталога теста: заглушки doas/bhyve/ifconfig, монитор цикла событий,
+# память процесса, тестовый сервер RFB, образец вывода консоли
+QT += testlib
+QT -= gui
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+include($$PWD/../../core/core.pri)
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/consolesample.cpp \
+    $$PWD/processmemory.cpp \
+    $$PWD/rfbtestserver.cpp \
+    $$PWD/stallmonitor.cpp \
+    $$PWD/stubtools.cpp
+
+HEADERS += \
+    $$PWD/consolesample.h \
+    $$PWD/processmemory.h \
+    $$PWD/rfbtestserver.h \
+    $$PWD/stallmonitor.h \
+    $$PWD/stubtools.h
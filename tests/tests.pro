@@ -0,0 +1,26 @@
+# QtTest на заглушках doas/bhyve/ifconfig: make check в каталоге сборки.
+# Модели GUI проверяются под QT_QPA_PLATFORM=offscreen
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_arpscanparser \
+    tst_commandrunner \
+    tst_controlserver \
+    tst_cputopology \
+    tst_diskbench \
+    tst_diskprofile \
+    tst_displayports \
+    tst_eventjournal \
+    tst_imageclone \
+    tst_interfacewatcher \
+    tst_lifecycle \
+    tst_logarchive \
+    tst_memoryadmission \
+    tst_networkreconciler \
+    tst_reattach \
+    tst_resourcesampler \
+    tst_restarttracker \
+    tst_rfbdecoder \
+    tst_serialconsole \
+    tst_terminalscreen \
+    tst_vminventory
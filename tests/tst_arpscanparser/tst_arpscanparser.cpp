@@ -0,0 +1,123 @@
+#include <QtTest>
+
+#include "arpscanparser.h"
+
+// Потоковый разбор arp-scan: одна строка и вывод на 65536 узлов, порезанный
+// на куски любого размера — ответ не зависит от того, как пришли данные
+class TestArpScanParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseLine_data();
+    void parseLine();
+    void chunks_data();
+    void chunks();
+    void oversizedLine();
+
+private:
+    static QByteArray scanOutput(int hosts);
+};
+
+void TestArpScanParser::parseLine_data()
+{
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<QString>("ip");
+    QTest::addColumn<QString>("mac");
+    QTest::addColumn<QString>("vendor");
+    QTest::addColumn<bool>("duplicate");
+
+    QTest::newRow("tab") << "192.168.1.10\t58:9c:fc:12:34:56\tPCS Systemtechnik GmbH" << true
+                         << "192.168.1.10" << "58:9c:fc:12:34:56" << "PCS Systemtechnik GmbH" << false;
+    QTest::newRow("upper-mac") << "10.0.0.2\t58:9C:FC:AB:CD:EF\tbhyve" << true
+                               << "10.0.0.2" << "58:9c:fc:ab:cd:ef" << "bhyve" << false;
+    QTest::newRow("no-vendor") << "10.0.0.3 58:9c:fc:00:00:03" << true
+                               << "10.0.0.3" << "58:9c:fc:00:00:03" << "" << false;
+    QTest::newRow("dup") << "10.0.0.4\t58:9c:fc:00:00:04\tbhyve (DUP: 2)" << true
+                         << "10.0.0.4" << "58:9c:fc:00:00:04" << "bhyve" << true;
+    QTest::newRow("octet-overflow") << "10.0.0.256\t58:9c:fc:00:00:05\tbhyve" << false << "" << "" << "" << false;
+    QTest::newRow("short-mac") << "10.0.0.6\t58:9c:fc:00:06\tbhyve" << false << "" << "" << "" << false;
+    QTest::newRow("header") << "Interface: bridge0, type: EN10MB, MAC: 58:9c:fc:00:00:01, IPv4: 10.0.0.1"
+                            << false << "" << "" << "" << false;
+}
+
+void TestArpScanParser::parseLine()
+{
+    QFETCH(QString, line);
+    QFETCH(bool, valid);
+
+    ArpEntry entry;
+    QCOMPARE(ArpScanParser::parseLine(line, &entry), valid);
+    if (!valid)
+        return;
+    QTEST(entry.ip, "ip");
+    QTEST(entry.mac, "mac");
+    QTEST(entry.vendor, "vendor");
+    QTEST(entry.duplicate, "duplicate");
+}
+
+void TestArpScanParser::chunks_data()
+{
+    QTest::addColumn<int>("chunkBytes");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("7") << 7;
+    QTest::newRow("4096") << 4096;
+    QTest::newRow("65536") << 65536;
+    QTest::newRow("whole") << 0;
+}
+
+void TestArpScanParser::chunks()
+{
+    QFETCH(int, chunkBytes);
+    constexpr int Hosts = 65536;
+    const QByteArray output = scanOutput(Hosts);
+    const int step = chunkBytes > 0 ? chunkBytes : output.size();
+
+    ArpScanParser parser;
+    QVector<ArpEntry> entries;
+    QStringList notes;
+    for (int pos = 0; pos < output.size(); pos += step)
+        parser.feed(output.mid(pos, step), &entries, &notes);
+    parser.finish(&entries, &notes);
+
+    QCOMPARE(entries.size(), Hosts);
+    QCOMPARE(parser.linesParsed(), quint64(Hosts + 1));
+    QCOMPARE(notes.size(), 1);
+    QVERIFY(notes.first().startsWith("Interface: bridge0"));
+    QCOMPARE(entries.first().ip, QString("10.0.0.0"));
+    QCOMPARE(entries.last().ip, QString("10.0.255.255"));
+    QCOMPARE(entries.last().mac, QString("58:9c:fc:00:ff:ff"));
+    QCOMPARE(entries.last().ipValue, (10u << 24) | 0xffffu);
+}
+
+// Строка длиннее MaxLineLength без '\n' разбирается сразу, а не копится
+void TestArpScanParser::oversizedLine()
+{
+    ArpScanParser parser;
+    QVector<ArpEntry> entries;
+    QStringList notes;
+    parser.feed(QByteArray(ArpScanParser::MaxLineLength + 1, 'x'), &entries, &notes);
+    QCOMPARE(notes.size(), 1);
+    parser.feed("10.0.0.1\t58:9c:fc:00:00:01\tbhyve\n", &entries, &notes);
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries.first().ip, QString("10.0.0.1"));
+}
+
+QByteArray TestArpScanParser::scanOutput(int hosts)
+{
+    QByteArray output = "Interface: bridge0, type: EN10MB, MAC: 58:9c:fc:00:00:01, IPv4: 10.0.0.1\n";
+    for (int i = 0; i < hosts; ++i) {
+        output += QString("10.%1.%2.%3\t58:9c:fc:%4:%5:%6\tPCS Systemtechnik GmbH\n")
+                      .arg((i >> 16) & 0xff).arg((i >> 8) & 0xff).arg(i & 0xff)
+                      .arg((i >> 16) & 0xff, 2, 16, QLatin1Char('0'))
+                      .arg((i >> 8) & 0xff, 2, 16, QLatin1Char('0'))
+                      .arg(i & 0xff, 2, 16, QLatin1Char('0'))
+                      .toLatin1();
+    }
+    return output;
+}
+
+QTEST_GUILESS_MAIN(TestArpScanParser)
+#include "tst_arpscanparser.moc"
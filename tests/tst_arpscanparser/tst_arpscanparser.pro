@@ -0,0 +1,7 @@
+TARGET = tst_arpscanparser
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_arpscanparser.cpp
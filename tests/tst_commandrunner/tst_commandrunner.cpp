@@ -0,0 +1,317 @@
+#include <QtTest>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+#include "commandrunner.h"
+
+namespace {
+
+const char *const DoasStub = R"(#!/bin/sh
+dir=$(dirname "$0")
+prog=$1
+shift
+exec "$dir/$prog" "$@"
+)";
+
+// step <имя> <код выхода> [секунд сна]: имя — строкой в steps.log; со сном
+// exec, чтобы kill() попадал в сам sleep, а не в оболочку над ним
+const char *const StepStub = R"(#!/bin/sh
+dir=$(dirname "$0")
+echo "$1" >> "$dir/steps.log"
+if [ -n "$3" ]; then
+    exec sleep "$3"
+fi
+echo "step $1" >&2
+exit "$2"
+)";
+
+constexpr int TimeoutMs = 300;
+// Шаг, который без kill() заведомо переживёт любой QTRY ниже
+const QString LongSleep = "30";
+constexpr int KillSettleMs = 5000;
+
+CommandSpec step(const QString &name, int exitCode, const QString &sleep = QString())
+{
+    QStringList arguments = {name, QString::number(exitCode)};
+    if (!sleep.isEmpty())
+        arguments << sleep;
+    return CommandSpec::make("step", arguments);
+}
+
+struct Outcome {
+    int calls = 0;
+    CommandResult result;
+};
+
+CommandCallback record(Outcome *outcome)
+{
+    return [outcome](const CommandResult &result) {
+        ++outcome->calls;
+        outcome->result = result;
+    };
+}
+
+} // namespace
+
+// CommandRunner над заглушками в каталоге инструментов: коды выхода,
+// несуществующая программа, таймаут и cancel() убивают процесс, цепочка
+// встаёт на первом сбое без allowFailure, статистика задержек — по ключу
+// команды и без отменённых
+class TestCommandRunner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void exitCode_data();
+    void exitCode();
+    void failedToStart();
+    void timeout();
+    void cancel();
+    void contextDeleted();
+    void chain_data();
+    void chain();
+    void cancelChain();
+    void latencyStats();
+
+private:
+    QStringList steps() const;
+
+    QTemporaryDir m_dir;
+    QScopedPointer<CommandRunner> m_commands;
+};
+
+void TestCommandRunner::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    const QList<QPair<QString, const char *>> stubs = {{"doas", DoasStub}, {"step", StepStub}};
+    for (const auto &stub : stubs) {
+        QFile file(m_dir.filePath(stub.first));
+        QVERIFY2(file.open(QIODevice::WriteOnly) && file.write(stub.second) > 0, qPrintable(file.errorString()));
+        file.close();
+        file.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    }
+}
+
+// Свежий runner на каждый тест — своя статистика и никаких хвостов
+void TestCommandRunner::init()
+{
+    QFile::remove(m_dir.filePath("steps.log"));
+    m_commands.reset(new CommandRunner);
+    m_commands->setToolDirectory(m_dir.path());
+}
+
+QStringList TestCommandRunner::steps() const
+{
+    QFile log(m_dir.filePath("steps.log"));
+    if (!log.open(QIODevice::ReadOnly))
+        return QStringList();
+    return QString::fromLatin1(log.readAll()).split('\n', Qt::SkipEmptyParts);
+}
+
+void TestCommandRunner::exitCode_data()
+{
+    QTest::addColumn<int>("code");
+    QTest::addColumn<bool>("ok");
+
+    QTest::newRow("zero") << 0 << true;
+    QTest::newRow("one") << 1 << false;
+    QTest::newRow("seventy") << 70 << false;
+}
+
+void TestCommandRunner::exitCode()
+{
+    QFETCH(int, code);
+    QFETCH(bool, ok);
+
+    QCOMPARE(m_commands->resolveProgram("step"), QDir(m_dir.path()).filePath("step"));
+    Outcome outcome;
+    m_commands->run(step("a", code), nullptr, record(&outcome));
+    QCOMPARE(m_commands->pendingCount(), 1);
+    QCOMPARE(outcome.calls, 0);
+
+    QTRY_COMPARE(outcome.calls, 1);
+    QCOMPARE(outcome.result.ok(), ok);
+    QCOMPARE(outcome.result.exitCode, code);
+    QVERIFY(!outcome.result.timedOut && !outcome.result.canceled && !outcome.result.failedToStart);
+    QCOMPARE(outcome.result.standardError, QByteArray("step a\n"));
+    if (!ok)
+        QVERIFY2(outcome.result.errorString().contains(QString("код %1").arg(code)),
+                 qPrintable(outcome.result.errorString()));
+    QCOMPARE(m_commands->pendingCount(), 0);
+}
+
+void TestCommandRunner::failedToStart()
+{
+    Outcome outcome;
+    m_commands->run(CommandSpec::make(m_dir.filePath("no-such-tool"), {}), nullptr, record(&outcome));
+
+    QTRY_COMPARE(outcome.calls, 1);
+    QVERIFY(outcome.result.failedToStart);
+    QVERIFY(!outcome.result.ok());
+    QCOMPARE(m_commands->pendingCount(), 0);
+    QVERIFY(m_commands->latencyStats().isEmpty());
+}
+
+// Таймаут убивает процесс, а не ждёт его: результат — вскоре после дедлайна
+void TestCommandRunner::timeout()
+{
+    CommandSpec spec = step("slow", 0, LongSleep);
+    spec.timeoutMs = TimeoutMs;
+    Outcome outcome;
+    m_commands->run(spec, nullptr, record(&outcome));
+
+    QTRY_COMPARE_WITH_TIMEOUT(outcome.calls, 1, TimeoutMs + KillSettleMs);
+    QVERIFY(outcome.result.timedOut);
+    QVERIFY(!outcome.result.ok());
+    QCOMPARE(outcome.result.exitStatus, QProcess::CrashExit);
+    QVERIFY2(outcome.result.elapsedMs >= TimeoutMs, qPrintable(QString::number(outcome.result.elapsedMs)));
+    QVERIFY(outcome.result.errorString().contains("таймаут"));
+    QCOMPARE(m_commands->pendingCount(), 0);
+}
+
+void TestCommandRunner::cancel()
+{
+    Outcome outcome;
+    Outcome other;
+    const quint64 id = m_commands->run(step("slow", 0, LongSleep), nullptr, record(&outcome));
+    m_commands->run(step("b", 0), nullptr, record(&other));
+    QTRY_COMPARE(steps().size(), 2);
+    m_commands->cancel(id);
+
+    QTRY_COMPARE_WITH_TIMEOUT(outcome.calls, 1, KillSettleMs);
+    QVERIFY(outcome.result.canceled);
+    QVERIFY(!outcome.result.timedOut);
+    QCOMPARE(outcome.result.errorString(), QString("отменено"));
+    QTRY_COMPARE(other.calls, 1);
+    QVERIFY(other.result.ok());
+    QCOMPARE(m_commands->pendingCount(), 0);
+
+    // Отменённое в статистику не попадает
+    QCOMPARE(m_commands->latencyStats().value("step").count(), quint64(1));
+}
+
+// Удалённый context глушит callback, но не сигнал и не статистику
+void TestCommandRunner::contextDeleted()
+{
+    QSignalSpy finished(m_commands.data(), &CommandRunner::commandFinished);
+    auto *context = new QObject;
+    Outcome outcome;
+    m_commands->run(step("a", 0), context, record(&outcome));
+    delete context;
+
+    QTRY_COMPARE(finished.count(), 1);
+    QCOMPARE(outcome.calls, 0);
+    QCOMPARE(m_commands->latencyStats().value("step").count(), quint64(1));
+}
+
+void TestCommandRunner::chain_data()
+{
+    // "имя:код", "!" в конце — allowFailure
+    QTest::addColumn<QStringList>("chain");
+    QTest::addColumn<bool>("ok");
+    QTest::addColumn<QStringList>("executed");
+
+    QTest::newRow("all-ok") << QStringList({"a:0", "b:0", "c:0"}) << true << QStringList({"a", "b", "c"});
+    QTest::newRow("first-fails") << QStringList({"a:1", "b:0", "c:0"}) << false << QStringList({"a"});
+    QTest::newRow("middle-fails") << QStringList({"a:0", "b:2", "c:0"}) << false << QStringList({"a", "b"});
+    QTest::newRow("allow-failure") << QStringList({"a:0", "b:2!", "c:0"}) << true << QStringList({"a", "b", "c"});
+    QTest::newRow("allowed-then-fails") << QStringList({"a:1!", "b:1", "c:0"}) << false << QStringList({"a", "b"});
+    QTest::newRow("last-allowed") << QStringList({"a:0", "b:1!"}) << true << QStringList({"a", "b"});
+    QTest::newRow("empty") << QStringList() << true << QStringList();
+}
+
+void TestCommandRunner::chain()
+{
+    QFETCH(QStringList, chain);
+    QFETCH(bool, ok);
+    QFETCH(QStringList, executed);
+
+    QList<CommandSpec> specs;
+    for (QString item : chain) {
+        const bool allowFailure = item.endsWith('!');
+        if (allowFailure)
+            item.chop(1);
+        CommandSpec spec = step(item.section(':', 0, 0), item.section(':', 1).toInt());
+        spec.allowFailure = allowFailure;
+        specs << spec;
+    }
+
+    QStringList stepNames;
+    int doneCalls = 0;
+    bool doneOk = false;
+    CommandResult last;
+    m_commands->runChain(
+        specs, nullptr,
+        [&stepNames](const CommandResult &result) { stepNames << result.spec.arguments.value(0); },
+        [&](bool chainOk, const CommandResult &result) {
+            ++doneCalls;
+            doneOk = chainOk;
+            last = result;
+        });
+
+    QTRY_COMPARE(doneCalls, 1);
+    QCOMPARE(doneOk, ok);
+    QCOMPARE(stepNames, executed);
+    QCOMPARE(steps(), executed);
+    if (!executed.isEmpty())
+        QCOMPARE(last.spec.arguments.value(0), executed.last());
+    QCOMPARE(m_commands->pendingCount(), 0);
+
+    QTest::qWait(100);
+    QCOMPARE(doneCalls, 1);
+    QCOMPARE(steps(), executed);
+}
+
+// cancel() по id цепочки убивает текущий шаг, следующие не стартуют
+void TestCommandRunner::cancelChain()
+{
+    int doneCalls = 0;
+    bool doneOk = true;
+    CommandResult last;
+    const quint64 id = m_commands->runChain(
+        {step("slow", 0, LongSleep), step("b", 0)}, nullptr, CommandCallback(),
+        [&](bool chainOk, const CommandResult &result) {
+            ++doneCalls;
+            doneOk = chainOk;
+            last = result;
+        });
+    QTRY_COMPARE(steps(), QStringList({"slow"}));
+    m_commands->cancel(id);
+
+    QTRY_COMPARE_WITH_TIMEOUT(doneCalls, 1, KillSettleMs);
+    QVERIFY(!doneOk);
+    QVERIFY(last.canceled);
+    QTest::qWait(100);
+    QCOMPARE(steps(), QStringList({"slow"}));
+    QCOMPARE(m_commands->pendingCount(), 0);
+}
+
+// Ключ — программа, а у doas — ещё и первая команда: "doas step" отдельно от "step"
+void TestCommandRunner::latencyStats()
+{
+    const QString sleep = "0.1";
+    const int sleepMs = 100;
+    int finished = 0;
+    auto count = [&finished](const CommandResult &) { ++finished; };
+
+    m_commands->run(step("a", 0, sleep), nullptr, count);
+    m_commands->run(step("b", 0, sleep), nullptr, count);
+    m_commands->run(CommandSpec::doas({"step", "c", "0", sleep}), nullptr, count);
+    m_commands->run(CommandSpec::doas({"step", "d", "3"}), nullptr, count);
+    QTRY_COMPARE(finished, 4);
+
+    const QMap<QString, LatencyHistogram> stats = m_commands->latencyStats();
+    QCOMPARE(QStringList(stats.keys()), QStringList({"doas step", "step"}));
+    QCOMPARE(stats.value("step").count(), quint64(2));
+    QCOMPARE(stats.value("doas step").count(), quint64(2));
+    QVERIFY2(stats.value("step").min() >= sleepMs, qPrintable(stats.value("step").summary()));
+    QVERIFY2(stats.value("doas step").max() >= sleepMs, qPrintable(stats.value("doas step").summary()));
+
+    m_commands->resetLatencyStats();
+    QVERIFY(m_commands->latencyStats().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestCommandRunner)
+#include "tst_commandrunner.moc"
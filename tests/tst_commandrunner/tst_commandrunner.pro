@@ -0,0 +1,7 @@
+TARGET = tst_commandrunner
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_commandrunner.cpp
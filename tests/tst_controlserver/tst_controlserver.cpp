@@ -0,0 +1,209 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QScopedPointer>
+
+#include "controlclient.h"
+#include "controlserver.h"
+#include "guestprocess.h"
+#include "stubtools.h"
+#include "vmsupervisor.h"
+
+namespace {
+
+constexpr int Vms = 4;
+constexpr int TimeoutMs = 30000;
+
+} // namespace
+
+// API управления на временном сокете поверх заглушек: разбор запросов и
+// отказы, второй сервер на занятом сокете; пачка start поднимает ВМ,
+// подписчик видит их status и строки лога, restart проходит через
+// остановку (новый pid), пачка stop гасит все
+class TestControlServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void requests_data();
+    void requests();
+    void socketInUse();
+    void batchLifecycle();
+
+private:
+    static QJsonObject request(ControlClient *client, const QJsonObject &request);
+    static QJsonObject batch(const QString &op);
+    bool connectClient(ControlClient *client) const;
+
+    StubTools m_stubs;
+    VmSupervisor *m_supervisor = nullptr;
+    ControlServer *m_server = nullptr;
+    QString m_path;
+};
+
+void TestControlServer::initTestCase()
+{
+    StubTools::Options options;
+    options.taps = Vms;
+    QVERIFY2(m_stubs.prepare(options), qPrintable(m_stubs.errorString()));
+    m_path = m_stubs.filePath("control.sock");
+}
+
+void TestControlServer::init()
+{
+    m_supervisor = m_stubs.createSupervisor(0);
+    m_server = new ControlServer(m_supervisor);
+    m_server->setConfigProvider([this](const QString &name, VmConfig *config, QString *) {
+        *config = m_stubs.config(name, m_supervisor->allocateTap());
+        return true;
+    });
+    QString error;
+    QVERIFY2(m_server->listen(m_path, &error), qPrintable(error));
+}
+
+// Сервер уходит раньше supervisor'а, ВМ гаснут до следующего теста
+void TestControlServer::cleanup()
+{
+    delete m_server;
+    m_server = nullptr;
+    QScopedPointer<VmSupervisor> supervisor(std::exchange(m_supervisor, nullptr));
+    QSignalSpy stopped(supervisor.data(), &VmSupervisor::allStopped);
+    if (supervisor->stopAll() > 0)
+        QVERIFY(stopped.wait(TimeoutMs));
+}
+
+QJsonObject TestControlServer::request(ControlClient *client, const QJsonObject &request)
+{
+    QSignalSpy replied(client, &ControlClient::replied);
+    const qint64 id = client->send(request);
+    for (int i = 0;; ++i) {
+        if (i == replied.count() && !replied.wait(TimeoutMs))
+            return QJsonObject();
+        if (replied.at(i).at(0).toLongLong() == id)
+            return replied.at(i).at(1).toJsonObject();
+    }
+}
+
+QJsonObject TestControlServer::batch(const QString &op)
+{
+    QJsonArray requests;
+    for (int i = 0; i < Vms; ++i)
+        requests.append(QJsonObject {{"op", op}, {"vm", QString("api%1").arg(i)}});
+    return QJsonObject {{"op", "batch"}, {"requests", requests}};
+}
+
+bool TestControlServer::connectClient(ControlClient *client) const
+{
+    QSignalSpy connected(client, &ControlClient::connected);
+    client->connectToServer(m_path);
+    return connected.count() > 0 || connected.wait(TimeoutMs);
+}
+
+void TestControlServer::requests_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<bool>("ok");
+
+    QTest::newRow("ping") << QByteArray(R"({"op":"ping"})") << true;
+    QTest::newRow("list") << QByteArray(R"({"op":"list"})") << true;
+    QTest::newRow("no-op") << QByteArray(R"({"vm":"api0"})") << false;
+    QTest::newRow("unknown-op") << QByteArray(R"({"op":"reboot","vm":"api0"})") << false;
+    QTest::newRow("no-vm") << QByteArray(R"({"op":"stop"})") << false;
+    QTest::newRow("missing-vm") << QByteArray(R"({"op":"status","vm":"nope"})") << false;
+    QTest::newRow("nested-batch") << QByteArray(R"({"op":"batch","requests":[{"op":"batch","requests":[]}]})") << true;
+    QTest::newRow("subscribe") << QByteArray(R"({"op":"subscribe","status":true})") << true;
+}
+
+void TestControlServer::requests()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(bool, ok);
+
+    ControlClient client;
+    QVERIFY(connectClient(&client));
+    const QJsonObject reply = request(&client, QJsonDocument::fromJson(json).object());
+    QVERIFY(!reply.isEmpty());
+    QCOMPARE(reply.value("ok").toBool(), ok);
+    if (!ok)
+        QVERIFY(!reply.value("error").toString().isEmpty());
+    if (QTest::currentDataTag() == QByteArray("list"))
+        QCOMPARE(reply.value("vms").toArray().size(), 0);
+    // Пачка отвечает сама, вложенная — отказом в своём результате
+    if (QTest::currentDataTag() == QByteArray("nested-batch"))
+        QCOMPARE(reply.value("results").toArray().at(0).toObject().value("ok").toBool(), false);
+}
+
+// Живой сервер на том же сокете не подменяется, после close() — можно
+void TestControlServer::socketInUse()
+{
+    ControlServer second(m_supervisor);
+    QString error;
+    QVERIFY(!second.listen(m_path, &error));
+    QVERIFY(!error.isEmpty());
+    QVERIFY(!second.isListening());
+
+    m_server->close();
+    QVERIFY2(second.listen(m_path, &error), qPrintable(error));
+    second.close();
+    QVERIFY(m_server->listen(m_path, &error));
+}
+
+void TestControlServer::batchLifecycle()
+{
+    QHash<QString, QString> states;
+    QHash<QString, qint64> pids;
+    int logLines = 0;
+    ControlClient watcher;
+    connect(&watcher, &ControlClient::event, this, [&](const QJsonObject &event) {
+        if (event.value("event").toString() == "log") {
+            logLines += event.value("lines").toArray().size();
+            return;
+        }
+        const QJsonObject vm = event.value("vm").toObject();
+        states.insert(vm.value("name").toString(), vm.value("state").toString());
+        pids.insert(vm.value("name").toString(), qint64(vm.value("pid").toDouble()));
+    });
+    auto all = [&states](const QString &state) {
+        for (int i = 0; i < Vms; ++i) {
+            if (states.value(QString("api%1").arg(i)) != state)
+                return false;
+        }
+        return true;
+    };
+    QVERIFY(connectClient(&watcher));
+    QVERIFY(request(&watcher, QJsonObject {{"op", "subscribe"}, {"status", true}, {"log", true}}).value("ok").toBool());
+
+    ControlClient driver;
+    QVERIFY(connectClient(&driver));
+    QJsonObject reply = request(&driver, batch("start"));
+    QVERIFY(reply.value("ok").toBool());
+    const QJsonArray results = reply.value("results").toArray();
+    QCOMPARE(results.size(), Vms);
+    for (const QJsonValue &result : results)
+        QVERIFY2(result.toObject().value("ok").toBool(), qPrintable(QJsonDocument(result.toObject()).toJson()));
+    QTRY_VERIFY_WITH_TIMEOUT(all("running"), 2 * GuestProcess::StartDeadlineMs);
+    QTRY_VERIFY_WITH_TIMEOUT(logLines > 0, TimeoutMs);
+
+    // Повторный start работающей ВМ — не ошибка
+    reply = request(&driver, QJsonObject {{"op", "start"}, {"vm", "api1"}});
+    QVERIFY(reply.value("ok").toBool());
+    QVERIFY(reply.value("already").toBool());
+
+    // События status сливаются за PushIntervalMs: промежуточное stopped при
+    // restart может не прийти, новый запуск виден по смене pid
+    const qint64 oldPid = pids.value("api0");
+    QVERIFY(oldPid > 0);
+    QVERIFY(request(&driver, QJsonObject {{"op", "restart"}, {"vm", "api0"}}).value("ok").toBool());
+    QTRY_VERIFY_WITH_TIMEOUT(states.value("api0") == "running" && pids.value("api0") != oldPid,
+                             2 * GuestProcess::StartDeadlineMs + TimeoutMs);
+
+    QVERIFY(request(&driver, batch("stop")).value("ok").toBool());
+    QTRY_VERIFY_WITH_TIMEOUT(all("stopped"), TimeoutMs);
+    QCOMPARE(StubTools::countIn(m_supervisor, VmInstance::State::Failed), 0);
+}
+
+QTEST_GUILESS_MAIN(TestControlServer)
+#include "tst_controlserver.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_controlserver
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_controlserver.cpp
@@ -0,0 +1,260 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+
+#include <algorithm>
+
+#include "cputopology.h"
+
+// Разбор sysfs и kern.sched.topology_spec на заготовках с известным ответом
+// и инварианты CpuPlacer на случайных наборах ВМ: пока vCPU не больше ядер,
+// ни одно ядро не делят двое; пока не больше потоков — ни один поток;
+// после release() всех ВМ нагрузки нет
+class TestCpuTopology : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parseCpuList_data();
+    void parseCpuList();
+    void sysfs();
+    void sysfsSiblings_data();
+    void sysfsSiblings();
+    void topologySpec();
+    void synthetic_data();
+    void synthetic();
+    void placement_data();
+    void placement();
+    void placeSpeed_data();
+    void placeSpeed();
+
+private:
+    static void addShapes();
+
+    QTemporaryDir m_dir;
+    QString m_sysfs;
+};
+
+void TestCpuTopology::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    // 2 пакета × 2 ядра × 2 потока, по узлу на пакет; нумерация как у Linux:
+    // cpuN и cpuN+4 — потоки одного ядра
+    m_sysfs = m_dir.filePath("sysfs");
+    auto write = [this](const QString &path, const QString &text) {
+        const QString fileName = m_sysfs + "/" + path;
+        QDir().mkpath(QFileInfo(fileName).path());
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly) && file.write(text.toLatin1() + "\n") > 0;
+    };
+    QVERIFY(write("cpu/online", "0-7"));
+    for (int id = 0; id < 8; ++id) {
+        QVERIFY(write(QString("cpu/cpu%1/topology/core_id").arg(id), QString::number(id % 2)));
+        QVERIFY(write(QString("cpu/cpu%1/topology/physical_package_id").arg(id), QString::number(id % 4 / 2)));
+    }
+    QVERIFY(write("node/node0/cpulist", "0-1,4-5"));
+    QVERIFY(write("node/node1/cpulist", "2-3,6-7"));
+
+    qInfo().noquote() << "этот хост:" << HostTopology::detect().summary();
+}
+
+void TestCpuTopology::parseCpuList_data()
+{
+    QTest::addColumn<QString>("list");
+    QTest::addColumn<QVector<int>>("ids");
+
+    QTest::newRow("ranges") << "0-3,8,10-11" << QVector<int>({0, 1, 2, 3, 8, 10, 11});
+    QTest::newRow("single") << "5" << QVector<int>({5});
+    QTest::newRow("spaces") << " 0-1, 4-5 " << QVector<int>({0, 1, 4, 5});
+    QTest::newRow("empty") << "" << QVector<int>();
+    QTest::newRow("reversed") << "3-1,7" << QVector<int>({7});
+    QTest::newRow("garbage") << "a,2-x,6" << QVector<int>({6});
+}
+
+void TestCpuTopology::parseCpuList()
+{
+    QFETCH(QString, list);
+    QFETCH(QVector<int>, ids);
+
+    QCOMPARE(HostTopology::parseCpuList(list), ids);
+}
+
+void TestCpuTopology::sysfs()
+{
+    const HostTopology host = HostTopology::fromSysfs(m_sysfs);
+    QCOMPARE(host.source, QString("sysfs"));
+    QCOMPARE(host.cpus.size(), 8);
+    QCOMPARE(host.coreCount(), 4);
+    QCOMPARE(host.nodeCount(), 2);
+}
+
+void TestCpuTopology::sysfsSiblings_data()
+{
+    QTest::addColumn<int>("cpu");
+    QTest::addColumn<QVector<int>>("siblings");
+    QTest::addColumn<int>("node");
+
+    QTest::newRow("cpu0") << 0 << QVector<int>({4}) << 0;
+    QTest::newRow("cpu1") << 1 << QVector<int>({5}) << 0;
+    QTest::newRow("cpu6") << 6 << QVector<int>({2}) << 1;
+    QTest::newRow("cpu7") << 7 << QVector<int>({3}) << 1;
+}
+
+void TestCpuTopology::sysfsSiblings()
+{
+    QFETCH(int, cpu);
+    QFETCH(QVector<int>, siblings);
+    QFETCH(int, node);
+
+    const HostTopology host = HostTopology::fromSysfs(m_sysfs);
+    QCOMPARE(host.siblings(cpu), siblings);
+    const auto it = std::find_if(host.cpus.cbegin(), host.cpus.cend(), [cpu](const HostCpu &c) { return c.id == cpu; });
+    QVERIFY(it != host.cpus.cend());
+    QCOMPARE(it->node, node);
+}
+
+void TestCpuTopology::topologySpec()
+{
+    const QByteArray spec =
+        "<groups>\n"
+        " <group level=\"1\" cache-level=\"0\">\n"
+        "  <cpu count=\"4\" mask=\"f,0,0,0\">0, 1, 2, 3</cpu>\n"
+        "  <children>\n"
+        "   <group level=\"2\" cache-level=\"2\">\n"
+        "    <cpu count=\"2\" mask=\"3,0,0,0\">0, 1</cpu>\n"
+        "    <flags><flag name=\"THREAD\">THREAD group</flag><flag name=\"SMT\">SMT group</flag></flags>\n"
+        "   </group>\n"
+        "   <group level=\"2\" cache-level=\"2\">\n"
+        "    <cpu count=\"2\" mask=\"c,0,0,0\">2, 3</cpu>\n"
+        "    <flags><flag name=\"THREAD\">THREAD group</flag><flag name=\"SMT\">SMT group</flag></flags>\n"
+        "   </group>\n"
+        "  </children>\n"
+        " </group>\n"
+        "</groups>\n";
+    const HostTopology host = HostTopology::fromTopologySpec(spec);
+    QCOMPARE(host.cpus.size(), 4);
+    QCOMPARE(host.coreCount(), 2);
+    QCOMPARE(host.siblings(0), QVector<int>({1}));
+    QCOMPARE(host.siblings(2), QVector<int>({3}));
+}
+
+void TestCpuTopology::addShapes()
+{
+    QTest::addColumn<int>("nodes");
+    QTest::addColumn<int>("cores");
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1x4x2") << 1 << 4 << 2;
+    QTest::newRow("2x4x2") << 2 << 4 << 2;
+    QTest::newRow("2x8x1") << 2 << 8 << 1;
+    QTest::newRow("4x4x2") << 4 << 4 << 2;
+    QTest::newRow("1x16x2") << 1 << 16 << 2;
+    QTest::newRow("2x12x2") << 2 << 12 << 2;
+}
+
+void TestCpuTopology::synthetic_data()
+{
+    addShapes();
+}
+
+void TestCpuTopology::synthetic()
+{
+    QFETCH(int, nodes);
+    QFETCH(int, cores);
+    QFETCH(int, threads);
+
+    const HostTopology host = HostTopology::synthetic(nodes, cores, threads);
+    QCOMPARE(host.cpus.size(), nodes * cores * threads);
+    QCOMPARE(host.coreCount(), nodes * cores);
+    QCOMPARE(host.nodeCount(), nodes);
+    // Потоки одного ядра — через coreCount() номеров, как у Linux на x86
+    QCOMPARE(host.siblings(0).size(), threads - 1);
+    if (threads > 1)
+        QCOMPARE(host.siblings(0).first(), nodes * cores);
+}
+
+void TestCpuTopology::placement_data()
+{
+    addShapes();
+}
+
+void TestCpuTopology::placement()
+{
+    QFETCH(int, nodes);
+    QFETCH(int, cores);
+    QFETCH(int, threads);
+
+    constexpr int Trials = 200;
+    constexpr int Steps = 24;
+    const HostTopology host = HostTopology::synthetic(nodes, cores, threads);
+    const int coreCount = host.coreCount();
+    QRandomGenerator random(16);
+
+    for (int trial = 0; trial < Trials; ++trial) {
+        CpuPlacer placer;
+        placer.setHost(host);
+        QHash<QString, int> vcpus;
+        int total = 0;
+        for (int step = 0; step < Steps; ++step) {
+            // Каждый четвёртый шаг одна из ВМ останавливается
+            if (!vcpus.isEmpty() && random.bounded(4) == 0) {
+                const QString name = vcpus.keys().value(random.bounded(vcpus.size()));
+                total -= vcpus.take(name);
+                placer.release(name);
+                continue;
+            }
+            const QString name = QString("vm%1").arg(step);
+            const int n = 1 + random.bounded(qMin(8, host.cpus.size()));
+            QCOMPARE(placer.place(name, n).size(), n);
+            vcpus.insert(name, n);
+            total += n;
+
+            QVector<int> coreLoad(coreCount, 0);
+            int maxLoad = 0;
+            for (const HostCpu &cpu : host.cpus) {
+                coreLoad[cpu.core] += placer.load(cpu.id);
+                maxLoad = qMax(maxLoad, placer.load(cpu.id));
+            }
+            const QByteArray where = QString("проба %1, шаг %2, vCPU %3").arg(trial).arg(step).arg(total).toUtf8();
+            if (total <= coreCount)
+                QVERIFY2(*std::max_element(coreLoad.cbegin(), coreLoad.cend()) <= 1,
+                         ("SMT-соседство при свободных ядрах: " + where).constData());
+            if (total <= host.cpus.size())
+                QVERIFY2(maxLoad <= 1, ("два vCPU на потоке при свободных потоках: " + where).constData());
+        }
+
+        for (const QString &name : vcpus.keys())
+            placer.release(name);
+        for (const HostCpu &cpu : host.cpus)
+            QCOMPARE(placer.load(cpu.id), 0);
+    }
+}
+
+void TestCpuTopology::placeSpeed_data()
+{
+    addShapes();
+}
+
+// Только время: place() + release() одной ВМ на 4 vCPU при занятой половине хоста
+void TestCpuTopology::placeSpeed()
+{
+    QFETCH(int, nodes);
+    QFETCH(int, cores);
+    QFETCH(int, threads);
+
+    CpuPlacer placer;
+    placer.setHost(HostTopology::synthetic(nodes, cores, threads));
+    const int busy = placer.host().cpus.size() / 2;
+    for (int i = 0; i < busy; ++i)
+        placer.place(QString("busy%1").arg(i), 1);
+
+    QBENCHMARK {
+        placer.place("vm", 4);
+        placer.release("vm");
+    }
+}
+
+QTEST_GUILESS_MAIN(TestCpuTopology)
+#include "tst_cputopology.moc"
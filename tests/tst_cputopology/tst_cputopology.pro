@@ -0,0 +1,7 @@
+TARGET = tst_cputopology
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_cputopology.cpp
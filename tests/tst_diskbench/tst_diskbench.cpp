@@ -0,0 +1,75 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include <atomic>
+
+#include "diskbench.h"
+
+// Короткий DiskBench во временном каталоге: буферизованный режим обязан
+// пройти все тесты, nocache на tmpfs может честно отказать. Временный файл
+// после замера удалён, прогресс сообщён для каждого теста
+class TestDiskBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void run();
+    void cancelBeforeStart();
+    void missingPath();
+};
+
+void TestDiskBench::run()
+{
+    QTemporaryDir pool;
+    QVERIFY(pool.isValid());
+    DiskBench::Options options;
+    options.path = pool.path();
+    options.bytesPerTest = 4LL << 20;
+    options.maxMsPerTest = 200;
+
+    int steps = 0;
+    const DiskBench::Report report = DiskBench::run(options, nullptr, [&steps](int, int, const QString &) { ++steps; });
+    for (const DiskBench::Result &result : report.results)
+        qInfo().noquote() << result.summary();
+
+    QVERIFY2(report.error.isEmpty(), qPrintable(report.error));
+    QVERIFY(!report.cancelled);
+    int buffered = 0;
+    for (const DiskBench::Result &result : report.results) {
+        if (result.mode != DiskBench::Mode::Buffered)
+            continue;
+        ++buffered;
+        QVERIFY2(result.ok() && result.mbPerSec() > 0, qPrintable(result.summary()));
+    }
+    QVERIFY(buffered > 0);
+    QVERIFY2(report.hasRecommendation, qPrintable(report.summary()));
+    QCOMPARE(steps, report.results.size() + 1);
+    QCOMPARE(QDir(pool.path()).entryList(QDir::Files | QDir::Hidden), QStringList());
+}
+
+void TestDiskBench::cancelBeforeStart()
+{
+    QTemporaryDir pool;
+    QVERIFY(pool.isValid());
+    DiskBench::Options options;
+    options.path = pool.path();
+    const std::atomic_bool cancel(true);
+
+    const DiskBench::Report report = DiskBench::run(options, &cancel);
+    QVERIFY(report.cancelled);
+    QVERIFY(report.results.isEmpty());
+    QVERIFY(!report.hasRecommendation);
+    QCOMPARE(QDir(pool.path()).entryList(QDir::Files | QDir::Hidden), QStringList());
+}
+
+void TestDiskBench::missingPath()
+{
+    DiskBench::Options options;
+    options.path = "/nonexistent/vmrun-diskbench";
+    const DiskBench::Report report = DiskBench::run(options);
+    QVERIFY(!report.error.isEmpty());
+    QVERIFY(report.results.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestDiskBench)
+#include "tst_diskbench.moc"
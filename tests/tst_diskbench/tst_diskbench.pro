@@ -0,0 +1,7 @@
+TARGET = tst_diskbench
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_diskbench.cpp
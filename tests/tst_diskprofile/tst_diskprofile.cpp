@@ -0,0 +1,128 @@
+#include <QtTest>
+#include <QJsonObject>
+
+#include "guestprocess.h"
+#include "vmconfig.h"
+#include "vminstance.h"
+
+// Профили дисков: разбор и обратно в строку bhyve, PCI-слоты под диски мимо
+// занятых устройств, профили в GuestState — и из файлов прежней версии
+class TestDiskProfile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parse_data();
+    void parse();
+    void diskSlots_data();
+    void diskSlots();
+    void slotsAvoidReserved();
+    void guestStateRoundTrip();
+    void guestStateLegacyDevice();
+};
+
+void TestDiskProfile::parse_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<QString>("bhyveOptions");
+
+    QTest::newRow("ahci-hd") << "ahci-hd" << true << "";
+    QTest::newRow("virtio-nocache-ro") << "virtio-blk,nocache,ro" << true << ",nocache,ro";
+    QTest::newRow("nvme-direct-sectors") << "nvme,direct,sectorsize=512/4096" << true << ",direct,sectorsize=512/4096";
+    QTest::newRow("virtio-4k") << "virtio-blk,sectorsize=4096" << true << ",sectorsize=4096";
+    QTest::newRow("empty") << "" << false << "";
+    QTest::newRow("scsi") << "scsi" << false << "";
+    QTest::newRow("unknown-option") << "virtio-blk,fast" << false << "";
+    QTest::newRow("odd-sector") << "nvme,sectorsize=1000" << false << "";
+    QTest::newRow("physical-smaller") << "ahci-hd,sectorsize=4096/512" << false << "";
+}
+
+void TestDiskProfile::parse()
+{
+    QFETCH(QString, text);
+    QFETCH(bool, valid);
+    QFETCH(QString, bhyveOptions);
+
+    DiskProfile profile;
+    QString error;
+    QCOMPARE(DiskProfile::parse(text, &profile, &error), valid);
+    if (!valid) {
+        QVERIFY(!error.isEmpty());
+        return;
+    }
+    QCOMPARE(profile.toString(), text);
+    QCOMPARE(profile.bhyveOptions(), bhyveOptions);
+}
+
+void TestDiskProfile::diskSlots_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QVector<int>>("slots");
+
+    QTest::newRow("one") << 1 << QVector<int>({3});
+    QTest::newRow("two") << 2 << QVector<int>({3, 5});
+    QTest::newRow("past-net") << 7 << QVector<int>({3, 5, 6, 7, 8, 9, 11});
+    QTest::newRow("too-many") << VmInstance::diskSlots(0).size() + 1 << QVector<int>();
+}
+
+void TestDiskProfile::diskSlots()
+{
+    QFETCH(int, count);
+    QFETCH(QVector<int>, slots);
+
+    QCOMPARE(VmInstance::diskSlots(count), slots);
+}
+
+// 0 — все свободные: hostbridge, ahci-cd, virtio-net, virtio-9p, fbuf и lpc не задеты
+void TestDiskProfile::slotsAvoidReserved()
+{
+    const QVector<int> all = VmInstance::diskSlots(0);
+    QVERIFY(!all.isEmpty());
+    QCOMPARE(all.first(), 3);
+    const QVector<int> reserved = {0, 4, VmInstance::NetSlot, 15, 30, 31};
+    for (int slot : all) {
+        QVERIFY2(!reserved.contains(slot), qPrintable(QString("слот %1 занят").arg(slot)));
+        QVERIFY(slot < 32);
+    }
+    QCOMPARE(VmInstance::diskSlots(all.size()), all);
+}
+
+void TestDiskProfile::guestStateRoundTrip()
+{
+    GuestState guest;
+    guest.name = "disks";
+    guest.config.name = guest.name;
+    guest.config.diskProfile.device = DiskProfile::Device::Nvme;
+    guest.config.diskProfile.nocache = true;
+    guest.config.extraDisks.append(DiskConfig {"/pool/data.img", DiskProfile()});
+    guest.config.extraDisks.last().profile.readOnly = true;
+
+    GuestState restored;
+    QVERIFY(GuestState::fromJson(guest.toJson(), &restored));
+    QCOMPARE(restored.config.diskProfile.toString(), QString("nvme,nocache"));
+    QCOMPARE(restored.config.extraDisks.size(), 1);
+    QCOMPARE(restored.config.extraDisks[0].path, QString("/pool/data.img"));
+    QCOMPARE(restored.config.extraDisks[0].profile.toString(), QString("ahci-hd,ro"));
+}
+
+// Файл состояния от прежней версии — только disk_device
+void TestDiskProfile::guestStateLegacyDevice()
+{
+    GuestState guest;
+    guest.name = "legacy";
+    QJsonObject json = guest.toJson();
+    json.remove("disk_profile");
+    json["disk_device"] = "virtio-blk";
+
+    GuestState restored;
+    QVERIFY(GuestState::fromJson(json, &restored));
+    QCOMPARE(restored.config.diskProfile.toString(), QString("virtio-blk"));
+
+    json.remove("disk_device");
+    QVERIFY(GuestState::fromJson(json, &restored));
+    QCOMPARE(restored.config.diskProfile.toString(), QString("ahci-hd"));
+}
+
+QTEST_GUILESS_MAIN(TestDiskProfile)
+#include "tst_diskprofile.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_diskprofile
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_diskprofile.cpp
@@ -0,0 +1,96 @@
+#include <QtTest>
+
+#include "displayports.h"
+
+// DisplayPorts на поддельном bind(): 5900 и 5902 заняты чужими процессами.
+// Порты ВМ не пересекаются, ВМ получает прежний порт, занятые и порты
+// подхваченных гостей не выдаются, при исчерпании диапазона — 0
+class TestDisplayPorts : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void skipsBusy();
+    void keepsPreviousPort();
+    void preferred();
+    void reserved();
+    void exhausted();
+    void range();
+
+private:
+    DisplayPorts m_ports;
+};
+
+void TestDisplayPorts::init()
+{
+    m_ports = DisplayPorts();
+    m_ports.setProbe([](int port) { return port != 5900 && port != 5902; });
+}
+
+void TestDisplayPorts::skipsBusy()
+{
+    QCOMPARE(m_ports.acquire("a"), 5901);
+    QCOMPARE(m_ports.acquire("b"), 5903);
+    QCOMPARE(m_ports.port("a"), 5901);
+    QCOMPARE(m_ports.assignments().size(), 2);
+}
+
+// Прежний порт остановленной ВМ новой не отдаётся, пока есть другие
+void TestDisplayPorts::keepsPreviousPort()
+{
+    QCOMPARE(m_ports.acquire("a"), 5901);
+    QCOMPARE(m_ports.acquire("b"), 5903);
+    m_ports.release("a");
+    QCOMPARE(m_ports.port("a"), 0);
+    QCOMPARE(m_ports.acquire("c"), 5904);
+    QCOMPARE(m_ports.acquire("a"), 5901);
+}
+
+void TestDisplayPorts::preferred()
+{
+    QCOMPARE(m_ports.acquire("b"), 5901);
+    QCOMPARE(m_ports.acquire("d", 5901), 0);
+    QCOMPARE(m_ports.port("d"), 0);
+    QCOMPARE(m_ports.acquire("d", 5902), 0);
+    QCOMPARE(m_ports.acquire("d", 5950), 5950);
+    // Заданный порт проверяется и вне диапазона
+    QCOMPARE(m_ports.acquire("e", 6100), 6100);
+}
+
+void TestDisplayPorts::reserved()
+{
+    m_ports.reserve("e", 5960);
+    QCOMPARE(m_ports.port("e"), 5960);
+    QCOMPARE(m_ports.acquire("f", 5960), 0);
+}
+
+void TestDisplayPorts::exhausted()
+{
+    m_ports.reserve("e", 5960);
+    int given = 0;
+    for (int i = 0; i < 200; ++i)
+        given += m_ports.acquire(QString("x%1").arg(i)) > 0 ? 1 : 0;
+    // Сотня портов без двух чужих и одного подхваченного
+    QCOMPARE(given, DisplayPorts::LastPort - DisplayPorts::FirstPort + 1 - 2 - 1);
+    QCOMPARE(m_ports.acquire("late"), 0);
+
+    m_ports.release("x0");
+    QCOMPARE(m_ports.acquire("late"), 5901);
+}
+
+void TestDisplayPorts::range()
+{
+    m_ports.setRange(6000, 6001);
+    QCOMPARE(m_ports.firstPort(), 6000);
+    QCOMPARE(m_ports.lastPort(), 6001);
+    QCOMPARE(m_ports.acquire("a"), 6000);
+    QCOMPARE(m_ports.acquire("b"), 6001);
+    QCOMPARE(m_ports.acquire("c"), 0);
+
+    m_ports.setRange(7000, 6000);
+    QCOMPARE(m_ports.lastPort(), 7000);
+}
+
+QTEST_GUILESS_MAIN(TestDisplayPorts)
+#include "tst_displayports.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_displayports
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_displayports.cpp
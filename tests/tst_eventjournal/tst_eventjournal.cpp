@@ -0,0 +1,264 @@
+#include <QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+#include <cmath>
+
+#include "eventjournal.h"
+
+namespace {
+
+// Столько строк писатель получает разом — далеко до MaxQueued, без потерь
+constexpr int FloodEvents = 20000;
+// Сессия, которой нет у журнала в тесте: история из "прошлого запуска"
+const QString OtherSession = "feedface";
+
+QList<QJsonObject> readLines(const QString &path, QStringList *errors)
+{
+    QList<QJsonObject> events;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errors->append(path + ": " + file.errorString());
+        return events;
+    }
+    int number = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        ++number;
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(line, &error);
+        if (!line.endsWith('\n') || error.error != QJsonParseError::NoError || !document.isObject())
+            errors->append(QString("строка %1: %2").arg(number).arg(QString::fromUtf8(line)));
+        else
+            events.append(document.object());
+    }
+    return events;
+}
+
+QByteArray historyLine(const QString &vm, VmPhase phase, qint64 ms)
+{
+    const QJsonObject event {
+        {"session", OtherSession},
+        {"vm", vm},
+        {"run", 1},
+        {"phase", EventJournal::phaseKey(phase)},
+        {"ms", double(ms)},
+    };
+    return QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n';
+}
+
+}
+
+// EventJournal с файлом во временном каталоге: каждая строка — отдельный
+// JSON-объект с обязательными полями и отрезком от прошлой фазы; всё, что
+// ушло в очередь писателя, на диске после деструктора и в том же порядке;
+// перцентили по фазам из истории с известными замерами
+class TestEventJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void phaseKeys();
+    void jsonLines();
+    void flushOnDestruction();
+    void percentiles();
+    void noFile();
+
+private:
+    static void checkPercentile(const LatencyHistogram &histogram, double p, qint64 exact);
+
+    QScopedPointer<QTemporaryDir> m_dir;
+};
+
+void TestEventJournal::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+}
+
+// Гистограмма отдаёт верхнюю границу корзины: не меньше точного значения
+// и не больше его на четверть октавы (и не больше max)
+void TestEventJournal::checkPercentile(const LatencyHistogram &histogram, double p, qint64 exact)
+{
+    const qint64 value = histogram.percentile(p);
+    const qint64 upper = qMin(histogram.max(), qint64(std::ceil(double(exact) * std::exp2(0.25))));
+    QVERIFY2(value >= exact && value <= upper,
+             qPrintable(QString("p%1 = %2, ожидалось %3..%4").arg(p).arg(value).arg(exact).arg(upper)));
+}
+
+void TestEventJournal::phaseKeys()
+{
+    for (int i = 0; i < EventJournal::PhaseCount; ++i) {
+        const VmPhase phase = VmPhase(i);
+        VmPhase parsed;
+        QVERIFY(EventJournal::phaseFromKey(EventJournal::phaseKey(phase), &parsed));
+        QCOMPARE(int(parsed), i);
+        QVERIFY(!EventJournal::phaseTitle(phase).isEmpty());
+    }
+    VmPhase parsed;
+    QVERIFY(!EventJournal::phaseFromKey("reboot", &parsed));
+}
+
+// Полный цикл одной ВМ: поля на месте, from — предыдущая отмеченная фаза,
+// у первых фаз обеих половин цикла отрезка нет
+void TestEventJournal::jsonLines()
+{
+    const QString path = m_dir->filePath("journal/events.jsonl");
+    const QVector<VmPhase> phases = {
+        VmPhase::Validate, VmPhase::Spawn, VmPhase::Started, VmPhase::TapAttached,
+        VmPhase::BridgeJoined, VmPhase::StopRequested, VmPhase::Finished, VmPhase::Destroyed,
+    };
+    {
+        EventJournal journal;
+        journal.setFile(path);
+        for (VmPhase phase : phases)
+            journal.record("vm0", 7, phase, phase == VmPhase::Started ? "pid 4242" : QString());
+        QCOMPARE(journal.recordedCount(), quint64(phases.size() - 2));
+        QCOMPARE(journal.vms(), QStringList({"vm0"}));
+    }
+
+    QStringList errors;
+    const QList<QJsonObject> events = readLines(path, &errors);
+    QVERIFY2(errors.isEmpty(), qPrintable(errors.join('\n')));
+    QCOMPARE(events.size(), phases.size());
+
+    const QString session = events.first().value("session").toString();
+    QVERIFY(!session.isEmpty());
+    double lastMonoNs = 0;
+    for (int i = 0; i < events.size(); ++i) {
+        const QJsonObject &event = events[i];
+        const VmPhase phase = phases[i];
+        QCOMPARE(event.value("vm").toString(), QString("vm0"));
+        QCOMPARE(event.value("run").toInt(), 7);
+        QCOMPARE(event.value("phase").toString(), EventJournal::phaseKey(phase));
+        QCOMPARE(event.value("session").toString(), session);
+        QVERIFY(event.value("ts").toDouble() > 0);
+        QVERIFY(event.value("mono_ns").toDouble() >= lastMonoNs);
+        lastMonoNs = event.value("mono_ns").toDouble();
+
+        const bool anchored = phase != VmPhase::Validate && phase != VmPhase::StopRequested;
+        QCOMPARE(event.contains("from"), anchored);
+        QCOMPARE(event.contains("ms"), anchored);
+        if (anchored) {
+            QCOMPARE(event.value("from").toString(), EventJournal::phaseKey(phases[i - 1]));
+            QVERIFY(event.value("ms").toDouble() >= 0);
+        }
+        QCOMPARE(event.value("detail").toString(), phase == VmPhase::Started ? QString("pid 4242") : QString());
+    }
+}
+
+// Деструктор сразу после пачки record(): писатель дописывает очередь до
+// конца, строки в порядке вызовов
+void TestEventJournal::flushOnDestruction()
+{
+    const QString path = m_dir->filePath("events.jsonl");
+    {
+        EventJournal journal;
+        journal.setFile(path);
+        for (int i = 0; i < FloodEvents; ++i)
+            journal.record(QString("vm%1").arg(i % 4), quint64(i), VmPhase::Validate, QString::number(i));
+        QCOMPARE(journal.droppedCount(), quint64(0));
+    }
+
+    QStringList errors;
+    const QList<QJsonObject> events = readLines(path, &errors);
+    QVERIFY2(errors.isEmpty(), qPrintable(errors.mid(0, 5).join('\n')));
+    QCOMPARE(events.size(), FloodEvents);
+    for (int i = 0; i < events.size(); ++i) {
+        if (events[i].value("detail").toString() != QString::number(i))
+            QFAIL(qPrintable(QString("строка %1: detail %2").arg(i).arg(events[i].value("detail").toString())));
+    }
+
+    // Второй журнал на тот же файл дописывает, а не затирает
+    {
+        EventJournal journal;
+        journal.setFile(path);
+        journal.record("vm0", 1, VmPhase::Validate, "tail");
+    }
+    const QList<QJsonObject> appended = readLines(path, &errors);
+    QCOMPARE(appended.size(), FloodEvents + 1);
+    QCOMPARE(appended.last().value("detail").toString(), QString("tail"));
+}
+
+// История "прошлого запуска" с известными отрезками: 1..100 мс у vm0 и
+// десять по 1000 мс у vm1, часть — в ротированном файле; мусор пропускается
+void TestEventJournal::percentiles()
+{
+    const QString path = m_dir->filePath("events.jsonl");
+    {
+        QFile rotated(path + ".1");
+        QVERIFY(rotated.open(QIODevice::WriteOnly));
+        for (int ms = 1; ms <= 50; ++ms)
+            rotated.write(historyLine("vm0", VmPhase::Started, ms));
+    }
+    {
+        QFile current(path);
+        QVERIFY(current.open(QIODevice::WriteOnly));
+        for (int ms = 51; ms <= 100; ++ms)
+            current.write(historyLine("vm0", VmPhase::Started, ms));
+        for (int i = 0; i < 10; ++i)
+            current.write(historyLine("vm1", VmPhase::Started, 1000));
+        current.write(historyLine("vm1", VmPhase::Destroyed, 250));
+        current.write("not json\n");
+        current.write("{\"session\":\"feedface\",\"vm\":\"vm0\",\"phase\":\"spawn\"}\n");
+        current.write("{\"session\":\"feedface\",\"vm\":\"vm0\",\"phase\":\"reboot\",\"ms\":5}\n");
+    }
+
+    EventJournal journal;
+    QSignalSpy loaded(&journal, &EventJournal::historyLoaded);
+    journal.setFile(path);
+    journal.loadHistory();
+    QTRY_COMPARE(loaded.count(), 1);
+    QCOMPARE(loaded.first().first().toInt(), 111);
+    QCOMPARE(journal.vms(), QStringList({"vm0", "vm1"}));
+
+    const LatencyHistogram started = journal.stats("vm0")[int(VmPhase::Started)];
+    QCOMPARE(started.count(), quint64(100));
+    QCOMPARE(started.min(), qint64(1));
+    QCOMPARE(started.max(), qint64(100));
+    QCOMPARE(started.mean(), 50.5);
+    checkPercentile(started, 50, 50);
+    checkPercentile(started, 90, 90);
+    checkPercentile(started, 95, 95);
+    checkPercentile(started, 99, 99);
+    QCOMPARE(journal.stats("vm0")[int(VmPhase::Spawn)].count(), quint64(0));
+
+    const LatencyHistogram destroyed = journal.stats("vm1")[int(VmPhase::Destroyed)];
+    QCOMPARE(destroyed.count(), quint64(1));
+    QCOMPARE(destroyed.percentile(50), qint64(250));
+
+    // Сумма по ВМ: 100 коротких и 10 длинных — p50 у коротких, p95 уже у длинных
+    const LatencyHistogram total = journal.stats()[int(VmPhase::Started)];
+    QCOMPARE(total.count(), quint64(110));
+    checkPercentile(total, 50, 55);
+    QCOMPARE(total.percentile(95), qint64(1000));
+    QCOMPARE(total.max(), qint64(1000));
+
+    // Живые отрезки добавляются к истории
+    journal.record("vm0", 1, VmPhase::Spawn);
+    journal.record("vm0", 1, VmPhase::Started);
+    QCOMPARE(journal.stats("vm0")[int(VmPhase::Started)].count(), quint64(101));
+}
+
+// Без файла — только статистика; писатель ничего не теряет и не пишет
+void TestEventJournal::noFile()
+{
+    EventJournal journal;
+    journal.record("vm0", 1, VmPhase::Validate);
+    QTest::qWait(50);
+    journal.record("vm0", 1, VmPhase::Spawn);
+    QCOMPARE(journal.recordedCount(), quint64(1));
+    QVERIFY(journal.stats("vm0")[int(VmPhase::Spawn)].min() >= 50);
+    QCOMPARE(journal.droppedCount(), quint64(0));
+    QVERIFY(journal.writeError().isEmpty());
+
+    // Новый run сбрасывает отметки: Spawn без Validate — без отрезка
+    journal.record("vm0", 2, VmPhase::Spawn);
+    QCOMPARE(journal.recordedCount(), quint64(1));
+}
+
+QTEST_GUILESS_MAIN(TestEventJournal)
+#include "tst_eventjournal.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_eventjournal
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_eventjournal.cpp
@@ -0,0 +1,170 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include <atomic>
+#include <sys/stat.h>
+
+#include "imageclone.h"
+
+namespace {
+
+constexpr qint64 MiB = 1 << 20;
+constexpr qint64 GoldenBytes = 64 * MiB;
+
+qint64 allocatedBytes(const QString &path)
+{
+    struct stat st;
+    return ::stat(QFile::encodeName(path).constData(), &st) == 0 ? qint64(st.st_blocks) * 512 : -1;
+}
+
+bool sameContent(const QString &a, const QString &b)
+{
+    QFile left(a), right(b);
+    if (!left.open(QIODevice::ReadOnly) || !right.open(QIODevice::ReadOnly) || left.size() != right.size())
+        return false;
+    while (!left.atEnd()) {
+        if (left.read(MiB) != right.read(MiB))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// Разреженный шаблон 64 МБ: случайные данные в начале и в середине и явно
+// записанные нули. Копия любым способом должна совпасть побайтно и не
+// занять на диске больше исходника; отменённая — не оставить ничего;
+// ImageCloner держит не больше maxParallel копий на одно устройство
+class TestImageClone : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void copy_data();
+    void copy();
+    void cancelBeforeStart();
+    void parallelLimit();
+
+private:
+    QTemporaryDir m_root;
+    QString m_golden;
+    qint64 m_goldenAllocated = 0;
+};
+
+void TestImageClone::initTestCase()
+{
+    QVERIFY(m_root.isValid());
+    QVERIFY(QDir().mkpath(m_root.filePath("golden")));
+    m_golden = m_root.filePath("golden/golden.img");
+
+    QFile file(m_golden);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.resize(GoldenBytes));
+    QByteArray data(int(4 * MiB), Qt::Uninitialized);
+    QRandomGenerator::global()->fillRange(reinterpret_cast<quint32 *>(data.data()), data.size() / 4);
+    file.seek(0);
+    file.write(data.constData(), MiB);
+    file.seek(24 * MiB);
+    file.write(data);
+    file.seek(48 * MiB);
+    file.write(QByteArray(int(4 * MiB), '\0'));
+    file.close();
+
+    m_goldenAllocated = allocatedBytes(m_golden);
+    QVERIFY(m_goldenAllocated > 0);
+}
+
+void TestImageClone::copy_data()
+{
+    QTest::addColumn<bool>("reflink");
+    QTest::addColumn<bool>("copyRange");
+
+    QTest::newRow("auto") << true << true;
+    QTest::newRow("copy-file-range") << false << true;
+    QTest::newRow("sparse") << false << false;
+}
+
+void TestImageClone::copy()
+{
+    QFETCH(bool, reflink);
+    QFETCH(bool, copyRange);
+
+    ImageCopy::Options options;
+    options.reflink = reflink;
+    options.copyRange = copyRange;
+    const QString name = QTest::currentDataTag();
+    const QString target = m_root.filePath(QString("%1/%1.img").arg(name));
+    const ImageCopy::Result result = ImageCopy::copy(m_golden, target, options);
+    const qint64 targetAllocated = allocatedBytes(target);
+    qInfo().noquote() << QString("%1, %2 мс, данных %3 МБ, на диске %4 из %5 МБ")
+                             .arg(ImageCopy::methodName(result.method))
+                             .arg(result.elapsedMs)
+                             .arg(result.copiedBytes / MiB)
+                             .arg(targetAllocated / MiB)
+                             .arg(m_goldenAllocated / MiB);
+
+    QVERIFY2(result.ok(), qPrintable(result.error));
+    QCOMPARE(result.totalBytes, GoldenBytes);
+    QVERIFY(sameContent(m_golden, target));
+    QVERIFY2(targetAllocated <= m_goldenAllocated + MiB, "копия не разреженная");
+    if (!reflink)
+        QVERIFY(result.method != ImageCopy::Method::Reflink);
+    if (!copyRange)
+        QCOMPARE(result.method, ImageCopy::Method::Sparse);
+    QVERIFY(!QFileInfo::exists(target + ".part"));
+}
+
+// Отмена до первого куска: ни образа, ни .part, ни пустого каталога
+void TestImageClone::cancelBeforeStart()
+{
+    const std::atomic_bool cancel(true);
+    const QString target = m_root.filePath("cancelled/cancelled.img");
+    const ImageCopy::Result result = ImageCopy::copy(m_golden, target, ImageCopy::Options(), &cancel);
+
+    QVERIFY(result.cancelled);
+    QVERIFY(!result.ok());
+    QVERIFY(!QFileInfo::exists(target));
+    QVERIFY(!QFileInfo::exists(target + ".part"));
+    QVERIFY(!QFileInfo::exists(m_root.filePath("cancelled")));
+}
+
+// Четыре копии на одно устройство при пределе 2; вторая копия в тот же
+// образ не принимается
+void TestImageClone::parallelLimit()
+{
+    ImageCloner cloner;
+    cloner.setMaxParallel(2);
+    ImageCopy::Options slow;
+    slow.reflink = false;
+    slow.copyRange = false;
+    slow.chunkBytes = int(MiB);
+    cloner.setCopyOptions(slow);
+
+    int maxRunning = 0;
+    connect(&cloner, &ImageCloner::jobChanged, this, [&cloner, &maxRunning]() {
+        int running = 0;
+        for (const ImageCloner::Job &job : cloner.jobs())
+            running += job.state == ImageCloner::State::Running ? 1 : 0;
+        maxRunning = qMax(maxRunning, running);
+    });
+    QSignalSpy finished(&cloner, &ImageCloner::allFinished);
+
+    for (int i = 0; i < 4; ++i)
+        QVERIFY(cloner.clone(m_golden, m_root.filePath(QString("vm%1/vm%1.img").arg(i))) > 0);
+    QString duplicate;
+    QCOMPARE(cloner.clone(m_golden, m_root.filePath("vm0/vm0.img"), &duplicate), 0);
+    QVERIFY(!duplicate.isEmpty());
+
+    QTRY_COMPARE_WITH_TIMEOUT(cloner.activeCount(), 0, 60000);
+    QCOMPARE(cloner.jobs().size(), 4);
+    for (const ImageCloner::Job &job : cloner.jobs()) {
+        QVERIFY2(job.state == ImageCloner::State::Done, qPrintable(job.error));
+        QVERIFY(sameContent(m_golden, job.target));
+    }
+    QVERIFY2(maxRunning <= 2, qPrintable(QString("на одном устройстве шло копий: %1").arg(maxRunning)));
+    QVERIFY(finished.count() >= 1);
+}
+
+QTEST_GUILESS_MAIN(TestImageClone)
+#include "tst_imageclone.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_imageclone
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_imageclone.cpp
@@ -0,0 +1,261 @@
+#include <QtTest>
+#include <QScopedPointer>
+#include <QSet>
+
+#include "guestprocess.h"
+#include "interfacewatcher.h"
+#include "stubtools.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+
+namespace {
+
+const QString Tap = "tap7";
+constexpr int AppearDelayMs = 150;
+constexpr int DeadlineMs = 400;
+// Дольше дедлайна с запасом на опрос с шагом до 500 мс
+constexpr int SettleMs = DeadlineMs + 1000;
+
+// Опрос по-настоящему, но интерфейс "появляется" не в ядре, а в наборе:
+// как у FakeInterfaceWatcher, только без notifyInterface() — его находит
+// сам цикл перепроверки
+class ScriptedPollWatcher : public PollingInterfaceWatcher
+{
+public:
+    explicit ScriptedPollWatcher(int appearDelayMs, QObject *parent = nullptr)
+        : PollingInterfaceWatcher(parent)
+        , m_appearDelayMs(appearDelayMs)
+    {
+    }
+
+    bool interfaceExists(const QString &ifname) const override { return m_present.contains(ifname); }
+
+protected:
+    void waitStarted(const QString &ifname) override
+    {
+        if (m_appearDelayMs >= 0)
+            QTimer::singleShot(m_appearDelayMs, this, [this, ifname]() { m_present.insert(ifname); });
+    }
+
+private:
+    int m_appearDelayMs;
+    QSet<QString> m_present;
+};
+
+struct Outcome {
+    int calls = 0;
+    bool ready = false;
+    qint64 elapsedMs = -1;
+};
+
+InterfaceWatcher *createWatcher(const QString &backend, int appearDelayMs)
+{
+    if (backend == "fake")
+        return new FakeInterfaceWatcher(appearDelayMs);
+    return new ScriptedPollWatcher(appearDelayMs);
+}
+
+InterfaceWatcher::ReadyCallback record(Outcome *outcome)
+{
+    return [outcome](bool ready, qint64 elapsedMs) {
+        ++outcome->calls;
+        outcome->ready = ready;
+        outcome->elapsedMs = elapsedMs;
+    };
+}
+
+}
+
+// Ожидание tap на бэкендах fake и poll: интерфейс до дедлайна, дедлайн без
+// интерфейса, cancel(), удалённый context; callback ровно один раз и никогда
+// изнутри waitFor(). Сверху — VmInstance на заглушках: у каждой ВМ своя
+// задержка "старт → сеть готова"
+class TestInterfaceWatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void appears_data();
+    void appears();
+    void deadline_data();
+    void deadline();
+    void cancel_data();
+    void cancel();
+    void contextDeleted_data();
+    void contextDeleted();
+    void loopback();
+    void vmNetworkReady();
+
+private:
+    static void addBackends();
+
+    StubTools m_stubs;
+};
+
+void TestInterfaceWatcher::initTestCase()
+{
+    QVERIFY2(m_stubs.prepare(), qPrintable(m_stubs.errorString()));
+}
+
+void TestInterfaceWatcher::addBackends()
+{
+    QTest::addColumn<QString>("backend");
+
+    QTest::newRow("fake") << "fake";
+    QTest::newRow("poll") << "poll";
+}
+
+void TestInterfaceWatcher::appears_data()
+{
+    addBackends();
+}
+
+void TestInterfaceWatcher::appears()
+{
+    QFETCH(QString, backend);
+
+    QScopedPointer<InterfaceWatcher> watcher(createWatcher(backend, AppearDelayMs));
+    QCOMPARE(watcher->backendName(), backend);
+    Outcome outcome;
+    watcher->waitFor(Tap, DeadlineMs, nullptr, record(&outcome));
+    QCOMPARE(outcome.calls, 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(outcome.calls, 1, SettleMs);
+    QVERIFY(outcome.ready);
+    QVERIFY2(outcome.elapsedMs >= AppearDelayMs && outcome.elapsedMs < DeadlineMs,
+             qPrintable(QString::number(outcome.elapsedMs)));
+
+    QTest::qWait(DeadlineMs);
+    QCOMPARE(outcome.calls, 1);
+}
+
+void TestInterfaceWatcher::deadline_data()
+{
+    addBackends();
+}
+
+void TestInterfaceWatcher::deadline()
+{
+    QFETCH(QString, backend);
+
+    QScopedPointer<InterfaceWatcher> watcher(createWatcher(backend, -1));
+    Outcome outcome;
+    watcher->waitFor(Tap, DeadlineMs, nullptr, record(&outcome));
+
+    QTRY_COMPARE_WITH_TIMEOUT(outcome.calls, 1, SettleMs);
+    QVERIFY(!outcome.ready);
+    QVERIFY2(outcome.elapsedMs >= DeadlineMs, qPrintable(QString::number(outcome.elapsedMs)));
+
+    QTest::qWait(AppearDelayMs);
+    QCOMPARE(outcome.calls, 1);
+}
+
+void TestInterfaceWatcher::cancel_data()
+{
+    addBackends();
+}
+
+// Отменённое ожидание молчит и при появлении интерфейса, и по дедлайну;
+// соседнее ожидание того же tap не задето
+void TestInterfaceWatcher::cancel()
+{
+    QFETCH(QString, backend);
+
+    QScopedPointer<InterfaceWatcher> watcher(createWatcher(backend, AppearDelayMs));
+    Outcome cancelled;
+    Outcome kept;
+    const quint64 id = watcher->waitFor(Tap, DeadlineMs, nullptr, record(&cancelled));
+    watcher->waitFor(Tap, DeadlineMs, nullptr, record(&kept));
+    watcher->cancel(id);
+    // Повторная отмена и неизвестный id — без последствий
+    watcher->cancel(id);
+    watcher->cancel(0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(kept.calls, 1, SettleMs);
+    QVERIFY(kept.ready);
+    QTest::qWait(SettleMs);
+    QCOMPARE(cancelled.calls, 0);
+}
+
+void TestInterfaceWatcher::contextDeleted_data()
+{
+    addBackends();
+}
+
+void TestInterfaceWatcher::contextDeleted()
+{
+    QFETCH(QString, backend);
+
+    QScopedPointer<InterfaceWatcher> watcher(createWatcher(backend, AppearDelayMs));
+    auto *context = new QObject;
+    Outcome outcome;
+    watcher->waitFor(Tap, DeadlineMs, context, record(&outcome));
+    delete context;
+
+    QTest::qWait(SettleMs);
+    QCOMPARE(outcome.calls, 0);
+}
+
+// Базовая проверка через if_nametoindex() на настоящем интерфейсе хоста
+void TestInterfaceWatcher::loopback()
+{
+    PollingInterfaceWatcher watcher;
+    QString loopback;
+    for (const QString &name : {QString("lo"), QString("lo0")}) {
+        if (watcher.interfaceExists(name))
+            loopback = name;
+    }
+    if (loopback.isEmpty())
+        QSKIP("нет ни lo, ни lo0");
+    QVERIFY(!watcher.interfaceExists("vmrun-no-such-if0"));
+
+    Outcome outcome;
+    watcher.waitFor(loopback, DeadlineMs, nullptr, record(&outcome));
+    QCOMPARE(outcome.calls, 0);
+    QTRY_COMPARE_WITH_TIMEOUT(outcome.calls, 1, DeadlineMs);
+    QVERIFY(outcome.ready);
+}
+
+// tap'ы двух ВМ появляются в разное время — networkReadyMs у каждой свой
+void TestInterfaceWatcher::vmNetworkReady()
+{
+    StubTools::Options options;
+    options.tapDelayMs = -1;  // только announce()
+    options.taps = 2;
+    m_stubs.apply(options);
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(2));
+    auto *network = qobject_cast<FakeInterfaceWatcher *>(supervisor->network());
+    QVERIFY(network);
+    VmInstance *first = supervisor->at(0);
+    VmInstance *second = supervisor->at(1);
+
+    for (VmInstance *vm : supervisor->instances())
+        vm->start();
+    QTRY_VERIFY_WITH_TIMEOUT(StubTools::allIn(supervisor.data(), VmInstance::State::Running),
+                             2 * GuestProcess::StartDeadlineMs);
+    QVERIFY(first->networkReadyMs() < 0);
+    QVERIFY(second->networkReadyMs() < 0);
+
+    QTest::qWait(AppearDelayMs);
+    network->announce(first->config().tap);
+    QTRY_VERIFY_WITH_TIMEOUT(first->networkReadyMs() >= 0, 5000);
+    QVERIFY(second->networkReadyMs() < 0);
+
+    QTest::qWait(DeadlineMs);
+    network->announce(second->config().tap);
+    QTRY_VERIFY_WITH_TIMEOUT(second->networkReadyMs() >= 0, 5000);
+
+    QVERIFY2(first->networkReadyMs() >= AppearDelayMs, qPrintable(QString::number(first->networkReadyMs())));
+    QVERIFY2(second->networkReadyMs() >= first->networkReadyMs() + DeadlineMs / 2,
+             qPrintable(QString("%1 / %2").arg(first->networkReadyMs()).arg(second->networkReadyMs())));
+    QCOMPARE(first->networkReadyStats().count(), quint64(1));
+    QCOMPARE(second->networkReadyStats().count(), quint64(1));
+
+    QSignalSpy stopped(supervisor.data(), &VmSupervisor::allStopped);
+    QCOMPARE(supervisor->stopAll(), 2);
+    QTRY_COMPARE_WITH_TIMEOUT(stopped.count(), 1, 15000);
+}
+
+QTEST_GUILESS_MAIN(TestInterfaceWatcher)
+#include "tst_interfacewatcher.moc"
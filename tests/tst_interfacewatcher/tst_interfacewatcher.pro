@@ -0,0 +1,7 @@
+TARGET = tst_interfacewatcher
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_interfacewatcher.cpp
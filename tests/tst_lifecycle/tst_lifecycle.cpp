@@ -0,0 +1,135 @@
+#include <QtTest>
+#include <QScopedPointer>
+
+#include "guestprocess.h"
+#include "stubtools.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+
+// Жизненный цикл ВМ на заглушках: start → Running → tap в bridge0 →
+// stopAll → Stopped, с поздним tap, медленным и ненадёжным ifconfig и stop()
+// на полпути запуска.
+// После остановки в каталоге состояния гостей не должно остаться файлов
+class TestLifecycle : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void startStop_data();
+    void startStop();
+    void stopWhileWaitingForTap();
+    void stopWhileStarting();
+
+private:
+    StubTools m_stubs;
+};
+
+void TestLifecycle::initTestCase()
+{
+    QVERIFY2(m_stubs.prepare(), qPrintable(m_stubs.errorString()));
+}
+
+void TestLifecycle::startStop_data()
+{
+    QTest::addColumn<int>("vms");
+    QTest::addColumn<int>("rounds");
+    QTest::addColumn<int>("tapDelayMs");
+    QTest::addColumn<int>("ifconfigDelayMs");
+    QTest::addColumn<int>("ifconfigFailPercent");
+
+    QTest::newRow("one-vm") << 1 << 3 << 50 << 0 << 0;
+    QTest::newRow("four-vms") << 4 << 3 << 50 << 0 << 0;
+    QTest::newRow("late-tap") << 2 << 1 << 1500 << 0 << 0;
+    QTest::newRow("slow-ifconfig") << 4 << 2 << 50 << 200 << 0;
+    QTest::newRow("flaky-ifconfig") << 4 << 3 << 50 << 0 << 20;
+}
+
+void TestLifecycle::startStop()
+{
+    QFETCH(int, vms);
+    QFETCH(int, rounds);
+    QFETCH(int, tapDelayMs);
+    QFETCH(int, ifconfigDelayMs);
+    QFETCH(int, ifconfigFailPercent);
+
+    StubTools::Options options;
+    options.tapDelayMs = tapDelayMs;
+    options.ifconfigDelayMs = ifconfigDelayMs;
+    options.ifconfigFailPercent = ifconfigFailPercent;
+    options.taps = vms;
+    m_stubs.apply(options);
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(vms));
+    QSignalSpy stopped(supervisor.data(), &VmSupervisor::allStopped);
+    // С запасом на ожидание tap, пачку NetworkReconciler и две команды ifconfig
+    const int networkTimeoutMs = tapDelayMs + 4 * ifconfigDelayMs + 5000;
+
+    for (int round = 0; round < rounds; ++round) {
+        for (VmInstance *vm : supervisor->instances())
+            vm->start();
+        QTRY_VERIFY_WITH_TIMEOUT(StubTools::allIn(supervisor.data(), VmInstance::State::Running),
+                                 2 * GuestProcess::StartDeadlineMs);
+        QTRY_VERIFY_WITH_TIMEOUT(StubTools::networkSettled(supervisor.data()), networkTimeoutMs);
+        if (ifconfigFailPercent == 0) {
+            for (const VmInstance *vm : supervisor->instances())
+                QVERIFY2(vm->networkReadyMs() >= 0, qPrintable(vm->name()));
+        }
+
+        QCOMPARE(supervisor->stopAll(), vms);
+        QTRY_COMPARE_WITH_TIMEOUT(stopped.count(), round + 1, 15000);
+        QCOMPARE(StubTools::countIn(supervisor.data(), VmInstance::State::Stopped), vms);
+    }
+
+    QCOMPARE(supervisor->stopStats().count(), quint64(vms * rounds));
+    QCOMPARE(GuestProcess::stateFiles(supervisor->runtimeDirectory()), QStringList());
+}
+
+// stop(), пока bhyve запущен, а tap ещё не появился: ВМ гаснет без Failed,
+// поздний tap её не оживляет
+void TestLifecycle::stopWhileWaitingForTap()
+{
+    StubTools::Options options;
+    options.tapDelayMs = 2000;
+    options.taps = 1;
+    m_stubs.apply(options);
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(1));
+    VmInstance *vm = supervisor->at(0);
+
+    vm->start();
+    QTRY_VERIFY_WITH_TIMEOUT(vm->processId() > 0, 2 * GuestProcess::StartDeadlineMs);
+    QVERIFY(vm->networkReadyMs() < 0);
+    vm->stop();
+    QTRY_COMPARE_WITH_TIMEOUT(vm->state(), VmInstance::State::Stopped, 15000);
+
+    QTest::qWait(options.tapDelayMs + 500);
+    QCOMPARE(vm->state(), VmInstance::State::Stopped);
+    QVERIFY(vm->networkReadyMs() < 0);
+}
+
+// stop() сразу после start(), пока прослойка не отчиталась pid'ом bhyve:
+// поздний started не объявляет ВМ работающей, а запускает ступени остановки
+void TestLifecycle::stopWhileStarting()
+{
+    StubTools::Options options;
+    options.taps = 1;
+    m_stubs.apply(options);
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(1));
+    VmInstance *vm = supervisor->at(0);
+    bool wasRunning = false;
+    connect(vm, &VmInstance::stateChanged, this, [&wasRunning](VmInstance::State state) {
+        wasRunning = wasRunning || state == VmInstance::State::Running;
+    });
+
+    vm->start();
+    QCOMPARE(vm->state(), VmInstance::State::Starting);
+    QVERIFY(vm->processId() <= 0);
+    vm->stop();
+    QCOMPARE(vm->state(), VmInstance::State::Stopping);
+    QTRY_COMPARE_WITH_TIMEOUT(vm->state(), VmInstance::State::Stopped, 2 * GuestProcess::StartDeadlineMs + 15000);
+
+    QVERIFY(!wasRunning);
+    QCOMPARE(GuestProcess::stateFiles(supervisor->runtimeDirectory()), QStringList());
+}
+
+QTEST_GUILESS_MAIN(TestLifecycle)
+#include "tst_lifecycle.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_lifecycle
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_lifecycle.cpp
@@ -0,0 +1,185 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "logarchive.h"
+#include "logbuffer.h"
+
+namespace {
+
+// Строки "line N" в буфер кусками по chunkLines; pad — хвост для объёма
+void appendLines(LogBuffer &buffer, int first, int count, int chunkLines = 100, const QByteArray &pad = QByteArray())
+{
+    QByteArray chunk;
+    for (int i = first; i < first + count; ++i) {
+        chunk += "line " + QByteArray::number(i) + pad + '\n';
+        if ((i - first + 1) % chunkLines == 0 || i + 1 == first + count) {
+            buffer.appendChunk(LogSeverity::Stdout, chunk);
+            chunk.clear();
+        }
+    }
+}
+
+} // namespace
+
+// Архив консоли: каждая строка доходит до диска, даже если гость выдал за
+// кадр больше ёмкости LogBuffer (цикл событий здесь не крутится, linesFlushed
+// не приходит ни разу — строки уходят в архив только по aboutToEvict);
+// файлы сменяются по размеру и удаляются сверх лимита, новый архив
+// дописывает последний файл; читатель находит строку по номеру, времени
+// и подстроке
+class TestLogArchive : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void floodBeforeFlush_data();
+    void floodBeforeFlush();
+    void rotation();
+    void resume();
+    void reader();
+};
+
+void TestLogArchive::floodBeforeFlush_data()
+{
+    QTest::addColumn<int>("capacity");
+    QTest::addColumn<int>("lines");
+    QTest::addColumn<int>("chunkLines");
+
+    QTest::newRow("fits-ring") << 1000 << 500 << 50;
+    QTest::newRow("one-chunk") << 100 << 1000 << 1000;
+    QTest::newRow("small-chunks") << 100 << 1000 << 7;
+    QTest::newRow("line-by-line") << 64 << 5000 << 1;
+}
+
+void TestLogArchive::floodBeforeFlush()
+{
+    QFETCH(int, capacity);
+    QFETCH(int, lines);
+    QFETCH(int, chunkLines);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LogBuffer buffer(capacity);
+    {
+        // Архив уходит раньше буфера: деструктор дописывает хвост и ждёт поток записи
+        LogArchive archive;
+        archive.setDirectory(dir.path());
+        archive.follow("vm0", &buffer);
+
+        appendLines(buffer, 0, lines, chunkLines);
+        QCOMPARE(buffer.droppedCount(), quint64(qMax(0, lines - capacity)));
+        QCOMPARE(archive.droppedCount(), quint64(0));
+    }
+
+    LogArchiveReader reader;
+    QString error;
+    QVERIFY2(reader.open(QDir(dir.path()).filePath("vm0"), &error), qPrintable(error));
+    QCOMPARE(reader.lineCount(), qint64(lines));
+    for (const qint64 row : {qint64(0), qint64(capacity), qint64(lines - 1)}) {
+        if (row < lines)
+            QCOMPARE(reader.line(row).mid(LogArchive::TextOffset), "line " + QByteArray::number(row));
+    }
+}
+
+// Файл — не больше 64 КиБ, файлов — не больше трёх: старые уходят вместе
+// с индексом, последняя строка — на месте
+void TestLogArchive::rotation()
+{
+    constexpr int Lines = 4000;
+    constexpr int MaxFiles = 3;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LogBuffer buffer;
+    {
+        LogArchive archive;
+        archive.setLimits(64 * 1024, MaxFiles);
+        archive.setDirectory(dir.path());
+        archive.follow("vm0", &buffer);
+        appendLines(buffer, 0, Lines, 100, QByteArray(100, '.'));
+    }
+
+    const QString vmDir = QDir(dir.path()).filePath("vm0");
+    const QStringList files = LogArchive::segmentFiles(vmDir);
+    QCOMPARE(files.size(), MaxFiles);
+    QVERIFY(!files.first().endsWith("console-000001.log"));
+    for (const QString &file : files) {
+        QVERIFY(QFileInfo(file).size() <= 64 * 1024);
+        QVERIFY(QFile::exists(LogArchive::indexPathFor(file)));
+    }
+
+    LogArchiveReader reader;
+    QString error;
+    QVERIFY2(reader.open(vmDir, &error), qPrintable(error));
+    QCOMPARE(reader.fileCount(), MaxFiles);
+    QVERIFY(reader.lineCount() > 0 && reader.lineCount() < Lines);
+    QVERIFY(reader.line(reader.lineCount() - 1).mid(LogArchive::TextOffset).startsWith("line " + QByteArray::number(Lines - 1)));
+}
+
+// Перезапуск окна: новый архив дописывает неполный последний файл, а не
+// начинает следующий, и сквозная нумерация строк продолжается
+void TestLogArchive::resume()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    for (int session = 0; session < 2; ++session) {
+        LogBuffer buffer;
+        LogArchive archive;
+        archive.setDirectory(dir.path());
+        archive.follow("vm0", &buffer);
+        appendLines(buffer, session * 1000, 1000);
+    }
+
+    LogArchiveReader reader;
+    QString error;
+    QVERIFY2(reader.open(QDir(dir.path()).filePath("vm0"), &error), qPrintable(error));
+    QCOMPARE(reader.fileCount(), 1);
+    QCOMPARE(reader.lineCount(), qint64(2000));
+    for (const qint64 row : {qint64(0), qint64(999), qint64(1000), qint64(1999)})
+        QCOMPARE(reader.line(row).mid(LogArchive::TextOffset), "line " + QByteArray::number(row));
+}
+
+void TestLogArchive::reader()
+{
+    constexpr int Lines = 1000;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    LogBuffer buffer;
+    {
+        LogArchive archive;
+        archive.setDirectory(dir.path());
+        archive.follow("vm0", &buffer);
+        appendLines(buffer, 0, Lines);
+    }
+
+    LogArchiveReader reader;
+    QString error;
+    QVERIFY2(reader.open(QDir(dir.path()).filePath("vm0"), &error), qPrintable(error));
+    QCOMPARE(reader.lineCount(), qint64(Lines));
+    QVERIFY(reader.line(Lines).isEmpty());
+
+    // Строки между записями индекса — через memchr от ближайшей
+    for (const qint64 row : {qint64(LogArchive::IndexStride - 1), qint64(LogArchive::IndexStride),
+                             qint64(LogArchive::IndexStride + 1), qint64(Lines - 1)})
+        QCOMPARE(reader.line(row).mid(LogArchive::TextOffset), "line " + QByteArray::number(row));
+
+    // Первая строка не раньше времени строки 500: с тем же временем, предыдущая — раньше
+    const qint64 at = reader.lineTimestamp(500);
+    QVERIFY(at > 0);
+    const qint64 row = reader.rowAtTime(at);
+    QVERIFY(row <= 500);
+    QCOMPARE(reader.lineTimestamp(row), at);
+    if (row > 0)
+        QVERIFY(reader.lineTimestamp(row - 1) < at);
+    QCOMPARE(reader.rowAtTime(reader.lineTimestamp(Lines - 1) + 1), qint64(Lines));
+
+    QCOMPARE(reader.find("line 777", 0), qint64(777));
+    QCOMPARE(reader.find("line 777", 778), qint64(-1));
+    QCOMPARE(reader.find("нет такой строки", 0), qint64(-1));
+    const std::atomic<bool> cancel(true);
+    QCOMPARE(reader.find("line 777", 0, &cancel), qint64(-1));
+}
+
+QTEST_GUILESS_MAIN(TestLogArchive)
+#include "tst_logarchive.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_logarchive
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_logarchive.cpp
@@ -0,0 +1,145 @@
+#include <QtTest>
+
+#include "hostmemory.h"
+#include "memoryadmission.h"
+
+namespace {
+
+constexpr quint64 GiB = 1ULL << 30;
+constexpr quint64 KiB = 1024;
+
+} // namespace
+
+// Разбор /proc/meminfo и размеров ВМ, решения допуска на поддельной памяти
+// хоста (16 ГБ, резерв 2 ГБ) и цена снимка на настоящем backend'е
+class TestMemoryAdmission : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void meminfo_data();
+    void meminfo();
+    void parseMemory_data();
+    void parseMemory();
+    void verdicts();
+    void snapshotSpeed();
+};
+
+void TestMemoryAdmission::meminfo_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<bool>("ok");
+    QTest::addColumn<quint64>("total");
+    QTest::addColumn<quint64>("available");
+    QTest::addColumn<quint64>("wired");
+
+    QTest::newRow("linux") << QByteArray("MemTotal:       16318480 kB\n"
+                                         "MemFree:         1022308 kB\n"
+                                         "MemAvailable:    9123456 kB\n"
+                                         "Mlocked:           65536 kB\n")
+                           << true << 16318480 * KiB << 9123456 * KiB << 65536 * KiB;
+    // Ядра старше 3.14: MemAvailable нет — свободная плюс кэши
+    QTest::newRow("old-kernel") << QByteArray("MemTotal:        8000000 kB\n"
+                                              "MemFree:            1000 kB\n"
+                                              "Buffers:             500 kB\n"
+                                              "Cached:             2000 kB\n")
+                                << true << 8000000 * KiB << 3500 * KiB << quint64(0);
+    QTest::newRow("no-total") << QByteArray("MemFree: 1000 kB\n") << false << quint64(0) << 1000 * KiB << quint64(0);
+    QTest::newRow("empty") << QByteArray() << false << quint64(0) << quint64(0) << quint64(0);
+}
+
+void TestMemoryAdmission::meminfo()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(bool, ok);
+    QFETCH(quint64, total);
+    QFETCH(quint64, available);
+    QFETCH(quint64, wired);
+
+    HostMemory memory;
+    QCOMPARE(MeminfoBackend::parse(text, &memory), ok);
+    QCOMPARE(memory.totalBytes, total);
+    QCOMPARE(memory.availableBytes, available);
+    QCOMPARE(memory.wiredBytes, wired);
+    QCOMPARE(memory.wireLimitBytes, quint64(0));
+}
+
+void TestMemoryAdmission::parseMemory_data()
+{
+    QTest::addColumn<QString>("memory");
+    QTest::addColumn<quint64>("bytes");
+
+    QTest::newRow("gigabytes") << "8G" << 8 * GiB;
+    QTest::newRow("megabytes") << "4096M" << 4 * GiB;
+    QTest::newRow("bare") << "512" << (512ULL << 20);
+    QTest::newRow("lower-spaced") << " 2g " << 2 * GiB;
+    QTest::newRow("fraction") << "1.5G" << quint64(0);
+    QTest::newRow("terabytes") << "1T" << quint64(0);
+    QTest::newRow("empty") << "" << quint64(0);
+}
+
+void TestMemoryAdmission::parseMemory()
+{
+    QFETCH(QString, memory);
+    QFETCH(quint64, bytes);
+
+    QCOMPARE(MemoryAdmission::parseMemory(memory), bytes);
+}
+
+// Допуск, очередь, отказ и проход очереди по release() — одна история
+void TestMemoryAdmission::verdicts()
+{
+    HostMemory host;
+    host.totalBytes = 16 * GiB;
+    host.availableBytes = 12 * GiB;
+    auto *fake = new FakeHostMemoryBackend(host);
+    MemoryAdmission admission;
+    admission.setBackend(std::unique_ptr<HostMemoryBackend>(fake));
+    admission.setReserveBytes(2 * GiB);
+    admission.setSettleMs(0);
+
+    QString reason;
+    QCOMPARE(admission.acquire("a", 8 * GiB, &reason, this, nullptr), MemoryAdmission::Verdict::Admit);
+    QCOMPARE(admission.committed("a"), 8 * GiB);
+    // Гость a закрепил свою память
+    host.availableBytes = 4 * GiB;
+    fake->set(host);
+
+    bool admittedB = false;
+    QCOMPARE(admission.acquire("b", 4 * GiB, &reason, this,
+                               [&admittedB](bool ok, const QString &) { admittedB = ok; }),
+             MemoryAdmission::Verdict::Queue);
+    QVERIFY(!reason.isEmpty());
+    QVERIFY(admission.isQueued("b"));
+    QCOMPARE(admission.acquire("c", 32 * GiB, &reason, this, nullptr), MemoryAdmission::Verdict::Reject);
+    QVERIFY(!reason.isEmpty());
+    QCOMPARE(admission.snapshot().queued, 1);
+
+    // a остановилась — очередь пропускает b без участия таймера
+    host.availableBytes = 12 * GiB;
+    fake->set(host);
+    admission.release("a");
+    QCoreApplication::processEvents();
+    QVERIFY(admittedB);
+    QCOMPARE(admission.committed("b"), 4 * GiB);
+    QVERIFY(!admission.isQueued("b"));
+
+    admission.setQueueing(false);
+    host.availableBytes = 3 * GiB;
+    fake->set(host);
+    QCOMPARE(admission.acquire("d", 4 * GiB, &reason, this, nullptr), MemoryAdmission::Verdict::Reject);
+    QVERIFY(!admission.isQueued("d"));
+}
+
+// Только время: снимок читается на каждом решении о запуске
+void TestMemoryAdmission::snapshotSpeed()
+{
+    MemoryAdmission real;
+    qInfo().noquote() << QString("backend %1: %2").arg(real.backendName(), real.snapshot().summary());
+    QBENCHMARK {
+        real.snapshot();
+    }
+}
+
+QTEST_GUILESS_MAIN(TestMemoryAdmission)
+#include "tst_memoryadmission.moc"
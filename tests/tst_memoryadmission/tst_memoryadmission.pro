@@ -0,0 +1,7 @@
+TARGET = tst_memoryadmission
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_memoryadmission.cpp
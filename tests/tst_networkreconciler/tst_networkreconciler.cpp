@@ -0,0 +1,286 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <algorithm>
+
+#include "commandrunner.h"
+#include "networkreconciler.h"
+
+namespace {
+
+const char *const DoasStub = R"(#!/bin/sh
+dir=$(dirname "$0")
+prog=$1
+shift
+exec "$dir/$prog" "$@"
+)";
+
+// "-a" — снимок из ifconfig.out; каждый вызов — строкой в ifconfig.log;
+// команда с tapN падает, если рядом есть файл fail-tapN
+const char *const IfconfigStub = R"(#!/bin/sh
+dir=$(dirname "$0")
+echo "$*" >> "$dir/ifconfig.log"
+if [ "$1" = "-a" ]; then
+    cat "$dir/ifconfig.out"
+    exit 0
+fi
+for arg in "$@"; do
+    if [ -e "$dir/fail-$arg" ]; then
+        echo "ifconfig: $arg: stub failure" >&2
+        exit 1
+    fi
+done
+exit 0
+)";
+
+// Вывод "ifconfig -a" FreeBSD: в мосту tap10 (не tap1), tap6 держит bhyve
+const char *const Snapshot =
+    "em0: flags=8843<UP,BROADCAST,RUNNING,SIMPLEX,MULTICAST> metric 0 mtu 1500\n"
+    "\tether 00:25:90:aa:bb:cc\n"
+    "bridge0: flags=8843<UP,BROADCAST,RUNNING,SIMPLEX,MULTICAST> metric 0 mtu 1500\n"
+    "\tether 58:9c:fc:10:ff:a0\n"
+    "\tid 00:00:00:00:00:00 priority 32768 hellotime 2 fwddelay 15\n"
+    "\tmember: tap10 flags=143<LEARNING,DISCOVER,AUTOEDGE,AUTOPTP>\n"
+    "\t        ifmaxaddr 0 port 7 priority 128 path cost 2000000\n"
+    "\tmember: tap3 flags=143<LEARNING,DISCOVER,AUTOEDGE,AUTOPTP>\n"
+    "\t        ifmaxaddr 0 port 5 priority 128 path cost 2000000\n"
+    "tap1: flags=8902<BROADCAST,PROMISC,SIMPLEX,MULTICAST> metric 0 mtu 1500\n"
+    "\toptions=80000<LINKSTATE>\n"
+    "\tgroups: tap\n"
+    "tap2: flags=8902<BROADCAST,PROMISC,SIMPLEX,MULTICAST> metric 0 mtu 1500\n"
+    "tap3: flags=8943<UP,BROADCAST,RUNNING,PROMISC,SIMPLEX,MULTICAST> metric 0 mtu 1500\n"
+    "\tOpened by PID 4242\n"
+    "tap5: flags=8902<BROADCAST,PROMISC,SIMPLEX,MULTICAST> metric 0 mtu 1500\n"
+    "tap6: flags=8943<UP,BROADCAST,RUNNING,PROMISC,SIMPLEX,MULTICAST> metric 0 mtu 1500\n"
+    "\tOpened by PID 4243\n"
+    "tap10: flags=8943<UP,BROADCAST,RUNNING,PROMISC,SIMPLEX,MULTICAST> metric 0 mtu 1500\n"
+    "tapfoo: flags=8902<BROADCAST,PROMISC,SIMPLEX,MULTICAST> metric 0 mtu 1500\n";
+
+struct Outcome {
+    bool called = false;
+    bool ok = false;
+    bool changed = false;
+    QString error;
+};
+
+} // namespace
+
+// NetworkReconciler против заглушек doas и ifconfig: снимок "ifconfig -a"
+// разбирается точно (tap1 — не tap10), запросы одного кадра уходят одной
+// командой, упавшая пачка повторяется по одному tap, cleanup() трогает
+// только лишнее и добавляет недостающих участников одним addm
+class TestNetworkReconciler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void parse();
+    void isTap_data();
+    void isTap();
+    void attachExactMember();
+    void coalesce();
+    void batchFallback();
+    void cleanup();
+
+private:
+    QStringList calls() const;
+    void attach(NetworkReconciler &reconciler, const QString &tap, bool attach, Outcome *outcome);
+
+    QTemporaryDir m_dir;
+    CommandRunner m_commands;
+};
+
+void TestNetworkReconciler::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    const QList<QPair<QString, const char *>> stubs = {{"doas", DoasStub}, {"ifconfig", IfconfigStub}};
+    for (const auto &stub : stubs) {
+        QFile file(m_dir.filePath(stub.first));
+        QVERIFY2(file.open(QIODevice::WriteOnly) && file.write(stub.second) > 0, qPrintable(file.errorString()));
+        file.close();
+        file.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    }
+    QFile snapshot(m_dir.filePath("ifconfig.out"));
+    QVERIFY(snapshot.open(QIODevice::WriteOnly) && snapshot.write(Snapshot) > 0);
+    m_commands.setToolDirectory(m_dir.path());
+}
+
+void TestNetworkReconciler::init()
+{
+    QFile::remove(m_dir.filePath("ifconfig.log"));
+    for (const QString &file : QDir(m_dir.path()).entryList({"fail-*"}, QDir::Files))
+        QFile::remove(m_dir.filePath(file));
+}
+
+QStringList TestNetworkReconciler::calls() const
+{
+    QFile log(m_dir.filePath("ifconfig.log"));
+    if (!log.open(QIODevice::ReadOnly))
+        return QStringList();
+    return QString::fromLatin1(log.readAll()).split('\n', Qt::SkipEmptyParts);
+}
+
+void TestNetworkReconciler::attach(NetworkReconciler &reconciler, const QString &tap, bool attach, Outcome *outcome)
+{
+    auto done = [outcome](bool ok, bool changed, const QString &error) {
+        outcome->called = true;
+        outcome->ok = ok;
+        outcome->changed = changed;
+        outcome->error = error;
+    };
+    if (attach)
+        reconciler.attach(tap, this, done);
+    else
+        reconciler.detach(tap, this, done);
+}
+
+// Участники моста — множество имён, а не подстроки вывода
+void TestNetworkReconciler::parse()
+{
+    const NetworkSnapshot snapshot = NetworkSnapshot::parse(Snapshot);
+
+    QCOMPARE(snapshot.members.value("bridge0"), (QSet<QString> {"tap10", "tap3"}));
+    QVERIFY(!snapshot.members.value("bridge0").contains("tap1"));
+    QCOMPARE(snapshot.opened, (QSet<QString> {"tap3", "tap6"}));
+    QCOMPARE(snapshot.interfaces,
+             (QSet<QString> {"em0", "bridge0", "tap1", "tap2", "tap3", "tap5", "tap6", "tap10", "tapfoo"}));
+    QVERIFY(snapshot.members.value("em0").isEmpty());
+}
+
+void TestNetworkReconciler::isTap_data()
+{
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<bool>("tap");
+
+    QTest::newRow("tap0") << "tap0" << true;
+    QTest::newRow("tap17") << "tap17" << true;
+    QTest::newRow("tapfoo") << "tapfoo" << false;
+    QTest::newRow("tap") << "tap" << false;
+    QTest::newRow("bridge0") << "bridge0" << false;
+    QTest::newRow("vmnet0") << "vmnet0" << false;
+}
+
+void TestNetworkReconciler::isTap()
+{
+    QFETCH(QString, name);
+    QFETCH(bool, tap);
+
+    QCOMPARE(NetworkSnapshot::isTap(name), tap);
+}
+
+// tap10 в мосту не делает участником tap1: для него — addm, для tap10 —
+// ни одной команды после снимка
+void TestNetworkReconciler::attachExactMember()
+{
+    NetworkReconciler reconciler(&m_commands);
+    Outcome tap1;
+    attach(reconciler, "tap1", true, &tap1);
+    QTRY_VERIFY(tap1.called);
+    QVERIFY2(tap1.ok, qPrintable(tap1.error));
+    QVERIFY(tap1.changed);
+    QCOMPARE(calls(), (QStringList {"-a", "bridge0 addm tap1 up"}));
+
+    QFile::remove(m_dir.filePath("ifconfig.log"));
+    Outcome tap10;
+    attach(reconciler, "tap10", true, &tap10);
+    QTRY_VERIFY(tap10.called);
+    QVERIFY(tap10.ok);
+    QVERIFY(!tap10.changed);
+    QCOMPARE(calls(), QStringList {"-a"});
+
+    // Чего нет в системе, того в мост не добавить
+    QFile::remove(m_dir.filePath("ifconfig.log"));
+    Outcome tap7;
+    attach(reconciler, "tap7", true, &tap7);
+    QTRY_VERIFY(tap7.called);
+    QVERIFY(!tap7.ok);
+    QVERIFY(tap7.error.contains("tap7"));
+    QCOMPARE(calls(), QStringList {"-a"});
+}
+
+// Запросы внутри CoalesceMs — один снимок и одна команда; на tap2 побеждает
+// последний запрос (detach: его и так нет в мосту — без команды)
+void TestNetworkReconciler::coalesce()
+{
+    NetworkReconciler reconciler(&m_commands);
+    Outcome outcomes[5];
+    attach(reconciler, "tap1", true, &outcomes[0]);
+    attach(reconciler, "tap2", true, &outcomes[1]);
+    attach(reconciler, "tap3", false, &outcomes[2]);
+    attach(reconciler, "tap5", true, &outcomes[3]);
+    attach(reconciler, "tap2", false, &outcomes[4]);
+    QTRY_VERIFY(std::all_of(std::begin(outcomes), std::end(outcomes), [](const Outcome &o) { return o.called; }));
+
+    QCOMPARE(calls(), (QStringList {"-a", "bridge0 addm tap1 deletem tap3 addm tap5 up"}));
+    for (const Outcome &outcome : outcomes)
+        QVERIFY2(outcome.ok, qPrintable(outcome.error));
+    QVERIFY(outcomes[0].changed);
+    QVERIFY(!outcomes[1].changed);
+    QVERIFY(outcomes[2].changed);
+    QVERIFY(outcomes[3].changed);
+    QVERIFY(!outcomes[4].changed);
+}
+
+// Пачка упала — по команде на tap: ошибка достаётся только виноватому
+void TestNetworkReconciler::batchFallback()
+{
+    QFile fail(m_dir.filePath("fail-tap2"));
+    QVERIFY(fail.open(QIODevice::WriteOnly));
+    fail.close();
+
+    NetworkReconciler reconciler(&m_commands);
+    Outcome tap1;
+    Outcome tap2;
+    attach(reconciler, "tap1", true, &tap1);
+    attach(reconciler, "tap2", true, &tap2);
+    QTRY_VERIFY(tap1.called && tap2.called);
+
+    QVERIFY2(tap1.ok, qPrintable(tap1.error));
+    QVERIFY(tap1.changed);
+    QVERIFY(!tap2.ok);
+    QVERIFY(tap2.error.contains("stub failure"));
+
+    QStringList log = calls();
+    QCOMPARE(log.size(), 4);
+    QCOMPARE(log.mid(0, 2), (QStringList {"-a", "bridge0 addm tap1 addm tap2 up"}));
+    // Повторы идут параллельно — порядок не важен
+    log = log.mid(2);
+    log.sort();
+    QCOMPARE(log, (QStringList {"bridge0 addm tap1 up", "bridge0 addm tap2 up"}));
+}
+
+// Ожидаются tap1 (есть, не в мосту), tap3 (в мосту) и tap4 (пропал): tap4
+// создаётся, tap1 и tap4 добавляются одной командой; tap2, tap5 и tap10
+// лишние и никем не открыты — уничтожаются, tap6 держит bhyve — остаётся,
+// tapfoo — не tapN
+void TestNetworkReconciler::cleanup()
+{
+    NetworkReconciler reconciler(&m_commands);
+    bool called = false;
+    NetworkReconciler::Report report;
+    reconciler.cleanup({"tap1", "tap3", "tap4"}, this, [&called, &report](const NetworkReconciler::Report &r) {
+        called = true;
+        report = r;
+    });
+    QTRY_VERIFY(called);
+
+    QVERIFY2(report.errors.isEmpty(), qPrintable(report.errors.join("; ")));
+    QCOMPARE(report.created, 1);
+    QCOMPARE(report.destroyed, 3);
+    QCOMPARE(report.kept, 1);
+    QCOMPARE(report.attached, 2);
+    QCOMPARE(report.failed, 0);
+    QCOMPARE(report.commands, 6);
+
+    QStringList log = calls();
+    QCOMPARE(log.size(), report.commands);
+    QCOMPARE(log.first(), QString("-a"));
+    QCOMPARE(log.last(), QString("bridge0 addm tap1 addm tap4 up"));
+    log = log.mid(1, log.size() - 2);
+    log.sort();
+    QCOMPARE(log, (QStringList {"tap10 destroy", "tap2 destroy", "tap4 create", "tap5 destroy"}));
+}
+
+QTEST_GUILESS_MAIN(TestNetworkReconciler)
+#include "tst_networkreconciler.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_networkreconciler
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_networkreconciler.cpp
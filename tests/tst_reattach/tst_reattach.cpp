@@ -0,0 +1,168 @@
+#include <QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScopedPointer>
+
+#include "guestprocess.h"
+#include "stubtools.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+
+// Подхват гостей на заглушках: supervisor удаляется с живыми bhyve (как окно
+// GUI при обновлении), новый находит их по файлам состояния — всех, с теми
+// же pid и с хвостом вывода загрузки из кусков прослойки. Файл, переживший
+// перезагрузку хоста, не подхватывается: ни ВМ, ни сбоя — только удаление
+class TestReattach : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void handover_data();
+    void handover();
+    void staleState_data();
+    void staleState();
+    void staleAttach();
+
+private:
+    // Файлы гостя, как их оставила бы прослойка; bootId пустой — текущий
+    bool writeGuest(const QString &dir, const QString &name, qint64 pid, const QString &bootId) const;
+
+    StubTools m_stubs;
+};
+
+void TestReattach::initTestCase()
+{
+    QVERIFY2(m_stubs.prepare(), qPrintable(m_stubs.errorString()));
+}
+
+bool TestReattach::writeGuest(const QString &dir, const QString &name, qint64 pid, const QString &bootId) const
+{
+    GuestState state;
+    state.name = name;
+    state.pid = pid;
+    state.shimPid = pid > 0 ? pid + 1 : 0;
+    state.config = m_stubs.config(name, "tap0");
+    QJsonObject json = state.toJson();
+    if (!bootId.isEmpty())
+        json["boot_id"] = bootId;
+
+    const QDir runtime(dir);
+    if (!runtime.mkpath("."))
+        return false;
+    const QList<QPair<QString, QByteArray>> files = {
+        {name + ".json", QJsonDocument(json).toJson(QJsonDocument::Compact)},
+        {name + ".pid", QByteArray::number(state.pid) + ' ' + QByteArray::number(state.shimPid) + '\n'},
+        {name + ".out.0", "[boot] login:\n"},
+        {name + ".err.0", QByteArray()},
+    };
+    for (const auto &file : files) {
+        QFile out(runtime.filePath(file.first));
+        if (!out.open(QIODevice::WriteOnly) || out.write(file.second) != file.second.size())
+            return false;
+    }
+    return true;
+}
+
+void TestReattach::handover_data()
+{
+    QTest::addColumn<int>("vms");
+    QTest::addColumn<int>("rounds");
+
+    QTest::newRow("one-vm") << 1 << 1;
+    QTest::newRow("four-vms") << 4 << 3;
+}
+
+void TestReattach::handover()
+{
+    QFETCH(int, vms);
+    QFETCH(int, rounds);
+
+    StubTools::Options options;
+    options.taps = vms;
+    m_stubs.apply(options);
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(vms));
+
+    for (int round = 0; round < rounds; ++round) {
+        supervisor->setKeepGuestsRunning(true);
+        for (VmInstance *vm : supervisor->instances())
+            vm->start();
+        QTRY_VERIFY_WITH_TIMEOUT(StubTools::allIn(supervisor.data(), VmInstance::State::Running),
+                                 2 * GuestProcess::StartDeadlineMs);
+        QHash<QString, qint64> pids;
+        for (const VmInstance *vm : supervisor->instances()) {
+            QVERIFY2(vm->processId() > 0, qPrintable(vm->name()));
+            pids.insert(vm->name(), vm->processId());
+        }
+
+        // Гости переживают supervisor, новый подхватывает их по файлам
+        supervisor.reset(m_stubs.createSupervisor(0));
+        QStringList names = supervisor->reattachGuests();
+        names.sort();
+        QStringList expected = pids.keys();
+        expected.sort();
+        QCOMPARE(names, expected);
+        for (auto it = pids.cbegin(); it != pids.cend(); ++it) {
+            const VmInstance *vm = supervisor->instance(it.key());
+            QVERIFY(vm);
+            QCOMPARE(vm->state(), VmInstance::State::Running);
+            QCOMPARE(vm->processId(), it.value());
+            QTRY_VERIFY2(StubTools::logContains(vm->log(), "[boot] login:"), qPrintable(vm->name()));
+        }
+
+        QSignalSpy stopped(supervisor.data(), &VmSupervisor::allStopped);
+        QCOMPARE(supervisor->stopAll(), vms);
+        QVERIFY(stopped.wait(15000));
+        QCOMPARE(StubTools::countIn(supervisor.data(), VmInstance::State::Failed), 0);
+    }
+
+    QCOMPARE(GuestProcess::stateFiles(supervisor->runtimeDirectory()), QStringList());
+}
+
+void TestReattach::staleState_data()
+{
+    QTest::addColumn<qint64>("pid");
+    QTest::addColumn<QString>("bootId");
+
+    // pid мог достаться другому процессу — смотреть на него нельзя
+    QTest::newRow("other-boot") << qint64(QCoreApplication::applicationPid()) << "vmrun-test-other-boot";
+    QTest::newRow("no-pids") << qint64(0) << QString();
+}
+
+void TestReattach::staleState()
+{
+    QFETCH(qint64, pid);
+    QFETCH(QString, bootId);
+
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(0));
+    const QString dir = supervisor->runtimeDirectory();
+    QVERIFY(writeGuest(dir, "ghost", pid, bootId));
+    QSignalSpy added(supervisor.data(), &VmSupervisor::instanceAdded);
+
+    QCOMPARE(supervisor->reattachGuests(), QStringList());
+    QCOMPARE(added.count(), 0);
+    QVERIFY(!supervisor->instance("ghost"));
+    QCOMPARE(QDir(dir).entryList({"ghost*"}, QDir::Files), QStringList());
+}
+
+// Тот же файл через GuestProcess::attach() напрямую: false, файлы удалены,
+// finished() не приходит
+void TestReattach::staleAttach()
+{
+    const QString dir = m_stubs.filePath("run");
+    QVERIFY(writeGuest(dir, "ghost", 0, QString()));
+
+    GuestProcess guest("ghost");
+    guest.setDirectory(dir);
+    QSignalSpy finished(&guest, &GuestProcess::finished);
+    QVERIFY(!guest.attach());
+    QVERIFY(!guest.isRunning());
+    QVERIFY(!guest.errorString().isEmpty());
+    QCOMPARE(QDir(dir).entryList({"ghost*"}, QDir::Files), QStringList());
+
+    QTest::qWait(2 * GuestProcess::PollMs);
+    QCOMPARE(finished.count(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestReattach)
+#include "tst_reattach.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_reattach
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_reattach.cpp
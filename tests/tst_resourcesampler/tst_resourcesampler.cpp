@@ -0,0 +1,158 @@
+#include <QtTest>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "resourcesampler.h"
+
+namespace {
+
+constexpr int Capacity = SampleRing::Capacity;
+constexpr quint64 ConcurrentSamples = 2000000;
+constexpr quint64 WriteMask = 0x5a5a5a5a5a5a5a5aULL;
+
+// Все поля замера выводятся из его номера: по копии видно, не смешались ли
+// в ней два замера
+ResourceSample sampleFor(quint64 n)
+{
+    ResourceSample sample;
+    sample.timestampMs = qint64(n);
+    sample.cpuPercent = float(n % 1000);
+    sample.cpuTimeUs = n * 3;
+    sample.rssBytes = n * 7;
+    sample.readBytes = ~n;
+    sample.writeBytes = n ^ WriteMask;
+    return sample;
+}
+
+bool consistent(const ResourceSample &sample)
+{
+    const quint64 n = quint64(sample.timestampMs);
+    return sample.cpuPercent == float(n % 1000) && sample.cpuTimeUs == n * 3 && sample.rssBytes == n * 7
+           && sample.readBytes == ~n && sample.writeBytes == (n ^ WriteMask);
+}
+
+} // namespace
+
+// SampleRing: снимок после переполнения — последние замеры по порядку,
+// читатель в другом потоке во время записи не видит ни рваных замеров, ни
+// замеров следующего круга на месте старых
+class TestResourceSampler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+    void wraparound_data();
+    void wraparound();
+    void concurrentReader();
+};
+
+void TestResourceSampler::empty()
+{
+    auto ring = std::make_unique<SampleRing>();
+    ResourceSample sample;
+
+    QCOMPARE(ring->written(), quint64(0));
+    QVERIFY(ring->snapshot().isEmpty());
+    QVERIFY(!ring->latest(&sample));
+}
+
+void TestResourceSampler::wraparound_data()
+{
+    QTest::addColumn<int>("pushed");
+    QTest::addColumn<int>("maxCount");
+    QTest::addColumn<int>("count");
+
+    // Снимок — не больше Capacity - 1: ячейку, которую писатель займёт
+    // следующей, не отдаём
+    QTest::newRow("one") << 1 << Capacity << 1;
+    QTest::newRow("below-capacity") << Capacity - 1 << Capacity << Capacity - 1;
+    QTest::newRow("full") << Capacity << Capacity << Capacity - 1;
+    QTest::newRow("wrapped") << Capacity + 1 << Capacity << Capacity - 1;
+    QTest::newRow("three-laps") << 3 * Capacity + 5 << Capacity << Capacity - 1;
+    QTest::newRow("limited") << 3 * Capacity + 5 << 10 << 10;
+    QTest::newRow("zero") << 100 << 0 << 0;
+}
+
+void TestResourceSampler::wraparound()
+{
+    QFETCH(int, pushed);
+    QFETCH(int, maxCount);
+    QFETCH(int, count);
+
+    auto ring = std::make_unique<SampleRing>();
+    for (int i = 0; i < pushed; ++i)
+        ring->push(sampleFor(quint64(i)));
+    QCOMPARE(ring->written(), quint64(pushed));
+
+    const QVector<ResourceSample> samples = ring->snapshot(maxCount);
+    QCOMPARE(samples.size(), count);
+    for (int i = 0; i < samples.size(); ++i) {
+        QCOMPARE(samples[i].timestampMs, qint64(pushed - count + i));
+        QVERIFY(consistent(samples[i]));
+    }
+
+    ResourceSample latest;
+    QVERIFY(ring->latest(&latest));
+    QCOMPARE(latest.timestampMs, qint64(pushed - 1));
+    QVERIFY(consistent(latest));
+}
+
+// Писатель без пауз обгоняет читателя на круги; читатель может пропускать
+// ячейки, но всё, что он вернул, — целые замеры строго по возрастанию и не
+// новее записанного
+void TestResourceSampler::concurrentReader()
+{
+    auto ring = std::make_unique<SampleRing>();
+    std::atomic<bool> done {false};
+    std::thread writer([&ring, &done]() {
+        for (quint64 i = 0; i < ConcurrentSamples; ++i)
+            ring->push(sampleFor(i));
+        done.store(true, std::memory_order_release);
+    });
+
+    QString failure;
+    int snapshots = 0;
+    qint64 returned = 0;
+    qint64 skipped = 0;
+    while (failure.isEmpty() && !done.load(std::memory_order_acquire)) {
+        const quint64 before = ring->written();
+        const QVector<ResourceSample> samples = ring->snapshot();
+        const quint64 after = ring->written();
+        ++snapshots;
+        returned += samples.size();
+        skipped += qMax<qint64>(0, qint64(qMin<quint64>(before, Capacity - 1)) - samples.size());
+
+        qint64 previous = -1;
+        for (const ResourceSample &sample : samples) {
+            if (!consistent(sample)) {
+                failure = QString("рваный замер %1").arg(sample.timestampMs);
+                break;
+            }
+            if (sample.timestampMs <= previous || quint64(sample.timestampMs) >= after) {
+                failure = QString("замер %1 после %2, записано %3").arg(sample.timestampMs).arg(previous).arg(after);
+                break;
+            }
+            previous = sample.timestampMs;
+        }
+
+        ResourceSample latest;
+        if (failure.isEmpty() && ring->latest(&latest) && !consistent(latest))
+            failure = QString("рваный последний замер %1").arg(latest.timestampMs);
+    }
+    writer.join();
+    QVERIFY2(failure.isEmpty(), qPrintable(failure));
+    qInfo().noquote() << QString("снимков во время записи: %1, замеров: %2, пропущено ячеек: %3")
+                             .arg(snapshots).arg(returned).arg(skipped);
+    QVERIFY(snapshots > 0);
+
+    // Писатель закончил — снимок снова полный и сплошной
+    const QVector<ResourceSample> samples = ring->snapshot();
+    QCOMPARE(samples.size(), Capacity - 1);
+    QCOMPARE(samples.first().timestampMs, qint64(ConcurrentSamples) - (Capacity - 1));
+    QCOMPARE(samples.last().timestampMs, qint64(ConcurrentSamples) - 1);
+}
+
+QTEST_GUILESS_MAIN(TestResourceSampler)
+#include "tst_resourcesampler.moc"
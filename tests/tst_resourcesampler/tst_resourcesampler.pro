@@ -0,0 +1,7 @@
+TARGET = tst_resourcesampler
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_resourcesampler.cpp
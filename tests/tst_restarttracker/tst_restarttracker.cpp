@@ -0,0 +1,283 @@
+#include <QtTest>
+
+#include <climits>
+
+#include "restarttracker.h"
+
+namespace {
+
+// bhyve(8) не различает сигналы сам — прослойка отдаёт 128 + номер сигнала
+constexpr int SigKill = 9;
+constexpr int SigTerm = 15;
+
+// Короткий прогон — меньше minUptimeMs любой политики ниже
+constexpr qint64 ShortRunMs = 100;
+
+}
+
+// RestartTracker без таймеров: время — счётчик миллисекунд в самом тесте.
+// Разбор кодов выхода bhyve, решения OnFailure/Always/Never, рост backoff до
+// потолка, разброс jitter, предохранитель по окну и сброс серии после
+// долгого аптайма
+class TestRestartTracker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void classify_data();
+    void classify();
+    void policy_data();
+    void policy();
+    void backoff();
+    void jitter();
+    void crashLoop();
+    void crashLoopWindow();
+    void uptimeResetsBackoff();
+
+private:
+    static RestartPolicy quietPolicy();
+};
+
+// Без jitter и предохранителя — задержки предсказуемы до миллисекунды
+RestartPolicy TestRestartTracker::quietPolicy()
+{
+    RestartPolicy policy;
+    policy.mode = RestartPolicy::OnFailure;
+    policy.rebootDelayMs = 500;
+    policy.initialBackoffMs = 1000;
+    policy.maxBackoffMs = 8000;
+    policy.jitterPercent = 0;
+    policy.crashLoopFailures = 0;
+    policy.minUptimeMs = 60000;
+    return policy;
+}
+
+void TestRestartTracker::classify_data()
+{
+    QTest::addColumn<int>("exitCode");
+    QTest::addColumn<bool>("crashed");
+    QTest::addColumn<int>("kind");
+
+    QTest::newRow("reboot") << 0 << false << int(RestartTracker::ExitKind::Reboot);
+    QTest::newRow("poweroff") << 1 << false << int(RestartTracker::ExitKind::PowerOff);
+    QTest::newRow("halt") << 2 << false << int(RestartTracker::ExitKind::Halt);
+    QTest::newRow("triple-fault") << 3 << false << int(RestartTracker::ExitKind::Failure);
+    QTest::newRow("error") << 4 << false << int(RestartTracker::ExitKind::Failure);
+    QTest::newRow("sigterm") << 128 + SigTerm << false << int(RestartTracker::ExitKind::Failure);
+    QTest::newRow("sigkill") << 128 + SigKill << false << int(RestartTracker::ExitKind::Failure);
+    QTest::newRow("crashed") << 0 << true << int(RestartTracker::ExitKind::Failure);
+}
+
+void TestRestartTracker::classify()
+{
+    QFETCH(int, exitCode);
+    QFETCH(bool, crashed);
+    QFETCH(int, kind);
+
+    QCOMPARE(int(RestartTracker::classify(exitCode, crashed)), kind);
+}
+
+void TestRestartTracker::policy_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<int>("exitCode");
+    QTest::addColumn<bool>("restart");
+    QTest::addColumn<int>("delayMs");
+
+    const int reboot = quietPolicy().rebootDelayMs;
+    const int backoff = quietPolicy().initialBackoffMs;
+    const int signal = 128 + SigKill;
+
+    QTest::newRow("on-failure/reboot") << int(RestartPolicy::OnFailure) << 0 << true << reboot;
+    QTest::newRow("on-failure/poweroff") << int(RestartPolicy::OnFailure) << 1 << false << 0;
+    QTest::newRow("on-failure/halt") << int(RestartPolicy::OnFailure) << 2 << false << 0;
+    QTest::newRow("on-failure/triple-fault") << int(RestartPolicy::OnFailure) << 3 << true << backoff;
+    QTest::newRow("on-failure/error") << int(RestartPolicy::OnFailure) << 4 << true << backoff;
+    QTest::newRow("on-failure/signal") << int(RestartPolicy::OnFailure) << signal << true << backoff;
+
+    QTest::newRow("always/reboot") << int(RestartPolicy::Always) << 0 << true << reboot;
+    QTest::newRow("always/poweroff") << int(RestartPolicy::Always) << 1 << true << reboot;
+    QTest::newRow("always/halt") << int(RestartPolicy::Always) << 2 << true << reboot;
+    QTest::newRow("always/triple-fault") << int(RestartPolicy::Always) << 3 << true << backoff;
+    QTest::newRow("always/signal") << int(RestartPolicy::Always) << signal << true << backoff;
+
+    QTest::newRow("never/reboot") << int(RestartPolicy::Never) << 0 << false << 0;
+    QTest::newRow("never/poweroff") << int(RestartPolicy::Never) << 1 << false << 0;
+    QTest::newRow("never/error") << int(RestartPolicy::Never) << 4 << false << 0;
+    QTest::newRow("never/signal") << int(RestartPolicy::Never) << signal << false << 0;
+}
+
+void TestRestartTracker::policy()
+{
+    QFETCH(int, mode);
+    QFETCH(int, exitCode);
+    QFETCH(bool, restart);
+    QFETCH(int, delayMs);
+
+    RestartPolicy policy = quietPolicy();
+    policy.mode = RestartPolicy::Mode(mode);
+    RestartTracker tracker(policy);
+    tracker.arm();
+
+    tracker.onStarted(0);
+    const RestartTracker::Decision decision =
+        tracker.onExit(RestartTracker::classify(exitCode, false), ShortRunMs);
+    QCOMPARE(decision.restart, restart);
+    QCOMPARE(decision.delayMs, delayMs);
+    QVERIFY(!decision.crashLoop);
+    QVERIFY(!decision.reason.isEmpty());
+    QCOMPARE(tracker.restarts(), restart ? 1 : 0);
+    QCOMPARE(tracker.failures(), exitCode > 2 ? 1 : 0);
+}
+
+// initial * 2^(n-1) до потолка; каждый повтор — в учёт восстановления
+void TestRestartTracker::backoff()
+{
+    RestartTracker tracker(quietPolicy());
+    tracker.arm();
+
+    const QVector<int> expected = {1000, 2000, 4000, 8000, 8000, 8000};
+    qint64 now = 0;
+    for (int i = 0; i < expected.size(); ++i) {
+        tracker.onStarted(now);
+        now += ShortRunMs;
+        const RestartTracker::Decision decision = tracker.onExit(RestartTracker::ExitKind::Failure, now);
+        QVERIFY(decision.restart);
+        QCOMPARE(decision.delayMs, expected[i]);
+        QCOMPARE(tracker.consecutiveFailures(), i + 1);
+        now += decision.delayMs;
+    }
+    tracker.onStarted(now);
+
+    QCOMPARE(tracker.failures(), expected.size());
+    QCOMPARE(tracker.restarts(), expected.size());
+    QCOMPARE(tracker.recoveryStats().count(), quint64(expected.size()));
+    QCOMPARE(tracker.meanUptimeMs(), ShortRunMs);
+}
+
+// ±jitterPercent от backoff и никогда не меньше нуля; разброс реально есть
+void TestRestartTracker::jitter()
+{
+    RestartPolicy policy = quietPolicy();
+    policy.jitterPercent = 20;
+    RestartTracker tracker(policy);
+
+    const int spread = policy.initialBackoffMs * policy.jitterPercent / 100;
+    int low = INT_MAX;
+    int high = INT_MIN;
+    for (int i = 0; i < 2000; ++i) {
+        // arm() обнуляет серию — каждый раз первый сбой, без роста backoff
+        tracker.arm();
+        tracker.onStarted(0);
+        const RestartTracker::Decision decision = tracker.onExit(RestartTracker::ExitKind::Failure, ShortRunMs);
+        QVERIFY(decision.restart);
+        low = qMin(low, decision.delayMs);
+        high = qMax(high, decision.delayMs);
+    }
+    QVERIFY2(low >= policy.initialBackoffMs - spread, qPrintable(QString::number(low)));
+    QVERIFY2(high <= policy.initialBackoffMs + spread, qPrintable(QString::number(high)));
+    QVERIFY(low < policy.initialBackoffMs);
+    QVERIFY(high > policy.initialBackoffMs);
+
+    // Перезагрузка гостя — без jitter
+    tracker.arm();
+    tracker.onStarted(0);
+    QCOMPARE(tracker.onExit(RestartTracker::ExitKind::Reboot, ShortRunMs).delayMs, policy.rebootDelayMs);
+}
+
+// N-й сбой внутри окна останавливает перезапуски до arm()
+void TestRestartTracker::crashLoop()
+{
+    RestartPolicy policy = quietPolicy();
+    policy.crashLoopFailures = 3;
+    policy.crashLoopWindowMs = 60000;
+    RestartTracker tracker(policy);
+    tracker.arm();
+
+    qint64 now = 0;
+    for (int i = 1; i <= policy.crashLoopFailures; ++i) {
+        tracker.onStarted(now);
+        now += ShortRunMs;
+        const RestartTracker::Decision decision = tracker.onExit(RestartTracker::ExitKind::Failure, now);
+        const bool last = i == policy.crashLoopFailures;
+        QCOMPARE(decision.restart, !last);
+        QCOMPARE(decision.crashLoop, last);
+        QCOMPARE(tracker.isCrashLoop(), last);
+        now += decision.delayMs;
+    }
+    QCOMPARE(tracker.restarts(), policy.crashLoopFailures - 1);
+    QVERIFY(tracker.summary().contains("предохранитель"));
+
+    // Перезагрузка гостя — не сбой, предохранитель её не трогает
+    tracker.onStarted(now);
+    now += ShortRunMs;
+    QVERIFY(tracker.onExit(RestartTracker::ExitKind::Reboot, now).restart);
+
+    tracker.arm();
+    QVERIFY(!tracker.isCrashLoop());
+    QCOMPARE(tracker.consecutiveFailures(), 0);
+    tracker.onStarted(now);
+    now += ShortRunMs;
+    const RestartTracker::Decision decision = tracker.onExit(RestartTracker::ExitKind::Failure, now);
+    QVERIFY(decision.restart);
+    QCOMPARE(decision.delayMs, policy.initialBackoffMs);
+}
+
+// Те же N сбоев, но реже окна — предохранитель молчит
+void TestRestartTracker::crashLoopWindow()
+{
+    RestartPolicy policy = quietPolicy();
+    policy.crashLoopFailures = 3;
+    policy.crashLoopWindowMs = 60000;
+    // Аптайм между сбоями не должен сбрасывать серию — проверяем только окно
+    policy.minUptimeMs = 10 * policy.crashLoopWindowMs;
+    RestartTracker tracker(policy);
+    tracker.arm();
+
+    qint64 now = 0;
+    for (int i = 0; i < 3 * policy.crashLoopFailures; ++i) {
+        tracker.onStarted(now);
+        now += policy.crashLoopWindowMs * 2 / 3;
+        const RestartTracker::Decision decision = tracker.onExit(RestartTracker::ExitKind::Failure, now);
+        QVERIFY2(decision.restart, qPrintable(QString("сбой %1").arg(i + 1)));
+        QVERIFY(!decision.crashLoop);
+    }
+    QVERIFY(!tracker.isCrashLoop());
+    QCOMPARE(tracker.consecutiveFailures(), 3 * policy.crashLoopFailures);
+}
+
+// Прогон дольше minUptimeMs начинает серию заново — backoff снова начальный
+void TestRestartTracker::uptimeResetsBackoff()
+{
+    const RestartPolicy policy = quietPolicy();
+    RestartTracker tracker(policy);
+    tracker.arm();
+
+    qint64 now = 0;
+    RestartTracker::Decision decision;
+    for (int i = 0; i < 3; ++i) {
+        tracker.onStarted(now);
+        now += ShortRunMs;
+        decision = tracker.onExit(RestartTracker::ExitKind::Failure, now);
+        now += decision.delayMs;
+    }
+    QCOMPARE(decision.delayMs, 4 * policy.initialBackoffMs);
+
+    // Чуть меньше порога — серия продолжается
+    tracker.onStarted(now);
+    now += policy.minUptimeMs - 1;
+    decision = tracker.onExit(RestartTracker::ExitKind::Failure, now);
+    QCOMPARE(decision.delayMs, policy.maxBackoffMs);
+    QCOMPARE(tracker.consecutiveFailures(), 4);
+    now += decision.delayMs;
+
+    tracker.onStarted(now);
+    now += policy.minUptimeMs;
+    decision = tracker.onExit(RestartTracker::ExitKind::Failure, now);
+    QVERIFY(decision.restart);
+    QCOMPARE(decision.delayMs, policy.initialBackoffMs);
+    QCOMPARE(tracker.consecutiveFailures(), 1);
+}
+
+QTEST_GUILESS_MAIN(TestRestartTracker)
+#include "tst_restarttracker.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_restarttracker
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_restarttracker.cpp
@@ -0,0 +1,148 @@
+#include <QtTest>
+
+#include "rfbdecoder.h"
+#include "rfbtestserver.h"
+
+// RfbDecoder без сокета: байты сервера подаются в feed() кусками разной
+// длины — целиком, как из сокета и с границами посреди заголовков. После
+// каждого прохода экран клиента обязан совпасть с экраном сервера, а
+// изменённых прямоугольников — быть по одному на каждый присланный
+class TestRfbDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void handshake_data();
+    void handshake();
+    void refused();
+    void passes_data();
+    void passes();
+    void unrequestedEncoding();
+
+private:
+    static bool feedChunked(RfbDecoder &decoder, const QByteArray &data, int chunkBytes);
+
+    QVector<RfbPass> m_passes;
+    std::vector<QByteArray> m_updates;
+};
+
+void TestRfbDecoder::initTestCase()
+{
+    ZrleEncoder zrle;
+    m_passes = buildDesktopPasses(2, 4, 40, &zrle, &m_updates);
+    QVERIFY2(zrle.usedAllKinds(), "тестовый рабочий стол задел не все виды плиток ZRLE");
+}
+
+bool TestRfbDecoder::feedChunked(RfbDecoder &decoder, const QByteArray &data, int chunkBytes)
+{
+    const int step = chunkBytes > 0 ? chunkBytes : data.size();
+    for (int offset = 0; offset < data.size(); offset += step) {
+        if (!decoder.feed(data.constData() + offset, qMin(step, data.size() - offset)))
+            return false;
+    }
+    return true;
+}
+
+void TestRfbDecoder::handshake_data()
+{
+    QTest::addColumn<int>("chunkBytes");
+
+    QTest::newRow("whole") << 0;
+    QTest::newRow("byte-by-byte") << 1;
+}
+
+// Ответы клиента: версия 3.8, тип None, ClientInit, затем SetPixelFormat
+// с родным форматом
+void TestRfbDecoder::handshake()
+{
+    QFETCH(int, chunkBytes);
+
+    ScreenSurface surface;
+    RfbDecoder decoder(&surface);
+    QVERIFY2(feedChunked(decoder, serverHandshake(DesktopWidth, DesktopHeight, "test"), chunkBytes),
+             qPrintable(decoder.error()));
+
+    QVERIFY(decoder.isReady());
+    QCOMPARE(decoder.width(), DesktopWidth);
+    QCOMPARE(decoder.height(), DesktopHeight);
+    QCOMPARE(decoder.desktopName(), QString("test"));
+    QCOMPARE(surface.screen.width, DesktopWidth);
+
+    const QByteArray out = decoder.takeOutput();
+    QVERIFY(out.startsWith("RFB 003.008\n"));
+    QCOMPARE(out.at(12), char(1));
+    QCOMPARE(out.at(13), char(1));
+    QCOMPARE(out.at(14), char(0));
+    QCOMPARE(out.mid(18, 16), RfbDecoder::PixelFormat::native().encode());
+}
+
+void TestRfbDecoder::refused()
+{
+    QByteArray data("RFB 003.008\n");
+    data.append(char(0));
+    appendBe32(data, 4);
+    data.append("busy");
+
+    ScreenSurface surface;
+    RfbDecoder decoder(&surface);
+    QVERIFY(!decoder.feed(data.constData(), data.size()));
+    QCOMPARE(decoder.phase(), RfbDecoder::Phase::Failed);
+    QVERIFY2(decoder.error().contains("busy"), qPrintable(decoder.error()));
+}
+
+void TestRfbDecoder::passes_data()
+{
+    QTest::addColumn<int>("chunkBytes");
+
+    QTest::newRow("whole-pass") << 0;
+    QTest::newRow("socket-64k") << 65536;
+    QTest::newRow("odd-1021") << 1021;
+}
+
+void TestRfbDecoder::passes()
+{
+    QFETCH(int, chunkBytes);
+
+    ScreenSurface surface;
+    RfbDecoder decoder(&surface);
+    QVERIFY(feedChunked(decoder, serverHandshake(DesktopWidth, DesktopHeight, "test"), chunkBytes));
+    size_t next = 0;
+    for (const RfbPass &pass : qAsConst(m_passes)) {
+        QByteArray data;
+        for (int i = 0; i < pass.updates; ++i)
+            data += m_updates[next++];
+        int completed = 0;
+        int dirtyRects = 0;
+        const int step = chunkBytes > 0 ? chunkBytes : data.size();
+        for (int offset = 0; offset < data.size(); offset += step) {
+            QVERIFY2(decoder.feed(data.constData() + offset, qMin(step, data.size() - offset)),
+                     qPrintable(pass.name + ": " + decoder.error()));
+            completed += decoder.takeCompletedUpdates();
+            dirtyRects += decoder.takeDirtyRects().size();
+        }
+
+        QCOMPARE(completed, pass.updates);
+        QCOMPARE(dirtyRects, pass.fullFrames ? pass.updates : pass.updates * 3);
+        QVERIFY2(surface.sameAs(pass.expected), qPrintable(pass.name + ": экран клиента не совпал с сервером"));
+    }
+    QCOMPARE(decoder.stats().updates, qint64(m_updates.size()));
+}
+
+// Hextile клиент не просил — соединение не продолжается
+void TestRfbDecoder::unrequestedEncoding()
+{
+    ScreenSurface surface;
+    RfbDecoder decoder(&surface);
+    const QByteArray init = serverHandshake(64, 64, "test");
+    QVERIFY(decoder.feed(init.constData(), init.size()));
+
+    QByteArray update = beginUpdate(1);
+    appendRectHeader(update, QRect(0, 0, 16, 16), 5);
+    QVERIFY(!decoder.feed(update.constData(), update.size()));
+    QCOMPARE(decoder.phase(), RfbDecoder::Phase::Failed);
+    QVERIFY(!decoder.error().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestRfbDecoder)
+#include "tst_rfbdecoder.moc"
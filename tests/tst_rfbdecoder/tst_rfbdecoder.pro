@@ -0,0 +1,7 @@
+TARGET = tst_rfbdecoder
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_rfbdecoder.cpp
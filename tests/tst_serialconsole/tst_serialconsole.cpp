@@ -0,0 +1,136 @@
+#include <QtTest>
+#include <QScopedPointer>
+
+#include "controlclient.h"
+#include "controlserver.h"
+#include "guestprocess.h"
+#include "logbuffer.h"
+#include "serialconsole.h"
+#include "stubtools.h"
+#include "terminalscreen.h"
+#include "vminstance.h"
+#include "vmsupervisor.h"
+
+namespace {
+
+constexpr int Keys = 40;
+constexpr int TimeoutMs = 30000;
+
+} // namespace
+
+// com1 заглушки bhyve через pty: приглашение login и эхо. Нажатия идут по
+// одному в SerialConsole::write, как из TerminalView, следующее — когда
+// вернулось эхо предыдущего; перевод строки — через API (op input). Те
+// же байты должны дойти до двух экранов, подписчика API и лога ВМ, а
+// история — восстановить экран новому зрителю
+class TestSerialConsole : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void echo();
+
+private:
+    StubTools m_stubs;
+};
+
+void TestSerialConsole::initTestCase()
+{
+    QVERIFY2(m_stubs.prepare(), qPrintable(m_stubs.errorString()));
+}
+
+void TestSerialConsole::echo()
+{
+    QScopedPointer<VmSupervisor> supervisor(m_stubs.createSupervisor(1));
+    VmInstance *vm = supervisor->at(0);
+    SerialConsole *serial = vm->serial();
+    QScopedPointer<ControlServer> server(new ControlServer(supervisor.data()));
+    QString error;
+    QVERIFY2(server->listen(m_stubs.filePath("control.sock"), &error), qPrintable(error));
+
+    TerminalScreen first;
+    TerminalScreen second;
+    QByteArray direct;
+    QByteArray api;
+    int keys = 0;
+    char expected = 0;
+    bool typing = false;
+    // Контекст соединения: уходит раньше переменных, которые оно трогает
+    QObject context;
+    auto sendKey = [&]() {
+        expected = char('a' + keys % 26);
+        serial->write(QByteArray(1, expected));
+    };
+    connect(serial, &SerialConsole::received, &context, [&](const QByteArray &data) {
+        first.feed(data);
+        second.feed(data);
+        direct += data;
+        if (typing && data.contains(expected)) {
+            if (++keys < Keys)
+                sendKey();
+            else
+                typing = false;
+        }
+    });
+
+    ControlClient client;
+    connect(&client, &ControlClient::event, this, [&api](const QJsonObject &event) {
+        if (event.value("event").toString() == "console")
+            api += QByteArray::fromBase64(event.value("data").toString().toLatin1());
+    });
+    QSignalSpy connected(&client, &ControlClient::connected);
+    QSignalSpy replied(&client, &ControlClient::replied);
+    client.connectToServer(server->path());
+    QVERIFY(connected.count() > 0 || connected.wait(TimeoutMs));
+    client.send(QJsonObject {{"op", "console"}, {"vm", vm->name()}});
+    QVERIFY(replied.wait(TimeoutMs));
+    QVERIFY(replied.last().at(1).toJsonObject().value("ok").toBool());
+
+    vm->start();
+    QTRY_VERIFY_WITH_TIMEOUT(direct.contains("login: "), 2 * GuestProcess::StartDeadlineMs);
+    QVERIFY(serial->isOpen());
+
+    typing = true;
+    sendKey();
+    QTRY_VERIFY_WITH_TIMEOUT(!typing, TimeoutMs);
+    QCOMPARE(keys, Keys);
+
+    replied.clear();
+    client.send(QJsonObject {{"op", "input"}, {"vm", vm->name()}, {"data", QString::fromLatin1(QByteArray("\n").toBase64())}});
+    QVERIFY(replied.wait(TimeoutMs));
+    QVERIFY(replied.last().at(1).toJsonObject().value("ok").toBool());
+    QTRY_VERIFY_WITH_TIMEOUT(direct.endsWith('\n'), TimeoutMs);
+
+    // Подписчик API получил ровно то, что прочитано из pty
+    QTRY_COMPARE_WITH_TIMEOUT(api.size(), direct.size(), TimeoutMs);
+    QCOMPARE(api, direct);
+
+    TerminalScreen replay;
+    replay.feed(serial->history());
+    for (int row = 0; row < first.rows(); ++row) {
+        QCOMPARE(second.line(row), first.line(row));
+        QCOMPARE(replay.line(row), first.line(row));
+    }
+    QCOMPARE(serial->bytesSent(), quint64(Keys + 1));
+    QVERIFY(serial->bytesReceived() >= quint64(direct.size()));
+
+    // Строка com1 в логе ВМ — с пометкой Serial
+    const LogBuffer *log = vm->log();
+    auto logged = [log]() {
+        for (quint64 seq = log->firstSeq(); seq < log->endSeq(); ++seq) {
+            const LogLine &line = log->lineAt(seq);
+            if (line.severity == LogSeverity::Serial && line.text.startsWith("login: abc"))
+                return true;
+        }
+        return false;
+    };
+    QTRY_VERIFY_WITH_TIMEOUT(logged(), TimeoutMs);
+
+    server.reset();
+    vm->stop();
+    QTRY_COMPARE_WITH_TIMEOUT(vm->state(), VmInstance::State::Stopped, 15000);
+}
+
+QTEST_GUILESS_MAIN(TestSerialConsole)
+#include "tst_serialconsole.moc"
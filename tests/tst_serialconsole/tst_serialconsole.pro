@@ -0,0 +1,7 @@
+TARGET = tst_serialconsole
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_serialconsole.cpp
@@ -0,0 +1,134 @@
+#include <QtTest>
+
+#include "consolesample.h"
+#include "terminalscreen.h"
+
+namespace {
+
+bool sameScreen(const TerminalScreen &a, const TerminalScreen &b)
+{
+    if (a.cursorRow() != b.cursorRow() || a.cursorColumn() != b.cursorColumn()
+        || a.scrollbackSize() != b.scrollbackSize())
+        return false;
+    for (int row = 0; row < a.rows(); ++row) {
+        if (a.line(row) != b.line(row))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// TerminalScreen без окна: печать, позиционирование, прокрутка в историю,
+// ответы на DSR и повреждения. Вывод загрузки с цветом, рамками и
+// кириллицей разбирается целиком и кусками — экран должен совпасть
+// (UTF-8 и последовательности рвутся на границах чтения)
+class TestTerminalScreen : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void print();
+    void cursorPosition();
+    void statusReport();
+    void scrollback();
+    void damage();
+    void chunking_data();
+    void chunking();
+
+private:
+    QByteArray m_sample;
+};
+
+void TestTerminalScreen::initTestCase()
+{
+    m_sample = consoleSample(256 * 1024);
+}
+
+void TestTerminalScreen::print()
+{
+    TerminalScreen screen;
+    screen.feed(QByteArray("hello\r\n\x1b[1;31mмир\x1b[0m"));
+    QCOMPARE(screen.text(0), QString("hello"));
+    QCOMPARE(screen.text(1), QString("мир"));
+    QCOMPARE(screen.cursorRow(), 1);
+    QCOMPARE(screen.cursorColumn(), 3);
+}
+
+void TestTerminalScreen::cursorPosition()
+{
+    TerminalScreen screen;
+    screen.feed(QByteArray("\x1b[5;10Hx"));
+    QCOMPARE(screen.text(4), QString(9, QLatin1Char(' ')) + "x");
+    QCOMPARE(screen.cursorRow(), 4);
+    QCOMPARE(screen.cursorColumn(), 10);
+}
+
+void TestTerminalScreen::statusReport()
+{
+    TerminalScreen screen;
+    screen.feed(QByteArray("\x1b[3;7H\x1b[6n\x1b[5n"));
+    QCOMPARE(screen.takeReplies(), QByteArray("\x1b[3;7R\x1b[0n"));
+    QCOMPARE(screen.takeReplies(), QByteArray());
+}
+
+void TestTerminalScreen::scrollback()
+{
+    TerminalScreen screen;
+    for (int i = 0; i < 30; ++i)
+        screen.feed(QString("line %1\r\n").arg(i).toLatin1());
+    // 30 строк и пустая под курсором на экране из 25
+    QCOMPARE(screen.scrollbackSize(), 30 + 1 - TerminalScreen::DefaultRows);
+    QCOMPARE(screen.cursorRow(), TerminalScreen::DefaultRows - 1);
+    QCOMPARE(screen.text(TerminalScreen::DefaultRows - 2), QString("line 29"));
+    QCOMPARE(screen.stats().scrolled, qint64(screen.scrollbackSize()));
+}
+
+void TestTerminalScreen::damage()
+{
+    TerminalScreen screen;
+    screen.takeDamage();
+    screen.feed(QByteArray("\x1b[3;1Habc"));
+    TerminalScreen::Damage damage = screen.takeDamage();
+    QVERIFY(!damage.isEmpty());
+    QCOMPARE(damage.scrolledLines, 0);
+    QVERIFY(!damage.rows.at(2).isEmpty());
+    QVERIFY(damage.rows.at(0).isEmpty());
+    QVERIFY(screen.takeDamage().isEmpty());
+}
+
+void TestTerminalScreen::chunking_data()
+{
+    QTest::addColumn<int>("minChunk");
+    QTest::addColumn<int>("maxChunk");
+
+    QTest::newRow("1-7-bytes") << 1 << 7;
+    QTest::newRow("byte-by-byte") << 1 << 1;
+    QTest::newRow("4k") << 4096 << 4096;
+}
+
+void TestTerminalScreen::chunking()
+{
+    QFETCH(int, minChunk);
+    QFETCH(int, maxChunk);
+
+    TerminalScreen whole;
+    whole.feed(m_sample);
+    TerminalScreen pieces;
+    QRandomGenerator random(22);
+    for (int offset = 0; offset < m_sample.size();) {
+        const int size = qMin(m_sample.size() - offset, random.bounded(minChunk, maxChunk + 1));
+        pieces.feed(m_sample.constData() + offset, size);
+        offset += size;
+    }
+
+    QVERIFY(sameScreen(whole, pieces));
+    const QByteArray replies = whole.takeReplies();
+    QVERIFY(!replies.isEmpty());
+    QCOMPARE(pieces.takeReplies(), replies);
+    QCOMPARE(pieces.stats().sequences, whole.stats().sequences);
+}
+
+QTEST_GUILESS_MAIN(TestTerminalScreen)
+#include "tst_terminalscreen.moc"
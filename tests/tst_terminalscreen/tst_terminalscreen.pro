@@ -0,0 +1,7 @@
+TARGET = tst_terminalscreen
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_terminalscreen.cpp
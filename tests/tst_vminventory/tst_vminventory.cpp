@@ -0,0 +1,243 @@
+#include <QtTest>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+#include "vminventory.h"
+
+namespace {
+
+constexpr int VmCount = 20;
+// Каталог без образа: сканер его видит и проверяет, но в индекс он не попадает
+const QString EmptyDir = "notes";
+constexpr int ScanTimeoutMs = 10000;
+
+QString vmName(int i)
+{
+    return QString("vm%1").arg(i, 2, 10, QChar('0'));
+}
+
+}
+
+// VmInventory на временном каталоге из VmCount образов: полный проход,
+// подъём индекса из кэша до сканирования и отказ от чужого или битого
+// кэша, точечная перепроверка по refreshVm() и по событиям каталога —
+// добавленные и удалённые образы видны без stat() остальных
+class TestVmInventory : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void fullScan();
+    void loadCache();
+    void cacheRejected_data();
+    void cacheRejected();
+    void refreshVm();
+    void watcher();
+
+private:
+    QString root() const { return m_dir->filePath("vm"); }
+    QString cachePath() const { return m_dir->filePath("cache/vm-inventory.cache"); }
+    bool createImage(const QString &name, qint64 bytes) const;
+    bool removeVm(const QString &name) const;
+    VmInventory *createInventory() const;
+    // refresh() и ожидание конца всех проходов
+    static bool scanAll(VmInventory *inventory);
+
+    QScopedPointer<QTemporaryDir> m_dir;
+};
+
+void TestVmInventory::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    for (int i = 0; i < VmCount; ++i)
+        QVERIFY(createImage(vmName(i), 1024 * (i + 1)));
+    QVERIFY(QDir().mkpath(root() + "/" + EmptyDir));
+    QFile stray(root() + "/README");
+    QVERIFY(stray.open(QIODevice::WriteOnly));
+}
+
+bool TestVmInventory::createImage(const QString &name, qint64 bytes) const
+{
+    if (!QDir().mkpath(root() + "/" + name))
+        return false;
+    QFile image(QString("%1/%2/%2.img").arg(root(), name));
+    return image.open(QIODevice::WriteOnly) && image.resize(bytes);
+}
+
+bool TestVmInventory::removeVm(const QString &name) const
+{
+    return QDir(root() + "/" + name).removeRecursively();
+}
+
+VmInventory *TestVmInventory::createInventory() const
+{
+    auto *inventory = new VmInventory;
+    inventory->setCachePath(cachePath());
+    inventory->setRoot(root());
+    return inventory;
+}
+
+bool TestVmInventory::scanAll(VmInventory *inventory)
+{
+    QSignalSpy finished(inventory, &VmInventory::scanFinished);
+    inventory->refresh();
+    return QTest::qWaitFor([&]() { return finished.count() > 0 && !inventory->isScanning(); }, ScanTimeoutMs);
+}
+
+void TestVmInventory::fullScan()
+{
+    QScopedPointer<VmInventory> inventory(createInventory());
+    QVERIFY(inventory->images().isEmpty());
+    QVERIFY(scanAll(inventory.data()));
+
+    QVERIFY(inventory->isRootAvailable());
+    const QVector<VmImageInfo> images = inventory->images();
+    QCOMPARE(images.size(), VmCount);
+    for (int i = 0; i < VmCount; ++i) {
+        QCOMPARE(images[i].name, vmName(i));
+        QCOMPARE(images[i].imagePath, inventory->imagePathFor(vmName(i)));
+        QCOMPARE(images[i].size, qint64(1024 * (i + 1)));
+        QVERIFY(images[i].mtimeMs > 0);
+    }
+    QVERIFY(!inventory->contains(EmptyDir));
+    QCOMPARE(inventory->statCount(), quint64(VmCount + 1));
+}
+
+// Деструктор сохраняет кэш; следующий экземпляр показывает индекс из него
+// сразу, а фоновая перепроверка затем приводит его к диску
+void TestVmInventory::loadCache()
+{
+    {
+        QScopedPointer<VmInventory> inventory(createInventory());
+        QVERIFY(scanAll(inventory.data()));
+    }
+    QVERIFY(QFileInfo::exists(cachePath()));
+
+    const QString removed = vmName(VmCount - 1);
+    const QString added = vmName(VmCount);
+    QVERIFY(removeVm(removed));
+    QVERIFY(createImage(added, 4096));
+
+    QScopedPointer<VmInventory> inventory(createInventory());
+    QSignalSpy finished(inventory.data(), &VmInventory::scanFinished);
+    QSignalSpy changed(inventory.data(), &VmInventory::changed);
+    QVERIFY(inventory->loadCache());
+
+    // Ещё ни одного stat(): всё — из кэша, в том числе уже удалённый образ
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(inventory->images().size(), VmCount);
+    QVERIFY(inventory->contains(removed));
+    QVERIFY(!inventory->contains(added));
+    QCOMPARE(inventory->image(vmName(3)).size, qint64(1024 * 4));
+    QCOMPARE(inventory->image(vmName(3)).imagePath, inventory->imagePathFor(vmName(3)));
+
+    QVERIFY(inventory->isScanning());
+    QVERIFY(QTest::qWaitFor([&]() { return finished.count() > 0 && !inventory->isScanning(); }, ScanTimeoutMs));
+    QVERIFY(!inventory->contains(removed));
+    QVERIFY(inventory->contains(added));
+    QCOMPARE(inventory->image(added).size, qint64(4096));
+    QCOMPARE(inventory->images().size(), VmCount);
+}
+
+void TestVmInventory::cacheRejected_data()
+{
+    QTest::addColumn<QString>("kind");
+
+    QTest::newRow("missing") << "missing";
+    QTest::newRow("other-root") << "other-root";
+    QTest::newRow("garbage") << "garbage";
+    QTest::newRow("truncated") << "truncated";
+}
+
+void TestVmInventory::cacheRejected()
+{
+    QFETCH(QString, kind);
+
+    if (kind == "other-root") {
+        // Тот же файл кэша, но записанный для другого каталога образов
+        QVERIFY(QDir().mkpath(m_dir->filePath("other/other")));
+        QFile image(m_dir->filePath("other/other/other.img"));
+        QVERIFY(image.open(QIODevice::WriteOnly) && image.resize(1));
+        {
+            QScopedPointer<VmInventory> other(new VmInventory);
+            other->setCachePath(cachePath());
+            other->setRoot(m_dir->filePath("other"));
+            QVERIFY(scanAll(other.data()));
+            QCOMPARE(other->images().size(), 1);
+        }
+        QVERIFY(QFileInfo::exists(cachePath()));
+    } else if (kind != "missing") {
+        {
+            QScopedPointer<VmInventory> inventory(createInventory());
+            QVERIFY(scanAll(inventory.data()));
+        }
+        QFile cache(cachePath());
+        const qint64 size = cache.size();
+        QVERIFY(size > 0);
+        if (kind == "garbage") {
+            QVERIFY(cache.open(QIODevice::WriteOnly));
+            cache.write(QByteArray(int(size), '\x5a'));
+        } else {
+            QVERIFY(cache.resize(size / 2));
+        }
+    }
+
+    QScopedPointer<VmInventory> inventory(createInventory());
+    QVERIFY(!inventory->loadCache());
+    QVERIFY(inventory->images().isEmpty());
+    QVERIFY(!inventory->isScanning());
+}
+
+// refreshVm() по добавленной, удалённой и выросшей ВМ: один проход через
+// debounce и stat() только этих каталогов (события каталога могут добавить
+// проход-другой по тем же каталогам; полный — это VmCount + 1)
+void TestVmInventory::refreshVm()
+{
+    QScopedPointer<VmInventory> inventory(createInventory());
+    QVERIFY(scanAll(inventory.data()));
+    const quint64 baseline = inventory->statCount();
+
+    const QString added = vmName(VmCount);
+    const QString removed = vmName(5);
+    const QString grown = vmName(7);
+    QVERIFY(createImage(added, 512));
+    QVERIFY(removeVm(removed));
+    QFile image(inventory->imagePathFor(grown));
+    QVERIFY(image.resize(1024 * 1024));
+
+    QSignalSpy changed(inventory.data(), &VmInventory::changed);
+    for (const QString &name : {added, removed, grown})
+        inventory->refreshVm(name);
+    QTRY_VERIFY_WITH_TIMEOUT(inventory->contains(added) && !inventory->contains(removed)
+                             && inventory->image(grown).size == 1024 * 1024, ScanTimeoutMs);
+    QTRY_VERIFY(!inventory->isScanning());
+
+    QVERIFY(changed.count() >= 1);
+    QCOMPARE(inventory->images().size(), VmCount);
+    const quint64 statted = inventory->statCount() - baseline;
+    QVERIFY2(statted >= 3 && statted < quint64(VmCount / 2), qPrintable(QString::number(statted)));
+}
+
+// Без явных вызовов: новый и удалённый каталог ВМ ловит QFileSystemWatcher
+void TestVmInventory::watcher()
+{
+    QScopedPointer<VmInventory> inventory(createInventory());
+    QVERIFY(scanAll(inventory.data()));
+    const quint64 baseline = inventory->statCount();
+
+    const QString added = vmName(VmCount);
+    const QString removed = vmName(3);
+    QVERIFY(createImage(added, 512));
+    QVERIFY(removeVm(removed));
+
+    QTRY_VERIFY_WITH_TIMEOUT(inventory->contains(added) && !inventory->contains(removed), ScanTimeoutMs);
+    QTRY_VERIFY(!inventory->isScanning());
+    QCOMPARE(inventory->images().size(), VmCount);
+    const quint64 statted = inventory->statCount() - baseline;
+    QVERIFY2(statted >= 1 && statted < quint64(VmCount / 2), qPrintable(QString::number(statted)));
+}
+
+QTEST_GUILESS_MAIN(TestVmInventory)
+#include "tst_vminventory.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_vminventory
+CONFIG += testcase
+
+include(../support/support.pri)
+
+SOURCES += \
+    tst_vminventory.cpp
@@ -1,27 +1,18 @@
-QT       += core gui
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-CONFIG += c++17
-
-# You can make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-SOURCES += \
-    main.cpp \
-    mainwindow.cpp
-
-HEADERS += \
-    mainwindow.h
-
-FORMS += \
-    mainwindow.ui
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
-
-RESOURCES += \
-    resources.qrc
+# core  — движок без виджетов (статическая библиотека),
+# gui   — vmrun-gui, тонкий клиент поверх core,
+# cli   — vmrun: консольные команды и демон для безголовых узлов,
+# tests — QtTest на заглушках doas/bhyve/ifconfig (make check),
+# bench — замеры QBENCHMARK на тех же заглушках, запускаются вручную
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    core \
+    gui \
+    cli \
+    tests \
+    bench
+
+gui.depends = core
+cli.depends = core
+tests.depends = core
+bench.depends = core